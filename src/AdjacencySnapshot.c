@@ -0,0 +1,660 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_ADJACENCYSNAPSHOT_C__
+#define _FABRIC_ADJACENCYSNAPSHOT_C__
+
+#include <string.h>
+#include "Internal.h"
+
+/**
+ * An Adjacency Snapshot is a read-optimized copy of a graph's edges in
+ * compressed sparse row form.
+ *
+ * The edge store links each vertex's edges through the next_out_id and
+ * next_in_id fields of its edge records, so walking a vertex's edges
+ * jumps around the edge store.  A snapshot instead holds, for each
+ * direction, an offsets array indexed by vertex id and packed arrays of
+ * neighbor ids and edge ids.  The edges of vertex v in a direction are
+ * entries offsets[v] up to offsets[v + 1] of that direction's arrays, so
+ * whole-graph algorithms such as PageRank or breadth first search read
+ * memory sequentially.  The edges of a vertex are in ascending id order.
+ *
+ * A snapshot can be restricted to the edges with one label.  It records
+ * the state of the edge store it was built from.  Edges created since
+ * then are merged in by Fabric_AdjacencySnapshot_refresh(2) without
+ * reading the edges that are already in the snapshot.  Any other change
+ * to the edge store rebuilds the snapshot from scratch.
+ *
+ * A graph file holds at most one saved snapshot, in its own section
+ * allocated at the end of the file.  The section's offset is kept in the graph's header
+ * and is 0 when there is no snapshot.  All values in the section are
+ * 32 bit integers in the byte order of the graph's file, laid out as:
+ *
+ *      label_id, num_vertices, num_edges, source_num_edges, source_next_id
+ *      out offsets (num_vertices + 2), out neighbors, out edge ids (num_edges)
+ *      in offsets (num_vertices + 2), in neighbors, in edge ids (num_edges)
+ */
+typedef struct AdjacencyRows {
+    uint32_t *offsets;      // Where each vertex's edges start; num_vertices + 2 entries
+    vertexid_t *neighbors;  // The vertex at the other end of each edge
+    edgeid_t *edges;        // The id of each edge
+} AdjacencyRows;
+
+typedef struct AdjacencySnapshot {
+    labelid_t label_id;         // The label of the edges in the snapshot or 0 for all edges
+    uint32_t num_vertices;      // The highest vertex id covered by the snapshot
+    uint32_t num_edges;         // The number of edges in the snapshot
+    uint32_t source_num_edges;  // The edge store's edge count when last refreshed
+    edgeid_t source_next_id;    // The edge store's first never used id when last refreshed
+    AdjacencyRows rows[2];      // The out rows and the in rows
+} AdjacencySnapshot;
+
+#define FABRIC_ADJACENCY_SNAPSHOT_HEADER_SIZE 20
+#define FABRIC_ADJACENCY_SNAPSHOT_CHUNK 1024
+
+/**
+ * Private function that maps a direction to its rows
+ */
+static inline
+AdjacencyRows *Fabric_AdjacencySnapshot__rows(AdjacencySnapshot *self, int direction) {
+    return &self->rows[FABRIC_DIRECTION_IN == direction ? 1 : 0];
+}
+
+/**
+ * Private function that frees the arrays of one direction
+ */
+static
+void Fabric_AdjacencySnapshot__free_rows(AdjacencyRows *rows, uint32_t num_vertices, uint32_t num_edges) {
+    if (NULL != rows->offsets) {
+        Fabric_memfree_tagged(rows->offsets, sizeof(uint32_t) * (num_vertices + 2), FABRIC_MEM_INDEX);
+    }
+    if (NULL != rows->neighbors) {
+        Fabric_memfree_tagged(rows->neighbors, sizeof(vertexid_t) * num_edges + 1, FABRIC_MEM_INDEX);
+    }
+    if (NULL != rows->edges) {
+        Fabric_memfree_tagged(rows->edges, sizeof(edgeid_t) * num_edges + 1, FABRIC_MEM_INDEX);
+    }
+    rows->offsets = NULL;
+    rows->neighbors = NULL;
+    rows->edges = NULL;
+}
+
+/**
+ * Private function that allocates the arrays of one direction
+ *
+ * Zero length arrays are still allocated so that a NULL array always
+ * means the allocation failed.
+ */
+static
+error_t Fabric_AdjacencySnapshot__alloc_rows(AdjacencyRows *rows, uint32_t num_vertices, uint32_t num_edges) {
+    rows->offsets = Fabric_memalloc_tagged(sizeof(uint32_t) * (num_vertices + 2), FABRIC_MEM_INDEX);
+    rows->neighbors = Fabric_memalloc_tagged(sizeof(vertexid_t) * num_edges + 1, FABRIC_MEM_INDEX);
+    rows->edges = Fabric_memalloc_tagged(sizeof(edgeid_t) * num_edges + 1, FABRIC_MEM_INDEX);
+    if (NULL == rows->offsets || NULL == rows->neighbors || NULL == rows->edges) {
+        error_t status = Fabric_memerrno();
+        Fabric_AdjacencySnapshot__free_rows(rows, num_vertices, num_edges);
+        return status;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Frees a snapshot
+ */
+void Fabric_AdjacencySnapshot_destroy(AdjacencySnapshot *self) {
+    Fabric_AdjacencySnapshot__free_rows(&self->rows[0], self->num_vertices, self->num_edges);
+    Fabric_AdjacencySnapshot__free_rows(&self->rows[1], self->num_vertices, self->num_edges);
+    Fabric_memfree_tagged(self, sizeof(AdjacencySnapshot), FABRIC_MEM_INDEX);
+}
+
+/**
+ * Private function that allocates an empty snapshot
+ */
+static
+AdjacencySnapshot *Fabric_AdjacencySnapshot__new(labelid_t label_id, error_t *status) {
+    AdjacencySnapshot *self = Fabric_memalloc_tagged(sizeof(AdjacencySnapshot), FABRIC_MEM_INDEX);
+    if (NULL == self) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    memset(self, 0, sizeof(AdjacencySnapshot));
+    self->label_id = label_id;
+    self->source_next_id = 1;
+    *status = FABRIC_OK;
+    return self;
+}
+
+/**
+ * Private function that merges new edges into one direction's rows
+ *
+ * The new edges are given as parallel arrays of the vertex owning each
+ * edge in this direction, the vertex at the other end and the edge id.
+ * They must be in ascending id order and have higher ids than the edges
+ * already in the rows.
+ */
+static
+error_t Fabric_AdjacencySnapshot__merge_rows(
+    AdjacencySnapshot *self,
+    int direction,
+    uint32_t num_vertices,
+    uint32_t num_new,
+    vertexid_t *owners,
+    vertexid_t *others,
+    edgeid_t *edge_ids) {
+
+    AdjacencyRows *old_rows = Fabric_AdjacencySnapshot__rows(self, direction);
+    AdjacencyRows new_rows;
+    uint32_t num_edges = self->num_edges + num_new;
+    uint32_t *fill;
+    uint32_t start, degree, i;
+    vertexid_t v;
+    error_t status;
+
+    status = Fabric_AdjacencySnapshot__alloc_rows(&new_rows, num_vertices, num_edges);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    fill = Fabric_memalloc_tagged(sizeof(uint32_t) * (num_vertices + 2), FABRIC_MEM_INDEX);
+    if (NULL == fill) {
+        status = Fabric_memerrno();
+        Fabric_AdjacencySnapshot__free_rows(&new_rows, num_vertices, num_edges);
+        return status;
+    }
+
+    // Count each vertex's edges, old and new, then turn the counts into offsets
+    memset(new_rows.offsets, 0, sizeof(uint32_t) * (num_vertices + 2));
+    for (v = 1; v <= self->num_vertices; v++) {
+        new_rows.offsets[v + 1] = old_rows->offsets[v + 1] - old_rows->offsets[v];
+    }
+    for (i = 0; i < num_new; i++) {
+        new_rows.offsets[owners[i] + 1]++;
+    }
+    for (v = 1; v <= num_vertices; v++) {
+        new_rows.offsets[v + 1] += new_rows.offsets[v];
+    }
+
+    // Old edges keep their order and come before the new edges
+    for (v = 1; v <= num_vertices; v++) {
+        fill[v] = new_rows.offsets[v];
+        if (v <= self->num_vertices) {
+            start = old_rows->offsets[v];
+            degree = old_rows->offsets[v + 1] - start;
+            memcpy(new_rows.neighbors + fill[v], old_rows->neighbors + start, sizeof(vertexid_t) * degree);
+            memcpy(new_rows.edges + fill[v], old_rows->edges + start, sizeof(edgeid_t) * degree);
+            fill[v] += degree;
+        }
+    }
+    for (i = 0; i < num_new; i++) {
+        v = owners[i];
+        new_rows.neighbors[fill[v]] = others[i];
+        new_rows.edges[fill[v]] = edge_ids[i];
+        fill[v]++;
+    }
+
+    Fabric_memfree_tagged(fill, sizeof(uint32_t) * (num_vertices + 2), FABRIC_MEM_INDEX);
+    Fabric_AdjacencySnapshot__free_rows(old_rows, self->num_vertices, self->num_edges);
+    *old_rows = new_rows;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that prefetches the next chunk of edge records
+ *
+ * A chunk stops at the end of the extent holding its first edge.
+ */
+static
+void Fabric_AdjacencySnapshot__prefetch(Graph *graph, EdgeStore *edge_store, edgeid_t edge_id) {
+    uint32_t count;
+
+    if (edge_id > edge_store->extents.capacity) {
+        return;
+    }
+    count = Fabric_ExtentList_get_contiguous(&edge_store->extents, edge_id);
+    if (count > FABRIC_ADJACENCY_SNAPSHOT_CHUNK) {
+        count = FABRIC_ADJACENCY_SNAPSHOT_CHUNK;
+    }
+    // Failing to prefetch only makes the reads slower
+    Fabric_Graph_prefetch(
+        graph,
+        Fabric_ExtentList_get_record_offset(&edge_store->extents, edge_id),
+        count * FABRIC_EDGE_STORAGE_SIZE);
+}
+
+/**
+ * Private function that adds the edges with ids in [first_id, end_id)
+ * to a snapshot
+ */
+static
+error_t Fabric_AdjacencySnapshot__extend(AdjacencySnapshot *self, Graph *graph, edgeid_t first_id, edgeid_t end_id) {
+    EdgeStore *edge_store = Fabric_Graph_get_edge_store(graph);
+    VertexStore *vertex_store = Fabric_Graph_get_vertex_store(graph);
+    uint32_t num_vertices = vertex_store->last_free_id - 1;
+    uint32_t max_new = end_id > first_id ? end_id - first_id : 0;
+    uint32_t num_new = 0;
+    vertexid_t *from_ids, *to_ids;
+    edgeid_t *edge_ids;
+    edgeid_t edge_id;
+    EntityView view;
+    vertexid_t from_id, to_id;
+    error_t status = FABRIC_OK;
+
+    if (num_vertices < self->num_vertices) {
+        num_vertices = self->num_vertices;
+    }
+
+    from_ids = Fabric_memalloc_tagged(sizeof(vertexid_t) * max_new + 1, FABRIC_MEM_INDEX);
+    to_ids = Fabric_memalloc_tagged(sizeof(vertexid_t) * max_new + 1, FABRIC_MEM_INDEX);
+    edge_ids = Fabric_memalloc_tagged(sizeof(edgeid_t) * max_new + 1, FABRIC_MEM_INDEX);
+    if (NULL == from_ids || NULL == to_ids || NULL == edge_ids) {
+        status = Fabric_memerrno();
+        goto done;
+    }
+
+    // The new edges are viewed in file order; only three of their
+    // fields are needed so they are never decoded into edge objects
+    Fabric_EntityView_init(&view);
+    for (edge_id = first_id; edge_id < end_id; edge_id++) {
+        if ((edge_id - first_id) % FABRIC_ADJACENCY_SNAPSHOT_CHUNK == 0) {
+            Fabric_AdjacencySnapshot__prefetch(graph, edge_store, edge_id);
+        }
+        status = Fabric_EdgeStore_view_edge(edge_store, edge_id, &view);
+        if (FABRIC_EDGE_DOESNT_EXIST == status) {
+            continue;
+        } else if (FABRIC_OK != status) {
+            goto done;
+        }
+        if (self->label_id != 0 && Fabric_EdgeView_get_label_id(&view) != self->label_id) {
+            Fabric_EntityView_release(&view);
+            continue;
+        }
+        from_id = Fabric_EdgeView_get_from_vertex_id(&view);
+        to_id = Fabric_EdgeView_get_to_vertex_id(&view);
+        Fabric_EntityView_release(&view);
+        if (from_id > num_vertices || to_id > num_vertices || to_id == 0) {
+            status = FABRIC_ADJACENCY_SNAPSHOT_ERROR;
+            goto done;
+        }
+        from_ids[num_new] = from_id;
+        to_ids[num_new] = to_id;
+        edge_ids[num_new] = edge_id;
+        num_new++;
+    }
+    status = FABRIC_OK;
+
+    if (num_new > 0 || num_vertices > self->num_vertices || NULL == self->rows[0].offsets) {
+        status = Fabric_AdjacencySnapshot__merge_rows(
+            self, FABRIC_DIRECTION_OUT, num_vertices, num_new, from_ids, to_ids, edge_ids);
+        if (FABRIC_OK == status) {
+            status = Fabric_AdjacencySnapshot__merge_rows(
+                self, FABRIC_DIRECTION_IN, num_vertices, num_new, to_ids, from_ids, edge_ids);
+            if (FABRIC_OK != status) {
+                // Keep both directions the same size
+                Fabric_AdjacencySnapshot__free_rows(&self->rows[0], num_vertices, self->num_edges + num_new);
+                Fabric_AdjacencySnapshot__free_rows(&self->rows[1], self->num_vertices, self->num_edges);
+                self->num_vertices = 0;
+                self->num_edges = 0;
+                self->source_num_edges = 0;
+                self->source_next_id = 1;
+            }
+        }
+        if (FABRIC_OK == status) {
+            self->num_vertices = num_vertices;
+            self->num_edges += num_new;
+        }
+    }
+
+done:
+    if (NULL != from_ids) {
+        Fabric_memfree_tagged(from_ids, sizeof(vertexid_t) * max_new + 1, FABRIC_MEM_INDEX);
+    }
+    if (NULL != to_ids) {
+        Fabric_memfree_tagged(to_ids, sizeof(vertexid_t) * max_new + 1, FABRIC_MEM_INDEX);
+    }
+    if (NULL != edge_ids) {
+        Fabric_memfree_tagged(edge_ids, sizeof(edgeid_t) * max_new + 1, FABRIC_MEM_INDEX);
+    }
+    if (FABRIC_OK == status) {
+        self->source_num_edges = edge_store->num_edges;
+        self->source_next_id = end_id;
+    }
+    return status;
+}
+
+/**
+ * Builds a snapshot of a graph's edges
+ *
+ * Changes to edges that have not been flushed are included.
+ *
+ * Args:
+ *      graph: The graph whose edges are copied
+ *      label_id: Only edges with this label are included, or 0 for all edges
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The new snapshot or NULL on failure
+ */
+AdjacencySnapshot *Fabric_AdjacencySnapshot_build(Graph *graph, labelid_t label_id, error_t *status) {
+    EdgeStore *edge_store = Fabric_Graph_get_edge_store(graph);
+    AdjacencySnapshot *self = Fabric_AdjacencySnapshot__new(label_id, status);
+    if (NULL == self) {
+        return NULL;
+    }
+    *status = Fabric_AdjacencySnapshot__extend(self, graph, 1, edge_store->last_free_id);
+    if (FABRIC_OK != *status) {
+        Fabric_AdjacencySnapshot_destroy(self);
+        return NULL;
+    }
+    return self;
+}
+
+/**
+ * Checks whether any edges changed since the snapshot was last refreshed
+ *
+ * Returns: TRUE if the snapshot matches the graph's edge store
+ */
+bool_t Fabric_AdjacencySnapshot_is_current(AdjacencySnapshot *self, Graph *graph) {
+    EdgeStore *edge_store = Fabric_Graph_get_edge_store(graph);
+    return self->source_num_edges == edge_store->num_edges &&
+        self->source_next_id == edge_store->last_free_id;
+}
+
+/**
+ * Brings a snapshot up to date with its graph's edge store
+ *
+ * If every edge created since the last refresh has a never used id, only
+ * those edges are read and merged into the snapshot.  Otherwise edges
+ * were deleted or ids were reused and the snapshot is rebuilt.
+ *
+ * Returns: FABRIC_OK on success, other error code on failure.  The
+ *          snapshot is left empty if a rebuild fails.
+ */
+error_t Fabric_AdjacencySnapshot_refresh(AdjacencySnapshot *self, Graph *graph) {
+    EdgeStore *edge_store = Fabric_Graph_get_edge_store(graph);
+
+    if (Fabric_AdjacencySnapshot_is_current(self, graph)) {
+        return FABRIC_OK;
+    }
+
+    if (edge_store->last_free_id >= self->source_next_id &&
+        edge_store->num_edges - self->source_num_edges == edge_store->last_free_id - self->source_next_id) {
+        return Fabric_AdjacencySnapshot__extend(self, graph, self->source_next_id, edge_store->last_free_id);
+    }
+
+    Fabric_AdjacencySnapshot__free_rows(&self->rows[0], self->num_vertices, self->num_edges);
+    Fabric_AdjacencySnapshot__free_rows(&self->rows[1], self->num_vertices, self->num_edges);
+    self->num_vertices = 0;
+    self->num_edges = 0;
+    return Fabric_AdjacencySnapshot__extend(self, graph, 1, edge_store->last_free_id);
+}
+
+/**
+ * Returns the highest vertex id a snapshot covers
+ */
+uint32_t Fabric_AdjacencySnapshot_get_vertex_count(AdjacencySnapshot *self) {
+    return self->num_vertices;
+}
+
+/**
+ * Returns the number of edges of a vertex in a direction
+ *
+ * Vertices the snapshot doesn't cover have no edges.
+ */
+uint32_t Fabric_AdjacencySnapshot_get_degree(AdjacencySnapshot *self, vertexid_t vertex_id, int direction) {
+    AdjacencyRows *rows = Fabric_AdjacencySnapshot__rows(self, direction);
+    if (vertex_id < 1 || vertex_id > self->num_vertices) {
+        return 0;
+    }
+    return rows->offsets[vertex_id + 1] - rows->offsets[vertex_id];
+}
+
+/**
+ * Returns the ids of the vertices at the other end of a vertex's edges
+ *
+ * Args:
+ *      self: The snapshot
+ *      vertex_id: The vertex whose neighbors are returned
+ *      direction: FABRIC_DIRECTION_OUT or FABRIC_DIRECTION_IN
+ *      count: Where the number of neighbors is stored
+ *
+ * Returns: A pointer into the snapshot valid until it is refreshed or destroyed
+ */
+vertexid_t *Fabric_AdjacencySnapshot_get_neighbors(
+    AdjacencySnapshot *self, vertexid_t vertex_id, int direction, uint32_t *count) {
+    AdjacencyRows *rows = Fabric_AdjacencySnapshot__rows(self, direction);
+    *count = Fabric_AdjacencySnapshot_get_degree(self, vertex_id, direction);
+    if (0 == *count) {
+        return NULL;
+    }
+    return rows->neighbors + rows->offsets[vertex_id];
+}
+
+/**
+ * Returns the ids of a vertex's edges in the same order as its neighbors
+ *
+ * Returns: A pointer into the snapshot valid until it is refreshed or destroyed
+ */
+edgeid_t *Fabric_AdjacencySnapshot_get_edge_ids(
+    AdjacencySnapshot *self, vertexid_t vertex_id, int direction, uint32_t *count) {
+    AdjacencyRows *rows = Fabric_AdjacencySnapshot__rows(self, direction);
+    *count = Fabric_AdjacencySnapshot_get_degree(self, vertex_id, direction);
+    if (0 == *count) {
+        return NULL;
+    }
+    return rows->edges + rows->offsets[vertex_id];
+}
+
+/**
+ * Private function that writes an array of integers in the graph's byte order
+ *
+ * Chunks already in the right order are written as they are; otherwise
+ * they are swapped into a buffer first.
+ */
+static
+error_t Fabric_AdjacencySnapshot__write_array(Graph *graph, uint32_t *values, uint32_t count, long offset) {
+    uint8_t buffer[FABRIC_ADJACENCY_SNAPSHOT_CHUNK * sizeof(uint32_t)];
+    int byte_order = Fabric_Graph_get_byte_order(graph);
+    uint32_t chunk;
+    error_t status;
+
+    while (count > 0) {
+        chunk = count < FABRIC_ADJACENCY_SNAPSHOT_CHUNK ? count : FABRIC_ADJACENCY_SNAPSHOT_CHUNK;
+        if (FABRIC_BYTE_ORDER_HOST == byte_order) {
+            status = Fabric_Graph_write_bytes(graph, (uint8_t*)values, chunk * sizeof(uint32_t), offset);
+        } else {
+            Fabric_ByteSwap_copy32(buffer, values, chunk, byte_order);
+            status = Fabric_Graph_write_bytes(graph, buffer, chunk * sizeof(uint32_t), offset);
+        }
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        values += chunk;
+        offset += chunk * sizeof(uint32_t);
+        count -= chunk;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that reads an array of integers in the graph's byte order
+ *
+ * Each chunk is read straight into place and swapped there if it needs to be.
+ */
+static
+error_t Fabric_AdjacencySnapshot__read_array(Graph *graph, uint32_t *values, uint32_t count, long offset) {
+    int byte_order = Fabric_Graph_get_byte_order(graph);
+    uint32_t chunk;
+    error_t status;
+
+    while (count > 0) {
+        chunk = count < FABRIC_ADJACENCY_SNAPSHOT_CHUNK ? count : FABRIC_ADJACENCY_SNAPSHOT_CHUNK;
+        status = Fabric_Graph_read_bytes(graph, (uint8_t*)values, chunk * sizeof(uint32_t), offset);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        Fabric_ByteSwap_copy32(values, values, chunk, byte_order);
+        values += chunk;
+        offset += chunk * sizeof(uint32_t);
+        count -= chunk;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that returns the size of a snapshot section
+ */
+static inline
+uint32_t Fabric_AdjacencySnapshot__section_size(uint32_t num_vertices, uint32_t num_edges) {
+    return FABRIC_ADJACENCY_SNAPSHOT_HEADER_SIZE + 2 * (
+        sizeof(uint32_t) * (num_vertices + 2) +
+        (sizeof(vertexid_t) + sizeof(edgeid_t)) * num_edges);
+}
+
+/**
+ * Returns the size of the snapshot section saved in a graph's file
+ *
+ * Returns: The size in bytes or 0 if the file has no snapshot
+ */
+uint32_t Fabric_AdjacencySnapshot_get_saved_size(Graph *graph) {
+    uint32_t offset = Fabric_Graph_get_adjacency_snapshot_offset(graph);
+    uint32_t header[5];
+
+    if (0 == offset || FABRIC_OK != Fabric_AdjacencySnapshot__read_array(graph, header, 5, offset)) {
+        return 0;
+    }
+    return Fabric_AdjacencySnapshot__section_size(header[1], header[2]);
+}
+
+/**
+ * Saves a snapshot as the graph file's snapshot section
+ *
+ * Any snapshot already saved in the file is replaced.  The section is
+ * rewritten in place when the new snapshot fits, otherwise it is
+ * allocated at the end of the file.
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_AdjacencySnapshot_save(AdjacencySnapshot *self, Graph *graph) {
+    uint32_t header[5];
+    uint32_t offset = Fabric_Graph_get_adjacency_snapshot_offset(graph);
+    uint32_t size = Fabric_AdjacencySnapshot__section_size(self->num_vertices, self->num_edges);
+    uint32_t position;
+    error_t status;
+    int i;
+
+    if (0 == offset || Fabric_AdjacencySnapshot_get_saved_size(graph) < size) {
+        offset = Fabric_Graph_allocate(graph, size, &status);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
+    position = offset;
+
+    header[0] = self->label_id;
+    header[1] = self->num_vertices;
+    header[2] = self->num_edges;
+    header[3] = self->source_num_edges;
+    header[4] = self->source_next_id;
+
+    status = Fabric_AdjacencySnapshot__write_array(graph, header, 5, position);
+    position += FABRIC_ADJACENCY_SNAPSHOT_HEADER_SIZE;
+    for (i = 0; i < 2 && FABRIC_OK == status; i++) {
+        status = Fabric_AdjacencySnapshot__write_array(graph, self->rows[i].offsets, self->num_vertices + 2, position);
+        position += sizeof(uint32_t) * (self->num_vertices + 2);
+        if (FABRIC_OK == status) {
+            status = Fabric_AdjacencySnapshot__write_array(graph, self->rows[i].neighbors, self->num_edges, position);
+            position += sizeof(vertexid_t) * self->num_edges;
+        }
+        if (FABRIC_OK == status) {
+            status = Fabric_AdjacencySnapshot__write_array(graph, self->rows[i].edges, self->num_edges, position);
+            position += sizeof(edgeid_t) * self->num_edges;
+        }
+    }
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    Fabric_Graph_set_adjacency_snapshot_offset(graph, offset);
+    return FABRIC_OK;
+}
+
+/**
+ * Loads the snapshot saved in a graph's file
+ *
+ * The snapshot may be older than the graph's edges.  Use
+ * Fabric_AdjacencySnapshot_refresh(2) to bring it up to date.
+ *
+ * Args:
+ *      graph: The graph whose snapshot is loaded
+ *      status: A pointer to where an error can be indicated.  It is set
+ *              to FABRIC_ADJACENCY_SNAPSHOT_MISSING if the file has no snapshot.
+ *
+ * Returns: The loaded snapshot or NULL on failure
+ */
+AdjacencySnapshot *Fabric_AdjacencySnapshot_load(Graph *graph, error_t *status) {
+    uint32_t offset = Fabric_Graph_get_adjacency_snapshot_offset(graph);
+    uint32_t header[5];
+    AdjacencySnapshot *self;
+    int i;
+
+    if (0 == offset) {
+        *status = FABRIC_ADJACENCY_SNAPSHOT_MISSING;
+        return NULL;
+    }
+
+    *status = Fabric_AdjacencySnapshot__read_array(graph, header, 5, offset);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    self = Fabric_AdjacencySnapshot__new(header[0], status);
+    if (NULL == self) {
+        return NULL;
+    }
+
+    offset += FABRIC_ADJACENCY_SNAPSHOT_HEADER_SIZE;
+    for (i = 0; i < 2; i++) {
+        *status = Fabric_AdjacencySnapshot__alloc_rows(&self->rows[i], header[1], header[2]);
+        if (FABRIC_OK != *status) {
+            break;
+        }
+        // Record the sizes as soon as there is something to free
+        self->num_vertices = header[1];
+        self->num_edges = header[2];
+        *status = Fabric_AdjacencySnapshot__read_array(graph, self->rows[i].offsets, header[1] + 2, offset);
+        offset += sizeof(uint32_t) * (header[1] + 2);
+        if (FABRIC_OK == *status) {
+            *status = Fabric_AdjacencySnapshot__read_array(graph, self->rows[i].neighbors, header[2], offset);
+            offset += sizeof(vertexid_t) * header[2];
+        }
+        if (FABRIC_OK == *status) {
+            *status = Fabric_AdjacencySnapshot__read_array(graph, self->rows[i].edges, header[2], offset);
+            offset += sizeof(edgeid_t) * header[2];
+        }
+        if (FABRIC_OK != *status) {
+            break;
+        }
+    }
+    if (FABRIC_OK != *status) {
+        Fabric_AdjacencySnapshot_destroy(self);
+        return NULL;
+    }
+
+    self->source_num_edges = header[3];
+    self->source_next_id = header[4];
+    return self;
+}
+
+/**
+ * Removes the saved snapshot from a graph's file
+ *
+ * The space used by the section is not reclaimed.
+ */
+void Fabric_AdjacencySnapshot_drop(Graph *graph) {
+    Fabric_Graph_set_adjacency_snapshot_offset(graph, 0);
+}
+
+#endif
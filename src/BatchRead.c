@@ -0,0 +1,265 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_BATCHREAD_C__
+#define _FABRIC_BATCHREAD_C__
+
+#include "Internal.h"
+
+/**
+ * Batched reads look up many vertices, edges or properties by id at once.
+ *
+ * Entities found in their store's cache are copied straight away, since
+ * a cached entity may have changes not yet written to the file.  The
+ * rest are read together with Fabric_Graph_read_records(5), which reads
+ * them in file order, reads a repeated id once and has the reads of all
+ * their pages in flight before it waits on any of them.  The entities
+ * read are not added to the cache, so a large batch doesn't evict the
+ * entities the cache already holds.
+ *
+ * The results are copies owned by the caller, one for each id in the
+ * order of the ids.  These functions live apart from their stores since
+ * the results are arrays of entity objects.
+ */
+typedef struct BatchRead {
+    uint32_t num_misses;        // The number of ids not found in the cache
+    uint32_t capacity;          // The number of misses there is room for
+    uint32_t record_size;       // The size of a record of the store being read
+    uint32_t *ids;              // The id of each miss
+    uint32_t *positions;        // The position in the batch of each miss
+    uint8_t *records;           // The record read for each miss
+} BatchRead;
+
+/**
+ * Private function that initializes an empty batch
+ */
+static
+void Fabric_BatchRead__init(BatchRead *self, uint32_t record_size) {
+    self->num_misses = 0;
+    self->capacity = 0;
+    self->record_size = record_size;
+    self->ids = NULL;
+    self->positions = NULL;
+    self->records = NULL;
+}
+
+/**
+ * Private function that frees a batch's misses
+ */
+static
+void Fabric_BatchRead__deinit(BatchRead *self) {
+    if (NULL != self->ids) {
+        Fabric_memfree(self->ids, self->capacity * (2 * sizeof(uint32_t) + self->record_size));
+        self->ids = NULL;
+    }
+}
+
+/**
+ * Private function that adds an id that isn't cached to a batch
+ *
+ * Room is made on the first miss for every id left in the batch, so a
+ * batch that is found in the cache allocates nothing.
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+static
+error_t Fabric_BatchRead__add_miss(BatchRead *self, uint32_t id, uint32_t position, uint32_t remaining) {
+    if (NULL == self->ids) {
+        self->ids = Fabric_memalloc(remaining * (2 * sizeof(uint32_t) + self->record_size));
+        if (NULL == self->ids) {
+            return Fabric_memerrno();
+        }
+        self->capacity = remaining;
+        self->positions = self->ids + remaining;
+        self->records = (uint8_t*)(self->positions + remaining);
+    }
+    self->ids[self->num_misses] = id;
+    self->positions[self->num_misses] = position;
+    self->num_misses++;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that reads the records of a batch's misses
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+static
+error_t Fabric_BatchRead__fetch(BatchRead *self, Graph *graph, ExtentList *extents, int store) {
+    if (self->num_misses == 0) {
+        return FABRIC_OK;
+    }
+    Fabric_stats_add(FABRIC_STAT_RECORDS_READ + store, self->num_misses);
+    return Fabric_Graph_read_records(graph, self->ids, self->num_misses, extents, self->records);
+}
+
+/**
+ * Reads a batch of vertices by id
+ *
+ * Args:
+ *      self: A graph's vertex store
+ *      vertex_ids: The ids of the vertices; they may be in any order and repeat
+ *      count: The number of ids
+ *      vertices: Where the vertices are copied, one for each id
+ *
+ * Returns: FABRIC_OK if every vertex was read.  Otherwise the error of a
+ *          vertex that couldn't be read, such as FABRIC_VERTEX_DOESNT_EXIST,
+ *          and the id of each vertex that couldn't be read is set to 0.
+ */
+error_t Fabric_VertexStore_read_vertices(VertexStore *self, const vertexid_t *vertex_ids, uint32_t count, Vertex *vertices) {
+    BatchRead batch;
+    Vertex *cached;
+    error_t status, result = FABRIC_OK;
+    uint32_t i;
+
+    Fabric_BatchRead__init(&batch, FABRIC_VERTEX_STORAGE_SIZE);
+    for (i = 0; i < count; i++) {
+        cached = Fabric_EntityCache_get(self->cache, vertex_ids[i]);
+        if (cached) {
+            vertices[i] = *cached;
+        } else if (vertex_ids[i] < 1 || vertex_ids[i] > self->extents.capacity) {
+            Fabric_Vertex_set_id(&vertices[i], 0);
+            result = FABRIC_VERTEXSTORE_INVALID_ID;
+        } else if (FABRIC_OK != (status = Fabric_BatchRead__add_miss(&batch, vertex_ids[i], i, count - i))) {
+            Fabric_BatchRead__deinit(&batch);
+            return status;
+        }
+    }
+
+    status = Fabric_BatchRead__fetch(&batch, Fabric_VertexStore_get_graph(self),
+        &self->extents, FABRIC_STATS_VERTEX_STORE);
+    for (i = 0; i < batch.num_misses; i++) {
+        Fabric_Vertex_set_id(&vertices[batch.positions[i]], batch.ids[i]);
+        Fabric_Vertex_init(&vertices[batch.positions[i]], batch.records + i * FABRIC_VERTEX_STORAGE_SIZE);
+    }
+    Fabric_BatchRead__deinit(&batch);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    // if its class id is 0 then it is not in use
+    for (i = 0; i < count; i++) {
+        if (Fabric_Vertex_get_id(&vertices[i]) != 0 && !Fabric_Vertex_is_in_use(&vertices[i])) {
+            Fabric_Vertex_set_id(&vertices[i], 0);
+            result = FABRIC_VERTEX_DOESNT_EXIST;
+        }
+    }
+    return result;
+}
+
+/**
+ * Reads a batch of edges by id
+ *
+ * Args:
+ *      self: A graph's edge store
+ *      edge_ids: The ids of the edges; they may be in any order and repeat
+ *      count: The number of ids
+ *      edges: Where the edges are copied, one for each id
+ *
+ * Returns: FABRIC_OK if every edge was read.  Otherwise the error of an
+ *          edge that couldn't be read, such as FABRIC_EDGE_DOESNT_EXIST,
+ *          and the id of each edge that couldn't be read is set to 0.
+ */
+error_t Fabric_EdgeStore_read_edges(EdgeStore *self, const edgeid_t *edge_ids, uint32_t count, Edge *edges) {
+    BatchRead batch;
+    Edge *cached;
+    error_t status, result = FABRIC_OK;
+    uint32_t i;
+
+    Fabric_BatchRead__init(&batch, FABRIC_EDGE_STORAGE_SIZE);
+    for (i = 0; i < count; i++) {
+        cached = Fabric_EntityCache_get(self->cache, edge_ids[i]);
+        if (cached) {
+            edges[i] = *cached;
+        } else if (edge_ids[i] < 1 || edge_ids[i] > self->extents.capacity) {
+            Fabric_Edge_set_id(&edges[i], 0);
+            result = FABRIC_EDGESTORE_INVALID_ID;
+        } else if (FABRIC_OK != (status = Fabric_BatchRead__add_miss(&batch, edge_ids[i], i, count - i))) {
+            Fabric_BatchRead__deinit(&batch);
+            return status;
+        }
+    }
+
+    status = Fabric_BatchRead__fetch(&batch, Fabric_EdgeStore_get_graph(self),
+        &self->extents, FABRIC_STATS_EDGE_STORE);
+    for (i = 0; i < batch.num_misses; i++) {
+        Fabric_Edge_set_id(&edges[batch.positions[i]], batch.ids[i]);
+        Fabric_Edge_init(&edges[batch.positions[i]], batch.records + i * FABRIC_EDGE_STORAGE_SIZE);
+    }
+    Fabric_BatchRead__deinit(&batch);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (Fabric_Edge_get_id(&edges[i]) != 0 && !Fabric_Edge_is_in_use(&edges[i])) {
+            Fabric_Edge_set_id(&edges[i], 0);
+            result = FABRIC_EDGE_DOESNT_EXIST;
+        }
+    }
+    return result;
+}
+
+/**
+ * Reads a batch of properties by id
+ *
+ * Args:
+ *      self: A graph's property store
+ *      property_ids: The ids of the properties; they may be in any order
+ *                    and repeat
+ *      count: The number of ids
+ *      properties: Where the properties are copied, one for each id
+ *
+ * Returns: FABRIC_OK if every property was read.  Otherwise the error of
+ *          a property that couldn't be read, such as
+ *          FABRIC_PROPERTY_DOESNT_EXIST, and the id of each property that
+ *          couldn't be read is set to 0.
+ */
+error_t Fabric_PropertyStore_read_properties(PropertyStore *self, const propertyid_t *property_ids, uint32_t count, Property *properties) {
+    BatchRead batch;
+    Property *cached;
+    error_t status, result = FABRIC_OK;
+    uint32_t i;
+
+    Fabric_BatchRead__init(&batch, FABRIC_PROPERTY_STORAGE_SIZE);
+    for (i = 0; i < count; i++) {
+        cached = Fabric_EntityCache_get(self->cache, property_ids[i]);
+        if (cached) {
+            properties[i] = *cached;
+        } else if (property_ids[i] < 1 || property_ids[i] > self->extents.capacity) {
+            Fabric_Property_set_id(&properties[i], 0);
+            result = FABRIC_PROPERTYSTORE_INVALID_ID;
+        } else if (FABRIC_OK != (status = Fabric_BatchRead__add_miss(&batch, property_ids[i], i, count - i))) {
+            Fabric_BatchRead__deinit(&batch);
+            return status;
+        }
+    }
+
+    status = Fabric_BatchRead__fetch(&batch, Fabric_PropertyStore_get_graph(self),
+        &self->extents, FABRIC_STATS_PROPERTY_STORE);
+    for (i = 0; i < batch.num_misses; i++) {
+        Fabric_Property_set_id(&properties[batch.positions[i]], batch.ids[i]);
+        Fabric_Property_init(&properties[batch.positions[i]], batch.records + i * FABRIC_PROPERTY_STORAGE_SIZE);
+    }
+    Fabric_BatchRead__deinit(&batch);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    // Deleted properties have no type
+    for (i = 0; i < count; i++) {
+        if (Fabric_Property_get_id(&properties[i]) != 0 &&
+                FABRIC_PROPTYPE_NOTHING == Fabric_Property_get_type(&properties[i])) {
+            Fabric_Property_set_id(&properties[i], 0);
+            result = FABRIC_PROPERTY_DOESNT_EXIST;
+        }
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,865 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+/**
+ * Micro and macro benchmarks for the FabricDB library
+ *
+ * Like TestAll.c this is a unity build of the whole library.  Build it with
+ * optimizations and run it from a directory where scratch graph files can
+ * be written:
+ *
+ *      gcc -std=gnu99 -O2 -o bench Benchmark.c -lpthread -lm
+ *      ./bench [-q] [-f text|csv|json] [filter]
+ *
+ * The microbenchmarks time single hot paths: Fabric_Graph_read_bytes(4),
+ * IdSet and EntityMap lookups, fetching and flushing classes and walking a
+ * class's descendents.  The macrobenchmarks generate whole graphs: a graph
+ * whose degrees follow a power law, a deep class hierarchy, vertices
+ * with long property chains and a stream of small logged writes that are
+ * committed one at a time or in write batches.
+ *
+ * Each benchmark times its operations in batches.  The latency of a batch
+ * is the mean latency of its operations, and the p50 and p99 latencies are
+ * taken over the batches.  The I/O bytes are those the graph's buffer pool
+ * read from and wrote to the file while the benchmark ran.  Results are
+ * printed as a table, or as CSV or JSON for scripts to compare runs.  -q
+ * runs every benchmark on a tenth of the data, and a filter only runs the
+ * benchmarks whose names contain it.
+ */
+
+// Fabric.c comes first so that its byte order macros aren't redefined
+#include "Fabric.c"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define BENCH_MAX_SAMPLES 8192
+#define BENCH_BATCH 64
+#define BENCH_LOOKUP_BATCH 1024
+#define BENCH_WRITE_BATCH 64
+#define BENCH_FLUSH_INTERVAL 4096
+
+#define BENCH_FORMAT_TEXT 0
+#define BENCH_FORMAT_CSV 1
+#define BENCH_FORMAT_JSON 2
+
+typedef struct Bench {
+    const char *name;                   // The name the benchmark is reported under
+    Graph *graph;                       // The graph whose I/O is counted or NULL
+    uint64_t ops;                       // The number of operations timed
+    double elapsed;                     // The seconds spent in timed batches
+    struct timespec started;            // When the current batch started
+    uint64_t bytes_read;                // The pool's bytes read when the benchmark began
+    uint64_t bytes_written;             // The pool's bytes written when the benchmark began
+    uint32_t num_samples;               // The number of batch latencies kept
+    double samples[BENCH_MAX_SAMPLES];  // The nanoseconds per operation of each batch
+} Bench;
+
+static int bench_format = BENCH_FORMAT_TEXT;
+static double bench_scale = 1.0;
+static const char *bench_filter = NULL;
+static int bench_reported = 0;
+static uint32_t bench_random_state = 2463534242u;
+static Bench bench;
+
+/**
+ * Returns the next value of a xorshift generator, so that every run
+ * generates the same graphs
+ */
+static
+uint32_t bench_random() {
+    bench_random_state ^= bench_random_state << 13;
+    bench_random_state ^= bench_random_state >> 17;
+    bench_random_state ^= bench_random_state << 5;
+    return bench_random_state;
+}
+
+/**
+ * Returns a number of items scaled down by -q, but never less than one
+ */
+static
+uint32_t bench_size(uint32_t size) {
+    uint32_t scaled = (uint32_t)(size * bench_scale);
+    return scaled > 0 ? scaled : 1;
+}
+
+/**
+ * Returns an id from 1 to max where small ids are far more likely than
+ * large ones, so that the ids' frequencies roughly follow a power law
+ */
+static
+uint32_t bench_skewed(uint32_t max) {
+    double u = (bench_random() + 0.5) / 4294967296.0;
+    uint32_t id = 1 + (uint32_t)(max * u * u * u);
+    return id > max ? max : id;
+}
+
+static
+double bench_seconds(struct timespec *from, struct timespec *to) {
+    return (double)(to->tv_sec - from->tv_sec) + (to->tv_nsec - from->tv_nsec) / 1e9;
+}
+
+/**
+ * Starts a benchmark, returning FALSE if the filter leaves it out
+ */
+static
+bool_t bench_start(const char *name, Graph *graph) {
+    if (NULL != bench_filter && NULL == strstr(name, bench_filter)) {
+        return FALSE;
+    }
+    bench.name = name;
+    bench.graph = graph;
+    bench.ops = 0;
+    bench.elapsed = 0;
+    bench.num_samples = 0;
+    if (NULL != graph) {
+        bench.bytes_read = Fabric_BufferPool_get_bytes_read(&graph->buffer_pool);
+        bench.bytes_written = Fabric_BufferPool_get_bytes_written(&graph->buffer_pool);
+    }
+    return TRUE;
+}
+
+static
+void bench_begin() {
+    clock_gettime(CLOCK_MONOTONIC, &bench.started);
+}
+
+/**
+ * Ends a batch of operations that began with bench_begin()
+ */
+static
+void bench_end(uint64_t ops) {
+    struct timespec now;
+    double seconds;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    seconds = bench_seconds(&bench.started, &now);
+    if (0 == ops) {
+        return;
+    }
+    bench.elapsed += seconds;
+    bench.ops += ops;
+    if (bench.num_samples < BENCH_MAX_SAMPLES) {
+        bench.samples[bench.num_samples++] = seconds * 1e9 / ops;
+    }
+}
+
+static
+int bench_compare_samples(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return x < y ? -1 : x > y;
+}
+
+static
+double bench_percentile(double percentile) {
+    uint32_t i = (uint32_t)(percentile * (bench.num_samples - 1) + 0.5);
+    return bench.num_samples > 0 ? bench.samples[i] : 0;
+}
+
+/**
+ * Reports the benchmark in the chosen format
+ */
+static
+void bench_finish() {
+    uint64_t bytes_read = 0, bytes_written = 0;
+    double ops_per_sec, p50, p99;
+
+    if (NULL != bench.graph) {
+        bytes_read = Fabric_BufferPool_get_bytes_read(&bench.graph->buffer_pool) - bench.bytes_read;
+        bytes_written = Fabric_BufferPool_get_bytes_written(&bench.graph->buffer_pool) - bench.bytes_written;
+    }
+    qsort(bench.samples, bench.num_samples, sizeof(double), bench_compare_samples);
+    p50 = bench_percentile(0.50);
+    p99 = bench_percentile(0.99);
+    ops_per_sec = bench.elapsed > 0 ? bench.ops / bench.elapsed : 0;
+
+    if (BENCH_FORMAT_CSV == bench_format) {
+        printf("%s,%llu,%.6f,%.1f,%.1f,%.1f,%llu,%llu\n", bench.name, (unsigned long long)bench.ops,
+            bench.elapsed, ops_per_sec, p50, p99, (unsigned long long)bytes_read, (unsigned long long)bytes_written);
+    } else if (BENCH_FORMAT_JSON == bench_format) {
+        printf("%s  {\"name\": \"%s\", \"ops\": %llu, \"seconds\": %.6f, \"ops_per_sec\": %.1f, "
+            "\"p50_ns\": %.1f, \"p99_ns\": %.1f, \"bytes_read\": %llu, \"bytes_written\": %llu}",
+            bench_reported > 0 ? ",\n" : "", bench.name, (unsigned long long)bench.ops, bench.elapsed,
+            ops_per_sec, p50, p99, (unsigned long long)bytes_read, (unsigned long long)bytes_written);
+    } else {
+        printf("%-36s %10llu %14.0f %10.1f %10.1f %12llu %12llu\n", bench.name, (unsigned long long)bench.ops,
+            ops_per_sec, p50, p99, (unsigned long long)bytes_read, (unsigned long long)bytes_written);
+    }
+    fflush(stdout);
+    bench_reported++;
+}
+
+static
+void bench_check(error_t status, const char *what) {
+    if (FABRIC_OK != status) {
+        fprintf(stderr, "%s failed with error %d\n", what, (int)status);
+        exit(1);
+    }
+}
+
+/**
+ * Creates an empty graph in a scratch file
+ */
+static
+FILE *bench_create_graph(const char *file_name, Graph *graph) {
+    FILE *file = fopen(file_name, "w+b");
+    if (NULL == file) {
+        fprintf(stderr, "Couldn't create %s\n", file_name);
+        exit(1);
+    }
+    Fabric_create_graph(file, graph);
+    Fabric_close_graph(graph);
+    Fabric_load_graph(file, graph);
+    return file;
+}
+
+/**
+ * Flushes the changes held by a graph's stores to the graph
+ *
+ * The stores can't evict changed entities from their caches, so the
+ * benchmarks that make many changes flush every BENCH_FLUSH_INTERVAL
+ * changes, as an application committing its changes would.
+ */
+static
+void bench_flush_stores(Graph *graph) {
+    bench_check(Fabric_ClassStore_flush(&graph->class_store), "Flushing the classes");
+    bench_check(Fabric_LabelStore_flush(&graph->label_store), "Flushing the labels");
+    bench_check(Fabric_VertexStore_flush(&graph->vertex_store), "Flushing the vertices");
+    bench_check(Fabric_EdgeStore_flush(&graph->edge_store), "Flushing the edges");
+    bench_check(Fabric_PropertyStore_flush(&graph->property_store), "Flushing the properties");
+}
+
+/**
+ * Writes a graph's changes to its file and loads it again, so that
+ * nothing is left in its caches
+ */
+static
+void bench_reload_graph(FILE *file, Graph *graph) {
+    bench_flush_stores(graph);
+    Fabric_close_graph(graph);
+    Fabric_load_graph(file, graph);
+}
+
+static
+void bench_remove_graph(const char *file_name, FILE *file, Graph *graph) {
+    Fabric_close_graph(graph);
+    fclose(file);
+    remove(file_name);
+}
+
+/**
+ * Adds a class to a graph without a name
+ */
+static
+Class *bench_add_class(Graph *graph, classid_t class_id) {
+    uint8_t data[FABRIC_CLASS_STORAGE_SIZE];
+    error_t status;
+    Class *c = Fabric_Class_new(class_id, &status);
+
+    bench_check(status, "Creating a class");
+    memset(data, 0, sizeof(data));
+    Fabric_Class_init(c, data);
+    bench_check(Fabric_ClassStore_update_class(&graph->class_store, c), "Adding a class");
+    return c;
+}
+
+/**
+ * Adds vertices of a class to a graph
+ */
+static
+void bench_add_vertices(Graph *graph, Class *c, uint32_t count) {
+    error_t status;
+    uint32_t i;
+
+    for (i = 1; i <= count; i++) {
+        Fabric_VertexStore_create_vertex(&graph->vertex_store, c, &status);
+        bench_check(status, "Creating a vertex");
+        if (0 == i % BENCH_FLUSH_INTERVAL) {
+            bench_flush_stores(graph);
+        }
+    }
+}
+
+static
+Vertex *bench_get_vertex(Graph *graph, vertexid_t vertex_id) {
+    error_t status;
+    Vertex *v = Fabric_VertexStore_get_vertex(&graph->vertex_store, vertex_id, &status);
+    bench_check(status, "Getting a vertex");
+    return v;
+}
+
+/**
+ * Walks the out edges of frontiers of random vertices from a cold graph,
+ * optionally prefetching each frontier's first edges before walking it
+ */
+static
+void bench_iterate_frontiers(FILE *file, Graph *graph, const char *name, uint32_t vertices, bool_t prefetch) {
+    vertexid_t frontier[BENCH_BATCH];
+    EdgeIterator iterator;
+    uint32_t i, j, visited;
+    error_t status;
+
+    // Both walks start cold and see the same frontiers
+    bench_reload_graph(file, graph);
+    bench_random_state = 2463534242u;
+    if (!bench_start(name, graph)) {
+        return;
+    }
+    for (i = 0; i < vertices; i += BENCH_BATCH) {
+        for (j = 0; j < BENCH_BATCH; j++) {
+            frontier[j] = 1 + bench_random() % vertices;
+        }
+        visited = 0;
+        bench_begin();
+        if (prefetch) {
+            bench_check(Fabric_EdgeIterator_prefetch_frontier(graph, frontier, BENCH_BATCH, FABRIC_DIRECTION_OUT),
+                "Prefetching a frontier");
+        }
+        for (j = 0; j < BENCH_BATCH; j++) {
+            Fabric_EdgeIterator_init(&iterator, graph, bench_get_vertex(graph, frontier[j]), FABRIC_DIRECTION_OUT);
+            while (NULL != Fabric_EdgeIterator_next(&iterator, &status)) {
+                visited++;
+            }
+        }
+        bench_end(visited);
+    }
+    bench_finish();
+}
+
+/**
+ * Reads a graph file in small pieces, first in order and then at random
+ */
+static
+void bench_read_bytes() {
+    char *file_name = "bench_read_bytes.fdb";
+    uint8_t buffer[32];
+    Graph graph;
+    FILE *file;
+    long size, offset;
+    uint32_t i, j, reads = bench_size(200000);
+
+    file = bench_create_graph(file_name, &graph);
+    bench_add_vertices(&graph, bench_add_class(&graph, 1), bench_size(100000));
+    bench_reload_graph(file, &graph);
+    fseek(file, 0, SEEK_END);
+    size = ftell(file) - sizeof(buffer);
+
+    if (bench_start("graph_read_bytes/sequential", &graph)) {
+        for (offset = 0; offset < size; ) {
+            bench_begin();
+            for (j = 0; j < BENCH_BATCH && offset < size; j++, offset += sizeof(buffer)) {
+                Fabric_Graph_read_bytes(&graph, buffer, sizeof(buffer), offset);
+            }
+            bench_end(j);
+        }
+        bench_finish();
+    }
+    if (bench_start("graph_read_bytes/random", &graph)) {
+        for (i = 0; i < reads; i += BENCH_BATCH) {
+            bench_begin();
+            for (j = 0; j < BENCH_BATCH; j++) {
+                Fabric_Graph_read_bytes(&graph, buffer, sizeof(buffer), bench_random() % size);
+            }
+            bench_end(j);
+        }
+        bench_finish();
+    }
+    bench_remove_graph(file_name, file, &graph);
+}
+
+/**
+ * Adds ids to a set and looks up ids that are and aren't in it
+ */
+static
+void bench_id_set() {
+    uint32_t i, j, count = bench_size(1000000);
+    IdSet *set;
+    error_t status;
+
+    set = Fabric_IdSet_new(&status);
+    bench_check(status, "Creating an id set");
+    if (bench_start("idset/add", NULL)) {
+        for (i = 0; i < count; i += BENCH_BATCH) {
+            bench_begin();
+            for (j = i; j < i + BENCH_BATCH; j++) {
+                Fabric_IdSet_add(set, j * 2654435761u | 1);
+            }
+            bench_end(BENCH_BATCH);
+        }
+        bench_finish();
+    }
+    if (bench_start("idset/has_hit", NULL)) {
+        for (i = 0; i < count; i += BENCH_BATCH) {
+            bench_begin();
+            for (j = i; j < i + BENCH_BATCH; j++) {
+                Fabric_IdSet_has(set, j * 2654435761u | 1);
+            }
+            bench_end(BENCH_BATCH);
+        }
+        bench_finish();
+    }
+    if (bench_start("idset/has_miss", NULL)) {
+        for (i = 0; i < count; i += BENCH_BATCH) {
+            bench_begin();
+            for (j = i; j < i + BENCH_BATCH; j++) {
+                Fabric_IdSet_has(set, (j * 2654435761u) & ~1u);
+            }
+            bench_end(BENCH_BATCH);
+        }
+        bench_finish();
+    }
+    Fabric_IdSet_destroy(set);
+}
+
+/**
+ * Sets random keys of an entity map and gets them back
+ */
+static
+void bench_entity_map() {
+    uint32_t i, j, count = bench_size(1000000);
+    EntityMap *map;
+    error_t status;
+
+    map = Fabric_EntityMap_new(&status);
+    bench_check(status, "Creating an entity map");
+    if (bench_start("entitymap/set", NULL)) {
+        for (i = 0; i < count; i += BENCH_BATCH) {
+            bench_begin();
+            for (j = i; j < i + BENCH_BATCH; j++) {
+                Fabric_EntityMap_set(map, j * 2654435761u | 1, map);
+            }
+            bench_end(BENCH_BATCH);
+        }
+        bench_finish();
+    }
+    if (bench_start("entitymap/get", NULL)) {
+        for (i = 0; i < count; i += BENCH_BATCH) {
+            bench_begin();
+            for (j = i; j < i + BENCH_BATCH; j++) {
+                Fabric_EntityMap_get(map, (bench_random() % count) * 2654435761u | 1);
+            }
+            bench_end(BENCH_BATCH);
+        }
+        bench_finish();
+    }
+    Fabric_EntityMap_destroy(map);
+}
+
+/**
+ * Builds a deep class hierarchy, then fetches, flushes and walks it
+ *
+ * The hierarchy is a chain of classes, each of which also has a few leaf
+ * classes, so the deepest class has every class in the chain as an
+ * ancestor.
+ */
+static
+void bench_class_hierarchy() {
+    char *file_name = "bench_class_hierarchy.fdb";
+    char name[32];
+    uint32_t depth = bench_size(500), leaves = 4, count = 0, i, j;
+    classid_t *chain;
+    Graph graph;
+    FILE *file;
+    Class *parent = NULL, *c;
+    DynamicList *list;
+    bool_t timed;
+    error_t status;
+
+    chain = malloc(depth * sizeof(classid_t));
+    file = bench_create_graph(file_name, &graph);
+    timed = bench_start("class_hierarchy/create_class", &graph);
+    for (i = 0; i < depth; i++) {
+        bench_begin();
+        for (j = 0; j <= leaves; j++) {
+            snprintf(name, sizeof(name), "Class%u_%u", i, j);
+            c = Fabric_ClassStore_create_class(&graph.class_store, parent, name, FALSE, &status);
+            bench_check(status, "Creating a class");
+            if (0 == j) {
+                chain[i] = Fabric_Class_get_id(c);
+            }
+        }
+        parent = Fabric_ClassStore_get_class(&graph.class_store, chain[i], &status);
+        bench_end(leaves + 1);
+    }
+    count = depth * (leaves + 1);
+    if (timed) {
+        bench_finish();
+    }
+    bench_reload_graph(file, &graph);
+
+    if (bench_start("class_store/get_class_cold", &graph)) {
+        for (i = 1; i <= count; i += BENCH_BATCH) {
+            bench_begin();
+            for (j = i; j < i + BENCH_BATCH && j <= count; j++) {
+                Fabric_ClassStore_get_class(&graph.class_store, j, &status);
+            }
+            bench_end(j - i);
+        }
+        bench_finish();
+    }
+    if (bench_start("class_store/get_class_hot", &graph)) {
+        for (i = 0; i < bench_size(1000000); i += BENCH_BATCH) {
+            bench_begin();
+            for (j = 0; j < BENCH_BATCH; j++) {
+                Fabric_ClassStore_get_class(&graph.class_store, 1 + bench_random() % count, &status);
+            }
+            bench_end(BENCH_BATCH);
+        }
+        bench_finish();
+    }
+    if (bench_start("class_store/flush_one", &graph)) {
+        for (i = 0; i < bench_size(20000); i++) {
+            c = Fabric_ClassStore_get_class(&graph.class_store, 1 + bench_random() % count, &status);
+            bench_begin();
+            Fabric_ClassStore_update_class(&graph.class_store, c);
+            Fabric_ClassStore_flush(&graph.class_store);
+            bench_end(1);
+        }
+        bench_finish();
+    }
+    if (bench_start("class_store/flush_all", &graph)) {
+        for (i = 0; i < bench_size(100); i++) {
+            for (j = 1; j <= count; j++) {
+                Fabric_ClassStore_update_class(&graph.class_store,
+                    Fabric_ClassStore_get_class(&graph.class_store, j, &status));
+            }
+            bench_begin();
+            Fabric_ClassStore_flush(&graph.class_store);
+            bench_end(count);
+        }
+        bench_finish();
+    }
+    if (bench_start("class_store/is_subclass", &graph)) {
+        for (i = 0; i < bench_size(1000000); i += BENCH_BATCH) {
+            bench_begin();
+            for (j = 0; j < BENCH_BATCH; j++) {
+                Fabric_ClassStore_is_subclass(&graph.class_store, chain[depth - 1], chain[bench_random() % depth], &status);
+            }
+            bench_end(BENCH_BATCH);
+        }
+        bench_finish();
+    }
+    if (bench_start("class_store/load_descendents", &graph)) {
+        list = Fabric_DynamicList_new(&status);
+        bench_check(status, "Creating a list");
+        for (i = 0; i < bench_size(2000); i++) {
+            Fabric_DynamicList_destroy(list);
+            list = Fabric_DynamicList_new(&status);
+            bench_begin();
+            bench_check(Fabric_ClassStore_load_descendent_classes(
+                &graph.class_store, chain[bench_random() % depth], list), "Loading descendents");
+            bench_end(1);
+        }
+        Fabric_DynamicList_destroy(list);
+        bench_finish();
+    }
+    free(chain);
+    bench_remove_graph(file_name, file, &graph);
+}
+
+/**
+ * Generates a graph whose degrees follow a power law, then reads back its
+ * edges, snapshots its adjacency and searches it
+ */
+static
+void bench_power_law() {
+    char *file_name = "bench_power_law.fdb";
+    uint32_t vertices = bench_size(50000), edges = vertices * 8, i, j, visited;
+    vertexid_t from_id, to_id, v;
+    Graph graph;
+    FILE *file;
+    Class *c;
+    EdgeIterator iterator;
+    AdjacencySnapshot *snapshot = NULL;
+    TraversalPool *pool;
+    bool_t timed;
+    error_t status;
+
+    file = bench_create_graph(file_name, &graph);
+    c = bench_add_class(&graph, 1);
+    bench_add_vertices(&graph, c, vertices);
+    timed = bench_start("power_law/create_edge", &graph);
+    for (i = 0; i < edges; i += BENCH_BATCH) {
+        bench_begin();
+        for (j = 0; j < BENCH_BATCH; j++) {
+            from_id = bench_skewed(vertices);
+            to_id = bench_skewed(vertices);
+            Fabric_EdgeStore_create_edge(&graph.edge_store, 1 + bench_random() % 4,
+                bench_get_vertex(&graph, from_id), bench_get_vertex(&graph, to_id), &status);
+        }
+        if (0 == (i + BENCH_BATCH) % BENCH_FLUSH_INTERVAL) {
+            bench_flush_stores(&graph);
+        }
+        bench_end(BENCH_BATCH);
+    }
+    if (timed) {
+        bench_finish();
+    }
+    bench_reload_graph(file, &graph);
+
+    if (bench_start("power_law/iterate_edges", &graph)) {
+        for (v = 1; v <= vertices; v += BENCH_BATCH) {
+            visited = 0;
+            bench_begin();
+            for (j = v; j < v + BENCH_BATCH && j <= vertices; j++) {
+                Fabric_EdgeIterator_init(&iterator, &graph, bench_get_vertex(&graph, j), FABRIC_DIRECTION_OUT);
+                while (NULL != Fabric_EdgeIterator_next(&iterator, &status)) {
+                    visited++;
+                }
+            }
+            bench_end(visited);
+        }
+        bench_finish();
+    }
+    bench_iterate_frontiers(file, &graph, "power_law/frontier_edges", vertices, FALSE);
+    bench_iterate_frontiers(file, &graph, "power_law/frontier_prefetched", vertices, TRUE);
+    if (bench_start("power_law/build_snapshot", &graph)) {
+        for (i = 0; i < 5; i++) {
+            if (NULL != snapshot) {
+                Fabric_AdjacencySnapshot_destroy(snapshot);
+            }
+            bench_begin();
+            snapshot = Fabric_AdjacencySnapshot_build(&graph, 0, &status);
+            bench_end(edges);
+            bench_check(status, "Building a snapshot");
+        }
+        bench_finish();
+    }
+    if (NULL == snapshot) {
+        snapshot = Fabric_AdjacencySnapshot_build(&graph, 0, &status);
+        bench_check(status, "Building a snapshot");
+    }
+    pool = Fabric_TraversalPool_new(0, &status);
+    bench_check(status, "Creating a traversal pool");
+    if (bench_start("power_law/bfs", &graph)) {
+        for (i = 0; i < 20; i++) {
+            bench_begin();
+            bench_check(Fabric_Traversal_bfs(pool, snapshot, bench_skewed(vertices),
+                FABRIC_DIRECTION_OUT | FABRIC_DIRECTION_IN, UINT32_MAX, NULL, NULL, &visited), "Searching");
+            bench_end(visited);
+        }
+        bench_finish();
+    }
+    Fabric_TraversalPool_destroy(pool);
+    Fabric_AdjacencySnapshot_destroy(snapshot);
+    bench_remove_graph(file_name, file, &graph);
+}
+
+/**
+ * Gives vertices long chains of properties, then gets the property at
+ * the end of each chain with cold and with warm caches
+ */
+/**
+ * Looks up batches of random vertices from a cold graph, first one at a
+ * time and then with batched reads
+ */
+static
+void bench_vertex_lookups() {
+    char *file_name = "bench_vertex_lookups.fdb";
+    uint32_t vertices = bench_size(200000), i, j;
+    static vertexid_t ids[BENCH_LOOKUP_BATCH];
+    static Vertex batch[BENCH_LOOKUP_BATCH];
+    Graph graph;
+    FILE *file;
+    int pass;
+
+    file = bench_create_graph(file_name, &graph);
+    bench_add_vertices(&graph, bench_add_class(&graph, 1), vertices);
+    for (pass = 0; pass < 2; pass++) {
+        // Both passes start cold and look up the same ids
+        bench_reload_graph(file, &graph);
+        bench_random_state = 2463534242u;
+        if (!bench_start(0 == pass ? "vertex_lookups/get_vertex" : "vertex_lookups/read_vertices", &graph)) {
+            continue;
+        }
+        for (i = 0; i < vertices; i += BENCH_LOOKUP_BATCH) {
+            for (j = 0; j < BENCH_LOOKUP_BATCH; j++) {
+                ids[j] = 1 + bench_random() % vertices;
+            }
+            bench_begin();
+            if (0 == pass) {
+                for (j = 0; j < BENCH_LOOKUP_BATCH; j++) {
+                    bench_get_vertex(&graph, ids[j]);
+                }
+            } else {
+                bench_check(Fabric_VertexStore_read_vertices(&graph.vertex_store, ids, BENCH_LOOKUP_BATCH, batch),
+                    "Reading vertices");
+            }
+            bench_end(BENCH_LOOKUP_BATCH);
+        }
+        bench_finish();
+    }
+    bench_remove_graph(file_name, file, &graph);
+}
+
+/**
+ * Adds vertices linked in a chain to a logged graph, committing each
+ * vertex on its own or a batch of them at a time
+ */
+static
+void bench_write_batches() {
+    char *file_name = "bench_write_batches.fdb";
+    char *wal_name = "bench_write_batches.log";
+    uint32_t writes = bench_size(4000), i, j;
+    WriteBatch batch;
+    Graph graph;
+    FILE *file, *wal_file;
+    Class *c;
+    Vertex *v, *previous;
+    error_t status;
+    int pass;
+
+    for (pass = 0; pass < 2; pass++) {
+        file = bench_create_graph(file_name, &graph);
+        Fabric_close_graph(&graph);
+        wal_file = fopen(wal_name, "w+b");
+        if (NULL == wal_file) {
+            fprintf(stderr, "Couldn't create %s\n", wal_name);
+            exit(1);
+        }
+        bench_check(Fabric_load_logged_graph(file, wal_file, &graph), "Loading a logged graph");
+        c = bench_add_class(&graph, 1);
+        previous = NULL;
+        if (bench_start(0 == pass ? "write_batches/commit_each" : "write_batches/batched", &graph)) {
+            for (i = 0; i < writes; i += BENCH_WRITE_BATCH) {
+                bench_begin();
+                if (1 == pass) {
+                    bench_check(Fabric_WriteBatch_begin(&batch, &graph), "Beginning a batch");
+                }
+                for (j = 0; j < BENCH_WRITE_BATCH; j++) {
+                    v = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+                    bench_check(status, "Creating a vertex");
+                    if (NULL != previous) {
+                        Fabric_EdgeStore_create_edge(&graph.edge_store, 1, previous, v, &status);
+                        bench_check(status, "Creating an edge");
+                    }
+                    previous = v;
+                    if (0 == pass) {
+                        bench_flush_stores(&graph);
+                        bench_check(Fabric_commit_graph(&graph), "Committing the graph");
+                    }
+                }
+                if (1 == pass) {
+                    bench_check(Fabric_WriteBatch_commit(&batch), "Committing a batch");
+                }
+                bench_end(BENCH_WRITE_BATCH);
+            }
+            bench_finish();
+        }
+        bench_remove_graph(file_name, file, &graph);
+        fclose(wal_file);
+        remove(wal_name);
+    }
+}
+
+static
+void bench_property_chain() {
+    char *file_name = "bench_property_chain.fdb";
+    uint32_t vertices = bench_size(4000), length = 64, i;
+    char *lookups[4] = {
+        "property_chain/get_last_cold", "property_chain/get_last_hot",
+        "property_chain/get_missing_cold", "property_chain/get_missing_hot"
+    };
+    uint8_t data[FABRIC_PROPERTY_STORAGE_SIZE];
+    labelid_t label_id;
+    vertexid_t v;
+    Graph graph;
+    FILE *file;
+    Property *p;
+    bool_t timed;
+    error_t status;
+
+    file = bench_create_graph(file_name, &graph);
+    bench_add_vertices(&graph, bench_add_class(&graph, 1), vertices);
+    p = Fabric_Property_new(0, &status);
+    bench_check(status, "Creating a property");
+    timed = bench_start("property_chain/set_property", &graph);
+    for (v = 1; v <= vertices; v++) {
+        bench_begin();
+        for (label_id = 1; label_id <= length; label_id++) {
+            memset(data, 0, sizeof(data));
+            Fabric_Property_init(p, data);
+            Fabric_Property_set_type(p, FABRIC_PROPTYPE_INTEGER);
+            Fabric_Property_set_integer_value(p, (int64_t)v * label_id);
+            Fabric_PropertyStore_set_vertex_property(&graph.property_store, bench_get_vertex(&graph, v), label_id, p);
+        }
+        if (0 == v % (BENCH_FLUSH_INTERVAL / length)) {
+            bench_flush_stores(&graph);
+        }
+        bench_end(length);
+    }
+    if (timed) {
+        bench_finish();
+    }
+    Fabric_Property_destroy(p);
+    bench_reload_graph(file, &graph);
+
+    // a missing label walks every list once, and then uses their directories
+    for (i = 0; i < 4; i++) {
+        if (bench_start(lookups[i], &graph)) {
+            for (v = 1; v <= vertices; v++) {
+                bench_begin();
+                Fabric_PropertyStore_get_vertex_property(&graph.property_store, bench_get_vertex(&graph, v),
+                    i < 2 ? length : length + 1, &status);
+                bench_end(1);
+            }
+            bench_finish();
+        }
+    }
+    bench_remove_graph(file_name, file, &graph);
+}
+
+int main(int argc, char **argv) {
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (0 == strcmp(argv[i], "-q")) {
+            bench_scale = 0.1;
+        } else if (0 == strcmp(argv[i], "-f") && i + 1 < argc) {
+            i++;
+            if (0 == strcmp(argv[i], "csv")) {
+                bench_format = BENCH_FORMAT_CSV;
+            } else if (0 == strcmp(argv[i], "json")) {
+                bench_format = BENCH_FORMAT_JSON;
+            } else {
+                bench_format = BENCH_FORMAT_TEXT;
+            }
+        } else if ('-' != argv[i][0]) {
+            bench_filter = argv[i];
+        } else {
+            fprintf(stderr, "Usage: %s [-q] [-f text|csv|json] [filter]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    Fabric_meminit();
+    if (BENCH_FORMAT_CSV == bench_format) {
+        printf("benchmark,ops,seconds,ops_per_sec,p50_ns,p99_ns,bytes_read,bytes_written\n");
+    } else if (BENCH_FORMAT_JSON == bench_format) {
+        printf("[\n");
+    } else {
+        printf("%-36s %10s %14s %10s %10s %12s %12s\n",
+            "benchmark", "ops", "ops/s", "p50 ns", "p99 ns", "read bytes", "write bytes");
+    }
+
+    bench_read_bytes();
+    bench_id_set();
+    bench_entity_map();
+    bench_class_hierarchy();
+    bench_power_law();
+    bench_vertex_lookups();
+    bench_write_batches();
+    bench_property_chain();
+
+    if (BENCH_FORMAT_JSON == bench_format) {
+        printf("\n]\n");
+    }
+    return 0;
+}
@@ -0,0 +1,896 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_BUFFERPOOL_C__
+#define _FABRIC_BUFFERPOOL_C__
+
+#include <string.h>
+#include <unistd.h>
+#ifndef FABRIC_NO_THREADS
+#  include <pthread.h>
+#endif
+#include "Internal.h"
+
+/**
+ * The Buffer Pool is a cache of fixed size pages of the graph file.
+ *
+ * All reads and writes to the graph file go through the buffer pool
+ * so that fetching a record is a copy out of a resident page rather
+ * than a seek and a series of single byte reads.  Pages are
+ * FABRIC_PAGE_SIZE bytes and page n covers the file offsets
+ * [n * page_size, (n + 1) * page_size).
+ *
+ * A page must be pinned while it is being used.  A pinned page is never
+ * evicted.  When a frame is needed and none is free, frames are chosen
+ * for eviction with the CLOCK algorithm.  Pages that have been written
+ * to are marked dirty and are written back to the file when they are
+ * evicted or when the pool is flushed.
+ *
+ * Pages are read and written with positioned I/O on the file's
+ * descriptor, so the pool never depends on the file's shared position.
+ * The pool counts the pages it finds and loads, and the bytes it reads
+ * from and writes to the file.
+ *
+ * Prefetched pages are read asynchronously by up to FABRIC_IO_THREADS
+ * I/O threads, which the pool starts the first time it prefetches.  A
+ * prefetch claims a frame for each page that isn't resident, marks it as
+ * loading and queues its read, then returns without waiting.  A loading
+ * frame is in the page table but isn't pinned; pinning it waits for its
+ * read to complete, and eviction passes over it until then.  At most
+ * half of the frames are loading at once.  Defining FABRIC_NO_THREADS
+ * makes prefetches read their pages before they return.
+ *
+ * Dirty pages can also be written back a few at a time by an
+ * incremental flush, which continues in file order from where the last
+ * one stopped.  Each dirty page keeps the pool's log sequence number
+ * from when it became dirty, so the owner of a write-ahead log can tell
+ * how much of the log the pages still depend on.
+ *
+ * The pool never steals a page for a write-ahead log that only redoes:
+ * a dirty page that was changed at or after the pool's commit lsn holds
+ * writes that haven't been committed, so it is neither evicted nor
+ * written back until its owner raises the commit lsn past the page's
+ * last change.  Every page written to the file therefore holds only
+ * committed writes whose log records are already on disk.  A pool that
+ * is never given a commit lsn writes back any dirty page.
+ */
+typedef struct BufferFrame {
+    uint32_t page_no;       // The number of the page held in this frame
+    uint32_t pin_count;     // The number of users currently pinning the page
+    bool_t in_use;          // Whether or not the frame holds a page
+    bool_t dirty;           // Whether or not the page must be written back
+    bool_t referenced;      // The CLOCK reference bit
+    bool_t loading;         // Whether an asynchronous read of the page hasn't been finished
+    bool_t io_done;         // Whether the I/O thread has completed the read; under io_lock
+    size_t io_bytes;        // The number of bytes the read got from the file; under io_lock
+    uint64_t dirty_lsn;     // The pool's lsn when the page became dirty
+    uint64_t last_lsn;      // The pool's lsn when the page was last changed
+    uint8_t *data;          // The page's data (page_size bytes)
+} BufferFrame;
+
+typedef struct BufferPool {
+    FILE *file;             // The file the pages are read from and written to
+    uint32_t page_size;     // The size of each page in bytes
+    int num_frames;         // The number of frames in the pool
+    int clock_hand;         // The next frame to be considered for eviction
+    BufferFrame *frames;    // The pool's frames
+    uint8_t *data;          // The memory backing all of the frames
+    EntityMap *page_table;  // Maps page numbers (+ 1) to their frames
+    uint64_t hits;          // The number of pins that found their page resident
+    uint64_t misses;        // The number of pins that loaded their page
+    uint64_t bytes_read;    // The number of bytes read from the file
+    uint64_t bytes_written; // The number of bytes written to the file
+    int num_loading;        // The number of frames that are loading
+    uint64_t lsn;           // The log sequence number given to pages as they become dirty
+    uint64_t commit_lsn;    // Dirty pages changed at or after this lsn can't be written back
+    uint32_t flush_page;    // The page the next incremental flush starts from
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_t io_lock;    // Protects the read queue and the frames' io_ fields
+    pthread_cond_t io_queued;   // Signalled when a read is queued or the I/O threads stop
+    pthread_cond_t io_finished; // Signalled when an I/O thread completes a read
+    BufferFrame **io_queue;     // A ring of the frames waiting to be read
+    int io_head;                // The position of the oldest queued frame
+    int io_count;               // The number of queued frames
+    bool_t io_stopping;         // Whether the I/O threads should exit
+    int num_io_threads;         // The number of I/O threads started
+    pthread_t io_threads[FABRIC_IO_THREADS];    // The I/O threads
+#endif
+} BufferPool;
+
+/**
+ * Initializes a buffer pool
+ *
+ * Args:
+ *      self: The buffer pool being initialized
+ *      file: The file the pool reads pages from
+ *      page_size: The size of a page in bytes
+ *      num_frames: The maximum number of pages that can be resident at once
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_BufferPool_init(BufferPool *self, FILE *file, uint32_t page_size, int num_frames) {
+    error_t status;
+    int i;
+
+    self->file = file;
+    self->page_size = page_size;
+    self->num_frames = num_frames;
+    self->clock_hand = 0;
+    self->hits = 0;
+    self->misses = 0;
+    self->bytes_read = 0;
+    self->bytes_written = 0;
+    self->num_loading = 0;
+    self->lsn = 0;
+    self->commit_lsn = UINT64_MAX;
+    self->flush_page = 0;
+
+    self->frames = Fabric_memalloc_tagged(num_frames * sizeof(BufferFrame), FABRIC_MEM_IO);
+    if (NULL == self->frames) {
+        return Fabric_memerrno();
+    }
+
+    self->data = Fabric_memalloc_tagged((size_t)num_frames * page_size, FABRIC_MEM_IO);
+    if (NULL == self->data) {
+        Fabric_memfree_tagged(self->frames, num_frames * sizeof(BufferFrame), FABRIC_MEM_IO);
+        return Fabric_memerrno();
+    }
+
+    // Size the page table so that it never needs to grow
+    self->page_table = Fabric_EntityMap_new_with_capacity(num_frames * 2, &status);
+    if (FABRIC_OK != status) {
+        Fabric_memfree_tagged(self->data, (size_t)num_frames * page_size, FABRIC_MEM_IO);
+        Fabric_memfree_tagged(self->frames, num_frames * sizeof(BufferFrame), FABRIC_MEM_IO);
+        return status;
+    }
+
+#ifndef FABRIC_NO_THREADS
+    // No more than half of the frames are ever queued
+    self->io_queue = Fabric_memalloc_tagged(num_frames * sizeof(BufferFrame*), FABRIC_MEM_IO);
+    if (NULL == self->io_queue) {
+        Fabric_EntityMap_destroy(self->page_table);
+        Fabric_memfree_tagged(self->data, (size_t)num_frames * page_size, FABRIC_MEM_IO);
+        Fabric_memfree_tagged(self->frames, num_frames * sizeof(BufferFrame), FABRIC_MEM_IO);
+        return Fabric_memerrno();
+    }
+    pthread_mutex_init(&self->io_lock, NULL);
+    pthread_cond_init(&self->io_queued, NULL);
+    pthread_cond_init(&self->io_finished, NULL);
+    self->io_head = 0;
+    self->io_count = 0;
+    self->io_stopping = FALSE;
+    self->num_io_threads = 0;
+#endif
+
+    for (i = 0; i < num_frames; i++) {
+        self->frames[i].page_no = 0;
+        self->frames[i].pin_count = 0;
+        self->frames[i].in_use = FALSE;
+        self->frames[i].dirty = FALSE;
+        self->frames[i].referenced = FALSE;
+        self->frames[i].loading = FALSE;
+        self->frames[i].io_done = FALSE;
+        self->frames[i].io_bytes = 0;
+        self->frames[i].dirty_lsn = 0;
+        self->frames[i].last_lsn = 0;
+        self->frames[i].data = self->data + (size_t)i * page_size;
+    }
+
+    return FABRIC_OK;
+}
+
+/**
+ * Frees a buffer pool's memory
+ *
+ * Dirty pages are NOT written back.  Fabric_BufferPool_flush(1) should
+ * be called first if the pages' changes must be saved.  Queued reads are
+ * completed before the I/O threads exit.
+ */
+void Fabric_BufferPool_deinit(BufferPool *self) {
+#ifndef FABRIC_NO_THREADS
+    int i;
+
+    pthread_mutex_lock(&self->io_lock);
+    self->io_stopping = TRUE;
+    pthread_cond_broadcast(&self->io_queued);
+    pthread_mutex_unlock(&self->io_lock);
+    for (i = 0; i < self->num_io_threads; i++) {
+        pthread_join(self->io_threads[i], NULL);
+    }
+    pthread_cond_destroy(&self->io_finished);
+    pthread_cond_destroy(&self->io_queued);
+    pthread_mutex_destroy(&self->io_lock);
+    Fabric_memfree_tagged(self->io_queue, self->num_frames * sizeof(BufferFrame*), FABRIC_MEM_IO);
+#endif
+    Fabric_EntityMap_destroy(self->page_table);
+    Fabric_memfree_tagged(self->data, (size_t)self->num_frames * self->page_size, FABRIC_MEM_IO);
+    Fabric_memfree_tagged(self->frames, self->num_frames * sizeof(BufferFrame), FABRIC_MEM_IO);
+}
+
+/**
+ * Private function that checks that a dirty frame holds only committed
+ * writes, so that it may be written back
+ */
+static
+bool_t Fabric_BufferPool__can_write(BufferPool *self, BufferFrame *frame) {
+    return UINT64_MAX == self->commit_lsn || frame->last_lsn < self->commit_lsn;
+}
+
+/**
+ * Private function that writes a run of frames holding consecutive
+ * pages to the file with a single write
+ */
+static
+error_t Fabric_BufferPool__write_run(BufferPool *self, BufferFrame **run, int run_length) {
+    uint8_t *buffer;
+    size_t run_size = (size_t)run_length * self->page_size;
+    off_t offset = (off_t)run[0]->page_no * self->page_size;
+    int i;
+
+    if (run_length == 1) {
+        buffer = run[0]->data;
+    } else {
+        buffer = Fabric_memalloc_tagged(run_size, FABRIC_MEM_IO);
+        if (NULL == buffer) {
+            return Fabric_memerrno();
+        }
+        for (i = 0; i < run_length; i++) {
+            memcpy(buffer + (size_t)i * self->page_size, run[i]->data, self->page_size);
+        }
+    }
+
+    if (pwrite(fileno(self->file), buffer, run_size, offset) != (ssize_t)run_size) {
+        if (run_length > 1) {
+            Fabric_memfree_tagged(buffer, run_size, FABRIC_MEM_IO);
+        }
+        return FABRIC_BUFFERPOOL_IO_ERROR;
+    }
+    self->bytes_written += run_size;
+
+    if (run_length > 1) {
+        Fabric_memfree_tagged(buffer, run_size, FABRIC_MEM_IO);
+    }
+    for (i = 0; i < run_length; i++) {
+        run[i]->dirty = FALSE;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private function for loading a page from the file into a frame
+ *
+ * The part of a page that lies beyond the end of the file is zeroed.
+ */
+static
+size_t Fabric_BufferPool__read_page(BufferPool *self, BufferFrame *frame) {
+    ssize_t bytes_read = pread(fileno(self->file), frame->data, self->page_size, (off_t)frame->page_no * self->page_size);
+
+    if (bytes_read < 0) {
+        bytes_read = 0;
+    }
+    if (bytes_read < self->page_size) {
+        memset(frame->data + bytes_read, 0, self->page_size - bytes_read);
+    }
+    return bytes_read;
+}
+
+/**
+ * Private function for loading a page from the file into a frame
+ */
+static
+error_t Fabric_BufferPool__load_page(BufferPool *self, BufferFrame *frame, uint32_t page_no) {
+    frame->page_no = page_no;
+    frame->in_use = TRUE;
+    frame->dirty = FALSE;
+    self->bytes_read += Fabric_BufferPool__read_page(self, frame);
+    return FABRIC_OK;
+}
+
+#ifndef FABRIC_NO_THREADS
+/**
+ * Private function run by a pool's I/O threads, which read the queued
+ * frames' pages until the pool is deinitialized
+ */
+static
+void *Fabric_BufferPool__io_thread(void *arg) {
+    BufferPool *self = arg;
+    BufferFrame *frame;
+    size_t bytes_read;
+
+    pthread_mutex_lock(&self->io_lock);
+    for (;;) {
+        while (0 == self->io_count && !self->io_stopping) {
+            pthread_cond_wait(&self->io_queued, &self->io_lock);
+        }
+        if (0 == self->io_count) {
+            break;
+        }
+        frame = self->io_queue[self->io_head];
+        self->io_head = (self->io_head + 1) % self->num_frames;
+        self->io_count--;
+        pthread_mutex_unlock(&self->io_lock);
+
+        bytes_read = Fabric_BufferPool__read_page(self, frame);
+
+        pthread_mutex_lock(&self->io_lock);
+        frame->io_bytes = bytes_read;
+        frame->io_done = TRUE;
+        pthread_cond_broadcast(&self->io_finished);
+    }
+    pthread_mutex_unlock(&self->io_lock);
+    return NULL;
+}
+
+/**
+ * Private function that queues the read of a loading frame's page
+ *
+ * Returns: FALSE if no I/O thread could be started
+ */
+static
+bool_t Fabric_BufferPool__queue_read(BufferPool *self, BufferFrame *frame) {
+    pthread_mutex_lock(&self->io_lock);
+    // Start another thread while every thread may be busy
+    if (self->num_io_threads < FABRIC_IO_THREADS && self->io_count >= self->num_io_threads &&
+            0 == pthread_create(&self->io_threads[self->num_io_threads], NULL, Fabric_BufferPool__io_thread, self)) {
+        self->num_io_threads++;
+    }
+    if (0 == self->num_io_threads) {
+        pthread_mutex_unlock(&self->io_lock);
+        return FALSE;
+    }
+    frame->io_done = FALSE;
+    self->io_queue[(self->io_head + self->io_count) % self->num_frames] = frame;
+    self->io_count++;
+    pthread_cond_signal(&self->io_queued);
+    pthread_mutex_unlock(&self->io_lock);
+    return TRUE;
+}
+
+/**
+ * Private function that finishes a loading frame, waiting for its read
+ * to complete if needed
+ *
+ * Args:
+ *      self: The buffer pool
+ *      frame: A loading frame
+ *      wait: Whether to wait for a read that hasn't completed
+ *
+ * Returns: FALSE if the frame is still loading
+ */
+static
+bool_t Fabric_BufferPool__finish_read(BufferPool *self, BufferFrame *frame, bool_t wait) {
+    pthread_mutex_lock(&self->io_lock);
+    while (wait && !frame->io_done) {
+        pthread_cond_wait(&self->io_finished, &self->io_lock);
+    }
+    if (!frame->io_done) {
+        pthread_mutex_unlock(&self->io_lock);
+        return FALSE;
+    }
+    self->bytes_read += frame->io_bytes;
+    frame->io_done = FALSE;
+    pthread_mutex_unlock(&self->io_lock);
+
+    frame->loading = FALSE;
+    self->num_loading--;
+    return TRUE;
+}
+#else
+/**
+ * Without threads no read is ever left loading
+ */
+static inline
+bool_t Fabric_BufferPool__finish_read(BufferPool *self, BufferFrame *frame, bool_t wait) {
+    (void)self;
+    (void)frame;
+    (void)wait;
+    return TRUE;
+}
+#endif
+
+/**
+ * Private function that finds a frame that can hold a new page
+ *
+ * Free frames are used first.  Otherwise the CLOCK hand sweeps the frames
+ * giving each referenced frame a second chance before it is chosen.  A
+ * dirty victim is written back before its frame is reused, and dirty
+ * frames holding uncommitted writes are passed over.  Loading
+ * frames whose reads have completed are finished as the hand passes them;
+ * if every other frame is pinned, the victim can be a loading frame once
+ * its read completes.
+ *
+ * Args:
+ *      self: The buffer pool
+ *      wait: Whether to wait for a loading frame rather than fail
+ *      status: A pointer to where an error can be indicated
+ */
+static
+BufferFrame *Fabric_BufferPool__get_victim(BufferPool *self, bool_t wait, error_t *status) {
+    BufferFrame *frame;
+    BufferFrame *loading = NULL;
+    int sweeps = 0;
+
+    *status = FABRIC_OK;
+    // Two full sweeps are enough to clear every reference bit
+    while (sweeps < self->num_frames * 2) {
+        frame = &self->frames[self->clock_hand];
+        self->clock_hand = (self->clock_hand + 1) % self->num_frames;
+        sweeps++;
+
+        if (!frame->in_use) {
+            return frame;
+        }
+        if (frame->loading && !Fabric_BufferPool__finish_read(self, frame, FALSE)) {
+            loading = frame;
+            continue;
+        }
+        if (frame->pin_count > 0) {
+            continue;
+        }
+        if (frame->dirty && !Fabric_BufferPool__can_write(self, frame)) {
+            continue;
+        }
+        if (frame->referenced) {
+            frame->referenced = FALSE;
+            continue;
+        }
+
+        if (frame->dirty) {
+            *status = Fabric_BufferPool__write_run(self, &frame, 1);
+            if (FABRIC_OK != *status) {
+                return NULL;
+            }
+        }
+        Fabric_EntityMap_unset(self->page_table, frame->page_no + 1);
+        frame->in_use = FALSE;
+        return frame;
+    }
+
+    if (wait && NULL != loading) {
+        Fabric_BufferPool__finish_read(self, loading, TRUE);
+        Fabric_EntityMap_unset(self->page_table, loading->page_no + 1);
+        loading->in_use = FALSE;
+        return loading;
+    }
+    *status = FABRIC_BUFFERPOOL_ALL_PINNED;
+    return NULL;
+}
+
+/**
+ * Pins a page in the buffer pool, loading it from the file if necessary
+ *
+ * Every call to this function must be matched by a call to
+ * Fabric_BufferPool_unpin(3) once the page's data is no longer needed.
+ *
+ * Args:
+ *      self: The buffer pool
+ *      page_no: The number of the page being pinned
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: A pointer to the page's data or NULL on failure
+ */
+uint8_t *Fabric_BufferPool_pin(BufferPool *self, uint32_t page_no, error_t *status) {
+    BufferFrame *frame = Fabric_EntityMap_get(self->page_table, page_no + 1);
+
+    if (NULL == frame) {
+        self->misses++;
+        frame = Fabric_BufferPool__get_victim(self, TRUE, status);
+        if (NULL == frame) {
+            return NULL;
+        }
+        *status = Fabric_BufferPool__load_page(self, frame, page_no);
+        if (FABRIC_OK != *status) {
+            return NULL;
+        }
+        *status = Fabric_EntityMap_set(self->page_table, page_no + 1, frame);
+        if (FABRIC_OK != *status) {
+            frame->in_use = FALSE;
+            return NULL;
+        }
+    } else {
+        self->hits++;
+        if (frame->loading) {
+            Fabric_BufferPool__finish_read(self, frame, TRUE);
+        }
+    }
+
+    *status = FABRIC_OK;
+    frame->pin_count++;
+    frame->referenced = TRUE;
+    return frame->data;
+}
+
+/**
+ * Unpins a page that was pinned with Fabric_BufferPool_pin(3)
+ *
+ * Args:
+ *      self: The buffer pool
+ *      page_no: The number of the page being unpinned
+ *      dirty: TRUE if the page's data was changed while it was pinned
+ */
+void Fabric_BufferPool_unpin(BufferPool *self, uint32_t page_no, bool_t dirty) {
+    BufferFrame *frame = Fabric_EntityMap_get(self->page_table, page_no + 1);
+    if (NULL == frame) {
+        return;
+    }
+    if (frame->pin_count > 0) {
+        frame->pin_count--;
+    }
+    if (dirty && !frame->dirty) {
+        frame->dirty = TRUE;
+        frame->dirty_lsn = self->lsn;
+    }
+    if (dirty) {
+        frame->last_lsn = self->lsn;
+    }
+}
+
+/**
+ * Loads the pages covering a range of the file ahead of their use
+ *
+ * The reads of the pages that aren't resident are queued for the pool's
+ * I/O threads and the function returns without waiting for them; pages
+ * that are already resident are only marked as referenced.  At most half
+ * of the pool is loaded by one call, and prefetching stops once half of
+ * the pool is loading, so that a prefetch can't evict the pages it is
+ * meant to complement.  Running out of unpinned frames
+ * is not an error; the remaining pages are simply not loaded.
+ *
+ * Args:
+ *      self: The buffer pool
+ *      offset: The file offset of the start of the range
+ *      length: The length of the range in bytes
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_BufferPool_prefetch(BufferPool *self, uint32_t offset, size_t length) {
+    error_t status;
+    BufferFrame *frame;
+    uint32_t page_no, last_page;
+    int max_pages = self->num_frames / 2;
+
+    if (length == 0) {
+        return FABRIC_OK;
+    }
+
+    last_page = (offset + length - 1) / self->page_size;
+    for (page_no = offset / self->page_size; page_no <= last_page && max_pages > 0; page_no++, max_pages--) {
+        frame = Fabric_EntityMap_get(self->page_table, page_no + 1);
+        if (NULL != frame) {
+            frame->referenced = TRUE;
+            continue;
+        }
+        if (self->num_loading >= self->num_frames / 2) {
+            return FABRIC_OK;
+        }
+        frame = Fabric_BufferPool__get_victim(self, FALSE, &status);
+        if (NULL == frame) {
+            return FABRIC_BUFFERPOOL_ALL_PINNED == status ? FABRIC_OK : status;
+        }
+        if (FABRIC_OK != (status = Fabric_EntityMap_set(self->page_table, page_no + 1, frame))) {
+            return status;
+        }
+        self->misses++;
+        frame->page_no = page_no;
+        frame->in_use = TRUE;
+        frame->dirty = FALSE;
+        frame->referenced = TRUE;
+#ifndef FABRIC_NO_THREADS
+        frame->loading = TRUE;
+        self->num_loading++;
+        if (!Fabric_BufferPool__queue_read(self, frame)) {
+            frame->loading = FALSE;
+            self->num_loading--;
+            self->bytes_read += Fabric_BufferPool__read_page(self, frame);
+        }
+#else
+        self->bytes_read += Fabric_BufferPool__read_page(self, frame);
+#endif
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private comparison function for sorting frames by page number
+ */
+static
+int Fabric_BufferPool__compare_frames(const void *a, const void *b) {
+    uint32_t page_a = (*(BufferFrame**)a)->page_no;
+    uint32_t page_b = (*(BufferFrame**)b)->page_no;
+    return page_a < page_b ? -1 : page_a > page_b;
+}
+
+/**
+ * Private function that lists the pool's dirty frames that can be
+ * written back in page order
+ *
+ * Returns: The number of frames listed
+ */
+static
+int Fabric_BufferPool__get_dirty(BufferPool *self, BufferFrame **dirty) {
+    int num_dirty = 0;
+    int i;
+
+    for (i = 0; i < self->num_frames; i++) {
+        if (self->frames[i].in_use && self->frames[i].dirty &&
+            Fabric_BufferPool__can_write(self, &self->frames[i])) {
+            dirty[num_dirty++] = &self->frames[i];
+        }
+    }
+    qsort(dirty, num_dirty, sizeof(BufferFrame*), Fabric_BufferPool__compare_frames);
+    return num_dirty;
+}
+
+/**
+ * Private function that writes frames listed in page order, writing each
+ * run of consecutive pages with a single write
+ */
+static
+error_t Fabric_BufferPool__write_frames(BufferPool *self, BufferFrame **frames, int num_frames) {
+    error_t status = FABRIC_OK;
+    int i, run_start;
+
+    for (run_start = 0, i = 1; i <= num_frames && FABRIC_OK == status; i++) {
+        if (i == num_frames || frames[i]->page_no != frames[i - 1]->page_no + 1) {
+            status = Fabric_BufferPool__write_run(self, frames + run_start, i - run_start);
+            run_start = i;
+        }
+    }
+    return status;
+}
+
+/**
+ * Writes all the dirty pages in the pool back to the file
+ *
+ * Pages are written in file order and runs of consecutive dirty
+ * pages are written with a single write.
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_BufferPool_flush(BufferPool *self) {
+    BufferFrame **dirty = Fabric_memalloc_tagged(self->num_frames * sizeof(BufferFrame*), FABRIC_MEM_IO);
+    error_t status;
+    int num_dirty;
+
+    if (NULL == dirty) {
+        return Fabric_memerrno();
+    }
+
+    num_dirty = Fabric_BufferPool__get_dirty(self, dirty);
+    status = Fabric_BufferPool__write_frames(self, dirty, num_dirty);
+
+    Fabric_memfree_tagged(dirty, self->num_frames * sizeof(BufferFrame*), FABRIC_MEM_IO);
+    if (FABRIC_OK == status && fflush(self->file) != 0) {
+        status = FABRIC_BUFFERPOOL_IO_ERROR;
+    }
+    return status;
+}
+
+/**
+ * Writes some of the dirty pages in the pool back to the file
+ *
+ * The pages are written in file order, starting from the page after the
+ * last one the previous incremental flush wrote and wrapping around to
+ * the start of the file, so that repeated calls sweep over every dirty
+ * page.  Runs of consecutive pages are written with a single write.
+ *
+ * Args:
+ *      self: The buffer pool
+ *      max_pages: The most pages to write
+ *      num_written: Set to the number of pages written; may be NULL
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_BufferPool_flush_some(BufferPool *self, int max_pages, int *num_written) {
+    BufferFrame **dirty = Fabric_memalloc_tagged(self->num_frames * sizeof(BufferFrame*), FABRIC_MEM_IO);
+    error_t status = FABRIC_OK;
+    int num_dirty, start, num_pages, num_tail;
+
+    if (NULL != num_written) {
+        *num_written = 0;
+    }
+    if (NULL == dirty) {
+        return Fabric_memerrno();
+    }
+
+    num_dirty = Fabric_BufferPool__get_dirty(self, dirty);
+    num_pages = num_dirty < max_pages ? num_dirty : max_pages;
+    for (start = 0; start < num_dirty && dirty[start]->page_no < self->flush_page; start++);
+
+    if (num_pages > 0) {
+        // The sweep wraps, so it is written as a tail and a head
+        num_tail = num_dirty - start;
+        if (num_tail > num_pages) {
+            num_tail = num_pages;
+        }
+        self->flush_page = dirty[(start + num_pages - 1) % num_dirty]->page_no + 1;
+        status = Fabric_BufferPool__write_frames(self, dirty + start, num_tail);
+        if (FABRIC_OK == status) {
+            status = Fabric_BufferPool__write_frames(self, dirty, num_pages - num_tail);
+        }
+        if (FABRIC_OK == status && fflush(self->file) != 0) {
+            status = FABRIC_BUFFERPOOL_IO_ERROR;
+        }
+        if (FABRIC_OK == status && NULL != num_written) {
+            *num_written = num_pages;
+        }
+    }
+
+    Fabric_memfree_tagged(dirty, self->num_frames * sizeof(BufferFrame*), FABRIC_MEM_IO);
+    return status;
+}
+
+/**
+ * Sets the log sequence number given to pages that become dirty
+ *
+ * Pages that are already dirty keep their number until they are written.
+ */
+void Fabric_BufferPool_set_lsn(BufferPool *self, uint64_t lsn) {
+    self->lsn = lsn;
+}
+
+/**
+ * Sets the log sequence number before which every write is committed
+ *
+ * Dirty pages that were last changed at or after it are kept in the
+ * pool rather than written back.  Once set, the number never goes
+ * backwards.
+ */
+void Fabric_BufferPool_set_commit_lsn(BufferPool *self, uint64_t lsn) {
+    if (UINT64_MAX == self->commit_lsn || lsn > self->commit_lsn) {
+        self->commit_lsn = lsn;
+    }
+}
+
+/**
+ * Gets the oldest log sequence number of a dirty page
+ *
+ * Returns: The smallest lsn of a dirty page, or UINT64_MAX if no page is dirty
+ */
+uint64_t Fabric_BufferPool_get_oldest_lsn(BufferPool *self) {
+    uint64_t oldest = UINT64_MAX;
+    int i;
+
+    for (i = 0; i < self->num_frames; i++) {
+        if (self->frames[i].in_use && self->frames[i].dirty && self->frames[i].dirty_lsn < oldest) {
+            oldest = self->frames[i].dirty_lsn;
+        }
+    }
+    return oldest;
+}
+
+/**
+ * Gets the number of dirty pages in a buffer pool
+ */
+int Fabric_BufferPool_get_dirty_count(BufferPool *self) {
+    int count = 0;
+    int i;
+
+    for (i = 0; i < self->num_frames; i++) {
+        if (self->frames[i].in_use && self->frames[i].dirty) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Copies bytes from the pool's pages into a buffer
+ *
+ * The range may span any number of pages.
+ *
+ * Args:
+ *      self: The buffer pool being read from
+ *      destination: Where the bytes will be copied to
+ *      num_bytes: The number of bytes to copy
+ *      offset: The file offset of the first byte
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_BufferPool_read(BufferPool *self, uint8_t *destination, size_t num_bytes, uint32_t offset) {
+    error_t status;
+    uint32_t page_no, page_offset;
+    size_t length;
+    uint8_t *page;
+
+    while (num_bytes > 0) {
+        page_no = offset / self->page_size;
+        page_offset = offset % self->page_size;
+        length = self->page_size - page_offset;
+        if (length > num_bytes) {
+            length = num_bytes;
+        }
+
+        page = Fabric_BufferPool_pin(self, page_no, &status);
+        if (NULL == page) {
+            return status;
+        }
+        memcpy(destination, page + page_offset, length);
+        Fabric_BufferPool_unpin(self, page_no, FALSE);
+
+        destination += length;
+        offset += length;
+        num_bytes -= length;
+    }
+
+    return FABRIC_OK;
+}
+
+/**
+ * Copies bytes from a buffer into the pool's pages and marks them dirty
+ *
+ * Args:
+ *      self: The buffer pool being written to
+ *      source: The bytes being written
+ *      num_bytes: The number of bytes to write
+ *      offset: The file offset of the first byte
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_BufferPool_write(BufferPool *self, uint8_t *source, size_t num_bytes, uint32_t offset) {
+    error_t status;
+    uint32_t page_no, page_offset;
+    size_t length;
+    uint8_t *page;
+
+    while (num_bytes > 0) {
+        page_no = offset / self->page_size;
+        page_offset = offset % self->page_size;
+        length = self->page_size - page_offset;
+        if (length > num_bytes) {
+            length = num_bytes;
+        }
+
+        page = Fabric_BufferPool_pin(self, page_no, &status);
+        if (NULL == page) {
+            return status;
+        }
+        memcpy(page + page_offset, source, length);
+        Fabric_BufferPool_unpin(self, page_no, TRUE);
+
+        source += length;
+        offset += length;
+        num_bytes -= length;
+    }
+
+    return FABRIC_OK;
+}
+
+/**
+ * Gets the number of pins that found their page already in a buffer pool
+ */
+uint64_t Fabric_BufferPool_get_hits(BufferPool *self) {
+    return self->hits;
+}
+
+/**
+ * Gets the number of pins that loaded their page from the file
+ */
+uint64_t Fabric_BufferPool_get_misses(BufferPool *self) {
+    return self->misses;
+}
+
+/**
+ * Gets the number of bytes a buffer pool has read from its file
+ *
+ * Returns: The bytes read since the pool was initialized
+ */
+uint64_t Fabric_BufferPool_get_bytes_read(BufferPool *self) {
+    return self->bytes_read;
+}
+
+/**
+ * Gets the number of bytes a buffer pool has written to its file
+ *
+ * Returns: The bytes written since the pool was initialized
+ */
+uint64_t Fabric_BufferPool_get_bytes_written(BufferPool *self) {
+    return self->bytes_written;
+}
+
+#endif
@@ -0,0 +1,431 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_BULKLOAD_C__
+#define _FABRIC_BULKLOAD_C__
+
+#include "Internal.h"
+
+/**
+ * A Bulk Load streams a large number of new vertices and edges into a
+ * graph without going through the stores' caches.
+ *
+ * Vertices and edges are added in batches and get sequential ids in the
+ * order they are added.  Edge records are serialized into runs and
+ * written straight to the edge store as each batch arrives.  Because ids
+ * are assigned in arrival order, the next_out_id and next_in_id links of
+ * an edge are known when it is added: they are the previous edge added
+ * for the same vertex.  The load only keeps the newest edge of each
+ * vertex, along with each vertex's class, in memory.  The vertex records,
+ * which hold the heads of the edge lists, are written in a final pass by
+ * Fabric_BulkLoad_finish(1).  The store headers and class counts are also
+ * written once, at the end.  Degree counts the edge store has loaded are
+ * updated as edges are added; counts that haven't been loaded are rebuilt
+ * when they are, since they no longer match the edge store.
+ *
+ * The resulting edge lists are the same as if every edge had been made
+ * with Fabric_EdgeStore_create_edge(5).  Edges may only connect vertices
+ * added by the same load, and the vertex and edge stores must not have
+ * any freed ids waiting to be reused.
+ *
+ * The graph should not be changed by other means while a load is open,
+ * and a load that fails should be aborted.
+ */
+typedef struct BulkVertex {
+    classid_t class_id;         // The class of the vertex
+    edgeid_t first_out_id;      // The newest outgoing edge of the vertex
+    edgeid_t first_in_id;       // The newest incoming edge of the vertex
+} BulkVertex;
+
+typedef struct BulkLoad {
+    Graph *graph;               // The graph being loaded
+    vertexid_t first_vertex_id; // The id of the load's first vertex
+    vertexid_t next_vertex_id;  // The id the next added vertex will get
+    edgeid_t first_edge_id;     // The id of the load's first edge
+    edgeid_t next_edge_id;      // The id the next added edge will get
+    uint32_t vertex_capacity;   // The number of vertices that fit in vertices
+    BulkVertex *vertices;       // The added vertices in id order
+    uint32_t num_classes;       // The number of entries in class_counts
+    uint32_t *class_counts;     // The number of added vertices of each class, by class id
+    uint8_t *run;               // Holds serialized records before they are written
+} BulkLoad;
+
+/**
+ * Starts loading vertices and edges into a graph
+ *
+ * Args:
+ *      self: The bulk load being started
+ *      graph: The graph being loaded
+ *
+ * Returns: FABRIC_OK on success, FABRIC_BULKLOAD_ERROR if a store has
+ *          freed ids or other error code on failure
+ */
+error_t Fabric_BulkLoad_begin(BulkLoad *self, Graph *graph) {
+    VertexStore *vertex_store = Fabric_Graph_get_vertex_store(graph);
+    EdgeStore *edge_store = Fabric_Graph_get_edge_store(graph);
+
+    self->graph = graph;
+    self->vertex_capacity = 0;
+    self->vertices = NULL;
+    self->num_classes = 0;
+    self->class_counts = NULL;
+    self->run = NULL;
+
+    // Freed ids would break the sequential numbering
+    if (Fabric_FreeIdMap_get_count(&vertex_store->free_ids) > 0 ||
+            Fabric_FreeIdMap_get_count(&edge_store->free_ids) > 0) {
+        return FABRIC_BULKLOAD_ERROR;
+    }
+    self->first_vertex_id = vertex_store->last_free_id;
+    self->next_vertex_id = self->first_vertex_id;
+    self->first_edge_id = edge_store->last_free_id;
+    self->next_edge_id = self->first_edge_id;
+
+    self->run = Fabric_memalloc(FABRIC_FLUSH_RUN_SIZE);
+    if (NULL == self->run) {
+        return Fabric_memerrno();
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Frees the memory used by a bulk load without finishing it
+ *
+ * Records that were already written stay in the file but the stores'
+ * headers are not updated, so their ids will be handed out again.
+ */
+void Fabric_BulkLoad_abort(BulkLoad *self) {
+    if (NULL != self->vertices) {
+        Fabric_memfree(self->vertices, sizeof(BulkVertex) * self->vertex_capacity);
+    }
+    if (NULL != self->class_counts) {
+        Fabric_memfree(self->class_counts, sizeof(uint32_t) * self->num_classes);
+    }
+    if (NULL != self->run) {
+        Fabric_memfree(self->run, FABRIC_FLUSH_RUN_SIZE);
+    }
+    self->vertex_capacity = 0;
+    self->vertices = NULL;
+    self->num_classes = 0;
+    self->class_counts = NULL;
+    self->run = NULL;
+}
+
+/**
+ * Private function that makes room for more vertices in a load
+ */
+static
+error_t Fabric_BulkLoad__reserve_vertices(BulkLoad *self, uint32_t num_vertices) {
+    uint32_t capacity = self->vertex_capacity > 0 ? self->vertex_capacity : 1024;
+    BulkVertex *vertices;
+
+    if (num_vertices <= self->vertex_capacity) {
+        return FABRIC_OK;
+    }
+    while (capacity < num_vertices) {
+        capacity *= 2;
+    }
+
+    vertices = Fabric_memrealloc(
+        self->vertices, sizeof(BulkVertex) * capacity, sizeof(BulkVertex) * self->vertex_capacity);
+    if (NULL == vertices) {
+        return Fabric_memerrno();
+    }
+    self->vertices = vertices;
+    self->vertex_capacity = capacity;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that checks a class the first time a load uses it
+ */
+static
+error_t Fabric_BulkLoad__use_class(BulkLoad *self, classid_t class_id) {
+    ClassStore *class_store = Fabric_Graph_get_class_store(self->graph);
+    uint32_t num_classes;
+    uint32_t *class_counts;
+    Class *c;
+    error_t status;
+
+    if (class_id < self->num_classes && self->class_counts[class_id] > 0) {
+        return FABRIC_OK;
+    }
+
+    c = Fabric_ClassStore_get_class(class_store, class_id, &status);
+    if (NULL == c) {
+        return status;
+    }
+    if (Fabric_Class_is_abstract(c)) {
+        return FABRIC_CLASS_ERROR;
+    }
+
+    if (class_id >= self->num_classes) {
+        num_classes = (uint32_t)class_id + 1;
+        class_counts = Fabric_memrealloc(
+            self->class_counts, sizeof(uint32_t) * num_classes, sizeof(uint32_t) * self->num_classes);
+        if (NULL == class_counts) {
+            return Fabric_memerrno();
+        }
+        memset(class_counts + self->num_classes, 0, sizeof(uint32_t) * (num_classes - self->num_classes));
+        self->class_counts = class_counts;
+        self->num_classes = num_classes;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that writes serialized records
+ *
+ * The run holds the records with ids from first_id to first_id + count - 1.
+ * They are written in as few pieces as the store's extents allow.
+ */
+static
+error_t Fabric_BulkLoad__write_run(BulkLoad *self, ExtentList *extents, uint32_t first_id, uint32_t count) {
+    uint8_t *position = self->run;
+    uint32_t length;
+    error_t status;
+
+    while (count > 0) {
+        length = Fabric_ExtentList_get_contiguous(extents, first_id);
+        if (length > count) {
+            length = count;
+        }
+        status = Fabric_Graph_write_bytes(
+            self->graph,
+            position,
+            length * extents->record_size,
+            Fabric_ExtentList_get_record_offset(extents, first_id));
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        position += length * extents->record_size;
+        first_id += length;
+        count -= length;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Adds a batch of vertices to a load
+ *
+ * The vertices get consecutive ids.  Their records are written when the
+ * load is finished.
+ *
+ * Args:
+ *      self: A bulk load
+ *      class_ids: The class of each new vertex
+ *      count: The number of new vertices
+ *      first_id: Where the id of the first new vertex is stored; may be NULL
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_BulkLoad_add_vertices(BulkLoad *self, classid_t *class_ids, uint32_t count, vertexid_t *first_id) {
+    uint32_t num_loaded = self->next_vertex_id - self->first_vertex_id;
+    uint32_t i;
+    error_t status;
+
+    if ((uint64_t)self->next_vertex_id + count > UINT32_MAX) {
+        return FABRIC_BULKLOAD_ERROR;
+    }
+    status = Fabric_BulkLoad__reserve_vertices(self, num_loaded + count);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    for (i = 0; i < count; i++) {
+        status = Fabric_BulkLoad__use_class(self, class_ids[i]);
+        if (FABRIC_OK != status) {
+            // Drop the part of the batch that was already counted
+            while (i-- > 0) {
+                self->class_counts[class_ids[i]]--;
+            }
+            return status;
+        }
+        self->class_counts[class_ids[i]]++;
+        self->vertices[num_loaded + i].class_id = class_ids[i];
+        self->vertices[num_loaded + i].first_out_id = 0;
+        self->vertices[num_loaded + i].first_in_id = 0;
+    }
+
+    if (NULL != first_id) {
+        *first_id = self->next_vertex_id;
+    }
+    self->next_vertex_id += count;
+    return FABRIC_OK;
+}
+
+/**
+ * Adds a batch of edges to a load
+ *
+ * The edges get consecutive ids and their records are written right
+ * away.  Both ends of every edge must be vertices added by this load.
+ *
+ * Args:
+ *      self: A bulk load
+ *      label_ids: The label of each new edge
+ *      from_ids: The start vertex of each new edge
+ *      to_ids: The end vertex of each new edge
+ *      count: The number of new edges
+ *      first_id: Where the id of the first new edge is stored; may be NULL
+ *
+ * Returns: FABRIC_OK on success, FABRIC_BULKLOAD_INVALID_VERTEX if an end
+ *          of an edge wasn't added by the load or other error code on failure
+ */
+error_t Fabric_BulkLoad_add_edges(
+        BulkLoad *self,
+        labelid_t *label_ids,
+        vertexid_t *from_ids,
+        vertexid_t *to_ids,
+        uint32_t count,
+        edgeid_t *first_id) {
+    EdgeStore *edge_store = Fabric_Graph_get_edge_store(self->graph);
+    ExtentList *extents = Fabric_Graph_get_store_extents(self->graph, FABRIC_EDGE_STORE);
+    uint32_t max_run = FABRIC_FLUSH_RUN_SIZE / FABRIC_EDGE_STORAGE_SIZE;
+    uint32_t run_length = 0;
+    edgeid_t run_id = self->next_edge_id;
+    edgeid_t edge_id;
+    uint32_t i, from, to;
+    Edge edge;
+    error_t status;
+
+    // Check the whole batch first so that a bad edge doesn't leave it half loaded
+    for (i = 0; i < count; i++) {
+        if (from_ids[i] < self->first_vertex_id || from_ids[i] >= self->next_vertex_id ||
+                to_ids[i] < self->first_vertex_id || to_ids[i] >= self->next_vertex_id) {
+            return FABRIC_BULKLOAD_INVALID_VERTEX;
+        }
+    }
+    if ((uint64_t)self->next_edge_id + count > UINT32_MAX) {
+        return FABRIC_BULKLOAD_ERROR;
+    }
+    status = Fabric_Graph_grow_store(self->graph, FABRIC_EDGE_STORE, self->next_edge_id + count - 1);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    for (i = 0; i < count; i++) {
+        edge_id = self->next_edge_id + i;
+        from = from_ids[i] - self->first_vertex_id;
+        to = to_ids[i] - self->first_vertex_id;
+
+        // New edges go at the heads of their vertices' lists
+        Fabric_Edge_set_id(&edge, edge_id);
+        Fabric_Edge_set_label_id(&edge, label_ids[i]);
+        Fabric_Edge_set_from_vertex_id(&edge, from_ids[i]);
+        Fabric_Edge_set_to_vertex_id(&edge, to_ids[i]);
+        Fabric_Edge_set_next_out_edge_id(&edge, self->vertices[from].first_out_id);
+        Fabric_Edge_set_next_in_edge_id(&edge, self->vertices[to].first_in_id);
+        Fabric_Edge_set_first_property_id(&edge, 0);
+        self->vertices[from].first_out_id = edge_id;
+        self->vertices[to].first_in_id = edge_id;
+
+        Fabric_Edge_load_bytes(&edge, self->run + run_length * FABRIC_EDGE_STORAGE_SIZE);
+        run_length++;
+        if (run_length == max_run || i + 1 == count) {
+            status = Fabric_BulkLoad__write_run(self, extents, run_id, run_length);
+            if (FABRIC_OK != status) {
+                return status;
+            }
+            run_id += run_length;
+            run_length = 0;
+        }
+    }
+
+    // Counts that can't grow are dropped, to be rebuilt when next loaded
+    for (i = 0; i < count && NULL != edge_store->degrees; i++) {
+        status = Fabric_DegreeCounts_add_edge(edge_store->degrees, label_ids[i],
+            from_ids[i], self->vertices[from_ids[i] - self->first_vertex_id].class_id,
+            to_ids[i], self->vertices[to_ids[i] - self->first_vertex_id].class_id);
+        if (FABRIC_OK != status) {
+            Fabric_DegreeCounts_destroy(edge_store->degrees);
+            edge_store->degrees = NULL;
+        }
+    }
+
+    if (NULL != first_id) {
+        *first_id = self->next_edge_id;
+    }
+    self->next_edge_id += count;
+    edge_store->num_edges += count;
+    return FABRIC_OK;
+}
+
+/**
+ * Writes a load's vertices and store headers and frees the load
+ *
+ * Args:
+ *      self: The bulk load being finished
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_BulkLoad_finish(BulkLoad *self) {
+    VertexStore *vertex_store = Fabric_Graph_get_vertex_store(self->graph);
+    EdgeStore *edge_store = Fabric_Graph_get_edge_store(self->graph);
+    ClassStore *class_store = Fabric_Graph_get_class_store(self->graph);
+    ExtentList *extents = Fabric_Graph_get_store_extents(self->graph, FABRIC_VERTEX_STORE);
+    uint32_t num_vertices = self->next_vertex_id - self->first_vertex_id;
+    uint32_t max_run = FABRIC_FLUSH_RUN_SIZE / FABRIC_VERTEX_STORAGE_SIZE;
+    uint32_t run_length = 0;
+    vertexid_t run_id = self->first_vertex_id;
+    uint32_t i;
+    Vertex vertex;
+    Class *c;
+    error_t status = FABRIC_OK;
+
+    if (num_vertices > 0) {
+        status = Fabric_Graph_grow_store(self->graph, FABRIC_VERTEX_STORE, self->next_vertex_id - 1);
+    }
+
+    // The final pass writes the heads of the edge lists into the vertices
+    for (i = 0; i < num_vertices && FABRIC_OK == status; i++) {
+        Fabric_Vertex_set_id(&vertex, self->first_vertex_id + i);
+        Fabric_Vertex_set_class_id(&vertex, self->vertices[i].class_id);
+        Fabric_Vertex_set_first_out_edge_id(&vertex, self->vertices[i].first_out_id);
+        Fabric_Vertex_set_first_in_edge_id(&vertex, self->vertices[i].first_in_id);
+        Fabric_Vertex_set_first_property_id(&vertex, 0);
+        Fabric_Vertex_load_bytes(&vertex, self->run + run_length * FABRIC_VERTEX_STORAGE_SIZE);
+        run_length++;
+        if (run_length == max_run || i + 1 == num_vertices) {
+            status = Fabric_BulkLoad__write_run(self, extents, run_id, run_length);
+            run_id += run_length;
+            run_length = 0;
+        }
+    }
+    if (FABRIC_OK != status) {
+        Fabric_BulkLoad_abort(self);
+        return status;
+    }
+
+    vertex_store->num_vertices += num_vertices;
+    vertex_store->last_free_id = self->next_vertex_id;
+    Fabric_Graph_update_uint32(self->graph, vertex_store->num_vertices, vertex_store->offset);
+    Fabric_Graph_update_uint32(self->graph, vertex_store->last_free_id, vertex_store->offset + 4);
+    Fabric_Graph_update_uint32(self->graph, vertex_store->last_free_id, vertex_store->offset + 8);
+
+    edge_store->last_free_id = self->next_edge_id;
+    Fabric_Graph_update_uint32(self->graph, edge_store->num_edges, edge_store->offset);
+    Fabric_Graph_update_uint32(self->graph, edge_store->last_free_id, edge_store->offset + 4);
+    Fabric_Graph_update_uint32(self->graph, edge_store->last_free_id, edge_store->offset + 8);
+
+    for (i = 0; i < self->num_classes && FABRIC_OK == status; i++) {
+        if (self->class_counts[i] == 0) {
+            continue;
+        }
+        c = Fabric_ClassStore_get_class(class_store, i, &status);
+        if (NULL != c) {
+            status = Fabric_ClassStore_add_to_count(class_store, c, self->class_counts[i]);
+        }
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_ClassStore_flush(class_store);
+    }
+
+    Fabric_BulkLoad_abort(self);
+    return status;
+}
+
+#endif
@@ -0,0 +1,223 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_BYTESWAP_C__
+#define _FABRIC_BYTESWAP_C__
+
+#include <string.h>
+#include "Internal.h"
+
+#if !defined(FABRIC_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define FABRIC_BYTESWAP__X86 1
+#  include <immintrin.h>
+#endif
+
+/**
+ * Converts whole arrays between a graph file's byte order and the host's
+ *
+ * Records are always big endian, and their fields are converted one at
+ * a time where they are read with betoh32(1) and friends.  Only the arrays of a
+ * saved adjacency snapshot, a property column page or a store's free id
+ * runs are converted all at once.  A graph file records the byte
+ * order of its arrays in its header: a graph stored in the host's order
+ * only needs its arrays copied, and one stored in the other order has them
+ * swapped by a kernel that reverses the bytes of many values at a time.
+ * On x86 there are AVX2 and SSSE3 kernels built on pshufb, and the best
+ * one the processor supports is chosen the first time an array is swapped.
+ * The scalar kernels work everywhere.  Defining FABRIC_NO_SIMD leaves out
+ * the vector kernels.
+ *
+ * The source and destination may be the same array, but they may not
+ * otherwise overlap.  Neither needs to be aligned.
+ */
+typedef void (*Fabric_ByteSwap__swap_kernel)(uint8_t *destination, const uint8_t *source, uint32_t count);
+
+/**
+ * Private scalar kernels that reverse the bytes of each value
+ */
+static
+void Fabric_ByteSwap__swap32_scalar(uint8_t *destination, const uint8_t *source, uint32_t count) {
+    uint32_t i, value;
+    for (i = 0; i < count; i++) {
+        memcpy(&value, source + i * 4, 4);
+        value = bswap32(value);
+        memcpy(destination + i * 4, &value, 4);
+    }
+}
+
+static
+void Fabric_ByteSwap__swap64_scalar(uint8_t *destination, const uint8_t *source, uint32_t count) {
+    uint32_t i;
+    uint64_t value;
+    for (i = 0; i < count; i++) {
+        memcpy(&value, source + i * 8, 8);
+        value = bswap64(value);
+        memcpy(destination + i * 8, &value, 8);
+    }
+}
+
+#ifdef FABRIC_BYTESWAP__X86
+/**
+ * Private SSSE3 kernels, swapping 16 bytes at a time
+ */
+__attribute__((target("ssse3")))
+static
+void Fabric_ByteSwap__swap32_ssse3(uint8_t *destination, const uint8_t *source, uint32_t count) {
+    __m128i mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    __m128i x;
+    uint32_t i;
+
+    for (i = 0; i + 4 <= count; i += 4) {
+        x = _mm_loadu_si128((const __m128i*)(source + i * 4));
+        _mm_storeu_si128((__m128i*)(destination + i * 4), _mm_shuffle_epi8(x, mask));
+    }
+    Fabric_ByteSwap__swap32_scalar(destination + i * 4, source + i * 4, count - i);
+}
+
+__attribute__((target("ssse3")))
+static
+void Fabric_ByteSwap__swap64_ssse3(uint8_t *destination, const uint8_t *source, uint32_t count) {
+    __m128i mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    __m128i x;
+    uint32_t i;
+
+    for (i = 0; i + 2 <= count; i += 2) {
+        x = _mm_loadu_si128((const __m128i*)(source + i * 8));
+        _mm_storeu_si128((__m128i*)(destination + i * 8), _mm_shuffle_epi8(x, mask));
+    }
+    Fabric_ByteSwap__swap64_scalar(destination + i * 8, source + i * 8, count - i);
+}
+
+/**
+ * Private AVX2 kernels, swapping 64 bytes at a time
+ *
+ * The AVX2 shuffle only moves bytes within each 16 byte lane, which is
+ * all a byte swap needs, so both lanes use the same pattern.
+ */
+__attribute__((target("avx2")))
+static
+void Fabric_ByteSwap__swap32_avx2(uint8_t *destination, const uint8_t *source, uint32_t count) {
+    __m256i mask = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    __m256i a, b;
+    uint32_t i;
+
+    for (i = 0; i + 16 <= count; i += 16) {
+        a = _mm256_loadu_si256((const __m256i*)(source + i * 4));
+        b = _mm256_loadu_si256((const __m256i*)(source + i * 4 + 32));
+        _mm256_storeu_si256((__m256i*)(destination + i * 4), _mm256_shuffle_epi8(a, mask));
+        _mm256_storeu_si256((__m256i*)(destination + i * 4 + 32), _mm256_shuffle_epi8(b, mask));
+    }
+    Fabric_ByteSwap__swap32_scalar(destination + i * 4, source + i * 4, count - i);
+}
+
+__attribute__((target("avx2")))
+static
+void Fabric_ByteSwap__swap64_avx2(uint8_t *destination, const uint8_t *source, uint32_t count) {
+    __m256i mask = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    __m256i a, b;
+    uint32_t i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        a = _mm256_loadu_si256((const __m256i*)(source + i * 8));
+        b = _mm256_loadu_si256((const __m256i*)(source + i * 8 + 32));
+        _mm256_storeu_si256((__m256i*)(destination + i * 8), _mm256_shuffle_epi8(a, mask));
+        _mm256_storeu_si256((__m256i*)(destination + i * 8 + 32), _mm256_shuffle_epi8(b, mask));
+    }
+    Fabric_ByteSwap__swap64_scalar(destination + i * 8, source + i * 8, count - i);
+}
+#endif
+
+static int Fabric_ByteSwap__kernel = -1;
+static Fabric_ByteSwap__swap_kernel Fabric_ByteSwap__swap32 = Fabric_ByteSwap__swap32_scalar;
+static Fabric_ByteSwap__swap_kernel Fabric_ByteSwap__swap64 = Fabric_ByteSwap__swap64_scalar;
+
+/**
+ * Private function that switches the kernels used to swap arrays
+ *
+ * Returns: TRUE if the processor supports the kernels
+ */
+static
+bool_t Fabric_ByteSwap__use_kernel(int kernel) {
+    if (FABRIC_BYTESWAP_KERNEL_SCALAR == kernel) {
+        Fabric_ByteSwap__swap32 = Fabric_ByteSwap__swap32_scalar;
+        Fabric_ByteSwap__swap64 = Fabric_ByteSwap__swap64_scalar;
+#ifdef FABRIC_BYTESWAP__X86
+    } else if (FABRIC_BYTESWAP_KERNEL_SSSE3 == kernel && __builtin_cpu_supports("ssse3")) {
+        Fabric_ByteSwap__swap32 = Fabric_ByteSwap__swap32_ssse3;
+        Fabric_ByteSwap__swap64 = Fabric_ByteSwap__swap64_ssse3;
+    } else if (FABRIC_BYTESWAP_KERNEL_AVX2 == kernel && __builtin_cpu_supports("avx2")) {
+        Fabric_ByteSwap__swap32 = Fabric_ByteSwap__swap32_avx2;
+        Fabric_ByteSwap__swap64 = Fabric_ByteSwap__swap64_avx2;
+#endif
+    } else {
+        return FALSE;
+    }
+    Fabric_ByteSwap__kernel = kernel;
+    return TRUE;
+}
+
+/**
+ * Gets the kernels used to swap arrays, choosing the best ones the
+ * processor supports the first time
+ *
+ * Returns: FABRIC_BYTESWAP_KERNEL_AVX2, FABRIC_BYTESWAP_KERNEL_SSSE3 or
+ *          FABRIC_BYTESWAP_KERNEL_SCALAR
+ */
+int Fabric_ByteSwap_get_kernel() {
+    if (Fabric_ByteSwap__kernel < 0 &&
+        !Fabric_ByteSwap__use_kernel(FABRIC_BYTESWAP_KERNEL_AVX2) &&
+        !Fabric_ByteSwap__use_kernel(FABRIC_BYTESWAP_KERNEL_SSSE3)) {
+        Fabric_ByteSwap__use_kernel(FABRIC_BYTESWAP_KERNEL_SCALAR);
+    }
+    return Fabric_ByteSwap__kernel;
+}
+
+/**
+ * Copies an array of 32 bit values between a byte order and the host's
+ *
+ * Converting to and from a byte order are the same operation, so this
+ * both encodes and decodes.
+ *
+ * Args:
+ *      destination: Where the converted values are written
+ *      source: The values to convert
+ *      count: The number of values
+ *      byte_order: FABRIC_BYTE_ORDER_BIG_ENDIAN or FABRIC_BYTE_ORDER_LITTLE_ENDIAN
+ */
+void Fabric_ByteSwap_copy32(void *destination, const void *source, uint32_t count, int byte_order) {
+    if (FABRIC_BYTE_ORDER_HOST != byte_order) {
+        Fabric_ByteSwap_get_kernel();
+        Fabric_ByteSwap__swap32(destination, source, count);
+    } else if (destination != source) {
+        memcpy(destination, source, (size_t)count * 4);
+    }
+}
+
+/**
+ * Copies an array of 64 bit values between a byte order and the host's
+ *
+ * Args:
+ *      destination: Where the converted values are written
+ *      source: The values to convert
+ *      count: The number of values
+ *      byte_order: FABRIC_BYTE_ORDER_BIG_ENDIAN or FABRIC_BYTE_ORDER_LITTLE_ENDIAN
+ */
+void Fabric_ByteSwap_copy64(void *destination, const void *source, uint32_t count, int byte_order) {
+    if (FABRIC_BYTE_ORDER_HOST != byte_order) {
+        Fabric_ByteSwap_get_kernel();
+        Fabric_ByteSwap__swap64(destination, source, count);
+    } else if (destination != source) {
+        memcpy(destination, source, (size_t)count * 8);
+    }
+}
+
+#endif
@@ -3,7 +3,7 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 23, 2015
- * Updated: March 27, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_CLASS_C__
@@ -40,6 +40,9 @@
  * A future version of this library may include a more complete type system
  * which will allow multiple inheritance.
  *
+ * The class store keeps the hierarchy numbered in memory, so descendent
+ * classes, subclass tests and total counts don't walk the child lists.
+ *
  * The database stores each class in 21 bytes
  *
  * +----+----+----+----+----+----+----+----+----+----+----+----+
@@ -61,6 +64,9 @@ typedef struct Class {
                                  // for creating unique ids
 } Class;
 
+/* Class objects are allocated from their own slab */
+static MemSlab Fabric_Class__slab = FABRIC_MEMSLAB_INITIALIZER(Class);
+
 /**
  * Gets a class's id
  */
@@ -86,7 +92,7 @@ void Fabric_Class_set_id(Class *self, classid_t id) {
  *          or NULL if there is a memory error
  */
 Class *Fabric_Class_new(classid_t id, error_t *status) {
-    Class *c = Fabric_memalloc(sizeof(Class));
+    Class *c = Fabric_memslab_alloc(&Fabric_Class__slab);
     if (c == NULL) {
         *status = Fabric_memerrno();
         return c;
@@ -101,7 +107,7 @@ Class *Fabric_Class_new(classid_t id, error_t *status) {
  * Frees a class object
  */
 void Fabric_Class_destroy(Class *self) {
-    Fabric_memfree(self, sizeof(Class));
+    Fabric_memslab_free(&Fabric_Class__slab, self);
 }
 
 /**
@@ -132,14 +138,14 @@ error_t Fabric_Class_init(Class *self, uint8_t *data) {
 }
 
 void Fabric_Class_load_bytes(Class *self, uint8_t *dest) {
-    *((labelid_t*)dest) = self->label_id;
-    *((classid_t*)(dest + 4)) = self->parent_id;
-    *((classid_t*)(dest + 6)) = self->first_child_id;
-    *((classid_t*)(dest + 8)) = self->next_child_id;
-    *((indexid_t*)(dest + 10)) = self->first_index_id;
-    *((uint32_t*)(dest + 12)) = self->count;
+    *((labelid_t*)dest) = htobe32(self->label_id);
+    *((classid_t*)(dest + 4)) = htobe16(self->parent_id);
+    *((classid_t*)(dest + 6)) = htobe16(self->first_child_id);
+    *((classid_t*)(dest + 8)) = htobe16(self->next_child_id);
+    *((indexid_t*)(dest + 10)) = htobe16(self->first_index_id);
+    *((uint32_t*)(dest + 12)) = htobe32(self->count);
     *(dest + 16) = self->is_abstract;
-    *((uint32_t*)(dest + 17)) = self->incrementer;
+    *((uint32_t*)(dest + 17)) = htobe32(self->incrementer);
 }
 
 /**
@@ -300,11 +306,14 @@ Class* Fabric_Class_get_next_child_class(Class *self, Graph *graph, error_t *sta
 }
 
 /**
- * Loads the descendent classes of a class to a specified depth
+ * Loads the ids of the descendent classes of a class to a specified depth
  *
- * The memory for the classes are dynamically allocated and should be
- * freed with Fabric_memfree(2) when they are no longer needed.
- * This is true even if this method returns an error code.
+ * The classes are found by walking the child lists, reading each class
+ * as a copy, and are listed by id since the class store's cache may evict
+ * a class while the list is still in use.  Each class can be got when it
+ * is needed with Fabric_ClassStore_get_listed_class(4).  The list should
+ * be destroyed when it is no longer needed, even if this method returns
+ * an error code.
  *
  * Args:
  *      self: The class object whose child classes are being retrieved
@@ -317,54 +326,41 @@ Class* Fabric_Class_get_next_child_class(Class *self, Graph *graph, error_t *sta
  * Returns: FABRIC_OK on success, other error number on failure
  */
 error_t Fabric_Class_load_descendent_classes(Class *self, Graph *graph, DynamicList *list, int depth) {
+    ClassStore *cs = Fabric_Graph_get_class_store(graph);
+    classid_t child_id = self->first_child_id;
+    Class child;
     error_t status;
-    Class *current_child, *next_child;
-
-    // make sure we have a child class
-    if (!Fabric_Class_has_child_classes(self)) {
-        return FABRIC_OK;
-    }
-
-    current_child = Fabric_Class_get_first_child_class(self, graph, &status);
-    if (FABRIC_OK != status) {
-        return status;
-    }
 
-    while (NULL != current_child) {
-        status = Fabric_DynamicList_append(list, current_child);
+    while (child_id != 0) {
+        status = Fabric_ClassStore_read_class(cs, child_id, &child);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        status = Fabric_DynamicList_append(list, (void*)(uintptr_t)child_id);
         if (FABRIC_OK != status) {
             return status;
         }
 
         // Add all of the child's descendents to the list
         if (depth != 1) {
-            status = Fabric_Class_load_descendent_classes(current_child, graph, list, depth - 1);
-            if (FABRIC_OK != status) {
-                return status;
-            }
-        }
-
-        if (Fabric_Class_has_next_child_class(current_child)) {
-            // get the next child class
-            next_child = Fabric_Class_get_next_child_class(current_child, graph, &status);
+            status = Fabric_Class_load_descendent_classes(&child, graph, list, depth - 1);
             if (FABRIC_OK != status) {
                 return status;
             }
-            current_child = next_child;
-        } else {
-            // let the loop know we are done
-            current_child = NULL;
         }
+        child_id = child.next_child_id;
     }
 
     return FABRIC_OK;
 }
 
 /**
- * Loads all of a classes child classes into a list
+ * Loads the ids of all of a classes child classes into a list
  *
  * The memory for the dynamic list is heap allocated, which means
- * it should be cleaned up once it is no longer needed.
+ * it should be cleaned up once it is no longer needed.  The classes are
+ * listed by id (see Fabric_Class_load_descendent_classes(4)).  A class iterator
+ * walks the same classes without allocating (see ClassIterator.c).
  *
  * Args:
  *      self: The class object whose child classes are being retrieved
@@ -372,7 +368,7 @@ error_t Fabric_Class_load_descendent_classes(Class *self, Graph *graph, DynamicL
  *      list: A pointer to dynamic list that will store the result
  *
  * Returns:
- *      A dynamic list object containing all the class's immediate child classes
+ *      A dynamic list object containing the ids of the class's immediate child classes
  *      status is set to FABRIC_OK on success, other error number on error
  */
 DynamicList *Fabric_Class_get_child_classes(Class *self, Graph *graph, error_t *status) {
@@ -384,10 +380,13 @@ DynamicList *Fabric_Class_get_child_classes(Class *self, Graph *graph, error_t *
 }
 
 /**
- * Loads all of a classes descendent classes into a list
+ * Loads the ids of all of a classes descendent classes into a list
  *
  * The memory for the dynamic list is heap allocated, which means
- * it should be cleaned up once it is no longer needed.
+ * it should be cleaned up once it is no longer needed.  The classes are
+ * found from the class hierarchy and listed in pre-order, by id (see
+ * Fabric_ClassStore_load_descendent_classes(3)).  A class iterator walks
+ * the same classes without allocating.
  *
  * Args:
  *      self: The class object whose child classes are being retrieved
@@ -395,13 +394,13 @@ DynamicList *Fabric_Class_get_child_classes(Class *self, Graph *graph, error_t *
  *      list: A pointer to dynamic list that will store the result
  *
  * Returns:
- *      A dynamic list of all the class's descendent classes
+ *      A dynamic list of the ids of all the class's descendent classes
  *      status is set to FABRIC_OK on success, other error number on failure
  */
 DynamicList *Fabric_Class_get_descendent_classes(Class *self, Graph *graph, error_t *status) {
     DynamicList *list = Fabric_DynamicList_new(status);
     if (list != NULL) {
-        *status = Fabric_Class_load_descendent_classes(self, graph, list, 0);
+        *status = Fabric_ClassStore_load_descendent_classes(Fabric_Graph_get_class_store(graph), self->id, list);
     }
     return list;
 }
@@ -472,26 +471,23 @@ bool_t Fabric_Class_has_members(Class *self) {
  *      status is set to FABRIC_OK on success, other error number on failure
  */
 uint32_t Fabric_Class_get_total_count(Class *self, Graph *graph, error_t *status) {
-    int i, l;
-    uint32_t total = self->count;
-    Class *child;
-    DynamicList *list;
-
-    // load all the classes descendents and add their count to total
-    list = Fabric_Class_get_descendent_classes(self, graph, status);
-    if (status == FABRIC_OK) {
-        for (i = 0, l = Fabric_DynamicList_count(list); i < l; i++) {
-            child = (Class*) Fabric_DynamicList_at(list, i);
-            total += child->count;
-        }
-    }
-
-    // clean up
-    if (NULL != list) {
-        Fabric_DynamicList_destroy(list);
-    }
+    return Fabric_ClassStore_get_total_count(Fabric_Graph_get_class_store(graph), self->id, status);
+}
 
-    return total;
+/**
+ * Determines whether a class is another class or one of its descendents
+ *
+ * Args:
+ *      self: The class that may be a descendent
+ *      ancestor: The class that may be its ancestor
+ *      graph: The graph object the classes belong to
+ *      status: A pointer to where any errors will be indicated
+ *
+ * Returns: TRUE if the class is the ancestor or descends from it, FALSE
+ *          if not or on failure
+ */
+bool_t Fabric_Class_is_subclass_of(Class *self, Class *ancestor, Graph *graph, error_t *status) {
+    return Fabric_ClassStore_is_subclass(Fabric_Graph_get_class_store(graph), self->id, ancestor->id, status);
 }
 
 /**
@@ -524,4 +520,59 @@ uint32_t Fabric_Class_increment(Class *self) {
     return result;
 }
 
-#endif
\ No newline at end of file
+/**
+ * Class views
+ *
+ * These read the fields of a class record straight from an EntityView
+ * without initializing a class object.
+ */
+/**
+ * Gets the label id of a viewed class
+ */
+labelid_t Fabric_ClassView_get_label_id(EntityView *view) {
+    return betoh32(*(labelid_t*)Fabric_EntityView_get_data(view));
+}
+
+/**
+ * Returns whether or not a viewed class is in use
+ */
+bool_t Fabric_ClassView_is_in_use(EntityView *view) {
+    return Fabric_ClassView_get_label_id(view) != 0;
+}
+
+/**
+ * Gets the id of a viewed class's parent class
+ */
+classid_t Fabric_ClassView_get_parent_class_id(EntityView *view) {
+    return betoh16(*(classid_t*)(Fabric_EntityView_get_data(view) + 4));
+}
+
+/**
+ * Gets the id of a viewed class's first child class
+ */
+classid_t Fabric_ClassView_get_first_child_class_id(EntityView *view) {
+    return betoh16(*(classid_t*)(Fabric_EntityView_get_data(view) + 6));
+}
+
+/**
+ * Gets the id of the next child class of a viewed class's parent
+ */
+classid_t Fabric_ClassView_get_next_child_class_id(EntityView *view) {
+    return betoh16(*(classid_t*)(Fabric_EntityView_get_data(view) + 8));
+}
+
+/**
+ * Gets the number of vertices in a viewed class
+ */
+uint32_t Fabric_ClassView_get_count(EntityView *view) {
+    return betoh32(*(uint32_t*)(Fabric_EntityView_get_data(view) + 12));
+}
+
+/**
+ * Returns whether or not a viewed class is abstract
+ */
+bool_t Fabric_ClassView_is_abstract(EntityView *view) {
+    return *(Fabric_EntityView_get_data(view) + 16);
+}
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_CLASSITERATOR_C__
+#define _FABRIC_CLASSITERATOR_C__
+
+#include "Internal.h"
+
+/**
+ * A Class Iterator walks the child classes or the descendent classes of
+ * a class one class at a time.
+ *
+ * Unlike Fabric_Class_get_child_classes(3), an iterator allocates nothing
+ * and reads a class only when it is asked for the next one, so a caller
+ * that stops early doesn't pay for the classes it never looks at.  Child
+ * classes are found by following the next_child_id fields of the class
+ * records.  Descendent classes are found from the class hierarchy by
+ * their position in pre-order, so they are also returned in pre-order.
+ *
+ * The classes returned by the iterator are copies owned by the iterator.
+ * They are valid until the next call to Fabric_ClassIterator_next(2) and
+ * are not affected by cache evictions; changes to them should be made to
+ * the class store's copy.  An iterator holds no resources and does not
+ * need to be deinitialized.
+ */
+typedef struct ClassIterator {
+    Graph *graph;           // The graph whose classes are being walked
+    classid_t class_id;     // The class whose descendents are walked, or 0 for child classes
+    classid_t next_id;      // The next child class to return; 0 at the end
+    uint32_t position;      // The position of the next descendent to return
+    Class current;          // The class most recently returned
+} ClassIterator;
+
+/**
+ * Initializes an iterator over a class's immediate child classes
+ *
+ * Args:
+ *      self: The iterator being initialized
+ *      graph: The graph the class belongs to
+ *      c: The class whose child classes are walked
+ */
+void Fabric_ClassIterator_init_children(ClassIterator *self, Graph *graph, Class *c) {
+    self->graph = graph;
+    self->class_id = 0;
+    self->next_id = Fabric_Class_get_first_child_class_id(c);
+    self->position = 0;
+}
+
+/**
+ * Initializes an iterator over all of a class's descendent classes
+ *
+ * Classes shouldn't be created or deleted while the iterator is in use,
+ * since that renumbers the class hierarchy.
+ *
+ * Args:
+ *      self: The iterator being initialized
+ *      graph: The graph the class belongs to
+ *      c: The class whose descendent classes are walked
+ */
+void Fabric_ClassIterator_init_descendents(ClassIterator *self, Graph *graph, Class *c) {
+    self->graph = graph;
+    self->class_id = Fabric_Class_get_id(c);
+    self->next_id = 0;
+    self->position = 0;
+}
+
+/**
+ * Returns the iterator's next class
+ *
+ * Args:
+ *      self: The iterator
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The next class, or NULL once every class has been returned or
+ *          if an error occurred
+ */
+Class *Fabric_ClassIterator_next(ClassIterator *self, error_t *status) {
+    ClassStore *cs = Fabric_Graph_get_class_store(self->graph);
+    classid_t class_id;
+
+    *status = FABRIC_OK;
+    if (self->class_id != 0) {
+        class_id = Fabric_ClassStore_get_descendent_class_id(cs, self->class_id, self->position, status);
+        if (class_id == 0) {
+            return NULL;
+        }
+        self->position++;
+    } else {
+        class_id = self->next_id;
+        if (class_id == 0) {
+            return NULL;
+        }
+    }
+
+    *status = Fabric_ClassStore_read_class(cs, class_id, &self->current);
+    if (FABRIC_OK != *status) {
+        self->next_id = 0;
+        return NULL;
+    }
+    self->next_id = Fabric_Class_get_next_child_class_id(&self->current);
+    return &self->current;
+}
+
+#endif
@@ -3,7 +3,7 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 23, 2015
- * Updated: March 31, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_CLASSSTORE_C__
@@ -11,8 +11,33 @@
 
 #define FABRIC_CLASSSTORE_HEADER_SIZE 6
 
+#include <string.h>
 #include "Internal.h"
 
+/**
+ * The class hierarchy numbers the classes in a pre-order walk of the
+ * class tree, so that the descendents of a class are numbered right
+ * after it.  A class's interval runs from its own number to the highest
+ * number in its subtree, and one class descends from another exactly
+ * when its number is inside the other's interval.  The hierarchy also
+ * keeps the total count of each class: the members of the class and of
+ * all its descendents.
+ *
+ * The hierarchy is built from the class records the first time it is
+ * needed.  After that it is kept up to date as classes are created and
+ * deleted and as their counts change through the class store.  Numbers
+ * start at 1; a class that isn't in use has a number of 0.
+ */
+typedef struct ClassHierarchy {
+    uint32_t capacity;          // The number of class ids the arrays have room for
+    uint32_t num_classes;       // The number of numbered classes
+    classid_t *parent_id;       // The parent of each class
+    uint16_t *enter;            // The number of each class
+    uint16_t *exit;             // The highest number in each class's subtree
+    uint32_t *total_count;      // The members of each class and its descendents
+    classid_t *order;           // The class with each number
+} ClassHierarchy;
+
 /**
  * The Class Store is the component of the graph that has the responsibility
  * of managing the storage of Class objects.
@@ -26,15 +51,323 @@
 typedef struct ClassStore {
     uint32_t offset;        // graph file offset (in bytes) for the class store
     uint16_t num_classes;   // The number of classes in the database
-    uint16_t next_free_id;  // The next free id in the class store
-                             // Free ids are stored as a link list
     uint16_t last_free_id;  // The last free id should point to a block that's never been used
-    uint32_t size;          // the size of the class store in bytes
-    EntityMap *cache;        // A cache of classes; Includes at least all classes in changed
+    FreeIdMap free_ids;     // The ids below last_free_id of deleted classes
+    ExtentList extents;     // The regions of the file that hold the class store
+    EntityCache *cache;        // A cache of classes; Includes at least all classes in changed
     IdSet *changed;          // A set of classes that have changed since last write
+    ClassHierarchy *hierarchy;  // The class hierarchy once it has been built
 } ClassStore;
 
 
+/**
+ * Internal function used by the cache to free evicted classs
+ */
+static
+void Fabric_ClassStore__destroy_class(void *class) {
+    Fabric_Class_destroy(class);
+}
+
+/**
+ * Internal function that frees the class hierarchy; it is built again
+ * the next time it is needed
+ */
+static
+void Fabric_ClassStore__forget_hierarchy(ClassStore *self) {
+    ClassHierarchy *h = self->hierarchy;
+    if (NULL == h) {
+        return;
+    }
+    Fabric_memfree_tagged(h->parent_id, h->capacity * sizeof(classid_t), FABRIC_MEM_INDEX);
+    Fabric_memfree_tagged(h->enter, h->capacity * sizeof(uint16_t), FABRIC_MEM_INDEX);
+    Fabric_memfree_tagged(h->exit, h->capacity * sizeof(uint16_t), FABRIC_MEM_INDEX);
+    Fabric_memfree_tagged(h->total_count, h->capacity * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    Fabric_memfree_tagged(h->order, h->capacity * sizeof(classid_t), FABRIC_MEM_INDEX);
+    Fabric_memfree_tagged(h, sizeof(ClassHierarchy), FABRIC_MEM_INDEX);
+    self->hierarchy = NULL;
+}
+
+/**
+ * Internal function that grows one of the class hierarchy's arrays,
+ * zeroing its new entries
+ */
+static
+error_t Fabric_ClassHierarchy__grow_array(void **array, size_t member_size, uint32_t old_capacity, uint32_t new_capacity) {
+    uint8_t *grown = Fabric_memrealloc_tagged(*array,
+        new_capacity * member_size, old_capacity * member_size, FABRIC_MEM_INDEX);
+    if (NULL == grown) {
+        return Fabric_memerrno();
+    }
+    memset(grown + old_capacity * member_size, 0, (new_capacity - old_capacity) * member_size);
+    *array = grown;
+    return FABRIC_OK;
+}
+
+/**
+ * Internal function that makes room in the class hierarchy for class ids
+ * below capacity
+ */
+static
+error_t Fabric_ClassHierarchy__reserve(ClassHierarchy *h, uint32_t capacity) {
+    error_t status;
+    if (capacity <= h->capacity) {
+        return FABRIC_OK;
+    }
+    if (FABRIC_OK != (status = Fabric_ClassHierarchy__grow_array((void**)&h->parent_id, sizeof(classid_t), h->capacity, capacity)) ||
+        FABRIC_OK != (status = Fabric_ClassHierarchy__grow_array((void**)&h->enter, sizeof(uint16_t), h->capacity, capacity)) ||
+        FABRIC_OK != (status = Fabric_ClassHierarchy__grow_array((void**)&h->exit, sizeof(uint16_t), h->capacity, capacity)) ||
+        FABRIC_OK != (status = Fabric_ClassHierarchy__grow_array((void**)&h->total_count, sizeof(uint32_t), h->capacity, capacity)) ||
+        FABRIC_OK != (status = Fabric_ClassHierarchy__grow_array((void**)&h->order, sizeof(classid_t), h->capacity, capacity))) {
+        return status;
+    }
+    h->capacity = capacity;
+    return FABRIC_OK;
+}
+
+/**
+ * Internal function that numbers the classes of a class hierarchy
+ *
+ * The classes are walked in pre-order from each root class, following
+ * the children in the order of their linked lists.
+ *
+ * Args:
+ *      h: A class hierarchy with the parents and counts of its classes
+ *      first_child_id: The first child of each class
+ *      next_child_id: The next sibling of each class
+ *      in_use: Whether each class is in use
+ *
+ * Returns: FABRIC_OK on success, FABRIC_CLASSSTORE_ERROR if the classes'
+ *          links don't form a tree
+ */
+static
+error_t Fabric_ClassHierarchy__number(ClassHierarchy *h, classid_t *first_child_id, classid_t *next_child_id, uint8_t *in_use) {
+    uint32_t root, id, child, number = 0;
+
+    for (root = 1; root < h->capacity; root++) {
+        if (!in_use[root] || (h->parent_id[root] != 0 && in_use[h->parent_id[root]])) {
+            continue;
+        }
+        h->parent_id[root] = 0;
+        id = root;
+        for (;;) {
+            if (h->enter[id] != 0) {
+                return FABRIC_CLASSSTORE_ERROR;
+            }
+            h->enter[id] = ++number;
+            h->order[number] = id;
+
+            // Go down to the first child, or over and up to the next class
+            child = first_child_id[id];
+            if (child != 0) {
+                if (child >= h->capacity || !in_use[child] || h->parent_id[child] != id) {
+                    return FABRIC_CLASSSTORE_ERROR;
+                }
+                id = child;
+                continue;
+            }
+            for (;;) {
+                h->exit[id] = number;
+                if (id == root) {
+                    break;
+                }
+                child = next_child_id[id];
+                if (child != 0) {
+                    if (child >= h->capacity || !in_use[child] || h->parent_id[child] != h->parent_id[id]) {
+                        return FABRIC_CLASSSTORE_ERROR;
+                    }
+                    id = child;
+                    break;
+                }
+                id = h->parent_id[id];
+            }
+            if (id == root) {
+                break;
+            }
+        }
+    }
+    h->num_classes = number;
+
+    // Children are numbered after their parents, so walking the numbers
+    // backwards adds each subtree's total to its parent
+    for (; number > 0; number--) {
+        id = h->order[number];
+        if (h->parent_id[id] != 0) {
+            h->total_count[h->parent_id[id]] += h->total_count[id];
+        }
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Internal function that builds the class hierarchy from the class records
+ */
+static
+error_t Fabric_ClassStore__build_hierarchy(ClassStore *self) {
+    ClassHierarchy *h;
+    EntityView view;
+    classid_t *links;
+    uint8_t *in_use;
+    uint32_t capacity, id;
+    error_t status;
+
+    // Every class that has been written fits in the store
+    capacity = self->extents.capacity + 1;
+    if (capacity < (uint32_t)self->last_free_id + 1) {
+        capacity = (uint32_t)self->last_free_id + 1;
+    }
+    if (capacity > (uint32_t)UINT16_MAX + 1) {
+        capacity = (uint32_t)UINT16_MAX + 1;
+    }
+
+    h = Fabric_memalloc_tagged(sizeof(ClassHierarchy), FABRIC_MEM_INDEX);
+    if (NULL == h) {
+        return Fabric_memerrno();
+    }
+    memset(h, 0, sizeof(ClassHierarchy));
+    self->hierarchy = h;
+    links = Fabric_memalloc_tagged(capacity * 2 * sizeof(classid_t) + capacity, FABRIC_MEM_INDEX);
+    if (NULL == links) {
+        Fabric_ClassStore__forget_hierarchy(self);
+        return Fabric_memerrno();
+    }
+    memset(links, 0, capacity * 2 * sizeof(classid_t) + capacity);
+    in_use = (uint8_t*)(links + capacity * 2);
+    status = Fabric_ClassHierarchy__reserve(h, capacity);
+
+    // Views read the classes without caching each of them
+    for (id = 1; id < capacity && FABRIC_OK == status; id++) {
+        Fabric_EntityView_init(&view);
+        status = Fabric_ClassStore_view_class(self, id, &view);
+        if (FABRIC_CLASS_DOESNT_EXIST == status || FABRIC_CLASSSTORE_INVALID_ID == status) {
+            status = FABRIC_OK;
+            continue;
+        } else if (FABRIC_OK != status) {
+            break;
+        }
+        in_use[id] = 1;
+        h->parent_id[id] = Fabric_ClassView_get_parent_class_id(&view);
+        links[id] = Fabric_ClassView_get_first_child_class_id(&view);
+        links[capacity + id] = Fabric_ClassView_get_next_child_class_id(&view);
+        h->total_count[id] = Fabric_ClassView_get_count(&view);
+        Fabric_EntityView_release(&view);
+    }
+    for (id = 1; id < capacity && FABRIC_OK == status; id++) {
+        if (in_use[id] && h->parent_id[id] >= capacity) {
+            status = FABRIC_CLASSSTORE_ERROR;
+        }
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_ClassHierarchy__number(h, links, links + capacity, in_use);
+    }
+    Fabric_memfree_tagged(links, capacity * 2 * sizeof(classid_t) + capacity, FABRIC_MEM_INDEX);
+    if (FABRIC_OK != status) {
+        Fabric_ClassStore__forget_hierarchy(self);
+    }
+    return status;
+}
+
+/**
+ * Internal function that gets the class hierarchy, building it if it
+ * hasn't been built
+ */
+static
+ClassHierarchy *Fabric_ClassStore__get_hierarchy(ClassStore *self, error_t *status) {
+    *status = FABRIC_OK;
+    if (NULL == self->hierarchy) {
+        *status = Fabric_ClassStore__build_hierarchy(self);
+    }
+    return self->hierarchy;
+}
+
+/**
+ * Internal function that numbers a new class in the class hierarchy
+ *
+ * The class must be its parent's first child and have no children, which
+ * puts it right after its parent.  A class without a parent is numbered
+ * after every other class.
+ */
+static
+error_t Fabric_ClassStore__add_to_hierarchy(ClassStore *self, classid_t class_id, classid_t parent_id) {
+    ClassHierarchy *h = self->hierarchy;
+    uint32_t id, number;
+    error_t status;
+
+    if (NULL == h) {
+        return FABRIC_OK;
+    }
+    status = Fabric_ClassHierarchy__reserve(h, (uint32_t)class_id + 1);
+    if (FABRIC_OK != status) {
+        Fabric_ClassStore__forget_hierarchy(self);
+        return FABRIC_OK;
+    }
+    if (parent_id != 0 && (parent_id >= h->capacity || h->enter[parent_id] == 0)) {
+        // A hierarchy that doesn't know the parent is out of date
+        Fabric_ClassStore__forget_hierarchy(self);
+        return FABRIC_OK;
+    }
+
+    number = parent_id == 0 ? h->num_classes + 1 : h->enter[parent_id] + 1U;
+    for (id = 1; id < h->capacity; id++) {
+        if (h->enter[id] == 0) {
+            continue;
+        }
+        if (h->enter[id] >= number) {
+            h->enter[id]++;
+        }
+        if (h->exit[id] + 1U >= number) {
+            h->exit[id]++;
+        }
+    }
+    memmove(h->order + number + 1, h->order + number, (h->num_classes + 1 - number) * sizeof(classid_t));
+    h->order[number] = class_id;
+    h->num_classes++;
+    h->enter[class_id] = number;
+    h->exit[class_id] = number;
+    h->parent_id[class_id] = parent_id;
+    h->total_count[class_id] = 0;
+    return FABRIC_OK;
+}
+
+/**
+ * Internal function that takes a class without children out of the class
+ * hierarchy
+ */
+static
+void Fabric_ClassStore__remove_from_hierarchy(ClassStore *self, classid_t class_id) {
+    ClassHierarchy *h = self->hierarchy;
+    uint32_t id, number;
+
+    if (NULL == h) {
+        return;
+    }
+    if (class_id >= h->capacity || h->enter[class_id] == 0 || h->exit[class_id] != h->enter[class_id]) {
+        Fabric_ClassStore__forget_hierarchy(self);
+        return;
+    }
+
+    number = h->enter[class_id];
+    for (id = h->parent_id[class_id]; id != 0; id = h->parent_id[id]) {
+        h->total_count[id] -= h->total_count[class_id];
+    }
+    h->enter[class_id] = 0;
+    h->exit[class_id] = 0;
+    h->parent_id[class_id] = 0;
+    h->total_count[class_id] = 0;
+    for (id = 1; id < h->capacity; id++) {
+        if (h->enter[id] == 0) {
+            continue;
+        }
+        if (h->enter[id] > number) {
+            h->enter[id]--;
+        }
+        if (h->exit[id] >= number) {
+            h->exit[id]--;
+        }
+    }
+    memmove(h->order + number, h->order + number + 1, (h->num_classes - number) * sizeof(classid_t));
+    h->num_classes--;
+}
+
 /**
  * Initializes a class store object
  *
@@ -44,30 +377,114 @@ typedef struct ClassStore {
  */
 error_t Fabric_ClassStore_init(ClassStore *self) {
     error_t status;
+    classid_t first_free_id;
+    uint8_t header[3 * sizeof(classid_t)];
     Graph *graph = Fabric_ClassStore_get_graph(self);
-    self->size = Fabric_Graph_get_label_store_offset(graph) - self->offset;
-    self->num_classes = Fabric_Graph_read_uint16(graph, self->offset);
-    self->next_free_id = Fabric_Graph_read_uint16(graph, self->offset + 2);
-    self->last_free_id = Fabric_Graph_read_uint16(graph, self->offset + 4);
+    Fabric_Graph_read_store_header(graph, header, sizeof(header), self->offset);
+    self->num_classes = betoh16(*(classid_t*)header);
+    first_free_id = betoh16(*(classid_t*)(header + 2));
+    self->last_free_id = betoh16(*(classid_t*)(header + 4));
+
+    // A new store has never handed out an id
+    if (first_free_id == 0) {
+        first_free_id = 1;
+        self->last_free_id = 1;
+    }
 
-    self->cache = Fabric_EntityMap_new(&status);
+    self->hierarchy = NULL;
+    self->cache = NULL;
+    self->changed = NULL;
+    Fabric_FreeIdMap_init(&self->free_ids);
+    status = Fabric_FreeIdMap_load(&self->free_ids, graph, FABRIC_CLASS_STORE, self->last_free_id);
+    if (FABRIC_FREEIDMAP_MISSING == status) {
+        // Older graphs link the free ids through the parent id of free classes
+        status = Fabric_FreeIdMap_load_list(&self->free_ids, graph, &self->extents,
+            first_free_id, self->last_free_id, sizeof(labelid_t), sizeof(classid_t));
+    }
     if (FABRIC_OK != status) {
         return status;
     }
+    // Changed classes are pinned in the cache until they are written
     self->changed = Fabric_IdSet_new(&status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    self->cache = Fabric_EntityCache_new(
+        FABRIC_CLASS_CACHE_SIZE,
+        FABRIC_CACHE_POLICY,
+        self->changed,
+        Fabric_ClassStore__destroy_class,
+        &status);
+    if (FABRIC_OK != status) {
+        Fabric_IdSet_destroy(self->changed);
+        self->changed = NULL;
+    }
     return status;
 }
 
+/**
+ * Frees the memory used by a class store, including its cached classes
+ *
+ * Changes that have not been flushed are lost.
+ */
+void Fabric_ClassStore_deinit(ClassStore *self) {
+    Fabric_ClassStore__forget_hierarchy(self);
+    if (NULL != self->cache) {
+        Fabric_EntityCache_destroy(self->cache);
+        self->cache = NULL;
+    }
+    if (NULL != self->changed) {
+        Fabric_IdSet_destroy(self->changed);
+        self->changed = NULL;
+    }
+    Fabric_FreeIdMap_deinit(&self->free_ids);
+}
+
 /**
  * Internal function for calculating the file offset of a class
  */
 static inline uint32_t Fabric_ClassStore__get_id_offset(ClassStore *self, classid_t class_id){
-    return (class_id - 1) * FABRIC_CLASS_STORAGE_SIZE + self->offset + FABRIC_CLASSSTORE_HEADER_SIZE;
+    return Fabric_ExtentList_get_record_offset(&self->extents, class_id);
+}
+
+/**
+ * Internal function that serializes a changed class for the flush
+ */
+static
+void Fabric_ClassStore__serialize(void *store, uint32_t class_id, uint8_t *destination) {
+    ClassStore *self = store;
+    // If the class has been changed, it MUST be in the cache
+    Fabric_Class_load_bytes(Fabric_EntityCache_get(self->cache, class_id), destination);
+}
+
+/**
+ * Internal function that saves the class store's free id map and writes its header
+ *
+ * The free ids are all in the saved map, so the header's next free id
+ * is the same as its last free id.
+ */
+static
+error_t Fabric_ClassStore__write_header(ClassStore *self) {
+    Graph *graph = Fabric_ClassStore_get_graph(self);
+    error_t status = Fabric_FreeIdMap_save(&self->free_ids, graph, FABRIC_CLASS_STORE);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    // Write the class store's header
+    Fabric_Graph_update_uint16(graph, self->num_classes, self->offset);
+    Fabric_Graph_update_uint16(graph, self->last_free_id, self->offset + 2);
+    Fabric_Graph_update_uint16(graph, self->last_free_id, self->offset + 4);
+
+    return FABRIC_OK;
 }
 
 /**
  * Writes updates to the class store to file.
  *
+ * The changed classes are written in file order, with adjacent classes
+ * written together, and the header is only rewritten if it changed.
+ *
  * Args:
  *      self: The class store whose data is being persisted
  *
@@ -78,89 +495,98 @@ static inline uint32_t Fabric_ClassStore__get_id_offset(ClassStore *self, classi
  *          before it can complete the write
  */
 error_t Fabric_ClassStore_flush(ClassStore *self) {
-    // If the changed set is empty, no changes have occurred
-    // and no write is needed
+    // If the changed set is empty, no records need to be written.
+    // Ids freed without changing a record only need the header
     if (Fabric_IdSet_is_empty(self->changed)){
-        return FABRIC_OK;
+        return Fabric_FreeIdMap_is_changed(&self->free_ids) ? Fabric_ClassStore__write_header(self) : FABRIC_OK;
     }
+    uint64_t started = Fabric_stats_now();
 
     error_t status;
     uint32_t *changed_ids = Fabric_IdSet_to_array(self->changed, &status);
-    uint32_t changed_id;
     if (FABRIC_OK != status) {
         return status;
     }
     int num_ids = Fabric_IdSet_get_count(self->changed);
+    int num_writable = 0;
     int i;
-    Class *changed_class;
-    uint16_t max_id = (self->size - FABRIC_CLASSSTORE_HEADER_SIZE ) / FABRIC_CLASS_STORAGE_SIZE;
-    uint8_t write_data[FABRIC_CLASS_STORAGE_SIZE];
-    uint32_t offset;
+    uint32_t max_changed_id = 0;
     Graph *graph = Fabric_ClassStore_get_graph(self);
 
-    for (i= 0; i < num_ids; i++) {
-        changed_id = changed_ids[i];
-        // If the class has been changed, it MUST be in the cache
-        changed_class = Fabric_EntityMap_get(self->cache, changed_id);
-        // We have to make sure we have room for the class.
-        // If not we return an error code indicating the need
-        // for the class store to be resized.  This is a relatively
-        // expensive operation and should be avoided.
-        // It is possible that the class is not currently in use which
-        // would allow the resize to be deferred.  However, there is not yet
-        // a way to ensure that the class store's next id value will remain
-        // accurate without writing it.
-        if (changed_id > max_id) {
-            return FABRIC_CLASSSTORE_NEEDS_RESIZE;
+    // Grow the store so that it has room for each class.  Classes that
+    // still don't fit stay in the changed set and an error code
+    // indicates that the class store could not be grown.
+    // It is possible that the class is not currently in use which
+    // would allow the growth to be deferred.  However, there is not yet
+    // a way to ensure that the class store's next id value will remain
+    // accurate without writing it.
+    for (i = 0; i < num_ids; i++) {
+        if (changed_ids[i] > max_changed_id) {
+            max_changed_id = changed_ids[i];
         }
+    }
+    Fabric_Graph_grow_store(graph, FABRIC_CLASS_STORE, max_changed_id);
+    for (i = 0; i < num_ids; i++) {
+        if (changed_ids[i] <= self->extents.capacity) {
+            changed_ids[num_writable++] = changed_ids[i];
+        }
+    }
 
-        offset = Fabric_ClassStore__get_id_offset(self, changed_id);
+    status = Fabric_Graph_write_records(
+        graph,
+        changed_ids,
+        num_writable,
+        &self->extents,
+        Fabric_ClassStore__serialize,
+        self);
+    Fabric_stats_add(FABRIC_STAT_FLUSHES + FABRIC_STATS_CLASS_STORE, 1);
+    Fabric_stats_add_elapsed(FABRIC_STAT_FLUSH_NANOS + FABRIC_STATS_CLASS_STORE, started);
 
-        Fabric_Class_load_bytes(changed_class, write_data);
-        // Write the class to file
-        Fabric_Graph_write_bytes(graph, write_data, FABRIC_CLASS_STORAGE_SIZE, offset);
-        // Remove the id from the set
-        // If a resize is triggered later, we won't have to write this class again
-        Fabric_IdSet_remove(self->changed, changed_id);
+    if (FABRIC_OK == status) {
+        Fabric_stats_add(FABRIC_STAT_RECORDS_WRITTEN + FABRIC_STATS_CLASS_STORE, num_writable);
+        // If the store couldn't grow, we won't have to write these classes again
+        for (i = 0; i < num_writable; i++) {
+            Fabric_IdSet_remove(self->changed, changed_ids[i]);
+        }
+        if (num_writable < num_ids) {
+            status = FABRIC_CLASSSTORE_NEEDS_RESIZE;
+        }
+    }
+    Fabric_memfree(changed_ids, sizeof(uint32_t) * num_ids);
+    if (FABRIC_OK != status) {
+        return status;
     }
 
-    // Write the class store's header
-    Fabric_Graph_write_uint16(graph, self->num_classes, self->offset);
-    Fabric_Graph_write_uint16(graph, self->next_free_id, self->offset + 2);
-    Fabric_Graph_write_uint16(Graph, self->next_free_id, self->offset + 4);
-
-    return FABRIC_OK;
+    return Fabric_ClassStore__write_header(self);
 }
 
 /**
  * Internal function for getting and updating the next id for a class
+ *
+ * The lowest id of a deleted class is reused before a new one is taken
+ * from the end of the store.
  */
 static
 classid_t Fabric_ClassStore__next_id(ClassStore *self) {
-    uint32_t next_id_offset;
-    Graph *g;
-    classid_t next_free_id = self->next_free_id;
-    if (self->next_free_id == self->last_free_id) {
-        self->next_free_id++;
-        self->last_free_id++;
-    } else if (Fabric_EntityMap_has_key(self->cache, next_free_id)) {
-        // The next free id for a free class is stored at the parent class offset
-        self->next_free_id = Fabric_Class_get_parent_class_id(Fabric_EntityMap_get(self->cache, next_free_id));
-        // TODO is there a case when such a class would not be in the changed set?
-    }
-    else {
-        g = Fabric_ClassStore_get_graph(self);
-        next_id_offset = Fabric_ClassStore__get_id_offset(self, next_free_id);
-        self->next_free_id = Fabric_Graph_read_uint16(g, next_id_offset + sizeof(labelid_t));
+    classid_t class_id = Fabric_FreeIdMap_take(&self->free_ids);
+    if (0 == class_id) {
+        class_id = self->last_free_id++;
     }
-    return next_free_id;
+    return class_id;
 }
 
+/**
+ * Internal function that frees a class's id so that it can be given out again
+ *
+ * If the free id map can't grow the id is never reused.
+ */
 static
-inline
-void Fabric_ClassStore__add_free_id(ClassStore *self, Class *class) {
-    Fabric_Class_set_parent_class_id(class, self->next_free_id);
-    self->next_free_id = Fabric_Class_get_id(class);
+void Fabric_ClassStore__add_free_id(ClassStore *self, classid_t class_id) {
+    if (class_id + 1 == self->last_free_id) {
+        self->last_free_id--;
+    } else {
+        Fabric_FreeIdMap_add(&self->free_ids, class_id);
+    }
 }
 
 /**
@@ -174,7 +600,7 @@ void Fabric_ClassStore__add_free_id(ClassStore *self, Class *class) {
  * Returns: The class object with the specified id, or NULL on failure
  */
 Class *Fabric_ClassStore_get_class(ClassStore *self, classid_t class_id, error_t *status) {
-    Class *c = Fabric_EntityMap_get(self->cache, class_id);
+    Class *c = Fabric_EntityCache_get(self->cache, class_id);
     uint32_t offset;
     uint8_t data[FABRIC_CLASS_STORAGE_SIZE];
     Graph *g;
@@ -185,21 +611,27 @@ Class *Fabric_ClassStore_get_class(ClassStore *self, classid_t class_id, error_t
     // file.  Secondary reasons are that it saves time and maintains
     // a canonical version of the class object.
     if (!c) {
-        offset = Fabric_ClassStore__get_id_offset(self, class_id);
-        if (offset > self->size + self->offset || class_id < 1) {
+        if (class_id < 1 || class_id > self->extents.capacity) {
             *status = FABRIC_CLASSSTORE_INVALID_ID;
             return c;
         }
+        offset = Fabric_ClassStore__get_id_offset(self, class_id);
         g = Fabric_ClassStore_get_graph(self);
         Fabric_Graph_read_bytes(g, data, FABRIC_CLASS_STORAGE_SIZE, offset);
+        Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_CLASS_STORE, 1);
         c = Fabric_Class_new(class_id, status);
         if (*status != FABRIC_OK) {
             // c should be NULL here
             return c;
         }
         *status = Fabric_Class_init(c, data);
-        // TODO decide what classes should be cached
-        Fabric_EntityMap_set(self->cache, class_id, c);
+        if (FABRIC_OK == *status) {
+            *status = Fabric_EntityCache_set(self->cache, class_id, c);
+        }
+        if (FABRIC_OK != *status) {
+            Fabric_Class_destroy(c);
+            return NULL;
+        }
     }
 
     // make sure the class is valid
@@ -213,6 +645,290 @@ Class *Fabric_ClassStore_get_class(ClassStore *self, classid_t class_id, error_t
     return c;
 }
 
+/**
+ * Views a class by id without creating a class object
+ *
+ * The view reads the cached class when there is one, since it may have
+ * changes not yet written to the file.  Otherwise it points at the
+ * class's record in the graph file.  The view must be released with
+ * Fabric_EntityView_release(1).
+ *
+ * Args:
+ *      self: A graph's class store
+ *      class_id: The id of the class being viewed
+ *      view: The view that is pointed at the class
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_ClassStore_view_class(ClassStore *self, classid_t class_id, EntityView *view) {
+    Class *cached = Fabric_EntityCache_get(self->cache, class_id);
+    error_t status;
+
+    if (cached) {
+        Fabric_Class_load_bytes(cached, Fabric_EntityView_copy(view));
+    } else {
+        if (class_id < 1 || class_id > self->extents.capacity) {
+            Fabric_EntityView_release(view);
+            return FABRIC_CLASSSTORE_INVALID_ID;
+        }
+        status = Fabric_EntityView_open(
+            view,
+            Fabric_ClassStore_get_graph(self),
+            FABRIC_CLASS_STORAGE_SIZE,
+            Fabric_ClassStore__get_id_offset(self, class_id));
+        if (FABRIC_OK != status) {
+            Fabric_EntityView_release(view);
+            return status;
+        }
+    }
+
+    if (!Fabric_ClassView_is_in_use(view)) {
+        Fabric_EntityView_release(view);
+        return FABRIC_CLASS_DOESNT_EXIST;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Reads a class by id into a class object owned by the caller
+ *
+ * The cached class is copied when there is one, since it may have
+ * changes not yet written to the file.  Otherwise the class's record is
+ * read from the graph file.  Either way nothing is added to the cache.
+ *
+ * Args:
+ *      self: A graph's class store
+ *      class_id: The id of the class being read
+ *      c: The class object the class is read into
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_ClassStore_read_class(ClassStore *self, classid_t class_id, Class *c) {
+    Class *cached = Fabric_EntityCache_get(self->cache, class_id);
+    uint8_t data[FABRIC_CLASS_STORAGE_SIZE];
+    error_t status;
+
+    if (cached) {
+        Fabric_Class_load_bytes(cached, data);
+    } else {
+        if (class_id < 1 || class_id > self->extents.capacity) {
+            return FABRIC_CLASSSTORE_INVALID_ID;
+        }
+        status = Fabric_Graph_read_bytes(
+            Fabric_ClassStore_get_graph(self),
+            data,
+            FABRIC_CLASS_STORAGE_SIZE,
+            Fabric_ClassStore__get_id_offset(self, class_id));
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_CLASS_STORE, 1);
+    }
+
+    Fabric_Class_set_id(c, class_id);
+    Fabric_Class_init(c, data);
+
+    if (!Fabric_Class_is_in_use(c)) {
+        return FABRIC_CLASS_DOESNT_EXIST;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Marks a class as changed so that it is written on the next flush
+ *
+ * Args:
+ *      self: A graph's class store
+ *      c: The class that was changed
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_ClassStore_update_class(ClassStore *self, Class *c) {
+    classid_t class_id = Fabric_Class_get_id(c);
+    // Mark the class as changed first so caching it can't evict it
+    error_t status = Fabric_IdSet_add(self->changed, class_id);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    return Fabric_EntityCache_set(self->cache, class_id, c);
+}
+
+/**
+ * Determines whether a class is a descendent of another class
+ *
+ * This compares the classes' intervals in the class hierarchy rather than
+ * walking the classes between them.
+ *
+ * Args:
+ *      self: A graph's class store
+ *      class_id: The class that may be a descendent
+ *      ancestor_id: The class that may be its ancestor
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: TRUE if the class is the ancestor or one of its descendents,
+ *          FALSE if not.  status is set to FABRIC_CLASS_DOESNT_EXIST if
+ *          either class isn't in use
+ */
+bool_t Fabric_ClassStore_is_subclass(ClassStore *self, classid_t class_id, classid_t ancestor_id, error_t *status) {
+    ClassHierarchy *h = Fabric_ClassStore__get_hierarchy(self, status);
+    if (FABRIC_OK != *status) {
+        return FALSE;
+    }
+    if (class_id >= h->capacity || ancestor_id >= h->capacity ||
+        h->enter[class_id] == 0 || h->enter[ancestor_id] == 0) {
+        *status = FABRIC_CLASS_DOESNT_EXIST;
+        return FALSE;
+    }
+    return h->enter[ancestor_id] <= h->enter[class_id] && h->enter[class_id] <= h->exit[ancestor_id];
+}
+
+/**
+ * Gets the number of vertices belonging to a class and all of its
+ * descendent classes from the class hierarchy
+ *
+ * Args:
+ *      self: A graph's class store
+ *      class_id: The class whose members are being counted
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The total count or 0 on failure
+ */
+uint32_t Fabric_ClassStore_get_total_count(ClassStore *self, classid_t class_id, error_t *status) {
+    ClassHierarchy *h = Fabric_ClassStore__get_hierarchy(self, status);
+    if (FABRIC_OK != *status) {
+        return 0;
+    }
+    if (class_id >= h->capacity || h->enter[class_id] == 0) {
+        *status = FABRIC_CLASS_DOESNT_EXIST;
+        return 0;
+    }
+    return h->total_count[class_id];
+}
+
+/**
+ * Gets one of a class's descendent classes by its position in pre-order
+ *
+ * The descendents are the classes numbered after the class in its
+ * interval of the class hierarchy, so the class at any position is found
+ * without walking the child lists.
+ *
+ * Args:
+ *      self: A graph's class store
+ *      class_id: The class whose descendent is being found
+ *      position: The position of the descendent, starting at 0
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The id of the descendent, or 0 if the class has no more than
+ *          position descendents or on failure
+ */
+classid_t Fabric_ClassStore_get_descendent_class_id(ClassStore *self, classid_t class_id, uint32_t position, error_t *status) {
+    ClassHierarchy *h = Fabric_ClassStore__get_hierarchy(self, status);
+    if (FABRIC_OK != *status) {
+        return 0;
+    }
+    if (class_id >= h->capacity || h->enter[class_id] == 0) {
+        *status = FABRIC_CLASS_DOESNT_EXIST;
+        return 0;
+    }
+    if (position >= (uint32_t)(h->exit[class_id] - h->enter[class_id])) {
+        return 0;
+    }
+    return h->order[h->enter[class_id] + 1U + position];
+}
+
+/**
+ * Changes the number of vertices in a class
+ *
+ * The class is marked as changed and the total counts of the class and
+ * its ancestors are kept up to date.  Class counts should only be
+ * changed through this function once the class hierarchy is in use.
+ *
+ * Args:
+ *      self: A graph's class store
+ *      c: The class whose count is changing
+ *      change: The number of members added, or removed if negative
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_ClassStore_add_to_count(ClassStore *self, Class *c, int32_t change) {
+    ClassHierarchy *h = self->hierarchy;
+    classid_t id = Fabric_Class_get_id(c);
+    error_t status;
+
+    Fabric_Class_set_count(c, Fabric_Class_get_count(c) + change);
+    status = Fabric_ClassStore_update_class(self, c);
+    if (FABRIC_OK != status) {
+        Fabric_Class_set_count(c, Fabric_Class_get_count(c) - change);
+        return status;
+    }
+    if (NULL != h) {
+        if (id >= h->capacity || h->enter[id] == 0) {
+            Fabric_ClassStore__forget_hierarchy(self);
+            return FABRIC_OK;
+        }
+        for (; id != 0; id = h->parent_id[id]) {
+            h->total_count[id] += change;
+        }
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Loads the ids of all of a class's descendent classes into a list
+ *
+ * The descendents are the classes numbered after the class in its
+ * interval of the class hierarchy, so they are found without walking
+ * the child lists.  They are listed in pre-order.
+ *
+ * The list holds ids rather than classes, since the cache may evict a
+ * class while the list is still in use.  Each class can be got when
+ * it is needed with Fabric_ClassStore_get_listed_class(4).
+ *
+ * Args:
+ *      self: A graph's class store
+ *      class_id: The class whose descendents are being loaded
+ *      list: The list the descendent class ids are appended to
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_ClassStore_load_descendent_classes(ClassStore *self, classid_t class_id, DynamicList *list) {
+    error_t status;
+    uint32_t number, exit;
+    ClassHierarchy *h = Fabric_ClassStore__get_hierarchy(self, &status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    if (class_id >= h->capacity || h->enter[class_id] == 0) {
+        return FABRIC_CLASS_DOESNT_EXIST;
+    }
+
+    exit = h->exit[class_id];
+    for (number = h->enter[class_id] + 1U; number <= exit; number++) {
+        status = Fabric_DynamicList_append(list, (void*)(uintptr_t)h->order[number]);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Gets a class from a list of class ids
+ *
+ * Args:
+ *      self: A graph's class store
+ *      list: A list of class ids, such as one loaded by
+ *            Fabric_ClassStore_load_descendent_classes(3) or
+ *            Fabric_Class_load_descendent_classes(4)
+ *      position: The position of the class in the list
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The class, or NULL on failure
+ */
+Class *Fabric_ClassStore_get_listed_class(ClassStore *self, DynamicList *list, int position, error_t *status) {
+    return Fabric_ClassStore_get_class(self, (classid_t)(uintptr_t)Fabric_DynamicList_at(list, position), status);
+}
+
 /**
  * Get's a class with a given name from the store
  *
@@ -227,12 +943,12 @@ Class *Fabric_ClassStore_get_class_by_name(ClassStore *self, text_t name, error_
     Graph *g = Fabric_ClassStore_get_graph(self);
     IndexStore *is = Fabric_Graph_get_index_store(g);
     ClassIndex *ci = Fabric_IndexStore_get_class_index(is, status);
-    if (FABRIC_OK != status) {
+    if (FABRIC_OK != *status) {
         return NULL;
     }
 
     classid_t id = Fabric_ClassIndex_get_class_id(ci, name, status);
-    if (FABRIC_OK != status) {
+    if (FABRIC_OK != *status) {
         return NULL;
     } else if (id == 0) {
         *status = FABRIC_CLASS_DOESNT_EXIST;
@@ -245,9 +961,12 @@ Class *Fabric_ClassStore_get_class_by_name(ClassStore *self, text_t name, error_
 /**
  * Creates a new class in the graph
  *
+ * The new class becomes the first child of the class it extends.
+ *
  * Args:
  *      self: The graph's class store
- *      extends: The class the one being created extends
+ *      extends: The class the one being created extends, or NULL to
+ *               create a root class
  *      name: The name of the class, must be unique
  *      is_abstract: Whether or not the new class should be made abstract
  *      status: A pointer to where an error can be indicated
@@ -273,6 +992,9 @@ Class *Fabric_ClassStore_create_class(
     error_t stat;
 
 
+    g = Fabric_ClassStore_get_graph(self);
+    is = Fabric_Graph_get_index_store(g);
+
     // Make sure the class doesn't already exist
     if(NULL != Fabric_ClassStore_get_class_by_name(self, name, status)) {
         *status = FABRIC_DUPLICATE_CLASSNAME;
@@ -291,25 +1013,23 @@ Class *Fabric_ClassStore_create_class(
     class_id = Fabric_ClassStore__next_id(self);
     c = Fabric_Class_new(class_id, status);
     if (FABRIC_OK != *status) {
-        Fabric_ClassStore__add_free_id(self, c);
+        Fabric_ClassStore__add_free_id(self, class_id);
         return NULL;
     }
 
     // Create or get an existing label for the class
-    g = Fabric_ClassStore_get_graph(self);
     ls = Fabric_Graph_get_label_store(g);
     label_id = Fabric_LabelStore_add_label(ls, name, status);
     if (FABRIC_OK != *status) {
-        Fabric_ClassStore__add_free_id(self, c);
+        Fabric_ClassStore__add_free_id(self, class_id);
         return NULL;
     }
 
     // Create the id index for the new class unless the class is abstract
     if (!is_abstract) {
-        is = Fabric_Graph_get_index_store(g);
         index_id = Fabric_IndexStore_create_id_index(is, class_id, status);
         if (FABRIC_OK != *status) {
-            Fabric_ClassStore__add_free_id(self, c);
+            Fabric_ClassStore__add_free_id(self, class_id);
             // The label should be cached, so an error shouldn't occur here
             Fabric_LabelStore_remove_label(ls, label_id);
             return NULL;
@@ -318,23 +1038,29 @@ Class *Fabric_ClassStore_create_class(
         index_id = 0;
     }
 
-    parent_class_id = Fabric_Class_get_id(extends);
+    parent_class_id = NULL == extends ? 0 : Fabric_Class_get_id(extends);
 
     Fabric_Class_set_label_id(c, label_id);
     Fabric_Class_set_parent_class_id(c, parent_class_id);
-    Fabric_Class_set_next_child_class_id(c, Fabric_Class_get_first_child_class_id(extends));
-    Fabric_Class_set_first_child_class_id(extends, class_id);
+    if (NULL != extends) {
+        Fabric_Class_set_next_child_class_id(c, Fabric_Class_get_first_child_class_id(extends));
+        Fabric_Class_set_first_child_class_id(extends, class_id);
+    } else {
+        Fabric_Class_set_next_child_class_id(c, 0);
+    }
+    Fabric_Class_set_first_child_class_id(c, 0);
     Fabric_Class_set_first_index_id(c, index_id);
     Fabric_Class_set_count(c, 0);
     Fabric_Class_set_incrementer(c, 1);
     Fabric_Class_set_is_abstract(c, is_abstract);
 
     // Make sure we are keeping track of he new class as well as the parent class
-    if (FABRIC_OK != (stat = Fabric_EntityMap_set(self->cache, class_id, c)) ||
-        FABRIC_OK != (stat = Fabric_EntityMap_set(self->cache, parent_class_id, extends))||
-        FABRIC_OK != (stat = Fabric_IdSet_add(self->changed, class_id)) ||
-        FABRIC_OK != (stat = Fabric_IdSet_add(self->changed, parent_class_id))||
-        FABRIC_OK != (stat = Fabric_IndexStore_add_class_to_index(is, c))) {
+    // Both are marked as changed first so that caching one can't evict the other
+    if (FABRIC_OK != (stat = Fabric_IdSet_add(self->changed, class_id)) ||
+        (NULL != extends && FABRIC_OK != (stat = Fabric_IdSet_add(self->changed, parent_class_id))) ||
+        FABRIC_OK != (stat = Fabric_EntityCache_set(self->cache, class_id, c)) ||
+        (NULL != extends && FABRIC_OK != (stat = Fabric_EntityCache_set(self->cache, parent_class_id, extends))) ||
+        FABRIC_OK != (stat = Fabric_IndexStore_add_class_to_index(is, c, name))) {
 
         *status = stat;
 
@@ -342,14 +1068,17 @@ Class *Fabric_ClassStore_create_class(
         if (!is_abstract) {
             Fabric_IndexStore_delete_id_index(is, index_id);
         }
-        Fabric_Class_set_first_child_class_id(extends, Fabric_Class_get_next_child_class_id(c));
+        if (NULL != extends) {
+            Fabric_Class_set_first_child_class_id(extends, Fabric_Class_get_next_child_class_id(c));
+        }
         // Mark the class as not in useand add its id back into the pot
         Fabric_Class_set_label_id(c, 0);
-        Fabric_ClassStore__add_free_id(self, c);
+        Fabric_ClassStore__add_free_id(self, class_id);
         return NULL;
     }
 
     self->num_classes++;
+    Fabric_ClassStore__add_to_hierarchy(self, class_id, parent_class_id);
     return c;
 }
 
@@ -373,7 +1102,7 @@ Class *Fabric_ClassStore_create_class(
  *      A memory error
  */
 error_t Fabric_ClassStore_delete_class(ClassStore *self, Class *c) {
-    Class *parent_class;
+    Class *parent_class = NULL;
     Class *child_class = NULL;
     classid_t class_id;
     Index *index;
@@ -400,18 +1129,20 @@ error_t Fabric_ClassStore_delete_class(ClassStore *self, Class *c) {
     g = Fabric_ClassStore_get_graph(self);
     class_id = Fabric_Class_get_id(c);
 
-    parent_class = Fabric_Class_get_parent_class(c, g, &status);
-    if (FABRIC_OK != status) {
-        return status;
+    // A root class has no parent to unlink it from
+    if (Fabric_Class_get_parent_class_id(c) != 0) {
+        parent_class = Fabric_Class_get_parent_class(c, g, &status);
+        if (FABRIC_OK != status) {
+            return status;
+        }
     }
 
     // update the class hierarchy
-    if (Fabric_Class_get_first_child_class_id(parent_class) == class_id) {
+    if (NULL == parent_class) {
+        status = FABRIC_OK;
+    } else if (Fabric_Class_get_first_child_class_id(parent_class) == class_id) {
         Fabric_Class_set_first_child_class_id(parent_class, Fabric_Class_get_next_child_class_id(c));
-        status = Fabric_EntityMap_set(self->cache, Fabric_Class_get_id(parent_class), child_class);
-        if (FABRIC_OK == status) {
-            status = Fabric_IdSet_add(self->changed, Fabric_Class_get_id(parent_class));
-        }
+        status = Fabric_ClassStore_update_class(self, parent_class);
     } else {
         child_class = Fabric_Class_get_first_child_class(parent_class, g, &status);
         if (FABRIC_OK != status) {
@@ -423,11 +1154,8 @@ error_t Fabric_ClassStore_delete_class(ClassStore *self, Class *c) {
                 return status;
             }
         }
-        Fabric_Class_set_next_child_class_id(child_class, class_id);
-        status = Fabric_EntityMap_set(self->cache, Fabric_Class_get_id(child_class), child_class);
-        if (FABRIC_OK == status) {
-            status = Fabric_IdSet_add(self->changed, Fabric_Class_get_id(child_class));
-        }
+        Fabric_Class_set_next_child_class_id(child_class, Fabric_Class_get_next_child_class_id(c));
+        status = Fabric_ClassStore_update_class(self, child_class);
     }
 
     // Update the label and class index store and track all the changes
@@ -438,19 +1166,22 @@ error_t Fabric_ClassStore_delete_class(ClassStore *self, Class *c) {
         FABRIC_OK != status ||
         FABRIC_OK != (status = Fabric_IndexStore_remove_class_from_index(is, c)) ||
         FABRIC_OK != (status = Fabric_IdSet_add(self->changed, class_id)) ||
-        FABRIC_OK != (status = Fabric_EntityMap_set(self->cache, class_id, c)) ||
+        FABRIC_OK != (status = Fabric_EntityCache_set(self->cache, class_id, c)) ||
         FABRIC_OK != (status = Fabric_IdSet_add(self->changed, class_id)) ||
         FABRIC_OK != (status = Fabric_LabelStore_remove_label(ls, label_id))) {
         // revert changes on error
-        if (child_class == NULL) {
-            Fabric_Class_set_first_child_class_id(parent_class, class_id);
-        } else {
+        if (child_class != NULL) {
             Fabric_Class_set_next_child_class_id(child_class, class_id);
+        } else if (parent_class != NULL) {
+            Fabric_Class_set_first_child_class_id(parent_class, class_id);
         }
         Fabric_IndexStore_add_class_to_index_if_not_exists(is, c);
         return status;
     }
-    Fabric_ClassStore__add_free_id(self, c);
+    // Mark the class as not in use and add its id back into the pot
+    Fabric_ClassStore__remove_from_hierarchy(self, class_id);
+    Fabric_Class_set_label_id(c, 0);
+    Fabric_ClassStore__add_free_id(self, class_id);
     self->num_classes--;
     return FABRIC_OK;
 }
@@ -0,0 +1,707 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_COMPACTION_C__
+#define _FABRIC_COMPACTION_C__
+
+#include <string.h>
+#include "Internal.h"
+
+/**
+ * A Compaction rewrites a graph's vertex, edge and property stores
+ * without their free slots, renumbering the records so that the ones
+ * used together are stored together.
+ *
+ * The vertices are put in one of three orders:
+ *
+ *      FABRIC_COMPACT_BY_ID keeps the vertices in their current order
+ *      FABRIC_COMPACT_BY_CLASS groups the vertices by class
+ *      FABRIC_COMPACT_BREADTH_FIRST numbers the vertices in the order a
+ *          breadth first search over both edge directions reaches them,
+ *          so that neighbors get nearby ids
+ *
+ * Edges are then numbered vertex by vertex in the new vertex order,
+ * which makes each vertex's out edges a contiguous run of records in
+ * the order its list visits them.  Properties are numbered the same way,
+ * the chains of the vertices first and then those of the edges.  Every
+ * reference between the records is rewritten in the same pass, and the
+ * old number of each record can be translated to its new one until the
+ * compaction is freed.
+ *
+ * The stores are read into memory whole and written back in runs.  The
+ * stores' caches are emptied, so Vertex, Edge and Property objects got
+ * from the graph before a compaction must not be used after it.  Saved
+ * adjacency snapshots are dropped, and the degree counts are rebuilt the
+ * next time they are loaded.  Property indices, property columns
+ * and label partitions refer to records by id, so a graph that has any
+ * of them can't be compacted.
+ */
+typedef struct Compaction {
+    Graph *graph;                   // The compacted graph
+    uint32_t num_vertex_ids;        // The number of entries in vertex_ids
+    vertexid_t *vertex_ids;         // The new id of each old vertex id, or 0
+    uint32_t num_edge_ids;          // The number of entries in edge_ids
+    edgeid_t *edge_ids;             // The new id of each old edge id, or 0
+    uint32_t num_property_ids;      // The number of entries in property_ids
+    propertyid_t *property_ids;     // The new id of each old property id, or 0
+} Compaction;
+
+/**
+ * Private buffers for the records while they are renumbered
+ */
+typedef struct CompactionRecords {
+    uint8_t *old_records;       // The store's records by old id
+    uint8_t *new_records;       // The store's records by new id
+    uint32_t *order;            // The old id given each new id, from new id 1
+    uint32_t count;             // The number of records in use
+} CompactionRecords;
+
+/**
+ * Private function that allocates zeroed memory for a compaction
+ */
+static
+void *Fabric_Compaction__alloc(size_t size, error_t *status) {
+    void *memory = Fabric_memalloc(size);
+    if (NULL == memory) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    memset(memory, 0, size);
+    return memory;
+}
+
+/**
+ * Private function that frees the buffers of one store
+ */
+static
+void Fabric_Compaction__free_records(CompactionRecords *records, uint32_t num_ids, size_t record_size) {
+    if (NULL != records->old_records) {
+        Fabric_memfree(records->old_records, record_size * num_ids);
+    }
+    if (NULL != records->new_records) {
+        Fabric_memfree(records->new_records, record_size * num_ids);
+    }
+    if (NULL != records->order) {
+        Fabric_memfree(records->order, sizeof(uint32_t) * num_ids);
+    }
+    records->old_records = NULL;
+    records->new_records = NULL;
+    records->order = NULL;
+}
+
+/**
+ * Private function that allocates the buffers of one store and reads
+ * its records
+ *
+ * Record i is read to old_records + i * record_size for the ids from 1
+ * to num_ids - 1.
+ */
+static
+error_t Fabric_Compaction__read_records(
+        Compaction *self,
+        CompactionRecords *records,
+        int store,
+        uint32_t num_ids,
+        size_t record_size) {
+    ExtentList *extents = Fabric_Graph_get_store_extents(self->graph, store);
+    uint32_t id = 1;
+    uint32_t length;
+    error_t status = FABRIC_OK;
+
+    records->count = 0;
+    records->old_records = Fabric_Compaction__alloc(record_size * num_ids, &status);
+    if (FABRIC_OK == status) {
+        records->new_records = Fabric_Compaction__alloc(record_size * num_ids, &status);
+    }
+    if (FABRIC_OK == status) {
+        records->order = Fabric_Compaction__alloc(sizeof(uint32_t) * num_ids, &status);
+    }
+
+    while (FABRIC_OK == status && id < num_ids) {
+        length = Fabric_ExtentList_get_contiguous(extents, id);
+        if (length > num_ids - id) {
+            length = num_ids - id;
+        }
+        if (length > FABRIC_FLUSH_RUN_SIZE / record_size) {
+            length = FABRIC_FLUSH_RUN_SIZE / record_size;
+        }
+        status = Fabric_Graph_read_bytes(
+            self->graph,
+            records->old_records + record_size * id,
+            length * record_size,
+            Fabric_ExtentList_get_record_offset(extents, id));
+        id += length;
+    }
+    return status;
+}
+
+/**
+ * Private function that writes a store's renumbered records
+ *
+ * The records from 1 to count are written from new_records and the
+ * records after them, up to num_ids - 1, are cleared.
+ */
+static
+error_t Fabric_Compaction__write_records(
+        Compaction *self,
+        CompactionRecords *records,
+        int store,
+        uint32_t num_ids,
+        size_t record_size) {
+    ExtentList *extents = Fabric_Graph_get_store_extents(self->graph, store);
+    uint32_t id = 1;
+    uint32_t length;
+    error_t status = FABRIC_OK;
+
+    // The cleared records were freed, so they are written as zeros
+    memset(records->new_records + record_size * (records->count + 1), 0,
+        record_size * (num_ids - records->count - 1));
+    while (FABRIC_OK == status && id < num_ids) {
+        length = Fabric_ExtentList_get_contiguous(extents, id);
+        if (length > num_ids - id) {
+            length = num_ids - id;
+        }
+        if (length > FABRIC_FLUSH_RUN_SIZE / record_size) {
+            length = FABRIC_FLUSH_RUN_SIZE / record_size;
+        }
+        status = Fabric_Graph_write_bytes(
+            self->graph,
+            records->new_records + record_size * id,
+            length * record_size,
+            Fabric_ExtentList_get_record_offset(extents, id));
+        id += length;
+    }
+    return status;
+}
+
+/**
+ * Private function that decodes a vertex's old record
+ *
+ * These decoders clear the object first, since init leaves it untouched
+ * for an id it rejects.
+ */
+static inline
+void Fabric_Compaction__get_vertex(CompactionRecords *vertices, vertexid_t id, Vertex *vertex) {
+    memset(vertex, 0, sizeof(Vertex));
+    Fabric_Vertex_set_id(vertex, id);
+    Fabric_Vertex_init(vertex, vertices->old_records + FABRIC_VERTEX_STORAGE_SIZE * id);
+}
+
+/**
+ * Private function that decodes an edge's old record
+ */
+static inline
+void Fabric_Compaction__get_edge(CompactionRecords *edges, edgeid_t id, Edge *edge) {
+    memset(edge, 0, sizeof(Edge));
+    Fabric_Edge_set_id(edge, id);
+    Fabric_Edge_init(edge, edges->old_records + FABRIC_EDGE_STORAGE_SIZE * id);
+}
+
+/**
+ * Private function that decodes a property's old record
+ */
+static inline
+void Fabric_Compaction__get_property(CompactionRecords *properties, propertyid_t id, Property *property) {
+    memset(property, 0, sizeof(Property));
+    Fabric_Property_set_id(property, id);
+    Fabric_Property_init(property, properties->old_records + FABRIC_PROPERTY_STORAGE_SIZE * id);
+}
+
+/**
+ * Private comparison function for sorting vertices by class and then id
+ */
+static
+int Fabric_Compaction__compare_keys(const void *a, const void *b) {
+    uint64_t key_a = *(const uint64_t*)a;
+    uint64_t key_b = *(const uint64_t*)b;
+    return key_a < key_b ? -1 : key_a > key_b;
+}
+
+/**
+ * Private function that gives a vertex the next new id
+ */
+static inline
+void Fabric_Compaction__number_vertex(Compaction *self, CompactionRecords *vertices, vertexid_t old_id) {
+    vertices->order[vertices->count++] = old_id;
+    self->vertex_ids[old_id] = vertices->count;
+}
+
+/**
+ * Private function that visits the vertices at the other ends of one of
+ * a vertex's edge lists during the breadth first search
+ */
+static
+error_t Fabric_Compaction__visit_list(
+        Compaction *self,
+        CompactionRecords *vertices,
+        CompactionRecords *edges,
+        edgeid_t edge_id,
+        int direction) {
+    vertexid_t other_id;
+    uint32_t steps;
+    Edge edge;
+
+    for (steps = 0; 0 != edge_id; steps++) {
+        // A list longer than the store has a loop
+        if (edge_id >= self->num_edge_ids || steps >= self->num_edge_ids) {
+            return FABRIC_COMPACTION_ERROR;
+        }
+        Fabric_Compaction__get_edge(edges, edge_id, &edge);
+        if (FABRIC_DIRECTION_OUT == direction) {
+            other_id = Fabric_Edge_get_to_vertex_id(&edge);
+            edge_id = Fabric_Edge_get_next_out_edge_id(&edge);
+        } else {
+            other_id = Fabric_Edge_get_from_vertex_id(&edge);
+            edge_id = Fabric_Edge_get_next_in_edge_id(&edge);
+        }
+        if (other_id > 0 && other_id < self->num_vertex_ids && 0 == self->vertex_ids[other_id]) {
+            Fabric_Compaction__number_vertex(self, vertices, other_id);
+        }
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that puts the vertices in use in their new order
+ */
+static
+error_t Fabric_Compaction__order_vertices(
+        Compaction *self,
+        CompactionRecords *vertices,
+        CompactionRecords *edges,
+        int order) {
+    VertexStore *vertex_store = Fabric_Graph_get_vertex_store(self->graph);
+    uint32_t num_in_use = 0;
+    uint32_t head, i;
+    uint64_t *keys;
+    vertexid_t id;
+    Vertex vertex;
+    error_t status = FABRIC_OK;
+
+    // Vertices that are in use have a class
+    for (id = 1; id < self->num_vertex_ids; id++) {
+        Fabric_Compaction__get_vertex(vertices, id, &vertex);
+        if (Fabric_Vertex_is_in_use(&vertex) && !Fabric_FreeIdMap_has(&vertex_store->free_ids, id)) {
+            vertices->order[num_in_use++] = id;
+        }
+    }
+
+    if (FABRIC_COMPACT_BY_CLASS == order) {
+        keys = Fabric_Compaction__alloc(sizeof(uint64_t) * (num_in_use + 1), &status);
+        if (NULL == keys) {
+            return status;
+        }
+        for (i = 0; i < num_in_use; i++) {
+            Fabric_Compaction__get_vertex(vertices, vertices->order[i], &vertex);
+            keys[i] = ((uint64_t)Fabric_Vertex_get_class_id(&vertex) << 32) | vertices->order[i];
+        }
+        qsort(keys, num_in_use, sizeof(uint64_t), Fabric_Compaction__compare_keys);
+        for (i = 0; i < num_in_use; i++) {
+            vertices->order[i] = (uint32_t)keys[i];
+        }
+        Fabric_memfree(keys, sizeof(uint64_t) * (num_in_use + 1));
+    }
+
+    if (FABRIC_COMPACT_BREADTH_FIRST != order) {
+        for (i = 0; i < num_in_use; i++) {
+            self->vertex_ids[vertices->order[i]] = i + 1;
+        }
+        vertices->count = num_in_use;
+        return FABRIC_OK;
+    }
+
+    // The search restarts from the lowest vertex it hasn't reached yet.
+    // The vertices in use were found in id order, so their ids are moved
+    // out of order before it becomes the search's queue.
+    keys = Fabric_Compaction__alloc(sizeof(uint64_t) * (num_in_use + 1), &status);
+    if (NULL == keys) {
+        return status;
+    }
+    for (i = 0; i < num_in_use; i++) {
+        keys[i] = vertices->order[i];
+    }
+    head = 0;
+    vertices->count = 0;
+    for (i = 0; i < num_in_use && FABRIC_OK == status; i++) {
+        if (0 != self->vertex_ids[keys[i]]) {
+            continue;
+        }
+        Fabric_Compaction__number_vertex(self, vertices, keys[i]);
+        while (head < vertices->count && FABRIC_OK == status) {
+            Fabric_Compaction__get_vertex(vertices, vertices->order[head++], &vertex);
+            status = Fabric_Compaction__visit_list(
+                self, vertices, edges, Fabric_Vertex_get_first_out_edge_id(&vertex), FABRIC_DIRECTION_OUT);
+            if (FABRIC_OK == status) {
+                status = Fabric_Compaction__visit_list(
+                    self, vertices, edges, Fabric_Vertex_get_first_in_edge_id(&vertex), FABRIC_DIRECTION_IN);
+            }
+        }
+    }
+    Fabric_memfree(keys, sizeof(uint64_t) * (num_in_use + 1));
+    return status;
+}
+
+/**
+ * Private function that numbers the edges vertex by vertex, following
+ * each vertex's out edge list
+ */
+static
+error_t Fabric_Compaction__order_edges(Compaction *self, CompactionRecords *vertices, CompactionRecords *edges) {
+    edgeid_t edge_id;
+    Vertex vertex;
+    Edge edge;
+    uint32_t i;
+
+    edges->count = 0;
+    for (i = 0; i < vertices->count; i++) {
+        Fabric_Compaction__get_vertex(vertices, vertices->order[i], &vertex);
+        edge_id = Fabric_Vertex_get_first_out_edge_id(&vertex);
+        while (0 != edge_id) {
+            // A list that reaches an edge twice is corrupt
+            if (edge_id >= self->num_edge_ids || 0 != self->edge_ids[edge_id]) {
+                return FABRIC_COMPACTION_ERROR;
+            }
+            edges->order[edges->count++] = edge_id;
+            self->edge_ids[edge_id] = edges->count;
+            Fabric_Compaction__get_edge(edges, edge_id, &edge);
+            edge_id = Fabric_Edge_get_next_out_edge_id(&edge);
+        }
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that numbers the properties of one chain
+ */
+static
+error_t Fabric_Compaction__order_chain(Compaction *self, CompactionRecords *properties, propertyid_t property_id) {
+    Property property;
+
+    while (0 != property_id) {
+        if (property_id >= self->num_property_ids || 0 != self->property_ids[property_id]) {
+            return FABRIC_COMPACTION_ERROR;
+        }
+        properties->order[properties->count++] = property_id;
+        self->property_ids[property_id] = properties->count;
+        Fabric_Compaction__get_property(properties, property_id, &property);
+        property_id = Fabric_Property_get_next_property_id(&property);
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that numbers the properties chain by chain, the
+ * vertices' chains first and then the edges'
+ */
+static
+error_t Fabric_Compaction__order_properties(
+        Compaction *self,
+        CompactionRecords *vertices,
+        CompactionRecords *edges,
+        CompactionRecords *properties) {
+    Vertex vertex;
+    Edge edge;
+    uint32_t i;
+    error_t status = FABRIC_OK;
+
+    properties->count = 0;
+    for (i = 0; i < vertices->count && FABRIC_OK == status; i++) {
+        Fabric_Compaction__get_vertex(vertices, vertices->order[i], &vertex);
+        status = Fabric_Compaction__order_chain(self, properties, Fabric_Vertex_get_first_property_id(&vertex));
+    }
+    for (i = 0; i < edges->count && FABRIC_OK == status; i++) {
+        Fabric_Compaction__get_edge(edges, edges->order[i], &edge);
+        status = Fabric_Compaction__order_chain(self, properties, Fabric_Edge_get_first_property_id(&edge));
+    }
+    return status;
+}
+
+/**
+ * Private function that translates an old id through a map
+ */
+static inline
+uint32_t Fabric_Compaction__map(uint32_t *ids, uint32_t num_ids, uint32_t old_id) {
+    return old_id < num_ids ? ids[old_id] : 0;
+}
+
+/**
+ * Private function that builds the renumbered records of every store
+ */
+static
+void Fabric_Compaction__renumber(
+        Compaction *self,
+        CompactionRecords *vertices,
+        CompactionRecords *edges,
+        CompactionRecords *properties) {
+    Vertex vertex;
+    Edge edge;
+    Property property;
+    uint32_t i;
+
+    for (i = 0; i < vertices->count; i++) {
+        Fabric_Compaction__get_vertex(vertices, vertices->order[i], &vertex);
+        Fabric_Vertex_set_first_out_edge_id(&vertex, Fabric_Compaction__map(
+            self->edge_ids, self->num_edge_ids, Fabric_Vertex_get_first_out_edge_id(&vertex)));
+        Fabric_Vertex_set_first_in_edge_id(&vertex, Fabric_Compaction__map(
+            self->edge_ids, self->num_edge_ids, Fabric_Vertex_get_first_in_edge_id(&vertex)));
+        Fabric_Vertex_set_first_property_id(&vertex, Fabric_Compaction__map(
+            self->property_ids, self->num_property_ids, Fabric_Vertex_get_first_property_id(&vertex)));
+        Fabric_Vertex_load_bytes(&vertex, vertices->new_records + FABRIC_VERTEX_STORAGE_SIZE * (i + 1));
+    }
+
+    for (i = 0; i < edges->count; i++) {
+        Fabric_Compaction__get_edge(edges, edges->order[i], &edge);
+        Fabric_Edge_set_from_vertex_id(&edge, Fabric_Compaction__map(
+            self->vertex_ids, self->num_vertex_ids, Fabric_Edge_get_from_vertex_id(&edge)));
+        Fabric_Edge_set_to_vertex_id(&edge, Fabric_Compaction__map(
+            self->vertex_ids, self->num_vertex_ids, Fabric_Edge_get_to_vertex_id(&edge)));
+        Fabric_Edge_set_next_out_edge_id(&edge, Fabric_Compaction__map(
+            self->edge_ids, self->num_edge_ids, Fabric_Edge_get_next_out_edge_id(&edge)));
+        Fabric_Edge_set_next_in_edge_id(&edge, Fabric_Compaction__map(
+            self->edge_ids, self->num_edge_ids, Fabric_Edge_get_next_in_edge_id(&edge)));
+        Fabric_Edge_set_first_property_id(&edge, Fabric_Compaction__map(
+            self->property_ids, self->num_property_ids, Fabric_Edge_get_first_property_id(&edge)));
+        Fabric_Edge_load_bytes(&edge, edges->new_records + FABRIC_EDGE_STORAGE_SIZE * (i + 1));
+    }
+
+    // Only the chain link of a property changes
+    for (i = 0; i < properties->count; i++) {
+        Fabric_Compaction__get_property(properties, properties->order[i], &property);
+        Fabric_Property_set_next_property_id(&property, Fabric_Compaction__map(
+            self->property_ids, self->num_property_ids, Fabric_Property_get_next_property_id(&property)));
+        Fabric_Property_load_bytes(&property, properties->new_records + FABRIC_PROPERTY_STORAGE_SIZE * (i + 1));
+    }
+}
+
+/**
+ * Private function that empties a store's free ids and rewrites its
+ * header for its new number of records
+ */
+static
+error_t Fabric_Compaction__write_header(Compaction *self, FreeIdMap *free_ids, int store, uint32_t offset, uint32_t count) {
+    error_t status;
+
+    // Taking the ids marks the map changed so that the saved one is emptied
+    while (0 != Fabric_FreeIdMap_take(free_ids));
+    status = Fabric_FreeIdMap_save(free_ids, self->graph, store);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    Fabric_Graph_update_uint32(self->graph, count, offset);
+    Fabric_Graph_update_uint32(self->graph, count + 1, offset + 4);
+    Fabric_Graph_update_uint32(self->graph, count + 1, offset + 8);
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that reloads the compacted stores from the file,
+ * which empties their caches
+ */
+static
+error_t Fabric_Compaction__reload_stores(Compaction *self) {
+    VertexStore *vertex_store = Fabric_Graph_get_vertex_store(self->graph);
+    EdgeStore *edge_store = Fabric_Graph_get_edge_store(self->graph);
+    PropertyStore *property_store = Fabric_Graph_get_property_store(self->graph);
+    error_t status;
+
+    Fabric_VertexStore_deinit(vertex_store);
+    Fabric_EdgeStore_deinit(edge_store);
+    Fabric_PropertyStore_deinit(property_store);
+    status = Fabric_VertexStore_init(vertex_store);
+    if (FABRIC_OK == status) {
+        status = Fabric_EdgeStore_init(edge_store);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_PropertyStore_init(property_store);
+    }
+    return status;
+}
+
+/**
+ * Compacts a graph's vertex, edge and property stores
+ *
+ * Changes held by the stores are flushed first.  The compaction keeps the
+ * maps from the old ids to the new ones until it is freed with
+ * Fabric_Compaction_deinit(1), which must be done whether or not it
+ * succeeded.  A compaction that fails after it starts writing leaves
+ * the graph inconsistent unless the graph has a write-ahead log and the
+ * failed writes aren't committed.
+ *
+ * Args:
+ *      self: The compaction
+ *      graph: The graph being compacted
+ *      order: FABRIC_COMPACT_BY_ID, FABRIC_COMPACT_BY_CLASS or
+ *             FABRIC_COMPACT_BREADTH_FIRST
+ *
+ * Returns: FABRIC_OK on success, FABRIC_COMPACTION_HAS_INDEXES if the graph
+ *          has property indices, property columns or label partitions,
+ *          FABRIC_COMPACTION_ERROR if an edge list or property chain is
+ *          corrupt or other error code on failure
+ */
+error_t Fabric_Compaction_run(Compaction *self, Graph *graph, int order) {
+    VertexStore *vertex_store = Fabric_Graph_get_vertex_store(graph);
+    EdgeStore *edge_store = Fabric_Graph_get_edge_store(graph);
+    PropertyStore *property_store = Fabric_Graph_get_property_store(graph);
+    CompactionRecords vertices, edges, properties;
+    LabelPartitionDirectory *partitions;
+    error_t status;
+
+    self->graph = graph;
+    self->num_vertex_ids = vertex_store->last_free_id;
+    self->num_edge_ids = edge_store->last_free_id;
+    self->num_property_ids = property_store->last_free_id;
+    self->vertex_ids = NULL;
+    self->edge_ids = NULL;
+    self->property_ids = NULL;
+    memset(&vertices, 0, sizeof(vertices));
+    memset(&edges, 0, sizeof(edges));
+    memset(&properties, 0, sizeof(properties));
+
+    status = Fabric_ClassStore_flush(Fabric_Graph_get_class_store(graph));
+    if (FABRIC_OK == status) {
+        status = Fabric_VertexStore_flush(vertex_store);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_EdgeStore_flush(edge_store);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_PropertyStore_flush(property_store);
+    }
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    // Indices and partitions would still hold the old ids
+    if (Fabric_IndexStore_has_property_indexes(Fabric_Graph_get_index_store(graph), &status)) {
+        return FABRIC_COMPACTION_HAS_INDEXES;
+    } else if (FABRIC_OK != status) {
+        return status;
+    }
+    partitions = Fabric_EdgeStore_get_label_partitions(edge_store, &status);
+    if (NULL == partitions) {
+        return status;
+    } else if (Fabric_LabelPartitionDirectory_get_count(partitions) > 0) {
+        return FABRIC_COMPACTION_HAS_INDEXES;
+    }
+
+    self->vertex_ids = Fabric_Compaction__alloc(sizeof(vertexid_t) * self->num_vertex_ids, &status);
+    if (FABRIC_OK == status) {
+        self->edge_ids = Fabric_Compaction__alloc(sizeof(edgeid_t) * self->num_edge_ids, &status);
+    }
+    if (FABRIC_OK == status) {
+        self->property_ids = Fabric_Compaction__alloc(sizeof(propertyid_t) * self->num_property_ids, &status);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_Compaction__read_records(
+            self, &vertices, FABRIC_VERTEX_STORE, self->num_vertex_ids, FABRIC_VERTEX_STORAGE_SIZE);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_Compaction__read_records(
+            self, &edges, FABRIC_EDGE_STORE, self->num_edge_ids, FABRIC_EDGE_STORAGE_SIZE);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_Compaction__read_records(
+            self, &properties, FABRIC_PROPERTY_STORE, self->num_property_ids, FABRIC_PROPERTY_STORAGE_SIZE);
+    }
+
+    if (FABRIC_OK == status) {
+        status = Fabric_Compaction__order_vertices(self, &vertices, &edges, order);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_Compaction__order_edges(self, &vertices, &edges);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_Compaction__order_properties(self, &vertices, &edges, &properties);
+    }
+
+    // Nothing is written until every record has been renumbered
+    if (FABRIC_OK == status) {
+        Fabric_Compaction__renumber(self, &vertices, &edges, &properties);
+        status = Fabric_Compaction__write_records(
+            self, &vertices, FABRIC_VERTEX_STORE, self->num_vertex_ids, FABRIC_VERTEX_STORAGE_SIZE);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_Compaction__write_records(
+            self, &edges, FABRIC_EDGE_STORE, self->num_edge_ids, FABRIC_EDGE_STORAGE_SIZE);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_Compaction__write_records(
+            self, &properties, FABRIC_PROPERTY_STORE, self->num_property_ids, FABRIC_PROPERTY_STORAGE_SIZE);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_Compaction__write_header(
+            self, &vertex_store->free_ids, FABRIC_VERTEX_STORE, vertex_store->offset, vertices.count);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_Compaction__write_header(
+            self, &edge_store->free_ids, FABRIC_EDGE_STORE, edge_store->offset, edges.count);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_Compaction__write_header(
+            self, &property_store->free_ids, FABRIC_PROPERTY_STORE, property_store->offset, properties.count);
+    }
+    if (FABRIC_OK == status) {
+        Fabric_AdjacencySnapshot_drop(graph);
+        status = Fabric_DegreeCounts_drop(graph);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_Compaction__reload_stores(self);
+    }
+
+    Fabric_Compaction__free_records(&vertices, self->num_vertex_ids, FABRIC_VERTEX_STORAGE_SIZE);
+    Fabric_Compaction__free_records(&edges, self->num_edge_ids, FABRIC_EDGE_STORAGE_SIZE);
+    Fabric_Compaction__free_records(&properties, self->num_property_ids, FABRIC_PROPERTY_STORAGE_SIZE);
+    return status;
+}
+
+/**
+ * Frees the id maps held by a compaction
+ */
+void Fabric_Compaction_deinit(Compaction *self) {
+    if (NULL != self->vertex_ids) {
+        Fabric_memfree(self->vertex_ids, sizeof(vertexid_t) * self->num_vertex_ids);
+    }
+    if (NULL != self->edge_ids) {
+        Fabric_memfree(self->edge_ids, sizeof(edgeid_t) * self->num_edge_ids);
+    }
+    if (NULL != self->property_ids) {
+        Fabric_memfree(self->property_ids, sizeof(propertyid_t) * self->num_property_ids);
+    }
+    self->vertex_ids = NULL;
+    self->edge_ids = NULL;
+    self->property_ids = NULL;
+}
+
+/**
+ * Gets the id a compaction gave a vertex
+ *
+ * Returns: The vertex's new id, or 0 if old_id wasn't a vertex in use
+ */
+vertexid_t Fabric_Compaction_get_vertex_id(Compaction *self, vertexid_t old_id) {
+    return NULL == self->vertex_ids ? 0 : Fabric_Compaction__map(self->vertex_ids, self->num_vertex_ids, old_id);
+}
+
+/**
+ * Gets the id a compaction gave an edge
+ *
+ * Returns: The edge's new id, or 0 if old_id wasn't an edge in use
+ */
+edgeid_t Fabric_Compaction_get_edge_id(Compaction *self, edgeid_t old_id) {
+    return NULL == self->edge_ids ? 0 : Fabric_Compaction__map(self->edge_ids, self->num_edge_ids, old_id);
+}
+
+/**
+ * Gets the id a compaction gave a property
+ *
+ * Returns: The property's new id, or 0 if old_id wasn't a property in use
+ */
+propertyid_t Fabric_Compaction_get_property_id(Compaction *self, propertyid_t old_id) {
+    return NULL == self->property_ids ? 0 : Fabric_Compaction__map(self->property_ids, self->num_property_ids, old_id);
+}
+
+#endif
@@ -0,0 +1,254 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_COMPRESSION_C__
+#define _FABRIC_COMPRESSION_C__
+
+#include <string.h>
+#include "Internal.h"
+
+#define FABRIC_COMPRESSION_MIN_MATCH 4
+#define FABRIC_COMPRESSION_HASH_BITS 12
+#define FABRIC_COMPRESSION_LAST_LITERALS 5
+#define FABRIC_COMPRESSION_MATCH_LIMIT 12
+#define FABRIC_COMPRESSION_MAX_OFFSET 65535
+
+/**
+ * A small compressor for stored values
+ *
+ * The compressed data uses the LZ4 block format, so it can be read by
+ * any LZ4 implementation, but the library doesn't depend on one.  The
+ * data is a series of sequences, each made of a token byte, a run of
+ * literal bytes and a match that copies earlier output:
+ *
+ *      token (1 byte): the literal length in the high 4 bits and the
+ *          match length minus 4 in the low 4 bits.  A field of 15 is
+ *          continued by the bytes after it, which are added to it up
+ *          to and including the first byte that isn't 255.
+ *      literals
+ *      offset (2 bytes, little endian): how far back the match starts
+ *      match length continuation bytes
+ *
+ * The last sequence has only literals, and the last 5 bytes of the input
+ * are always literals.
+ *
+ * Matches are found greedily with a hash table of recent 4 byte strings,
+ * which favours speed over the size of the output.
+ */
+
+/**
+ * Gets the largest size the compressed form of some data can have
+ *
+ * Args:
+ *      size: The size of the uncompressed data
+ */
+uint32_t Fabric_Compression_bound(uint32_t size) {
+    return size + size / 255 + 16;
+}
+
+/**
+ * Private function that hashes the 4 bytes at p
+ */
+static inline
+uint32_t Fabric_Compression__hash(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return (value * 2654435761U) >> (32 - FABRIC_COMPRESSION_HASH_BITS);
+}
+
+/**
+ * Private function that writes the continuation bytes of a length
+ *
+ * Returns: The position after the bytes or NULL if they don't fit
+ */
+static
+uint8_t *Fabric_Compression__write_length(uint8_t *out, uint8_t *end, uint32_t length) {
+    for (; length >= 255; length -= 255) {
+        if (out >= end) {
+            return NULL;
+        }
+        *out++ = 255;
+    }
+    if (out >= end) {
+        return NULL;
+    }
+    *out++ = length;
+    return out;
+}
+
+/**
+ * Private function that writes a sequence
+ *
+ * Returns: The position after the sequence or NULL if it doesn't fit
+ */
+static
+uint8_t *Fabric_Compression__write_sequence(
+    uint8_t *out,
+    uint8_t *end,
+    const uint8_t *literals,
+    uint32_t num_literals,
+    uint32_t offset,
+    uint32_t match_length) {
+
+    uint8_t *token = out++;
+    uint32_t match_code = match_length - FABRIC_COMPRESSION_MIN_MATCH;
+
+    if (token >= end) {
+        return NULL;
+    }
+    *token = (num_literals < 15 ? num_literals : 15) << 4;
+    if (num_literals >= 15 && NULL == (out = Fabric_Compression__write_length(out, end, num_literals - 15))) {
+        return NULL;
+    }
+    if (num_literals > (uint32_t)(end - out)) {
+        return NULL;
+    }
+    memcpy(out, literals, num_literals);
+    out += num_literals;
+
+    // The last sequence has no match
+    if (0 == match_length) {
+        return out;
+    }
+    if (end - out < 2) {
+        return NULL;
+    }
+    *out++ = offset & 0xff;
+    *out++ = offset >> 8;
+    *token |= match_code < 15 ? match_code : 15;
+    if (match_code >= 15) {
+        out = Fabric_Compression__write_length(out, end, match_code - 15);
+    }
+    return out;
+}
+
+/**
+ * Compresses data
+ *
+ * Args:
+ *      source: The data being compressed
+ *      size: The size of the data
+ *      destination: Where the compressed data is written
+ *      capacity: The size of destination.  Output that would be larger
+ *                is abandoned, so a capacity below size only succeeds
+ *                when compressing saves space.
+ *
+ * Returns: The size of the compressed data or 0 if it doesn't fit
+ */
+uint32_t Fabric_Compression_compress(const uint8_t *source, uint32_t size, uint8_t *destination, uint32_t capacity) {
+    uint32_t table[1 << FABRIC_COMPRESSION_HASH_BITS];
+    uint8_t *out = destination;
+    uint8_t *end = destination + capacity;
+    uint32_t anchor = 0, position = 0, candidate, length, hash;
+    uint32_t match_end = size > FABRIC_COMPRESSION_LAST_LITERALS ? size - FABRIC_COMPRESSION_LAST_LITERALS : 0;
+
+    // Positions are stored plus one, so 0 is an empty slot
+    memset(table, 0, sizeof(table));
+    while (size > FABRIC_COMPRESSION_MATCH_LIMIT && position < size - FABRIC_COMPRESSION_MATCH_LIMIT) {
+        hash = Fabric_Compression__hash(source + position);
+        candidate = table[hash];
+        table[hash] = position + 1;
+        if (0 == candidate-- ||
+            position - candidate > FABRIC_COMPRESSION_MAX_OFFSET ||
+            0 != memcmp(source + candidate, source + position, FABRIC_COMPRESSION_MIN_MATCH)) {
+            position++;
+            continue;
+        }
+
+        length = FABRIC_COMPRESSION_MIN_MATCH;
+        while (position + length < match_end && source[candidate + length] == source[position + length]) {
+            length++;
+        }
+        out = Fabric_Compression__write_sequence(out, end,
+            source + anchor, position - anchor, position - candidate, length);
+        if (NULL == out) {
+            return 0;
+        }
+        position += length;
+        anchor = position;
+    }
+
+    out = Fabric_Compression__write_sequence(out, end, source + anchor, size - anchor, 0, 0);
+    return NULL == out ? 0 : out - destination;
+}
+
+/**
+ * Private function that reads the continuation bytes of a length
+ *
+ * Returns: FALSE if the input ends first or the length passes limit
+ */
+static
+bool_t Fabric_Compression__read_length(const uint8_t *source, uint32_t size, uint32_t *position, uint32_t *length, uint32_t limit) {
+    uint8_t byte;
+    do {
+        if (*position >= size || *length > limit) {
+            return FALSE;
+        }
+        byte = source[(*position)++];
+        *length += byte;
+    } while (byte == 255);
+    return TRUE;
+}
+
+/**
+ * Decompresses data
+ *
+ * Corrupt input is detected rather than read or written past the ends
+ * of the buffers.
+ *
+ * Args:
+ *      source: The compressed data
+ *      size: The size of the compressed data
+ *      destination: Where the data is written
+ *      original_size: The size of the data before it was compressed
+ *
+ * Returns: TRUE if the data decompressed to exactly original_size bytes
+ */
+bool_t Fabric_Compression_decompress(const uint8_t *source, uint32_t size, uint8_t *destination, uint32_t original_size) {
+    uint32_t position = 0, written = 0, length, offset, i;
+    uint8_t token;
+
+    while (position < size) {
+        token = source[position++];
+        length = token >> 4;
+        if (length == 15 && !Fabric_Compression__read_length(source, size, &position, &length, original_size)) {
+            return FALSE;
+        }
+        if (length > size - position || length > original_size - written) {
+            return FALSE;
+        }
+        memcpy(destination + written, source + position, length);
+        position += length;
+        written += length;
+        if (position == size) {
+            break;
+        }
+
+        if (size - position < 2) {
+            return FALSE;
+        }
+        offset = source[position] | (source[position + 1] << 8);
+        position += 2;
+        length = token & 15;
+        if (length == 15 && !Fabric_Compression__read_length(source, size, &position, &length, original_size)) {
+            return FALSE;
+        }
+        length += FABRIC_COMPRESSION_MIN_MATCH;
+        if (0 == offset || offset > written || length > original_size - written) {
+            return FALSE;
+        }
+        // A match can overlap the bytes it produces
+        for (i = 0; i < length; i++) {
+            destination[written + i] = destination[written - offset + i];
+        }
+        written += length;
+    }
+    return written == original_size;
+}
+
+#endif
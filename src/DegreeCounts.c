@@ -0,0 +1,768 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_DEGREECOUNTS_C__
+#define _FABRIC_DEGREECOUNTS_C__
+
+#include <string.h>
+#include "Internal.h"
+
+#define FABRIC_DEGREE_COUNTS_PAGE_ID 6
+#define FABRIC_DEGREE_COUNTS_TYPE 0x0A
+#define FABRIC_DEGREE_COUNTS_HEADER_SIZE 12
+#define FABRIC_DEGREE_COUNTS_FIELDS 4
+
+/**
+ * Degree Counts are the edge statistics of a graph: the number of out
+ * edges and in edges of every vertex, the number of edges with each
+ * label, and for each class a histogram of its vertices' degrees.  They
+ * give the degree of a vertex without walking its edge lists, and let a
+ * query choose the end of a pattern with the fewer edges.
+ *
+ * Bucket b of a histogram counts the vertices of the class with a degree
+ * from 2^b up to 2^(b+1) - 1 in the direction, so there are
+ * FABRIC_DEGREE_BUCKETS of them.  Vertices without edges in a direction
+ * aren't counted; the class's count includes them.  A histogram holds a
+ * vertex's immediate class only.
+ *
+ * The counts sit next to the edge store, which updates them as it creates
+ * edges, and are loaded the first time an edge is created or the counts
+ * are asked for.  They are written when the edge store is flushed, as a
+ * sequence of 32 bit words spread over a chain of index pages starting at
+ * root page 6.  Each page has a 12 byte header:
+ *
+ *      type (1 byte): 0x0A
+ *      unused (3 bytes)
+ *      next_page_id (4 bytes): the next page of the chain, 0 for the last
+ *      used (4 bytes): the number of bytes of words after the header
+ *
+ * The words are the number of edges counted, the number of vertex ids,
+ * label ids and class ids that have counts, then the edge count of each
+ * label id, the histograms of each class id (the out buckets then the in
+ * buckets), and finally the out degree and in degree of each vertex id.
+ * Every page but the last is full, and only the pages whose words changed
+ * are written.  Since the vertices come last, new vertices only add to
+ * the end of the chain.
+ *
+ * Counts whose number of edges doesn't match the edge store, such as
+ * those of an older graph or of a graph bulk loaded since they were
+ * written, are rebuilt from the edge records when they are loaded.
+ * Graphs made before the index store had six root pages may have given
+ * page 6 to another index.  Their counts are kept in memory only and
+ * rebuilt each time they are loaded.
+ */
+struct DegreeCounts {
+    EdgeStore *store;           // The edge store whose edges are counted
+    uint32_t num_edges;         // The number of edges counted
+    uint32_t num_vertices;      // The number of vertex ids with degrees, including 0
+    uint32_t degree_cap;        // The capacity of degrees
+    uint32_t *degrees;          // The out degree and in degree of each vertex id
+    uint32_t num_labels;        // The number of label ids with counts, including 0
+    uint32_t label_cap;         // The capacity of label_counts
+    uint32_t *label_counts;     // The number of edges with each label id
+    uint32_t num_classes;       // The number of class ids with histograms, including 0
+    uint32_t histogram_cap;     // The capacity of histograms
+    uint32_t *histograms;       // The out and in histograms of each class id
+    uint32_t *page_ids;         // The pages of the chain
+    uint32_t num_pages;         // The number of pages in the chain
+    uint8_t *dirty;             // Whether each page's words changed since it was written
+    uint32_t dirty_cap;         // The capacity of dirty
+    bool_t moved;               // Whether every page must be written, since words moved
+    bool_t changed;             // Whether any word changed since the counts were written
+    bool_t is_unsaved;          // Whether the root page belongs to another index
+};
+
+/**
+ * Private function that gets the number of words a page holds
+ */
+static inline
+uint32_t Fabric_DegreeCounts__words_per_page(DegreeCounts *self) {
+    IndexStore *store = Fabric_Graph_get_index_store(Fabric_EdgeStore_get_graph(self->store));
+    return (store->page_size - FABRIC_DEGREE_COUNTS_HEADER_SIZE) / sizeof(uint32_t);
+}
+
+/**
+ * Private function that gets the number of words of histograms per class
+ */
+static inline
+uint32_t Fabric_DegreeCounts__class_words(void) {
+    return 2 * FABRIC_DEGREE_BUCKETS;
+}
+
+/**
+ * Private function that gets the index of the first word of the degrees
+ */
+static inline
+uint32_t Fabric_DegreeCounts__vertex_base(DegreeCounts *self) {
+    return FABRIC_DEGREE_COUNTS_FIELDS + self->num_labels +
+        self->num_classes * Fabric_DegreeCounts__class_words();
+}
+
+/**
+ * Private function that gets the number of words in the counts
+ */
+static inline
+uint32_t Fabric_DegreeCounts__num_words(DegreeCounts *self) {
+    return Fabric_DegreeCounts__vertex_base(self) + 2 * self->num_vertices;
+}
+
+/**
+ * Private function that gets the bucket of a degree
+ */
+static inline
+uint32_t Fabric_DegreeCounts__bucket(uint32_t degree) {
+    return 31 - __builtin_clz(degree);
+}
+
+/**
+ * Private function that marks the page holding a word as changed
+ *
+ * If the dirty flags can't grow every page is written instead.
+ */
+static
+void Fabric_DegreeCounts__touch(DegreeCounts *self, uint32_t word) {
+    uint32_t page_number = word / Fabric_DegreeCounts__words_per_page(self);
+    uint32_t new_cap = self->dirty_cap < 8 ? 8 : self->dirty_cap;
+    uint8_t *dirty;
+
+    self->changed = TRUE;
+    if (page_number >= self->dirty_cap) {
+        while (new_cap <= page_number) {
+            new_cap *= 2;
+        }
+        dirty = Fabric_memrealloc_tagged(self->dirty, new_cap, self->dirty_cap, FABRIC_MEM_INDEX);
+        if (NULL == dirty) {
+            self->moved = TRUE;
+            return;
+        }
+        memset(dirty + self->dirty_cap, 0, new_cap - self->dirty_cap);
+        self->dirty = dirty;
+        self->dirty_cap = new_cap;
+    }
+    self->dirty[page_number] = 1;
+}
+
+/**
+ * Private function that grows an array of counts, zeroing the new counts
+ *
+ * Args:
+ *      array: The array being grown
+ *      cap: The number of counts the array has room for
+ *      count: The number of counts needed
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+static
+error_t Fabric_DegreeCounts__reserve(uint32_t **array, uint32_t *cap, uint32_t count) {
+    uint32_t new_cap = *cap < 16 ? 16 : *cap;
+    uint32_t *grown;
+
+    if (count <= *cap) {
+        return FABRIC_OK;
+    }
+    while (new_cap < count) {
+        new_cap *= 2;
+    }
+    grown = Fabric_memrealloc_tagged(*array, new_cap * sizeof(uint32_t), *cap * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    if (NULL == grown) {
+        return Fabric_memerrno();
+    }
+    memset(grown + *cap, 0, (new_cap - *cap) * sizeof(uint32_t));
+    *array = grown;
+    *cap = new_cap;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that makes room for the counts of a vertex, a label
+ * and a class
+ *
+ * Ids that already have counts leave the words where they are.  A new
+ * label or class moves the words after it, so every page is marked to
+ * be written.
+ */
+static
+error_t Fabric_DegreeCounts__reserve_ids(DegreeCounts *self, vertexid_t vertex_id, labelid_t label_id, classid_t class_id) {
+    uint32_t first_word;
+    error_t status;
+
+    if (FABRIC_OK != (status = Fabric_DegreeCounts__reserve(&self->degrees, &self->degree_cap, 2 * (vertex_id + 1))) ||
+        FABRIC_OK != (status = Fabric_DegreeCounts__reserve(&self->label_counts, &self->label_cap, label_id + 1)) ||
+        FABRIC_OK != (status = Fabric_DegreeCounts__reserve(&self->histograms, &self->histogram_cap,
+            (class_id + 1) * Fabric_DegreeCounts__class_words()))) {
+        return status;
+    }
+
+    if (label_id >= self->num_labels) {
+        self->num_labels = label_id + 1;
+        self->moved = TRUE;
+    }
+    if (class_id >= self->num_classes) {
+        self->num_classes = class_id + 1;
+        self->moved = TRUE;
+    }
+    if (vertex_id >= self->num_vertices) {
+        // The new words are at the end of the chain
+        first_word = Fabric_DegreeCounts__num_words(self);
+        self->num_vertices = vertex_id + 1;
+        for (; first_word < Fabric_DegreeCounts__num_words(self); first_word++) {
+            Fabric_DegreeCounts__touch(self, first_word);
+        }
+        Fabric_DegreeCounts__touch(self, 1);
+    }
+    if (self->moved) {
+        self->changed = TRUE;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that gets a pointer to the word at an index
+ */
+static
+uint32_t *Fabric_DegreeCounts__word(DegreeCounts *self, uint32_t word) {
+    uint32_t class_words = self->num_classes * Fabric_DegreeCounts__class_words();
+    switch (word) {
+        case 0: return &self->num_edges;
+        case 1: return &self->num_vertices;
+        case 2: return &self->num_labels;
+        case 3: return &self->num_classes;
+    }
+    word -= FABRIC_DEGREE_COUNTS_FIELDS;
+    if (word < self->num_labels) {
+        return self->label_counts + word;
+    }
+    word -= self->num_labels;
+    if (word < class_words) {
+        return self->histograms + word;
+    }
+    return self->degrees + (word - class_words);
+}
+
+/**
+ * Private function that adds one to a vertex's degree and moves it to
+ * the next bucket of its class's histogram if its degree's bucket changed
+ */
+static
+void Fabric_DegreeCounts__add_degree(DegreeCounts *self, vertexid_t vertex_id, classid_t class_id, int direction) {
+    uint32_t side = FABRIC_DIRECTION_IN == direction ? 1 : 0;
+    uint32_t histogram = class_id * Fabric_DegreeCounts__class_words() + side * FABRIC_DEGREE_BUCKETS;
+    uint32_t histogram_word = FABRIC_DEGREE_COUNTS_FIELDS + self->num_labels + histogram;
+    uint32_t *degree = self->degrees + 2 * vertex_id + side;
+    uint32_t bucket;
+
+    if (*degree > 0) {
+        bucket = Fabric_DegreeCounts__bucket(*degree);
+        self->histograms[histogram + bucket]--;
+        Fabric_DegreeCounts__touch(self, histogram_word + bucket);
+    }
+    (*degree)++;
+    bucket = Fabric_DegreeCounts__bucket(*degree);
+    self->histograms[histogram + bucket]++;
+    Fabric_DegreeCounts__touch(self, histogram_word + bucket);
+    Fabric_DegreeCounts__touch(self, Fabric_DegreeCounts__vertex_base(self) + 2 * vertex_id + side);
+}
+
+/**
+ * Private function that clears the counts
+ */
+static
+void Fabric_DegreeCounts__clear(DegreeCounts *self) {
+    if (NULL != self->degrees) {
+        memset(self->degrees, 0, self->degree_cap * sizeof(uint32_t));
+    }
+    if (NULL != self->label_counts) {
+        memset(self->label_counts, 0, self->label_cap * sizeof(uint32_t));
+    }
+    if (NULL != self->histograms) {
+        memset(self->histograms, 0, self->histogram_cap * sizeof(uint32_t));
+    }
+    self->num_edges = 0;
+    self->num_vertices = 0;
+    self->num_labels = 0;
+    self->num_classes = 0;
+    self->moved = TRUE;
+    self->changed = TRUE;
+}
+
+/**
+ * Private function that counts the edges of the edge store again
+ *
+ * The degrees and label counts are taken from the edge records, then
+ * the histograms from the class of every vertex with edges.
+ */
+static
+error_t Fabric_DegreeCounts__rebuild(DegreeCounts *self) {
+    VertexStore *vertex_store = Fabric_Graph_get_vertex_store(Fabric_EdgeStore_get_graph(self->store));
+    EntityView view;
+    edgeid_t edge_id;
+    vertexid_t vertex_id, from_id, to_id;
+    labelid_t label_id;
+    classid_t class_id;
+    uint32_t side, *histogram;
+    error_t status;
+
+    Fabric_DegreeCounts__clear(self);
+    Fabric_EntityView_init(&view);
+    for (edge_id = 1; edge_id < self->store->last_free_id; edge_id++) {
+        status = Fabric_EdgeStore_view_edge(self->store, edge_id, &view);
+        if (FABRIC_EDGE_DOESNT_EXIST == status || FABRIC_EDGESTORE_INVALID_ID == status) {
+            continue;
+        } else if (FABRIC_OK != status) {
+            return status;
+        }
+        label_id = Fabric_EdgeView_get_label_id(&view);
+        from_id = Fabric_EdgeView_get_from_vertex_id(&view);
+        to_id = Fabric_EdgeView_get_to_vertex_id(&view);
+        Fabric_EntityView_release(&view);
+
+        status = Fabric_DegreeCounts__reserve_ids(self, from_id > to_id ? from_id : to_id, label_id, 0);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        self->degrees[2 * from_id]++;
+        self->degrees[2 * to_id + 1]++;
+        self->label_counts[label_id]++;
+        self->num_edges++;
+    }
+
+    for (vertex_id = 1; vertex_id < self->num_vertices; vertex_id++) {
+        if (0 == self->degrees[2 * vertex_id] && 0 == self->degrees[2 * vertex_id + 1]) {
+            continue;
+        }
+        status = Fabric_VertexStore_view_vertex(vertex_store, vertex_id, &view);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        class_id = Fabric_VertexView_get_class_id(&view);
+        Fabric_EntityView_release(&view);
+
+        status = Fabric_DegreeCounts__reserve_ids(self, vertex_id, 0, class_id);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        histogram = self->histograms + class_id * Fabric_DegreeCounts__class_words();
+        for (side = 0; side < 2; side++) {
+            if (self->degrees[2 * vertex_id + side] > 0) {
+                histogram[side * FABRIC_DEGREE_BUCKETS +
+                    Fabric_DegreeCounts__bucket(self->degrees[2 * vertex_id + side])]++;
+            }
+        }
+    }
+    self->moved = TRUE;
+    self->changed = TRUE;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that remembers a page of the chain
+ */
+static
+error_t Fabric_DegreeCounts__add_page(DegreeCounts *self, uint32_t page_id) {
+    uint32_t *page_ids = Fabric_memrealloc_tagged(self->page_ids, (self->num_pages + 1) * sizeof(uint32_t),
+        self->num_pages * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    if (NULL == page_ids) {
+        return Fabric_memerrno();
+    }
+    self->page_ids = page_ids;
+    self->page_ids[self->num_pages++] = page_id;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that reads the words of one page of the chain
+ *
+ * The first page holds the sizes of the sections, which are reserved
+ * before its words are read.
+ */
+static
+error_t Fabric_DegreeCounts__load_page(DegreeCounts *self, uint8_t *page, uint32_t used, uint32_t *word) {
+    uint32_t num_words = used / sizeof(uint32_t);
+    uint32_t i, num_vertices, num_labels, num_classes;
+    uint32_t *words = (uint32_t*)(page + FABRIC_DEGREE_COUNTS_HEADER_SIZE);
+    error_t status;
+
+    if (0 == *word) {
+        if (num_words < FABRIC_DEGREE_COUNTS_FIELDS) {
+            return FABRIC_INDEX_ERROR;
+        }
+        num_vertices = betoh32(words[1]);
+        num_labels = betoh32(words[2]);
+        num_classes = betoh32(words[3]);
+        if (num_vertices > UINT32_MAX / 2 || num_classes > (uint32_t)UINT16_MAX + 1) {
+            return FABRIC_INDEX_ERROR;
+        }
+        if (FABRIC_OK != (status = Fabric_DegreeCounts__reserve(&self->degrees, &self->degree_cap, 2 * num_vertices)) ||
+            FABRIC_OK != (status = Fabric_DegreeCounts__reserve(&self->label_counts, &self->label_cap, num_labels)) ||
+            FABRIC_OK != (status = Fabric_DegreeCounts__reserve(&self->histograms, &self->histogram_cap,
+                num_classes * Fabric_DegreeCounts__class_words()))) {
+            return status;
+        }
+        self->num_vertices = num_vertices;
+        self->num_labels = num_labels;
+        self->num_classes = num_classes;
+    }
+    if (*word + num_words > Fabric_DegreeCounts__num_words(self)) {
+        return FABRIC_INDEX_ERROR;
+    }
+    for (i = 0; i < num_words; i++, (*word)++) {
+        *Fabric_DegreeCounts__word(self, *word) = betoh32(words[i]);
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that reads the chain of pages into the counts
+ *
+ * A root page that has never been written, or was dropped, leaves the
+ * counts empty.  The pages of a dropped chain are still followed so that
+ * the counts are written over them.
+ */
+static
+error_t Fabric_DegreeCounts__load(DegreeCounts *self) {
+    IndexStore *store = Fabric_Graph_get_index_store(Fabric_EdgeStore_get_graph(self->store));
+    Graph *graph = Fabric_IndexStore_get_graph(store);
+    uint32_t page_size = store->page_size;
+    uint32_t page_id = FABRIC_DEGREE_COUNTS_PAGE_ID;
+    uint32_t used, word = 0;
+    bool_t is_empty = FALSE;
+    uint8_t *page;
+    error_t status = FABRIC_OK;
+
+    if (Fabric_IndexStore_get_page_count(store) < FABRIC_DEGREE_COUNTS_PAGE_ID) {
+        return FABRIC_OK;
+    }
+    page = Fabric_memalloc_tagged(page_size, FABRIC_MEM_INDEX);
+    if (NULL == page) {
+        return Fabric_memerrno();
+    }
+    while (page_id != 0) {
+        // A chain longer than the store can only be a loop
+        if (page_id > Fabric_IndexStore_get_page_count(store) ||
+            self->num_pages >= Fabric_IndexStore_get_page_count(store)) {
+            status = FABRIC_INDEX_ERROR;
+            break;
+        }
+        status = Fabric_Graph_read_bytes(graph, page, page_size, Fabric_IndexStore_get_page_offset(store, page_id));
+        if (FABRIC_OK != status) {
+            break;
+        }
+        Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_INDEX_STORE, 1);
+        used = betoh32(*(uint32_t*)(page + 8));
+        if (page_id == FABRIC_DEGREE_COUNTS_PAGE_ID && page[0] == 0) {
+            is_empty = TRUE;
+        } else if (page_id == FABRIC_DEGREE_COUNTS_PAGE_ID && page[0] != FABRIC_DEGREE_COUNTS_TYPE) {
+            self->is_unsaved = TRUE;
+            break;
+        } else if (page[0] != FABRIC_DEGREE_COUNTS_TYPE || used > page_size - FABRIC_DEGREE_COUNTS_HEADER_SIZE) {
+            status = FABRIC_INDEX_ERROR;
+            break;
+        }
+        if (FABRIC_OK != (status = Fabric_DegreeCounts__add_page(self, page_id)) ||
+            (!is_empty && FABRIC_OK != (status = Fabric_DegreeCounts__load_page(self, page, used, &word)))) {
+            break;
+        }
+        page_id = betoh32(*(uint32_t*)(page + 4));
+    }
+    Fabric_memfree_tagged(page, page_size, FABRIC_MEM_INDEX);
+
+    if (FABRIC_OK == status && !is_empty && !self->is_unsaved && word != Fabric_DegreeCounts__num_words(self)) {
+        status = FABRIC_INDEX_ERROR;
+    }
+    self->moved = FALSE;
+    self->changed = FALSE;
+    return status;
+}
+
+/**
+ * Reads the degree counts of a graph's edges into memory
+ *
+ * Counts that don't match the edge store are rebuilt, scanning every
+ * edge and every vertex with edges.
+ *
+ * Args:
+ *      store: The graph's edge store
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The degree counts or NULL on failure
+ */
+DegreeCounts *Fabric_DegreeCounts_load(EdgeStore *store, error_t *status) {
+    DegreeCounts *self = Fabric_memalloc_tagged(sizeof(DegreeCounts), FABRIC_MEM_INDEX);
+    if (NULL == self) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    memset(self, 0, sizeof(DegreeCounts));
+    self->store = store;
+
+    *status = Fabric_DegreeCounts__load(self);
+    if (FABRIC_OK == *status && self->num_edges != store->num_edges) {
+        *status = Fabric_DegreeCounts__rebuild(self);
+    }
+    if (FABRIC_OK != *status) {
+        Fabric_DegreeCounts_destroy(self);
+        return NULL;
+    }
+    return self;
+}
+
+/**
+ * Frees the memory held by degree counts
+ */
+void Fabric_DegreeCounts_destroy(DegreeCounts *self) {
+    if (NULL != self->degrees) {
+        Fabric_memfree_tagged(self->degrees, self->degree_cap * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    }
+    if (NULL != self->label_counts) {
+        Fabric_memfree_tagged(self->label_counts, self->label_cap * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    }
+    if (NULL != self->histograms) {
+        Fabric_memfree_tagged(self->histograms, self->histogram_cap * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    }
+    if (NULL != self->page_ids) {
+        Fabric_memfree_tagged(self->page_ids, self->num_pages * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    }
+    if (NULL != self->dirty) {
+        Fabric_memfree_tagged(self->dirty, self->dirty_cap, FABRIC_MEM_INDEX);
+    }
+    Fabric_memfree_tagged(self, sizeof(DegreeCounts), FABRIC_MEM_INDEX);
+}
+
+/**
+ * Gets the number of edges that have been counted
+ */
+uint32_t Fabric_DegreeCounts_get_edge_count(DegreeCounts *self) {
+    return self->num_edges;
+}
+
+/**
+ * Gets the number of edges a vertex has in a direction
+ *
+ * Args:
+ *      self: A graph's degree counts
+ *      vertex_id: The vertex
+ *      direction: FABRIC_DIRECTION_OUT or FABRIC_DIRECTION_IN
+ *
+ * Returns: The vertex's out degree or in degree, 0 if it has no edges
+ */
+uint32_t Fabric_DegreeCounts_get_degree(DegreeCounts *self, vertexid_t vertex_id, int direction) {
+    if (vertex_id >= self->num_vertices) {
+        return 0;
+    }
+    return self->degrees[2 * vertex_id + (FABRIC_DIRECTION_IN == direction ? 1 : 0)];
+}
+
+/**
+ * Gets the number of edges that have a label
+ */
+uint32_t Fabric_DegreeCounts_get_label_count(DegreeCounts *self, labelid_t label_id) {
+    return label_id < self->num_labels ? self->label_counts[label_id] : 0;
+}
+
+/**
+ * Gets the histogram of the degrees of a class's vertices
+ *
+ * Args:
+ *      self: A graph's degree counts
+ *      class_id: The class whose vertices are counted; subclasses
+ *                aren't included
+ *      direction: FABRIC_DIRECTION_OUT or FABRIC_DIRECTION_IN
+ *      buckets: An array of FABRIC_DEGREE_BUCKETS counts to fill.  Bucket
+ *               b is the number of vertices whose degree is from 2^b up
+ *               to 2^(b+1) - 1
+ */
+void Fabric_DegreeCounts_get_histogram(DegreeCounts *self, classid_t class_id, int direction, uint32_t *buckets) {
+    if (class_id >= self->num_classes) {
+        memset(buckets, 0, FABRIC_DEGREE_BUCKETS * sizeof(uint32_t));
+        return;
+    }
+    memcpy(buckets, self->histograms + class_id * Fabric_DegreeCounts__class_words() +
+        (FABRIC_DIRECTION_IN == direction ? FABRIC_DEGREE_BUCKETS : 0),
+        FABRIC_DEGREE_BUCKETS * sizeof(uint32_t));
+}
+
+/**
+ * Returns: TRUE if a vertex has at least FABRIC_SUPERNODE_DEGREE out
+ *          edges or in edges, FALSE if not
+ */
+bool_t Fabric_DegreeCounts_is_supernode(DegreeCounts *self, vertexid_t vertex_id) {
+    return Fabric_DegreeCounts_get_degree(self, vertex_id, FABRIC_DIRECTION_OUT) >= FABRIC_SUPERNODE_DEGREE ||
+        Fabric_DegreeCounts_get_degree(self, vertex_id, FABRIC_DIRECTION_IN) >= FABRIC_SUPERNODE_DEGREE;
+}
+
+/**
+ * Finds the vertices with many out edges or in edges
+ *
+ * Args:
+ *      self: A graph's degree counts
+ *      min_degree: The least out degree or in degree of a vertex found
+ *      vertex_ids: Where the ids of the vertices found are stored, in
+ *                  id order
+ *      max_count: The most ids vertex_ids can hold
+ *
+ * Returns: The number of vertices found, which can be more than max_count
+ */
+uint32_t Fabric_DegreeCounts_find_supernodes(DegreeCounts *self, uint32_t min_degree, vertexid_t *vertex_ids, uint32_t max_count) {
+    uint32_t count = 0;
+    vertexid_t vertex_id;
+
+    for (vertex_id = 1; vertex_id < self->num_vertices; vertex_id++) {
+        if (self->degrees[2 * vertex_id] >= min_degree || self->degrees[2 * vertex_id + 1] >= min_degree) {
+            if (count < max_count) {
+                vertex_ids[count] = vertex_id;
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * Counts a new edge
+ *
+ * The counts are left unchanged on failure.
+ *
+ * Args:
+ *      self: A graph's degree counts
+ *      label_id: The id of the edge's label
+ *      from_id: The id of the edge's start vertex
+ *      from_class_id: The id of the start vertex's class
+ *      to_id: The id of the edge's end vertex
+ *      to_class_id: The id of the end vertex's class
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_DegreeCounts_add_edge(
+    DegreeCounts *self,
+    labelid_t label_id,
+    vertexid_t from_id,
+    classid_t from_class_id,
+    vertexid_t to_id,
+    classid_t to_class_id) {
+
+    error_t status = Fabric_DegreeCounts__reserve_ids(self, from_id, label_id, from_class_id);
+    if (FABRIC_OK != status ||
+        FABRIC_OK != (status = Fabric_DegreeCounts__reserve_ids(self, to_id, label_id, to_class_id))) {
+        return status;
+    }
+
+    Fabric_DegreeCounts__add_degree(self, from_id, from_class_id, FABRIC_DIRECTION_OUT);
+    Fabric_DegreeCounts__add_degree(self, to_id, to_class_id, FABRIC_DIRECTION_IN);
+    self->label_counts[label_id]++;
+    Fabric_DegreeCounts__touch(self, FABRIC_DEGREE_COUNTS_FIELDS + label_id);
+    self->num_edges++;
+    Fabric_DegreeCounts__touch(self, 0);
+    return FABRIC_OK;
+}
+
+/**
+ * Writes the pages of the counts whose words changed
+ *
+ * Args:
+ *      self: A graph's degree counts
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_DegreeCounts_flush(DegreeCounts *self) {
+    IndexStore *store = Fabric_Graph_get_index_store(Fabric_EdgeStore_get_graph(self->store));
+    Graph *graph = Fabric_IndexStore_get_graph(store);
+    uint32_t words_per_page = Fabric_DegreeCounts__words_per_page(self);
+    uint32_t num_words = Fabric_DegreeCounts__num_words(self);
+    uint32_t num_pages = (num_words + words_per_page - 1) / words_per_page;
+    uint32_t page_number, word, used, i;
+    uint32_t *words;
+    uint8_t *page;
+    uint32_t page_id;
+    error_t status;
+
+    if (!self->changed || self->is_unsaved) {
+        return FABRIC_OK;
+    }
+    status = Fabric_IndexStore_reserve_root_pages(store);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    if (self->num_pages == 0 &&
+        FABRIC_OK != (status = Fabric_DegreeCounts__add_page(self, FABRIC_DEGREE_COUNTS_PAGE_ID))) {
+        return status;
+    }
+    while (self->num_pages < num_pages) {
+        page_id = Fabric_IndexStore_allocate_page(store, &status);
+        if (FABRIC_OK != status ||
+            FABRIC_OK != (status = Fabric_DegreeCounts__add_page(self, page_id))) {
+            return status;
+        }
+        // The page before it has to point at the new page
+        Fabric_DegreeCounts__touch(self, (self->num_pages - 2) * words_per_page);
+    }
+    page = Fabric_memalloc_tagged(store->page_size, FABRIC_MEM_INDEX);
+    if (NULL == page) {
+        return Fabric_memerrno();
+    }
+    words = (uint32_t*)(page + FABRIC_DEGREE_COUNTS_HEADER_SIZE);
+
+    // Pages past the end of the words are left in the chain but unlinked
+    for (page_number = 0; page_number < num_pages && FABRIC_OK == status; page_number++) {
+        if (!self->moved && (page_number >= self->dirty_cap || !self->dirty[page_number])) {
+            continue;
+        }
+        word = page_number * words_per_page;
+        used = num_words - word < words_per_page ? num_words - word : words_per_page;
+        for (i = 0; i < used; i++) {
+            words[i] = htobe32(*Fabric_DegreeCounts__word(self, word + i));
+        }
+        page[0] = FABRIC_DEGREE_COUNTS_TYPE;
+        page[1] = page[2] = page[3] = 0;
+        *(uint32_t*)(page + 4) = htobe32(page_number + 1 < num_pages ? self->page_ids[page_number + 1] : 0);
+        *(uint32_t*)(page + 8) = htobe32(used * sizeof(uint32_t));
+        status = Fabric_Graph_write_bytes(graph, page, FABRIC_DEGREE_COUNTS_HEADER_SIZE + used * sizeof(uint32_t),
+            Fabric_IndexStore_get_page_offset(store, self->page_ids[page_number]));
+        Fabric_stats_add(FABRIC_STAT_RECORDS_WRITTEN + FABRIC_STATS_INDEX_STORE, 1);
+    }
+    Fabric_memfree_tagged(page, store->page_size, FABRIC_MEM_INDEX);
+    if (FABRIC_OK == status) {
+        if (NULL != self->dirty) {
+            memset(self->dirty, 0, self->dirty_cap);
+        }
+        self->moved = FALSE;
+        self->changed = FALSE;
+    }
+    return status;
+}
+
+/**
+ * Marks a graph's written degree counts as out of date
+ *
+ * The counts are rebuilt the next time they are loaded, reusing the
+ * pages of their chain.  Counts the edge store has loaded are not
+ * changed.
+ *
+ * Args:
+ *      graph: The graph whose counts are dropped
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_DegreeCounts_drop(Graph *graph) {
+    IndexStore *store = Fabric_Graph_get_index_store(graph);
+    uint32_t offset;
+    uint8_t type;
+    error_t status;
+
+    if (Fabric_IndexStore_get_page_count(store) < FABRIC_DEGREE_COUNTS_PAGE_ID) {
+        return FABRIC_OK;
+    }
+    offset = Fabric_IndexStore_get_page_offset(store, FABRIC_DEGREE_COUNTS_PAGE_ID);
+    status = Fabric_Graph_read_bytes(graph, &type, sizeof(type), offset);
+    if (FABRIC_OK != status || FABRIC_DEGREE_COUNTS_TYPE != type) {
+        return status;
+    }
+    type = 0;
+    return Fabric_Graph_write_bytes(graph, &type, sizeof(type), offset);
+}
+
+#endif
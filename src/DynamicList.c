@@ -33,7 +33,7 @@ typedef struct DynamicList {
  *          be checked with Fabric_memerrno()
  */
 DynamicList *Fabric_DynamicList_allocate() {
-    return Fabric_memalloc(sizeof(DynamicList));
+    return Fabric_memalloc_tagged(sizeof(DynamicList), FABRIC_MEM_LIST);
 }
 
 /**
@@ -43,7 +43,7 @@ DynamicList *Fabric_DynamicList_allocate() {
  *      list: The list object being deallocated
  */
 void *Fabric_DynamicList_deallocate(DynamicList *list) {
-    Fabric_memfree(list, sizeof(DynamicList));
+    Fabric_memfree_tagged(list, sizeof(DynamicList), FABRIC_MEM_LIST);
 }
 
 /**
@@ -60,7 +60,7 @@ void *Fabric_DynamicList_deallocate(DynamicList *list) {
 error_t Fabric_DynamicList_init_with_capacity(DynamicList *self, int capacity) {
     self->cap = capacity > FABRIC_DYNAMIC_LIST_MIN_CAP ? capacity : FABRIC_DYNAMIC_LIST_MIN_CAP;
     self->count = 0;
-    self->list = (void**)Fabric_memalloc(self->cap * sizeof(void*));
+    self->list = (void**)Fabric_memalloc_tagged(self->cap * sizeof(void*), FABRIC_MEM_LIST);
     if (self->list == NULL) {
         return Fabric_memerrno();
     }
@@ -89,7 +89,7 @@ error_t Fabric_DynamicList_init(DynamicList *self) {
  *      self: A pointer to the dynamic list that is being deinitialized
  */
 void Fabric_DynamicList_deinit(DynamicList *self) {
-    Fabric_memfree(self->list, self->cap * sizeof(void*));
+    Fabric_memfree_tagged(self->list, self->cap * sizeof(void*), FABRIC_MEM_LIST);
 }
 
 /**
@@ -179,7 +179,7 @@ error_t Fabric_DynamicList_change_capacity(DynamicList *self, int new_capacity)
     if (new_capacity < FABRIC_DYNAMIC_LIST_MIN_CAP) {
         return FABRIC_OK;
     }
-    void* new_list = Fabric_memrealloc(self->list, new_capacity * sizeof(void*), self->cap * sizeof(void*));
+    void* new_list = Fabric_memrealloc_tagged(self->list, new_capacity * sizeof(void*), self->cap * sizeof(void*), FABRIC_MEM_LIST);
     if (new_list == NULL) {
         return Fabric_memerrno();
     }
@@ -47,6 +47,38 @@ typedef struct Edge {
     propertyid_t first_property_id; // the id of the first property for this edge
 } Edge;
 
+/* Edge objects are allocated from their own slab */
+static MemSlab Fabric_Edge__slab = FABRIC_MEMSLAB_INITIALIZER(Edge);
+
+/**
+ * Creates a new edge object
+ *
+ * Args:
+ *      id: The internal id of the edge object being created
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: A heap allocated edge object that is NOT initialized
+ *          or NULL if there is a memory error
+ */
+Edge *Fabric_Edge_new(edgeid_t id, error_t *status) {
+    Edge *edge = Fabric_memslab_alloc(&Fabric_Edge__slab);
+    if (NULL == edge) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+
+    edge->id = id;
+    *status = FABRIC_OK;
+    return edge;
+}
+
+/**
+ * Frees an edge object
+ */
+void Fabric_Edge_destroy(Edge *self) {
+    Fabric_memslab_free(&Fabric_Edge__slab, self);
+}
+
 
 /**
  * Gets an edges's id
@@ -88,6 +120,31 @@ int Fabric_Edge_init(Edge *self, uint8_t *data) {
     return FABRIC_OK;
 }
 
+/**
+ * Writes an edge's database data
+ *
+ * Args:
+ *      self: The edge being stored
+ *      dest: An array of 24 bytes to hold the edge's data
+ */
+void Fabric_Edge_load_bytes(Edge *self, uint8_t *dest) {
+    *((labelid_t*)dest) = htobe32(self->label_id);
+    *((vertexid_t*)(dest + 4)) = htobe32(self->from_id);
+    *((vertexid_t*)(dest + 8)) = htobe32(self->to_id);
+    *((edgeid_t*)(dest + 12)) = htobe32(self->next_out_id);
+    *((edgeid_t*)(dest + 16)) = htobe32(self->next_in_id);
+    *((propertyid_t*)(dest + 20)) = htobe32(self->first_property_id);
+}
+
+/**
+ * Returns whether or not this edge is in use.
+ *
+ * An edge is marked as not in use by setting its from_id to 0
+ */
+bool_t Fabric_Edge_is_in_use(Edge *self) {
+    return self->from_id != 0;
+}
+
 /**
  * Returns the label id for an edge
  */
@@ -95,6 +152,13 @@ labelid_t Fabric_Edge_get_label_id(Edge *self) {
     return self->label_id;
 }
 
+/**
+ * Sets the label id for an edge
+ */
+void Fabric_Edge_set_label_id(Edge *self, labelid_t label_id) {
+    self->label_id = label_id;
+}
+
 /**
  * Gets the label for an edge
  *
@@ -119,6 +183,13 @@ vertexid_t Fabric_Edge_get_from_vertex_id(Edge *self) {
     return self->from_id;
 }
 
+/**
+ * Sets the id of the edge's start vertex
+ */
+void Fabric_Edge_set_from_vertex_id(Edge *self, vertexid_t vertex_id) {
+    self->from_id = vertex_id;
+}
+
 /**
  * Returns the edge's start vertex
  *
@@ -143,6 +214,13 @@ vertexid_t Fabric_Edge_get_to_vertex_id(Edge *self) {
     return self->to_id;
 }
 
+/**
+ * Sets the id of the edge's end vertex
+ */
+void Fabric_Edge_set_to_vertex_id(Edge *self, vertexid_t vertex_id) {
+    self->to_id = vertex_id;
+}
+
 /**
  * Returns the edge's end vertex
  *
@@ -167,6 +245,13 @@ edgeid_t Fabric_Edge_get_next_out_edge_id(Edge *self) {
     return self->next_out_id;
 }
 
+/**
+ * Sets the id of the edge's start vertex's next out edge
+ */
+void Fabric_Edge_set_next_out_edge_id(Edge *self, edgeid_t edge_id) {
+    self->next_out_id = edge_id;
+}
+
 /**
  * Returns the edge's start vertex's next out edge
  *
@@ -201,6 +286,13 @@ edgeid_t Fabric_Edge_get_next_in_edge_id(Edge *self) {
     return self->next_in_id;
 }
 
+/**
+ * Sets the id of the edge's end vertex's next in edge
+ */
+void Fabric_Edge_set_next_in_edge_id(Edge *self, edgeid_t edge_id) {
+    self->next_in_id = edge_id;
+}
+
 /**
  * Returns the edge's end vertex's next in edge
  *
@@ -235,6 +327,13 @@ propertyid_t Fabric_Edge_get_first_property_id(Edge *self) {
     return self->first_property_id;
 }
 
+/**
+ * Sets the id of the edge's first property
+ */
+void Fabric_Edge_set_first_property_id(Edge *self, propertyid_t property_id) {
+    self->first_property_id = property_id;
+}
+
 /**
  * Gets the edges's first property
  *
@@ -263,4 +362,59 @@ bool_t Fabric_Edge_has_properties(Edge *self) {
     return self->first_property_id != 0;
 }
 
-#endif
\ No newline at end of file
+/**
+ * Edge views
+ *
+ * These read the fields of an edge record straight from an EntityView
+ * without initializing an edge object.
+ */
+/**
+ * Gets the label id of a viewed edge
+ */
+labelid_t Fabric_EdgeView_get_label_id(EntityView *view) {
+    return betoh32(*(labelid_t*)Fabric_EntityView_get_data(view));
+}
+
+/**
+ * Gets the id of a viewed edge's start vertex
+ */
+vertexid_t Fabric_EdgeView_get_from_vertex_id(EntityView *view) {
+    return betoh32(*(vertexid_t*)(Fabric_EntityView_get_data(view) + 4));
+}
+
+/**
+ * Returns whether or not a viewed edge is in use
+ */
+bool_t Fabric_EdgeView_is_in_use(EntityView *view) {
+    return Fabric_EdgeView_get_from_vertex_id(view) != 0;
+}
+
+/**
+ * Gets the id of a viewed edge's end vertex
+ */
+vertexid_t Fabric_EdgeView_get_to_vertex_id(EntityView *view) {
+    return betoh32(*(vertexid_t*)(Fabric_EntityView_get_data(view) + 8));
+}
+
+/**
+ * Gets the id of the start vertex's next outgoing edge
+ */
+edgeid_t Fabric_EdgeView_get_next_out_edge_id(EntityView *view) {
+    return betoh32(*(edgeid_t*)(Fabric_EntityView_get_data(view) + 12));
+}
+
+/**
+ * Gets the id of the end vertex's next incoming edge
+ */
+edgeid_t Fabric_EdgeView_get_next_in_edge_id(EntityView *view) {
+    return betoh32(*(edgeid_t*)(Fabric_EntityView_get_data(view) + 16));
+}
+
+/**
+ * Gets the id of a viewed edge's first property
+ */
+propertyid_t Fabric_EdgeView_get_first_property_id(EntityView *view) {
+    return betoh32(*(propertyid_t*)(Fabric_EntityView_get_data(view) + 20));
+}
+
+#endif
@@ -0,0 +1,236 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_EDGEITERATOR_C__
+#define _FABRIC_EDGEITERATOR_C__
+
+#include "Internal.h"
+
+/**
+ * An Edge Iterator walks the out edges or the in edges of a vertex.
+ *
+ * The edges of a vertex form a linked list through the next_out_id or
+ * next_in_id fields of its edge records.  Rather than going through the
+ * edge cache one edge at a time, the iterator reads the list in batches
+ * of FABRIC_EDGE_ITERATOR_BATCH edges into its own buffer.  Before each
+ * batch is read, the region of the edge store that the batch is likely
+ * to occupy is prefetched.  New edges are placed at the head of a list,
+ * so a list usually runs from higher ids to lower ids and the region
+ * prefetched is the one just below the next edge.  Once a batch is read
+ * the next batch's region is prefetched, so on a buffered graph its
+ * reads complete while the caller works through the current batch.
+ *
+ * A traversal can prefetch the first batch of every vertex of its
+ * frontier at once with Fabric_EdgeIterator_prefetch_frontier(4), which
+ * leaves many reads in flight instead of waiting on one at a time.
+ *
+ * An iterator can be restricted to the edges with one label.  If the
+ * vertex's edges are partitioned by label, it starts at the label's group
+ * and stops after the group's last edge.  Otherwise it reads the whole
+ * list and skips the other labels.
+ *
+ * The edges returned by the iterator are copies owned by the iterator.
+ * They are valid until the next call to Fabric_EdgeIterator_next(2) and
+ * are not affected by cache evictions.  An iterator holds no resources
+ * and does not need to be deinitialized.
+ */
+typedef struct EdgeIterator {
+    Graph *graph;                           // The graph whose edges are being walked
+    int direction;                          // FABRIC_DIRECTION_OUT or FABRIC_DIRECTION_IN
+    edgeid_t next_id;                       // The id of the edge after the batch; 0 at the end
+    labelid_t label_id;                     // The label of the edges returned or 0 for all edges
+    uint32_t remaining;                     // The number of edges left to read
+    int count;                              // The number of edges in the batch
+    int position;                           // The index of the next edge to return
+    Edge batch[FABRIC_EDGE_ITERATOR_BATCH]; // The current batch of edges
+} EdgeIterator;
+
+/**
+ * Initializes an iterator over a vertex's edges
+ *
+ * Args:
+ *      self: The iterator being initialized
+ *      graph: The graph the vertex belongs to
+ *      vertex: The vertex whose edges are walked
+ *      direction: FABRIC_DIRECTION_OUT for out edges or
+ *                 FABRIC_DIRECTION_IN for in edges
+ */
+void Fabric_EdgeIterator_init(EdgeIterator *self, Graph *graph, Vertex *vertex, int direction) {
+    self->graph = graph;
+    self->direction = direction;
+    self->count = 0;
+    self->position = 0;
+    self->label_id = 0;
+    self->remaining = UINT32_MAX;
+    if (FABRIC_DIRECTION_IN == direction) {
+        self->next_id = Fabric_Vertex_get_first_in_edge_id(vertex);
+    } else {
+        self->next_id = Fabric_Vertex_get_first_out_edge_id(vertex);
+    }
+}
+
+/**
+ * Initializes an iterator over a vertex's edges with one label
+ *
+ * Args:
+ *      self: The iterator being initialized
+ *      graph: The graph the vertex belongs to
+ *      vertex: The vertex whose edges are walked
+ *      direction: FABRIC_DIRECTION_OUT for out edges or
+ *                 FABRIC_DIRECTION_IN for in edges
+ *      label_id: The label of the edges returned
+ *
+ * Returns: FABRIC_OK on success, other error code if the graph's label
+ *          partitions can't be loaded
+ */
+error_t Fabric_EdgeIterator_init_with_label(EdgeIterator *self, Graph *graph, Vertex *vertex, int direction, labelid_t label_id) {
+    error_t status;
+    LabelPartitionDirectory *partitions = Fabric_EdgeStore_get_label_partitions(
+        Fabric_Graph_get_edge_store(graph), &status);
+
+    Fabric_EdgeIterator_init(self, graph, vertex, direction);
+    if (NULL == partitions) {
+        self->next_id = 0;
+        return status;
+    }
+    self->label_id = label_id;
+    Fabric_LabelPartitionDirectory_find_group(partitions, Fabric_Vertex_get_id(vertex),
+        direction, label_id, &self->next_id, &self->remaining);
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that prefetches the records a batch starting at an
+ * edge is likely to use
+ */
+static
+void Fabric_EdgeIterator__prefetch(Graph *graph, edgeid_t next_id) {
+    EdgeStore *store = Fabric_Graph_get_edge_store(graph);
+    edgeid_t first_id;
+
+    if (next_id < 1 || next_id > store->extents.capacity) {
+        return;
+    }
+
+    // The prefetched records stop at the start of the next edge's extent
+    first_id = store->extents.first_ids[Fabric_ExtentList_find(&store->extents, next_id)];
+    if (next_id >= first_id + FABRIC_EDGE_ITERATOR_BATCH) {
+        first_id = next_id - FABRIC_EDGE_ITERATOR_BATCH + 1;
+    }
+    // Failing to prefetch only makes the reads slower
+    Fabric_Graph_prefetch(
+        graph,
+        Fabric_ExtentList_get_record_offset(&store->extents, first_id),
+        (next_id - first_id + 1) * FABRIC_EDGE_STORAGE_SIZE);
+}
+
+/**
+ * Private function that reads the next batch of edges
+ */
+static
+error_t Fabric_EdgeIterator__fill(EdgeIterator *self) {
+    EdgeStore *store = Fabric_Graph_get_edge_store(self->graph);
+    Edge *edge;
+    error_t status;
+
+    self->count = 0;
+    self->position = 0;
+    Fabric_EdgeIterator__prefetch(self->graph, self->next_id);
+
+    while (self->next_id != 0 && self->count < FABRIC_EDGE_ITERATOR_BATCH) {
+        edge = &self->batch[self->count];
+        status = Fabric_EdgeStore_read_edge(store, self->next_id, edge);
+        if (FABRIC_OK != status) {
+            self->next_id = 0;
+            return status;
+        }
+        if (self->label_id == 0 || Fabric_Edge_get_label_id(edge) == self->label_id) {
+            self->count++;
+        }
+        if (--self->remaining == 0) {
+            self->next_id = 0;
+        } else if (FABRIC_DIRECTION_IN == self->direction) {
+            self->next_id = Fabric_Edge_get_next_in_edge_id(edge);
+        } else {
+            self->next_id = Fabric_Edge_get_next_out_edge_id(edge);
+        }
+    }
+    Fabric_EdgeIterator__prefetch(self->graph, self->next_id);
+    return FABRIC_OK;
+}
+
+/**
+ * Returns the iterator's next edge
+ *
+ * Args:
+ *      self: The iterator
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The next edge, or NULL once every edge has been returned or
+ *          if an error occurred
+ */
+Edge *Fabric_EdgeIterator_next(EdgeIterator *self, error_t *status) {
+    *status = FABRIC_OK;
+    if (self->position >= self->count) {
+        if (self->next_id == 0) {
+            return NULL;
+        }
+        *status = Fabric_EdgeIterator__fill(self);
+        if (FABRIC_OK != *status || self->count == 0) {
+            return NULL;
+        }
+    }
+    return &self->batch[self->position++];
+}
+
+/**
+ * Prefetches the first batch of edges of each vertex in a frontier
+ *
+ * The records of the vertices that aren't cached are prefetched first,
+ * so their reads are all in flight before the first vertex is needed.
+ * Each vertex is then fetched through the vertex store and the region
+ * its first batch of edges is likely to occupy is prefetched.  Edge
+ * iterators started on the vertices afterwards find their first batch
+ * loaded or loading.
+ *
+ * Args:
+ *      graph: The graph the vertices belong to
+ *      vertex_ids: The ids of the frontier's vertices
+ *      count: The number of vertices in the frontier
+ *      direction: FABRIC_DIRECTION_OUT for out edges or
+ *                 FABRIC_DIRECTION_IN for in edges
+ *
+ * Returns: FABRIC_OK on success, other error code if a vertex can't be read
+ */
+error_t Fabric_EdgeIterator_prefetch_frontier(Graph *graph, const vertexid_t *vertex_ids, uint32_t count, int direction) {
+    VertexStore *store = Fabric_Graph_get_vertex_store(graph);
+    Vertex *vertex;
+    error_t status;
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        if (vertex_ids[i] >= 1 && vertex_ids[i] <= store->extents.capacity &&
+                !Fabric_EntityCache_has_key(store->cache, vertex_ids[i])) {
+            Fabric_Graph_prefetch(graph,
+                Fabric_ExtentList_get_record_offset(&store->extents, vertex_ids[i]),
+                FABRIC_VERTEX_STORAGE_SIZE);
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        vertex = Fabric_VertexStore_get_vertex(store, vertex_ids[i], &status);
+        if (NULL == vertex) {
+            return status;
+        }
+        Fabric_EdgeIterator__prefetch(graph, FABRIC_DIRECTION_IN == direction ?
+            Fabric_Vertex_get_first_in_edge_id(vertex) : Fabric_Vertex_get_first_out_edge_id(vertex));
+    }
+    return FABRIC_OK;
+}
+
+#endif
@@ -3,7 +3,7 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 23, 2015
- * Updated: March 27, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_EDGESTORE_C__
@@ -11,6 +11,8 @@
 
 #include "Internal.h"
 
+#define FABRIC_EDGESTORE_HEADER_SIZE 12
+
 /**
  * The Edge Store is the component of the graph that has the responsibility
  * of managing the storage of Edge objects.
@@ -18,30 +20,590 @@
  * For many of the functions to work, it is assumed that the Edge Store
  * is embedded inside a Graph object.
  *
+ * The store begins with a 12 byte header holding the number of edges,
+ * the next free id and the last free id.  It is followed by the edge
+ * records, starting with edge 1.  Freed ids are kept in a free id map
+ * (see FreeIdMap.c); older graphs link them through the next_out_id
+ * field of unused records.
+ *
+ * The edges of a dense vertex can be partitioned by label so that walks
+ * of one label skip the others; see LabelPartition.c.  The partitions
+ * are loaded the first time an edge is created or a walk asks for them.
+ * The store also counts the degree of every vertex and the edges of
+ * every label as it creates edges; see DegreeCounts.c.  The counts are
+ * loaded the same way.
+ *
  * For a detailed description of Edge objects, see the accompanying
  * Edge.c file.
  */
 typedef struct EdgeStore {
-    uint32_t offset;    // graph file offset for the class store
-    uint32_t size;      // the size of the class store
+    uint32_t offset;        // graph file offset for the edge store
+    ExtentList extents;     // The regions of the file that hold the edge store
+    uint32_t num_edges;     // The number of edges in the graph
+    uint32_t last_free_id;  // The last edge id available
+                             // Always points to an previously unwritten portion of the file
+    FreeIdMap free_ids;     // The freed ids below last_free_id
+    EntityCache *cache;      // A cache of edges; Includes at least all edges in changed
+    IdSet *changed;          // A set of edges that have changed since last write
+    LabelPartitionDirectory *partitions;    // The label partitions once they have been loaded
+    DegreeCounts *degrees;                  // The degree counts once they have been loaded
 } EdgeStore;
 
+/**
+ * Internal function used by the cache to free evicted edges
+ */
+static
+void Fabric_EdgeStore__destroy_edge(void *edge) {
+    Fabric_Edge_destroy(edge);
+}
+
 /**
  * Initializes an Edge Store object
  *
  * Args:
  *      self: The Edge Store object being initialized.  Its offset should
  *            already be set by the Graph
+ *
+ * Returns: FABRIC_OK on success or other error code on failure
+ */
+error_t Fabric_EdgeStore_init(EdgeStore *self) {
+    error_t status;
+    edgeid_t first_free_id;
+    uint8_t header[3 * sizeof(uint32_t)];
+    Graph *graph = Fabric_EdgeStore_get_graph(self);
+    Fabric_Graph_read_store_header(graph, header, sizeof(header), self->offset);
+    self->num_edges = betoh32(*(uint32_t*)header);
+    first_free_id = betoh32(*(uint32_t*)(header + 4));
+    self->last_free_id = betoh32(*(uint32_t*)(header + 8));
+
+    // A new store has never handed out an id
+    if (first_free_id == 0) {
+        first_free_id = 1;
+        self->last_free_id = 1;
+    }
+
+    Fabric_FreeIdMap_init(&self->free_ids);
+    status = Fabric_FreeIdMap_load(&self->free_ids, graph, FABRIC_EDGE_STORE, self->last_free_id);
+    if (FABRIC_FREEIDMAP_MISSING == status) {
+        // Older graphs link the free ids through the next out edge id of free edge records
+        status = Fabric_FreeIdMap_load_list(&self->free_ids, graph, &self->extents,
+            first_free_id, self->last_free_id, 12, sizeof(uint32_t));
+    }
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    self->cache = NULL;
+    self->partitions = NULL;
+    self->degrees = NULL;
+    // Changed edges are pinned in the cache until they are written
+    self->changed = Fabric_IdSet_new(&status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    self->cache = Fabric_EntityCache_new(
+        FABRIC_EDGE_CACHE_SIZE,
+        FABRIC_CACHE_POLICY,
+        self->changed,
+        Fabric_EdgeStore__destroy_edge,
+        &status);
+    if (FABRIC_OK != status) {
+        Fabric_IdSet_destroy(self->changed);
+        self->changed = NULL;
+    }
+    return status;
+}
+
+/**
+ * Frees the memory used by an edge store, including its cached edges
+ *
+ * Changes that have not been flushed are lost.
+ */
+void Fabric_EdgeStore_deinit(EdgeStore *self) {
+    if (NULL != self->cache) {
+        Fabric_EntityCache_destroy(self->cache);
+        self->cache = NULL;
+    }
+    if (NULL != self->changed) {
+        Fabric_IdSet_destroy(self->changed);
+        self->changed = NULL;
+    }
+    if (NULL != self->partitions) {
+        Fabric_LabelPartitionDirectory_destroy(self->partitions);
+        self->partitions = NULL;
+    }
+    if (NULL != self->degrees) {
+        Fabric_DegreeCounts_destroy(self->degrees);
+        self->degrees = NULL;
+    }
+    Fabric_FreeIdMap_deinit(&self->free_ids);
+}
+
+/**
+ * Internal function for calculating the file offset of an edge
+ */
+static inline uint32_t Fabric_EdgeStore__get_id_offset(EdgeStore *self, edgeid_t edge_id) {
+    return Fabric_ExtentList_get_record_offset(&self->extents, edge_id);
+}
+
+/**
+ * Internal function that returns the largest id that fits in the store
+ */
+static inline edgeid_t Fabric_EdgeStore__max_id(EdgeStore *self) {
+    return self->extents.capacity;
+}
+
+/**
+ * Internal function that serializes a changed edge for the flush
+ */
+static
+void Fabric_EdgeStore__serialize(void *store, uint32_t edge_id, uint8_t *destination) {
+    EdgeStore *self = store;
+    // If the edge has been changed, it MUST be in the cache
+    Fabric_Edge_load_bytes(Fabric_EntityCache_get(self->cache, edge_id), destination);
+}
+
+/**
+ * Internal function that saves the edge store's free id map and writes its header
+ *
+ * The free ids are all in the saved map, so the header's next free id
+ * is the same as its last free id.
+ */
+static
+error_t Fabric_EdgeStore__write_header(EdgeStore *self) {
+    Graph *graph = Fabric_EdgeStore_get_graph(self);
+    error_t status = Fabric_FreeIdMap_save(&self->free_ids, graph, FABRIC_EDGE_STORE);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    // Write the edge store's header
+    Fabric_Graph_update_uint32(graph, self->num_edges, self->offset);
+    Fabric_Graph_update_uint32(graph, self->last_free_id, self->offset + 4);
+    Fabric_Graph_update_uint32(graph, self->last_free_id, self->offset + 8);
+
+    return FABRIC_OK;
+}
+
+/**
+ * Writes updates to the edge store to file.
+ *
+ * The changed edges are written in file order, with adjacent edges
+ * written together, and the header is only rewritten if it changed.
+ *
+ * Args:
+ *      self: The edge store whose data is being persisted
+ *
+ * Returns:
+ *      FABRIC_OK if the write is successful
+ *      A memory error if there is not enough memory to complete the action
+ *      FABRIC_EDGESTORE_NEEDS_RESIZE if the edge store must be resized
+ *          before it can complete the write
  */
-void Fabric_EdgeStore_init(EdgeStore *self) {
+error_t Fabric_EdgeStore_flush(EdgeStore *self) {
+    error_t status;
+    if (NULL != self->partitions &&
+        FABRIC_OK != (status = Fabric_LabelPartitionDirectory_flush(self->partitions))) {
+        return status;
+    }
+    if (NULL != self->degrees &&
+        FABRIC_OK != (status = Fabric_DegreeCounts_flush(self->degrees))) {
+        return status;
+    }
+    if (Fabric_IdSet_is_empty(self->changed)){
+        // Ids freed without changing a record only need the header
+        return Fabric_FreeIdMap_is_changed(&self->free_ids) ? Fabric_EdgeStore__write_header(self) : FABRIC_OK;
+    }
+    uint64_t started = Fabric_stats_now();
+
+    uint32_t *changed_ids = Fabric_IdSet_to_array(self->changed, &status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    int num_ids = Fabric_IdSet_get_count(self->changed);
+    int num_writable = 0;
+    int i;
+    edgeid_t max_id = 0;
     Graph *graph = Fabric_EdgeStore_get_graph(self);
-    self->size = Fabric_Graph_get_property_store_offset(graph) - self->offset;
+
+    // Grow the store to fit every changed record first.  Edges that
+    // still don't fit stay in the changed set
+    for (i = 0; i < num_ids; i++) {
+        if (changed_ids[i] > max_id) {
+            max_id = changed_ids[i];
+        }
+    }
+    Fabric_Graph_grow_store(graph, FABRIC_EDGE_STORE, max_id);
+    max_id = Fabric_EdgeStore__max_id(self);
+    for (i = 0; i < num_ids; i++) {
+        if (changed_ids[i] <= max_id) {
+            changed_ids[num_writable++] = changed_ids[i];
+        }
+    }
+
+    status = Fabric_Graph_write_records(
+        graph,
+        changed_ids,
+        num_writable,
+        &self->extents,
+        Fabric_EdgeStore__serialize,
+        self);
+    Fabric_stats_add(FABRIC_STAT_FLUSHES + FABRIC_STATS_EDGE_STORE, 1);
+    Fabric_stats_add_elapsed(FABRIC_STAT_FLUSH_NANOS + FABRIC_STATS_EDGE_STORE, started);
+
+    if (FABRIC_OK == status) {
+        Fabric_stats_add(FABRIC_STAT_RECORDS_WRITTEN + FABRIC_STATS_EDGE_STORE, num_writable);
+        for (i = 0; i < num_writable; i++) {
+            Fabric_IdSet_remove(self->changed, changed_ids[i]);
+        }
+        if (num_writable < num_ids) {
+            status = FABRIC_EDGESTORE_NEEDS_RESIZE;
+        }
+    }
+    Fabric_memfree(changed_ids, sizeof(uint32_t) * num_ids);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    return Fabric_EdgeStore__write_header(self);
 }
 
+/**
+ * Internal function for getting and updating the next id for an edge
+ *
+ * The lowest freed id is reused before a new one is taken from the end
+ * of the store.
+ */
+static
+edgeid_t Fabric_EdgeStore__next_id(EdgeStore *self) {
+    edgeid_t edge_id = Fabric_FreeIdMap_take(&self->free_ids);
+    if (0 == edge_id) {
+        edge_id = self->last_free_id++;
+    }
+    return edge_id;
+}
+
+/**
+ * Internal function that frees an edge's id so that it can be given out again
+ *
+ * If the free id map can't grow the id is never reused.
+ */
+static
+void Fabric_EdgeStore__add_free_id(EdgeStore *self, edgeid_t edge_id) {
+    if (edge_id + 1 == self->last_free_id) {
+        self->last_free_id--;
+    } else {
+        Fabric_FreeIdMap_add(&self->free_ids, edge_id);
+    }
+}
+
+/**
+ * Reads an edge into memory owned by the caller
+ *
+ * Unlike Fabric_EdgeStore_get_edge, the edge is not added to the cache.
+ * This lets scans read many edges without evicting the cache's working
+ * set.  A cached copy of the edge is used if there is one, since it may
+ * hold changes that have not been written yet.
+ *
+ * Args:
+ *      self: A graph's edge store
+ *      edge_id: The id of the edge being read
+ *      edge: Where the edge will be stored
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_EdgeStore_read_edge(EdgeStore *self, edgeid_t edge_id, Edge *edge) {
+    Edge *cached = Fabric_EntityCache_get(self->cache, edge_id);
+    uint8_t data[FABRIC_EDGE_STORAGE_SIZE];
+    error_t status;
+
+    if (cached) {
+        Fabric_Edge_load_bytes(cached, data);
+    } else {
+        if (edge_id < 1 || edge_id > Fabric_EdgeStore__max_id(self)) {
+            return FABRIC_EDGESTORE_INVALID_ID;
+        }
+        status = Fabric_Graph_read_bytes(
+            Fabric_EdgeStore_get_graph(self),
+            data,
+            FABRIC_EDGE_STORAGE_SIZE,
+            Fabric_EdgeStore__get_id_offset(self, edge_id));
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_EDGE_STORE, 1);
+    }
+
+    Fabric_Edge_set_id(edge, edge_id);
+    Fabric_Edge_init(edge, data);
+
+    if (!Fabric_Edge_is_in_use(edge)) {
+        return FABRIC_EDGE_DOESNT_EXIST;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Views an edge by id without creating an edge object
+ *
+ * The view reads the cached edge when there is one, since it may have
+ * changes not yet written to the file.  Otherwise it points at the
+ * edge's record in the graph file.  The view must be released with
+ * Fabric_EntityView_release(1).
+ *
+ * Args:
+ *      self: A graph's edge store
+ *      edge_id: The id of the edge being viewed
+ *      view: The view that is pointed at the edge
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_EdgeStore_view_edge(EdgeStore *self, edgeid_t edge_id, EntityView *view) {
+    Edge *cached = Fabric_EntityCache_get(self->cache, edge_id);
+    error_t status;
+
+    if (cached) {
+        Fabric_Edge_load_bytes(cached, Fabric_EntityView_copy(view));
+    } else {
+        if (edge_id < 1 || edge_id > Fabric_EdgeStore__max_id(self)) {
+            Fabric_EntityView_release(view);
+            return FABRIC_EDGESTORE_INVALID_ID;
+        }
+        status = Fabric_EntityView_open(
+            view,
+            Fabric_EdgeStore_get_graph(self),
+            FABRIC_EDGE_STORAGE_SIZE,
+            Fabric_EdgeStore__get_id_offset(self, edge_id));
+        if (FABRIC_OK != status) {
+            Fabric_EntityView_release(view);
+            return status;
+        }
+    }
+
+    if (!Fabric_EdgeView_is_in_use(view)) {
+        Fabric_EntityView_release(view);
+        return FABRIC_EDGE_DOESNT_EXIST;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Gets an edge by id from the store
+ *
+ * Args:
+ *      self: A graph's edge store
+ *      edge_id: The id of the edge being retrieved
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The edge object with the specified id, or NULL on failure
+ */
 Edge *Fabric_EdgeStore_get_edge(EdgeStore *self, edgeid_t edge_id, error_t *status) {
-    // TODO this is a stub
+    Edge *edge = Fabric_EntityCache_get(self->cache, edge_id);
+    uint8_t data[FABRIC_EDGE_STORAGE_SIZE];
+    Graph *g;
     *status = FABRIC_OK;
-    return NULL;
+
+    // A cached copy may have changes not yet written to the file
+    if (!edge) {
+        if (edge_id < 1 || edge_id > Fabric_EdgeStore__max_id(self)) {
+            *status = FABRIC_EDGESTORE_INVALID_ID;
+            return NULL;
+        }
+        g = Fabric_EdgeStore_get_graph(self);
+        Fabric_Graph_read_bytes(g, data, FABRIC_EDGE_STORAGE_SIZE, Fabric_EdgeStore__get_id_offset(self, edge_id));
+        Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_EDGE_STORE, 1);
+        edge = Fabric_Edge_new(edge_id, status);
+        if (FABRIC_OK != *status) {
+            return NULL;
+        }
+        Fabric_Edge_init(edge, data);
+        *status = Fabric_EntityCache_set(self->cache, edge_id, edge);
+        if (FABRIC_OK != *status) {
+            Fabric_Edge_destroy(edge);
+            return NULL;
+        }
+    }
+
+    // if its start vertex is 0 then it is not in use
+    if (!Fabric_Edge_is_in_use(edge)) {
+        *status = FABRIC_EDGE_DOESNT_EXIST;
+        return NULL;
+    }
+
+    return edge;
+}
+
+/**
+ * Marks an edge as changed so that it is written on the next flush
+ *
+ * Args:
+ *      self: A graph's edge store
+ *      edge: The edge that has changed
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_EdgeStore_update_edge(EdgeStore *self, Edge *edge) {
+    edgeid_t edge_id = Fabric_Edge_get_id(edge);
+    // Mark the edge as changed first so caching it can't evict it
+    error_t status = Fabric_IdSet_add(self->changed, edge_id);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    return Fabric_EntityCache_set(self->cache, edge_id, edge);
+}
+
+/**
+ * Gets the label partitions of a graph's edges, loading them if needed
+ *
+ * Args:
+ *      self: A graph's edge store
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The label partition directory or NULL on failure
+ */
+LabelPartitionDirectory *Fabric_EdgeStore_get_label_partitions(EdgeStore *self, error_t *status) {
+    *status = FABRIC_OK;
+    if (NULL == self->partitions) {
+        self->partitions = Fabric_LabelPartitionDirectory_load(self, status);
+    }
+    return self->partitions;
+}
+
+/**
+ * Gets the degree counts of a graph's edges, loading them if needed
+ *
+ * Args:
+ *      self: A graph's edge store
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The degree counts or NULL on failure
+ */
+DegreeCounts *Fabric_EdgeStore_get_degree_counts(EdgeStore *self, error_t *status) {
+    *status = FABRIC_OK;
+    if (NULL == self->degrees) {
+        self->degrees = Fabric_DegreeCounts_load(self, status);
+    }
+    return self->degrees;
+}
+
+/**
+ * Groups a vertex's out edges or in edges by label
+ *
+ * See Fabric_LabelPartitionDirectory_partition(3).  The vertex and the
+ * edges that move are marked as changed.
+ *
+ * Args:
+ *      self: A graph's edge store
+ *      vertex: The vertex whose edges are grouped
+ *      direction: FABRIC_DIRECTION_OUT or FABRIC_DIRECTION_IN
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_EdgeStore_partition_by_label(EdgeStore *self, Vertex *vertex, int direction) {
+    error_t status;
+    LabelPartitionDirectory *partitions = Fabric_EdgeStore_get_label_partitions(self, &status);
+    if (NULL == partitions) {
+        return status;
+    }
+    return Fabric_LabelPartitionDirectory_partition(partitions, vertex, direction);
+}
+
+/**
+ * Private function that drops a new edge that could not be created
+ *
+ * The edge is removed from the cache and the changed set, destroyed and
+ * its id is freed.
+ */
+static
+void Fabric_EdgeStore__discard_edge(EdgeStore *self, Edge *edge) {
+    edgeid_t edge_id = Fabric_Edge_get_id(edge);
+    Fabric_EntityCache_unset(self->cache, edge_id);
+    Fabric_IdSet_remove(self->changed, edge_id);
+    Fabric_Edge_destroy(edge);
+    Fabric_EdgeStore__add_free_id(self, edge_id);
+}
+
+/**
+ * Creates a new edge between two vertices
+ *
+ * The edge becomes the first out edge of its start vertex and the first
+ * in edge of its end vertex, or the first edge of its label's group when
+ * the vertex's edges are partitioned by label.  Both vertices are marked
+ * as changed, and the edge is added to the degree counts.  If any step
+ * fails, the edge is unlinked, dropped from the cache and its id is freed.
+ *
+ * Args:
+ *      self: The graph's edge store
+ *      label_id: The id of the edge's label
+ *      from: The edge's start vertex
+ *      to: The edge's end vertex
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The newly created edge or NULL on failure
+ */
+Edge *Fabric_EdgeStore_create_edge(
+    EdgeStore *self,
+    labelid_t label_id,
+    Vertex *from,
+    Vertex *to,
+    error_t *status) {
+
+    Graph *g = Fabric_EdgeStore_get_graph(self);
+    VertexStore *vs = Fabric_Graph_get_vertex_store(g);
+    edgeid_t edge_id;
+    Edge *edge;
+    LabelPartitionDirectory *partitions = Fabric_EdgeStore_get_label_partitions(self, status);
+    DegreeCounts *degrees;
+
+    if (NULL == partitions || NULL == (degrees = Fabric_EdgeStore_get_degree_counts(self, status))) {
+        return NULL;
+    }
+    edge_id = Fabric_EdgeStore__next_id(self);
+    edge = Fabric_Edge_new(edge_id, status);
+    if (FABRIC_OK != *status) {
+        Fabric_EdgeStore__add_free_id(self, edge_id);
+        return NULL;
+    }
+
+    Fabric_Edge_set_label_id(edge, label_id);
+    Fabric_Edge_set_from_vertex_id(edge, Fabric_Vertex_get_id(from));
+    Fabric_Edge_set_to_vertex_id(edge, Fabric_Vertex_get_id(to));
+    Fabric_Edge_set_next_out_edge_id(edge, 0);
+    Fabric_Edge_set_next_in_edge_id(edge, 0);
+    Fabric_Edge_set_first_property_id(edge, 0);
+
+    // Mark the edge as changed first so caching it can't evict it
+    if (FABRIC_OK != (*status = Fabric_IdSet_add(self->changed, edge_id)) ||
+        FABRIC_OK != (*status = Fabric_EntityCache_set(self->cache, edge_id, edge))) {
+        Fabric_EdgeStore__discard_edge(self, edge);
+        return NULL;
+    }
+
+    // Each failure unwinds the links made before it, newest first
+    *status = Fabric_LabelPartitionDirectory_link_edge(partitions, edge, from, FABRIC_DIRECTION_OUT);
+    if (FABRIC_OK != *status) {
+        Fabric_EdgeStore__discard_edge(self, edge);
+        return NULL;
+    }
+    *status = Fabric_LabelPartitionDirectory_link_edge(partitions, edge, to, FABRIC_DIRECTION_IN);
+    if (FABRIC_OK != *status) {
+        Fabric_LabelPartitionDirectory_unlink_edge(partitions, edge, from, FABRIC_DIRECTION_OUT);
+        Fabric_EdgeStore__discard_edge(self, edge);
+        return NULL;
+    }
+    if (FABRIC_OK != (*status = Fabric_VertexStore_update_vertex(vs, from)) ||
+        FABRIC_OK != (*status = Fabric_VertexStore_update_vertex(vs, to)) ||
+        FABRIC_OK != (*status = Fabric_DegreeCounts_add_edge(degrees, label_id,
+            Fabric_Vertex_get_id(from), Fabric_Vertex_get_class_id(from),
+            Fabric_Vertex_get_id(to), Fabric_Vertex_get_class_id(to)))) {
+        Fabric_LabelPartitionDirectory_unlink_edge(partitions, edge, to, FABRIC_DIRECTION_IN);
+        Fabric_LabelPartitionDirectory_unlink_edge(partitions, edge, from, FABRIC_DIRECTION_OUT);
+        Fabric_EdgeStore__discard_edge(self, edge);
+        return NULL;
+    }
+
+    self->num_edges++;
+    return edge;
 }
 
-#endif
\ No newline at end of file
+#endif
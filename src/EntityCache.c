@@ -0,0 +1,495 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_ENTITY_CACHE_C__
+#define _FABRIC_ENTITY_CACHE_C__
+
+#include <stdint.h>
+#include <string.h>
+#include "Internal.h"
+#include "EntityMap.c"
+
+#define FABRIC_ENTITYCACHE_INITIAL_SLOTS 32
+#define FABRIC_ENTITYCACHE_NO_SLOT -1
+
+typedef struct EntityCacheSlot {
+    uint32_t key;           // The id of the cached entity; 0 if the slot is free
+    void *entity;           // The cached entity
+    bool_t referenced;      // CLOCK: whether the entity was used since the hand last passed
+    int prev;               // LRU: the next more recently used slot
+    int next;               // LRU: the next less recently used slot; or the next free slot
+} EntityCacheSlot;
+
+/**
+ * An Entity Cache is a bounded map of ids to entities loaded by a store
+ *
+ * Once the cache holds capacity entities, adding another one evicts an
+ * entity chosen by the cache's replacement policy:
+ *
+ *      FABRIC_CACHE_POLICY_CLOCK: Second chance; entities used since the
+ *                                 clock hand last passed them are skipped
+ *      FABRIC_CACHE_POLICY_LRU:   The least recently used entity
+ *
+ * Entities whose ids are in the cache's pinned set are never evicted.
+ * Stores pin their changed set, so an entity is only dropped after it
+ * has been written.  If every entity is pinned the cache grows past its
+ * capacity rather than failing.
+ *
+ * The cache owns the entities it holds and destroys them when they are
+ * evicted or when the cache is destroyed.  Its slots are allocated when
+ * the first entity is added, so opening a store whose cache is never
+ * used allocates nothing but the cache's header.  An entity returned by
+ * Fabric_EntityCache_get may be evicted by any later call that adds an
+ * entity to the cache unless its id is pinned.
+ *
+ * A cache can be told to hold fewer entities than its capacity with
+ * Fabric_EntityCache_set_limit, which graphs do when memory is over
+ * budget.  Lowering the limit evicts nothing by itself: a cache over its
+ * limit evicts two entities for each one it adds until it is back under,
+ * or all of the extra ones at once with Fabric_EntityCache_trim.
+ */
+typedef struct EntityCache {
+    EntityMap *index;               // Map of ids to slot number + 1
+    EntityCacheSlot *slots;         // Storage for the cached entries
+    int num_slots;                  // The number of allocated slots
+    int count;                      // The number of cached entities
+    int capacity;                   // The most entities held before evicting
+    int limit;                      // The number of entities held before evicting; at most capacity
+    int policy;                     // One of the FABRIC_CACHE_POLICY_* values
+    int free_slot;                  // The first slot of the free list
+    int clock_hand;                 // CLOCK: the next slot to consider for eviction
+    int lru_head;                   // LRU: the most recently used slot
+    int lru_tail;                   // LRU: the least recently used slot
+    IdSet *pinned;                  // Ids that may not be evicted
+    void (*destroy)(void *entity);  // Frees an evicted entity
+    uint64_t hits;                  // The number of lookups that found their entity
+    uint64_t misses;                // The number of lookups that didn't
+    uint64_t evictions;             // The number of entities evicted
+    uint64_t marked_hits;           // The number of hits when the recent hit ratio was last taken
+    uint64_t marked_misses;         // The number of misses when the recent hit ratio was last taken
+} EntityCache;
+
+/**
+ * Private function that adds slots to the free list
+ */
+static
+error_t Fabric_EntityCache__grow(EntityCache *self, int new_num_slots) {
+    EntityCacheSlot *slots = Fabric_memalloc_tagged(new_num_slots * sizeof(EntityCacheSlot), FABRIC_MEM_CACHE);
+    int i;
+    if (NULL == slots) {
+        return Fabric_memerrno();
+    }
+
+    if (NULL != self->slots) {
+        memcpy(slots, self->slots, self->num_slots * sizeof(EntityCacheSlot));
+        Fabric_memfree_tagged(self->slots, self->num_slots * sizeof(EntityCacheSlot), FABRIC_MEM_CACHE);
+    }
+    memset(slots + self->num_slots, 0, (new_num_slots - self->num_slots) * sizeof(EntityCacheSlot));
+
+    for (i = new_num_slots - 1; i >= self->num_slots; i--) {
+        slots[i].next = self->free_slot;
+        self->free_slot = i;
+    }
+
+    self->slots = slots;
+    self->num_slots = new_num_slots;
+    return FABRIC_OK;
+}
+
+/**
+ * Creates an entity cache
+ *
+ * Args:
+ *      capacity: The number of entities to hold before evicting
+ *      policy: One of the FABRIC_CACHE_POLICY_* values
+ *      pinned: A set of ids that must not be evicted; may be NULL
+ *      destroy: Function used to free evicted entities
+ *      status: A pointer to where any errors will be stored
+ *
+ * Returns: A newly allocated entity cache, or NULL on error
+ */
+EntityCache *Fabric_EntityCache_new(
+    int capacity,
+    int policy,
+    IdSet *pinned,
+    void (*destroy)(void *entity),
+    error_t *status) {
+
+    EntityCache *cache = Fabric_memalloc_tagged(sizeof(EntityCache), FABRIC_MEM_CACHE);
+    if (NULL == cache) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+
+    if (capacity < 1) {
+        capacity = 1;
+    }
+    cache->slots = NULL;
+    cache->num_slots = 0;
+    cache->count = 0;
+    cache->capacity = capacity;
+    cache->limit = capacity;
+    cache->policy = policy;
+    cache->free_slot = FABRIC_ENTITYCACHE_NO_SLOT;
+    cache->clock_hand = 0;
+    cache->lru_head = FABRIC_ENTITYCACHE_NO_SLOT;
+    cache->lru_tail = FABRIC_ENTITYCACHE_NO_SLOT;
+    cache->pinned = pinned;
+    cache->destroy = destroy;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+    cache->marked_hits = 0;
+    cache->marked_misses = 0;
+
+    cache->index = Fabric_EntityMap_new(status);
+    if (FABRIC_OK != *status) {
+        Fabric_memfree_tagged(cache, sizeof(EntityCache), FABRIC_MEM_CACHE);
+        return NULL;
+    }
+
+    return cache;
+}
+
+/**
+ * Destroys an entity cache and all of the entities it holds
+ */
+void Fabric_EntityCache_destroy(EntityCache *self) {
+    int i;
+    for (i = 0; i < self->num_slots; i++) {
+        if (self->slots[i].key != 0 && NULL != self->slots[i].entity) {
+            self->destroy(self->slots[i].entity);
+        }
+    }
+    if (NULL != self->slots) {
+        Fabric_memfree_tagged(self->slots, self->num_slots * sizeof(EntityCacheSlot), FABRIC_MEM_CACHE);
+    }
+    Fabric_EntityMap_destroy(self->index);
+    Fabric_memfree_tagged(self, sizeof(EntityCache), FABRIC_MEM_CACHE);
+}
+
+/**
+ * Private function that finds the slot holding a key
+ */
+static inline
+int Fabric_EntityCache__slot_of(EntityCache *self, uint32_t key) {
+    return (int)(uintptr_t)Fabric_EntityMap_get(self->index, key) - 1;
+}
+
+/**
+ * Private function that removes a slot from the LRU list
+ */
+static
+void Fabric_EntityCache__lru_unlink(EntityCache *self, int slot) {
+    EntityCacheSlot *s = self->slots + slot;
+    if (s->prev != FABRIC_ENTITYCACHE_NO_SLOT) {
+        self->slots[s->prev].next = s->next;
+    } else {
+        self->lru_head = s->next;
+    }
+    if (s->next != FABRIC_ENTITYCACHE_NO_SLOT) {
+        self->slots[s->next].prev = s->prev;
+    } else {
+        self->lru_tail = s->prev;
+    }
+}
+
+/**
+ * Private function that makes a slot the most recently used one
+ */
+static
+void Fabric_EntityCache__lru_push(EntityCache *self, int slot) {
+    EntityCacheSlot *s = self->slots + slot;
+    s->prev = FABRIC_ENTITYCACHE_NO_SLOT;
+    s->next = self->lru_head;
+    if (self->lru_head != FABRIC_ENTITYCACHE_NO_SLOT) {
+        self->slots[self->lru_head].prev = slot;
+    } else {
+        self->lru_tail = slot;
+    }
+    self->lru_head = slot;
+}
+
+/**
+ * Private function that records a use of a slot
+ */
+static inline
+void Fabric_EntityCache__touch(EntityCache *self, int slot) {
+    if (FABRIC_CACHE_POLICY_LRU == self->policy) {
+        if (self->lru_head != slot) {
+            Fabric_EntityCache__lru_unlink(self, slot);
+            Fabric_EntityCache__lru_push(self, slot);
+        }
+    } else {
+        self->slots[slot].referenced = TRUE;
+    }
+}
+
+/**
+ * Private function that empties a slot and returns it to the free list
+ */
+static
+void Fabric_EntityCache__release(EntityCache *self, int slot) {
+    if (FABRIC_CACHE_POLICY_LRU == self->policy) {
+        Fabric_EntityCache__lru_unlink(self, slot);
+    }
+    Fabric_EntityMap_unset(self->index, self->slots[slot].key);
+    self->slots[slot].key = 0;
+    self->slots[slot].entity = NULL;
+    self->slots[slot].next = self->free_slot;
+    self->free_slot = slot;
+    self->count--;
+}
+
+/**
+ * Private function that chooses an entity to evict
+ *
+ * Returns: The victim's slot, or FABRIC_ENTITYCACHE_NO_SLOT if every entity is pinned
+ */
+static
+int Fabric_EntityCache__find_victim(EntityCache *self) {
+    int slot, steps;
+    EntityCacheSlot *s;
+
+    if (FABRIC_CACHE_POLICY_LRU == self->policy) {
+        for (slot = self->lru_tail; slot != FABRIC_ENTITYCACHE_NO_SLOT; slot = self->slots[slot].prev) {
+            if (NULL == self->pinned || !Fabric_IdSet_has(self->pinned, self->slots[slot].key)) {
+                return slot;
+            }
+        }
+        return FABRIC_ENTITYCACHE_NO_SLOT;
+    }
+
+    // Two sweeps: the first may only clear reference bits
+    for (steps = 0; steps < 2 * self->num_slots; steps++) {
+        slot = self->clock_hand;
+        self->clock_hand = (self->clock_hand + 1) % self->num_slots;
+        s = self->slots + slot;
+        if (s->key == 0 || (NULL != self->pinned && Fabric_IdSet_has(self->pinned, s->key))) {
+            continue;
+        }
+        if (s->referenced) {
+            s->referenced = FALSE;
+            continue;
+        }
+        return slot;
+    }
+    return FABRIC_ENTITYCACHE_NO_SLOT;
+}
+
+/**
+ * Private function that evicts an entity
+ *
+ * Returns: TRUE if an entity was evicted, FALSE if every entity is pinned
+ */
+static
+bool_t Fabric_EntityCache__evict(EntityCache *self) {
+    int slot = Fabric_EntityCache__find_victim(self);
+    void *victim;
+
+    if (slot == FABRIC_ENTITYCACHE_NO_SLOT) {
+        return FALSE;
+    }
+    victim = self->slots[slot].entity;
+    Fabric_EntityCache__release(self, slot);
+    if (NULL != victim) {
+        self->destroy(victim);
+    }
+    self->evictions++;
+    return TRUE;
+}
+
+/**
+ * Returns whether or not an entity cache holds the entity with a given id
+ *
+ * This does not count as a use of the entity or as a lookup.
+ */
+bool_t Fabric_EntityCache_has_key(EntityCache *self, uint32_t key) {
+    return Fabric_EntityMap_has_key(self->index, key);
+}
+
+/**
+ * Retrieves an entity from the cache
+ *
+ * Args:
+ *      self: The cache the entity is being retrieved from
+ *      key: The id of the entity being retrieved
+ *
+ * Returns: The entity, or NULL if it isn't cached
+ */
+void *Fabric_EntityCache_get(EntityCache *self, uint32_t key) {
+    int slot = Fabric_EntityCache__slot_of(self, key);
+    if (slot < 0) {
+        self->misses++;
+        return NULL;
+    }
+    self->hits++;
+    Fabric_EntityCache__touch(self, slot);
+    return self->slots[slot].entity;
+}
+
+/**
+ * Adds or replaces the entity for an id in the cache
+ *
+ * Adding an entity to a full cache evicts another entity.  An entity
+ * that is replaced by a different one is destroyed, since the cache owns
+ * it; callers that still need it must unset it first.
+ *
+ * Args:
+ *      self: The cache
+ *      key: The id of the entity
+ *      entity: The entity
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_EntityCache_set(EntityCache *self, uint32_t key, void *entity) {
+    int slot = Fabric_EntityCache__slot_of(self, key);
+    error_t status;
+
+    if (slot >= 0) {
+        if (self->slots[slot].entity != entity && NULL != self->slots[slot].entity) {
+            self->destroy(self->slots[slot].entity);
+        }
+        self->slots[slot].entity = entity;
+        Fabric_EntityCache__touch(self, slot);
+        return FABRIC_OK;
+    }
+
+    if (self->count >= self->limit && Fabric_EntityCache__evict(self) && self->count >= self->limit) {
+        // The limit has been lowered below the count
+        Fabric_EntityCache__evict(self);
+    }
+
+    if (self->free_slot == FABRIC_ENTITYCACHE_NO_SLOT) {
+        status = Fabric_EntityCache__grow(self, self->num_slots > 0 ? self->num_slots * 2 :
+            self->capacity < FABRIC_ENTITYCACHE_INITIAL_SLOTS ? self->capacity : FABRIC_ENTITYCACHE_INITIAL_SLOTS);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
+
+    slot = self->free_slot;
+    status = Fabric_EntityMap_set(self->index, key, (void*)(uintptr_t)(slot + 1));
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    self->free_slot = self->slots[slot].next;
+    self->slots[slot].key = key;
+    self->slots[slot].entity = entity;
+    self->slots[slot].referenced = FALSE;
+    if (FABRIC_CACHE_POLICY_LRU == self->policy) {
+        Fabric_EntityCache__lru_push(self, slot);
+    }
+    self->count++;
+    return FABRIC_OK;
+}
+
+/**
+ * Removes an entity from the cache without destroying it
+ */
+void Fabric_EntityCache_unset(EntityCache *self, uint32_t key) {
+    int slot = Fabric_EntityCache__slot_of(self, key);
+    if (slot >= 0) {
+        Fabric_EntityCache__release(self, slot);
+    }
+}
+
+/**
+ * Sets the number of entities a cache holds before evicting
+ *
+ * Args:
+ *      self: The cache
+ *      limit: The new limit; it is kept between 1 and the cache's capacity
+ */
+void Fabric_EntityCache_set_limit(EntityCache *self, int limit) {
+    self->limit = limit < 1 ? 1 : limit > self->capacity ? self->capacity : limit;
+}
+
+/**
+ * Gets the number of entities a cache holds before evicting
+ */
+int Fabric_EntityCache_get_limit(EntityCache *self) {
+    return self->limit;
+}
+
+/**
+ * Gets the most entities a cache holds before evicting
+ */
+int Fabric_EntityCache_get_capacity(EntityCache *self) {
+    return self->capacity;
+}
+
+/**
+ * Evicts entities until a cache is within its limit
+ *
+ * Pinned entities are kept, so the cache may still be over its limit.
+ * Any entity returned by the cache that isn't pinned may be evicted.
+ */
+void Fabric_EntityCache_trim(EntityCache *self) {
+    while (self->count > self->limit && Fabric_EntityCache__evict(self));
+}
+
+/**
+ * Gets the number of entities in an entity cache
+ */
+int Fabric_EntityCache_get_count(EntityCache *self) {
+    return self->count;
+}
+
+/**
+ * Gets the number of lookups that found their entity
+ */
+uint64_t Fabric_EntityCache_get_hits(EntityCache *self) {
+    return self->hits;
+}
+
+/**
+ * Gets the number of lookups that didn't find their entity
+ */
+uint64_t Fabric_EntityCache_get_misses(EntityCache *self) {
+    return self->misses;
+}
+
+/**
+ * Gets the number of entities that have been evicted
+ */
+uint64_t Fabric_EntityCache_get_evictions(EntityCache *self) {
+    return self->evictions;
+}
+
+/**
+ * Gets the fraction of lookups that found their entity
+ *
+ * Returns: The hit ratio, or 0 if there have been no lookups
+ */
+float64_t Fabric_EntityCache_get_hit_ratio(EntityCache *self) {
+    uint64_t lookups = self->hits + self->misses;
+    if (lookups == 0) {
+        return 0;
+    }
+    return (float64_t)self->hits / (float64_t)lookups;
+}
+
+/**
+ * Gets the fraction of the lookups since this was last called that found
+ * their entity
+ *
+ * Returns: The hit ratio, or 0 if there have been no lookups
+ */
+float64_t Fabric_EntityCache_get_recent_hit_ratio(EntityCache *self) {
+    uint64_t hits = self->hits - self->marked_hits;
+    uint64_t lookups = hits + self->misses - self->marked_misses;
+    self->marked_hits = self->hits;
+    self->marked_misses = self->misses;
+    if (lookups == 0) {
+        return 0;
+    }
+    return (float64_t)hits / (float64_t)lookups;
+}
+
+#endif
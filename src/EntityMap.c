@@ -3,7 +3,7 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 28, 2015
- * Updated: March 29, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_ENTITY_MAP_C__
@@ -11,10 +11,10 @@
 
 #include "Internal.h"
 #include "Hash.c"
+#include "Stats.c"
 
 #define FABRIC_ENTITYMAP_DEFAULT_CAPACITY 32
-#define FABRIC_ENTITYMAP_MAXLOAD 0.6
-#define FABRIC_ENTITYMAP_TOMBSTONE 0x11111111
+#define FABRIC_ENTITYMAP_MAXLOAD 0.75
 
 typedef struct EnityMapEntry {
     uint32_t key;
@@ -24,19 +24,28 @@ typedef struct EnityMapEntry {
 /**
  * A map of uint32 ids to void* pointers
  *
- * Currently implemented as a simple hash table.
+ * Implemented as an open addressing hash table with linear probing.
+ * The capacity is always a power of two so that a hash can be masked
+ * into a slot, and unsetting a key shifts later entries back instead of
+ * leaving tombstones.
+ *
+ * Ids start at 1, so a key of 0 marks an empty slot and can't be set.
+ * The table is allocated when the first key is set, so a map that stays
+ * empty costs only its header.
  */
 typedef struct EntityMap {
     int count;                  // The number of entries in the map
-    int cap;                    // The capacity of the underlying array
-    EntityMapEntry *entries;    // The underlying data for the map
+    int cap;                    // The capacity of the underlying array; a power of two
+    int max_count;              // The count at which the map grows
+    EntityMapEntry *entries;    // The underlying data for the map, or NULL until a key is set
 } EntityMap;
 
 /**
  * Creates an entity map with a specified capacity
  *
  * Args:
- *      capacity: The initial capacity the map should have, < 1 for default
+ *      capacity: The initial capacity the map should have, < 1 for default.
+ *                It is rounded up to a power of two.
  *      satus: A pointer to where any errors will be stored
  *
  * Returns: A newly allocated and initialized entity map, or NULL on error
@@ -45,24 +54,17 @@ EntityMap *Fabric_EntityMap_new_with_capacity(int capacity, error_t *status) {
     if (capacity < 1) {
         capacity = FABRIC_ENTITYMAP_DEFAULT_CAPACITY;
     }
+    capacity = hash_capacity(capacity);
 
-    EntityMap *map = Fabric_memalloc(sizeof(EntityMap));
+    EntityMap *map = Fabric_memalloc_tagged(sizeof(EntityMap), FABRIC_MEM_CACHE);
     if (NULL == map) {
         *status = Fabric_memerrno();
     } else {
         map->count = 0;
         map->cap = capacity;
-
-        map->entries = Fabric_memalloc(capacity * sizeof(EntityMapEntry));
-        if (NULL == map->entries) {
-            // Clean up the memory
-            Fabric_memfree(map, sizeof(EntityMapEntry));
-            map = NULL;
-            *status = Fabric_memerrno();
-        } else {
-            memset(map->entries, 0, capacity * sizeof(EntityMapEntry));
-            *status = FABRIC_OK;
-        }
+        map->max_count = 0;
+        map->entries = NULL;
+        *status = FABRIC_OK;
     }
 
     return map;
@@ -87,8 +89,10 @@ EntityMap *Fabric_EntityMap_new(error_t *status) {
  *      self: The entity map being destroyed
  */
 void Fabric_EntityMap_destroy(EntityMap *self) {
-    Fabric_memfree(self->entries, self->cap * sizeof(EntityMapEntry));
-    Fabric_memfree(self, sizeof(EntityMap));
+    if (NULL != self->entries) {
+        Fabric_memfree_tagged(self->entries, self->cap * sizeof(EntityMapEntry), FABRIC_MEM_CACHE);
+    }
+    Fabric_memfree_tagged(self, sizeof(EntityMap), FABRIC_MEM_CACHE);
 }
 
 /**
@@ -105,16 +109,23 @@ int Fabric_EntityMap_get_capacity(EntityMap *self) {
     return self->cap;
 }
 
-uint32_t Fabric_EntityMap__pos_of_key(EntityMap *self, uint32_t key) {
-    uint32_t pos = hash_uint32(key) % self->cap;
-    while (self->entries[pos].key != 0) {
-        if (self->entries[pos].key == key) {
-            return pos;
-        }
-        pos = (pos + 1) % self->cap;
+/**
+ * Private function that finds the slot holding a key, or the empty
+ * slot where it would be added
+ *
+ * The lookup and the number of slots it examined are counted.
+ */
+static inline
+uint32_t Fabric_EntityMap__find_slot(EntityMap *self, uint32_t key) {
+    uint32_t mask = self->cap - 1;
+    uint32_t home = hash_uint32(key) & mask;
+    uint32_t pos = home;
+    while (self->entries[pos].key != 0 && self->entries[pos].key != key) {
+        pos = (pos + 1) & mask;
     }
-
-    return FABRIC_ENTITYMAP_TOMBSTONE;
+    Fabric_stats_add(FABRIC_STAT_ENTITYMAP_LOOKUPS, 1);
+    Fabric_stats_add(FABRIC_STAT_ENTITYMAP_PROBES, ((pos - home) & mask) + 1);
+    return pos;
 }
 
 /**
@@ -127,32 +138,26 @@ uint32_t Fabric_EntityMap__pos_of_key(EntityMap *self, uint32_t key) {
  * Returns: TRUE if the set contains the id, FALSE if not
  */
 bool_t Fabric_EntityMap_has_key(EntityMap *self, uint32_t key) {
-    return Fabric_EntityMap__pos_of_key(self, key) != FABRIC_ENTITYMAP_TOMBSTONE;
-}
-
-/**
- * Private method for adding ids to an entity map without performing
- * capacity or duplicate checks.
- */
-void Fabric_EntityMap__add_no_checks(EntityMap *self, EntityMapEntry entry) {
-    int pos = hash_uint32(entry.key) % self->cap;
-    while (self->entries[pos].key != 0 && self->entries[pos].key != FABRIC_ENTITYMAP_TOMBSTONE) {
-        pos = (pos + 1) % self->cap;
+    if (key == 0 || NULL == self->entries) {
+        return FALSE;
     }
-
-    self->entries[pos] = entry;
-    self->count++;
+    return self->entries[Fabric_EntityMap__find_slot(self, key)].key == key;
 }
 
 /**
  * Private function to resize an entity map
+ *
+ * A map without a table is given one of new_cap slots.
  */
+static
 error_t Fabric_EntityMap__resize(EntityMap *self, int new_cap) {
 
     EntityMapEntry *old_data = self->entries;
-    EntityMapEntry *new_data = Fabric_memalloc(new_cap * sizeof(EntityMapEntry));
-    int l = self->cap;
-    int i, status;
+    EntityMapEntry *new_data = Fabric_memalloc_tagged(new_cap * sizeof(EntityMapEntry), FABRIC_MEM_CACHE);
+    uint32_t mask = new_cap - 1;
+    uint32_t pos;
+    int l = NULL == old_data ? 0 : self->cap;
+    int i;
 
     if (new_data == NULL) {
         return Fabric_memerrno();
@@ -161,23 +166,33 @@ error_t Fabric_EntityMap__resize(EntityMap *self, int new_cap) {
     memset(new_data, 0, new_cap * sizeof(EntityMapEntry));
 
     self->entries = new_data;
-    self->count = 0;
     self->cap = new_cap;
+    self->max_count = new_cap * FABRIC_ENTITYMAP_MAXLOAD;
 
+    // The keys are distinct, so each entry goes in the first empty slot
     for (i = 0; i < l; i++) {
-        if (old_data[i].key != 0 && old_data[i].key != FABRIC_ENTITYMAP_TOMBSTONE) {
-            Fabric_EntityMap__add_no_checks(self, old_data[i]);
+        if (old_data[i].key != 0) {
+            pos = hash_uint32(old_data[i].key) & mask;
+            while (self->entries[pos].key != 0) {
+                pos = (pos + 1) & mask;
+            }
+            self->entries[pos] = old_data[i];
         }
     }
+    if (NULL == old_data) {
+        return FABRIC_OK;
+    }
+    Fabric_stats_add(FABRIC_STAT_ENTITYMAP_RESIZES, 1);
 
-    Fabric_memfree(old_data, l * sizeof(EntityMapEntry));
+    Fabric_memfree_tagged(old_data, l * sizeof(EntityMapEntry), FABRIC_MEM_CACHE);
     return FABRIC_OK;
 }
 
 /**
  * Adds or updates a key value pair in an entity map
  *
- * If an error occurs, the map should remain unchanged
+ * If an error occurs, the map should remain unchanged.  Setting the
+ * key 0 has no effect.
  *
  * Args:
  *      self: The map that the new entry is being added to
@@ -186,26 +201,35 @@ error_t Fabric_EntityMap__resize(EntityMap *self, int new_cap) {
  */
 error_t Fabric_EntityMap_set(EntityMap *self, uint32_t key, void* entity) {
     error_t status;
-    EntityMapEntry entry = {key, entity};
-    uint32_t pos = Fabric_EntityMap__pos_of_key(self, key);
-    float load;
+    uint32_t pos;
 
-    if (pos != FABRIC_ENTITYMAP_TOMBSTONE) {
-        self->entries[pos].entity = entity;
+    if (key == 0) {
         return FABRIC_OK;
     }
+    if (NULL == self->entries) {
+        status = Fabric_EntityMap__resize(self, self->cap);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
 
-    load = (float)(self->count + 1) / (float)(self->cap);
+    pos = Fabric_EntityMap__find_slot(self, key);
+    if (self->entries[pos].key == key) {
+        self->entries[pos].entity = entity;
+        return FABRIC_OK;
+    }
 
-    if (load > FABRIC_ENTITYMAP_MAXLOAD) {
+    if (self->count + 1 > self->max_count) {
         status = Fabric_EntityMap__resize(self, self->cap * 2);
         if (FABRIC_OK != status) {
             return status;
         }
+        pos = Fabric_EntityMap__find_slot(self, key);
     }
 
-    Fabric_EntityMap__add_no_checks(self, entry);
-
+    self->entries[pos].key = key;
+    self->entries[pos].entity = entity;
+    self->count++;
     return FABRIC_OK;
 }
 
@@ -219,27 +243,52 @@ error_t Fabric_EntityMap_set(EntityMap *self, uint32_t key, void* entity) {
  * Returns: The value associated with the key, or NULL if it doesn't exist
  */
 void* Fabric_EntityMap_get(EntityMap *self, uint32_t key) {
-    uint32_t pos = Fabric_EntityMap__pos_of_key(self, key);
-    if (pos == FABRIC_ENTITYMAP_TOMBSTONE) {
+    EntityMapEntry *entry;
+    if (key == 0 || NULL == self->entries) {
         return NULL;
     }
-    return self->entries[pos].entity;
+    entry = self->entries + Fabric_EntityMap__find_slot(self, key);
+    return entry->key == key ? entry->entity : NULL;
 }
 
 /**
  * Unsets a key value pair in an entity map
  *
+ * The entries after it in its probe sequence are shifted back into the
+ * freed slot so that no tombstone is needed.
+ *
  * Args:
  *      self: The map that is having the entry removed
  *      key: The key of the entry being removed
  */
 void Fabric_EntityMap_unset(EntityMap *self, uint32_t key) {
-    uint32_t pos = Fabric_EntityMap__pos_of_key(self, key);
-    if (pos != FABRIC_ENTITYMAP_TOMBSTONE) {
-        self->entries[pos].key = FABRIC_ENTITYMAP_TOMBSTONE;
-        self->entries[pos].entity = NULL;
-        self->count--;
+    uint32_t mask = self->cap - 1;
+    uint32_t hole, pos, home;
+
+    if (key == 0 || NULL == self->entries) {
+        return;
+    }
+    hole = Fabric_EntityMap__find_slot(self, key);
+    if (self->entries[hole].key != key) {
+        return;
+    }
+
+    pos = hole;
+    for (;;) {
+        pos = (pos + 1) & mask;
+        if (self->entries[pos].key == 0) {
+            break;
+        }
+        // Move the entry back if the hole lies between its home and its slot
+        home = hash_uint32(self->entries[pos].key) & mask;
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            self->entries[hole] = self->entries[pos];
+            hole = pos;
+        }
     }
+    self->entries[hole].key = 0;
+    self->entries[hole].entity = NULL;
+    self->count--;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,122 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_ENTITYVIEW_C__
+#define _FABRIC_ENTITYVIEW_C__
+
+#include "Internal.h"
+
+/**
+ * An Entity View gives read only access to an entity's record without
+ * copying it into an entity object.
+ *
+ * A view points straight at the record's bytes in a pinned buffer pool
+ * page or in the graph's file mapping.  The fields of the record are only
+ * decoded when they are read, using the Fabric_XView_get_* functions of
+ * each entity type.  A view needs no allocation, which makes it the
+ * preferred way for read only traversals to look at entities.  Entity
+ * objects are still needed to change an entity.
+ *
+ * A record that spans two pages, or an entity whose newest version is in
+ * a store's cache, is copied into the view's own buffer instead.
+ *
+ * A view holds a pin on its page until it is released, so views should
+ * be short lived.  The bytes of a view over a mapped graph are only valid
+ * until the next write that grows the graph file.
+ */
+typedef struct EntityView {
+    Graph *graph;                               // The graph whose record is viewed
+    uint8_t *data;                              // The record's bytes
+    uint32_t page_no;                           // The pinned page holding the record
+    bool_t is_pinned;                           // Whether the bytes were pinned by the graph
+    uint8_t copy[FABRIC_ENTITY_VIEW_COPY_SIZE]; // Holds records that couldn't be pinned
+} EntityView;
+
+/**
+ * Initializes a view so that it views nothing
+ *
+ * Releasing a view that views nothing does nothing.
+ */
+void Fabric_EntityView_init(EntityView *self) {
+    self->graph = NULL;
+    self->data = NULL;
+    self->is_pinned = FALSE;
+}
+
+/**
+ * Points a view at a record in the graph file
+ *
+ * Anything the view was viewing is released first.
+ *
+ * Args:
+ *      self: The view
+ *      graph: The graph holding the record
+ *      num_bytes: The size of the record; at most FABRIC_ENTITY_VIEW_COPY_SIZE
+ *      offset: The file offset of the record
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_EntityView_open(EntityView *self, Graph *graph, uint32_t num_bytes, uint32_t offset) {
+    error_t status;
+
+    Fabric_EntityView_release(self);
+    if (num_bytes > FABRIC_ENTITY_VIEW_COPY_SIZE) {
+        return FABRIC_ENTITY_VIEW_ERROR;
+    }
+
+    self->graph = graph;
+    self->data = Fabric_Graph_pin_bytes(graph, num_bytes, offset, &self->page_no, &status);
+    if (NULL != self->data) {
+        self->is_pinned = TRUE;
+        return FABRIC_OK;
+    }
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    // The record isn't contiguous in memory so it has to be copied
+    self->data = self->copy;
+    return Fabric_Graph_read_bytes(graph, self->copy, num_bytes, offset);
+}
+
+/**
+ * Prepares a view to hold a copy of a record
+ *
+ * Anything the view was viewing is released first.
+ *
+ * Returns: The buffer the record should be copied into; it holds
+ *          FABRIC_ENTITY_VIEW_COPY_SIZE bytes
+ */
+uint8_t *Fabric_EntityView_copy(EntityView *self) {
+    Fabric_EntityView_release(self);
+    self->data = self->copy;
+    return self->copy;
+}
+
+/**
+ * Returns the bytes of the record a view is viewing
+ */
+uint8_t *Fabric_EntityView_get_data(EntityView *self) {
+    return self->data;
+}
+
+/**
+ * Releases the page a view is holding
+ *
+ * The view views nothing afterwards.
+ */
+void Fabric_EntityView_release(EntityView *self) {
+    if (self->is_pinned) {
+        Fabric_Graph_unpin_bytes(self->graph, self->page_no);
+    }
+    self->graph = NULL;
+    self->data = NULL;
+    self->is_pinned = FALSE;
+}
+
+#endif
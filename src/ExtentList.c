@@ -0,0 +1,154 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_EXTENTLIST_C__
+#define _FABRIC_EXTENTLIST_C__
+
+#include "Internal.h"
+
+/**
+ * An Extent List describes the regions of the graph file that make up a
+ * store.
+ *
+ * A store starts as a single extent and grows by chaining another extent
+ * onto the end of the list.  New extents are allocated at the end of the
+ * file, so a store can grow without moving any other store.  Each new
+ * extent is as large as all of the store's previous extents together, so
+ * a store of n bytes has O(log n) extents.
+ *
+ * A store holds fixed size records numbered from 1.  The first extent
+ * begins with the store's header.  Records never straddle two extents,
+ * so any bytes at the end of an extent that can't hold a whole record
+ * are unused.  Byte addressed stores use a record size of 1.
+ *
+ * The lists of every store are kept in the graph's store directory.
+ */
+typedef struct Extent {
+    uint32_t offset;        // The file offset of the extent
+    uint32_t size;          // The size of the extent in bytes
+} Extent;
+
+typedef struct ExtentList {
+    uint32_t header_size;   // The bytes reserved for the store header at the start of the first extent
+    uint32_t record_size;   // The size of each of the store's records
+    uint32_t capacity;      // The number of records that fit in the store
+    int num_extents;        // The number of extents in the list
+    Extent extents[FABRIC_MAX_STORE_EXTENTS];       // The extents in store order
+    uint32_t first_ids[FABRIC_MAX_STORE_EXTENTS];   // The id of the first record in each extent
+} ExtentList;
+
+/**
+ * Initializes an empty extent list
+ *
+ * Args:
+ *      self: The list being initialized
+ *      header_size: The size of the store's header
+ *      record_size: The size of the store's records
+ */
+void Fabric_ExtentList_init(ExtentList *self, uint32_t header_size, uint32_t record_size) {
+    self->header_size = header_size;
+    self->record_size = record_size > 0 ? record_size : 1;
+    self->capacity = 0;
+    self->num_extents = 0;
+}
+
+/**
+ * Adds an extent to the end of a list
+ *
+ * Returns: FABRIC_OK on success or FABRIC_EXTENT_LIMIT if the list is full
+ */
+error_t Fabric_ExtentList_add(ExtentList *self, uint32_t offset, uint32_t size) {
+    uint32_t usable = size;
+
+    if (self->num_extents >= FABRIC_MAX_STORE_EXTENTS) {
+        return FABRIC_EXTENT_LIMIT;
+    }
+    if (self->num_extents == 0) {
+        usable = size > self->header_size ? size - self->header_size : 0;
+    }
+
+    self->extents[self->num_extents].offset = offset;
+    self->extents[self->num_extents].size = size;
+    self->first_ids[self->num_extents] = self->capacity + 1;
+    self->num_extents++;
+    self->capacity += usable / self->record_size;
+    return FABRIC_OK;
+}
+
+/**
+ * Returns the index of the extent holding a record
+ *
+ * The id must be between 1 and the list's capacity.
+ */
+int Fabric_ExtentList_find(ExtentList *self, uint32_t id) {
+    int low = 0;
+    int high = self->num_extents - 1;
+    int middle;
+
+    // Find the last extent whose first id is not after id
+    while (low < high) {
+        middle = (low + high + 1) / 2;
+        if (self->first_ids[middle] <= id) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return low;
+}
+
+/**
+ * Returns the file offset of a record
+ *
+ * The id must be between 1 and the list's capacity.
+ */
+uint32_t Fabric_ExtentList_get_record_offset(ExtentList *self, uint32_t id) {
+    int i = Fabric_ExtentList_find(self, id);
+    uint32_t offset = self->extents[i].offset + (id - self->first_ids[i]) * self->record_size;
+    return i == 0 ? offset + self->header_size : offset;
+}
+
+/**
+ * Returns the number of records from id to the end of its extent
+ *
+ * These records are contiguous in the file.
+ */
+uint32_t Fabric_ExtentList_get_contiguous(ExtentList *self, uint32_t id) {
+    int i = Fabric_ExtentList_find(self, id);
+    uint32_t end_id = i + 1 < self->num_extents ? self->first_ids[i + 1] : self->capacity + 1;
+    return end_id - id;
+}
+
+/**
+ * Returns the file offset of the store's header
+ */
+uint32_t Fabric_ExtentList_get_header_offset(ExtentList *self) {
+    return self->num_extents > 0 ? self->extents[0].offset : 0;
+}
+
+/**
+ * Returns the total size of the list's extents in bytes
+ */
+uint32_t Fabric_ExtentList_get_size(ExtentList *self) {
+    uint32_t size = 0;
+    int i;
+    for (i = 0; i < self->num_extents; i++) {
+        size += self->extents[i].size;
+    }
+    return size;
+}
+
+/**
+ * Returns the size of the next extent to add to a list
+ */
+uint32_t Fabric_ExtentList_get_next_size(ExtentList *self) {
+    uint32_t size = Fabric_ExtentList_get_size(self);
+    return size < MIN_PAGE_SIZE ? MIN_PAGE_SIZE : size;
+}
+
+#endif
@@ -15,7 +15,7 @@
 /**
  * This file implements most of the public interface for the FabricDB library.
  */
-#define FABRIC_VERSION_NUMBER 1
+#define FABRIC_VERSION_NUMBER 2
 
 const char FABRIC_HEADER_STRING[16] = {
     'f', 'a', 'b', 'r', 'i', 'c', 'd', 'b', ' ', 'v', '0', '.', '1', '\0', '\0', '\0'
@@ -24,13 +24,42 @@ const char FABRIC_HEADER_STRING[16] = {
 /**
  * Creates a new Fabric graph in the specified file
  *
+ * The graph's bulk arrays (saved adjacency snapshots, property column
+ * pages and free id runs) are stored in the host's byte order, so they
+ * are read without being converted.  Records and page headers are big
+ * endian whatever the byte order, and are still decoded field by field.
+ * The file can still be read by a host with the other byte order.
+ *
  * Args:
  *      file: A valid, open file object where the graph will be stored
  *      new_graph: Memory location for the newly created graph
  */
 void Fabric_create_graph(FILE *graph_file, Graph *new_graph) {
+    Fabric_create_graph_with_byte_order(graph_file, new_graph, FABRIC_BYTE_ORDER_HOST);
+}
+
+/**
+ * Creates a new Fabric graph whose bulk arrays are stored in a given byte order
+ *
+ * Only the arrays listed by Fabric_create_graph follow the byte order;
+ * records and page headers are always big endian.
+ *
+ * Args:
+ *      file: A valid, open file object where the graph will be stored
+ *      new_graph: Memory location for the newly created graph
+ *      byte_order: FABRIC_BYTE_ORDER_BIG_ENDIAN or FABRIC_BYTE_ORDER_LITTLE_ENDIAN
+ */
+void Fabric_create_graph_with_byte_order(FILE *graph_file, Graph *new_graph, int byte_order) {
     int i;
     new_graph->graph_file = graph_file;
+    new_graph->is_mapped = FALSE;
+    new_graph->has_wal = FALSE;
+    new_graph->snapshots = NULL;
+    new_graph->batch = NULL;
+    new_graph->mem_pressure = Fabric_mempressure();
+    new_graph->first_page = NULL;
+    new_graph->position = 0;
+    Fabric_BufferPool_init(&new_graph->buffer_pool, graph_file, FABRIC_PAGE_SIZE, FABRIC_BUFFER_POOL_SIZE);
 
     // initialize header strings
     for (i = 0; i < 16; i++) {
@@ -42,7 +71,7 @@ void Fabric_create_graph(FILE *graph_file, Graph *new_graph) {
     new_graph->fabric_version_number = FABRIC_VERSION_NUMBER;
     new_graph->application_version_number = 0;
     new_graph->file_change_counter = 1;
-    new_graph->class_store.offset = FABRIC_HEADER_SIZE;
+    new_graph->class_store.offset = FABRIC_HEADER_SIZE + FABRIC_STORE_DIRECTORY_SIZE;
     new_graph->label_store.offset = new_graph->class_store.offset + MIN_PAGE_SIZE;
     new_graph->vertex_store.offset = new_graph->label_store.offset + MIN_PAGE_SIZE;
     new_graph->edge_store.offset = new_graph->vertex_store.offset + MIN_PAGE_SIZE;
@@ -52,18 +81,117 @@ void Fabric_create_graph(FILE *graph_file, Graph *new_graph) {
     new_graph->index_store.offset = new_graph->text_store.offset + MIN_PAGE_SIZE;
     new_graph->index_store.page_size = INDEX_PAGE_SIZE;
     new_graph->index_store.page_count = 0;
+    new_graph->index_store.class_index = NULL;
+    new_graph->index_store.label_index = NULL;
+    new_graph->index_store.property_indexes = NULL;
+    new_graph->index_store.property_columns = NULL;
+    new_graph->adjacency_snapshot_offset = 0;
+    new_graph->byte_order = byte_order;
+    new_graph->free_id_directory_offset = 0;
+    new_graph->class_store.cache = NULL;
+    new_graph->class_store.changed = NULL;
+    Fabric_FreeIdMap_init(&new_graph->class_store.free_ids);
+    new_graph->class_store.hierarchy = NULL;
+    new_graph->label_store.cache = NULL;
+    new_graph->label_store.changed = NULL;
+    Fabric_FreeIdMap_init(&new_graph->label_store.free_ids);
+    new_graph->vertex_store.cache = NULL;
+    new_graph->vertex_store.changed = NULL;
+    Fabric_FreeIdMap_init(&new_graph->vertex_store.free_ids);
+    new_graph->edge_store.cache = NULL;
+    new_graph->edge_store.changed = NULL;
+    Fabric_FreeIdMap_init(&new_graph->edge_store.free_ids);
+    new_graph->edge_store.partitions = NULL;
+    new_graph->edge_store.degrees = NULL;
+    new_graph->property_store.cache = NULL;
+    new_graph->property_store.changed = NULL;
+    Fabric_FreeIdMap_init(&new_graph->property_store.free_ids);
+    new_graph->property_store.index_changes = NULL;
+    new_graph->property_store.directories = NULL;
+
+    // Give each store its first extent
+    Fabric_Graph_create_directory(new_graph);
 
     // Write header values to file
     Fabric_Graph_write_header (new_graph);
 
     // TODO: Initialize stores
 
+    Fabric_Graph_flush(new_graph);
 }
 
 void Fabric_load_graph(FILE *graph_file, Graph *graph) {
     Fabric_Graph_init(graph, graph_file);
 }
 
+/**
+ * Loads a graph by mapping its file into memory
+ *
+ * Reads become pointer arithmetic on the mapping instead of going
+ * through the buffer pool.  This suits read-mostly graphs and lets
+ * processes share the operating system's page cache.  The file must
+ * be open for reading and writing and must not be used through stdio
+ * while the graph is loaded.
+ *
+ * Args:
+ *      graph_file: The graph's file
+ *      graph: Memory location for the loaded graph
+ *
+ * Returns: FABRIC_OK on success, FABRIC_MAPPING_ERROR if the file could not be mapped
+ */
+error_t Fabric_map_graph(FILE *graph_file, Graph *graph) {
+    if (Fabric_Graph_init_mapped(graph, graph_file) != 0) {
+        return FABRIC_MAPPING_ERROR;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Loads a graph whose writes are logged to a write-ahead log
+ *
+ * Writes committed before a crash are recovered from the log.  Commit
+ * with Fabric_commit_graph(1) to make writes durable at the cost of an
+ * append to the log rather than a sync of the graph file.
+ *
+ * Args:
+ *      graph_file: The graph's file
+ *      wal_file: The graph's log file, opened for reading and writing;
+ *                an empty file starts a new log
+ *      graph: Memory location for the loaded graph
+ *
+ * Returns: FABRIC_OK on success, FABRIC_WAL_ERROR if the log could not be recovered
+ */
+error_t Fabric_load_logged_graph(FILE *graph_file, FILE *wal_file, Graph *graph) {
+    if (Fabric_Graph_init_logged(graph, graph_file, wal_file) != 0) {
+        return FABRIC_WAL_ERROR;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Makes the writes to a graph since its last commit durable
+ *
+ * Args:
+ *      graph: A graph that was created or loaded
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_commit_graph(Graph *graph) {
+    return Fabric_Graph_commit(graph);
+}
+
+/**
+ * Writes any buffered changes to a graph's file and frees the graph's memory
+ *
+ * The graph's file is left open.
+ *
+ * Args:
+ *      graph: A graph that was created or loaded
+ */
+void Fabric_close_graph(Graph *graph) {
+    Fabric_Graph_deinit(graph);
+}
+
 void Fabric_dump_graph_header (Graph *graph) {
     int i;
     fprintf(stdout, "Fabric Header String: ");
@@ -90,4 +218,49 @@ void Fabric_dump_graph_header (Graph *graph) {
     fprintf(stdout, "Index Store Offset: %lu\n", (unsigned long)graph->index_store.offset);
     fprintf(stdout, "Index Page Size: %lu\n", (unsigned long)graph->index_store.page_size);
     fprintf(stdout, "Index Page Count: %lu\n", (unsigned long)graph->index_store.page_count);
-}
\ No newline at end of file
+    fprintf(stdout, "Byte Order: %s\n",
+        FABRIC_BYTE_ORDER_BIG_ENDIAN == graph->byte_order ? "big endian" : "little endian");
+}
+
+void Fabric_dump_graph_stats (Graph *graph) {
+    static const char *store_names[FABRIC_STATS_NUM_STORES] = {
+        "Class", "Label", "Vertex", "Edge", "Property", "Text", "Index"
+    };
+    static const char *memory_names[FABRIC_MEM_NUM_TAGS] = {
+        "General", "Cache", "Index", "Text", "List", "I/O"
+    };
+    GraphStats stats;
+    GraphStoreStats *store;
+    int i;
+
+    Fabric_Graph_get_stats(graph, &stats);
+    for (i = 0; i < FABRIC_STATS_NUM_STORES; i++) {
+        store = &stats.stores[i];
+        fprintf(stdout, "%s Store: %llu cache hits, %llu cache misses, %llu evictions, "
+            "%llu records read, %llu records written, %llu flushes in %.3f ms\n",
+            store_names[i], (unsigned long long)store->cache_hits, (unsigned long long)store->cache_misses,
+            (unsigned long long)store->cache_evictions, (unsigned long long)store->records_read,
+            (unsigned long long)store->records_written, (unsigned long long)store->flushes, store->flush_nanos / 1e6);
+    }
+    fprintf(stdout, "Graph Reads: %llu calls, %llu bytes\n",
+        (unsigned long long)stats.read_bytes_calls, (unsigned long long)stats.bytes_read);
+    fprintf(stdout, "Graph Writes: %llu calls, %llu bytes\n",
+        (unsigned long long)stats.write_bytes_calls, (unsigned long long)stats.bytes_written);
+    fprintf(stdout, "Seeks: %llu\n", (unsigned long long)stats.seeks);
+    fprintf(stdout, "Buffer Pool: %llu page hits, %llu page misses\n",
+        (unsigned long long)stats.page_hits, (unsigned long long)stats.page_misses);
+    fprintf(stdout, "File I/O: %llu bytes read, %llu bytes written\n",
+        (unsigned long long)stats.file_bytes_read, (unsigned long long)stats.file_bytes_written);
+    fprintf(stdout, "Graph Flushes: %llu in %.3f ms\n",
+        (unsigned long long)stats.graph_flushes, stats.graph_flush_nanos / 1e6);
+    fprintf(stdout, "Id Set Lookups: %llu, %.2f probes each, %llu resizes\n", (unsigned long long)stats.idset_lookups,
+        stats.idset_lookups > 0 ? (double)stats.idset_probes / stats.idset_lookups : 0.0,
+        (unsigned long long)stats.idset_resizes);
+    fprintf(stdout, "Entity Map Lookups: %llu, %.2f probes each, %llu resizes\n", (unsigned long long)stats.entitymap_lookups,
+        stats.entitymap_lookups > 0 ? (double)stats.entitymap_probes / stats.entitymap_lookups : 0.0,
+        (unsigned long long)stats.entitymap_resizes);
+    for (i = 0; i < FABRIC_MEM_NUM_TAGS; i++) {
+        fprintf(stdout, "%s Memory: %lu\n", memory_names[i], (unsigned long)stats.memory_used[i]);
+    }
+    fprintf(stdout, "Total Memory: %lu\n", (unsigned long)stats.memory_total);
+}
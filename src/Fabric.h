@@ -11,7 +11,13 @@
 #include "Internal.h"
 
 void Fabric_create_graph(FILE *file, Graph *new_graph);
+void Fabric_create_graph_with_byte_order(FILE *file, Graph *new_graph, int byte_order);
 void Fabric_load_graph(FILE *graph_file, Graph *graph);
+error_t Fabric_map_graph(FILE *graph_file, Graph *graph);
+error_t Fabric_load_logged_graph(FILE *graph_file, FILE *wal_file, Graph *graph);
+error_t Fabric_commit_graph(Graph *graph);
+void Fabric_close_graph(Graph *graph);
 void Fabric_dump_graph_header (Graph *graph);
+void Fabric_dump_graph_stats (Graph *graph);
 
 #endif
\ No newline at end of file
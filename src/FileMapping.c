@@ -0,0 +1,325 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_FILEMAPPING_C__
+#define _FABRIC_FILEMAPPING_C__
+
+#include <string.h>
+#include "Internal.h"
+
+#ifndef FABRIC_NO_MMAP
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+/**
+ * A File Mapping maps a whole graph file into memory.
+ *
+ * It is an alternative to the buffer pool for read-mostly graphs.  Reads
+ * become pointer arithmetic on the mapping, there is no stdio buffering
+ * and the operating system's page cache is shared by every process that
+ * maps the same file.
+ *
+ * The mapping always covers the whole file.  Reading past the end of the
+ * file yields zeros.  Writing past the end grows the file in
+ * FABRIC_MAPPING_GROWTH steps and remaps it, so pointers into the mapping
+ * are only valid until the next write that grows the file.
+ *
+ * Advice on how regions of the mapping will be used belongs to the
+ * mapping rather than to the file, so the mapping remembers up to
+ * FABRIC_MAPPING_MAX_ADVICE regions and advises them again whenever it is
+ * remapped.
+ *
+ * On systems without mmap (FABRIC_NO_MMAP defined) a mapping can not be
+ * initialized and graphs must use the buffer pool.
+ */
+#ifndef FABRIC_MAPPING_GROWTH
+#  define FABRIC_MAPPING_GROWTH MIN_PAGE_SIZE
+#endif
+#ifndef FABRIC_MAPPING_MAX_ADVICE
+#  define FABRIC_MAPPING_MAX_ADVICE 64
+#endif
+
+typedef struct FileMappingAdvice {
+    size_t offset;          // The file offset of the start of the region
+    size_t length;          // The length of the region in bytes
+    int advice;             // One of the FABRIC_ADVISE_* values
+} FileMappingAdvice;
+
+typedef struct FileMapping {
+    int fd;                 // The file descriptor of the mapped file
+    uint8_t *data;          // The start of the mapping
+    size_t size;            // The size of the mapping and of the file in bytes
+    int num_advice;         // The number of regions in advice
+    FileMappingAdvice advice[FABRIC_MAPPING_MAX_ADVICE]; // The regions advised so far
+} FileMapping;
+
+#ifndef FABRIC_NO_MMAP
+
+/**
+ * Private function that maps the first size bytes of the file
+ *
+ * The previous mapping, if any, is only unmapped once the new one has
+ * succeeded, so a failure leaves the mapping as it was.
+ */
+static
+error_t Fabric_FileMapping__map(FileMapping *self, size_t size) {
+    void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, self->fd, 0);
+    if (MAP_FAILED == data) {
+        return FABRIC_MAPPING_ERROR;
+    }
+    if (NULL != self->data) {
+        munmap(self->data, self->size);
+    }
+    self->data = data;
+    self->size = size;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that converts a FABRIC_ADVISE_* value and applies it
+ * to the part of a region that lies within the mapping
+ */
+static
+error_t Fabric_FileMapping__advise(FileMapping *self, size_t offset, size_t length, int advice) {
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t start = offset / page_size * page_size;
+    int native_advice;
+
+    if (start >= self->size) {
+        return FABRIC_OK;
+    }
+    length += offset - start;
+    if (start + length > self->size) {
+        length = self->size - start;
+    }
+
+    switch (advice) {
+        case FABRIC_ADVISE_SEQUENTIAL:
+            native_advice = MADV_SEQUENTIAL;
+            break;
+        case FABRIC_ADVISE_RANDOM:
+            native_advice = MADV_RANDOM;
+            break;
+        case FABRIC_ADVISE_WILLNEED:
+            native_advice = MADV_WILLNEED;
+            break;
+        default:
+            native_advice = MADV_NORMAL;
+    }
+
+    if (madvise(self->data + start, length, native_advice) != 0) {
+        return FABRIC_MAPPING_ERROR;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Maps a graph file into memory
+ *
+ * Any data buffered by stdio for the file is flushed first.  Once the
+ * file is mapped it should no longer be read or written through stdio.
+ *
+ * Args:
+ *      self: The mapping being initialized
+ *      file: An open file that is readable and writable
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_FileMapping_init(FileMapping *self, FILE *file) {
+    struct stat info;
+    size_t size;
+
+    fflush(file);
+    self->fd = fileno(file);
+    self->data = NULL;
+    self->size = 0;
+    self->num_advice = 0;
+
+    if (self->fd < 0 || fstat(self->fd, &info) != 0) {
+        return FABRIC_MAPPING_ERROR;
+    }
+
+    // An empty file can't be mapped, so give it some room up front
+    size = info.st_size;
+    if (size == 0) {
+        size = FABRIC_MAPPING_GROWTH;
+        if (ftruncate(self->fd, size) != 0) {
+            return FABRIC_MAPPING_ERROR;
+        }
+    }
+
+    return Fabric_FileMapping__map(self, size);
+}
+
+/**
+ * Writes the mapping back to the file and unmaps it
+ */
+void Fabric_FileMapping_deinit(FileMapping *self) {
+    if (NULL != self->data) {
+        msync(self->data, self->size, MS_SYNC);
+        munmap(self->data, self->size);
+        self->data = NULL;
+        self->size = 0;
+    }
+}
+
+/**
+ * Makes sure the file and the mapping are at least min_size bytes
+ *
+ * If the file is too small it is grown and remapped, which may move the
+ * mapping to a different address.  The remembered advice is applied to
+ * the new mapping.  If the remapping fails the old mapping is kept.
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_FileMapping_ensure_size(FileMapping *self, size_t min_size) {
+    error_t status;
+    size_t new_size;
+    int i;
+
+    if (min_size <= self->size) {
+        return FABRIC_OK;
+    }
+
+    new_size = (min_size + FABRIC_MAPPING_GROWTH - 1) / FABRIC_MAPPING_GROWTH * FABRIC_MAPPING_GROWTH;
+    if (ftruncate(self->fd, new_size) != 0) {
+        return FABRIC_MAPPING_ERROR;
+    }
+    status = Fabric_FileMapping__map(self, new_size);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    // Advice is only a hint, so failing to apply it again isn't an error
+    for (i = 0; i < self->num_advice; i++) {
+        Fabric_FileMapping__advise(self, self->advice[i].offset, self->advice[i].length, self->advice[i].advice);
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Schedules the mapping's changes to be written to the file
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_FileMapping_sync(FileMapping *self) {
+    if (msync(self->data, self->size, MS_ASYNC) != 0) {
+        return FABRIC_MAPPING_ERROR;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Advises the operating system on how a region of the mapping will be used
+ *
+ * The parts of the region beyond the end of the mapping are ignored until
+ * the mapping grows over them.  Every advice but FABRIC_ADVISE_WILLNEED,
+ * which only asks for the region to be read ahead once, is remembered so
+ * that it holds across remappings; a region advised again replaces its
+ * earlier advice.
+ *
+ * Args:
+ *      self: The mapping
+ *      offset: The file offset of the start of the region
+ *      length: The length of the region in bytes
+ *      advice: One of the FABRIC_ADVISE_* values
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_FileMapping_advise(FileMapping *self, size_t offset, size_t length, int advice) {
+    int i;
+
+    if (FABRIC_ADVISE_WILLNEED != advice) {
+        for (i = 0; i < self->num_advice; i++) {
+            if (self->advice[i].offset == offset && self->advice[i].length == length) {
+                break;
+            }
+        }
+        if (i < FABRIC_MAPPING_MAX_ADVICE) {
+            self->advice[i].offset = offset;
+            self->advice[i].length = length;
+            self->advice[i].advice = advice;
+            if (i == self->num_advice) {
+                self->num_advice++;
+            }
+        }
+    }
+    return Fabric_FileMapping__advise(self, offset, length, advice);
+}
+
+#else
+
+error_t Fabric_FileMapping_init(FileMapping *self, FILE *file) {
+    (void)file;
+    self->data = NULL;
+    self->size = 0;
+    self->num_advice = 0;
+    return FABRIC_MAPPING_ERROR;
+}
+
+void Fabric_FileMapping_deinit(FileMapping *self) {
+    (void)self;
+}
+
+error_t Fabric_FileMapping_ensure_size(FileMapping *self, size_t min_size) {
+    (void)self;
+    (void)min_size;
+    return FABRIC_MAPPING_ERROR;
+}
+
+error_t Fabric_FileMapping_sync(FileMapping *self) {
+    (void)self;
+    return FABRIC_MAPPING_ERROR;
+}
+
+error_t Fabric_FileMapping_advise(FileMapping *self, size_t offset, size_t length, int advice) {
+    (void)self;
+    (void)offset;
+    (void)length;
+    (void)advice;
+    return FABRIC_OK;
+}
+
+#endif
+
+/**
+ * Copies bytes out of the mapping
+ *
+ * Bytes beyond the end of the file are read as zeros.
+ */
+void Fabric_FileMapping_read(FileMapping *self, uint8_t *destination, size_t num_bytes, size_t offset) {
+    size_t available = 0;
+    if (offset < self->size) {
+        available = self->size - offset;
+        if (available > num_bytes) {
+            available = num_bytes;
+        }
+        memcpy(destination, self->data + offset, available);
+    }
+    if (available < num_bytes) {
+        memset(destination + available, 0, num_bytes - available);
+    }
+}
+
+/**
+ * Copies bytes into the mapping, growing the file if needed
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_FileMapping_write(FileMapping *self, uint8_t *source, size_t num_bytes, size_t offset) {
+    error_t status = Fabric_FileMapping_ensure_size(self, offset + num_bytes);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    memcpy(self->data + offset, source, num_bytes);
+    return FABRIC_OK;
+}
+
+#endif
@@ -0,0 +1,504 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_FREEIDMAP_C__
+#define _FABRIC_FREEIDMAP_C__
+
+#include <string.h>
+#include "Internal.h"
+
+/* The number of ids covered by each summary word */
+#define FABRIC_FREEIDMAP_GROUP_SIZE 4096
+/* The fewest runs a saved map has room for */
+#define FABRIC_FREEIDMAP_MIN_RUNS 16
+/* The number of runs read from the file at once */
+#define FABRIC_FREEIDMAP_CHUNK 256
+
+/**
+ * The free id directory has an entry for each store with a free id map,
+ * in store id order, holding the offset of the store's saved runs and
+ * the number of runs there is room for there.
+ */
+#define FABRIC_FREEIDMAP_DIRECTORY_ENTRY_SIZE 8
+#define FABRIC_FREEIDMAP_DIRECTORY_SIZE (FABRIC_FREEIDMAP_DIRECTORY_ENTRY_SIZE * FABRIC_PROPERTY_STORE)
+
+/**
+ * A Free Id Map tracks the ids of a store that are free to be given out
+ * again, below the store's last free id.
+ *
+ * The map is a bitmap with a bit for each id, and a summary bitmap with
+ * a bit for each word of the first that isn't zero.  Taking an id finds
+ * the lowest free one, so deleted records are reused from the front of
+ * the store and new records stay close together.  The map remembers the
+ * lowest summary word that can have a free id, so taking ids only skips
+ * each empty part of the map once until an id below it is freed.
+ *
+ * A map is saved to the graph file as a list of runs of free ids: a
+ * count of the runs followed by the first id and the length of each of
+ * them, in the file's byte order.  Each store's runs have their own
+ * section, which is rewritten in place while it has room and moved to
+ * the end of the file when it doesn't.  The sections are listed in the
+ * free id directory, whose offset is kept in the graph's header.
+ */
+typedef struct FreeIdMap {
+    uint64_t capacity;      // The number of ids the bitmaps have room for
+    uint32_t count;         // The number of free ids
+    uint32_t lowest;        // No summary word below this one has a bit set
+    uint64_t *words;        // Bit i of word w is set when id 64 * w + i is free
+    uint64_t *summary;      // Bit j of word s is set when word 64 * s + j isn't 0
+    bool_t is_changed;      // Whether the map changed since it was last saved
+} FreeIdMap;
+
+/**
+ * Initializes an empty free id map
+ */
+void Fabric_FreeIdMap_init(FreeIdMap *self) {
+    self->capacity = 0;
+    self->count = 0;
+    self->lowest = 0;
+    self->words = NULL;
+    self->summary = NULL;
+    self->is_changed = FALSE;
+}
+
+/**
+ * Frees the memory used by a free id map
+ */
+void Fabric_FreeIdMap_deinit(FreeIdMap *self) {
+    if (NULL != self->words) {
+        Fabric_memfree_tagged(self->words, self->capacity / 8, FABRIC_MEM_INDEX);
+        Fabric_memfree_tagged(self->summary, self->capacity / FABRIC_FREEIDMAP_GROUP_SIZE * 8, FABRIC_MEM_INDEX);
+    }
+    Fabric_FreeIdMap_init(self);
+}
+
+/**
+ * Private function that grows a map until it has room for an id
+ */
+static
+error_t Fabric_FreeIdMap__grow(FreeIdMap *self, uint32_t id) {
+    uint64_t capacity = self->capacity > 0 ? self->capacity : FABRIC_FREEIDMAP_GROUP_SIZE;
+    uint64_t *words, *summary;
+
+    while (capacity <= id) {
+        capacity *= 2;
+    }
+    words = Fabric_memalloc_tagged(capacity / 8, FABRIC_MEM_INDEX);
+    summary = Fabric_memalloc_tagged(capacity / FABRIC_FREEIDMAP_GROUP_SIZE * 8, FABRIC_MEM_INDEX);
+    if (NULL == words || NULL == summary) {
+        if (NULL != words) {
+            Fabric_memfree_tagged(words, capacity / 8, FABRIC_MEM_INDEX);
+        }
+        if (NULL != summary) {
+            Fabric_memfree_tagged(summary, capacity / FABRIC_FREEIDMAP_GROUP_SIZE * 8, FABRIC_MEM_INDEX);
+        }
+        return Fabric_memerrno();
+    }
+    memset(words, 0, capacity / 8);
+    memset(summary, 0, capacity / FABRIC_FREEIDMAP_GROUP_SIZE * 8);
+    if (NULL != self->words) {
+        memcpy(words, self->words, self->capacity / 8);
+        memcpy(summary, self->summary, self->capacity / FABRIC_FREEIDMAP_GROUP_SIZE * 8);
+        Fabric_memfree_tagged(self->words, self->capacity / 8, FABRIC_MEM_INDEX);
+        Fabric_memfree_tagged(self->summary, self->capacity / FABRIC_FREEIDMAP_GROUP_SIZE * 8, FABRIC_MEM_INDEX);
+    }
+    self->words = words;
+    self->summary = summary;
+    self->capacity = capacity;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that marks a free id as used
+ */
+static inline
+void Fabric_FreeIdMap__clear(FreeIdMap *self, uint32_t id) {
+    uint32_t word = id / 64;
+    self->words[word] &= ~((uint64_t)1 << (id % 64));
+    if (0 == self->words[word]) {
+        self->summary[word / 64] &= ~((uint64_t)1 << (word % 64));
+    }
+    self->count--;
+    self->is_changed = TRUE;
+}
+
+/**
+ * Marks an id as free
+ *
+ * Args:
+ *      self: The map
+ *      id: The id being freed; it must not be 0
+ *
+ * Returns: FABRIC_OK on success or a memory error if the map couldn't grow
+ */
+error_t Fabric_FreeIdMap_add(FreeIdMap *self, uint32_t id) {
+    uint32_t word = id / 64;
+    error_t status;
+
+    if (id >= self->capacity && FABRIC_OK != (status = Fabric_FreeIdMap__grow(self, id))) {
+        return status;
+    }
+    if (self->words[word] & ((uint64_t)1 << (id % 64))) {
+        return FABRIC_OK;
+    }
+    self->words[word] |= (uint64_t)1 << (id % 64);
+    self->summary[word / 64] |= (uint64_t)1 << (word % 64);
+    if (word / 64 < self->lowest) {
+        self->lowest = word / 64;
+    }
+    self->count++;
+    self->is_changed = TRUE;
+    return FABRIC_OK;
+}
+
+/**
+ * Returns TRUE if an id is free
+ */
+bool_t Fabric_FreeIdMap_has(FreeIdMap *self, uint32_t id) {
+    return id < self->capacity && (self->words[id / 64] & ((uint64_t)1 << (id % 64))) != 0;
+}
+
+/**
+ * Marks an id as used if it is free
+ *
+ * Returns: TRUE if the id was free
+ */
+bool_t Fabric_FreeIdMap_remove(FreeIdMap *self, uint32_t id) {
+    if (!Fabric_FreeIdMap_has(self, id)) {
+        return FALSE;
+    }
+    Fabric_FreeIdMap__clear(self, id);
+    return TRUE;
+}
+
+/**
+ * Gets the number of free ids in a map
+ */
+uint32_t Fabric_FreeIdMap_get_count(FreeIdMap *self) {
+    return self->count;
+}
+
+/**
+ * Returns TRUE if the map changed since it was last saved or loaded
+ */
+bool_t Fabric_FreeIdMap_is_changed(FreeIdMap *self) {
+    return self->is_changed;
+}
+
+/**
+ * Takes the lowest free id from a map
+ *
+ * Returns: The id, which is no longer free, or 0 if no id is free
+ */
+uint32_t Fabric_FreeIdMap_take(FreeIdMap *self) {
+    uint32_t group, word, id;
+
+    if (0 == self->count) {
+        return 0;
+    }
+    for (group = self->lowest; 0 == self->summary[group]; group++);
+    self->lowest = group;
+    word = group * 64 + __builtin_ctzll(self->summary[group]);
+    id = word * 64 + __builtin_ctzll(self->words[word]);
+    Fabric_FreeIdMap__clear(self, id);
+    return id;
+}
+
+/**
+ * Takes the lowest run of consecutive free ids from a map
+ *
+ * Unlike Fabric_FreeIdMap_take(1) this looks at each word of the map
+ * from the lowest free id until it finds a long enough run.
+ *
+ * Args:
+ *      self: The map
+ *      count: The number of ids in the run
+ *
+ * Returns: The first id of the run, whose ids are no longer free, or 0
+ *          if no run is long enough
+ */
+uint32_t Fabric_FreeIdMap_take_run(FreeIdMap *self, uint32_t count) {
+    uint32_t num_words = self->capacity / 64;
+    uint32_t start = 0, length = 0, word, bit, id;
+    uint64_t bits;
+
+    if (0 == count || count > self->count) {
+        return 0;
+    }
+    if (1 == count) {
+        return Fabric_FreeIdMap_take(self);
+    }
+
+    for (word = self->lowest * 64; word < num_words && length < count; word++) {
+        bits = self->words[word];
+        if (0 == word % 64 && 0 == self->summary[word / 64]) {
+            // A whole group without a free id ends any run
+            length = 0;
+            word += 63;
+        } else if (0 == bits) {
+            length = 0;
+        } else if (UINT64_MAX == bits) {
+            if (0 == length) {
+                start = word * 64;
+            }
+            length += 64;
+        } else {
+            for (bit = 0; bit < 64 && length < count; bit++) {
+                if (bits & ((uint64_t)1 << bit)) {
+                    if (0 == length) {
+                        start = word * 64 + bit;
+                    }
+                    length++;
+                } else {
+                    length = 0;
+                }
+            }
+        }
+    }
+    if (length < count) {
+        return 0;
+    }
+
+    for (id = start; id < start + count; id++) {
+        Fabric_FreeIdMap__clear(self, id);
+    }
+    return start;
+}
+
+/**
+ * Private function that counts the runs of free ids in a map
+ */
+static
+uint32_t Fabric_FreeIdMap__count_runs(FreeIdMap *self) {
+    uint32_t num_words = self->capacity / 64;
+    uint32_t runs = 0, word;
+    uint64_t carry = 0;
+
+    for (word = self->lowest * 64; word < num_words; word++) {
+        // A run starts at each set bit whose lower neighbour isn't set
+        runs += __builtin_popcountll(self->words[word] & ~((self->words[word] << 1) | carry));
+        carry = self->words[word] >> 63;
+    }
+    return runs;
+}
+
+/**
+ * Private function that stores the runs of free ids in a map, after a
+ * count of them
+ */
+static
+void Fabric_FreeIdMap__get_runs(FreeIdMap *self, uint32_t *values) {
+    uint32_t num_words = self->capacity / 64;
+    uint32_t runs = 0, word, bit;
+    bool_t in_run = FALSE;
+
+    for (word = self->lowest * 64; word < num_words; word++) {
+        if (!in_run && 0 == self->words[word]) {
+            continue;
+        }
+        for (bit = 0; bit < 64; bit++) {
+            if (self->words[word] & ((uint64_t)1 << bit)) {
+                if (!in_run) {
+                    values[1 + 2 * runs] = word * 64 + bit;
+                    values[2 + 2 * runs] = 0;
+                    in_run = TRUE;
+                    runs++;
+                }
+                values[2 * runs]++;
+            } else {
+                in_run = FALSE;
+            }
+        }
+    }
+    values[0] = runs;
+}
+
+/**
+ * Private function that returns the offset of a store's entry in the free
+ * id directory, creating the directory if the graph doesn't have one yet
+ */
+static
+uint32_t Fabric_FreeIdMap__get_entry(Graph *graph, int store, bool_t create, error_t *status) {
+    uint32_t directory = Fabric_Graph_get_free_id_directory_offset(graph);
+    int i;
+
+    *status = FABRIC_OK;
+    if (0 == directory) {
+        if (!create) {
+            return 0;
+        }
+        directory = Fabric_Graph_allocate(graph, FABRIC_FREEIDMAP_DIRECTORY_SIZE, status);
+        if (FABRIC_OK != *status) {
+            return 0;
+        }
+        for (i = 0; i < FABRIC_FREEIDMAP_DIRECTORY_SIZE; i += 4) {
+            Fabric_Graph_update_uint32(graph, 0, directory + i);
+        }
+        Fabric_Graph_set_free_id_directory_offset(graph, directory);
+    }
+    return directory + (store - 1) * FABRIC_FREEIDMAP_DIRECTORY_ENTRY_SIZE;
+}
+
+/**
+ * Saves a store's free id map to the graph file if it has changed
+ *
+ * Args:
+ *      self: The map
+ *      graph: The graph whose store the map belongs to
+ *      store: One of FABRIC_CLASS_STORE through FABRIC_PROPERTY_STORE
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_FreeIdMap_save(FreeIdMap *self, Graph *graph, int store) {
+    uint32_t entry, offset, capacity, num_runs, size;
+    uint32_t *values;
+    error_t status;
+
+    if (!self->is_changed) {
+        return FABRIC_OK;
+    }
+    entry = Fabric_FreeIdMap__get_entry(graph, store, TRUE, &status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    offset = Fabric_Graph_read_uint32(graph, entry);
+    capacity = Fabric_Graph_read_uint32(graph, entry + 4);
+    num_runs = Fabric_FreeIdMap__count_runs(self);
+
+    // Move the section to the end of the file when it runs out of room
+    if (0 == offset || num_runs > capacity) {
+        capacity = num_runs * 2 > FABRIC_FREEIDMAP_MIN_RUNS ? num_runs * 2 : FABRIC_FREEIDMAP_MIN_RUNS;
+        offset = Fabric_Graph_allocate(graph, sizeof(uint32_t) * (1 + 2 * capacity), &status);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
+
+    size = sizeof(uint32_t) * (1 + 2 * num_runs);
+    values = Fabric_memalloc_tagged(size, FABRIC_MEM_IO);
+    if (NULL == values) {
+        return Fabric_memerrno();
+    }
+    Fabric_FreeIdMap__get_runs(self, values);
+    Fabric_ByteSwap_copy32(values, values, 1 + 2 * num_runs, Fabric_Graph_get_byte_order(graph));
+    status = Fabric_Graph_write_bytes(graph, (uint8_t*)values, size, offset);
+    Fabric_memfree_tagged(values, size, FABRIC_MEM_IO);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    Fabric_Graph_update_uint32(graph, offset, entry);
+    Fabric_Graph_update_uint32(graph, capacity, entry + 4);
+    self->is_changed = FALSE;
+    return FABRIC_OK;
+}
+
+/**
+ * Loads a store's free id map from the graph file
+ *
+ * Ids saved in the map that aren't below the store's last free id are
+ * left out.
+ *
+ * Args:
+ *      self: An empty map
+ *      graph: The graph whose store the map belongs to
+ *      store: One of FABRIC_CLASS_STORE through FABRIC_PROPERTY_STORE
+ *      last_id: The store's last free id
+ *
+ * Returns: FABRIC_OK on success, FABRIC_FREEIDMAP_MISSING if the store's
+ *          map was never saved or other error code on failure
+ */
+error_t Fabric_FreeIdMap_load(FreeIdMap *self, Graph *graph, int store, uint32_t last_id) {
+    int byte_order = Fabric_Graph_get_byte_order(graph);
+    uint32_t values[2 * FABRIC_FREEIDMAP_CHUNK];
+    uint32_t entry, offset, num_runs, done, n, i, id, first, length, end;
+    error_t status;
+
+    entry = Fabric_FreeIdMap__get_entry(graph, store, FALSE, &status);
+    if (0 == entry || 0 == (offset = Fabric_Graph_read_uint32(graph, entry))) {
+        return FABRIC_FREEIDMAP_MISSING;
+    }
+    status = Fabric_Graph_read_bytes(graph, (uint8_t*)values, sizeof(uint32_t), offset);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    Fabric_ByteSwap_copy32(values, values, 1, byte_order);
+    num_runs = values[0];
+    offset += sizeof(uint32_t);
+
+    for (done = 0; done < num_runs; done += n) {
+        n = num_runs - done < FABRIC_FREEIDMAP_CHUNK ? num_runs - done : FABRIC_FREEIDMAP_CHUNK;
+        status = Fabric_Graph_read_bytes(graph, (uint8_t*)values, n * 2 * sizeof(uint32_t), offset);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        Fabric_ByteSwap_copy32(values, values, 2 * n, byte_order);
+        offset += n * 2 * sizeof(uint32_t);
+        for (i = 0; i < n; i++) {
+            first = values[2 * i];
+            length = values[2 * i + 1];
+            if (0 == first || first >= last_id) {
+                continue;
+            }
+            end = length < last_id - first ? first + length : last_id;
+            for (id = first; id < end; id++) {
+                if (FABRIC_OK != (status = Fabric_FreeIdMap_add(self, id))) {
+                    return status;
+                }
+            }
+        }
+    }
+    self->is_changed = FALSE;
+    return FABRIC_OK;
+}
+
+/**
+ * Loads a store's free ids from the linked list kept in its free records
+ *
+ * Graphs saved before stores had free id maps kept their free ids as a
+ * list running through a field of each free record, starting at the id
+ * in the store's header.  The list is read once, when the store is
+ * loaded; saving the map replaces it.
+ *
+ * Args:
+ *      self: An empty map
+ *      graph: The graph whose store the map belongs to
+ *      extents: The store's extents
+ *      first_id: The head of the list, from the store's header
+ *      last_id: The store's last free id, which ends the list
+ *      link_offset: The offset of the link within a free record
+ *      link_size: The size of the link, 2 or 4 bytes
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_FreeIdMap_load_list(
+    FreeIdMap *self,
+    Graph *graph,
+    ExtentList *extents,
+    uint32_t first_id,
+    uint32_t last_id,
+    uint32_t link_offset,
+    int link_size) {
+
+    uint32_t id = first_id, offset, steps;
+    error_t status;
+
+    // Each id can only appear once, so a longer list must have a cycle
+    for (steps = 0; id > 0 && id < last_id && id <= extents->capacity && steps < last_id; steps++) {
+        if (FABRIC_OK != (status = Fabric_FreeIdMap_add(self, id))) {
+            return status;
+        }
+        offset = Fabric_ExtentList_get_record_offset(extents, id) + link_offset;
+        id = 2 == link_size ? Fabric_Graph_read_uint16(graph, offset) : Fabric_Graph_read_uint32(graph, offset);
+    }
+    // The list is replaced by the map the next time the store is flushed
+    self->is_changed = self->count > 0;
+    return FABRIC_OK;
+}
+
+#endif
@@ -12,8 +12,22 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include "Fabric.h"
 #include "Memory.c"
+#include "Stats.c"
+#include "ByteSwap.c"
+#include "BufferPool.c"
+#include "FileMapping.c"
+#include "Wal.c"
+#include "ExtentList.c"
+#include "FreeIdMap.c"
+#include "EntityView.c"
+#include "Snapshot.c"
+#include "WriteBatch.c"
+#include "Compression.c"
 #include "ClassStore.c"
 #include "LabelStore.c"
 #include "VertexStore.c"
@@ -25,12 +39,27 @@
 #include "Label.c"
 #include "Vertex.c"
 #include "Edge.c"
+#include "EdgeIterator.c"
+#include "ClassIterator.c"
+#include "AdjacencySnapshot.c"
+#include "Traversal.c"
+#include "LabelPartition.c"
+#include "DegreeCounts.c"
+#include "BulkLoad.c"
 #include "Property.c"
+#include "PropertyIterator.c"
+#include "PropertyDirectory.c"
+#include "BatchRead.c"
 #include "Text.c"
 #include "Index.c"
+#include "PropertyIndex.c"
+#include "PropertyColumn.c"
+#include "Predicate.c"
+#include "Compaction.c"
 #include "DynamicList.c"
 #include "IdSet.c"
 #include "EntityMap.c"
+#include "EntityCache.c"
 
 /**
  * File offset definitions
@@ -53,276 +82,1608 @@
 #define INDEX_STORE_OFFSET_OFFSET 72
 #define INDEX_PAGE_SIZE_OFFSET 76
 #define INDEX_PAGE_COUNT_OFFSET 80
-#define FABRIC_HEADER_SIZE 84
+#define ADJACENCY_SNAPSHOT_OFFSET_OFFSET 84
+#define STORE_DIRECTORY_OFFSET_OFFSET 88
+#define END_OFFSET_OFFSET 92
+#define BYTE_ORDER_OFFSET 96
+#define FREE_ID_DIRECTORY_OFFSET_OFFSET 100
+#define HEADER_CHECKSUM_OFFSET 104
+#define FABRIC_HEADER_SIZE 108
+
+/* The first version whose header ends with a checksum of its other fields */
+#define FABRIC_HEADER_CHECKSUM_VERSION 2
+
+/* The number of bytes read from the start of the file when a graph is opened */
+#define FABRIC_FIRST_PAGE_SIZE (FABRIC_PAGE_SIZE > FABRIC_HEADER_SIZE ? FABRIC_PAGE_SIZE : FABRIC_HEADER_SIZE)
+
+/**
+ * Store directory definitions
+ *
+ * The store directory holds an entry for each store, in store id order.
+ * An entry is the number of extents in the store followed by the offset
+ * and size of each of its FABRIC_MAX_STORE_EXTENTS extents.
+ */
+#define FABRIC_STORE_DIRECTORY_ENTRY_SIZE (4 + 8 * FABRIC_MAX_STORE_EXTENTS)
+#define FABRIC_STORE_DIRECTORY_SIZE (FABRIC_STORE_DIRECTORY_ENTRY_SIZE * FABRIC_INDEX_STORE)
+
+/**
+ * A Graph object is responsible for managing the storage and retrieval
+ * of a graph as a whole.  It is persistent in the sense that it writes
+ * and reads itself from a binary file.
+ *
+ * A graph has several subcompenents which are responsible for managing different
+ * portions of the graph store file.  The graph maintains important pieces
+ * of metadata in the header of its file which it uses to initialize itself.
+ */
+typedef struct Graph {
+    FILE *graph_file;                        // The file in which this graph is stored
+    bool_t is_mapped;                        // Whether the file is memory mapped instead of buffered
+    BufferPool buffer_pool;                  // Cache of the graph file's pages when not mapped
+    FileMapping mapping;                     // Mapping of the graph file when mapped
+    bool_t has_wal;                          // Whether writes are logged to a write-ahead log
+    Wal wal;                                 // The graph's write-ahead log when it has one
+    uint64_t checkpoint_time;                // When a commit last ran an incremental checkpoint, in ms
+    long position;                           // Offset used by reads and writes given an offset of -1
+    uint8_t fabric_header_string[16];       // Used to verify file type by Fabric
+    uint8_t application_header_string[16];  // Optionally used by app to verify file type
+    uint32_t fabric_version_number;         // Version of fabric in use
+    uint32_t application_version_number;    // Optional version of application
+    uint32_t file_change_counter;           // Tracks changes to this file
+    ClassStore class_store;                  // Store for vertex classes
+    LabelStore label_store;                  // Store for labels
+    VertexStore vertex_store;                // Store for vertices
+    EdgeStore edge_store;                    // Store for edges
+    PropertyStore property_store;            // Store for properties
+    TextStore text_store;                    // Store for text
+    IndexStore index_store;                  // Store for indices
+    uint32_t adjacency_snapshot_offset;      // Offset of the saved adjacency snapshot or 0 if none
+    uint32_t store_directory_offset;         // Offset of the store directory or 0 for a fixed layout
+    uint32_t end_offset;                     // Offset of the end of the allocated part of the file
+    uint32_t byte_order;                     // The byte order of the file's bulk arrays, not its records
+    uint32_t free_id_directory_offset;      // Offset of the stores' saved free id maps or 0 if none
+    SnapshotManager *snapshots;              // Versions of the pages read by snapshots or NULL
+    WriteBatch *batch;                       // The open write batch or NULL
+    uint32_t mem_pressure;                   // The memory pressure the caches were last balanced for
+    uint8_t *first_page;                     // The start of the file while the graph is opened, or NULL
+} Graph;
+
+/**
+ * Private function that takes the lock shared with a graph's snapshots
+ *
+ * The buffer pool is shared with the threads reading snapshots, so the
+ * writer holds the lock while it uses the pool.  Nothing is locked when
+ * snapshots aren't enabled.
+ */
+static
+void Fabric_Graph__lock(Graph *self) {
+    if (NULL != self->snapshots) {
+        Fabric_SnapshotManager_lock(self->snapshots);
+    }
+}
+
+/**
+ * Private function that releases the lock taken by Fabric_Graph__lock(1)
+ */
+static
+void Fabric_Graph__unlock(Graph *self) {
+    if (NULL != self->snapshots) {
+        Fabric_SnapshotManager_unlock(self->snapshots);
+    }
+}
+
+/**
+ * Private function that sets a store cache's limit for the memory budget
+ *
+ * While the process is over budget the cache gives up between an eighth
+ * and a quarter of its entities each time the pressure changes; the
+ * lower its hit ratio since it was last balanced, the more it gives up.
+ * A cache still evicting down to its last limit isn't shrunk again.
+ * Once the process is back under budget the cache may fill again.
+ */
+static
+void Fabric_Graph__balance_cache(EntityCache *cache, bool_t is_over_budget) {
+    int count, released;
+    float64_t hit_ratio;
+
+    if (NULL == cache) {
+        return;
+    }
+    hit_ratio = Fabric_EntityCache_get_recent_hit_ratio(cache);
+    if (!is_over_budget) {
+        Fabric_EntityCache_set_limit(cache, Fabric_EntityCache_get_capacity(cache));
+        return;
+    }
+    count = Fabric_EntityCache_get_count(cache);
+    if (count > Fabric_EntityCache_get_limit(cache) || count <= FABRIC_MEM_BUDGET_MIN_CACHE_SIZE) {
+        return;
+    }
+    released = (int)(count * (2 - hit_ratio) / 8);
+    Fabric_EntityCache_set_limit(cache, count - released < FABRIC_MEM_BUDGET_MIN_CACHE_SIZE ?
+        FABRIC_MEM_BUDGET_MIN_CACHE_SIZE : count - released);
+}
+
+/**
+ * Private function that balances a graph's caches against the memory
+ * budget when the memory pressure has changed
+ *
+ * The memory in use is counted for the whole process, not per graph.
+ * Each graph shrinks its caches by the same fraction when the process is
+ * over budget, so graphs give up memory in proportion to how much of it
+ * they cache, and a graph kept busy by one thread never touches the
+ * caches of a graph used by another.  Lowering a limit evicts nothing, so
+ * an entity can only be evicted by its own store adding to its cache, as
+ * it could be without a budget.
+ */
+static inline
+void Fabric_Graph__balance_memory(Graph *self) {
+    uint32_t pressure = Fabric_mempressure();
+    bool_t is_over_budget;
+
+    if (pressure == self->mem_pressure) {
+        return;
+    }
+    self->mem_pressure = pressure;
+    is_over_budget = Fabric_memis_over_budget();
+    Fabric_Graph__balance_cache(self->class_store.cache, is_over_budget);
+    Fabric_Graph__balance_cache(self->label_store.cache, is_over_budget);
+    Fabric_Graph__balance_cache(self->vertex_store.cache, is_over_budget);
+    Fabric_Graph__balance_cache(self->edge_store.cache, is_over_budget);
+    Fabric_Graph__balance_cache(self->property_store.cache, is_over_budget);
+    Fabric_Graph__balance_cache(self->property_store.directories, is_over_budget);
+}
+
+/**
+ * Private function that lets the buffer pool write back the pages whose
+ * writes have all been committed by the graph's write-ahead log
+ *
+ * The buffer pool must be locked.
+ */
+static
+void Fabric_Graph__update_commit_lsn(Graph *self) {
+    if (self->has_wal) {
+        Fabric_BufferPool_set_commit_lsn(&self->buffer_pool, Fabric_Wal_get_commit_lsn(&self->wal));
+    }
+}
+
+/**
+ * Private function that applies a write to the buffer pool or mapping
+ *
+ * It is also used to replay writes from the write-ahead log, so nothing
+ * is logged.
+ */
+static
+error_t Fabric_Graph__apply_write(void *target, uint8_t *bytes, uint32_t num_bytes, uint32_t offset) {
+    Graph *self = target;
+    error_t status = FABRIC_OK;
+    if (self->is_mapped) {
+        return Fabric_FileMapping_write(&self->mapping, bytes, num_bytes, offset);
+    }
+
+    // Snapshots keep the pages as they were before the write
+    Fabric_Graph__lock(self);
+    if (NULL != self->snapshots) {
+        status = Fabric_SnapshotManager_capture(self->snapshots, offset, num_bytes);
+    }
+    if (FABRIC_OK == status) {
+        Fabric_Graph__update_commit_lsn(self);
+        status = Fabric_BufferPool_write(&self->buffer_pool, bytes, num_bytes, offset);
+    }
+    Fabric_Graph__unlock(self);
+    return status;
+}
+
+/**
+ * Writes data to the graphs file
+ *
+ * The data is written to the graph's buffer pool.  It reaches the
+ * file when its pages are evicted or when the graph is flushed.  With a
+ * write-ahead log, that waits until the write has been committed.
+ * A mapped graph writes straight into its mapping instead, growing
+ * the file if the data lies past its end.
+ *
+ * Args:
+ *      self: The graph object whose header is being written
+ *      bytes: An array of bytes that are to be written whose size is specified in num_bytes
+ *      num_bytes: The number of bytes to write to the file
+ *      offset: The position in the file to write to or -1 to write from current position in file
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Graph_write_bytes (Graph *self, uint8_t *bytes, int num_bytes, long offset) {
+    error_t status;
+
+    Fabric_stats_add(FABRIC_STAT_WRITE_BYTES_CALLS, 1);
+    Fabric_stats_add(FABRIC_STAT_BYTES_WRITTEN, num_bytes);
+    // Set position to appropriate offset
+    if (offset != -1) {
+        if (offset != self->position) {
+            Fabric_stats_add(FABRIC_STAT_SEEKS, 1);
+        }
+        self->position = offset;
+    }
+
+#if FABRIC_DEBUG
+    printf("Writing %d bytes at %ld\n", num_bytes, self->position);
+#endif
+    // An open batch keeps the pages as they were before the write
+    if (NULL != self->batch) {
+        offset = self->position;
+        status = Fabric_WriteBatch_capture(self->batch, offset, num_bytes);
+        self->position = offset;
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
+    // The redo record must be logged before the write is applied
+    if (self->has_wal) {
+        Fabric_BufferPool_set_lsn(&self->buffer_pool, Fabric_Wal_get_lsn(&self->wal));
+        status = Fabric_Wal_append(&self->wal, bytes, num_bytes, self->position);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
+    status = Fabric_Graph__apply_write(self, bytes, num_bytes, self->position);
+    self->position += num_bytes;
+    return status;
+}
+
+/**
+ * Writes a uint32 value to the database
+ *
+ * Args:
+ *      self: The graph being written to
+ *      value: The value to write
+ *      offset: The location in the file to write the value
+ */
+void Fabric_Graph_write_uint32 (Graph *self, uint32_t value, long offset) {
+    uint32_t network_order_value = htobe32(value);
+    uint8_t *bytes = (uint8_t*) &network_order_value;
+#if FABRIC_DEBUG
+    printf("Writing uint32 %u with network value %u\n", value, network_order_value);
+#endif
+    Fabric_Graph_write_bytes(self, bytes, sizeof(value), offset);
+}
+
+/**
+ * Writes a uint16 value to the database
+ *
+ * Args:
+ *      self: The graph being written to
+ *      value: The value to write
+ *      offset: The location in the file to write the value
+ */
+void Fabric_Graph_write_uint16 (Graph *self, uint16_t value, long offset) {
+    uint16_t network_order_value = htobe16(value);
+    uint8_t *bytes = (uint8_t*) &network_order_value;
+#if FABRIC_DEBUG
+    printf("Writing uint16 %u with network value %u\n", value, network_order_value);
+#endif
+    Fabric_Graph_write_bytes(self, bytes, sizeof(value), offset);
+}
+
+/**
+ * Writes a uint32 value to the graph's file only if it differs from
+ * the value already there
+ *
+ * Store headers use this so that flushing an unchanged store does not
+ * dirty the header's page.
+ *
+ * Args:
+ *      self: The graph
+ *      value: The value to write
+ *      offset: The location in the file to write the value
+ */
+void Fabric_Graph_update_uint32 (Graph *self, uint32_t value, long offset) {
+    if (Fabric_Graph_read_uint32(self, offset) != value) {
+        Fabric_Graph_write_uint32(self, value, offset);
+    }
+}
+
+/**
+ * Writes a uint16 value to the graph's file only if it differs from
+ * the value already there
+ *
+ * Args:
+ *      self: The graph
+ *      value: The value to write
+ *      offset: The location in the file to write the value
+ */
+void Fabric_Graph_update_uint16 (Graph *self, uint16_t value, long offset) {
+    if (Fabric_Graph_read_uint16(self, offset) != value) {
+        Fabric_Graph_write_uint16(self, value, offset);
+    }
+}
+
+/**
+ * Private comparison function for sorting record ids
+ */
+static
+int Fabric_Graph__compare_ids(const void *a, const void *b) {
+    uint32_t id_a = *(const uint32_t*)a;
+    uint32_t id_b = *(const uint32_t*)b;
+    return (id_a > id_b) - (id_a < id_b);
+}
+
+/**
+ * Writes a set of fixed size records to the graph's file
+ *
+ * The ids are sorted so that the records are written in file order,
+ * and records with consecutive ids are serialized into one buffer and
+ * written with a single write.  A run is split when it is larger than
+ * FABRIC_FLUSH_RUN_SIZE or when it reaches the end of an extent.  This is the shared flush path for all
+ * of the stores that hold fixed size records.
+ *
+ * Args:
+ *      self: The graph
+ *      ids: The ids of the records to write; sorted in place
+ *      num_ids: The number of ids
+ *      extents: The extents of the store holding the records; every id
+ *               must be within its capacity
+ *      serialize: Function that writes a record's bytes
+ *      store: The store passed to serialize
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Graph_write_records (
+    Graph *self,
+    uint32_t *ids,
+    int num_ids,
+    ExtentList *extents,
+    Fabric_RecordSerializer serialize,
+    void *store) {
+
+    uint32_t record_size = extents->record_size;
+    uint32_t max_run = FABRIC_FLUSH_RUN_SIZE / record_size;
+    uint32_t run_length, contiguous;
+    uint32_t num_records;
+    uint8_t *buffer;
+    error_t status = FABRIC_OK;
+    uint32_t i = 0;
+
+    if (num_ids < 1) {
+        return FABRIC_OK;
+    }
+    num_records = num_ids;
+    if (max_run < 1) {
+        max_run = 1;
+    }
+    if (max_run > num_records) {
+        max_run = num_records;
+    }
+
+    buffer = Fabric_memalloc(max_run * record_size);
+    if (NULL == buffer) {
+        return Fabric_memerrno();
+    }
+
+    qsort(ids, num_records, sizeof(uint32_t), Fabric_Graph__compare_ids);
+
+    while (i < num_records && FABRIC_OK == status) {
+        // Serialize the run of consecutive ids starting at ids[i]
+        run_length = 0;
+        contiguous = Fabric_ExtentList_get_contiguous(extents, ids[i]);
+        do {
+            serialize(store, ids[i + run_length], buffer + run_length * record_size);
+            run_length++;
+        } while (i + run_length < num_records &&
+                 run_length < max_run &&
+                 run_length < contiguous &&
+                 ids[i + run_length] == ids[i] + run_length);
+
+        status = Fabric_Graph_write_bytes(
+            self,
+            buffer,
+            run_length * record_size,
+            Fabric_ExtentList_get_record_offset(extents, ids[i]));
+        i += run_length;
+    }
+
+    Fabric_memfree(buffer, max_run * record_size);
+    return status;
+}
+
+/**
+ * Private comparison function for sorting batch keys, which hold a record
+ * id in their high 32 bits and a position in the batch in their low 32 bits
+ */
+static
+int Fabric_Graph__compare_keys(const void *a, const void *b) {
+    uint64_t key_a = *(const uint64_t*)a;
+    uint64_t key_b = *(const uint64_t*)b;
+    return (key_a > key_b) - (key_a < key_b);
+}
+
+/**
+ * Private function that finds the run of consecutive ids in one extent
+ * starting at keys[i]; repeats of an id are part of its run
+ *
+ * Returns: The index of the first key after the run
+ */
+static
+uint32_t Fabric_Graph__find_run(uint64_t *keys, uint32_t i, uint32_t num_keys,
+        ExtentList *extents, uint32_t max_run, uint32_t *run_length) {
+    uint32_t first_id = (uint32_t)(keys[i] >> 32);
+    uint32_t contiguous = Fabric_ExtentList_get_contiguous(extents, first_id);
+    uint32_t id;
+
+    *run_length = 1;
+    for (i++; i < num_keys; i++) {
+        id = (uint32_t)(keys[i] >> 32);
+        if (id == first_id + *run_length &&
+                *run_length < max_run && *run_length < contiguous) {
+            (*run_length)++;
+        } else if (id != first_id + *run_length - 1) {
+            break;
+        }
+    }
+    return i;
+}
+
+/**
+ * Reads a batch of fixed size records from the graph's file
+ *
+ * The ids are sorted so the records are read in file order, and an id
+ * that appears more than once is read once.  The pages of every record
+ * are prefetched before the first record is read, so on a buffered graph
+ * the reads of the pages that aren't resident are in flight together.
+ * Each run of consecutive ids in one extent is then read with a single
+ * read, up to FABRIC_READ_RUN_SIZE bytes at a time.
+ *
+ * Args:
+ *      self: The graph object being read from
+ *      ids: The ids of the records; they may be in any order and repeat
+ *      num_ids: The number of ids
+ *      extents: The extents of the store holding the records; every id
+ *               must be within its capacity
+ *      destination: Where the records are copied; the record of ids[i]
+ *                   is copied to destination + i * the record size
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Graph_read_records (
+    Graph *self,
+    const uint32_t *ids,
+    uint32_t num_ids,
+    ExtentList *extents,
+    uint8_t *destination) {
+
+    uint32_t record_size = extents->record_size;
+    uint32_t max_run = FABRIC_READ_RUN_SIZE / record_size;
+    uint32_t first_id, run_length, offset, i, j, k;
+    uint32_t prefetch_start = 0, prefetch_end = 0;
+    uint64_t *keys;
+    uint8_t *buffer;
+    size_t scratch_size;
+    error_t status = FABRIC_OK;
+
+    if (num_ids < 1) {
+        return FABRIC_OK;
+    }
+    if (max_run < 1) {
+        max_run = 1;
+    }
+
+    scratch_size = num_ids * sizeof(uint64_t) + max_run * record_size;
+    keys = Fabric_memalloc(scratch_size);
+    if (NULL == keys) {
+        return Fabric_memerrno();
+    }
+    buffer = (uint8_t*)(keys + num_ids);
+
+    for (i = 0; i < num_ids; i++) {
+        keys[i] = ((uint64_t)ids[i] << 32) | i;
+    }
+    qsort(keys, num_ids, sizeof(uint64_t), Fabric_Graph__compare_keys);
+
+    // Runs less than a page apart are prefetched together
+    for (i = 0; i < num_ids; i = j) {
+        j = Fabric_Graph__find_run(keys, i, num_ids, extents, max_run, &run_length);
+        offset = Fabric_ExtentList_get_record_offset(extents, (uint32_t)(keys[i] >> 32));
+        if (prefetch_end != 0 && offset > prefetch_end + FABRIC_PAGE_SIZE) {
+            Fabric_Graph_prefetch(self, prefetch_start, prefetch_end - prefetch_start);
+            prefetch_end = 0;
+        }
+        if (prefetch_end == 0) {
+            prefetch_start = offset;
+        }
+        prefetch_end = offset + run_length * record_size;
+    }
+    Fabric_Graph_prefetch(self, prefetch_start, prefetch_end - prefetch_start);
+
+    for (i = 0; i < num_ids && FABRIC_OK == status; i = j) {
+        j = Fabric_Graph__find_run(keys, i, num_ids, extents, max_run, &run_length);
+        first_id = (uint32_t)(keys[i] >> 32);
+        status = Fabric_Graph_read_bytes(self, buffer, run_length * record_size,
+            Fabric_ExtentList_get_record_offset(extents, first_id));
+        for (k = i; k < j; k++) {
+            memcpy(destination + (uint32_t)keys[k] * record_size,
+                buffer + ((uint32_t)(keys[k] >> 32) - first_id) * record_size, record_size);
+        }
+    }
+
+    Fabric_memfree(keys, scratch_size);
+    return status;
+}
+
+/**
+ * Reads bytes from the graph file into a buffer
+ *
+ * The bytes are copied out of the graph's buffer pool, which loads
+ * the pages they are on from the file if they are not resident.
+ * On failure the destination is zeroed.  Since the stores read on a
+ * cache miss, this is also where the graph balances its caches against
+ * the memory budget.
+ *
+ * Args:
+ *      self: The graph object being read from
+ *      destination: The location to store the read data
+ *      num_bytes: The number of bytes to read
+ *      offset: The offset to read from or -1 to read from current offset
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Graph_read_bytes (Graph *self, uint8_t *destination, int num_bytes, long offset) {
+    error_t status;
+
+    Fabric_Graph__balance_memory(self);
+    Fabric_stats_add(FABRIC_STAT_READ_BYTES_CALLS, 1);
+    Fabric_stats_add(FABRIC_STAT_BYTES_READ, num_bytes);
+    // Set position to appropriate offset
+    if (offset != -1) {
+        if (offset != self->position) {
+            Fabric_stats_add(FABRIC_STAT_SEEKS, 1);
+        }
+        self->position = offset;
+    }
+#if FABRIC_DEBUG
+    printf("Reading %d bytes at %ld\n", num_bytes, self->position);
+#endif
+    if (self->is_mapped) {
+        Fabric_FileMapping_read(&self->mapping, destination, num_bytes, self->position);
+        self->position += num_bytes;
+        return FABRIC_OK;
+    }
+    Fabric_Graph__lock(self);
+    status = Fabric_BufferPool_read(&self->buffer_pool, destination, num_bytes, self->position);
+    Fabric_Graph__unlock(self);
+    if (FABRIC_OK != status) {
+        memset(destination, 0, num_bytes);
+    }
+    self->position += num_bytes;
+    return status;
+}
+
+
+/**
+ * Pins bytes of the graph file in memory so they can be read in place
+ *
+ * A buffered graph pins the page holding the bytes in its buffer pool.
+ * A mapped graph points into its mapping; the pointer is only valid until
+ * the next write that grows the file.  Bytes that span two pages or run
+ * past the end of the mapping can't be pinned, in which case NULL is
+ * returned with a status of FABRIC_OK and the bytes must be copied out
+ * with Fabric_Graph_read_bytes(4) instead.
+ *
+ * Args:
+ *      self: The graph being read from
+ *      num_bytes: The number of bytes to pin
+ *      offset: The file offset of the bytes
+ *      page_no: Where the number of the pinned page is stored
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: A pointer to the pinned bytes or NULL if they weren't pinned
+ */
+uint8_t *Fabric_Graph_pin_bytes(Graph *self, uint32_t num_bytes, uint32_t offset, uint32_t *page_no, error_t *status) {
+    uint32_t page_size = self->buffer_pool.page_size;
+    uint8_t *page;
+
+    *status = FABRIC_OK;
+    if (self->is_mapped) {
+        if ((size_t)offset + num_bytes > self->mapping.size) {
+            return NULL;
+        }
+        return self->mapping.data + offset;
+    }
+    if (offset / page_size != (offset + num_bytes - 1) / page_size) {
+        return NULL;
+    }
+
+    *page_no = offset / page_size;
+    Fabric_Graph__lock(self);
+    page = Fabric_BufferPool_pin(&self->buffer_pool, *page_no, status);
+    Fabric_Graph__unlock(self);
+    if (NULL == page) {
+        return NULL;
+    }
+    return page + offset % page_size;
+}
+
+/**
+ * Unpins bytes pinned with Fabric_Graph_pin_bytes(5)
+ *
+ * Args:
+ *      self: The graph the bytes were pinned from
+ *      page_no: The page number returned by Fabric_Graph_pin_bytes(5)
+ */
+void Fabric_Graph_unpin_bytes(Graph *self, uint32_t page_no) {
+    if (!self->is_mapped) {
+        Fabric_Graph__lock(self);
+        Fabric_BufferPool_unpin(&self->buffer_pool, page_no, FALSE);
+        Fabric_Graph__unlock(self);
+    }
+}
+
+/**
+ * Reads and returns a 32 bit unsigned integer value from the database file
+ *
+ * Args:
+ *      self: The graph being read from
+ *      offset: The position to read from or -1 for current position
+ *
+ * Returns: The value as an integer in host endianness
+ */
+uint32_t Fabric_Graph_read_uint32 (Graph *self, long offset) {
+    uint8_t bytes[sizeof(uint32_t)];
+    uint32_t result;
+    if (offset == -1) {
+        offset = self->position;
+    }
+    // A mapped value can be decoded in place
+    if (self->is_mapped && offset + sizeof(uint32_t) <= self->mapping.size) {
+        self->position = offset + sizeof(uint32_t);
+        return betoh32(*((uint32_t*)(self->mapping.data + offset)));
+    }
+    Fabric_Graph_read_bytes(self, bytes, sizeof(uint32_t), offset);
+    result = betoh32 (*((uint32_t*) bytes));
+#if DEBUG
+    printf("uint32 read is %u with network %u\n", result, (uint32_t) *bytes);
+#endif
+    return result;
+}
+
+/**
+ * Reads and returns a 32 bit unsigned integer value from the database file
+ *
+ * Args:
+ *      self: The graph being read from
+ *      offset: The position to read from or -1 for current position
+ *
+ * Returns: The value as an integer in host endianness
+ */
+uint16_t Fabric_Graph_read_uint16 (Graph *self, long offset) {
+    uint8_t bytes[sizeof(uint16_t)];
+    uint16_t result;
+    if (offset == -1) {
+        offset = self->position;
+    }
+    // A mapped value can be decoded in place
+    if (self->is_mapped && offset + sizeof(uint16_t) <= self->mapping.size) {
+        self->position = offset + sizeof(uint16_t);
+        return betoh16(*((uint16_t*)(self->mapping.data + offset)));
+    }
+    Fabric_Graph_read_bytes(self, bytes, sizeof(uint16_t), offset);
+    result = betoh16 (*((uint16_t*) bytes));
+#if DEBUG
+    printf("uint16 read is %u with network %u\n", result, (uint16_t) *bytes);
+#endif
+    return result;
+}
+
+/**
+ * Private function that stores a 32 bit value in a buffer in network order
+ */
+static inline
+void Fabric_Graph__put_uint32(uint8_t *bytes, uint32_t value) {
+    value = htobe32(value);
+    memcpy(bytes, &value, sizeof(uint32_t));
+}
+
+/**
+ * Private function that loads a 32 bit value stored in network order
+ */
+static inline
+uint32_t Fabric_Graph__get_uint32(const uint8_t *bytes) {
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(uint32_t));
+    return betoh32(value);
+}
+
+/**
+ * Private function that encodes a graph's header as it is stored in its file
+ *
+ * Returns: The size of the encoded header, which only ends with a
+ *          checksum from FABRIC_HEADER_CHECKSUM_VERSION on
+ */
+static
+int Fabric_Graph__encode_header(Graph *self, uint8_t *bytes) {
+    memcpy(bytes + FABRIC_HEADER_STRING_OFFSET, self->fabric_header_string, 16);
+    memcpy(bytes + APPLICATION_HEADER_STRING_OFFSET, self->application_header_string, 16);
+    Fabric_Graph__put_uint32(bytes + FABRIC_VERSION_NUMBER_OFFSET, self->fabric_version_number);
+    Fabric_Graph__put_uint32(bytes + APPLICATION_VERSION_NUMBER_OFFSET, self->application_version_number);
+    Fabric_Graph__put_uint32(bytes + FILE_CHANGE_COUNTER_OFFSET, self->file_change_counter);
+    Fabric_Graph__put_uint32(bytes + CLASS_STORE_OFFSET_OFFSET, self->class_store.offset);
+    Fabric_Graph__put_uint32(bytes + LABEL_STORE_OFFSET_OFFSET, self->label_store.offset);
+    Fabric_Graph__put_uint32(bytes + VERTEX_STORE_OFFSET_OFFSET, self->vertex_store.offset);
+    Fabric_Graph__put_uint32(bytes + EDGE_STORE_OFFSET_OFFSET, self->edge_store.offset);
+    Fabric_Graph__put_uint32(bytes + PROPERTY_STORE_OFFSET_OFFSET, self->property_store.offset);
+    Fabric_Graph__put_uint32(bytes + TEXT_STORE_OFFSET_OFFSET, self->text_store.offset);
+    Fabric_Graph__put_uint32(bytes + TEXT_BLOCK_SIZE_OFFSET, self->text_store.block_size);
+    Fabric_Graph__put_uint32(bytes + INDEX_STORE_OFFSET_OFFSET, self->index_store.offset);
+    Fabric_Graph__put_uint32(bytes + INDEX_PAGE_SIZE_OFFSET, self->index_store.page_size);
+    Fabric_Graph__put_uint32(bytes + INDEX_PAGE_COUNT_OFFSET, self->index_store.page_count);
+    Fabric_Graph__put_uint32(bytes + ADJACENCY_SNAPSHOT_OFFSET_OFFSET, self->adjacency_snapshot_offset);
+    Fabric_Graph__put_uint32(bytes + STORE_DIRECTORY_OFFSET_OFFSET, self->store_directory_offset);
+    Fabric_Graph__put_uint32(bytes + END_OFFSET_OFFSET, self->end_offset);
+    Fabric_Graph__put_uint32(bytes + BYTE_ORDER_OFFSET, self->byte_order);
+    Fabric_Graph__put_uint32(bytes + FREE_ID_DIRECTORY_OFFSET_OFFSET, self->free_id_directory_offset);
+
+    if (self->fabric_version_number < FABRIC_HEADER_CHECKSUM_VERSION) {
+        return HEADER_CHECKSUM_OFFSET;
+    }
+    Fabric_Graph__put_uint32(bytes + HEADER_CHECKSUM_OFFSET, hash(bytes, HEADER_CHECKSUM_OFFSET));
+    return FABRIC_HEADER_SIZE;
+}
+
+/**
+ * Private function that decodes a graph's header from the bytes at the
+ * start of its file
+ *
+ * Returns: FALSE if the header has a checksum that doesn't match it
+ */
+static
+bool_t Fabric_Graph__decode_header(Graph *self, uint8_t *bytes) {
+    memcpy(self->fabric_header_string, bytes + FABRIC_HEADER_STRING_OFFSET, 16);
+    memcpy(self->application_header_string, bytes + APPLICATION_HEADER_STRING_OFFSET, 16);
+    self->fabric_version_number = Fabric_Graph__get_uint32(bytes + FABRIC_VERSION_NUMBER_OFFSET);
+    self->application_version_number = Fabric_Graph__get_uint32(bytes + APPLICATION_VERSION_NUMBER_OFFSET);
+    self->file_change_counter = Fabric_Graph__get_uint32(bytes + FILE_CHANGE_COUNTER_OFFSET);
+    self->class_store.offset = Fabric_Graph__get_uint32(bytes + CLASS_STORE_OFFSET_OFFSET);
+    self->label_store.offset = Fabric_Graph__get_uint32(bytes + LABEL_STORE_OFFSET_OFFSET);
+    self->vertex_store.offset = Fabric_Graph__get_uint32(bytes + VERTEX_STORE_OFFSET_OFFSET);
+    self->edge_store.offset = Fabric_Graph__get_uint32(bytes + EDGE_STORE_OFFSET_OFFSET);
+    self->property_store.offset = Fabric_Graph__get_uint32(bytes + PROPERTY_STORE_OFFSET_OFFSET);
+    self->text_store.offset = Fabric_Graph__get_uint32(bytes + TEXT_STORE_OFFSET_OFFSET);
+    self->text_store.block_size = Fabric_Graph__get_uint32(bytes + TEXT_BLOCK_SIZE_OFFSET);
+    self->index_store.offset = Fabric_Graph__get_uint32(bytes + INDEX_STORE_OFFSET_OFFSET);
+    self->index_store.page_size = Fabric_Graph__get_uint32(bytes + INDEX_PAGE_SIZE_OFFSET);
+    self->index_store.page_count = Fabric_Graph__get_uint32(bytes + INDEX_PAGE_COUNT_OFFSET);
+    self->adjacency_snapshot_offset = Fabric_Graph__get_uint32(bytes + ADJACENCY_SNAPSHOT_OFFSET_OFFSET);
+    self->store_directory_offset = Fabric_Graph__get_uint32(bytes + STORE_DIRECTORY_OFFSET_OFFSET);
+    self->end_offset = Fabric_Graph__get_uint32(bytes + END_OFFSET_OFFSET);
+    self->byte_order = Fabric_Graph__get_uint32(bytes + BYTE_ORDER_OFFSET);
+    self->free_id_directory_offset = Fabric_Graph__get_uint32(bytes + FREE_ID_DIRECTORY_OFFSET_OFFSET);
+
+    // Older graphs have no checksum; their store directory follows the fields
+    if (self->fabric_version_number < FABRIC_HEADER_CHECKSUM_VERSION) {
+        return TRUE;
+    }
+    return hash(bytes, HEADER_CHECKSUM_OFFSET) == Fabric_Graph__get_uint32(bytes + HEADER_CHECKSUM_OFFSET);
+}
+
+/**
+ * Private function that updates one of the fields of a graph's header
+ *
+ * The header's checksum is rewritten with it, so the graph's copy of the
+ * field must already hold the new value.
+ */
+static
+void Fabric_Graph__update_header(Graph *self, uint32_t value, long offset) {
+    uint8_t bytes[FABRIC_HEADER_SIZE];
+    Fabric_Graph_update_uint32(self, value, offset);
+    if (FABRIC_HEADER_SIZE == Fabric_Graph__encode_header(self, bytes)) {
+        Fabric_Graph_update_uint32(self, Fabric_Graph__get_uint32(bytes + HEADER_CHECKSUM_OFFSET), HEADER_CHECKSUM_OFFSET);
+    }
+}
+
+/**
+ * Writes all of a graphs header values to its file
+ *
+ * Primarily used for initialization of a new graph file.  The header is
+ * written with a single write.
+ *
+ * Args:
+ *      self: A fully instantiated Graph object whose values will be written
+ *
+ * Returns: 0 on success, less than 0 on failure
+ */
+int Fabric_Graph_write_header (Graph *self) {
+    uint8_t bytes[FABRIC_HEADER_SIZE];
+    int size = Fabric_Graph__encode_header(self, bytes);
+    if (FABRIC_OK != Fabric_Graph_write_bytes(self, bytes, size, 0)) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Reads a store's header
+ *
+ * While a graph is being opened, a header that lies in the first page of
+ * the file is copied from the bytes read with the graph's header instead
+ * of being read again.
+ *
+ * Args:
+ *      self: The graph being read from
+ *      destination: The location to store the header
+ *      num_bytes: The size of the header
+ *      offset: The file offset of the header
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Graph_read_store_header(Graph *self, uint8_t *destination, int num_bytes, long offset) {
+    if (NULL != self->first_page && offset + num_bytes <= FABRIC_FIRST_PAGE_SIZE) {
+        memcpy(destination, self->first_page + offset, num_bytes);
+        return FABRIC_OK;
+    }
+    return Fabric_Graph_read_bytes(self, destination, num_bytes, offset);
+}
+
+/**
+ * Private function that returns the extent list of a store
+ */
+static
+ExtentList *Fabric_Graph__get_extents(Graph *self, int store) {
+    switch (store) {
+        case FABRIC_CLASS_STORE:
+            return &self->class_store.extents;
+        case FABRIC_LABEL_STORE:
+            return &self->label_store.extents;
+        case FABRIC_VERTEX_STORE:
+            return &self->vertex_store.extents;
+        case FABRIC_EDGE_STORE:
+            return &self->edge_store.extents;
+        case FABRIC_PROPERTY_STORE:
+            return &self->property_store.extents;
+        case FABRIC_TEXT_STORE:
+            return &self->text_store.extents;
+        case FABRIC_INDEX_STORE:
+            return &self->index_store.extents;
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * Private function that empties the extent list of every store
+ */
+static
+void Fabric_Graph__init_extents(Graph *self) {
+    Fabric_ExtentList_init(&self->class_store.extents, FABRIC_CLASSSTORE_HEADER_SIZE, FABRIC_CLASS_STORAGE_SIZE);
+    Fabric_ExtentList_init(&self->label_store.extents, FABRIC_LABELSTORE_HEADER_SIZE, FABRIC_LABEL_STORAGE_SIZE);
+    Fabric_ExtentList_init(&self->vertex_store.extents, FABRIC_VERTEXSTORE_HEADER_SIZE, FABRIC_VERTEX_STORAGE_SIZE);
+    Fabric_ExtentList_init(&self->edge_store.extents, FABRIC_EDGESTORE_HEADER_SIZE, FABRIC_EDGE_STORAGE_SIZE);
+    Fabric_ExtentList_init(&self->property_store.extents, FABRIC_PROPERTYSTORE_HEADER_SIZE, FABRIC_PROPERTY_STORAGE_SIZE);
+    Fabric_ExtentList_init(&self->text_store.extents, FABRIC_TEXTSTORE_HEADER_SIZE, self->text_store.block_size);
+    Fabric_ExtentList_init(&self->index_store.extents, 0, self->index_store.page_size);
+}
+
+/**
+ * Private function that gives every store the single extent that runs
+ * from its offset to the next store's offset
+ *
+ * This is the layout of graphs without a store directory.
+ */
+static
+void Fabric_Graph__derive_extents(Graph *self, uint32_t index_store_size) {
+    Fabric_ExtentList_add(&self->class_store.extents,
+        self->class_store.offset, self->label_store.offset - self->class_store.offset);
+    Fabric_ExtentList_add(&self->label_store.extents,
+        self->label_store.offset, self->vertex_store.offset - self->label_store.offset);
+    Fabric_ExtentList_add(&self->vertex_store.extents,
+        self->vertex_store.offset, self->edge_store.offset - self->vertex_store.offset);
+    Fabric_ExtentList_add(&self->edge_store.extents,
+        self->edge_store.offset, self->property_store.offset - self->edge_store.offset);
+    Fabric_ExtentList_add(&self->property_store.extents,
+        self->property_store.offset, self->text_store.offset - self->property_store.offset);
+    Fabric_ExtentList_add(&self->text_store.extents,
+        self->text_store.offset, self->index_store.offset - self->text_store.offset);
+    Fabric_ExtentList_add(&self->index_store.extents, self->index_store.offset, index_store_size);
+}
+
+/**
+ * Private function that writes a store's entry in the store directory
+ */
+static
+void Fabric_Graph__write_directory_entry(Graph *self, int store) {
+    ExtentList *extents = Fabric_Graph__get_extents(self, store);
+    uint32_t offset = self->store_directory_offset + (store - 1) * FABRIC_STORE_DIRECTORY_ENTRY_SIZE;
+    int i;
+
+    Fabric_Graph_update_uint32(self, extents->num_extents, offset);
+    for (i = 0; i < extents->num_extents; i++) {
+        Fabric_Graph_update_uint32(self, extents->extents[i].offset, offset + 4 + 8 * i);
+        Fabric_Graph_update_uint32(self, extents->extents[i].size, offset + 8 + 8 * i);
+    }
+}
+
+/**
+ * Private function that reads the extents of every store
+ *
+ * Graphs without a store directory get one extent per store.
+ */
+static
+void Fabric_Graph__load_extents(Graph *self) {
+    ExtentList *extents;
+    uint8_t entry[FABRIC_STORE_DIRECTORY_ENTRY_SIZE];
+    uint32_t num_extents, i;
+    int store;
+
+    Fabric_Graph__init_extents(self);
+
+    if (0 == self->store_directory_offset) {
+        Fabric_Graph__derive_extents(self, self->index_store.page_size * self->index_store.page_count);
+        if (0 == self->end_offset) {
+            self->end_offset = self->index_store.offset + self->index_store.page_size * self->index_store.page_count;
+            // A saved snapshot section follows the index store
+            if (self->adjacency_snapshot_offset >= self->end_offset) {
+                self->end_offset = self->adjacency_snapshot_offset + Fabric_AdjacencySnapshot_get_saved_size(self);
+            }
+        }
+        return;
+    }
+
+    // Each entry is read whole, from the first page when it lies there
+    for (store = FABRIC_CLASS_STORE; store <= FABRIC_INDEX_STORE; store++) {
+        extents = Fabric_Graph__get_extents(self, store);
+        Fabric_Graph_read_store_header(self, entry, FABRIC_STORE_DIRECTORY_ENTRY_SIZE,
+            self->store_directory_offset + (store - 1) * FABRIC_STORE_DIRECTORY_ENTRY_SIZE);
+        num_extents = Fabric_Graph__get_uint32(entry);
+        for (i = 0; i < num_extents && i < FABRIC_MAX_STORE_EXTENTS; i++) {
+            Fabric_ExtentList_add(
+                extents,
+                Fabric_Graph__get_uint32(entry + 4 + 8 * i),
+                Fabric_Graph__get_uint32(entry + 8 + 8 * i));
+        }
+    }
+}
+
+/**
+ * Lays out the stores of a new graph and writes its store directory
+ *
+ * The directory is placed right after the header and each store gets
+ * one MIN_PAGE_SIZE extent.  The stores' offsets must already be set.
+ *
+ * Args:
+ *      self: A graph being created
+ */
+void Fabric_Graph_create_directory(Graph *self) {
+    int store;
+
+    Fabric_Graph__init_extents(self);
+    Fabric_Graph__derive_extents(self, MIN_PAGE_SIZE);
+    self->store_directory_offset = FABRIC_HEADER_SIZE;
+    self->end_offset = self->index_store.offset + MIN_PAGE_SIZE;
+    for (store = FABRIC_CLASS_STORE; store <= FABRIC_INDEX_STORE; store++) {
+        Fabric_Graph__write_directory_entry(self, store);
+    }
+}
+
+/**
+ * Allocates a region at the end of the graph file
+ *
+ * Args:
+ *      self: The graph
+ *      size: The size of the region in bytes
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The file offset of the region, or 0 on failure
+ */
+uint32_t Fabric_Graph_allocate(Graph *self, uint32_t size, error_t *status) {
+    uint32_t offset = self->end_offset;
+    if ((uint64_t)offset + size > UINT32_MAX) {
+        *status = FABRIC_EXTENT_LIMIT;
+        return 0;
+    }
+    self->end_offset += size;
+    Fabric_Graph__update_header(self, self->end_offset, END_OFFSET_OFFSET);
+    *status = FABRIC_OK;
+    return offset;
+}
+
+/**
+ * Grows a store until it can hold a number of records
+ *
+ * New extents are allocated at the end of the file and added to the
+ * store directory.  A graph without a store directory is given one at
+ * the end of the file.
+ *
+ * Args:
+ *      self: The graph
+ *      store: One of the FABRIC_*_STORE identifiers
+ *      min_capacity: The number of records the store must be able to hold
+ *
+ * Returns: FABRIC_OK on success, FABRIC_EXTENT_LIMIT if the store can't
+ *          grow any more or other error code on failure
+ */
+error_t Fabric_Graph_grow_store(Graph *self, int store, uint32_t min_capacity) {
+    ExtentList *extents = Fabric_Graph__get_extents(self, store);
+    uint32_t offset, size, directory_offset;
+    error_t status = FABRIC_OK;
+    int i;
+
+    if (NULL == extents) {
+        return FABRIC_GRAPH_ERROR;
+    }
+    if (extents->capacity >= min_capacity) {
+        return FABRIC_OK;
+    }
+
+    if (0 == self->store_directory_offset) {
+        directory_offset = Fabric_Graph_allocate(self, FABRIC_STORE_DIRECTORY_SIZE, &status);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        self->store_directory_offset = directory_offset;
+        for (i = FABRIC_CLASS_STORE; i <= FABRIC_INDEX_STORE; i++) {
+            Fabric_Graph__write_directory_entry(self, i);
+        }
+        Fabric_Graph__update_header(self, self->store_directory_offset, STORE_DIRECTORY_OFFSET_OFFSET);
+    }
+
+    while (extents->capacity < min_capacity && FABRIC_OK == status) {
+        if (extents->num_extents >= FABRIC_MAX_STORE_EXTENTS) {
+            status = FABRIC_EXTENT_LIMIT;
+            break;
+        }
+        size = Fabric_ExtentList_get_next_size(extents);
+        // Even a byte addressed store grows by whole records
+        if (size < extents->record_size) {
+            size = extents->record_size;
+        }
+        offset = Fabric_Graph_allocate(self, size, &status);
+        if (FABRIC_OK == status) {
+            // Snapshots copy the extents while holding the lock
+            Fabric_Graph__lock(self);
+            status = Fabric_ExtentList_add(extents, offset, size);
+            Fabric_Graph__unlock(self);
+        }
+    }
+
+    Fabric_Graph__write_directory_entry(self, store);
+    return status;
+}
+
+/**
+ * Returns the extent list of a store
+ *
+ * Args:
+ *      self: The graph
+ *      store: One of the FABRIC_*_STORE identifiers
+ *
+ * Returns: The store's extents or NULL for an unknown store
+ */
+ExtentList *Fabric_Graph_get_store_extents(Graph *self, int store) {
+    return Fabric_Graph__get_extents(self, store);
+}
+
+/**
+ * Private function that reads a graph's header and initializes its stores
+ *
+ * The first page of the file is read with a single read, and the header,
+ * the store directory and the store headers that lie in it are decoded
+ * from that copy.  The graph's file and I/O mode must already be set up.
+ *
+ * Returns: 0 on success, less than 0 if the header's checksum is wrong
+ */
+static
+int Fabric_Graph__load(Graph *self) {
+    uint8_t first_page[FABRIC_FIRST_PAGE_SIZE];
+
+    if (FABRIC_OK != Fabric_Graph_read_bytes(self, first_page, FABRIC_FIRST_PAGE_SIZE, 0)) {
+        return -1;
+    }
+    if (!Fabric_Graph__decode_header(self, first_page)) {
+        return -1;
+    }
+    self->position = FABRIC_HEADER_SIZE;
+    self->first_page = first_page;
+
+    // Find the extents of each of the stores
+    Fabric_Graph__load_extents(self);
+
+    // Initialize each of the stores
+    Fabric_ClassStore_init(&self->class_store);
+    Fabric_LabelStore_init(&self->label_store);
+    Fabric_VertexStore_init(&self->vertex_store);
+    Fabric_EdgeStore_init(&self->edge_store);
+    Fabric_PropertyStore_init(&self->property_store);
+    Fabric_TextStore_init(&self->text_store);
+    Fabric_IndexStore_init(&self->index_store);
+
+    // The copy lives on the stack, and later writes would make it stale
+    self->first_page = NULL;
+    return 0;
+}
+
+/**
+ * Initializes a Graph object from a file
+ *
+ * Args:
+ *      self: An uninitialized graph object to be initialized
+ *      graph_file: The file to read the graph from
+ *
+ * Returns: 0 on success; less than 0 on error
+ */
+int Fabric_Graph_init(Graph *self, FILE *graph_file) {
+    // Set the file for the graph
+    self->graph_file = graph_file;
+    self->is_mapped = FALSE;
+    self->has_wal = FALSE;
+    self->snapshots = NULL;
+    self->batch = NULL;
+    self->mem_pressure = Fabric_mempressure();
+    self->first_page = NULL;
+    if (FABRIC_OK != Fabric_BufferPool_init(&self->buffer_pool, graph_file, FABRIC_PAGE_SIZE, FABRIC_BUFFER_POOL_SIZE)) {
+        return -1;
+    }
+    if (0 != Fabric_Graph__load(self)) {
+        Fabric_BufferPool_deinit(&self->buffer_pool);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Initializes a Graph object from a file and a write-ahead log
+ *
+ * The committed writes in the log are replayed into the graph file and
+ * forced to disk before the graph is loaded, after which the log is
+ * emptied.  From then on every write to the graph is logged.
+ *
+ * Args:
+ *      self: An uninitialized graph object to be initialized
+ *      graph_file: The file to read the graph from
+ *      wal_file: The graph's log file, opened for reading and writing
+ *
+ * Returns: 0 on success; less than 0 on error
+ */
+int Fabric_Graph_init_logged(Graph *self, FILE *graph_file, FILE *wal_file) {
+    self->graph_file = graph_file;
+    self->is_mapped = FALSE;
+    self->has_wal = FALSE;
+    self->snapshots = NULL;
+    self->batch = NULL;
+    self->mem_pressure = Fabric_mempressure();
+    self->first_page = NULL;
+    if (FABRIC_OK != Fabric_BufferPool_init(&self->buffer_pool, graph_file, FABRIC_PAGE_SIZE, FABRIC_BUFFER_POOL_SIZE)) {
+        return -1;
+    }
+    if (FABRIC_OK != Fabric_Wal_init(&self->wal, wal_file)) {
+        Fabric_BufferPool_deinit(&self->buffer_pool);
+        return -1;
+    }
+    self->has_wal = TRUE;
+    self->checkpoint_time = 0;
+
+    if (FABRIC_OK != Fabric_Wal_recover(&self->wal, Fabric_Graph__apply_write, self) ||
+        FABRIC_OK != Fabric_Graph_checkpoint(self) ||
+        0 != Fabric_Graph__load(self)) {
+        Fabric_Wal_deinit(&self->wal);
+        Fabric_BufferPool_deinit(&self->buffer_pool);
+        self->has_wal = FALSE;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Initializes a Graph object from a file that is mapped into memory
+ *
+ * The file is read and written through the mapping instead of the
+ * buffer pool.  The label store is advised to expect random access.
+ *
+ * Args:
+ *      self: An uninitialized graph object to be initialized
+ *      graph_file: The file to read the graph from, opened for reading and writing
+ *
+ * Returns: 0 on success; less than 0 on error
+ */
+int Fabric_Graph_init_mapped(Graph *self, FILE *graph_file) {
+    int result;
+    self->graph_file = graph_file;
+    self->is_mapped = TRUE;
+    self->has_wal = FALSE;
+    self->snapshots = NULL;
+    self->batch = NULL;
+    self->mem_pressure = Fabric_mempressure();
+    self->first_page = NULL;
+    if (FABRIC_OK != Fabric_FileMapping_init(&self->mapping, graph_file)) {
+        return -1;
+    }
+    result = Fabric_Graph__load(self);
+    if (result == 0) {
+        Fabric_Graph_advise_store(self, FABRIC_LABEL_STORE, FABRIC_ADVISE_RANDOM);
+    } else {
+        Fabric_FileMapping_deinit(&self->mapping);
+    }
+    return result;
+}
+
+/**
+ * Writes all of the graph's buffered changes to its file
+ *
+ * A graph with a write-ahead log keeps the pages holding writes that
+ * haven't been committed in its buffer pool.
+ *
+ * Args:
+ *      self: The graph being flushed
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Graph_flush(Graph *self) {
+    uint64_t started = Fabric_stats_now();
+    error_t status;
+    if (self->is_mapped) {
+        status = Fabric_FileMapping_sync(&self->mapping);
+    } else {
+        Fabric_Graph__lock(self);
+        Fabric_Graph__update_commit_lsn(self);
+        status = Fabric_BufferPool_flush(&self->buffer_pool);
+        Fabric_Graph__unlock(self);
+    }
+    Fabric_stats_add(FABRIC_STAT_GRAPH_FLUSHES, 1);
+    Fabric_stats_add_elapsed(FABRIC_STAT_GRAPH_FLUSH_NANOS, started);
+    return status;
+}
+
+/**
+ * Private function that gets a monotonic time in milliseconds
+ */
+static
+uint64_t Fabric_Graph__now_ms() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000u + (uint64_t)now.tv_nsec / 1000000u;
+}
 
 /**
- * A Graph object is responsible for managing the storage and retrieval
- * of a graph as a whole.  It is persistent in the sense that it writes
- * and reads itself from a binary file.
+ * Makes the writes to a graph since the last commit durable
  *
- * A graph has several subcompenents which are responsible for managing different
- * portions of the graph store file.  The graph maintains important pieces
- * of metadata in the header of its file which it uses to initialize itself.
+ * A graph with a write-ahead log commits by forcing the log to disk.
+ * At most every FABRIC_CHECKPOINT_INTERVAL milliseconds a commit then
+ * writes up to FABRIC_CHECKPOINT_PAGES dirty pages with an incremental
+ * checkpoint, so that pages reach the graph file steadily rather than
+ * all at once.  A full checkpoint is still run once the log grows past
+ * FABRIC_WAL_CHECKPOINT_SIZE.  A graph without a log is flushed and its
+ * file is forced to disk.  Changes held by the stores must be flushed to
+ * the graph before they can be committed.
+ *
+ * Args:
+ *      self: The graph being committed
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
  */
-typedef struct Graph {
-    FILE *graph_file;                        // The file in which this graph is stored
-    uint8_t fabric_header_string[16];       // Used to verify file type by Fabric
-    uint8_t application_header_string[16];  // Optionally used by app to verify file type
-    uint32_t fabric_version_number;         // Version of fabric in use
-    uint32_t application_version_number;    // Optional version of application
-    uint32_t file_change_counter;           // Tracks changes to this file
-    ClassStore class_store;                  // Store for vertex classes
-    LabelStore label_store;                  // Store for labels
-    VertexStore vertex_store;                // Store for vertices
-    EdgeStore edge_store;                    // Store for edges
-    PropertyStore property_store;            // Store for properties
-    TextStore text_store;                    // Store for text
-    IndexStore index_store;                  // Store for indices
-} Graph;
+error_t Fabric_Graph_commit(Graph *self) {
+    error_t status;
+    uint64_t now;
+    if (!self->has_wal) {
+        return Fabric_Graph_checkpoint(self);
+    }
+    status = Fabric_Wal_commit(&self->wal);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    if (Fabric_Wal_get_size(&self->wal) > FABRIC_WAL_CHECKPOINT_SIZE) {
+        return Fabric_Graph_checkpoint(self);
+    }
+    now = Fabric_Graph__now_ms();
+    if (now - self->checkpoint_time >= FABRIC_CHECKPOINT_INTERVAL) {
+        self->checkpoint_time = now;
+        status = Fabric_Graph_checkpoint_step(self, FABRIC_CHECKPOINT_PAGES);
+    }
+    return status;
+}
 
 /**
- * Writes data to the graphs file
+ * Runs an incremental checkpoint of a graph
+ *
+ * Up to max_pages dirty pages are written back in file order, continuing
+ * from where the last incremental checkpoint stopped.  For a graph with a
+ * write-ahead log, the graph file is then forced to disk and the oldest
+ * log record a dirty page still depends on is recorded in the log, so
+ * that recovery starts there.  Once no page is dirty the log is emptied.
+ * A mapped graph has no dirty pages of its own, so nothing is done.
  *
  * Args:
- *      self: The graph object whose header is being written
- *      bytes: An array of bytes that are to be written whose size is specified in num_bytes
- *      num_bytes: The number of bytes to write to the file
- *      offset: The position in the file to write to or -1 to write from current position in file
+ *      self: The graph being checkpointed
+ *      max_pages: The most dirty pages to write
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
  */
-void Fabric_Graph_write_bytes (Graph *self, uint8_t *bytes, int num_bytes, long offset) {
-    FILE *file = self->graph_file;
-    int i;
+error_t Fabric_Graph_checkpoint_step(Graph *self, int max_pages) {
+    error_t status;
+    uint64_t redo_lsn;
+    int num_written;
 
-    // Set position to appropriate offset
-    if (offset != -1) {
-        fseek(file, offset, SEEK_SET);
+    if (self->is_mapped) {
+        return FABRIC_OK;
     }
+    Fabric_Graph__lock(self);
+    Fabric_Graph__update_commit_lsn(self);
+    status = Fabric_BufferPool_flush_some(&self->buffer_pool, max_pages, &num_written);
+    if (FABRIC_OK == status && self->has_wal &&
+        (num_written > 0 || Fabric_Wal_get_size(&self->wal) > 0)) {
+        // Pages evicted since the last sync are forced to disk too
+        if (fsync(fileno(self->graph_file)) != 0) {
+            status = FABRIC_GRAPH_ERROR;
+        } else {
+            redo_lsn = Fabric_BufferPool_get_oldest_lsn(&self->buffer_pool);
+            status = Fabric_Wal_checkpoint(&self->wal, redo_lsn);
+        }
+    }
+    Fabric_Graph__unlock(self);
+    return status;
+}
 
-#if FABRIC_DEBUG
-    printf("Writing %d bytes at %lu\n", num_bytes, ftell(file));
-#endif
-    // Write the data
-    for (i = 0; i < num_bytes; i++) {
-        fputc(bytes[i], file);
-#if FABRIC_DEBUG
-        fprintf(stdout, "%d ", bytes[i]);
-#endif
+/**
+ * Forces every write to a graph onto its file on disk
+ *
+ * The graph is flushed and its file is synced.  The graph's write-ahead
+ * log is then no longer needed and is emptied, unless pages holding
+ * writes that haven't been committed are still dirty; their records
+ * stay in the log.
+ *
+ * Args:
+ *      self: The graph being checkpointed
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Graph_checkpoint(Graph *self) {
+    error_t status = Fabric_Graph_flush(self);
+    if (FABRIC_OK != status) {
+        return status;
     }
-#if DEBUG
-    fputc('\n', stdout);
-#endif
+    if (fsync(fileno(self->graph_file)) != 0) {
+        return FABRIC_GRAPH_ERROR;
+    }
+    if (self->has_wal) {
+        Fabric_Graph__lock(self);
+        status = Fabric_Wal_checkpoint(&self->wal, Fabric_BufferPool_get_oldest_lsn(&self->buffer_pool));
+        Fabric_Graph__unlock(self);
+    }
+    return status;
 }
 
 /**
- * Writes a uint32 value to the database
+ * Flushes a graph and releases the memory it holds
+ *
+ * A graph with a write-ahead log commits its writes and is checkpointed
+ * instead, so its log is empty once it is closed.  Neither file is
+ * closed.
  *
  * Args:
- *      self: The graph being written to
- *      value: The value to write
- *      offset: The location in the file to write the value
+ *      self: The graph being deinitialized
+ *
+ * Returns: FABRIC_OK on success, other error code if the flush failed
  */
-void Fabric_Graph_write_uint32 (Graph *self, uint32_t value, long offset) {
-    uint32_t network_order_value = htobe32(value);
-    uint8_t *bytes = (uint8_t*) &network_order_value;
-#if FABRIC_DEBUG
-    printf("Writing uint32 %u with network value %u\n", value, network_order_value);
-#endif
-    Fabric_Graph_write_bytes(self, bytes, sizeof(value), offset);
+error_t Fabric_Graph_deinit(Graph *self) {
+    error_t status;
+    if (self->has_wal) {
+        status = Fabric_Wal_commit(&self->wal);
+        if (FABRIC_OK == status) {
+            status = Fabric_Graph_checkpoint(self);
+        }
+        Fabric_Wal_deinit(&self->wal);
+        self->has_wal = FALSE;
+    } else {
+        status = Fabric_Graph_flush(self);
+    }
+    Fabric_ClassStore_deinit(&self->class_store);
+    Fabric_LabelStore_deinit(&self->label_store);
+    Fabric_VertexStore_deinit(&self->vertex_store);
+    Fabric_EdgeStore_deinit(&self->edge_store);
+    Fabric_PropertyStore_deinit(&self->property_store);
+    Fabric_IndexStore_deinit(&self->index_store);
+    if (NULL != self->snapshots) {
+        Fabric_SnapshotManager_destroy(self->snapshots);
+        self->snapshots = NULL;
+    }
+    if (self->is_mapped) {
+        Fabric_FileMapping_deinit(&self->mapping);
+    } else {
+        Fabric_BufferPool_deinit(&self->buffer_pool);
+    }
+    return status;
 }
 
 /**
- * Writes a uint16 value to the database
+ * Discards the changes held by a graph's stores and loads them again
+ * from the graph
+ *
+ * The stores' caches and everything else they keep in memory are freed
+ * without being flushed, and the graph's header and stores are then
+ * read as they are in the buffer pool or mapping.
  *
  * Args:
- *      self: The graph being written to
- *      value: The value to write
- *      offset: The location in the file to write the value
+ *      self: The graph being reloaded
+ *
+ * Returns: FABRIC_OK on success, FABRIC_GRAPH_ERROR if the header can't be read
  */
-void Fabric_Graph_write_uint16 (Graph *self, uint16_t value, long offset) {
-    uint16_t network_order_value = htobe32(value);
-    uint8_t *bytes = (uint8_t*) &network_order_value;
-#if FABRIC_DEBUG
-    printf("Writing uint16 %u with network value %u\n", value, network_order_value);
-#endif
-    Fabric_Graph_write_bytes(self, bytes, sizeof(value), offset);
+error_t Fabric_Graph_reload(Graph *self) {
+    Fabric_ClassStore_deinit(&self->class_store);
+    Fabric_LabelStore_deinit(&self->label_store);
+    Fabric_VertexStore_deinit(&self->vertex_store);
+    Fabric_EdgeStore_deinit(&self->edge_store);
+    Fabric_PropertyStore_deinit(&self->property_store);
+    Fabric_IndexStore_deinit(&self->index_store);
+    if (0 != Fabric_Graph__load(self)) {
+        return FABRIC_GRAPH_ERROR;
+    }
+    return FABRIC_OK;
 }
 
 /**
- * Reads bytes from the graph file into a buffer
+ * Gives back the memory a graph's caches hold beyond what the memory
+ * budget allows
+ *
+ * The caches are balanced against the budget and then evict down to
+ * their limits straight away instead of as they are next added to, which
+ * suits a graph that isn't being used.  Entities obtained from the
+ * stores that haven't been changed since they were last flushed must not
+ * be used afterwards.
  *
  * Args:
- *      self: The graph object being read from
- *      destination: The location to store the read data
- *      num_bytes: The number of bytes to read
- *      offset: The offset to read from or -1 to read from current offset
+ *      self: The graph
  */
-void Fabric_Graph_read_bytes (Graph *self, uint8_t *destination, int num_bytes, long offset) {
-    int i;
-    // Set position to appropriate offset
-    if (offset != -1) {
-        fseek(self->graph_file, offset, SEEK_SET);
+void Fabric_Graph_reclaim_memory(Graph *self) {
+    Fabric_Graph__balance_memory(self);
+    if (NULL != self->class_store.cache) {
+        Fabric_EntityCache_trim(self->class_store.cache);
     }
-#if FABRIC_DEBUG
-    printf("Reading %d bytes at %lu\n", num_bytes, ftell(self->graph_file));
-#endif
-    for (i = 0; i < num_bytes; i++) {
-        destination[i] = (uint8_t)fgetc(self->graph_file);
-#if FABRIC_DEBUG
-        fprintf(stdout, "%d ", (int)destination[i]);
-#endif
+    if (NULL != self->label_store.cache) {
+        Fabric_EntityCache_trim(self->label_store.cache);
+    }
+    if (NULL != self->vertex_store.cache) {
+        Fabric_EntityCache_trim(self->vertex_store.cache);
+    }
+    if (NULL != self->edge_store.cache) {
+        Fabric_EntityCache_trim(self->edge_store.cache);
+    }
+    if (NULL != self->property_store.cache) {
+        Fabric_EntityCache_trim(self->property_store.cache);
+    }
+    if (NULL != self->property_store.directories) {
+        Fabric_EntityCache_trim(self->property_store.directories);
     }
-#if FABRIC_DEBUG
-    fputc('\n', stdout);
-#endif
 }
 
-
 /**
- * Reads and returns a 32 bit unsigned integer value from the database file
+ * Advises the operating system on how a store's region of a mapped
+ * graph will be accessed
+ *
+ * For example, FABRIC_ADVISE_SEQUENTIAL suits bulk scans of the vertex
+ * store while FABRIC_ADVISE_RANDOM suits the label store.  Graphs that
+ * are not mapped ignore the advice.
  *
  * Args:
- *      self: The graph being read from
- *      offset: The position to read from or -1 for current position
+ *      self: The graph
+ *      store: One of the FABRIC_*_STORE identifiers
+ *      advice: One of the FABRIC_ADVISE_* values
  *
- * Returns: The value as an integer in host endianness
+ * Returns: FABRIC_OK on success, other error code on failure
  */
-uint32_t Fabric_Graph_read_uint32 (Graph *self, long offset) {
-    uint8_t bytes[sizeof(uint32_t)];
-    uint32_t result;
-    Fabric_Graph_read_bytes(self, bytes, sizeof(uint32_t), offset);
-    result = betoh32 (*((uint32_t*) bytes));
-#if DEBUG
-    printf("uint32 read is %u with network %u\n", result, (uint32_t) *bytes);
-#endif
-    return result;
+error_t Fabric_Graph_advise_store(Graph *self, int store, int advice) {
+    ExtentList *extents = Fabric_Graph__get_extents(self, store);
+    error_t status = FABRIC_OK;
+    int i;
+
+    if (NULL == extents) {
+        return FABRIC_GRAPH_ERROR;
+    }
+    if (!self->is_mapped) {
+        return FABRIC_OK;
+    }
+
+    for (i = 0; i < extents->num_extents && FABRIC_OK == status; i++) {
+        status = Fabric_FileMapping_advise(&self->mapping, extents->extents[i].offset, extents->extents[i].size, advice);
+    }
+    return status;
 }
 
+
 /**
- * Reads and returns a 32 bit unsigned integer value from the database file
+ * Loads a region of the graph file ahead of its use
+ *
+ * A buffered graph loads the region's pages into its buffer pool.  A
+ * mapped graph advises the operating system that the region will be
+ * needed soon.
  *
  * Args:
- *      self: The graph being read from
- *      offset: The position to read from or -1 for current position
+ *      self: The graph
+ *      offset: The file offset of the start of the region
+ *      length: The length of the region in bytes
  *
- * Returns: The value as an integer in host endianness
+ * Returns: FABRIC_OK on success, other error code on failure
  */
-uint16_t Fabric_Graph_read_uint16 (Graph *self, long offset) {
-    uint8_t bytes[sizeof(uint16_t)];
-    uint16_t result;
-    Fabric_Graph_read_bytes(self, bytes, sizeof(uint16_t), offset);
-    result = betoh16 (*((uint16_t*) bytes));
-#if DEBUG
-    printf("uint16 read is %u with network %u\n", result, (uint16_t) *bytes);
-#endif
-    return result;
+error_t Fabric_Graph_prefetch(Graph *self, long offset, size_t length) {
+    error_t status;
+    if (self->is_mapped) {
+        return Fabric_FileMapping_advise(&self->mapping, offset, length, FABRIC_ADVISE_WILLNEED);
+    }
+    Fabric_Graph__lock(self);
+    status = Fabric_BufferPool_prefetch(&self->buffer_pool, offset, length);
+    Fabric_Graph__unlock(self);
+    return status;
 }
 
 /**
- * Writes all of a graphs header values to its file
+ * Lets other threads read a graph through snapshots while it is written
  *
- * Primarily used for initialization of a new graph file
+ * The thread that enabled snapshots becomes the graph's only writer;
+ * other threads may only use Fabric_Snapshot_* functions.  A snapshot
+ * sees the graph as of the writer's last Fabric_Graph_publish(1).
+ * Mapped graphs can't be read through snapshots.
  *
  * Args:
- *      self: A fully instantiated Graph object whose values will be written
+ *      self: The graph
  *
- * Returns: 0 on success, less than 0 on failure
+ * Returns: FABRIC_OK on success, FABRIC_SNAPSHOT_ERROR for a mapped graph
+ *          or other error code on failure
  */
-int Fabric_Graph_write_header (Graph *self) {
-    FILE *file = self->graph_file;
-    int i;
-
-    fseek (file, 0L, SEEK_SET);   // ensure file pointer at beginning of file
-
-    // Write the file header string
-    Fabric_Graph_write_bytes(self, self->fabric_header_string, 16, 0);
-    // Write the application header string
-    Fabric_Graph_write_bytes(self, self->application_header_string, 16, -1);
-    // Write the version number
-    Fabric_Graph_write_uint32 (self, self->fabric_version_number, -1);
-    // Write application version number;
-    Fabric_Graph_write_uint32 (self, self->application_version_number, -1);
-    // Write file change counter
-    Fabric_Graph_write_uint32 (self, self->file_change_counter, -1);
-    // Write class store offset
-    Fabric_Graph_write_uint32 (self, self->class_store.offset, -1);
-    // Write label store offset
-    Fabric_Graph_write_uint32 (self, self->label_store.offset, -1);
-    // Write the vertex store offset
-    Fabric_Graph_write_uint32 (self, self->vertex_store.offset, -1);
-    // Write the edge store offest
-    Fabric_Graph_write_uint32 (self, self->edge_store.offset, -1);
-    // Write the property store
-    Fabric_Graph_write_uint32 (self, self->property_store.offset, -1);
-    // Write the text store offset
-    Fabric_Graph_write_uint32 (self, self->text_store.offset, -1);
-    // Write the text block size
-    Fabric_Graph_write_uint32 (self, self->text_store.block_size, -1);
-    // Write the index store offset
-    Fabric_Graph_write_uint32 (self, self->index_store.offset, -1);
-    // Write the index page size
-    Fabric_Graph_write_uint32 (self, self->index_store.page_size, -1);
-    // Write the index page count
-    Fabric_Graph_write_uint32 (self, self->index_store.page_count, -1);
-
-    return 0;
+error_t Fabric_Graph_enable_snapshots(Graph *self) {
+    error_t status = FABRIC_OK;
+    if (self->is_mapped) {
+        return FABRIC_SNAPSHOT_ERROR;
+    }
+    if (NULL == self->snapshots) {
+        self->snapshots = Fabric_SnapshotManager_new(&self->buffer_pool, &status);
+    }
+    return status;
 }
 
 /**
- * Initializes a Graph object from a file
+ * Flushes the changes held by a graph's class, label, vertex, edge and
+ * property stores to the graph
  *
  * Args:
- *      self: An uninitialized graph object to be initialized
- *      graph_file: The file to read the graph from
+ *      self: The graph
  *
- * Returns: 0 on success; less than 0 on error
+ * Returns: FABRIC_OK on success, other error code on failure
  */
-int Fabric_Graph_init(Graph *self, FILE *graph_file) {
-    // Set the file for the graph
-    self->graph_file = graph_file;
-    // Read the fabric header string
-    Fabric_Graph_read_bytes(self, self->fabric_header_string, 16, 0);
-    // Read the application header string
-    Fabric_Graph_read_bytes(self, self->application_header_string, 16, -1);
-    // Read the fabric version number
-    self->fabric_version_number = Fabric_Graph_read_uint32(self, -1);
-    // Read the application version number
-    self->application_version_number = Fabric_Graph_read_uint32(self, -1);
-    // Read the file change counter
-    self->file_change_counter = Fabric_Graph_read_uint32(self, -1);
-    // Read the class store offset
-    self->class_store.offset = Fabric_Graph_read_uint32(self, -1);
-    // Read the label store offset
-    self->label_store.offset = Fabric_Graph_read_uint32(self, -1);
-    // Read the vertex store ofset
-    self->vertex_store.offset = Fabric_Graph_read_uint32(self, -1);
-    // Read the edge store offset
-    self->edge_store.offset = Fabric_Graph_read_uint32(self, -1);
-    // Read the property store offset
-    self->property_store.offset = Fabric_Graph_read_uint32(self, -1);
-    // Read the text store offset
-    self->text_store.offset = Fabric_Graph_read_uint32(self, -1);
-    // Read the text store block size
-    self->text_store.block_size = Fabric_Graph_read_uint32(self, -1);
-    // Read the index store offset
-    self->index_store.offset = Fabric_Graph_read_uint32(self, -1);
-    // Read the index page size
-    self->index_store.page_size = Fabric_Graph_read_uint32(self, -1);
-    // Read the index page count
-    self->index_store.page_count = Fabric_Graph_read_uint32(self, -1);
+error_t Fabric_Graph_flush_stores(Graph *self) {
+    error_t status = Fabric_ClassStore_flush(&self->class_store);
+    if (FABRIC_OK == status) {
+        status = Fabric_LabelStore_flush(&self->label_store);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_VertexStore_flush(&self->vertex_store);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_EdgeStore_flush(&self->edge_store);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_PropertyStore_flush(&self->property_store);
+    }
+    return status;
+}
 
-    // Initialize each of the stores
-    Fabric_ClassStore_init(&self->class_store);
-    Fabric_LabelStore_init(&self->label_store);
-    Fabric_VertexStore_init(&self->vertex_store);
-    Fabric_EdgeStore_init(&self->edge_store);
-    Fabric_PropertyStore_init(&self->property_store);
-    Fabric_TextStore_init(&self->text_store);
-    Fabric_IndexStore_init(&self->index_store);
+/**
+ * Makes the writer's changes to a graph visible to new snapshots
+ *
+ * The changes held by the class, label, vertex, edge and property stores
+ * are flushed to the graph first.  Snapshots that are already active keep
+ * reading the graph as it was when they began.
+ *
+ * Args:
+ *      self: A graph with snapshots enabled
+ *
+ * Returns: FABRIC_OK on success, FABRIC_SNAPSHOT_ERROR if snapshots
+ *          aren't enabled or other error code on failure
+ */
+error_t Fabric_Graph_publish(Graph *self) {
+    error_t status;
+    if (NULL == self->snapshots) {
+        return FABRIC_SNAPSHOT_ERROR;
+    }
 
-    return 0;
+    status = Fabric_Graph_flush_stores(self);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    Fabric_SnapshotManager_publish(self->snapshots);
+    return FABRIC_OK;
 }
 
-
 /**
  * Returns the Graph object a Class Store belongs to
  *
@@ -347,7 +1708,7 @@ Graph* Fabric_ClassStore_get_graph(ClassStore *self) {
  */
 Graph* Fabric_LabelStore_get_graph(LabelStore *self) {
     size_t self_int = (size_t) self;
-    size_t offset = offsetof(Graph, class_store);
+    size_t offset = offsetof(Graph, label_store);
     return (Graph*) (self_int - offset);
 }
 
@@ -589,4 +1950,182 @@ IndexStore *Fabric_Graph_get_index_store(Graph *self) {
     return &self->index_store;
 }
 
+/**
+ * Gets the file offset of a graph's saved adjacency snapshot
+ *
+ * Returns: The offset of the snapshot section or 0 if there is none
+ */
+uint32_t Fabric_Graph_get_adjacency_snapshot_offset(Graph *self) {
+    return self->adjacency_snapshot_offset;
+}
+
+/**
+ * Gets the file offset of a graph's free id directory
+ *
+ * Returns: The offset of the directory or 0 if no free id map was saved
+ */
+uint32_t Fabric_Graph_get_free_id_directory_offset(Graph *self) {
+    return self->free_id_directory_offset;
+}
+
+/**
+ * Gets the byte order of the arrays in a graph's file
+ *
+ * Records, page headers and the file header are always big endian, and
+ * are decoded field by field.  Only the arrays of saved adjacency
+ * snapshots, property column pages and free id runs are stored in the
+ * order the graph was created with.
+ *
+ * Returns: FABRIC_BYTE_ORDER_BIG_ENDIAN or FABRIC_BYTE_ORDER_LITTLE_ENDIAN
+ */
+int Fabric_Graph_get_byte_order(Graph *self) {
+    return self->byte_order;
+}
+
+/**
+ * Private function that copies the counts of a store's cache
+ */
+static
+void Fabric_Graph__get_cache_stats(EntityCache *cache, GraphStoreStats *stats) {
+    if (NULL != cache) {
+        stats->cache_hits = Fabric_EntityCache_get_hits(cache);
+        stats->cache_misses = Fabric_EntityCache_get_misses(cache);
+        stats->cache_evictions = Fabric_EntityCache_get_evictions(cache);
+    }
+}
+
+/**
+ * Gets a graph's statistics
+ *
+ * The cache and buffer pool counts are the graph's own.  The other
+ * counters are kept for the whole process, as described in Stats.c, and
+ * can be reset with Fabric_stats_reset().  The memory is all of the
+ * memory the library is using.
+ *
+ * Args:
+ *      self: The graph
+ *      stats: Where the statistics are stored
+ */
+void Fabric_Graph_get_stats(Graph *self, GraphStats *stats) {
+    uint64_t values[FABRIC_STAT_NUM_COUNTERS];
+    GraphStoreStats *store;
+    int i;
+
+    memset(stats, 0, sizeof(GraphStats));
+    Fabric_stats_read(values);
+    for (i = 0; i < FABRIC_STATS_NUM_STORES; i++) {
+        store = &stats->stores[i];
+        store->records_read = values[FABRIC_STAT_RECORDS_READ + i];
+        store->records_written = values[FABRIC_STAT_RECORDS_WRITTEN + i];
+        store->flushes = values[FABRIC_STAT_FLUSHES + i];
+        store->flush_nanos = values[FABRIC_STAT_FLUSH_NANOS + i];
+    }
+    Fabric_Graph__get_cache_stats(self->class_store.cache, &stats->stores[FABRIC_STATS_CLASS_STORE]);
+    Fabric_Graph__get_cache_stats(self->label_store.cache, &stats->stores[FABRIC_STATS_LABEL_STORE]);
+    Fabric_Graph__get_cache_stats(self->vertex_store.cache, &stats->stores[FABRIC_STATS_VERTEX_STORE]);
+    Fabric_Graph__get_cache_stats(self->edge_store.cache, &stats->stores[FABRIC_STATS_EDGE_STORE]);
+    Fabric_Graph__get_cache_stats(self->property_store.cache, &stats->stores[FABRIC_STATS_PROPERTY_STORE]);
+
+    stats->read_bytes_calls = values[FABRIC_STAT_READ_BYTES_CALLS];
+    stats->write_bytes_calls = values[FABRIC_STAT_WRITE_BYTES_CALLS];
+    stats->bytes_read = values[FABRIC_STAT_BYTES_READ];
+    stats->bytes_written = values[FABRIC_STAT_BYTES_WRITTEN];
+    stats->seeks = values[FABRIC_STAT_SEEKS];
+    if (!self->is_mapped) {
+        Fabric_Graph__lock(self);
+        stats->page_hits = Fabric_BufferPool_get_hits(&self->buffer_pool);
+        stats->page_misses = Fabric_BufferPool_get_misses(&self->buffer_pool);
+        stats->file_bytes_read = Fabric_BufferPool_get_bytes_read(&self->buffer_pool);
+        stats->file_bytes_written = Fabric_BufferPool_get_bytes_written(&self->buffer_pool);
+        Fabric_Graph__unlock(self);
+    }
+    stats->graph_flushes = values[FABRIC_STAT_GRAPH_FLUSHES];
+    stats->graph_flush_nanos = values[FABRIC_STAT_GRAPH_FLUSH_NANOS];
+    stats->idset_lookups = values[FABRIC_STAT_IDSET_LOOKUPS];
+    stats->idset_probes = values[FABRIC_STAT_IDSET_PROBES];
+    stats->idset_resizes = values[FABRIC_STAT_IDSET_RESIZES];
+    stats->entitymap_lookups = values[FABRIC_STAT_ENTITYMAP_LOOKUPS];
+    stats->entitymap_probes = values[FABRIC_STAT_ENTITYMAP_PROBES];
+    stats->entitymap_resizes = values[FABRIC_STAT_ENTITYMAP_RESIZES];
+    for (i = 0; i < FABRIC_MEM_NUM_TAGS; i++) {
+        stats->memory_used[i] = Fabric_memused_tagged(i);
+        stats->memory_total += stats->memory_used[i];
+    }
+}
+
+/**
+ * Sets the file offset of a graph's saved adjacency snapshot
+ *
+ * The offset is written to the graph's header.
+ *
+ * Args:
+ *      self: The graph
+ *      offset: The offset of the snapshot section or 0 if there is none
+ */
+void Fabric_Graph_set_adjacency_snapshot_offset(Graph *self, uint32_t offset) {
+    self->adjacency_snapshot_offset = offset;
+    Fabric_Graph__update_header(self, offset, ADJACENCY_SNAPSHOT_OFFSET_OFFSET);
+}
+
+/**
+ * Sets the file offset of a graph's free id directory
+ *
+ * The offset is written to the graph's header.
+ *
+ * Args:
+ *      self: The graph
+ *      offset: The offset of the directory
+ */
+void Fabric_Graph_set_free_id_directory_offset(Graph *self, uint32_t offset) {
+    self->free_id_directory_offset = offset;
+    Fabric_Graph__update_header(self, offset, FREE_ID_DIRECTORY_OFFSET_OFFSET);
+}
+
+/**
+ * Gets the manager of a graph's snapshots
+ *
+ * Args:
+ *      self: The graph
+ *
+ * Returns: The graph's snapshot manager or NULL if snapshots aren't enabled
+ */
+SnapshotManager *Fabric_Graph_get_snapshot_manager(Graph *self) {
+    return self->snapshots;
+}
+
+/**
+ * Gets a graph's open write batch
+ *
+ * Args:
+ *      self: The graph
+ *
+ * Returns: The graph's open batch or NULL if no batch is open
+ */
+WriteBatch *Fabric_Graph_get_write_batch(Graph *self) {
+    return self->batch;
+}
+
+/**
+ * Sets the write batch that keeps copies of the pages a graph changes
+ *
+ * Args:
+ *      self: The graph
+ *      batch: The graph's open batch or NULL to stop keeping copies
+ */
+void Fabric_Graph_set_write_batch(Graph *self, WriteBatch *batch) {
+    self->batch = batch;
+}
+
+/**
+ * Records the number of pages in a graph's index store in its header
+ *
+ * Args:
+ *      self: The graph
+ *      page_count: The number of index pages
+ */
+void Fabric_Graph_set_index_page_count(Graph *self, uint32_t page_count) {
+    self->index_store.page_count = page_count;
+    Fabric_Graph__update_header(self, page_count, INDEX_PAGE_COUNT_OFFSET);
+}
+
 #endif
\ No newline at end of file
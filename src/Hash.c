@@ -8,6 +8,7 @@
 #define _FABRIC_HASH_C__
 
 #include <stdint.h>
+#include <string.h>
 
 uint32_t hash(uint8_t *key, size_t len) {
     uint32_t hash, i;
@@ -22,8 +23,60 @@ uint32_t hash(uint8_t *key, size_t len) {
     return hash;
 }
 
+/**
+ * Hash for text keys that reads its key a 64 bit word at a time
+ *
+ * Each word is mixed in with a multiply and a shift, so the cost is one
+ * short dependency chain per eight bytes instead of a chain per byte as
+ * with hash(2).  Words are read in the host's byte order, so the values
+ * must not be stored in files.
+ */
+static inline
+uint32_t hash_text(const uint8_t *key, size_t len) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ len;
+    uint64_t word;
+
+    while (len >= sizeof(word)) {
+        memcpy(&word, key, sizeof(word));
+        h = (h ^ word) * 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 31;
+        key += sizeof(word);
+        len -= sizeof(word);
+    }
+    word = 0;
+    memcpy(&word, key, len);
+    h = (h ^ word) * 0x94d049bb133111ebULL;
+    h ^= h >> 29;
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+/**
+ * Integer hash for uint32 keys
+ *
+ * This is the finalizer of MurmurHash3.  It mixes every bit of the key
+ * into every bit of the result, so the low bits can be masked off to
+ * index a power of two sized table.
+ */
+static inline
 uint32_t hash_uint32(uint32_t key) {
-    return hash((uint8_t*)(&key), 4);
+    key ^= key >> 16;
+    key *= 0x85ebca6b;
+    key ^= key >> 13;
+    key *= 0xc2b2ae35;
+    key ^= key >> 16;
+    return key;
+}
+
+/**
+ * Rounds a table capacity up to a power of two
+ */
+static inline
+int hash_capacity(int capacity) {
+    int cap = 1;
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+    return cap;
 }
 
 #endif
\ No newline at end of file
@@ -3,7 +3,7 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 28, 2015
- * Updated: March 29, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_IDSET_C__
@@ -11,20 +11,28 @@
 
 #include "Internal.h"
 #include "Hash.c"
+#include "Stats.c"
 
 #define FABRIC_IDSET_DEFAULT_CAPACITY 32
-#define FABRIC_IDSET_MAXLOAD 0.6
-#define FABRIC_IDSET_TOMBSTONE 0x11111111
+#define FABRIC_IDSET_MAXLOAD 0.75
 
 /**
  * A set of uint32 ids.
  *
- * Currently implemented as a simple hash table.
+ * Implemented as an open addressing hash table with linear probing.
+ * The capacity is always a power of two so that a hash can be masked
+ * into a slot, and removals shift later entries back instead of leaving
+ * tombstones, so probe sequences never grow with churn.
+ *
+ * Ids start at 1, so 0 marks an empty slot and can't be stored.  The
+ * table is allocated by the first add, so a set that stays empty costs
+ * only its header.
  */
 typedef struct IdSet {
     int count;              // The number of ids in the set
-    int cap;                // The capacity of the underlying array
-    uint32_t *ids;         // The underlying data for the set
+    int cap;                // The capacity of the underlying array; a power of two
+    int max_count;          // The count at which the set grows
+    uint32_t *ids;          // The underlying data for the set, or NULL until an id is added
 } IdSet;
 
 
@@ -34,7 +42,8 @@ uint32_t *Fabric_IdSet_to_array(IdSet *self, error_t *status);
  * Creates an id set with a specified capacity
  *
  * Args:
- *      capacity: The initial capacity the set should have, < 1 for default
+ *      capacity: The initial capacity the set should have, < 1 for default.
+ *                It is rounded up to a power of two.
  *      satus: A pointer to where any errors will be stored
  *
  * Returns: A newly allocated and initialized id set, or NULL on error
@@ -43,24 +52,17 @@ IdSet *Fabric_IdSet_new_with_capacity(int capacity, error_t *status) {
     if (capacity < 1) {
         capacity = FABRIC_IDSET_DEFAULT_CAPACITY;
     }
+    capacity = hash_capacity(capacity);
 
-    IdSet *set = Fabric_memalloc(sizeof(IdSet));
+    IdSet *set = Fabric_memalloc_tagged(sizeof(IdSet), FABRIC_MEM_LIST);
     if (NULL == set) {
         *status = Fabric_memerrno();
     } else {
         set->count = 0;
         set->cap = capacity;
-
-        set->ids = Fabric_memalloc(capacity * sizeof(uint32_t));
-        if (NULL == set->ids) {
-            // Clean up the memory
-            Fabric_memfree(set, sizeof(IdSet));
-            set = NULL;
-            *status = Fabric_memerrno();
-        } else {
-            memset(set->ids, 0, capacity * sizeof(uint32_t));
-            *status = FABRIC_OK;
-        }
+        set->max_count = 0;
+        set->ids = NULL;
+        *status = FABRIC_OK;
     }
 
     return set;
@@ -85,8 +87,10 @@ IdSet *Fabric_IdSet_new(error_t *status) {
  *      self: The id set being destroyed
  */
 void Fabric_IdSet_destroy(IdSet *self) {
-    Fabric_memfree(self->ids, self->cap * sizeof(uint32_t));
-    Fabric_memfree(self, sizeof(IdSet));
+    if (NULL != self->ids) {
+        Fabric_memfree_tagged(self->ids, self->cap * sizeof(uint32_t), FABRIC_MEM_LIST);
+    }
+    Fabric_memfree_tagged(self, sizeof(IdSet), FABRIC_MEM_LIST);
 }
 
 /**
@@ -110,6 +114,25 @@ int Fabric_IdSet_get_capacity(IdSet *self) {
     return self->cap;
 }
 
+/**
+ * Private function that finds the slot holding an id, or the empty
+ * slot where it would be added
+ *
+ * The lookup and the number of slots it examined are counted.
+ */
+static inline
+uint32_t Fabric_IdSet__find_slot(IdSet *self, uint32_t id) {
+    uint32_t mask = self->cap - 1;
+    uint32_t home = hash_uint32(id) & mask;
+    uint32_t pos = home;
+    while (self->ids[pos] != 0 && self->ids[pos] != id) {
+        pos = (pos + 1) & mask;
+    }
+    Fabric_stats_add(FABRIC_STAT_IDSET_LOOKUPS, 1);
+    Fabric_stats_add(FABRIC_STAT_IDSET_PROBES, ((pos - home) & mask) + 1);
+    return pos;
+}
+
 /**
  * Returns whether or not the set has an id
  *
@@ -120,39 +143,26 @@ int Fabric_IdSet_get_capacity(IdSet *self) {
  * Returns: TRUE if the set contains the id, FALSE if not
  */
 bool_t Fabric_IdSet_has(IdSet *self, uint32_t id) {
-    uint32_t pos = hash_uint32(id) % self->cap;
-    while (self->ids[pos] != 0) {
-        if (self->ids[pos] == id) {
-            return TRUE;
-        }
-        pos = (pos + 1) % self->cap;
+    if (id == 0 || NULL == self->ids) {
+        return FALSE;
     }
-    return FALSE;
-}
-
-/**
- * Private method for adding ids to the set without performing
- * capacity or other checks.
- */
-void Fabric_IdSet__add_no_checks(IdSet *self, uint32_t id) {
-    uint32_t pos = hash_uint32(id) % self->cap;
-    while (self->ids[pos] != 0 && self->ids[pos] != FABRIC_IDSET_TOMBSTONE) {
-        pos = (pos + 1) % self->cap;
-    }
-
-    self->ids[pos] = id;
-    self->count++;
+    return self->ids[Fabric_IdSet__find_slot(self, id)] == id;
 }
 
 /**
  * Private function to resize an id set
+ *
+ * A set without a table is given one of new_cap slots.
  */
+static
 error_t Fabric_IdSet__resize(IdSet *self, int new_cap) {
 
     uint32_t *old_data = self->ids;
-    uint32_t *new_data = Fabric_memalloc(new_cap * sizeof(uint32_t));
-    int l = self->cap;
-    int i, status;
+    uint32_t *new_data = Fabric_memalloc_tagged(new_cap * sizeof(uint32_t), FABRIC_MEM_LIST);
+    uint32_t mask = new_cap - 1;
+    uint32_t pos;
+    int l = NULL == old_data ? 0 : self->cap;
+    int i;
 
     if (new_data == NULL) {
         return Fabric_memerrno();
@@ -161,64 +171,107 @@ error_t Fabric_IdSet__resize(IdSet *self, int new_cap) {
     memset(new_data, 0, new_cap * sizeof(uint32_t));
 
     self->ids = new_data;
-    self->count = 0;
     self->cap = new_cap;
+    self->max_count = new_cap * FABRIC_IDSET_MAXLOAD;
 
+    // The ids are distinct, so each one goes in the first empty slot
     for (i = 0; i < l; i++) {
-        if (old_data[i] != 0 && old_data[i] != FABRIC_IDSET_TOMBSTONE) {
-            Fabric_IdSet__add_no_checks(self, old_data[i]);
+        if (old_data[i] != 0) {
+            pos = hash_uint32(old_data[i]) & mask;
+            while (self->ids[pos] != 0) {
+                pos = (pos + 1) & mask;
+            }
+            self->ids[pos] = old_data[i];
         }
     }
+    if (NULL == old_data) {
+        return FABRIC_OK;
+    }
+    Fabric_stats_add(FABRIC_STAT_IDSET_RESIZES, 1);
 
-    Fabric_memfree(old_data, l * sizeof(uint32_t));
+    Fabric_memfree_tagged(old_data, l * sizeof(uint32_t), FABRIC_MEM_LIST);
     return FABRIC_OK;
 }
 
 /**
  * Adds an id to the set
  *
- * If an error occurs, the set should remain unchanged
+ * If an error occurs, the set should remain unchanged.  Adding the
+ * id 0 has no effect.
  *
  * Args:
  *      self: The set that the id is being added to
  */
 error_t Fabric_IdSet_add(IdSet *self, uint32_t id) {
+    uint32_t pos;
+    error_t status;
+
+    if (id == 0) {
+        return FABRIC_OK;
+    }
+    if (NULL == self->ids) {
+        status = Fabric_IdSet__resize(self, self->cap);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
+
+    pos = Fabric_IdSet__find_slot(self, id);
     // Don't add a duplicate
-    if (Fabric_IdSet_has(self, id)) {
+    if (self->ids[pos] == id) {
         return FABRIC_OK;
     }
 
-    error_t status;
-    float load = (float)(self->count + 1) / (float)(self->cap);
-    if (load > FABRIC_IDSET_MAXLOAD) {
+    if (self->count + 1 > self->max_count) {
         status = Fabric_IdSet__resize(self, self->cap * 2);
         if (FABRIC_OK != status) {
             return status;
         }
+        pos = Fabric_IdSet__find_slot(self, id);
     }
 
-    Fabric_IdSet__add_no_checks(self, id);
-
+    self->ids[pos] = id;
+    self->count++;
     return FABRIC_OK;
 }
 
 /**
  * Removes an id from a set
  *
+ * The ids after it in its probe sequence are shifted back into the
+ * freed slot so that no tombstone is needed.
+ *
  * Args:
  *      self: The set that is having the id removed
  *      id: The id being removed from the set
  */
 void Fabric_IdSet_remove(IdSet *self, uint32_t id) {
-    uint32_t pos = hash_uint32(id) % self->cap;
-    while (self->ids[pos] != 0) {
-        if (self->ids[pos] == id) {
-            self->ids[pos] = FABRIC_IDSET_TOMBSTONE;
-            self->count--;
+    uint32_t mask = self->cap - 1;
+    uint32_t hole, pos, home;
+
+    if (id == 0 || NULL == self->ids) {
+        return;
+    }
+    hole = Fabric_IdSet__find_slot(self, id);
+    if (self->ids[hole] != id) {
+        return;
+    }
+
+    pos = hole;
+    for (;;) {
+        pos = (pos + 1) & mask;
+        if (self->ids[pos] == 0) {
             break;
         }
-        pos = (pos + 1) % self->cap;
+        // Move the entry back if the hole lies between its home and its slot
+        home = hash_uint32(self->ids[pos]) & mask;
+        if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+            self->ids[hole] = self->ids[pos];
+            hole = pos;
+        }
     }
+    self->ids[hole] = 0;
+    self->count--;
 }
 
 /**
@@ -243,7 +296,7 @@ uint32_t *Fabric_IdSet_to_array(IdSet *self, error_t *status) {
         int internal_pos = 0;
         int arr_l = self->count;
         for (;array_pos < arr_l; array_pos++) {
-            while (self->ids[internal_pos] == 0 || self->ids[internal_pos] == FABRIC_IDSET_TOMBSTONE) {
+            while (self->ids[internal_pos] == 0) {
                 internal_pos++;
             }
             array[array_pos] = self->ids[internal_pos];
@@ -3,13 +3,15 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 25, 2015
- * Updated: March 29, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_INDEX_C__
 #define _FABRIC_INDEX_C__
 
+#include <string.h>
 #include "Internal.h"
+#include "Hash.c"
 
 /**
  * An index is a redundant data store which speeds up the lookup of
@@ -37,10 +39,557 @@ typedef struct UnusedIndex {
     indexid_t next_unused_index;
 } UnusedIndex;
 
-typedef struct ClassIndex {
+/**
+ * A name index maps the names of entities to their ids.  The class index
+ * and the label index are name indices.
+ *
+ * A name index's entries are stored in a chain of index pages that starts
+ * at the index's root page.  The root pages of the name indices are among
+ * the index store's first FABRIC_INDEX_ROOT_PAGES pages; a root page
+ * whose type is 0 holds an empty index.  Each page has a 12 byte header
+ * followed by the entries, which are appended as names are added.  A
+ * removed entry is kept with an id of 0.
+ *
+ * +----+----+----+----+----+----+----+----+----+----+----+----+
+ * | type | unused     | next_page_id      | used_bytes        |
+ * +----+----+----+----+----+----+----+----+----+----+----+----+
+ *
+ * +----+----+----+----+----+----+----+----+--
+ * | id                | length  | name (length bytes)
+ * +----+----+----+----+----+----+----+----+--
+ *
+ * The index is read once, the first time it is needed, into a hash
+ * table keyed on the names which is kept in memory from then on.  The
+ * names are interned in an arena, so reading an index doesn't allocate
+ * once per name, and a table from ids to entries gives the name of an
+ * id.  Writes go to the pages and the tables together.
+ */
+#define FABRIC_CLASS_INDEX_PAGE_ID 1
+#define FABRIC_LABEL_INDEX_PAGE_ID 2
+#define FABRIC_CLASS_INDEX_TYPE 0x01
+#define FABRIC_LABEL_INDEX_TYPE 0x02
+#define FABRIC_NAME_INDEX_HEADER_SIZE 12
+#define FABRIC_NAME_INDEX_ENTRY_HEADER_SIZE 6
+#define FABRIC_NAME_INDEX_ARENA_CHUNK 4096
+
+typedef struct NameIndexEntry {
+    uint32_t hash;          // The hash of the name
+    uint32_t id;            // The entity with the name
+    bool_t is_deleted;      // Whether the entity was removed from the index
+    uint16_t length;        // The length of the name
+    uint32_t offset;        // The file offset of the stored entry
+    uint8_t *name;          // The null terminated name, held by the arena
+} NameIndexEntry;
+
+typedef struct NameIndex {
     Index base;
-    classid_t count;
-} ClassIndex;
+    uint32_t count;             // The number of names in the index
+    IndexStore *store;          // The index store holding the index's pages
+    MemArena names;             // Holds the names of the entries
+    NameIndexEntry *entries;    // Every entry in the order they were stored
+    uint32_t num_entries;       // The number of entries, including deleted ones
+    uint32_t entries_cap;       // The capacity of the entries array
+    uint32_t *slots;            // Hash table of entry positions plus one; 0 is empty
+    uint32_t num_slots;         // The size of the hash table; a power of two
+    uint32_t *by_id;            // The position plus one of each id's newest entry
+    uint32_t by_id_cap;         // The number of ids the by_id array holds
+    uint32_t last_page_id;      // The page entries are appended to or 0 if none
+    uint32_t last_page_used;    // The bytes used in the last page after its header
+} NameIndex;
+
+/**
+ * The class index maps class names to class ids.
+ */
+struct ClassIndex {
+    NameIndex names;
+};
+
+/**
+ * The label index interns the text of labels; it maps text to label ids
+ * and label ids back to their text.
+ */
+struct LabelIndex {
+    NameIndex names;
+};
+
+/**
+ * Private function that finds the table slot for a name
+ *
+ * Returns: The slot holding the name's live entry or the empty slot
+ *          where it would be inserted
+ */
+static
+uint32_t Fabric_NameIndex__find_slot(NameIndex *self, const uint8_t *name, uint16_t length, uint32_t hash_value) {
+    uint32_t mask = self->num_slots - 1;
+    uint32_t i = hash_value & mask;
+    NameIndexEntry *entry;
+
+    while (self->slots[i] != 0) {
+        entry = &self->entries[self->slots[i] - 1];
+        if (!entry->is_deleted &&
+            entry->hash == hash_value &&
+            entry->length == length &&
+            memcmp(entry->name, name, length) == 0) {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/**
+ * Private function that resizes the hash table to fit its entries
+ */
+static
+error_t Fabric_NameIndex__resize_table(NameIndex *self, uint32_t num_slots) {
+    uint32_t *slots = Fabric_memalloc_tagged(num_slots * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    uint32_t mask = num_slots - 1;
+    uint32_t i, j;
+
+    if (NULL == slots) {
+        return Fabric_memerrno();
+    }
+    memset(slots, 0, num_slots * sizeof(uint32_t));
+
+    // Deleted entries are dropped from the table
+    for (i = 0; i < self->num_entries; i++) {
+        if (self->entries[i].is_deleted) {
+            continue;
+        }
+        for (j = self->entries[i].hash & mask; slots[j] != 0; j = (j + 1) & mask);
+        slots[j] = i + 1;
+    }
+    if (NULL != self->slots) {
+        Fabric_memfree_tagged(self->slots, self->num_slots * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    }
+    self->slots = slots;
+    self->num_slots = num_slots;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that makes room in the by_id array for an id
+ */
+static
+error_t Fabric_NameIndex__reserve_id(NameIndex *self, uint32_t id) {
+    uint32_t new_cap = self->by_id_cap;
+    uint32_t *by_id;
+
+    if (id < self->by_id_cap) {
+        return FABRIC_OK;
+    }
+    while (new_cap <= id) {
+        new_cap *= 2;
+    }
+    by_id = Fabric_memrealloc_tagged(self->by_id,
+        new_cap * sizeof(uint32_t), self->by_id_cap * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    if (NULL == by_id) {
+        return Fabric_memerrno();
+    }
+    memset(by_id + self->by_id_cap, 0, (new_cap - self->by_id_cap) * sizeof(uint32_t));
+    self->by_id = by_id;
+    self->by_id_cap = new_cap;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that adds an entry to the in memory index
+ */
+static
+error_t Fabric_NameIndex__insert(NameIndex *self, const uint8_t *name, uint16_t length, uint32_t id, uint32_t offset) {
+    NameIndexEntry *entries, *entry;
+    uint32_t new_cap, hash_value, slot;
+    error_t status;
+
+    // Keep the table under three quarters full, counting deleted entries
+    if ((self->num_entries + 1) * 4 > self->num_slots * 3) {
+        status = Fabric_NameIndex__resize_table(self, self->num_slots * 2);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
+    if (self->num_entries == self->entries_cap) {
+        new_cap = self->entries_cap * 2;
+        entries = Fabric_memrealloc_tagged(self->entries,
+            new_cap * sizeof(NameIndexEntry), self->entries_cap * sizeof(NameIndexEntry), FABRIC_MEM_INDEX);
+        if (NULL == entries) {
+            return Fabric_memerrno();
+        }
+        self->entries = entries;
+        self->entries_cap = new_cap;
+    }
+    status = Fabric_NameIndex__reserve_id(self, id);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    entry = &self->entries[self->num_entries];
+    entry->name = Fabric_memarena_alloc(&self->names, length + 1);
+    if (NULL == entry->name) {
+        return Fabric_memerrno();
+    }
+    memcpy(entry->name, name, length);
+    entry->name[length] = '\0';
+    hash_value = hash_text(name, length);
+    entry->hash = hash_value;
+    entry->id = id;
+    entry->is_deleted = FALSE;
+    entry->length = length;
+    entry->offset = offset;
+
+    slot = Fabric_NameIndex__find_slot(self, name, length, hash_value);
+    self->slots[slot] = ++self->num_entries;
+    self->by_id[id] = self->num_entries;
+    self->count++;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that reads one of the index's pages into memory
+ */
+static
+error_t Fabric_NameIndex__load_page(NameIndex *self, uint8_t *page, uint32_t page_id, uint32_t *next_page_id) {
+    uint32_t page_size = self->store->page_size;
+    uint32_t page_offset = Fabric_IndexStore_get_page_offset(self->store, page_id);
+    uint32_t used, position, id;
+    uint16_t length;
+    error_t status;
+
+    status = Fabric_Graph_read_bytes(Fabric_IndexStore_get_graph(self->store), page, page_size, page_offset);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_INDEX_STORE, 1);
+    *next_page_id = 0;
+    // An unused root page holds an empty index
+    if (page_id == self->base.id && page[0] == 0) {
+        return FABRIC_OK;
+    }
+    used = betoh32(*(uint32_t*)(page + 8));
+    if (page[0] != self->base.type || used > page_size - FABRIC_NAME_INDEX_HEADER_SIZE) {
+        return FABRIC_INDEX_ERROR;
+    }
+    *next_page_id = betoh32(*(uint32_t*)(page + 4));
+
+    position = FABRIC_NAME_INDEX_HEADER_SIZE;
+    while (position + FABRIC_NAME_INDEX_ENTRY_HEADER_SIZE <= used + FABRIC_NAME_INDEX_HEADER_SIZE) {
+        id = betoh32(*(uint32_t*)(page + position));
+        length = betoh16(*(uint16_t*)(page + position + 4));
+        if (position + FABRIC_NAME_INDEX_ENTRY_HEADER_SIZE + length > used + FABRIC_NAME_INDEX_HEADER_SIZE) {
+            return FABRIC_INDEX_ERROR;
+        }
+        if (id != 0) {
+            status = Fabric_NameIndex__insert(self,
+                page + position + FABRIC_NAME_INDEX_ENTRY_HEADER_SIZE, length, id, page_offset + position);
+            if (FABRIC_OK != status) {
+                return status;
+            }
+        }
+        position += FABRIC_NAME_INDEX_ENTRY_HEADER_SIZE + length;
+    }
+
+    self->last_page_id = page_id;
+    self->last_page_used = used;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that frees the memory held by a name index
+ */
+static
+void Fabric_NameIndex__deinit(NameIndex *self) {
+    Fabric_memarena_release(&self->names);
+    if (NULL != self->entries) {
+        Fabric_memfree_tagged(self->entries, self->entries_cap * sizeof(NameIndexEntry), FABRIC_MEM_INDEX);
+    }
+    if (NULL != self->slots) {
+        Fabric_memfree_tagged(self->slots, self->num_slots * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    }
+    if (NULL != self->by_id) {
+        Fabric_memfree_tagged(self->by_id, self->by_id_cap * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    }
+}
+
+/**
+ * Private function that reads a name index into memory
+ *
+ * An index whose root page hasn't been allocated yet is empty.
+ *
+ * Args:
+ *      self: The name index being loaded
+ *      store: The graph's index store
+ *      root_page_id: The first page of the index
+ *      type: The type of the index's pages
+ *
+ * Returns: FABRIC_OK on success, FABRIC_INDEX_ERROR if the index's pages
+ *          aren't valid or other error code on failure
+ */
+static
+error_t Fabric_NameIndex__load(NameIndex *self, IndexStore *store, uint32_t root_page_id, uint8_t type) {
+    uint32_t page_id = root_page_id;
+    uint32_t next_page_id = 0;
+    uint8_t *page;
+    error_t status = FABRIC_OK;
+
+    self->base.id = root_page_id;
+    self->base.type = type;
+    self->count = 0;
+    self->store = store;
+    Fabric_memarena_init(&self->names, FABRIC_NAME_INDEX_ARENA_CHUNK, FABRIC_MEM_INDEX);
+    self->num_entries = 0;
+    self->entries_cap = 16;
+    self->slots = NULL;
+    self->by_id_cap = 16;
+    self->last_page_id = 0;
+    self->last_page_used = 0;
+    self->entries = Fabric_memalloc_tagged(self->entries_cap * sizeof(NameIndexEntry), FABRIC_MEM_INDEX);
+    self->by_id = Fabric_memalloc_tagged(self->by_id_cap * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    if (NULL == self->entries || NULL == self->by_id) {
+        return Fabric_memerrno();
+    }
+    memset(self->by_id, 0, self->by_id_cap * sizeof(uint32_t));
+    status = Fabric_NameIndex__resize_table(self, 32);
+    if (FABRIC_OK != status || Fabric_IndexStore_get_page_count(store) < root_page_id) {
+        return status;
+    }
+
+    page = Fabric_memalloc_tagged(store->page_size, FABRIC_MEM_INDEX);
+    if (NULL == page) {
+        return Fabric_memerrno();
+    }
+    while (page_id != 0 && FABRIC_OK == status) {
+        if (page_id > Fabric_IndexStore_get_page_count(store)) {
+            status = FABRIC_INDEX_ERROR;
+            break;
+        }
+        status = Fabric_NameIndex__load_page(self, page, page_id, &next_page_id);
+        page_id = next_page_id;
+    }
+    Fabric_memfree_tagged(page, store->page_size, FABRIC_MEM_INDEX);
+    return status;
+}
+
+/**
+ * Private function that finds the id with a given name
+ */
+static
+uint32_t Fabric_NameIndex__get_id(NameIndex *self, text_t name) {
+    size_t length = strlen(name);
+    uint32_t slot;
+
+    if (length > UINT16_MAX) {
+        return 0;
+    }
+    slot = Fabric_NameIndex__find_slot(self, (uint8_t*)name, length, hash_text((uint8_t*)name, length));
+    if (self->slots[slot] == 0) {
+        return 0;
+    }
+    return self->entries[self->slots[slot] - 1].id;
+}
+
+/**
+ * Private function that finds the name of an id
+ *
+ * Returns: The interned name or NULL if the id isn't in the index
+ */
+static
+text_t Fabric_NameIndex__get_name(NameIndex *self, uint32_t id) {
+    NameIndexEntry *entry;
+    if (id == 0 || id >= self->by_id_cap || self->by_id[id] == 0) {
+        return NULL;
+    }
+    entry = &self->entries[self->by_id[id] - 1];
+    return entry->is_deleted ? NULL : (text_t)entry->name;
+}
+
+/**
+ * Private function that writes the header of a new index page
+ */
+static
+error_t Fabric_NameIndex__write_page_header(NameIndex *self, uint32_t page_id, uint8_t type) {
+    uint8_t header[FABRIC_NAME_INDEX_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    header[0] = type;
+    return Fabric_Graph_write_bytes(Fabric_IndexStore_get_graph(self->store), header, sizeof(header),
+        Fabric_IndexStore_get_page_offset(self->store, page_id));
+}
+
+/**
+ * Private function that starts the page new entries are appended to
+ *
+ * An empty index starts at its root page.  The root pages of every name
+ * index are allocated together, the first time any of them is needed.
+ */
+static
+error_t Fabric_NameIndex__start_page(NameIndex *self) {
+    Graph *graph = Fabric_IndexStore_get_graph(self->store);
+    uint32_t page_id;
+    error_t status = FABRIC_OK;
+
+    if (self->last_page_id == 0) {
+        status = Fabric_IndexStore_reserve_root_pages(self->store);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        page_id = self->base.id;
+    } else {
+        page_id = Fabric_IndexStore_allocate_page(self->store, &status);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
+
+    status = Fabric_NameIndex__write_page_header(self, page_id, self->base.type);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    if (self->last_page_id != 0) {
+        Fabric_Graph_write_uint32(graph, page_id,
+            Fabric_IndexStore_get_page_offset(self->store, self->last_page_id) + 4);
+    }
+    self->last_page_id = page_id;
+    self->last_page_used = 0;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that adds a name to a name index
+ *
+ * The entry is written to the index's last page, or to a new page if it
+ * doesn't fit.
+ *
+ * Returns: FABRIC_OK on success, duplicate_error if the name is in the
+ *          index, FABRIC_INDEX_ERROR if the name is too long to fit in an
+ *          index page or other error code on failure
+ */
+static
+error_t Fabric_NameIndex__add(NameIndex *self, text_t name, uint32_t id, error_t duplicate_error) {
+    Graph *graph = Fabric_IndexStore_get_graph(self->store);
+    uint32_t page_size = self->store->page_size;
+    size_t length = strlen(name);
+    uint32_t entry_size = FABRIC_NAME_INDEX_ENTRY_HEADER_SIZE + length;
+    uint32_t page_offset, offset;
+    uint8_t entry_header[FABRIC_NAME_INDEX_ENTRY_HEADER_SIZE];
+    error_t status;
+
+    if (id == 0 || length > UINT16_MAX || entry_size > page_size - FABRIC_NAME_INDEX_HEADER_SIZE) {
+        return FABRIC_INDEX_ERROR;
+    }
+    if (0 != Fabric_NameIndex__get_id(self, name)) {
+        return duplicate_error;
+    }
+
+    // Start a new page when the entry doesn't fit in the last one
+    if (self->last_page_id == 0 || self->last_page_used + entry_size > page_size - FABRIC_NAME_INDEX_HEADER_SIZE) {
+        status = Fabric_NameIndex__start_page(self);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
+
+    page_offset = Fabric_IndexStore_get_page_offset(self->store, self->last_page_id);
+    offset = page_offset + FABRIC_NAME_INDEX_HEADER_SIZE + self->last_page_used;
+    *(uint32_t*)entry_header = htobe32(id);
+    *(uint16_t*)(entry_header + 4) = htobe16(length);
+    if (FABRIC_OK != (status = Fabric_Graph_write_bytes(graph, entry_header, sizeof(entry_header), offset)) ||
+        FABRIC_OK != (status = Fabric_Graph_write_bytes(graph, (uint8_t*)name, length, offset + sizeof(entry_header)))) {
+        return status;
+    }
+    // The stored entry only counts once the page's used bytes include it
+    status = Fabric_NameIndex__insert(self, (uint8_t*)name, length, id, offset);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    self->last_page_used += entry_size;
+    Fabric_Graph_write_uint32(graph, self->last_page_used, page_offset + 8);
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that removes an id from a name index
+ *
+ * The entry stays in the hash table as a deleted marker until the table
+ * is next resized.
+ */
+static
+void Fabric_NameIndex__remove(NameIndex *self, uint32_t id) {
+    NameIndexEntry *entry;
+    if (NULL == Fabric_NameIndex__get_name(self, id)) {
+        return;
+    }
+    entry = &self->entries[self->by_id[id] - 1];
+    entry->is_deleted = TRUE;
+    self->count--;
+    Fabric_Graph_write_uint32(Fabric_IndexStore_get_graph(self->store), 0, entry->offset);
+}
+
+/**
+ * Private function that puts back an id's most recently removed entry
+ *
+ * Returns: FABRIC_OK on success, FABRIC_INDEX_ERROR if the id was never
+ *          removed, duplicate_error if another id has taken its name
+ */
+static
+error_t Fabric_NameIndex__restore(NameIndex *self, uint32_t id, error_t duplicate_error) {
+    NameIndexEntry *entry;
+    uint32_t mask = self->num_slots - 1;
+    uint32_t i, position;
+
+    if (id == 0 || id >= self->by_id_cap || self->by_id[id] == 0) {
+        return FABRIC_INDEX_ERROR;
+    }
+    position = self->by_id[id];
+    entry = &self->entries[position - 1];
+    if (!entry->is_deleted) {
+        return FABRIC_OK;
+    }
+    i = Fabric_NameIndex__find_slot(self, entry->name, entry->length, entry->hash);
+    if (self->slots[i] != 0) {
+        return duplicate_error;
+    }
+
+    // A resize since the removal drops the entry from the table
+    for (i = entry->hash & mask; self->slots[i] != 0 && self->slots[i] != position; i = (i + 1) & mask);
+    self->slots[i] = position;
+    entry->is_deleted = FALSE;
+    self->count++;
+    Fabric_Graph_write_uint32(Fabric_IndexStore_get_graph(self->store), id, entry->offset);
+    return FABRIC_OK;
+}
+
+/**
+ * Reads a graph's class index into memory
+ *
+ * A graph whose index store has no pages yet gets an empty index; its
+ * root page is allocated when the first class is added.
+ *
+ * Args:
+ *      store: The graph's index store
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The class index or NULL on failure
+ */
+ClassIndex *Fabric_ClassIndex_load(IndexStore *store, error_t *status) {
+    ClassIndex *self = Fabric_memalloc_tagged(sizeof(ClassIndex), FABRIC_MEM_INDEX);
+    if (NULL == self) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    *status = Fabric_NameIndex__load(&self->names, store, FABRIC_CLASS_INDEX_PAGE_ID, FABRIC_CLASS_INDEX_TYPE);
+    if (FABRIC_OK != *status) {
+        Fabric_ClassIndex_destroy(self);
+        return NULL;
+    }
+    return self;
+}
+
+/**
+ * Frees the memory held by a class index
+ */
+void Fabric_ClassIndex_destroy(ClassIndex *self) {
+    Fabric_NameIndex__deinit(&self->names);
+    Fabric_memfree_tagged(self, sizeof(ClassIndex), FABRIC_MEM_INDEX);
+}
 
 /**
  * Return's the id of a class with a given name
@@ -53,9 +602,188 @@ typedef struct ClassIndex {
  * Returns: The id of the class being searched for or 0 if not found or error occurs
  */
 classid_t Fabric_ClassIndex_get_class_id(ClassIndex *self, text_t name, error_t *status) {
-    // TODO this is a stub
     *status = FABRIC_OK;
-    return 0;
+    return Fabric_NameIndex__get_id(&self->names, name);
+}
+
+/**
+ * Adds a class to a class index
+ *
+ * Args:
+ *      self: The class index
+ *      name: The name of the class
+ *      class_id: The id of the class
+ *
+ * Returns: FABRIC_OK on success, FABRIC_DUPLICATE_CLASSNAME if a class
+ *          already has the name, FABRIC_INDEX_ERROR if the name is too
+ *          long to fit in an index page or other error code on failure
+ */
+error_t Fabric_ClassIndex_add(ClassIndex *self, text_t name, classid_t class_id) {
+    return Fabric_NameIndex__add(&self->names, name, class_id, FABRIC_DUPLICATE_CLASSNAME);
+}
+
+/**
+ * Removes a class from a class index
+ *
+ * Args:
+ *      self: The class index
+ *      class_id: The id of the class being removed
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_ClassIndex_remove(ClassIndex *self, classid_t class_id) {
+    Fabric_NameIndex__remove(&self->names, class_id);
+    return FABRIC_OK;
+}
+
+/**
+ * Puts back a class's most recently removed entry if the class isn't
+ * in a class index
+ *
+ * Args:
+ *      self: The class index
+ *      class_id: The id of the class being restored
+ *
+ * Returns: FABRIC_OK on success, FABRIC_INDEX_ERROR if the class was
+ *          never removed, FABRIC_DUPLICATE_CLASSNAME if another class
+ *          has taken its name
+ */
+error_t Fabric_ClassIndex_restore(ClassIndex *self, classid_t class_id) {
+    return Fabric_NameIndex__restore(&self->names, class_id, FABRIC_DUPLICATE_CLASSNAME);
+}
+
+/**
+ * Private function that builds a label index from the label and text
+ * stores and writes it to the index's pages
+ *
+ * This is used for graphs whose labels were created before the label
+ * index was stored.
+ */
+static
+error_t Fabric_LabelIndex__rebuild(LabelIndex *self, Graph *graph) {
+    LabelStore *ls = Fabric_Graph_get_label_store(graph);
+    Label *label;
+    Text *text;
+    labelid_t label_id;
+    error_t status;
+
+    for (label_id = 1; label_id < ls->last_free_id; label_id++) {
+        label = Fabric_LabelStore_get_label(ls, label_id, &status);
+        if (FABRIC_LABEL_DOESNT_EXIST == status) {
+            continue;
+        } else if (FABRIC_OK != status) {
+            return status;
+        }
+        text = Fabric_Label_get_text(label, graph, &status);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        status = Fabric_NameIndex__add(&self->names, Fabric_Text_get_value(text), label_id, FABRIC_INDEX_ERROR);
+        Fabric_Text_destroy(text);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Reads a graph's label index into memory
+ *
+ * If the graph has labels but no stored label index, the index is built
+ * from the label and text stores and stored.
+ *
+ * Args:
+ *      store: The graph's index store
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The label index or NULL on failure
+ */
+LabelIndex *Fabric_LabelIndex_load(IndexStore *store, error_t *status) {
+    Graph *graph = Fabric_IndexStore_get_graph(store);
+    LabelIndex *self = Fabric_memalloc_tagged(sizeof(LabelIndex), FABRIC_MEM_INDEX);
+    if (NULL == self) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    *status = Fabric_NameIndex__load(&self->names, store, FABRIC_LABEL_INDEX_PAGE_ID, FABRIC_LABEL_INDEX_TYPE);
+    if (FABRIC_OK == *status && self->names.last_page_id == 0) {
+        *status = Fabric_LabelIndex__rebuild(self, graph);
+    }
+    if (FABRIC_OK != *status) {
+        Fabric_LabelIndex_destroy(self);
+        return NULL;
+    }
+    return self;
+}
+
+/**
+ * Frees the memory held by a label index
+ */
+void Fabric_LabelIndex_destroy(LabelIndex *self) {
+    Fabric_NameIndex__deinit(&self->names);
+    Fabric_memfree_tagged(self, sizeof(LabelIndex), FABRIC_MEM_INDEX);
+}
+
+/**
+ * Return's the id of a label with a given text value
+ *
+ * Args:
+ *      self: The label index
+ *      name: The text of the label being searched for
+ *      status: A pointer to where an error can be stored
+ *
+ * Returns: The id of the label being searched for or 0 if not found or error occurs
+ */
+labelid_t Fabric_LabelIndex_get_label_id(LabelIndex *self, text_t name, error_t *status) {
+    *status = FABRIC_OK;
+    return Fabric_NameIndex__get_id(&self->names, name);
+}
+
+/**
+ * Return's the text of a label
+ *
+ * The text is interned; it belongs to the index and must not be freed
+ * or changed.
+ *
+ * Args:
+ *      self: The label index
+ *      label_id: The id of the label
+ *
+ * Returns: The null terminated text or NULL if the label isn't in the index
+ */
+text_t Fabric_LabelIndex_get_text(LabelIndex *self, labelid_t label_id) {
+    return Fabric_NameIndex__get_name(&self->names, label_id);
+}
+
+/**
+ * Adds a label to a label index
+ *
+ * Args:
+ *      self: The label index
+ *      name: The text of the label
+ *      label_id: The id of the label
+ *
+ * Returns: FABRIC_OK on success, FABRIC_INDEX_ERROR if a label already
+ *          has the text or it is too long to fit in an index page, other
+ *          error code on failure
+ */
+error_t Fabric_LabelIndex_add(LabelIndex *self, text_t name, labelid_t label_id) {
+    return Fabric_NameIndex__add(&self->names, name, label_id, FABRIC_INDEX_ERROR);
+}
+
+/**
+ * Removes a label from a label index
+ *
+ * Args:
+ *      self: The label index
+ *      label_id: The id of the label being removed
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_LabelIndex_remove(LabelIndex *self, labelid_t label_id) {
+    Fabric_NameIndex__remove(&self->names, label_id);
+    return FABRIC_OK;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -3,14 +3,25 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 23, 2015
- * Updated: March 30, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_INDEXSTORE_C__
 #define _FABRIC_INDEXSTORE_C__
 
+#include <string.h>
 #include "Internal.h"
 
+/**
+ * The first pages of the index store are the root pages of the indices
+ * that every graph has: the class index, the label index, the property
+ * index directory, the label partition directory, the property column
+ * directory and the degree counts.  They are allocated together, with a
+ * type of 0, the first time any of them is written.
+ */
+#define FABRIC_INDEX_ROOT_PAGES 6
+#define FABRIC_INDEX_ROOT_HEADER_SIZE 12
+
 /**
  * The Index Store is the component of the graph that has the responsibility
  * of managing the storage of Indices.
@@ -24,78 +35,613 @@
 typedef struct IndexStore {
     uint32_t offset;        // graph file offset for the class store
     uint32_t size;          // the size of the class store
+    ExtentList extents;     // the regions of the file that hold the index store
     uint32_t page_size;     // the size of each index page
     uint32_t page_count;    // the total number of index pages
+    ClassIndex *class_index;    // the class index once it has been loaded
+    LabelIndex *label_index;    // the label index once it has been loaded
+    PropertyIndexDirectory *property_indexes;   // the property indices once they have been loaded
+    PropertyColumnDirectory *property_columns;  // the property columns once they have been loaded
 } IndexStore;
 
 /**
  * Initializes an Index Store object
  *
  * Args:
- *      self: The Index Store object being initialized.  Its offset, page_size,
- *            and page_count should already be set by the Graph
+ *      self: The Index Store object being initialized.  Its offset, extents,
+ *            page_size, and page_count should already be set by the Graph
  */
 void Fabric_IndexStore_init(IndexStore *self) {
-    self->size = self->page_size * self->page_count;
+    self->size = Fabric_ExtentList_get_size(&self->extents);
+    self->class_index = NULL;
+    self->label_index = NULL;
+    self->property_indexes = NULL;
+    self->property_columns = NULL;
+}
+
+/**
+ * Frees the indices an Index Store keeps in memory
+ */
+void Fabric_IndexStore_deinit(IndexStore *self) {
+    if (NULL != self->class_index) {
+        Fabric_ClassIndex_destroy(self->class_index);
+        self->class_index = NULL;
+    }
+    if (NULL != self->label_index) {
+        Fabric_LabelIndex_destroy(self->label_index);
+        self->label_index = NULL;
+    }
+    if (NULL != self->property_indexes) {
+        Fabric_PropertyIndexDirectory_destroy(self->property_indexes);
+        self->property_indexes = NULL;
+    }
+    if (NULL != self->property_columns) {
+        Fabric_PropertyColumnDirectory_destroy(self->property_columns);
+        self->property_columns = NULL;
+    }
+}
+
+/**
+ * Gets the number of pages in an Index Store
+ */
+uint32_t Fabric_IndexStore_get_page_count(IndexStore *self) {
+    return self->page_count;
 }
 
 /**
- * Retrieves an index from the database
+ * Gets the file offset of an index page
+ *
+ * Args:
+ *      self: A graph's index store
+ *      page_id: The id of the page, starting from 1
+ *
+ * Returns: The offset of the page in the graph's file
+ */
+uint32_t Fabric_IndexStore_get_page_offset(IndexStore *self, uint32_t page_id) {
+    return Fabric_ExtentList_get_record_offset(&self->extents, page_id);
+}
+
+/**
+ * Adds a page to an Index Store, growing the store if it is full
+ *
+ * The page's contents are not initialized.
+ *
+ * Args:
+ *      self: A graph's index store
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The id of the new page or 0 on failure
+ */
+uint32_t Fabric_IndexStore_allocate_page(IndexStore *self, error_t *status) {
+    Graph *graph = Fabric_IndexStore_get_graph(self);
+    uint32_t page_id = self->page_count + 1;
+
+    *status = Fabric_Graph_grow_store(graph, FABRIC_INDEX_STORE, page_id);
+    if (FABRIC_OK != *status) {
+        return 0;
+    }
+    self->page_count = page_id;
+    self->size = Fabric_ExtentList_get_size(&self->extents);
+    Fabric_Graph_set_index_page_count(graph, page_id);
+    return page_id;
+}
+
+/**
+ * Allocates the root pages of the index store if they don't exist yet
+ *
+ * A new root page is given a zeroed header, marking its index as empty.
+ *
+ * Args:
+ *      self: A graph's index store
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_IndexStore_reserve_root_pages(IndexStore *self) {
+    Graph *graph = Fabric_IndexStore_get_graph(self);
+    uint8_t header[FABRIC_INDEX_ROOT_HEADER_SIZE];
+    uint32_t page_id;
+    error_t status = FABRIC_OK;
+
+    memset(header, 0, sizeof(header));
+    while (self->page_count < FABRIC_INDEX_ROOT_PAGES) {
+        page_id = Fabric_IndexStore_allocate_page(self, &status);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        status = Fabric_Graph_write_bytes(graph, header, sizeof(header),
+            Fabric_IndexStore_get_page_offset(self, page_id));
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Retrieves a class's index by its index id
+ *
+ * Id indices aren't kept yet (see Fabric_IndexStore_create_id_index(3))
+ * and property indices are found by their class and label through the
+ * property index directory, so no index has an id that can be retrieved
+ * here and NULL is returned.
  *
  * Args:
  *      self: The index store that is retrieving an index object
  *      index_id: The id of the index object being retrieved
- *      out: Pointer to where the loaded index will be stored
+ *      status: A pointer to where an error can be indicated
  *
- * Returns: FABRIC_OK on success, other error code on failure
+ * Returns: NULL, with status set to FABRIC_OK
  */
 Index *Fabric_IndexStore_get_index(IndexStore *self, indexid_t index_id, error_t *status) {
-    //TODO this is a stub
     *status = FABRIC_OK;
     return NULL;
 }
 
+/**
+ * Gets a graph's class index
+ *
+ * The index is read from its pages the first time it is needed and kept
+ * in memory after that.
+ *
+ * Args:
+ *      self: A graph's index store
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The class index or NULL on failure
+ */
 ClassIndex *Fabric_IndexStore_get_class_index(IndexStore *self, error_t *status) {
-    //TODO this is a stub
     *status = FABRIC_OK;
-    return NULL;
+    if (NULL == self->class_index) {
+        self->class_index = Fabric_ClassIndex_load(self, status);
+    }
+    return self->class_index;
 }
 
+/**
+ * Gets a graph's label index
+ *
+ * The index is read from its pages, or built from the label store if it
+ * hasn't been stored, the first time it is needed and kept in memory
+ * after that.
+ *
+ * Args:
+ *      self: A graph's index store
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The label index or NULL on failure
+ */
 LabelIndex *Fabric_IndexStore_get_label_index(IndexStore *self, error_t *status) {
-    // TODO This is a stub
     *status = FABRIC_OK;
-    return NULL;
+    if (NULL == self->label_index) {
+        self->label_index = Fabric_LabelIndex_load(self, status);
+    }
+    return self->label_index;
 }
 
+/**
+ * Gets a graph's property index directory
+ *
+ * The directory is read from its page the first time it is needed and
+ * kept in memory after that.
+ */
+static
+PropertyIndexDirectory *Fabric_IndexStore__get_property_indexes(IndexStore *self, error_t *status) {
+    *status = FABRIC_OK;
+    if (NULL == self->property_indexes) {
+        self->property_indexes = Fabric_PropertyIndexDirectory_load(self, status);
+    }
+    return self->property_indexes;
+}
+
+/**
+ * Gets the property index of a class's property
+ *
+ * Args:
+ *      self: A graph's index store
+ *      class_id: The class whose vertices are indexed
+ *      label_id: The label of the indexed property
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The index or NULL on failure.  status is set to
+ *          FABRIC_INDEX_DOESNT_EXIST if there is no such index
+ */
+PropertyIndex *Fabric_IndexStore_get_property_index(IndexStore *self, classid_t class_id, labelid_t label_id, error_t *status) {
+    PropertyIndex *index;
+    PropertyIndexDirectory *directory = Fabric_IndexStore__get_property_indexes(self, status);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    index = Fabric_PropertyIndexDirectory_find(directory, class_id, label_id);
+    if (NULL == index) {
+        *status = FABRIC_INDEX_DOESNT_EXIST;
+    }
+    return index;
+}
+
+/**
+ * Creates a property index on a class's property
+ *
+ * Pending property changes are flushed first and the index is filled
+ * with the current values of the class's vertices.  Vertices of the
+ * class's subclasses are not indexed.
+ *
+ * Args:
+ *      self: A graph's index store
+ *      class_id: The class whose vertices are indexed
+ *      label_id: The label of the indexed property
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The new index or NULL on failure.  status is set to
+ *          FABRIC_INDEX_ERROR if the index already exists
+ */
+PropertyIndex *Fabric_IndexStore_create_property_index(IndexStore *self, classid_t class_id, labelid_t label_id, error_t *status) {
+    Graph *graph = Fabric_IndexStore_get_graph(self);
+    PropertyStore *ps = Fabric_Graph_get_property_store(graph);
+    VertexStore *vs = Fabric_Graph_get_vertex_store(graph);
+    PropertyIndexDirectory *directory;
+    PropertyIndex *index;
+    Property *property;
+    Vertex *vertex;
+    vertexid_t vertex_id;
+
+    *status = Fabric_PropertyStore_flush(ps);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    directory = Fabric_IndexStore__get_property_indexes(self, status);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    index = Fabric_PropertyIndexDirectory_create(directory, class_id, label_id, status);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+
+    for (vertex_id = 1; vertex_id < vs->last_free_id; vertex_id++) {
+        vertex = Fabric_VertexStore_get_vertex(vs, vertex_id, status);
+        if (FABRIC_VERTEX_DOESNT_EXIST == *status) {
+            continue;
+        } else if (FABRIC_OK != *status) {
+            return NULL;
+        } else if (Fabric_Vertex_get_class_id(vertex) != class_id) {
+            continue;
+        }
+        property = Fabric_PropertyStore_get_vertex_property(ps, vertex, label_id, status);
+        if (FABRIC_PROPERTY_DOESNT_EXIST == *status) {
+            continue;
+        } else if (FABRIC_OK != *status) {
+            return NULL;
+        }
+        *status = Fabric_PropertyIndex_insert(index,
+            Fabric_Property_get_type(property), Fabric_Property_get_data(property), vertex_id);
+        if (FABRIC_OK != *status) {
+            return NULL;
+        }
+    }
+    *status = FABRIC_OK;
+    return index;
+}
+
+/**
+ * Gets a graph's property column directory
+ *
+ * The directory is read from its page the first time it is needed and
+ * kept in memory after that.
+ */
+static
+PropertyColumnDirectory *Fabric_IndexStore__get_property_columns(IndexStore *self, error_t *status) {
+    *status = FABRIC_OK;
+    if (NULL == self->property_columns) {
+        self->property_columns = Fabric_PropertyColumnDirectory_load(self, status);
+    }
+    return self->property_columns;
+}
+
+/**
+ * Gets the column of a class's property
+ *
+ * The column holds the values the property had when the property store
+ * was last flushed.
+ *
+ * Args:
+ *      self: A graph's index store
+ *      class_id: The class whose vertices are held
+ *      label_id: The label of the held property
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The column or NULL on failure.  status is set to
+ *          FABRIC_INDEX_DOESNT_EXIST if there is no such column
+ */
+PropertyColumn *Fabric_IndexStore_get_property_column(IndexStore *self, classid_t class_id, labelid_t label_id, error_t *status) {
+    PropertyColumn *column;
+    PropertyColumnDirectory *directory = Fabric_IndexStore__get_property_columns(self, status);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    column = Fabric_PropertyColumnDirectory_find(directory, class_id, label_id);
+    if (NULL == column) {
+        *status = FABRIC_INDEX_DOESNT_EXIST;
+    }
+    return column;
+}
+
+/**
+ * Creates a column of a class's property
+ *
+ * Pending property changes are flushed first.  Every vertex of the class
+ * is given a row, in vertex id order, holding its current value or null.
+ * Vertices of the class's subclasses are not included.
+ *
+ * Args:
+ *      self: A graph's index store
+ *      class_id: The class whose vertices are held
+ *      label_id: The label of the held property
+ *      type: FABRIC_COLUMN_INTEGER, FABRIC_COLUMN_REAL or FABRIC_COLUMN_BOOLEAN
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The new column or NULL on failure.  status is set to
+ *          FABRIC_INDEX_ERROR if the column already exists or the type
+ *          is unknown
+ */
+PropertyColumn *Fabric_IndexStore_create_property_column(IndexStore *self, classid_t class_id, labelid_t label_id, uint8_t type, error_t *status) {
+    Graph *graph = Fabric_IndexStore_get_graph(self);
+    PropertyStore *ps = Fabric_Graph_get_property_store(graph);
+    VertexStore *vs = Fabric_Graph_get_vertex_store(graph);
+    PropertyColumnDirectory *directory;
+    PropertyColumn *column;
+    Property *property;
+    Vertex *vertex;
+    vertexid_t vertex_id;
+
+    *status = Fabric_PropertyStore_flush(ps);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    directory = Fabric_IndexStore__get_property_columns(self, status);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    column = Fabric_PropertyColumnDirectory_create(directory, class_id, label_id, type, status);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+
+    for (vertex_id = 1; vertex_id < vs->last_free_id; vertex_id++) {
+        vertex = Fabric_VertexStore_get_vertex(vs, vertex_id, status);
+        if (FABRIC_VERTEX_DOESNT_EXIST == *status) {
+            continue;
+        } else if (FABRIC_OK != *status) {
+            return NULL;
+        } else if (Fabric_Vertex_get_class_id(vertex) != class_id) {
+            continue;
+        }
+        property = Fabric_PropertyStore_get_vertex_property(ps, vertex, label_id, status);
+        if (FABRIC_PROPERTY_DOESNT_EXIST == *status) {
+            *status = Fabric_PropertyColumn_set(column, vertex_id, FABRIC_PROPTYPE_NOTHING, NULL);
+        } else if (FABRIC_OK == *status) {
+            *status = Fabric_PropertyColumn_set(column, vertex_id,
+                Fabric_Property_get_type(property), Fabric_Property_get_data(property));
+        }
+        if (FABRIC_OK != *status) {
+            return NULL;
+        }
+    }
+    *status = Fabric_PropertyColumnDirectory_flush(directory);
+    return FABRIC_OK == *status ? column : NULL;
+}
+
+/**
+ * Writes the changed rows of a graph's property columns
+ *
+ * Args:
+ *      self: A graph's index store
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_IndexStore_flush_property_columns(IndexStore *self) {
+    uint64_t started;
+    error_t status;
+
+    if (NULL == self->property_columns) {
+        return FABRIC_OK;
+    }
+    started = Fabric_stats_now();
+    status = Fabric_PropertyColumnDirectory_flush(self->property_columns);
+    Fabric_stats_add(FABRIC_STAT_FLUSHES + FABRIC_STATS_INDEX_STORE, 1);
+    Fabric_stats_add_elapsed(FABRIC_STAT_FLUSH_NANOS + FABRIC_STATS_INDEX_STORE, started);
+    return status;
+}
+
+/**
+ * Checks whether changes to a class's property have to be logged for a
+ * property index or a property column
+ *
+ * Args:
+ *      self: A graph's index store
+ *      class_id: The class of the property's owner
+ *      label_id: The label of the property
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: TRUE if the property has an index or a column
+ */
+bool_t Fabric_IndexStore_tracks_property(IndexStore *self, classid_t class_id, labelid_t label_id, error_t *status) {
+    Fabric_IndexStore_get_property_index(self, class_id, label_id, status);
+    if (FABRIC_INDEX_DOESNT_EXIST == *status) {
+        Fabric_IndexStore_get_property_column(self, class_id, label_id, status);
+    }
+    if (FABRIC_INDEX_DOESNT_EXIST == *status) {
+        *status = FABRIC_OK;
+        return FALSE;
+    }
+    return FABRIC_OK == *status;
+}
+
+/**
+ * Checks whether a graph has any property indices or property columns
+ *
+ * Both refer to vertices by their ids.
+ *
+ * Args:
+ *      self: A graph's index store
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: TRUE if there is at least one property index or column
+ */
+bool_t Fabric_IndexStore_has_property_indexes(IndexStore *self, error_t *status) {
+    PropertyIndexDirectory *indexes = Fabric_IndexStore__get_property_indexes(self, status);
+    PropertyColumnDirectory *columns;
+    if (FABRIC_OK != *status) {
+        return FALSE;
+    }
+    if (Fabric_PropertyIndexDirectory_get_count(indexes) > 0) {
+        return TRUE;
+    }
+    columns = Fabric_IndexStore__get_property_columns(self, status);
+    if (FABRIC_OK != *status) {
+        return FALSE;
+    }
+    return Fabric_PropertyColumnDirectory_get_count(columns) > 0;
+}
+
+/**
+ * Applies a logged property change to the property index and the
+ * property column it belongs to
+ *
+ * Args:
+ *      self: A graph's index store
+ *      change: The change to a property
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_IndexStore_apply_property_change(IndexStore *self, PropertyChange *change) {
+    error_t status;
+    PropertyColumn *column;
+    PropertyIndex *index = Fabric_IndexStore_get_property_index(self, change->class_id, change->label_id, &status);
+    if (FABRIC_OK == status) {
+        if (FABRIC_PROPTYPE_NOTHING != change->old_type) {
+            status = Fabric_PropertyIndex_remove(index, change->old_type, change->old_data, change->vertex_id);
+        }
+        if (FABRIC_OK == status && FABRIC_PROPTYPE_NOTHING != change->new_type) {
+            status = Fabric_PropertyIndex_insert(index, change->new_type, change->new_data, change->vertex_id);
+        }
+    }
+    if (FABRIC_OK != status && FABRIC_INDEX_DOESNT_EXIST != status) {
+        return status;
+    }
+
+    column = Fabric_IndexStore_get_property_column(self, change->class_id, change->label_id, &status);
+    if (FABRIC_INDEX_DOESNT_EXIST == status) {
+        return FABRIC_OK;
+    } else if (FABRIC_OK != status) {
+        return status;
+    }
+    return Fabric_PropertyColumn_set(column, change->vertex_id, change->new_type, change->new_data);
+}
+
+/**
+ * Creates the id index of a new class
+ *
+ * Id indices, which list the vertices that belong to a class, aren't
+ * kept yet: every class gets the index id 0, the same as an abstract
+ * class, and its vertices are found by scanning the vertex store.
+ *
+ * Args:
+ *      self: A graph's index store
+ *      class_id: The id of the new class
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: 0, with status set to FABRIC_OK
+ */
 indexid_t Fabric_IndexStore_create_id_index(IndexStore *self, classid_t class_id, error_t *status) {
-    // TODO this is a stub
     *status = FABRIC_OK;
     return 0;
 }
 
+/**
+ * Deletes the id index of a class
+ *
+ * Since no id index is created, there is nothing to delete.
+ *
+ * Returns: FABRIC_OK
+ */
 error_t Fabric_IndexStore_delete_id_index(IndexStore *self, indexid_t index_id) {
-    // TODO this is a stub
     return FABRIC_OK;
 }
 
-error_t Fabric_IndexStore_add_class_to_index(IndexStore *self, Class *class) {
-    // TODO This is a stub
-    return FABRIC_OK;
+/**
+ * Adds a class to the class index
+ *
+ * Args:
+ *      self: A graph's index store
+ *      class: The class being added
+ *      name: The class's name
+ *
+ * Returns: FABRIC_OK on success, FABRIC_DUPLICATE_CLASSNAME if another
+ *          class has the name or other error code on failure
+ */
+error_t Fabric_IndexStore_add_class_to_index(IndexStore *self, Class *class, text_t name) {
+    error_t status;
+    ClassIndex *ci = Fabric_IndexStore_get_class_index(self, &status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    return Fabric_ClassIndex_add(ci, name, Fabric_Class_get_id(class));
 }
 
+/**
+ * Puts a class removed from the class index back if it isn't there
+ *
+ * Args:
+ *      self: A graph's index store
+ *      class: The class being restored
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
 error_t Fabric_IndexStore_add_class_to_index_if_not_exists(IndexStore *self, Class *class) {
-    // TODO This is a stub
-    return FABRIC_OK;
+    error_t status;
+    ClassIndex *ci = Fabric_IndexStore_get_class_index(self, &status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    return Fabric_ClassIndex_restore(ci, Fabric_Class_get_id(class));
 }
 
+/**
+ * Removes a class from the class index
+ *
+ * Args:
+ *      self: A graph's index store
+ *      class: The class being removed
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
 error_t Fabric_IndexStore_remove_class_from_index(IndexStore *self, Class *class) {
-    // TODO This is a stub
-    return FABRIC_OK;
+    error_t status;
+    ClassIndex *ci = Fabric_IndexStore_get_class_index(self, &status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    return Fabric_ClassIndex_remove(ci, Fabric_Class_get_id(class));
 }
 
-error_t Fabric_IndexStore_add_label_to_index(IndexStore *self, Label *label) {
-    // TODO This is a stub
-    return FABRIC_OK;
+/**
+ * Adds a label to the label index
+ *
+ * Args:
+ *      self: A graph's index store
+ *      label: The label being added
+ *      name: The label's text
+ *
+ * Returns: FABRIC_OK on success, FABRIC_INDEX_ERROR if another label
+ *          has the text or other error code on failure
+ */
+error_t Fabric_IndexStore_add_label_to_index(IndexStore *self, Label *label, text_t name) {
+    error_t status;
+    LabelIndex *li = Fabric_IndexStore_get_label_index(self, &status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    return Fabric_LabelIndex_add(li, name, Fabric_Label_get_id(label));
 }
 
 #endif
\ No newline at end of file
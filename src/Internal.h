@@ -3,7 +3,7 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 23, 2015
- * Updated: March 31, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_INTERNAL_H__
@@ -15,6 +15,126 @@
 #ifndef INDEX_PAGE_SIZE
 #define INDEX_PAGE_SIZE 65536
 #endif
+/* The size of a buffer pool page; should evenly divide MIN_PAGE_SIZE */
+#ifndef FABRIC_PAGE_SIZE
+#define FABRIC_PAGE_SIZE 4096
+#endif
+/* The number of pages a graph's buffer pool can hold at once */
+#ifndef FABRIC_BUFFER_POOL_SIZE
+#define FABRIC_BUFFER_POOL_SIZE 256
+#endif
+/* The most threads a buffer pool reads prefetched pages with */
+#ifndef FABRIC_IO_THREADS
+#define FABRIC_IO_THREADS 4
+#endif
+/* The replacement policy used by store caches */
+#ifndef FABRIC_CACHE_POLICY
+#define FABRIC_CACHE_POLICY FABRIC_CACHE_POLICY_CLOCK
+#endif
+/* The number of classes a class store keeps cached */
+#ifndef FABRIC_CLASS_CACHE_SIZE
+#define FABRIC_CLASS_CACHE_SIZE 1024
+#endif
+/* The number of labels a label store keeps cached */
+#ifndef FABRIC_LABEL_CACHE_SIZE
+#define FABRIC_LABEL_CACHE_SIZE 4096
+#endif
+/* The number of bytes a thread allocates between checks of the memory budget */
+#ifndef FABRIC_MEM_BUDGET_CHECK_SIZE
+#define FABRIC_MEM_BUDGET_CHECK_SIZE 65536
+#endif
+/* The fewest entities a cache is shrunk to when memory is over budget */
+#ifndef FABRIC_MEM_BUDGET_MIN_CACHE_SIZE
+#define FABRIC_MEM_BUDGET_MIN_CACHE_SIZE 64
+#endif
+/* The size of the chunks that memory slabs carve objects from */
+#ifndef FABRIC_MEMSLAB_CHUNK_SIZE
+#define FABRIC_MEMSLAB_CHUNK_SIZE 16384
+#endif
+/* The alignment of objects allocated from memory slabs */
+#ifndef FABRIC_MEMSLAB_ALIGNMENT
+#define FABRIC_MEMSLAB_ALIGNMENT 8
+#endif
+/* The number of vertices a vertex store keeps cached */
+#ifndef FABRIC_VERTEX_CACHE_SIZE
+#define FABRIC_VERTEX_CACHE_SIZE 16384
+#endif
+/* The number of edges an edge store keeps cached */
+#ifndef FABRIC_EDGE_CACHE_SIZE
+#define FABRIC_EDGE_CACHE_SIZE 16384
+#endif
+/* The number of properties a property store keeps cached */
+#ifndef FABRIC_PROPERTY_CACHE_SIZE
+#define FABRIC_PROPERTY_CACHE_SIZE 16384
+#endif
+/* The number of properties a vertex needs before it gets a property directory */
+#ifndef FABRIC_PROPERTY_DIRECTORY_MIN
+#define FABRIC_PROPERTY_DIRECTORY_MIN 16
+#endif
+/* The number of property directories a property store keeps cached */
+#ifndef FABRIC_PROPERTY_DIRECTORY_CACHE_SIZE
+#define FABRIC_PROPERTY_DIRECTORY_CACHE_SIZE 4096
+#endif
+/* The number of edges an edge iterator reads at once */
+#ifndef FABRIC_EDGE_ITERATOR_BATCH
+#define FABRIC_EDGE_ITERATOR_BATCH 32
+#endif
+/* The number of keys a property index cursor reads at once */
+#ifndef FABRIC_PROPERTY_INDEX_CURSOR_BATCH
+#define FABRIC_PROPERTY_INDEX_CURSOR_BATCH 64
+#endif
+/* The most values a predicate can compare against */
+#ifndef FABRIC_PREDICATE_MAX_VALUES
+#define FABRIC_PREDICATE_MAX_VALUES 16
+#endif
+/* The most vertices a traversal worker takes on without sharing them */
+#ifndef FABRIC_TRAVERSAL_GRAIN
+#define FABRIC_TRAVERSAL_GRAIN 256
+#endif
+/* The most workers a traversal pool can have */
+#ifndef FABRIC_TRAVERSAL_MAX_THREADS
+#define FABRIC_TRAVERSAL_MAX_THREADS 64
+#endif
+/* The most extents a store can be made of */
+#ifndef FABRIC_MAX_STORE_EXTENTS
+#define FABRIC_MAX_STORE_EXTENTS 24
+#endif
+/* The initial size of a write-ahead log's record buffer */
+#ifndef FABRIC_WAL_BUFFER_SIZE
+#define FABRIC_WAL_BUFFER_SIZE 65536
+#endif
+/* The size a write-ahead log can reach before a commit checkpoints the graph */
+#ifndef FABRIC_WAL_CHECKPOINT_SIZE
+#define FABRIC_WAL_CHECKPOINT_SIZE (16 * 1024 * 1024)
+#endif
+/* The most dirty pages an incremental checkpoint writes */
+#ifndef FABRIC_CHECKPOINT_PAGES
+#define FABRIC_CHECKPOINT_PAGES 32
+#endif
+/* The least time between the incremental checkpoints run by commits, in milliseconds */
+#ifndef FABRIC_CHECKPOINT_INTERVAL
+#define FABRIC_CHECKPOINT_INTERVAL 100
+#endif
+/* The largest run of records a store flush writes at once, in bytes */
+#ifndef FABRIC_FLUSH_RUN_SIZE
+#define FABRIC_FLUSH_RUN_SIZE (FABRIC_PAGE_SIZE * 16)
+#endif
+/* The largest run of records a batched read reads at once, in bytes */
+#ifndef FABRIC_READ_RUN_SIZE
+#define FABRIC_READ_RUN_SIZE (FABRIC_PAGE_SIZE * 16)
+#endif
+/* The smallest chunk a write batch allocates for its page copies, in bytes */
+#ifndef FABRIC_WRITE_BATCH_CHUNK_SIZE
+#define FABRIC_WRITE_BATCH_CHUNK_SIZE (FABRIC_PAGE_SIZE * 16)
+#endif
+/* The out degree or in degree at which a vertex counts as a supernode */
+#ifndef FABRIC_SUPERNODE_DEGREE
+#define FABRIC_SUPERNODE_DEGREE 4096
+#endif
+/* The most snapshots of a graph that can be active at once */
+#ifndef FABRIC_MAX_SNAPSHOTS
+#define FABRIC_MAX_SNAPSHOTS 64
+#endif
 
 /**
  * Library for managing byte order on various systems
@@ -22,6 +142,9 @@
 #include "../ByteOrder/byteorder.h"
 #include <stdlib.h>
 #include <stdio.h>
+#ifndef FABRIC_NO_THREADS
+#  include <pthread.h>
+#endif
 
 /**
  * Types used by Fabric
@@ -37,6 +160,49 @@ typedef uint32_t error_t;
  */
 #define FABRIC_CLASS_STORAGE_SIZE 21
 #define FABRIC_LABEL_STORAGE_SIZE 8
+#define FABRIC_VERTEX_STORAGE_SIZE 14
+#define FABRIC_EDGE_STORAGE_SIZE 24
+#define FABRIC_PROPERTY_STORAGE_SIZE 17
+/* The largest record an entity view can copy */
+#define FABRIC_ENTITY_VIEW_COPY_SIZE FABRIC_EDGE_STORAGE_SIZE
+
+/**
+ * Store identifiers
+ */
+#define FABRIC_CLASS_STORE 1
+#define FABRIC_LABEL_STORE 2
+#define FABRIC_VERTEX_STORE 3
+#define FABRIC_EDGE_STORE 4
+#define FABRIC_PROPERTY_STORE 5
+#define FABRIC_TEXT_STORE 6
+#define FABRIC_INDEX_STORE 7
+
+/**
+ * Access pattern hints for mapped graphs
+ */
+#define FABRIC_ADVISE_NORMAL 0
+#define FABRIC_ADVISE_SEQUENTIAL 1
+#define FABRIC_ADVISE_RANDOM 2
+#define FABRIC_ADVISE_WILLNEED 3
+
+/**
+ * Edge directions for adjacency iteration
+ */
+#define FABRIC_DIRECTION_OUT 1
+#define FABRIC_DIRECTION_IN 2
+
+/**
+ * Vertex orders for compactions
+ */
+#define FABRIC_COMPACT_BY_ID 0
+#define FABRIC_COMPACT_BY_CLASS 1
+#define FABRIC_COMPACT_BREADTH_FIRST 2
+
+/* The number of buckets in a class's histogram of degrees */
+#define FABRIC_DEGREE_BUCKETS 32
+
+/* The depth of a vertex a traversal didn't reach */
+#define FABRIC_TRAVERSAL_UNREACHED UINT32_MAX
 
 /**
  * Ids of preset indices
@@ -45,6 +211,81 @@ typedef uint32_t error_t;
 #define FABRIC_LABEL_INDEX 2
 #define FABRIC_EDGE_INDEX 3
 
+/**
+ * Value types of property columns
+ */
+#define FABRIC_COLUMN_INTEGER 1
+#define FABRIC_COLUMN_REAL 2
+#define FABRIC_COLUMN_BOOLEAN 3
+
+/**
+ * Predicate operators
+ */
+#define FABRIC_PREDICATE_EQUAL 1
+#define FABRIC_PREDICATE_LESS 2
+#define FABRIC_PREDICATE_LESS_EQUAL 3
+#define FABRIC_PREDICATE_GREATER 4
+#define FABRIC_PREDICATE_GREATER_EQUAL 5
+
+/**
+ * Kernels that evaluate predicates
+ */
+#define FABRIC_PREDICATE_KERNEL_SCALAR 0
+#define FABRIC_PREDICATE_KERNEL_SSE4 1
+#define FABRIC_PREDICATE_KERNEL_AVX2 2
+
+/**
+ * Byte orders of a graph file's bulk arrays; records are always big endian
+ */
+#define FABRIC_BYTE_ORDER_BIG_ENDIAN 0
+#define FABRIC_BYTE_ORDER_LITTLE_ENDIAN 1
+#if BYTE_ORDER == BIG_ENDIAN
+#  define FABRIC_BYTE_ORDER_HOST FABRIC_BYTE_ORDER_BIG_ENDIAN
+#else
+#  define FABRIC_BYTE_ORDER_HOST FABRIC_BYTE_ORDER_LITTLE_ENDIAN
+#endif
+
+/**
+ * Kernels that swap the bytes of arrays
+ */
+#define FABRIC_BYTESWAP_KERNEL_SCALAR 0
+#define FABRIC_BYTESWAP_KERNEL_SSSE3 1
+#define FABRIC_BYTESWAP_KERNEL_AVX2 2
+
+/**
+ * The stores statistics are kept for
+ */
+#define FABRIC_STATS_CLASS_STORE 0
+#define FABRIC_STATS_LABEL_STORE 1
+#define FABRIC_STATS_VERTEX_STORE 2
+#define FABRIC_STATS_EDGE_STORE 3
+#define FABRIC_STATS_PROPERTY_STORE 4
+#define FABRIC_STATS_TEXT_STORE 5
+#define FABRIC_STATS_INDEX_STORE 6
+#define FABRIC_STATS_NUM_STORES 7
+
+/**
+ * Hot path counters; the per store counters are indexed by adding one of
+ * the FABRIC_STATS_*_STORE values
+ */
+#define FABRIC_STAT_READ_BYTES_CALLS 0
+#define FABRIC_STAT_WRITE_BYTES_CALLS 1
+#define FABRIC_STAT_BYTES_READ 2
+#define FABRIC_STAT_BYTES_WRITTEN 3
+#define FABRIC_STAT_SEEKS 4
+#define FABRIC_STAT_GRAPH_FLUSHES 5
+#define FABRIC_STAT_GRAPH_FLUSH_NANOS 6
+#define FABRIC_STAT_IDSET_LOOKUPS 7
+#define FABRIC_STAT_IDSET_PROBES 8
+#define FABRIC_STAT_IDSET_RESIZES 9
+#define FABRIC_STAT_ENTITYMAP_LOOKUPS 10
+#define FABRIC_STAT_ENTITYMAP_PROBES 11
+#define FABRIC_STAT_ENTITYMAP_RESIZES 12
+#define FABRIC_STAT_RECORDS_READ 13
+#define FABRIC_STAT_RECORDS_WRITTEN (FABRIC_STAT_RECORDS_READ + FABRIC_STATS_NUM_STORES)
+#define FABRIC_STAT_FLUSHES (FABRIC_STAT_RECORDS_WRITTEN + FABRIC_STATS_NUM_STORES)
+#define FABRIC_STAT_FLUSH_NANOS (FABRIC_STAT_FLUSHES + FABRIC_STATS_NUM_STORES)
+#define FABRIC_STAT_NUM_COUNTERS (FABRIC_STAT_FLUSH_NANOS + FABRIC_STATS_NUM_STORES)
 
 /**
  * Temporary macros
@@ -61,6 +302,14 @@ typedef uint32_t error_t;
 #ifndef FABRIC_TEXT_BLOCK_SIZE
 #  define FABRIC_TEXT_BLOCK_SIZE 32
 #endif
+/* Texts at least this long are compressed if it saves space; 0 for never */
+#ifndef FABRIC_TEXT_COMPRESSION_THRESHOLD
+#  define FABRIC_TEXT_COMPRESSION_THRESHOLD 512
+#endif
+/* A compressed text's header also holds the size of its value */
+#define FABRIC_TEXT_HEADER_SIZE 8
+/* The bit of a text's stored size that marks it as compressed */
+#define FABRIC_TEXT_COMPRESSED 0x80000000
 
 /**
  * Booleans
@@ -97,6 +346,20 @@ struct Index;
 typedef struct Index Index;
 struct ClassIndex;
 typedef struct ClassIndex ClassIndex;
+struct LabelIndex;
+typedef struct LabelIndex LabelIndex;
+struct PropertyIndex;
+typedef struct PropertyIndex PropertyIndex;
+struct PropertyIndexDirectory;
+typedef struct PropertyIndexDirectory PropertyIndexDirectory;
+struct PropertyIndexCursor;
+typedef struct PropertyIndexCursor PropertyIndexCursor;
+struct PropertyColumn;
+typedef struct PropertyColumn PropertyColumn;
+struct PropertyColumnDirectory;
+typedef struct PropertyColumnDirectory PropertyColumnDirectory;
+struct Predicate;
+typedef struct Predicate Predicate;
 
 /**
  * Storage manager structs
@@ -111,11 +374,81 @@ struct EdgeStore;
 typedef struct EdgeStore EdgeStore;
 struct PropertyStore;
 typedef struct PropertyStore PropertyStore;
+struct PropertyChange;
+typedef struct PropertyChange PropertyChange;
+struct PropertyDirectory;
+typedef struct PropertyDirectory PropertyDirectory;
 struct TextStore;
 typedef struct TextStore TextStore;
 struct IndexStore;
 typedef struct IndexStore IndexStore;
 
+/**
+ * I/O structs
+ */
+struct BufferPool;
+typedef struct BufferPool BufferPool;
+struct FileMapping;
+typedef struct FileMapping FileMapping;
+struct Wal;
+typedef struct Wal Wal;
+struct ExtentList;
+typedef struct ExtentList ExtentList;
+struct FreeIdMap;
+typedef struct FreeIdMap FreeIdMap;
+struct EntityView;
+typedef struct EntityView EntityView;
+struct BulkLoad;
+typedef struct BulkLoad BulkLoad;
+struct Compaction;
+typedef struct Compaction Compaction;
+struct SnapshotManager;
+typedef struct SnapshotManager SnapshotManager;
+struct Snapshot;
+typedef struct Snapshot Snapshot;
+struct WriteBatch;
+typedef struct WriteBatch WriteBatch;
+
+/**
+ * Iterator types
+ */
+struct EdgeIterator;
+typedef struct EdgeIterator EdgeIterator;
+struct ClassIterator;
+typedef struct ClassIterator ClassIterator;
+struct PropertyIterator;
+typedef struct PropertyIterator PropertyIterator;
+struct AdjacencySnapshot;
+typedef struct AdjacencySnapshot AdjacencySnapshot;
+struct LabelPartitionDirectory;
+typedef struct LabelPartitionDirectory LabelPartitionDirectory;
+struct DegreeCounts;
+typedef struct DegreeCounts DegreeCounts;
+struct TraversalPool;
+typedef struct TraversalPool TraversalPool;
+
+/**
+ * Statistics structs
+ */
+struct GraphStoreStats;
+typedef struct GraphStoreStats GraphStoreStats;
+struct GraphStats;
+typedef struct GraphStats GraphStats;
+
+/**
+ * Memory types
+ */
+struct MemSlab;
+typedef struct MemSlab MemSlab;
+/* Static initializer for the slab of a type; must follow the type's definition */
+#ifdef FABRIC_NO_THREADS
+#  define FABRIC_MEMSLAB_INITIALIZER(type) {sizeof(type), 0, NULL, NULL, 0}
+#else
+#  define FABRIC_MEMSLAB_INITIALIZER(type) {sizeof(type), 0, NULL, NULL, 0, PTHREAD_MUTEX_INITIALIZER}
+#endif
+struct MemArena;
+typedef struct MemArena MemArena;
+
 /**
  * Collection types
  */
@@ -125,6 +458,14 @@ struct IdSet;
 typedef struct IdSet IdSet;
 struct EntityMap;
 typedef struct EntityMap EntityMap;
+struct EntityCache;
+typedef struct EntityCache EntityCache;
+
+/**
+ * Entity cache replacement policies
+ */
+#define FABRIC_CACHE_POLICY_CLOCK 0
+#define FABRIC_CACHE_POLICY_LRU 1
 
 /**
  * Id size typedefs
@@ -141,24 +482,227 @@ typedef uint16_t indexid_t;
 /**
  * Memory functions
  */
+/* Tags for the subsystems memory usage is counted against */
+#define FABRIC_MEM_GENERAL 0
+#define FABRIC_MEM_CACHE 1
+#define FABRIC_MEM_INDEX 2
+#define FABRIC_MEM_TEXT 3
+#define FABRIC_MEM_LIST 4
+#define FABRIC_MEM_IO 5
+#define FABRIC_MEM_NUM_TAGS 6
 int Fabric_meminit();
 void *Fabric_memalloc(size_t size);
+void *Fabric_memalloc_tagged(size_t size, int tag);
+void *Fabric_memrealloc(void *old_ptr, size_t new_size, size_t old_size);
+void *Fabric_memrealloc_tagged(void *old_ptr, size_t new_size, size_t old_size, int tag);
 void Fabric_memfree(void* ptr, size_t size);
+void Fabric_memfree_tagged(void *ptr, size_t size, int tag);
 size_t Fabric_memused();
+size_t Fabric_memused_tagged(int tag);
 int Fabric_memerrno();
+void Fabric_memset_budget(size_t budget);
+size_t Fabric_memget_budget();
+bool_t Fabric_memis_over_budget();
+uint32_t Fabric_mempressure();
+void *Fabric_memslab_alloc(MemSlab *slab);
+void Fabric_memslab_free(MemSlab *slab, void *ptr);
+void Fabric_memslab_release(MemSlab *slab);
+size_t Fabric_memreserved();
+void Fabric_memarena_init(MemArena *arena, size_t chunk_size, int tag);
+void *Fabric_memarena_alloc(MemArena *arena, size_t size);
+void Fabric_memarena_release(MemArena *arena);
+
+/**
+ * Statistics functions
+ */
+void Fabric_stats_read(uint64_t *values);
+void Fabric_stats_reset();
+
+/**
+ * Compression functions
+ */
+uint32_t Fabric_Compression_bound(uint32_t size);
+uint32_t Fabric_Compression_compress(const uint8_t *source, uint32_t size, uint8_t *destination, uint32_t capacity);
+bool_t Fabric_Compression_decompress(const uint8_t *source, uint32_t size, uint8_t *destination, uint32_t original_size);
+
+/**
+ * Byte swapping functions
+ */
+int Fabric_ByteSwap_get_kernel();
+void Fabric_ByteSwap_copy32(void *destination, const void *source, uint32_t count, int byte_order);
+void Fabric_ByteSwap_copy64(void *destination, const void *source, uint32_t count, int byte_order);
+
+/**
+ * Buffer pool methods
+ */
+error_t Fabric_BufferPool_init(BufferPool *self, FILE *file, uint32_t page_size, int num_frames);
+void Fabric_BufferPool_deinit(BufferPool *self);
+uint8_t *Fabric_BufferPool_pin(BufferPool *self, uint32_t page_no, error_t *status);
+void Fabric_BufferPool_unpin(BufferPool *self, uint32_t page_no, bool_t dirty);
+error_t Fabric_BufferPool_prefetch(BufferPool *self, uint32_t offset, size_t length);
+error_t Fabric_BufferPool_flush(BufferPool *self);
+error_t Fabric_BufferPool_flush_some(BufferPool *self, int max_pages, int *num_written);
+void Fabric_BufferPool_set_lsn(BufferPool *self, uint64_t lsn);
+void Fabric_BufferPool_set_commit_lsn(BufferPool *self, uint64_t lsn);
+uint64_t Fabric_BufferPool_get_oldest_lsn(BufferPool *self);
+int Fabric_BufferPool_get_dirty_count(BufferPool *self);
+error_t Fabric_BufferPool_read(BufferPool *self, uint8_t *destination, size_t num_bytes, uint32_t offset);
+error_t Fabric_BufferPool_write(BufferPool *self, uint8_t *source, size_t num_bytes, uint32_t offset);
+uint64_t Fabric_BufferPool_get_bytes_read(BufferPool *self);
+uint64_t Fabric_BufferPool_get_bytes_written(BufferPool *self);
+uint64_t Fabric_BufferPool_get_hits(BufferPool *self);
+uint64_t Fabric_BufferPool_get_misses(BufferPool *self);
+
+/**
+ * File mapping methods
+ */
+error_t Fabric_FileMapping_init(FileMapping *self, FILE *file);
+void Fabric_FileMapping_deinit(FileMapping *self);
+error_t Fabric_FileMapping_ensure_size(FileMapping *self, size_t min_size);
+error_t Fabric_FileMapping_sync(FileMapping *self);
+error_t Fabric_FileMapping_advise(FileMapping *self, size_t offset, size_t length, int advice);
+void Fabric_FileMapping_read(FileMapping *self, uint8_t *destination, size_t num_bytes, size_t offset);
+error_t Fabric_FileMapping_write(FileMapping *self, uint8_t *source, size_t num_bytes, size_t offset);
+
+/**
+ * Write-ahead log methods
+ */
+/**
+ * Applies a write replayed from a log to its target
+ */
+typedef error_t (*Fabric_WalApplier)(void *target, uint8_t *bytes, uint32_t num_bytes, uint32_t offset);
+error_t Fabric_Wal_init(Wal *self, FILE *file);
+void Fabric_Wal_deinit(Wal *self);
+error_t Fabric_Wal_append(Wal *self, uint8_t *bytes, uint32_t num_bytes, uint32_t offset);
+error_t Fabric_Wal_commit(Wal *self);
+size_t Fabric_Wal_get_size(Wal *self);
+uint64_t Fabric_Wal_get_lsn(Wal *self);
+uint64_t Fabric_Wal_get_commit_lsn(Wal *self);
+error_t Fabric_Wal_checkpoint(Wal *self, uint64_t redo_lsn);
+error_t Fabric_Wal_recover(Wal *self, Fabric_WalApplier apply, void *target);
+error_t Fabric_Wal_truncate(Wal *self);
+
+/**
+ * Extent list methods
+ */
+void Fabric_ExtentList_init(ExtentList *self, uint32_t header_size, uint32_t record_size);
+error_t Fabric_ExtentList_add(ExtentList *self, uint32_t offset, uint32_t size);
+int Fabric_ExtentList_find(ExtentList *self, uint32_t id);
+uint32_t Fabric_ExtentList_get_record_offset(ExtentList *self, uint32_t id);
+uint32_t Fabric_ExtentList_get_contiguous(ExtentList *self, uint32_t id);
+uint32_t Fabric_ExtentList_get_header_offset(ExtentList *self);
+uint32_t Fabric_ExtentList_get_size(ExtentList *self);
+uint32_t Fabric_ExtentList_get_next_size(ExtentList *self);
+
+/**
+ * Free id map methods
+ */
+void Fabric_FreeIdMap_init(FreeIdMap *self);
+void Fabric_FreeIdMap_deinit(FreeIdMap *self);
+error_t Fabric_FreeIdMap_add(FreeIdMap *self, uint32_t id);
+bool_t Fabric_FreeIdMap_has(FreeIdMap *self, uint32_t id);
+bool_t Fabric_FreeIdMap_remove(FreeIdMap *self, uint32_t id);
+uint32_t Fabric_FreeIdMap_get_count(FreeIdMap *self);
+bool_t Fabric_FreeIdMap_is_changed(FreeIdMap *self);
+uint32_t Fabric_FreeIdMap_take(FreeIdMap *self);
+uint32_t Fabric_FreeIdMap_take_run(FreeIdMap *self, uint32_t count);
+error_t Fabric_FreeIdMap_save(FreeIdMap *self, Graph *graph, int store);
+error_t Fabric_FreeIdMap_load(FreeIdMap *self, Graph *graph, int store, uint32_t last_id);
+error_t Fabric_FreeIdMap_load_list(
+    FreeIdMap *self,
+    Graph *graph,
+    ExtentList *extents,
+    uint32_t first_id,
+    uint32_t last_id,
+    uint32_t link_offset,
+    int link_size);
+
+/**
+ * Entity view methods
+ */
+void Fabric_EntityView_init(EntityView *self);
+error_t Fabric_EntityView_open(EntityView *self, Graph *graph, uint32_t num_bytes, uint32_t offset);
+uint8_t *Fabric_EntityView_copy(EntityView *self);
+uint8_t *Fabric_EntityView_get_data(EntityView *self);
+void Fabric_EntityView_release(EntityView *self);
+
+/**
+ * Snapshot methods
+ */
+SnapshotManager *Fabric_SnapshotManager_new(BufferPool *pool, error_t *status);
+void Fabric_SnapshotManager_destroy(SnapshotManager *self);
+void Fabric_SnapshotManager_lock(SnapshotManager *self);
+void Fabric_SnapshotManager_unlock(SnapshotManager *self);
+error_t Fabric_SnapshotManager_capture(SnapshotManager *self, uint32_t offset, uint32_t num_bytes);
+void Fabric_SnapshotManager_publish(SnapshotManager *self);
+uint32_t Fabric_SnapshotManager_get_num_versions(SnapshotManager *self);
+error_t Fabric_Snapshot_begin(Snapshot *self, Graph *graph);
+void Fabric_Snapshot_end(Snapshot *self);
+uint32_t Fabric_Snapshot_get_epoch(Snapshot *self);
+error_t Fabric_Snapshot_read_bytes(Snapshot *self, uint8_t *destination, uint32_t num_bytes, uint32_t offset);
+error_t Fabric_Snapshot_read_vertex(Snapshot *self, vertexid_t vertex_id, Vertex *vertex);
+error_t Fabric_Snapshot_read_edge(Snapshot *self, edgeid_t edge_id, Edge *edge);
+
+/**
+ * Write batch methods
+ */
+error_t Fabric_WriteBatch_begin(WriteBatch *self, Graph *graph);
+error_t Fabric_WriteBatch_capture(WriteBatch *self, uint32_t offset, uint32_t num_bytes);
+uint32_t Fabric_WriteBatch_get_page_count(WriteBatch *self);
+error_t Fabric_WriteBatch_commit(WriteBatch *self);
+error_t Fabric_WriteBatch_abort(WriteBatch *self);
 
 /**
  * Graph write methods
  */
-void Fabric_Graph_write_bytes (Graph *self, uint8_t *bytes, int num_bytes, long offset);
+error_t Fabric_Graph_write_bytes (Graph *self, uint8_t *bytes, int num_bytes, long offset);
 void Fabric_Graph_write_uint32 (Graph *self, uint32_t value, long offset);
+void Fabric_Graph_write_uint16 (Graph *self, uint16_t value, long offset);
+error_t Fabric_Graph_flush (Graph *self);
+error_t Fabric_Graph_commit (Graph *self);
+error_t Fabric_Graph_checkpoint (Graph *self);
+error_t Fabric_Graph_checkpoint_step (Graph *self, int max_pages);
+void Fabric_Graph_update_uint32 (Graph *self, uint32_t value, long offset);
+void Fabric_Graph_update_uint16 (Graph *self, uint16_t value, long offset);
+
+/**
+ * Serializes the record with the given id from a store into destination
+ */
+typedef void (*Fabric_RecordSerializer)(void *store, uint32_t id, uint8_t *destination);
+error_t Fabric_Graph_write_records (
+    Graph *self,
+    uint32_t *ids,
+    int num_ids,
+    ExtentList *extents,
+    Fabric_RecordSerializer serialize,
+    void *store);
+error_t Fabric_Graph_read_records (
+    Graph *self,
+    const uint32_t *ids,
+    uint32_t num_ids,
+    ExtentList *extents,
+    uint8_t *destination);
+void Fabric_Graph_create_directory (Graph *self);
+uint32_t Fabric_Graph_allocate (Graph *self, uint32_t size, error_t *status);
+error_t Fabric_Graph_grow_store (Graph *self, int store, uint32_t min_capacity);
+ExtentList *Fabric_Graph_get_store_extents (Graph *self, int store);
+error_t Fabric_Graph_advise_store (Graph *self, int store, int advice);
+error_t Fabric_Graph_prefetch (Graph *self, long offset, size_t length);
+error_t Fabric_Graph_enable_snapshots (Graph *self);
+error_t Fabric_Graph_flush_stores (Graph *self);
+error_t Fabric_Graph_publish (Graph *self);
+error_t Fabric_Graph_reload (Graph *self);
+void Fabric_Graph_reclaim_memory (Graph *self);
 
 /**
  * Graph read methods
  */
-void Fabric_Graph_read_bytes (Graph *self, uint8_t *destination, int num_bytes, long offset);
+error_t Fabric_Graph_read_bytes (Graph *self, uint8_t *destination, int num_bytes, long offset);
 uint32_t Fabric_Graph_read_uint32 (Graph *self, long offset);
 uint16_t Fabric_Graph_read_uint16 (Graph *self, long offset);
+error_t Fabric_Graph_read_store_header(Graph *self, uint8_t *destination, int num_bytes, long offset);
+uint8_t *Fabric_Graph_pin_bytes (Graph *self, uint32_t num_bytes, uint32_t offset, uint32_t *page_no, error_t *status);
+void Fabric_Graph_unpin_bytes (Graph *self, uint32_t page_no);
 
 /**
  * Graph retrieval methods
@@ -181,6 +725,16 @@ EdgeStore *Fabric_Graph_get_edge_store(Graph *self);
 PropertyStore *Fabric_Graph_get_property_store(Graph *self);
 TextStore *Fabric_Graph_get_text_store(Graph *self);
 IndexStore *Fabric_Graph_get_index_store(Graph *self);
+uint32_t Fabric_Graph_get_adjacency_snapshot_offset(Graph *self);
+uint32_t Fabric_Graph_get_free_id_directory_offset(Graph *self);
+int Fabric_Graph_get_byte_order(Graph *self);
+void Fabric_Graph_get_stats(Graph *self, GraphStats *stats);
+void Fabric_Graph_set_adjacency_snapshot_offset(Graph *self, uint32_t offset);
+void Fabric_Graph_set_free_id_directory_offset(Graph *self, uint32_t offset);
+SnapshotManager *Fabric_Graph_get_snapshot_manager(Graph *self);
+WriteBatch *Fabric_Graph_get_write_batch(Graph *self);
+void Fabric_Graph_set_write_batch(Graph *self, WriteBatch *batch);
+void Fabric_Graph_set_index_page_count(Graph *self, uint32_t page_count);
 
 /**
  * Graph file offsets
@@ -198,6 +752,7 @@ uint32_t Fabric_Graph_get_index_store_offset(Graph* self);
  */
 error_t Fabric_ClassStore_init(ClassStore *self);
 error_t Fabric_ClassStore_flush(ClassStore *self);
+void Fabric_ClassStore_deinit(ClassStore *self);
 Class *Fabric_ClassStore_get_class(ClassStore *self, classid_t class_id, error_t *status);
 Class *Fabric_ClassStore_get_class_by_name(ClassStore *self, text_t name, error_t *status);
 Class *Fabric_ClassStore_create_class(
@@ -207,43 +762,249 @@ Class *Fabric_ClassStore_create_class(
     bool_t is_abstract,
     error_t *status);
 error_t Fabric_ClassStore_delete_class(ClassStore *self, Class *c);
+error_t Fabric_ClassStore_update_class(ClassStore *self, Class *c);
+error_t Fabric_ClassStore_read_class(ClassStore *self, classid_t class_id, Class *c);
+error_t Fabric_ClassStore_view_class(ClassStore *self, classid_t class_id, EntityView *view);
+bool_t Fabric_ClassStore_is_subclass(ClassStore *self, classid_t class_id, classid_t ancestor_id, error_t *status);
+uint32_t Fabric_ClassStore_get_total_count(ClassStore *self, classid_t class_id, error_t *status);
+classid_t Fabric_ClassStore_get_descendent_class_id(ClassStore *self, classid_t class_id, uint32_t position, error_t *status);
+error_t Fabric_ClassStore_add_to_count(ClassStore *self, Class *c, int32_t change);
+error_t Fabric_ClassStore_load_descendent_classes(ClassStore *self, classid_t class_id, DynamicList *list);
+Class *Fabric_ClassStore_get_listed_class(ClassStore *self, DynamicList *list, int position, error_t *status);
 
 /**
  * LabelStore methods
  */
 Label *Fabric_LabelStore_get_label(LabelStore *self, labelid_t label_id, error_t *status);
+Label *Fabric_LabelStore_get_label_by_name(LabelStore *self, text_t name, error_t *status);
 labelid_t Fabric_LabelStore_add_label(LabelStore *self, text_t name, error_t *status);
+text_t Fabric_LabelStore_get_label_name(LabelStore *self, labelid_t label_id, error_t *status);
 error_t Fabric_LabelStore_remove_label(LabelStore *self, labelid_t label_id);
+void Fabric_LabelStore_deinit(LabelStore *self);
 
 /**
  * VertexStore methods
  */
-Vertex *Fabric_VertexStore_get_vertex(VertexStore *self, edgeid_t edge_id, error_t *status);
+error_t Fabric_VertexStore_init(VertexStore *self);
+void Fabric_VertexStore_deinit(VertexStore *self);
+error_t Fabric_VertexStore_flush(VertexStore *self);
+Vertex *Fabric_VertexStore_get_vertex(VertexStore *self, vertexid_t vertex_id, error_t *status);
+Vertex *Fabric_VertexStore_create_vertex(VertexStore *self, Class *c, error_t *status);
+vertexid_t Fabric_VertexStore_create_vertices(VertexStore *self, Class *c, uint32_t count, error_t *status);
+error_t Fabric_VertexStore_update_vertex(VertexStore *self, Vertex *vertex);
+error_t Fabric_VertexStore_view_vertex(VertexStore *self, vertexid_t vertex_id, EntityView *view);
+error_t Fabric_VertexStore_read_vertices(VertexStore *self, const vertexid_t *vertex_ids, uint32_t count, Vertex *vertices);
 
 /**
  * EdgeStore methods
  */
+error_t Fabric_EdgeStore_init(EdgeStore *self);
+void Fabric_EdgeStore_deinit(EdgeStore *self);
+error_t Fabric_EdgeStore_flush(EdgeStore *self);
 Edge *Fabric_EdgeStore_get_edge(EdgeStore *self, edgeid_t edge_id, error_t *status);
+Edge *Fabric_EdgeStore_create_edge(
+    EdgeStore *self,
+    labelid_t label_id,
+    Vertex *from,
+    Vertex *to,
+    error_t *status);
+error_t Fabric_EdgeStore_read_edge(EdgeStore *self, edgeid_t edge_id, Edge *edge);
+error_t Fabric_EdgeStore_read_edges(EdgeStore *self, const edgeid_t *edge_ids, uint32_t count, Edge *edges);
+error_t Fabric_EdgeStore_view_edge(EdgeStore *self, edgeid_t edge_id, EntityView *view);
+error_t Fabric_EdgeStore_update_edge(EdgeStore *self, Edge *edge);
+LabelPartitionDirectory *Fabric_EdgeStore_get_label_partitions(EdgeStore *self, error_t *status);
+error_t Fabric_EdgeStore_partition_by_label(EdgeStore *self, Vertex *vertex, int direction);
+DegreeCounts *Fabric_EdgeStore_get_degree_counts(EdgeStore *self, error_t *status);
+
+/**
+ * EdgeIterator methods
+ */
+void Fabric_EdgeIterator_init(EdgeIterator *self, Graph *graph, Vertex *vertex, int direction);
+error_t Fabric_EdgeIterator_init_with_label(EdgeIterator *self, Graph *graph, Vertex *vertex, int direction, labelid_t label_id);
+Edge *Fabric_EdgeIterator_next(EdgeIterator *self, error_t *status);
+error_t Fabric_EdgeIterator_prefetch_frontier(Graph *graph, const vertexid_t *vertex_ids, uint32_t count, int direction);
+
+/**
+ * ClassIterator methods
+ */
+void Fabric_ClassIterator_init_children(ClassIterator *self, Graph *graph, Class *c);
+void Fabric_ClassIterator_init_descendents(ClassIterator *self, Graph *graph, Class *c);
+Class *Fabric_ClassIterator_next(ClassIterator *self, error_t *status);
+
+/**
+ * LabelPartitionDirectory methods
+ */
+LabelPartitionDirectory *Fabric_LabelPartitionDirectory_load(EdgeStore *store, error_t *status);
+void Fabric_LabelPartitionDirectory_destroy(LabelPartitionDirectory *self);
+uint32_t Fabric_LabelPartitionDirectory_get_count(LabelPartitionDirectory *self);
+bool_t Fabric_LabelPartitionDirectory_is_partitioned(LabelPartitionDirectory *self, vertexid_t vertex_id, int direction);
+bool_t Fabric_LabelPartitionDirectory_find_group(
+    LabelPartitionDirectory *self,
+    vertexid_t vertex_id,
+    int direction,
+    labelid_t label_id,
+    edgeid_t *first_id,
+    uint32_t *count);
+error_t Fabric_LabelPartitionDirectory_link_edge(LabelPartitionDirectory *self, Edge *edge, Vertex *vertex, int direction);
+error_t Fabric_LabelPartitionDirectory_unlink_edge(LabelPartitionDirectory *self, Edge *edge, Vertex *vertex, int direction);
+error_t Fabric_LabelPartitionDirectory_partition(LabelPartitionDirectory *self, Vertex *vertex, int direction);
+error_t Fabric_LabelPartitionDirectory_flush(LabelPartitionDirectory *self);
+
+/**
+ * DegreeCounts methods
+ */
+DegreeCounts *Fabric_DegreeCounts_load(EdgeStore *store, error_t *status);
+void Fabric_DegreeCounts_destroy(DegreeCounts *self);
+uint32_t Fabric_DegreeCounts_get_edge_count(DegreeCounts *self);
+uint32_t Fabric_DegreeCounts_get_degree(DegreeCounts *self, vertexid_t vertex_id, int direction);
+uint32_t Fabric_DegreeCounts_get_label_count(DegreeCounts *self, labelid_t label_id);
+void Fabric_DegreeCounts_get_histogram(DegreeCounts *self, classid_t class_id, int direction, uint32_t *buckets);
+bool_t Fabric_DegreeCounts_is_supernode(DegreeCounts *self, vertexid_t vertex_id);
+uint32_t Fabric_DegreeCounts_find_supernodes(DegreeCounts *self, uint32_t min_degree, vertexid_t *vertex_ids, uint32_t max_count);
+error_t Fabric_DegreeCounts_add_edge(
+    DegreeCounts *self,
+    labelid_t label_id,
+    vertexid_t from_id,
+    classid_t from_class_id,
+    vertexid_t to_id,
+    classid_t to_class_id);
+error_t Fabric_DegreeCounts_flush(DegreeCounts *self);
+error_t Fabric_DegreeCounts_drop(Graph *graph);
+
+/**
+ * AdjacencySnapshot methods
+ */
+AdjacencySnapshot *Fabric_AdjacencySnapshot_build(Graph *graph, labelid_t label_id, error_t *status);
+void Fabric_AdjacencySnapshot_destroy(AdjacencySnapshot *self);
+bool_t Fabric_AdjacencySnapshot_is_current(AdjacencySnapshot *self, Graph *graph);
+error_t Fabric_AdjacencySnapshot_refresh(AdjacencySnapshot *self, Graph *graph);
+uint32_t Fabric_AdjacencySnapshot_get_vertex_count(AdjacencySnapshot *self);
+uint32_t Fabric_AdjacencySnapshot_get_degree(AdjacencySnapshot *self, vertexid_t vertex_id, int direction);
+vertexid_t *Fabric_AdjacencySnapshot_get_neighbors(
+    AdjacencySnapshot *self, vertexid_t vertex_id, int direction, uint32_t *count);
+edgeid_t *Fabric_AdjacencySnapshot_get_edge_ids(
+    AdjacencySnapshot *self, vertexid_t vertex_id, int direction, uint32_t *count);
+error_t Fabric_AdjacencySnapshot_save(AdjacencySnapshot *self, Graph *graph);
+AdjacencySnapshot *Fabric_AdjacencySnapshot_load(Graph *graph, error_t *status);
+void Fabric_AdjacencySnapshot_drop(Graph *graph);
+uint32_t Fabric_AdjacencySnapshot_get_saved_size(Graph *graph);
+
+/**
+ * Traversal methods
+ */
+TraversalPool *Fabric_TraversalPool_new(uint32_t num_workers, error_t *status);
+void Fabric_TraversalPool_destroy(TraversalPool *self);
+uint32_t Fabric_TraversalPool_get_worker_count(TraversalPool *self);
+error_t Fabric_Traversal_bfs(
+    TraversalPool *pool,
+    AdjacencySnapshot *snapshot,
+    vertexid_t start_id,
+    int direction,
+    uint32_t max_depth,
+    vertexid_t *vertices,
+    uint32_t *depths,
+    uint32_t *count);
+error_t Fabric_Traversal_k_hop(
+    TraversalPool *pool,
+    AdjacencySnapshot *snapshot,
+    vertexid_t start_id,
+    int direction,
+    uint32_t hops,
+    vertexid_t *vertices,
+    uint32_t *count);
+error_t Fabric_Traversal_connected_components(
+    TraversalPool *pool,
+    AdjacencySnapshot *snapshot,
+    vertexid_t *components,
+    uint32_t *count);
+
+/**
+ * BulkLoad methods
+ */
+error_t Fabric_BulkLoad_begin(BulkLoad *self, Graph *graph);
+error_t Fabric_BulkLoad_add_vertices(BulkLoad *self, classid_t *class_ids, uint32_t count, vertexid_t *first_id);
+error_t Fabric_BulkLoad_add_edges(
+    BulkLoad *self,
+    labelid_t *label_ids,
+    vertexid_t *from_ids,
+    vertexid_t *to_ids,
+    uint32_t count,
+    edgeid_t *first_id);
+error_t Fabric_BulkLoad_finish(BulkLoad *self);
+void Fabric_BulkLoad_abort(BulkLoad *self);
+
+/**
+ * Compaction methods
+ */
+error_t Fabric_Compaction_run(Compaction *self, Graph *graph, int order);
+void Fabric_Compaction_deinit(Compaction *self);
+vertexid_t Fabric_Compaction_get_vertex_id(Compaction *self, vertexid_t old_id);
+edgeid_t Fabric_Compaction_get_edge_id(Compaction *self, edgeid_t old_id);
+propertyid_t Fabric_Compaction_get_property_id(Compaction *self, propertyid_t old_id);
 
 /**
  * PropertyStore methods
  */
+error_t Fabric_PropertyStore_init(PropertyStore *self);
+void Fabric_PropertyStore_deinit(PropertyStore *self);
+error_t Fabric_PropertyStore_flush(PropertyStore *self);
 Property *Fabric_PropertyStore_get_property(PropertyStore *self, propertyid_t property_id, error_t *status);
+error_t Fabric_PropertyStore_read_property(PropertyStore *self, propertyid_t property_id, Property *property);
+error_t Fabric_PropertyStore_read_properties(PropertyStore *self, const propertyid_t *property_ids, uint32_t count, Property *properties);
+error_t Fabric_PropertyStore_update_property(PropertyStore *self, Property *property);
+Property *Fabric_PropertyStore_get_vertex_property(PropertyStore *self, Vertex *vertex, labelid_t label_id, error_t *status);
+error_t Fabric_PropertyStore_set_vertex_property(PropertyStore *self, Vertex *vertex, labelid_t label_id, Property *value);
+error_t Fabric_PropertyStore_remove_vertex_property(PropertyStore *self, Vertex *vertex, labelid_t label_id);
+uint32_t Fabric_PropertyStore_select_properties(
+    PropertyStore *self,
+    Predicate *predicate,
+    labelid_t label_id,
+    propertyid_t first_id,
+    uint32_t count,
+    uint8_t *selection,
+    error_t *status);
+
+/**
+ * PropertyDirectory methods
+ */
+PropertyDirectory *Fabric_PropertyDirectory_build(Graph *graph, Vertex *vertex, error_t *status);
+void Fabric_PropertyDirectory_destroy(PropertyDirectory *self);
+propertyid_t Fabric_PropertyDirectory_find(PropertyDirectory *self, labelid_t label_id);
+error_t Fabric_PropertyDirectory_add(PropertyDirectory *self, labelid_t label_id, propertyid_t property_id);
+void Fabric_PropertyDirectory_remove(PropertyDirectory *self, labelid_t label_id);
+uint32_t Fabric_PropertyDirectory_get_count(PropertyDirectory *self);
 
 /**
  * TextStore methods
  */
 Text *Fabric_TextStore_get_text(TextStore *self, textid_t text_id, error_t *status);
 textid_t Fabric_TextStore_create_text(TextStore *self, text_t value, error_t *status);
+text_t Fabric_TextStore_read_text(TextStore *self, textid_t text_id, MemArena *arena, uint32_t *size, error_t *status);
+error_t Fabric_TextStore_delete_text(TextStore *self, textid_t text_id);
 
 /**
  * IndexStore methods
  */
 Index *Fabric_IndexStore_get_index(IndexStore *self, indexid_t index_id, error_t *status);
 ClassIndex *Fabric_IndexStore_get_class_index(IndexStore *self, error_t *status);
-error_t Fabric_IndexStore_add_class_to_index(IndexStore *self, Class *class);
+LabelIndex *Fabric_IndexStore_get_label_index(IndexStore *self, error_t *status);
+void Fabric_IndexStore_deinit(IndexStore *self);
+uint32_t Fabric_IndexStore_get_page_count(IndexStore *self);
+uint32_t Fabric_IndexStore_get_page_offset(IndexStore *self, uint32_t page_id);
+uint32_t Fabric_IndexStore_allocate_page(IndexStore *self, error_t *status);
+error_t Fabric_IndexStore_add_class_to_index(IndexStore *self, Class *class, text_t name);
 error_t Fabric_IndexStore_add_class_to_index_if_not_exists(IndexStore *self, Class *class);
 error_t Fabric_IndexStore_remove_class_from_index(IndexStore *self, Class *class);
+error_t Fabric_IndexStore_add_label_to_index(IndexStore *self, Label *label, text_t name);
+error_t Fabric_IndexStore_reserve_root_pages(IndexStore *self);
+PropertyIndex *Fabric_IndexStore_get_property_index(IndexStore *self, classid_t class_id, labelid_t label_id, error_t *status);
+PropertyIndex *Fabric_IndexStore_create_property_index(IndexStore *self, classid_t class_id, labelid_t label_id, error_t *status);
+bool_t Fabric_IndexStore_tracks_property(IndexStore *self, classid_t class_id, labelid_t label_id, error_t *status);
+bool_t Fabric_IndexStore_has_property_indexes(IndexStore *self, error_t *status);
+error_t Fabric_IndexStore_apply_property_change(IndexStore *self, PropertyChange *change);
+PropertyColumn *Fabric_IndexStore_get_property_column(IndexStore *self, classid_t class_id, labelid_t label_id, error_t *status);
+PropertyColumn *Fabric_IndexStore_create_property_column(IndexStore *self, classid_t class_id, labelid_t label_id, uint8_t type, error_t *status);
+error_t Fabric_IndexStore_flush_property_columns(IndexStore *self);
 indexid_t Fabric_IndexStore_create_id_index(IndexStore *self, classid_t class_id, error_t *status);
 error_t Fabric_IndexStore_delete_id_index(IndexStore *self, indexid_t index_id);
 
@@ -281,10 +1042,18 @@ uint32_t Fabric_Class_get_count(Class *self);
 void Fabric_Class_set_count(Class *self, uint32_t count);
 bool_t Fabric_Class_has_members(Class *self);
 uint32_t Fabric_Class_get_total_count(Class *self, Graph *graph, error_t *status);
+bool_t Fabric_Class_is_subclass_of(Class *self, Class *ancestor, Graph *graph, error_t *status);
 bool_t Fabric_Class_is_abstract(Class *self);
 void Fabric_Class_set_is_abstract(Class *self, bool_t is_abstract);
 uint32_t Fabric_Class_increment(Class *self);
 void Fabric_Class_set_incrementer(Class *self, uint32_t value);
+labelid_t Fabric_ClassView_get_label_id(EntityView *view);
+bool_t Fabric_ClassView_is_in_use(EntityView *view);
+classid_t Fabric_ClassView_get_parent_class_id(EntityView *view);
+classid_t Fabric_ClassView_get_first_child_class_id(EntityView *view);
+classid_t Fabric_ClassView_get_next_child_class_id(EntityView *view);
+uint32_t Fabric_ClassView_get_count(EntityView *view);
+bool_t Fabric_ClassView_is_abstract(EntityView *view);
 
 /**
  * Label methods
@@ -294,6 +1063,8 @@ void Fabric_Label_set_id(Label *self, labelid_t id);
 Label* Fabric_Label_new(labelid_t id, error_t *status);
 void Fabric_Label_destroy(Label *self);
 error_t Fabric_Label_init(Label *self, uint8_t *data);
+void Fabric_Label_load_bytes(Label *self, uint8_t *dest);
+bool_t Fabric_Label_is_in_use(Label *self);
 textid_t Fabric_Label_get_text_id(Label *self);
 void Fabric_Label_set_text_id(Label *self, textid_t text_id);
 Text *Fabric_Label_get_text(Label *self, Graph *graph, error_t *status);
@@ -308,47 +1079,85 @@ void Fabric_Label_remove_ref(Label *self);
  */
 vertexid_t Fabric_Vertex_get_id(Vertex *self);
 void Fabric_Vertex_set_id(Vertex *self, vertexid_t id);
+Vertex *Fabric_Vertex_new(vertexid_t id, error_t *status);
+void Fabric_Vertex_destroy(Vertex *self);
 error_t Fabric_Vertex_init(Vertex *self, uint8_t *data);
+void Fabric_Vertex_load_bytes(Vertex *self, uint8_t *dest);
+bool_t Fabric_Vertex_is_in_use(Vertex *self);
 classid_t Fabric_Vertex_get_class_id(Vertex *self);
+void Fabric_Vertex_set_class_id(Vertex *self, classid_t class_id);
 Class *Fabric_Vertex_get_class(Vertex *self, Graph *graph, error_t *status);
 edgeid_t Fabric_Vertex_get_first_out_edge_id(Vertex *self);
+void Fabric_Vertex_set_first_out_edge_id(Vertex *self, edgeid_t edge_id);
 bool_t Fabric_Vertex_has_out_edges(Vertex *self);
 Edge *Fabric_Vertex_get_first_out_edge(Vertex *self, Graph *graph, error_t *status);
 edgeid_t Fabric_Vertex_get_first_in_edge_id(Vertex *self);
+void Fabric_Vertex_set_first_in_edge_id(Vertex *self, edgeid_t edge_id);
 bool_t Fabric_Vertex_has_in_edges(Vertex *self);
 Edge *Fabric_Vertex_get_first_in_edge(Vertex *self, Graph *graph, error_t *status);
 propertyid_t Fabric_Vertex_get_first_property_id(Vertex *self);
+void Fabric_Vertex_set_first_property_id(Vertex *self, propertyid_t property_id);
 Property *Fabric_Vertex_get_first_property(Vertex *self, Graph *graph, error_t *status);
 bool_t Fabric_Vertex_has_properties(Vertex *self);
+classid_t Fabric_VertexView_get_class_id(EntityView *view);
+bool_t Fabric_VertexView_is_in_use(EntityView *view);
+edgeid_t Fabric_VertexView_get_first_out_edge_id(EntityView *view);
+edgeid_t Fabric_VertexView_get_first_in_edge_id(EntityView *view);
+propertyid_t Fabric_VertexView_get_first_property_id(EntityView *view);
 
 /**
  * Edge methods
  */
+Edge *Fabric_Edge_new(edgeid_t id, error_t *status);
+void Fabric_Edge_destroy(Edge *self);
+edgeid_t Fabric_Edge_get_id(Edge *self);
+void Fabric_Edge_set_id(Edge *self, edgeid_t id);
+int Fabric_Edge_init(Edge *self, uint8_t *data);
+void Fabric_Edge_load_bytes(Edge *self, uint8_t *dest);
+bool_t Fabric_Edge_is_in_use(Edge *self);
 labelid_t Fabric_Edge_get_label_id(Edge *self);
+void Fabric_Edge_set_label_id(Edge *self, labelid_t label_id);
 Label *Fabric_Edge_get_label(Edge *self, Graph *graph, error_t *status);
 vertexid_t Fabric_Edge_get_from_vertex_id(Edge *self);
+void Fabric_Edge_set_from_vertex_id(Edge *self, vertexid_t vertex_id);
 Vertex *Fabric_Edge_get_from_vertex(Edge *self, Graph *graph, error_t *status);
 vertexid_t Fabric_Edge_get_to_vertex_id(Edge *self);
+void Fabric_Edge_set_to_vertex_id(Edge *self, vertexid_t vertex_id);
 Vertex *Fabric_Edge_get_to_vertex(Edge *self, Graph *graph, error_t *status);
 edgeid_t Fabric_Edge_get_next_out_edge_id(Edge *self);
+void Fabric_Edge_set_next_out_edge_id(Edge *self, edgeid_t edge_id);
 Edge *Fabric_Edge_get_next_out_edge(Edge *self, Graph *graph, error_t *status);
 bool_t Fabric_Edge_has_next_out_edge(Edge *self);
 edgeid_t Fabric_Edge_get_next_in_edge_id(Edge *self);
+void Fabric_Edge_set_next_in_edge_id(Edge *self, edgeid_t edge_id);
 Edge *Fabric_Edge_get_next_in_edge(Edge *self, Graph *graph, error_t *status);
 bool_t Fabric_Edge_has_next_in_edge(Edge *self);
 propertyid_t Fabric_Edge_get_first_property_id(Edge *self);
+void Fabric_Edge_set_first_property_id(Edge *self, propertyid_t property_id);
 Property *Fabric_Edge_get_first_property(Edge *self, Graph *graph, error_t *status);
 bool_t Fabric_Edge_has_properties(Edge *self);
+labelid_t Fabric_EdgeView_get_label_id(EntityView *view);
+vertexid_t Fabric_EdgeView_get_from_vertex_id(EntityView *view);
+bool_t Fabric_EdgeView_is_in_use(EntityView *view);
+vertexid_t Fabric_EdgeView_get_to_vertex_id(EntityView *view);
+edgeid_t Fabric_EdgeView_get_next_out_edge_id(EntityView *view);
+edgeid_t Fabric_EdgeView_get_next_in_edge_id(EntityView *view);
+propertyid_t Fabric_EdgeView_get_first_property_id(EntityView *view);
 
 /**
  * Property methods
  */
 propertyid_t Fabric_Property_get_id(Property *self);
 void Fabric_Property_set_id(Property *self, propertyid_t id);
+Property *Fabric_Property_new(propertyid_t id, error_t *status);
+void Fabric_Property_destroy(Property *self);
 error_t Fabric_Property_init(Property *self, uint8_t *data);
+void Fabric_Property_load_bytes(Property *self, uint8_t *dest);
 labelid_t Fabric_Property_get_label_id(Property *self);
+void Fabric_Property_set_label_id(Property *self, labelid_t label_id);
 Label *Fabric_Property_get_label(Property *self, Graph *graph, error_t *status);
 propertyid_t Fabric_Property_get_next_property_id(Property *self);
+void Fabric_Property_set_next_property_id(Property *self, propertyid_t property_id);
 Property *Fabric_Property_get_next_property(Property *self, Graph *graph, error_t *status);
 bool_t Fabric_Property_has_next_property(Property *self);
 uint8_t Fabric_Property_get_type(Property *self);
@@ -367,22 +1176,114 @@ void Fabric_Property_get_short_text(Property *self, text_t dest);
 void Fabric_Property_set_short_text(Property *self, text_t source);
 textid_t Fabric_Property_get_text_value_id(Property *self);
 void Fabric_Property_set_text_value_id(Property *self, textid_t text_id);
+labelid_t Fabric_PropertyView_get_label_id(EntityView *view);
+propertyid_t Fabric_PropertyView_get_next_property_id(EntityView *view);
+uint8_t Fabric_PropertyView_get_type(EntityView *view);
+int64_t Fabric_PropertyView_get_integer_value(EntityView *view);
+
+/**
+ * PropertyIterator methods
+ */
+void Fabric_PropertyIterator_init(PropertyIterator *self, Graph *graph, propertyid_t first_id);
+void Fabric_PropertyIterator_init_vertex(PropertyIterator *self, Graph *graph, Vertex *vertex);
+void Fabric_PropertyIterator_init_edge(PropertyIterator *self, Graph *graph, Edge *edge);
+Property *Fabric_PropertyIterator_next(PropertyIterator *self, error_t *status);
+Property *Fabric_PropertyIterator_find(PropertyIterator *self, labelid_t label_id, error_t *status);
 
 /**
  * Text methods
  */
+Text *Fabric_Text_new(textid_t id, error_t *status);
+void Fabric_Text_destroy(Text *self);
 textid_t Fabric_Text_get_id(Text *self);
 void Fabric_Text_set_id(Text *self, textid_t id);
 error_t Fabric_Text_init(Text *self, uint8_t *data);
 uint32_t Fabric_Text_get_size(Text *self);
 void Fabric_Text_set_size(Text *self, uint32_t size);
+uint32_t Fabric_Text_get_stored_size(Text *self);
+bool_t Fabric_Text_is_compressed(Text *self);
 text_t Fabric_Text_get_value(Text *self);
 void Fabric_Text_set_value(Text *self, text_t value);
 
 /**
  * ClassIndex methods
  */
+ClassIndex *Fabric_ClassIndex_load(IndexStore *store, error_t *status);
+void Fabric_ClassIndex_destroy(ClassIndex *self);
 classid_t Fabric_ClassIndex_get_class_id(ClassIndex *self, text_t name, error_t *status);
+error_t Fabric_ClassIndex_add(ClassIndex *self, text_t name, classid_t class_id);
+error_t Fabric_ClassIndex_remove(ClassIndex *self, classid_t class_id);
+error_t Fabric_ClassIndex_restore(ClassIndex *self, classid_t class_id);
+
+/**
+ * LabelIndex methods
+ */
+LabelIndex *Fabric_LabelIndex_load(IndexStore *store, error_t *status);
+void Fabric_LabelIndex_destroy(LabelIndex *self);
+labelid_t Fabric_LabelIndex_get_label_id(LabelIndex *self, text_t name, error_t *status);
+text_t Fabric_LabelIndex_get_text(LabelIndex *self, labelid_t label_id);
+error_t Fabric_LabelIndex_add(LabelIndex *self, text_t name, labelid_t label_id);
+error_t Fabric_LabelIndex_remove(LabelIndex *self, labelid_t label_id);
+
+/**
+ * PropertyIndex methods
+ */
+classid_t Fabric_PropertyIndex_get_class_id(PropertyIndex *self);
+labelid_t Fabric_PropertyIndex_get_label_id(PropertyIndex *self);
+error_t Fabric_PropertyIndex_insert(PropertyIndex *self, uint8_t type, const uint8_t *data, vertexid_t vertex_id);
+error_t Fabric_PropertyIndex_remove(PropertyIndex *self, uint8_t type, const uint8_t *data, vertexid_t vertex_id);
+PropertyIndexDirectory *Fabric_PropertyIndexDirectory_load(IndexStore *store, error_t *status);
+void Fabric_PropertyIndexDirectory_destroy(PropertyIndexDirectory *self);
+uint32_t Fabric_PropertyIndexDirectory_get_count(PropertyIndexDirectory *self);
+PropertyIndex *Fabric_PropertyIndexDirectory_find(PropertyIndexDirectory *self, classid_t class_id, labelid_t label_id);
+PropertyIndex *Fabric_PropertyIndexDirectory_create(PropertyIndexDirectory *self, classid_t class_id, labelid_t label_id, error_t *status);
+error_t Fabric_PropertyIndexCursor_init(
+    PropertyIndexCursor *self,
+    PropertyIndex *index,
+    Property *low,
+    bool_t low_inclusive,
+    Property *high,
+    bool_t high_inclusive);
+vertexid_t Fabric_PropertyIndexCursor_next(PropertyIndexCursor *self, error_t *status);
+
+/**
+ * PropertyColumn methods
+ */
+classid_t Fabric_PropertyColumn_get_class_id(PropertyColumn *self);
+labelid_t Fabric_PropertyColumn_get_label_id(PropertyColumn *self);
+uint8_t Fabric_PropertyColumn_get_type(PropertyColumn *self);
+uint32_t Fabric_PropertyColumn_get_row_count(PropertyColumn *self);
+const vertexid_t *Fabric_PropertyColumn_get_vertex_ids(PropertyColumn *self);
+const int64_t *Fabric_PropertyColumn_get_integers(PropertyColumn *self);
+const float64_t *Fabric_PropertyColumn_get_reals(PropertyColumn *self);
+const uint8_t *Fabric_PropertyColumn_get_booleans(PropertyColumn *self);
+const uint8_t *Fabric_PropertyColumn_get_nulls(PropertyColumn *self);
+bool_t Fabric_PropertyColumn_is_null(PropertyColumn *self, uint32_t row);
+bool_t Fabric_PropertyColumn_find_row(PropertyColumn *self, vertexid_t vertex_id, uint32_t *row);
+error_t Fabric_PropertyColumn_set(PropertyColumn *self, vertexid_t vertex_id, uint8_t type, const uint8_t *data);
+PropertyColumnDirectory *Fabric_PropertyColumnDirectory_load(IndexStore *store, error_t *status);
+void Fabric_PropertyColumnDirectory_destroy(PropertyColumnDirectory *self);
+uint32_t Fabric_PropertyColumnDirectory_get_count(PropertyColumnDirectory *self);
+PropertyColumn *Fabric_PropertyColumnDirectory_find(PropertyColumnDirectory *self, classid_t class_id, labelid_t label_id);
+PropertyColumn *Fabric_PropertyColumnDirectory_create(
+    PropertyColumnDirectory *self,
+    classid_t class_id,
+    labelid_t label_id,
+    uint8_t type,
+    error_t *status);
+error_t Fabric_PropertyColumnDirectory_flush(PropertyColumnDirectory *self);
+
+/**
+ * Predicate methods
+ */
+int Fabric_Predicate_get_kernel();
+error_t Fabric_Predicate_init(Predicate *self, int op, Property *value);
+error_t Fabric_Predicate_init_range(Predicate *self, Property *low, Property *high);
+error_t Fabric_Predicate_init_in(Predicate *self, Property **values, uint32_t count);
+bool_t Fabric_Predicate_matches(Predicate *self, uint8_t type, const uint8_t *data);
+uint32_t Fabric_Predicate_select_records(Predicate *self, const uint8_t *records, uint32_t count, labelid_t label_id, uint8_t *selection);
+uint32_t Fabric_Predicate_select_column(Predicate *self, PropertyColumn *column, uint8_t *selection, error_t *status);
+uint32_t Fabric_Predicate_get_selected_ids(const uint8_t *selection, uint32_t count, const uint32_t *ids, uint32_t first_id, uint32_t *out);
 
 /**
  * DynamicList methods
@@ -430,6 +1331,31 @@ error_t Fabric_EntityMap_set(EntityMap *self, uint32_t key, void* entity);
 void *Fabric_EntityMap_get(EntityMap *self, uint32_t key);
 void Fabric_EntityMap_unset(EntityMap *self, uint32_t key);
 
+/**
+ * EntityCache methods
+ */
+EntityCache *Fabric_EntityCache_new(
+    int capacity,
+    int policy,
+    IdSet *pinned,
+    void (*destroy)(void *entity),
+    error_t *status);
+void Fabric_EntityCache_destroy(EntityCache *self);
+bool_t Fabric_EntityCache_has_key(EntityCache *self, uint32_t key);
+void *Fabric_EntityCache_get(EntityCache *self, uint32_t key);
+error_t Fabric_EntityCache_set(EntityCache *self, uint32_t key, void *entity);
+void Fabric_EntityCache_unset(EntityCache *self, uint32_t key);
+int Fabric_EntityCache_get_count(EntityCache *self);
+uint64_t Fabric_EntityCache_get_hits(EntityCache *self);
+uint64_t Fabric_EntityCache_get_misses(EntityCache *self);
+uint64_t Fabric_EntityCache_get_evictions(EntityCache *self);
+float64_t Fabric_EntityCache_get_hit_ratio(EntityCache *self);
+float64_t Fabric_EntityCache_get_recent_hit_ratio(EntityCache *self);
+void Fabric_EntityCache_set_limit(EntityCache *self, int limit);
+int Fabric_EntityCache_get_limit(EntityCache *self);
+int Fabric_EntityCache_get_capacity(EntityCache *self);
+void Fabric_EntityCache_trim(EntityCache *self);
+
 /**
  * Internal property types
  */
@@ -470,6 +1396,7 @@ void Fabric_EntityMap_unset(EntityMap *self, uint32_t key);
 #  define FABRIC_OK 0x00000000
 #  define FABRIC_ERROR 0x00000001
 #  define FABRIC_OUT_OF_MEMORY 0x00000002
+#  define FABRIC_MEM_OVER_BUDGET 0x00000003
 /* Error codes for the class store */
 #  define FABRIC_CLASSSTORE_ERROR 0x00000100
 #  define FABRIC_CLASSSTORE_INVALID_ID 0x00000101
@@ -480,17 +1407,62 @@ void Fabric_EntityMap_unset(EntityMap *self, uint32_t key);
 #  define FABRIC_CLASSSTORE_NEEDS_RESIZE 0x00000110
 /* Error codes for the label store */
 #  define FABRIC_LABELSTORE_ERROR 0x00000200
+#  define FABRIC_LABELSTORE_INVALID_ID 0x00000201
+#  define FABRIC_LABEL_DOESNT_EXIST 0x00000202
 #  define FABRIC_LABELSTORE_NEEDS_RESIZE 0x00000210
 /* Error codes for the vertex store */
 #  define FABRIC_VERTEXSTORE_ERROR 0x00000300
+#  define FABRIC_VERTEXSTORE_INVALID_ID 0x00000301
+#  define FABRIC_VERTEX_DOESNT_EXIST 0x00000302
+#  define FABRIC_VERTEXSTORE_NEEDS_RESIZE 0x00000310
 /* Error codes for the edge store */
 #  define FABRIC_EDGESTORE_ERROR 0x00000400
+#  define FABRIC_EDGESTORE_INVALID_ID 0x00000401
+#  define FABRIC_EDGE_DOESNT_EXIST 0x00000402
+#  define FABRIC_EDGESTORE_TOO_MANY_LABELS 0x00000403
+#  define FABRIC_EDGESTORE_NEEDS_RESIZE 0x00000410
 /* Error codes for the property store */
 #  define FABRIC_PROPERTYSTORE_ERROR 0x00000500
+#  define FABRIC_PROPERTYSTORE_INVALID_ID 0x00000501
+#  define FABRIC_PROPERTY_DOESNT_EXIST 0x00000502
+#  define FABRIC_PROPERTYSTORE_NEEDS_RESIZE 0x00000510
 /* Error codes for the text store */
 #  define FABRIC_TEXTSTORE_ERROR 0x00000600
 /* Error codes for the index store */
 #  define FABRIC_INDEXSTORE_ERROR 0x00000700
+/* Error codes for the buffer pool */
+#  define FABRIC_BUFFERPOOL_ERROR 0x00000800
+#  define FABRIC_BUFFERPOOL_ALL_PINNED 0x00000801
+#  define FABRIC_BUFFERPOOL_IO_ERROR 0x00000802
+/* Error codes for file mappings */
+#  define FABRIC_MAPPING_ERROR 0x00000900
+/* Error codes for adjacency snapshots */
+#  define FABRIC_ADJACENCY_SNAPSHOT_ERROR 0x00000A00
+#  define FABRIC_ADJACENCY_SNAPSHOT_MISSING 0x00000A01
+/* Error codes for store extents */
+#  define FABRIC_EXTENT_ERROR 0x00000C00
+#  define FABRIC_EXTENT_LIMIT 0x00000C01
+/* Error codes for write-ahead logs */
+#  define FABRIC_WAL_ERROR 0x00000B00
+#  define FABRIC_WAL_IO_ERROR 0x00000B01
+/* Error codes for entity views */
+#  define FABRIC_ENTITY_VIEW_ERROR 0x00000D00
+/* Error codes for bulk loads */
+#  define FABRIC_BULKLOAD_ERROR 0x00000E00
+#  define FABRIC_BULKLOAD_INVALID_VERTEX 0x00000E01
+/* Error codes for snapshots */
+#  define FABRIC_SNAPSHOT_ERROR 0x00000F00
+#  define FABRIC_SNAPSHOT_LIMIT 0x00000F01
+/* Error codes for traversals */
+#  define FABRIC_TRAVERSAL_ERROR 0x00001800
+/* Error codes for free id maps */
+#  define FABRIC_FREEIDMAP_ERROR 0x00001900
+#  define FABRIC_FREEIDMAP_MISSING 0x00001901
+/* Error codes for compactions */
+#  define FABRIC_COMPACTION_ERROR 0x00001A00
+#  define FABRIC_COMPACTION_HAS_INDEXES 0x00001A01
+/* Error codes for write batches */
+#  define FABRIC_WRITEBATCH_ERROR 0x00001B00
 /* Error codes for graph objects */
 #  define FABRIC_GRAPH_ERROR 0x00001000
 /* Error codes for class objects */
@@ -514,6 +1486,7 @@ void Fabric_EntityMap_unset(EntityMap *self, uint32_t key);
 /* Error codes for index objects */
 #  define FABRIC_INDEX_ERROR 0x00001700
 #  define FABRIC_INDEX_INVALID_ID 0x00001701
+#  define FABRIC_INDEX_DOESNT_EXIST 0x00001702
 /* Error codes for dynamic lists */
 #  define FABRIC_DYNAMIC_LIST_ERROR 0x00002100
 #endif
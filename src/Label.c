@@ -34,6 +34,9 @@ typedef struct Label {
     uint32_t refs;      // The number of references to this label
 } Label;
 
+/* Label objects are allocated from their own slab */
+static MemSlab Fabric_Label__slab = FABRIC_MEMSLAB_INITIALIZER(Label);
+
 /**
  * Gets a label's id
  */
@@ -48,19 +51,33 @@ void Fabric_Label_set_id(Label *self, labelid_t id) {
     self->id = id;
 }
 
+/**
+ * Creates a new label object
+ *
+ * Args:
+ *      id: The internal id of the label object being created
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: A heap allocated label object that is NOT initialized
+ *          or NULL if there is a memory error
+ */
 Label* Fabric_Label_new(labelid_t id, error_t *status) {
-    Label* new_label = Fabric_memalloc(sizeof(Label));
-    id (NULL == new_label) {
+    Label* new_label = Fabric_memslab_alloc(&Fabric_Label__slab);
+    if (NULL == new_label) {
         *status = Fabric_memerrno();
     } else {
         new_label->id = id;
+        *status = FABRIC_OK;
     }
 
     return new_label;
 }
 
+/**
+ * Frees a label object
+ */
 void Fabric_Label_destroy(Label *self) {
-    Fabric_memfree(self, sizeof(Label));
+    Fabric_memslab_free(&Fabric_Label__slab, self);
 }
 
 /**
@@ -84,6 +101,27 @@ error_t Fabric_Label_init(Label *self, uint8_t *data) {
     return FABRIC_OK;
 }
 
+/**
+ * Writes a label's stored data block
+ *
+ * Args:
+ *      self: The label being stored
+ *      dest: An array of eight bytes to hold the label's data
+ */
+void Fabric_Label_load_bytes(Label *self, uint8_t *dest) {
+    *((textid_t*)dest) = htobe32(self->text_id);
+    *((uint32_t*)(dest + 4)) = htobe32(self->refs);
+}
+
+/**
+ * Returns whether or not this label is in use.
+ *
+ * A label is marked as not in use by setting its text_id to 0
+ */
+bool_t Fabric_Label_is_in_use(Label *self) {
+    return self->text_id != 0;
+}
+
 /**
  * Get's the id of a label's text
  */
@@ -0,0 +1,859 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_LABELPARTITION_C__
+#define _FABRIC_LABELPARTITION_C__
+
+#include <string.h>
+#include "Internal.h"
+
+#define FABRIC_LABEL_PARTITION_PAGE_ID 4
+#define FABRIC_LABEL_PARTITION_TYPE 0x07
+#define FABRIC_LABEL_PARTITION_HEADER_SIZE 12
+#define FABRIC_LABEL_PARTITION_ENTRY_HEADER_SIZE 8
+#define FABRIC_LABEL_GROUP_SIZE 16
+
+/**
+ * A Label Partition groups the out edges or the in edges of one vertex
+ * by label.
+ *
+ * The edges of a vertex are still a single linked list, so walking every
+ * edge works the same whether or not the vertex is partitioned.  In a
+ * partitioned list the edges with the same label are kept next to each
+ * other, and the partition records the first edge, the last edge and the
+ * number of edges of each group.  A walk that only wants one label starts
+ * at its group's first edge and stops after its count, touching no other
+ * edges.
+ *
+ * The groups are in the order they appear in the list.  A new edge goes
+ * to the front of its label's group: only the last edge of the group
+ * before it has to point at the new edge.  An edge with a new label
+ * starts a group at the front of the list.
+ */
+typedef struct LabelGroup {
+    labelid_t label_id;     // The label of the group's edges
+    edgeid_t first_id;      // The first edge of the group in the list
+    edgeid_t last_id;       // The last edge of the group in the list
+    uint32_t count;         // The number of edges in the group
+} LabelGroup;
+
+typedef struct LabelPartition {
+    vertexid_t vertex_id;   // The vertex whose edges are grouped
+    int direction;          // FABRIC_DIRECTION_OUT or FABRIC_DIRECTION_IN
+    uint32_t num_groups;    // The number of groups
+    uint32_t cap;           // The capacity of groups
+    LabelGroup *groups;     // The groups in the order of the edge list
+} LabelPartition;
+
+/**
+ * A Label Partition Directory holds the label partitions of a graph.
+ *
+ * Only the vertices that have been partitioned have an entry, which is
+ * meant for the few dense vertices whose filtered walks are expensive.
+ * The directory is kept in memory and written to a chain of index pages
+ * starting at root page 4 when the edge store is flushed.  Each page has
+ * a 12 byte header:
+ *
+ *      type (1 byte): 0x07
+ *      unused (3 bytes)
+ *      next_page_id (4 bytes): the next page of the chain, 0 for the last
+ *      used (4 bytes): the number of bytes of entries after the header
+ *
+ * An entry is a vertex id (4 bytes), its direction (1 byte), an unused
+ * byte and its number of groups (2 bytes), followed by 16 bytes for each
+ * group: its label id, first edge id, last edge id and count.  An entry
+ * never spans pages, which limits the number of labels a partition can
+ * have.
+ */
+struct LabelPartitionDirectory {
+    EdgeStore *store;               // The edge store whose edges are grouped
+    EntityMap *out;                 // Partitions of out edges by vertex id
+    EntityMap *in;                  // Partitions of in edges by vertex id
+    LabelPartition **partitions;    // Every partition, in the order they are written
+    uint32_t count;                 // The number of partitions
+    uint32_t cap;                   // The capacity of partitions
+    uint32_t *page_ids;             // The pages of the chain
+    uint32_t num_pages;             // The number of pages in the chain
+    bool_t changed;                 // Whether the directory changed since it was written
+};
+
+/**
+ * Private function that frees a partition
+ */
+static
+void Fabric_LabelPartition__destroy(LabelPartition *self) {
+    if (NULL != self->groups) {
+        Fabric_memfree_tagged(self->groups, self->cap * sizeof(LabelGroup), FABRIC_MEM_INDEX);
+    }
+    Fabric_memfree_tagged(self, sizeof(LabelPartition), FABRIC_MEM_INDEX);
+}
+
+/**
+ * Private function that makes room for a number of groups in a partition
+ */
+static
+error_t Fabric_LabelPartition__reserve(LabelPartition *self, uint32_t num_groups) {
+    uint32_t new_cap = self->cap < 4 ? 4 : self->cap;
+    LabelGroup *groups;
+
+    if (num_groups <= self->cap) {
+        return FABRIC_OK;
+    }
+    while (new_cap < num_groups) {
+        new_cap *= 2;
+    }
+    groups = Fabric_memrealloc_tagged(self->groups, new_cap * sizeof(LabelGroup),
+        self->cap * sizeof(LabelGroup), FABRIC_MEM_INDEX);
+    if (NULL == groups) {
+        return Fabric_memerrno();
+    }
+    self->groups = groups;
+    self->cap = new_cap;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that gets the highest number of groups a partition's
+ * entry can hold
+ */
+static inline
+uint32_t Fabric_LabelPartitionDirectory__max_groups(LabelPartitionDirectory *self) {
+    IndexStore *store = Fabric_Graph_get_index_store(Fabric_EdgeStore_get_graph(self->store));
+    return (store->page_size - FABRIC_LABEL_PARTITION_HEADER_SIZE - FABRIC_LABEL_PARTITION_ENTRY_HEADER_SIZE) /
+        FABRIC_LABEL_GROUP_SIZE;
+}
+
+/**
+ * Private function that gets the map holding the partitions of a direction
+ */
+static inline
+EntityMap *Fabric_LabelPartitionDirectory__map(LabelPartitionDirectory *self, int direction) {
+    return FABRIC_DIRECTION_IN == direction ? self->in : self->out;
+}
+
+/**
+ * Private function that adds a new, empty partition to the directory
+ */
+static
+LabelPartition *Fabric_LabelPartitionDirectory__add(LabelPartitionDirectory *self, vertexid_t vertex_id, int direction, error_t *status) {
+    LabelPartition *partition;
+    LabelPartition **partitions;
+    uint32_t new_cap;
+
+    if (self->count == self->cap) {
+        new_cap = self->cap < 8 ? 8 : self->cap * 2;
+        partitions = Fabric_memrealloc_tagged(self->partitions, new_cap * sizeof(LabelPartition*),
+            self->cap * sizeof(LabelPartition*), FABRIC_MEM_INDEX);
+        if (NULL == partitions) {
+            *status = Fabric_memerrno();
+            return NULL;
+        }
+        self->partitions = partitions;
+        self->cap = new_cap;
+    }
+    partition = Fabric_memalloc_tagged(sizeof(LabelPartition), FABRIC_MEM_INDEX);
+    if (NULL == partition) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    partition->vertex_id = vertex_id;
+    partition->direction = direction;
+    partition->num_groups = 0;
+    partition->cap = 0;
+    partition->groups = NULL;
+    *status = Fabric_EntityMap_set(Fabric_LabelPartitionDirectory__map(self, direction), vertex_id, partition);
+    if (FABRIC_OK != *status) {
+        Fabric_LabelPartition__destroy(partition);
+        return NULL;
+    }
+    self->partitions[self->count++] = partition;
+    self->changed = TRUE;
+    return partition;
+}
+
+/**
+ * Private function that removes a partition from the directory
+ */
+static
+void Fabric_LabelPartitionDirectory__remove(LabelPartitionDirectory *self, LabelPartition *partition) {
+    uint32_t i;
+    for (i = 0; i < self->count; i++) {
+        if (self->partitions[i] == partition) {
+            memmove(self->partitions + i, self->partitions + i + 1,
+                (self->count - i - 1) * sizeof(LabelPartition*));
+            self->count--;
+            break;
+        }
+    }
+    Fabric_EntityMap_unset(Fabric_LabelPartitionDirectory__map(self, partition->direction), partition->vertex_id);
+    Fabric_LabelPartition__destroy(partition);
+    self->changed = TRUE;
+}
+
+/**
+ * Private function that reads the entries of one page of the chain
+ */
+static
+error_t Fabric_LabelPartitionDirectory__load_page(LabelPartitionDirectory *self, uint8_t *page, uint32_t used) {
+    uint32_t position = FABRIC_LABEL_PARTITION_HEADER_SIZE;
+    uint32_t end = FABRIC_LABEL_PARTITION_HEADER_SIZE + used;
+    uint32_t i, num_groups;
+    LabelPartition *partition;
+    LabelGroup *group;
+    uint8_t *entry;
+    error_t status;
+
+    while (position + FABRIC_LABEL_PARTITION_ENTRY_HEADER_SIZE <= end) {
+        entry = page + position;
+        num_groups = betoh16(*(uint16_t*)(entry + 6));
+        if (position + FABRIC_LABEL_PARTITION_ENTRY_HEADER_SIZE + num_groups * FABRIC_LABEL_GROUP_SIZE > end) {
+            return FABRIC_INDEX_ERROR;
+        }
+        partition = Fabric_LabelPartitionDirectory__add(self, betoh32(*(uint32_t*)entry),
+            entry[4] == FABRIC_DIRECTION_IN ? FABRIC_DIRECTION_IN : FABRIC_DIRECTION_OUT, &status);
+        if (FABRIC_OK != status ||
+            FABRIC_OK != (status = Fabric_LabelPartition__reserve(partition, num_groups))) {
+            return status;
+        }
+        entry += FABRIC_LABEL_PARTITION_ENTRY_HEADER_SIZE;
+        for (i = 0; i < num_groups; i++, entry += FABRIC_LABEL_GROUP_SIZE) {
+            group = &partition->groups[i];
+            group->label_id = betoh32(*(uint32_t*)entry);
+            group->first_id = betoh32(*(uint32_t*)(entry + 4));
+            group->last_id = betoh32(*(uint32_t*)(entry + 8));
+            group->count = betoh32(*(uint32_t*)(entry + 12));
+        }
+        partition->num_groups = num_groups;
+        position += FABRIC_LABEL_PARTITION_ENTRY_HEADER_SIZE + num_groups * FABRIC_LABEL_GROUP_SIZE;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that remembers a page of the chain
+ */
+static
+error_t Fabric_LabelPartitionDirectory__add_page(LabelPartitionDirectory *self, uint32_t page_id) {
+    uint32_t *page_ids = Fabric_memrealloc_tagged(self->page_ids, (self->num_pages + 1) * sizeof(uint32_t),
+        self->num_pages * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    if (NULL == page_ids) {
+        return Fabric_memerrno();
+    }
+    self->page_ids = page_ids;
+    self->page_ids[self->num_pages++] = page_id;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that reads the chain of pages into the directory
+ */
+static
+error_t Fabric_LabelPartitionDirectory__load(LabelPartitionDirectory *self) {
+    IndexStore *store = Fabric_Graph_get_index_store(Fabric_EdgeStore_get_graph(self->store));
+    Graph *graph = Fabric_IndexStore_get_graph(store);
+    uint32_t page_size = store->page_size;
+    uint32_t page_id = FABRIC_LABEL_PARTITION_PAGE_ID;
+    uint32_t used;
+    uint8_t *page;
+    error_t status = FABRIC_OK;
+
+    if (Fabric_IndexStore_get_page_count(store) < FABRIC_LABEL_PARTITION_PAGE_ID) {
+        return FABRIC_OK;
+    }
+    page = Fabric_memalloc_tagged(page_size, FABRIC_MEM_INDEX);
+    if (NULL == page) {
+        return Fabric_memerrno();
+    }
+    while (page_id != 0) {
+        // A chain longer than the store can only be a loop
+        if (page_id > Fabric_IndexStore_get_page_count(store) ||
+            self->num_pages >= Fabric_IndexStore_get_page_count(store)) {
+            status = FABRIC_INDEX_ERROR;
+            break;
+        }
+        status = Fabric_Graph_read_bytes(graph, page, page_size, Fabric_IndexStore_get_page_offset(store, page_id));
+        if (FABRIC_OK != status) {
+            break;
+        }
+        Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_INDEX_STORE, 1);
+        // An empty root page has never been written
+        if (page[0] == 0 && page_id == FABRIC_LABEL_PARTITION_PAGE_ID) {
+            break;
+        }
+        used = betoh32(*(uint32_t*)(page + 8));
+        if (page[0] != FABRIC_LABEL_PARTITION_TYPE || used > page_size - FABRIC_LABEL_PARTITION_HEADER_SIZE) {
+            status = FABRIC_INDEX_ERROR;
+            break;
+        }
+        if (FABRIC_OK != (status = Fabric_LabelPartitionDirectory__add_page(self, page_id)) ||
+            FABRIC_OK != (status = Fabric_LabelPartitionDirectory__load_page(self, page, used))) {
+            break;
+        }
+        page_id = betoh32(*(uint32_t*)(page + 4));
+    }
+    Fabric_memfree_tagged(page, page_size, FABRIC_MEM_INDEX);
+    self->changed = FALSE;
+    return status;
+}
+
+/**
+ * Reads a graph's label partitions into memory
+ *
+ * Args:
+ *      store: The graph's edge store
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The directory or NULL on failure
+ */
+LabelPartitionDirectory *Fabric_LabelPartitionDirectory_load(EdgeStore *store, error_t *status) {
+    LabelPartitionDirectory *self = Fabric_memalloc_tagged(sizeof(LabelPartitionDirectory), FABRIC_MEM_INDEX);
+    if (NULL == self) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    self->store = store;
+    self->in = NULL;
+    self->partitions = NULL;
+    self->count = 0;
+    self->cap = 0;
+    self->page_ids = NULL;
+    self->num_pages = 0;
+    self->changed = FALSE;
+    self->out = Fabric_EntityMap_new(status);
+    if (FABRIC_OK == *status) {
+        self->in = Fabric_EntityMap_new(status);
+    }
+    if (FABRIC_OK == *status) {
+        *status = Fabric_LabelPartitionDirectory__load(self);
+    }
+    if (FABRIC_OK != *status) {
+        Fabric_LabelPartitionDirectory_destroy(self);
+        return NULL;
+    }
+    return self;
+}
+
+/**
+ * Frees the memory held by a label partition directory and its partitions
+ */
+void Fabric_LabelPartitionDirectory_destroy(LabelPartitionDirectory *self) {
+    uint32_t i;
+    for (i = 0; i < self->count; i++) {
+        Fabric_LabelPartition__destroy(self->partitions[i]);
+    }
+    if (NULL != self->partitions) {
+        Fabric_memfree_tagged(self->partitions, self->cap * sizeof(LabelPartition*), FABRIC_MEM_INDEX);
+    }
+    if (NULL != self->page_ids) {
+        Fabric_memfree_tagged(self->page_ids, self->num_pages * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    }
+    if (NULL != self->out) {
+        Fabric_EntityMap_destroy(self->out);
+    }
+    if (NULL != self->in) {
+        Fabric_EntityMap_destroy(self->in);
+    }
+    Fabric_memfree_tagged(self, sizeof(LabelPartitionDirectory), FABRIC_MEM_INDEX);
+}
+
+/**
+ * Gets the number of partitions in a directory
+ */
+uint32_t Fabric_LabelPartitionDirectory_get_count(LabelPartitionDirectory *self) {
+    return self->count;
+}
+
+/**
+ * Checks whether a vertex's edges are partitioned by label
+ *
+ * Args:
+ *      self: A label partition directory
+ *      vertex_id: The vertex
+ *      direction: FABRIC_DIRECTION_OUT or FABRIC_DIRECTION_IN
+ *
+ * Returns: TRUE if the vertex's edges in the direction are partitioned
+ */
+bool_t Fabric_LabelPartitionDirectory_is_partitioned(LabelPartitionDirectory *self, vertexid_t vertex_id, int direction) {
+    return Fabric_EntityMap_has_key(Fabric_LabelPartitionDirectory__map(self, direction), vertex_id);
+}
+
+/**
+ * Finds where the edges with a label start in a partitioned edge list
+ *
+ * Args:
+ *      self: A label partition directory
+ *      vertex_id: The vertex whose edges are looked up
+ *      direction: FABRIC_DIRECTION_OUT or FABRIC_DIRECTION_IN
+ *      label_id: The label of the edges
+ *      first_id: Where the group's first edge id is stored, 0 if the
+ *                vertex has no edges with the label
+ *      count: Where the group's number of edges is stored
+ *
+ * Returns: TRUE if the vertex's edges are partitioned, otherwise FALSE
+ *          and first_id and count are left alone
+ */
+bool_t Fabric_LabelPartitionDirectory_find_group(
+    LabelPartitionDirectory *self,
+    vertexid_t vertex_id,
+    int direction,
+    labelid_t label_id,
+    edgeid_t *first_id,
+    uint32_t *count) {
+
+    LabelPartition *partition = Fabric_EntityMap_get(Fabric_LabelPartitionDirectory__map(self, direction), vertex_id);
+    uint32_t i;
+
+    if (NULL == partition) {
+        return FALSE;
+    }
+    *first_id = 0;
+    *count = 0;
+    for (i = 0; i < partition->num_groups; i++) {
+        if (partition->groups[i].label_id == label_id) {
+            *first_id = partition->groups[i].first_id;
+            *count = partition->groups[i].count;
+            break;
+        }
+    }
+    return TRUE;
+}
+
+/**
+ * Private function that sets the id of the edge after an edge in a list
+ */
+static
+error_t Fabric_LabelPartitionDirectory__set_next(LabelPartitionDirectory *self, edgeid_t edge_id, int direction, edgeid_t next_id) {
+    error_t status;
+    Edge *edge = Fabric_EdgeStore_get_edge(self->store, edge_id, &status);
+    if (NULL == edge) {
+        return status;
+    }
+    if (FABRIC_DIRECTION_IN == direction) {
+        Fabric_Edge_set_next_in_edge_id(edge, next_id);
+    } else {
+        Fabric_Edge_set_next_out_edge_id(edge, next_id);
+    }
+    return Fabric_EdgeStore_update_edge(self->store, edge);
+}
+
+/**
+ * Links a new edge into one of a vertex's edge lists
+ *
+ * An unpartitioned list gets the edge at its head.  A partitioned list
+ * gets it at the head of its label's group.  If the edge's label would
+ * give the partition more groups than its entry can hold, the partition
+ * is dropped; the list is still complete, so walks fall back to reading
+ * every edge.
+ *
+ * The edge's next id and the vertex's first id are set, but neither is
+ * marked as changed.
+ *
+ * Args:
+ *      self: A label partition directory
+ *      edge: The new edge; it must already be in the edge store's cache
+ *      vertex: The vertex whose list the edge joins
+ *      direction: FABRIC_DIRECTION_OUT or FABRIC_DIRECTION_IN
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_LabelPartitionDirectory_link_edge(LabelPartitionDirectory *self, Edge *edge, Vertex *vertex, int direction) {
+    LabelPartition *partition = Fabric_EntityMap_get(
+        Fabric_LabelPartitionDirectory__map(self, direction), Fabric_Vertex_get_id(vertex));
+    labelid_t label_id = Fabric_Edge_get_label_id(edge);
+    edgeid_t edge_id = Fabric_Edge_get_id(edge);
+    edgeid_t next_id;
+    LabelGroup *group = NULL;
+    uint32_t i;
+    error_t status;
+
+    if (NULL != partition) {
+        for (i = 0; i < partition->num_groups; i++) {
+            if (partition->groups[i].label_id == label_id) {
+                group = &partition->groups[i];
+                break;
+            }
+        }
+        if (NULL == group && partition->num_groups >= Fabric_LabelPartitionDirectory__max_groups(self)) {
+            Fabric_LabelPartitionDirectory__remove(self, partition);
+            partition = NULL;
+        }
+    }
+
+    if (FABRIC_DIRECTION_IN == direction) {
+        next_id = Fabric_Vertex_get_first_in_edge_id(vertex);
+    } else {
+        next_id = Fabric_Vertex_get_first_out_edge_id(vertex);
+    }
+
+    if (NULL != group) {
+        // The edge goes in front of its group's first edge
+        next_id = group->first_id;
+        if (group != partition->groups) {
+            status = Fabric_LabelPartitionDirectory__set_next(self, (group - 1)->last_id, direction, edge_id);
+            if (FABRIC_OK != status) {
+                return status;
+            }
+        }
+        group->first_id = edge_id;
+        group->count++;
+    } else if (NULL != partition) {
+        // A new label's group starts the list
+        status = Fabric_LabelPartition__reserve(partition, partition->num_groups + 1);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        memmove(partition->groups + 1, partition->groups, partition->num_groups * sizeof(LabelGroup));
+        partition->num_groups++;
+        group = partition->groups;
+        group->label_id = label_id;
+        group->first_id = edge_id;
+        group->last_id = edge_id;
+        group->count = 1;
+    }
+    if (NULL != partition) {
+        self->changed = TRUE;
+    }
+
+    if (FABRIC_DIRECTION_IN == direction) {
+        Fabric_Edge_set_next_in_edge_id(edge, next_id);
+        if (NULL == group || group == partition->groups) {
+            Fabric_Vertex_set_first_in_edge_id(vertex, edge_id);
+        }
+    } else {
+        Fabric_Edge_set_next_out_edge_id(edge, next_id);
+        if (NULL == group || group == partition->groups) {
+            Fabric_Vertex_set_first_out_edge_id(vertex, edge_id);
+        }
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Unlinks an edge that was just linked with
+ * Fabric_LabelPartitionDirectory_link_edge(4)
+ *
+ * It undoes a link whose edge is still at the head of its list or of its
+ * label's group, so that a failed edge creation leaves the vertex's list
+ * as it was.  A new label's group is removed again; a partition that the
+ * link dropped is not restored, since the list is complete without it.
+ *
+ * Args:
+ *      self: A label partition directory
+ *      edge: The edge being unlinked
+ *      vertex: The vertex whose list the edge was linked into
+ *      direction: FABRIC_DIRECTION_OUT or FABRIC_DIRECTION_IN
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_LabelPartitionDirectory_unlink_edge(LabelPartitionDirectory *self, Edge *edge, Vertex *vertex, int direction) {
+    LabelPartition *partition = Fabric_EntityMap_get(
+        Fabric_LabelPartitionDirectory__map(self, direction), Fabric_Vertex_get_id(vertex));
+    labelid_t label_id = Fabric_Edge_get_label_id(edge);
+    edgeid_t edge_id = Fabric_Edge_get_id(edge);
+    edgeid_t next_id;
+    LabelGroup *group = NULL;
+    bool_t is_first = TRUE;
+    uint32_t i;
+    error_t status = FABRIC_OK;
+
+    if (FABRIC_DIRECTION_IN == direction) {
+        next_id = Fabric_Edge_get_next_in_edge_id(edge);
+    } else {
+        next_id = Fabric_Edge_get_next_out_edge_id(edge);
+    }
+
+    if (NULL != partition) {
+        for (i = 0; i < partition->num_groups; i++) {
+            if (partition->groups[i].label_id == label_id) {
+                group = &partition->groups[i];
+                break;
+            }
+        }
+    }
+    if (NULL != group && group->first_id == edge_id) {
+        is_first = group == partition->groups;
+        if (1 == group->count) {
+            // The link started a new label's group at the head of the list
+            partition->num_groups--;
+            memmove(group, group + 1, (partition->num_groups - i) * sizeof(LabelGroup));
+        } else {
+            group->first_id = next_id;
+            group->count--;
+            if (!is_first) {
+                status = Fabric_LabelPartitionDirectory__set_next(self, (group - 1)->last_id, direction, next_id);
+            }
+        }
+        self->changed = TRUE;
+    }
+
+    if (is_first) {
+        if (FABRIC_DIRECTION_IN == direction) {
+            Fabric_Vertex_set_first_in_edge_id(vertex, next_id);
+        } else {
+            Fabric_Vertex_set_first_out_edge_id(vertex, next_id);
+        }
+    }
+    return status;
+}
+
+/**
+ * Private type used to sort a vertex's edges into their groups
+ */
+typedef struct LabelPartitionItem {
+    edgeid_t edge_id;       // The edge
+    uint32_t group;         // The index of the edge's group
+    uint32_t position;      // The edge's position in the grouped list
+} LabelPartitionItem;
+
+/**
+ * Private function that reads a vertex's edge list into an array
+ */
+static
+LabelPartitionItem *Fabric_LabelPartitionDirectory__read_list(
+    LabelPartitionDirectory *self,
+    Vertex *vertex,
+    int direction,
+    LabelPartition *partition,
+    uint32_t *items_cap,
+    error_t *status) {
+
+    Graph *graph = Fabric_EdgeStore_get_graph(self->store);
+    LabelPartitionItem *items = NULL, *grown;
+    uint32_t cap = 0, count = 0, i;
+    labelid_t label_id;
+    EdgeIterator iterator;
+    Edge *edge;
+
+    Fabric_EdgeIterator_init(&iterator, graph, vertex, direction);
+    while (NULL != (edge = Fabric_EdgeIterator_next(&iterator, status))) {
+        if (count == cap) {
+            grown = Fabric_memrealloc_tagged(items, (cap < 64 ? 64 : cap * 2) * sizeof(LabelPartitionItem),
+                cap * sizeof(LabelPartitionItem), FABRIC_MEM_INDEX);
+            if (NULL == grown) {
+                *status = Fabric_memerrno();
+                break;
+            }
+            items = grown;
+            cap = cap < 64 ? 64 : cap * 2;
+        }
+
+        // Groups are numbered in the order their labels first appear
+        label_id = Fabric_Edge_get_label_id(edge);
+        for (i = 0; i < partition->num_groups; i++) {
+            if (partition->groups[i].label_id == label_id) {
+                break;
+            }
+        }
+        if (i == partition->num_groups) {
+            if (FABRIC_OK != (*status = Fabric_LabelPartition__reserve(partition, i + 1))) {
+                break;
+            }
+            partition->groups[i].label_id = label_id;
+            partition->groups[i].count = 0;
+            partition->num_groups++;
+        }
+        partition->groups[i].count++;
+        items[count].edge_id = Fabric_Edge_get_id(edge);
+        items[count].group = i;
+        count++;
+    }
+    if (FABRIC_OK != *status && NULL != items) {
+        Fabric_memfree_tagged(items, cap * sizeof(LabelPartitionItem), FABRIC_MEM_INDEX);
+        items = NULL;
+    }
+    *items_cap = cap;
+    return items;
+}
+
+/**
+ * Groups a vertex's edges by label
+ *
+ * The vertex's edge list is reordered so that the edges with the same
+ * label are next to each other, keeping the order of the edges within a
+ * label and ordering the labels by where they first appeared.  Only the
+ * edges whose next edge changes are rewritten.  From then on, new edges
+ * keep the list grouped and walks of one label only read its edges.
+ *
+ * This is meant for dense vertices; every partition is kept in memory.
+ *
+ * Args:
+ *      self: A label partition directory
+ *      vertex: The vertex whose edges are grouped
+ *      direction: FABRIC_DIRECTION_OUT or FABRIC_DIRECTION_IN
+ *
+ * Returns:
+ *      FABRIC_OK on success or if the list is already partitioned
+ *      FABRIC_EDGESTORE_TOO_MANY_LABELS if the vertex's edges have more
+ *          labels than a partition can hold
+ *      Other error code on failure
+ */
+error_t Fabric_LabelPartitionDirectory_partition(LabelPartitionDirectory *self, Vertex *vertex, int direction) {
+    Graph *graph = Fabric_EdgeStore_get_graph(self->store);
+    vertexid_t vertex_id = Fabric_Vertex_get_id(vertex);
+    LabelPartitionItem *items;
+    LabelPartition *partition;
+    edgeid_t *sorted = NULL;
+    uint32_t num_items = 0, items_cap, i, position, start;
+    edgeid_t old_next, new_next;
+    error_t status = FABRIC_OK;
+
+    if (Fabric_LabelPartitionDirectory_is_partitioned(self, vertex_id, direction)) {
+        return FABRIC_OK;
+    }
+    partition = Fabric_LabelPartitionDirectory__add(self, vertex_id, direction, &status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    items = Fabric_LabelPartitionDirectory__read_list(self, vertex, direction, partition, &items_cap, &status);
+    if (FABRIC_OK == status && partition->num_groups > Fabric_LabelPartitionDirectory__max_groups(self)) {
+        status = FABRIC_EDGESTORE_TOO_MANY_LABELS;
+    }
+    for (i = 0; i < partition->num_groups; i++) {
+        num_items += partition->groups[i].count;
+    }
+    if (FABRIC_OK == status && num_items > 0) {
+        sorted = Fabric_memalloc_tagged(num_items * sizeof(edgeid_t), FABRIC_MEM_INDEX);
+        if (NULL == sorted) {
+            status = Fabric_memerrno();
+        }
+    }
+    if (FABRIC_OK != status) {
+        if (NULL != items) {
+            Fabric_memfree_tagged(items, items_cap * sizeof(LabelPartitionItem), FABRIC_MEM_INDEX);
+        }
+        Fabric_LabelPartitionDirectory__remove(self, partition);
+        return status;
+    }
+
+    // Find where each group starts, then place the edges stably
+    for (i = 0, start = 0; i < partition->num_groups; i++) {
+        partition->groups[i].first_id = start;
+        start += partition->groups[i].count;
+    }
+    for (i = 0; i < num_items; i++) {
+        position = partition->groups[items[i].group].first_id++;
+        items[i].position = position;
+        sorted[position] = items[i].edge_id;
+    }
+    for (i = 0, start = 0; i < partition->num_groups; i++) {
+        partition->groups[i].first_id = sorted[start];
+        start += partition->groups[i].count;
+        partition->groups[i].last_id = sorted[start - 1];
+    }
+
+    // Rewrite the edges whose next edge moved
+    for (i = 0; i < num_items && FABRIC_OK == status; i++) {
+        old_next = i + 1 < num_items ? items[i + 1].edge_id : 0;
+        position = items[i].position;
+        new_next = position + 1 < num_items ? sorted[position + 1] : 0;
+        if (old_next != new_next) {
+            status = Fabric_LabelPartitionDirectory__set_next(self, items[i].edge_id, direction, new_next);
+        }
+    }
+    if (FABRIC_OK == status && num_items > 0 && items[0].edge_id != sorted[0]) {
+        if (FABRIC_DIRECTION_IN == direction) {
+            Fabric_Vertex_set_first_in_edge_id(vertex, sorted[0]);
+        } else {
+            Fabric_Vertex_set_first_out_edge_id(vertex, sorted[0]);
+        }
+        status = Fabric_VertexStore_update_vertex(Fabric_Graph_get_vertex_store(graph), vertex);
+    }
+
+    if (NULL != items) {
+        Fabric_memfree_tagged(items, items_cap * sizeof(LabelPartitionItem), FABRIC_MEM_INDEX);
+    }
+    if (NULL != sorted) {
+        Fabric_memfree_tagged(sorted, num_items * sizeof(edgeid_t), FABRIC_MEM_INDEX);
+    }
+    return status;
+}
+
+/**
+ * Writes the directory to its chain of index pages if it has changed
+ *
+ * Args:
+ *      self: A label partition directory
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_LabelPartitionDirectory_flush(LabelPartitionDirectory *self) {
+    IndexStore *store = Fabric_Graph_get_index_store(Fabric_EdgeStore_get_graph(self->store));
+    Graph *graph = Fabric_IndexStore_get_graph(store);
+    uint32_t page_size = store->page_size;
+    uint32_t page_number = 0, used = 0, entry_size, i, j;
+    LabelPartition *partition;
+    uint8_t *page, *entry;
+    uint32_t page_id;
+    error_t status;
+
+    if (!self->changed) {
+        return FABRIC_OK;
+    }
+    status = Fabric_IndexStore_reserve_root_pages(store);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    if (self->num_pages == 0 &&
+        FABRIC_OK != (status = Fabric_LabelPartitionDirectory__add_page(self, FABRIC_LABEL_PARTITION_PAGE_ID))) {
+        return status;
+    }
+    page = Fabric_memalloc_tagged(page_size, FABRIC_MEM_INDEX);
+    if (NULL == page) {
+        return Fabric_memerrno();
+    }
+
+    for (i = 0; i <= self->count && FABRIC_OK == status; i++) {
+        partition = i < self->count ? self->partitions[i] : NULL;
+        entry_size = NULL == partition ? 0 :
+            FABRIC_LABEL_PARTITION_ENTRY_HEADER_SIZE + partition->num_groups * FABRIC_LABEL_GROUP_SIZE;
+
+        // Write the page once it is full or every entry is in it
+        if (NULL == partition || FABRIC_LABEL_PARTITION_HEADER_SIZE + used + entry_size > page_size) {
+            if (NULL != partition && page_number + 1 == self->num_pages) {
+                page_id = Fabric_IndexStore_allocate_page(store, &status);
+                if (FABRIC_OK != status ||
+                    FABRIC_OK != (status = Fabric_LabelPartitionDirectory__add_page(self, page_id))) {
+                    break;
+                }
+            }
+            page[0] = FABRIC_LABEL_PARTITION_TYPE;
+            page[1] = page[2] = page[3] = 0;
+            *(uint32_t*)(page + 4) = htobe32(NULL == partition ? 0 : self->page_ids[page_number + 1]);
+            *(uint32_t*)(page + 8) = htobe32(used);
+            status = Fabric_Graph_write_bytes(graph, page, FABRIC_LABEL_PARTITION_HEADER_SIZE + used,
+                Fabric_IndexStore_get_page_offset(store, self->page_ids[page_number]));
+            Fabric_stats_add(FABRIC_STAT_RECORDS_WRITTEN + FABRIC_STATS_INDEX_STORE, 1);
+            page_number++;
+            used = 0;
+        }
+        if (NULL == partition) {
+            break;
+        }
+
+        entry = page + FABRIC_LABEL_PARTITION_HEADER_SIZE + used;
+        *(uint32_t*)entry = htobe32(partition->vertex_id);
+        entry[4] = partition->direction;
+        entry[5] = 0;
+        *(uint16_t*)(entry + 6) = htobe16(partition->num_groups);
+        entry += FABRIC_LABEL_PARTITION_ENTRY_HEADER_SIZE;
+        for (j = 0; j < partition->num_groups; j++, entry += FABRIC_LABEL_GROUP_SIZE) {
+            *(uint32_t*)entry = htobe32(partition->groups[j].label_id);
+            *(uint32_t*)(entry + 4) = htobe32(partition->groups[j].first_id);
+            *(uint32_t*)(entry + 8) = htobe32(partition->groups[j].last_id);
+            *(uint32_t*)(entry + 12) = htobe32(partition->groups[j].count);
+        }
+        used += entry_size;
+    }
+    Fabric_memfree_tagged(page, page_size, FABRIC_MEM_INDEX);
+    if (FABRIC_OK == status) {
+        self->changed = FALSE;
+    }
+    return status;
+}
+
+#endif
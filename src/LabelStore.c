@@ -3,7 +3,7 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 23, 2015
- * Updated: March 31, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_LABELSTORE_C__
@@ -26,15 +26,23 @@
  */
 typedef struct LabelStore {
     uint32_t offset;        // graph file offset for the label store
-    uint32_t size;          // the size of the label store
+    ExtentList extents;     // The regions of the file that hold the label store
     uint32_t num_labels;    // The number of labels used by the graph
-    uint32_t next_free_id;  // The next available index id
     uint32_t last_free_id;  // The last label id available
                              // Always points to an previously unwritten portion of the file
-    EntityMap *cache;        // A cache of Label objects
+    FreeIdMap free_ids;     // The freed ids below last_free_id
+    EntityCache *cache;        // A cache of Label objects
     IdSet *changed;          // A list of changed labels that need to be written
 } LabelStore;
 
+/**
+ * Internal function used by the cache to free evicted labels
+ */
+static
+void Fabric_LabelStore__destroy_label(void *label) {
+    Fabric_Label_destroy(label);
+}
+
 /**
  * Initializes a label store object
  *
@@ -45,86 +53,232 @@ typedef struct LabelStore {
  * Returns: FABRIC_OK on success or other error code on failure
  */
 error_t Fabric_LabelStore_init(LabelStore *self) {
+    error_t status;
+    labelid_t first_free_id;
+    uint8_t header[3 * sizeof(uint32_t)];
     Graph *graph = Fabric_LabelStore_get_graph(self);
-    self->size = Fabric_Graph_get_vertex_store_offset(graph) - self->offset;
-    self->num_labels = Fabric_Graph_read_uint16(graph, self->offset);
-    self->next_free_id = Fabric_Graph_read_uint16(graph, self->offset + 4);
-    self->last_free_id = Fabric_Graph_read_uint16(graph, self->offset + 8);
+    Fabric_Graph_read_store_header(graph, header, sizeof(header), self->offset);
+    self->num_labels = betoh32(*(uint32_t*)header);
+    first_free_id = betoh32(*(uint32_t*)(header + 4));
+    self->last_free_id = betoh32(*(uint32_t*)(header + 8));
+    // A new store's header is zeroed but label ids start at 1
+    if (self->last_free_id == 0) {
+        first_free_id = 1;
+        self->last_free_id = 1;
+    }
 
-    self->cache = Fabric_EntityMap_new(&status);
+    self->cache = NULL;
+    self->changed = NULL;
+    Fabric_FreeIdMap_init(&self->free_ids);
+    status = Fabric_FreeIdMap_load(&self->free_ids, graph, FABRIC_LABEL_STORE, self->last_free_id);
+    if (FABRIC_FREEIDMAP_MISSING == status) {
+        // Older graphs link the free ids through the refs of free labels
+        status = Fabric_FreeIdMap_load_list(&self->free_ids, graph, &self->extents,
+            first_free_id, self->last_free_id, sizeof(textid_t), sizeof(uint32_t));
+    }
     if (FABRIC_OK != status) {
         return status;
     }
+    // Changed labels are pinned in the cache until they are written
     self->changed = Fabric_IdSet_new(&status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    self->cache = Fabric_EntityCache_new(
+        FABRIC_LABEL_CACHE_SIZE,
+        FABRIC_CACHE_POLICY,
+        self->changed,
+        Fabric_LabelStore__destroy_label,
+        &status);
+    if (FABRIC_OK != status) {
+        Fabric_IdSet_destroy(self->changed);
+        self->changed = NULL;
+    }
     return status;
 }
 
+/**
+ * Frees the memory used by a label store, including its cached labels
+ *
+ * Changes that have not been flushed are lost.
+ */
+void Fabric_LabelStore_deinit(LabelStore *self) {
+    if (NULL != self->cache) {
+        Fabric_EntityCache_destroy(self->cache);
+        self->cache = NULL;
+    }
+    if (NULL != self->changed) {
+        Fabric_IdSet_destroy(self->changed);
+        self->changed = NULL;
+    }
+    Fabric_FreeIdMap_deinit(&self->free_ids);
+}
+
 /**
  * Internal function for calculating the file offset of a label
  */
 static inline uint32_t Fabric_LabelStore__get_id_offset(LabelStore *self, labelid_t label_id){
-    return (label_id - 1) * FABRIC_LABEL_STORAGE_SIZE + self->offset + FABRIC_LABELSTORE_HEADER_SIZE;
+    return Fabric_ExtentList_get_record_offset(&self->extents, label_id);
 }
 
-error_t Fabric_LabelStore_flush(LabelStore *self) {
-    // TODO: this is a stub
+/**
+ * Internal function that serializes a changed label for the flush
+ */
+static
+void Fabric_LabelStore__serialize(void *store, uint32_t label_id, uint8_t *destination) {
+    LabelStore *self = store;
+    // If the label has been changed, it MUST be in the cache
+    Fabric_Label_load_bytes(Fabric_EntityCache_get(self->cache, label_id), destination);
+}
+
+/**
+ * Internal function that saves the label store's free id map and writes its header
+ *
+ * The free ids are all in the saved map, so the header's next free id
+ * is the same as its last free id.
+ */
+static
+error_t Fabric_LabelStore__write_header(LabelStore *self) {
+    Graph *graph = Fabric_LabelStore_get_graph(self);
+    error_t status = Fabric_FreeIdMap_save(&self->free_ids, graph, FABRIC_LABEL_STORE);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    // Write the label store's header
+    Fabric_Graph_update_uint32(graph, self->num_labels, self->offset);
+    Fabric_Graph_update_uint32(graph, self->last_free_id, self->offset + 4);
+    Fabric_Graph_update_uint32(graph, self->last_free_id, self->offset + 8);
+
     return FABRIC_OK;
 }
 
+/**
+ * Writes updates to the label store to file.
+ *
+ * The changed labels are written in file order, with adjacent labels
+ * written together, and the header is only rewritten if it changed.
+ *
+ * Args:
+ *      self: The label store whose data is being persisted
+ *
+ * Returns:
+ *      FABRIC_OK if the write is successful
+ *      A memory error if there is not enough memory to complete the action
+ *      FABRIC_LABELSTORE_NEEDS_RESIZE if the label store must be resized
+ *          before it can complete the write
+ */
+error_t Fabric_LabelStore_flush(LabelStore *self) {
+    if (Fabric_IdSet_is_empty(self->changed)){
+        // Ids freed without changing a record only need the header
+        return Fabric_FreeIdMap_is_changed(&self->free_ids) ? Fabric_LabelStore__write_header(self) : FABRIC_OK;
+    }
+    uint64_t started = Fabric_stats_now();
+
+    error_t status;
+    uint32_t *changed_ids = Fabric_IdSet_to_array(self->changed, &status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    int num_ids = Fabric_IdSet_get_count(self->changed);
+    int num_writable = 0;
+    int i;
+    labelid_t max_changed_id = 0;
+    Graph *graph = Fabric_LabelStore_get_graph(self);
+
+    // Grow the store to fit every label; labels that still don't fit
+    // stay in the changed set
+    for (i = 0; i < num_ids; i++) {
+        if (changed_ids[i] > max_changed_id) {
+            max_changed_id = changed_ids[i];
+        }
+    }
+    Fabric_Graph_grow_store(graph, FABRIC_LABEL_STORE, max_changed_id);
+    for (i = 0; i < num_ids; i++) {
+        if (changed_ids[i] <= self->extents.capacity) {
+            changed_ids[num_writable++] = changed_ids[i];
+        }
+    }
+
+    status = Fabric_Graph_write_records(
+        graph,
+        changed_ids,
+        num_writable,
+        &self->extents,
+        Fabric_LabelStore__serialize,
+        self);
+    Fabric_stats_add(FABRIC_STAT_FLUSHES + FABRIC_STATS_LABEL_STORE, 1);
+    Fabric_stats_add_elapsed(FABRIC_STAT_FLUSH_NANOS + FABRIC_STATS_LABEL_STORE, started);
+
+    if (FABRIC_OK == status) {
+        Fabric_stats_add(FABRIC_STAT_RECORDS_WRITTEN + FABRIC_STATS_LABEL_STORE, num_writable);
+        for (i = 0; i < num_writable; i++) {
+            Fabric_IdSet_remove(self->changed, changed_ids[i]);
+        }
+        if (num_writable < num_ids) {
+            status = FABRIC_LABELSTORE_NEEDS_RESIZE;
+        }
+    }
+    Fabric_memfree(changed_ids, sizeof(uint32_t) * num_ids);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    return Fabric_LabelStore__write_header(self);
+}
+
 /**
  * Internal function for getting and updating the next id for a label
+ *
+ * The lowest freed id is reused before a new one is taken from the end
+ * of the store.
  */
 static
 labelid_t Fabric_LabelStore__next_id(LabelStore *self) {
-    uint32_t next_id_offset;
-    Graph *g;
-    classid_t next_free_id = self->next_free_id;
-    if (self->next_free_id == self->last_free_id) {
-        self->next_free_id++;
-        self->last_free_id++;
-    } else if (Fabric_EntityMap_has_key(self->cache, next_free_id)) {
-        // The next free id for a free label is stored at the refs offset
-        self->next_free_id = Fabric_Label_get_refs(Fabric_EntityMap_get(self->cache, next_free_id));
-        // TODO is there a case when such a label would not be in the changed set?
-    }
-    else {
-        g = Fabric_LabelStore_get_graph(self);
-        next_id_offset = Fabric_LabelStore__get_id_offset(self, next_free_id);
-        self->next_free_id = Fabric_Graph_read_uint32(g, next_id_offset + sizeof(textid_t));
+    labelid_t label_id = Fabric_FreeIdMap_take(&self->free_ids);
+    if (0 == label_id) {
+        label_id = self->last_free_id++;
     }
-    return next_free_id;
+    return label_id;
 }
 
+/**
+ * Internal function that frees a label's id so that it can be given out again
+ *
+ * If the free id map can't grow the id is never reused.
+ */
 static
-inline
-void Fabric_LabelStore__add_free_id(LabelStore *self, Label *label) {
-    Fabric_Label_set_refs(label, self->next_free_id);
-    self->next_free_id = Fabric_Label_get_id(label);
+void Fabric_LabelStore__add_free_id(LabelStore *self, labelid_t label_id) {
+    if (label_id + 1 == self->last_free_id) {
+        self->last_free_id--;
+    } else {
+        Fabric_FreeIdMap_add(&self->free_ids, label_id);
+    }
 }
 
 Label* Fabric_LabelStore_get_label(LabelStore *self, uint32_t label_id, error_t *status) {
-    Label *label = Fabric_EntityMap_get(self->cache, label_id);
+    Label *label = Fabric_EntityCache_get(self->cache, label_id);
     uint32_t offset;
     uint8_t data[FABRIC_LABEL_STORAGE_SIZE];
     Graph *g;
     *status = FABRIC_OK;
 
     if (!label) {
-        offset = Fabric_LabelStore__get_id_offset(self, label_id);
-        if (offset > self->size + self->offset || label_id < 1) {
+        if (label_id < 1 || label_id > self->extents.capacity) {
             *status = FABRIC_LABELSTORE_INVALID_ID;
             return label;
         }
+        offset = Fabric_LabelStore__get_id_offset(self, label_id);
         g = Fabric_LabelStore_get_graph(self);
         Fabric_Graph_read_bytes(g, data, FABRIC_LABEL_STORAGE_SIZE, offset);
+        Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_LABEL_STORE, 1);
         label = Fabric_Label_new(label_id, status);
         if (*status != FABRIC_OK) {
             // label should be NULL here
             return label;
         }
         *status = Fabric_Label_init(label, data);
-        // TODO decide what labels should be cached
-        Fabric_EntityMap_set(self->cache, label_id, label);
+        Fabric_EntityCache_set(self->cache, label_id, label);
     }
 
     // make sure the label is valid
@@ -141,24 +295,37 @@ Label* Fabric_LabelStore_get_label_by_name(LabelStore *self, text_t name, error_
     Graph *g = Fabric_LabelStore_get_graph(self);
     IndexStore *is = Fabric_Graph_get_index_store(g);
     LabelIndex *li = Fabric_IndexStore_get_label_index(is, status);
-    if (FABRIC_OK != status) {
+    if (FABRIC_OK != *status) {
         return NULL;
     }
 
     labelid_t id = Fabric_LabelIndex_get_label_id(li, name, status);
-    if (FABRIC_OK != status) {
+    if (FABRIC_OK != *status) {
         return NULL;
     } else if (id == 0) {
         *status = FABRIC_LABEL_DOESNT_EXIST;
         return NULL;
     }
 
-    return Fabric_LabelStore_get_class(self, id, status);
+    return Fabric_LabelStore_get_label(self, id, status);
 }
 
 
+/**
+ * Adds a reference to the label with a given text, creating the label
+ * if there isn't one
+ *
+ * A new label's text is saved in the text store and interned in the
+ * label index.
+ *
+ * Args:
+ *      self: A graph's label store
+ *      name: The label's text
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The id of the label or 0 on failure
+ */
 labelid_t Fabric_LabelStore_add_label(LabelStore *self, text_t name, error_t *status) {
-    // TODO: This is a stub
     Label *label = Fabric_LabelStore_get_label_by_name(self, name, status);
     Graph *g;
     TextStore *ts;
@@ -170,29 +337,31 @@ labelid_t Fabric_LabelStore_add_label(LabelStore *self, text_t name, error_t *st
     if (FABRIC_LABEL_DOESNT_EXIST == *status) {
         // TODO: refactor into another method
         g = Fabric_LabelStore_get_graph(self);
-        ts = Fabric_Graph_get_label_store(g);
+        ts = Fabric_Graph_get_text_store(g);
 
-        if (FABRIC_OK != *status) {
-            return 0;
-        }
-        next_id = Fabric_LabelStore_next_id(self);
+        next_id = Fabric_LabelStore__next_id(self);
         label = Fabric_Label_new(next_id, status);
         if (FABRIC_OK != *status ||
             0 == (text_id = Fabric_TextStore_create_text(ts, name, status))) {
-            Fabric_LabelStore__add_free_id(self, label);
+            if (NULL != label) {
+                Fabric_Label_destroy(label);
+            }
+            Fabric_LabelStore__add_free_id(self, next_id);
             return 0;
         }
         Fabric_Label_set_text_id(label, text_id);
         Fabric_Label_set_refs(label, 0);
         is = Fabric_Graph_get_index_store(g);
-        Fabric_IndexStore_add_label_to_index(is, label, status);
+        *status = Fabric_IndexStore_add_label_to_index(is, label, name);
         if (FABRIC_OK != *status) {
             // clean up
             Fabric_Label_set_text_id(label, 0);
-            Fabric_LabelStore__add_free_id(self, label);
+            Fabric_LabelStore__add_free_id(self, next_id);
             Fabric_TextStore_delete_text(ts, text_id);
+            Fabric_Label_destroy(label);
             return 0;
         }
+        self->num_labels++;
 
     } else if (FABRIC_OK != *status) {
         return 0;
@@ -201,10 +370,10 @@ labelid_t Fabric_LabelStore_add_label(LabelStore *self, text_t name, error_t *st
         next_id = Fabric_Label_get_id(label);
     }
     
-    if (FABRIC_OK != (stat = Fabric_EntityMap_set(self->cache, next_id, label)) ||
-        FABRIC_OK != (stat = Fabric_IdSet_add(self->changed, next_id))) {
+    if (FABRIC_OK != (stat = Fabric_IdSet_add(self->changed, next_id)) ||
+        FABRIC_OK != (stat = Fabric_EntityCache_set(self->cache, next_id, label))) {
         if (text_id != 0) {
-            Fabric_LabelStore__add_free_id(self, label);
+            Fabric_LabelStore__add_free_id(self, next_id);
             Fabric_Label_set_text_id(label, 0);
             Fabric_TextStore_delete_text(ts, text_id);
         }
@@ -217,6 +386,33 @@ labelid_t Fabric_LabelStore_add_label(LabelStore *self, text_t name, error_t *st
     return next_id;
 }
 
+/**
+ * Gets the text of a label
+ *
+ * The text is interned by the label index; it must not be freed or
+ * changed.
+ *
+ * Args:
+ *      self: A graph's label store
+ *      label_id: The id of the label
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The null terminated text of the label or NULL on failure
+ */
+text_t Fabric_LabelStore_get_label_name(LabelStore *self, labelid_t label_id, error_t *status) {
+    Graph *g = Fabric_LabelStore_get_graph(self);
+    LabelIndex *li = Fabric_IndexStore_get_label_index(Fabric_Graph_get_index_store(g), status);
+    text_t name;
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    name = Fabric_LabelIndex_get_text(li, label_id);
+    if (NULL == name) {
+        *status = FABRIC_LABEL_DOESNT_EXIST;
+    }
+    return name;
+}
+
 error_t Fabric_LabelStore_remove_label(LabelStore *self, labelid_t label_id) {
     // TODO: This is a stub
     return FABRIC_OK;
@@ -3,7 +3,7 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 25, 2015
- * Updated: March 25, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_MEMORY_C__
@@ -22,66 +22,319 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+#ifndef FABRIC_NO_THREADS
+#  include <pthread.h>
+#endif
 #include "Internal.h"
 
-int _fabric_mem_errno = FABRIC_OK;
-size_t _fabric_mem_used;
+/**
+ * Memory usage is counted per thread so that threads allocating at the
+ * same time don't contend for one counter.  Each thread that allocates
+ * gets a block of counters, one per FABRIC_MEM_* tag, that only it writes
+ * to.  Fabric_memused adds up every thread's block when it is asked.
+ * Memory can be freed by a different thread than the one that allocated
+ * it, so a single thread's count can wrap below zero; only the totals
+ * are meaningful.
+ *
+ * When a thread exits its counts are folded into the retired block so
+ * the totals stay correct.  The error number is also kept per thread.
+ *
+ * Defining FABRIC_NO_THREADS uses a single block of counters instead.
+ *
+ * The process can be given a memory budget with Fabric_memset_budget.
+ * Adding up the counters for every allocation would make threads contend
+ * again, so each thread checks the totals against the budget once it has
+ * allocated FABRIC_MEM_BUDGET_CHECK_SIZE bytes since its last check.  An
+ * allocation that finds the process over budget still succeeds, but sets
+ * the thread's error number to FABRIC_MEM_OVER_BUDGET as a warning, well
+ * before allocations start failing with FABRIC_OUT_OF_MEMORY.
+ *
+ * Every check that finds the process over budget, and the first one that
+ * finds it back under, changes the memory pressure number returned by
+ * Fabric_mempressure.  Graphs watch the number and shrink or restore
+ * their caches when it changes, as described in Graph.c.  The process is
+ * only back under budget once it is using less than 7/8 of it, so that
+ * caches aren't restored as soon as they have been shrunk.
+ */
+typedef struct MemCounters {
+    size_t used[FABRIC_MEM_NUM_TAGS];   // Bytes in use for each tag
+    size_t reserved;                    // Bytes held by slab chunks
+    size_t unchecked;                   // Bytes allocated since the budget was last checked
+    struct MemCounters *next;           // The next thread's counters
+} MemCounters;
+
+static MemCounters _fabric_mem_retired;
+static size_t _fabric_mem_budget = 0;
+static uint32_t _fabric_mem_pressure = 0;
+static bool_t _fabric_mem_over_budget = FALSE;
+
+#ifndef FABRIC_NO_THREADS
+static __thread MemCounters *_fabric_mem_counters;
+static __thread int _fabric_mem_errno = FABRIC_OK;
+static pthread_mutex_t _fabric_mem_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t _fabric_mem_once = PTHREAD_ONCE_INIT;
+static pthread_key_t _fabric_mem_key;
+
+// Only the owning thread writes a block, but other threads read it
+#  define FABRIC_MEM_ADD(field, delta) __atomic_store_n(&(field), (field) + (delta), __ATOMIC_RELAXED)
+#  define FABRIC_MEM_LOAD(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+#  define FABRIC_MEM_STORE(field, value) __atomic_store_n(&(field), (value), __ATOMIC_RELAXED)
+#  define FABRIC_MEM_INCREMENT(field) __atomic_add_fetch(&(field), 1, __ATOMIC_RELAXED)
+#else
+static MemCounters *_fabric_mem_counters = &_fabric_mem_retired;
+static int _fabric_mem_errno = FABRIC_OK;
+
+#  define FABRIC_MEM_ADD(field, delta) ((field) += (delta))
+#  define FABRIC_MEM_LOAD(field) (field)
+#  define FABRIC_MEM_STORE(field, value) ((field) = (value))
+#  define FABRIC_MEM_INCREMENT(field) (++(field))
+#endif
+
+#ifndef FABRIC_NO_THREADS
+/**
+ * Private function that folds an exiting thread's counts into the
+ * retired block
+ */
+static
+void Fabric_mem__retire_counters(void *arg) {
+    MemCounters *counters = arg;
+    MemCounters *previous;
+    int i;
+
+    pthread_mutex_lock(&_fabric_mem_lock);
+    for (i = 0; i < FABRIC_MEM_NUM_TAGS; i++) {
+        _fabric_mem_retired.used[i] += counters->used[i];
+    }
+    _fabric_mem_retired.reserved += counters->reserved;
+    for (previous = &_fabric_mem_retired; previous->next != counters; previous = previous->next);
+    previous->next = counters->next;
+    pthread_mutex_unlock(&_fabric_mem_lock);
+    free(counters);
+}
+
+/**
+ * Private function that creates the key used to retire counters
+ */
+static
+void Fabric_mem__create_key() {
+    pthread_key_create(&_fabric_mem_key, Fabric_mem__retire_counters);
+}
+#endif
+
+/**
+ * Private function that returns the calling thread's counters
+ *
+ * A thread's counters are created the first time it allocates.  If they
+ * can't be, its counts go to the retired block instead; updating that
+ * block needs the lock, so FABRIC_MEM_ADD must not be used with it.
+ */
+static inline
+MemCounters *Fabric_mem__get_counters() {
+#ifndef FABRIC_NO_THREADS
+    MemCounters *counters;
+    if (NULL != _fabric_mem_counters) {
+        return _fabric_mem_counters;
+    }
+
+    pthread_once(&_fabric_mem_once, Fabric_mem__create_key);
+    counters = calloc(1, sizeof(MemCounters));
+    if (NULL == counters) {
+        return NULL;
+    }
+    pthread_mutex_lock(&_fabric_mem_lock);
+    counters->next = _fabric_mem_retired.next;
+    _fabric_mem_retired.next = counters;
+    pthread_mutex_unlock(&_fabric_mem_lock);
+    pthread_setspecific(_fabric_mem_key, counters);
+    _fabric_mem_counters = counters;
+#endif
+    return _fabric_mem_counters;
+}
+
+/**
+ * Private function that compares the memory in use with the budget
+ */
+static
+void Fabric_mem__check_budget() {
+    size_t budget = FABRIC_MEM_LOAD(_fabric_mem_budget);
+    size_t used = Fabric_memused();
+
+    if (budget != 0 && used > budget) {
+        _fabric_mem_errno = FABRIC_MEM_OVER_BUDGET;
+        FABRIC_MEM_STORE(_fabric_mem_over_budget, TRUE);
+        FABRIC_MEM_INCREMENT(_fabric_mem_pressure);
+    } else if (budget == 0 || used < budget - budget / 8) {
+        if (FABRIC_MEM_OVER_BUDGET == _fabric_mem_errno) {
+            _fabric_mem_errno = FABRIC_OK;
+        }
+        if (FABRIC_MEM_LOAD(_fabric_mem_over_budget)) {
+            FABRIC_MEM_STORE(_fabric_mem_over_budget, FALSE);
+            FABRIC_MEM_INCREMENT(_fabric_mem_pressure);
+        }
+    }
+}
+
+/**
+ * Private function that adds to the calling thread's count for a tag
+ */
+static inline
+void Fabric_mem__count(int tag, size_t delta) {
+    MemCounters *counters = Fabric_mem__get_counters();
+    if (NULL != counters) {
+        FABRIC_MEM_ADD(counters->used[tag], delta);
+        // Frees are counted with negative deltas
+        if ((intptr_t)delta > 0 && FABRIC_MEM_LOAD(_fabric_mem_budget) != 0) {
+            counters->unchecked += delta;
+            if (counters->unchecked >= FABRIC_MEM_BUDGET_CHECK_SIZE) {
+                counters->unchecked = 0;
+                Fabric_mem__check_budget();
+            }
+        }
+        return;
+    }
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_lock(&_fabric_mem_lock);
+    _fabric_mem_retired.used[tag] += delta;
+    pthread_mutex_unlock(&_fabric_mem_lock);
+#endif
+}
+
+/**
+ * Private function that adds to the calling thread's count of slab
+ * chunk bytes
+ */
+static inline
+void Fabric_mem__count_reserved(size_t delta) {
+    MemCounters *counters = Fabric_mem__get_counters();
+    if (NULL != counters) {
+        FABRIC_MEM_ADD(counters->reserved, delta);
+        return;
+    }
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_lock(&_fabric_mem_lock);
+    _fabric_mem_retired.reserved += delta;
+    pthread_mutex_unlock(&_fabric_mem_lock);
+#endif
+}
 
 /**
  * Initializes Fabric's memory system.
  *
- * Right now it doesn't do anything
+ * Every thread's counts are reset to zero, so it should be called
+ * before any other threads start allocating.
  *
  * Returns: FABRIC_OK on success, otherwise an error code
  */
 int Fabric_meminit() {
-    _fabric_mem_used = 0;
+    MemCounters *counters;
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_lock(&_fabric_mem_lock);
+#endif
+    for (counters = &_fabric_mem_retired; NULL != counters; counters = counters->next) {
+        memset(counters->used, 0, sizeof(counters->used));
+        counters->reserved = 0;
+    }
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_unlock(&_fabric_mem_lock);
+#endif
     return FABRIC_OK;
 }
 
 /**
- * Allocates memory and returns a pointer to it
+ * Allocates memory and counts it against a subsystem
+ *
+ * Memory allocated with a tag must be freed with the same tag.
  *
  * Args:
  *      size: The number of bytes to allocate
+ *      tag: One of the FABRIC_MEM_* tags
  *
  * Returns: A pointer to the allocated memory on success
  *          NULL on failure with fabric_mem_errno set to a value
  *              other than FABRIC_OK
  */
-void *Fabric_memalloc(size_t size) {
-    _fabric_mem_used += size;
+void *Fabric_memalloc_tagged(size_t size, int tag) {
+    void *ptr;
     if (size < 1) {
         return NULL;
     }
-    void *ptr = malloc(size);
+    ptr = malloc(size);
     if (!ptr) {
         _fabric_mem_errno = FABRIC_OUT_OF_MEMORY;
+        return NULL;
     }
+    Fabric_mem__count(tag, size);
     return ptr;
 }
 
 /**
- * Reallocates a block of memory
+ * Allocates memory and returns a pointer to it
+ *
+ * Args:
+ *      size: The number of bytes to allocate
+ *
+ * Returns: A pointer to the allocated memory on success
+ *          NULL on failure with fabric_mem_errno set to a value
+ *              other than FABRIC_OK
+ */
+void *Fabric_memalloc(size_t size) {
+    return Fabric_memalloc_tagged(size, FABRIC_MEM_GENERAL);
+}
+
+/**
+ * Reallocates a block of memory counted against a subsystem
  *
  * Args:
  *      old_ptr: The current point being reallocated
  *      new_size: The number of bytes to allocate
  *      old_size: The size of the memory block pointed to by old_ptr
+ *      tag: The FABRIC_MEM_* tag the block was allocated with
  *
  * Returns: A pointer to the allocated memory on success
  *          NULL on failure with fabric_mem_errno set to a value
  *              other than FABRIC_OK
  */
-void *Fabric_memrealloc(void *old_ptr, size_t new_size, size_t old_size) {
-    _fabric_mem_used += new_size - old_size;
+void *Fabric_memrealloc_tagged(void *old_ptr, size_t new_size, size_t old_size, int tag) {
     void *new_ptr = realloc(old_ptr, new_size);
     if (!new_ptr && new_size != 0) {
+        // The old block is still allocated
         _fabric_mem_errno = FABRIC_OUT_OF_MEMORY;
+        return NULL;
     }
+    Fabric_mem__count(tag, new_size - old_size);
     return new_ptr;
 }
 
+/**
+ * Reallocates a block of memory
+ *
+ * Args:
+ *      old_ptr: The current point being reallocated
+ *      new_size: The number of bytes to allocate
+ *      old_size: The size of the memory block pointed to by old_ptr
+ *
+ * Returns: A pointer to the allocated memory on success
+ *          NULL on failure with fabric_mem_errno set to a value
+ *              other than FABRIC_OK
+ */
+void *Fabric_memrealloc(void *old_ptr, size_t new_size, size_t old_size) {
+    return Fabric_memrealloc_tagged(old_ptr, new_size, old_size, FABRIC_MEM_GENERAL);
+}
+
+/**
+ * Frees memory that was counted against a subsystem
+ *
+ * Args:
+ *      ptr: A pointer to memory being freed
+ *      size: The size of the data being freed
+ *      tag: The FABRIC_MEM_* tag the memory was allocated with
+ */
+void Fabric_memfree_tagged(void *ptr, size_t size, int tag) {
+    Fabric_mem__count(tag, -size);
+    free(ptr);
+}
+
 /**
  * Frees the memory pointed to by ptr
  *
@@ -90,22 +343,358 @@ void *Fabric_memrealloc(void *old_ptr, size_t new_size, size_t old_size) {
  *      size: The size of the data being freed
  */
 void Fabric_memfree(void* ptr, size_t size) {
-    _fabric_mem_used -= size;
-    free(ptr);
+    Fabric_memfree_tagged(ptr, size, FABRIC_MEM_GENERAL);
+}
+
+/**
+ * A Memory Slab hands out objects of a single fixed size
+ *
+ * Objects are carved out of chunks of FABRIC_MEMSLAB_CHUNK_SIZE bytes
+ * and freed objects are kept on a free list for reuse, so allocating
+ * and freeing are O(1) and don't call malloc for every entity loaded
+ * from disk.  Chunks are only returned to the system by
+ * Fabric_memslab_release.
+ *
+ * Memory usage is accounted per object, so Fabric_memused reports the
+ * same values it would if each object had been allocated separately.
+ * The bytes reserved by chunks are reported by Fabric_memreserved.
+ *
+ * Each entity type owns a static slab, declared with
+ * FABRIC_MEMSLAB_INITIALIZER.  Since those slabs are shared by every
+ * graph and thread, each slab has a lock unless FABRIC_NO_THREADS is
+ * defined.  Defining FABRIC_NO_SLAB makes slabs fall back to
+ * Fabric_memalloc, which is useful with memory checkers.
+ */
+typedef struct MemSlab {
+    size_t object_size;     // The size of the objects as requested
+    size_t slot_size;       // The size of the objects including alignment padding
+    void *free_list;        // Freed objects; each one points to the next
+    void *chunks;           // Allocated chunks; each one points to the next
+    size_t num_chunks;      // The number of allocated chunks
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_t lock;   // Guards the free list and the chunks
+#endif
+} MemSlab;
+
+#ifndef FABRIC_NO_SLAB
+/**
+ * Private function that carves a new chunk into free objects
+ */
+static
+error_t Fabric_memslab__add_chunk(MemSlab *slab) {
+    size_t header = (sizeof(void*) + FABRIC_MEMSLAB_ALIGNMENT - 1) & ~(size_t)(FABRIC_MEMSLAB_ALIGNMENT - 1);
+    size_t chunk_size = FABRIC_MEMSLAB_CHUNK_SIZE;
+    uint8_t *chunk;
+    uint8_t *object;
+
+    if (slab->slot_size == 0) {
+        slab->slot_size = slab->object_size < sizeof(void*) ? sizeof(void*) : slab->object_size;
+        slab->slot_size = (slab->slot_size + FABRIC_MEMSLAB_ALIGNMENT - 1) & ~(size_t)(FABRIC_MEMSLAB_ALIGNMENT - 1);
+    }
+    if (chunk_size < header + slab->slot_size) {
+        chunk_size = header + slab->slot_size;
+    }
+
+    chunk = malloc(chunk_size);
+    if (NULL == chunk) {
+        _fabric_mem_errno = FABRIC_OUT_OF_MEMORY;
+        return FABRIC_OUT_OF_MEMORY;
+    }
+    Fabric_mem__count_reserved(chunk_size);
+
+    *(void**)chunk = slab->chunks;
+    slab->chunks = chunk;
+    slab->num_chunks++;
+
+    for (object = chunk + header; object + slab->slot_size <= chunk + chunk_size; object += slab->slot_size) {
+        *(void**)object = slab->free_list;
+        slab->free_list = object;
+    }
+    return FABRIC_OK;
+}
+#endif
+
+/**
+ * Allocates an object from a slab
+ *
+ * Args:
+ *      slab: The slab for the object's type
+ *
+ * Returns: A pointer to the object's memory on success
+ *          NULL on failure with fabric_mem_errno set to a value
+ *              other than FABRIC_OK
+ */
+void *Fabric_memslab_alloc(MemSlab *slab) {
+#ifdef FABRIC_NO_SLAB
+    return Fabric_memalloc(slab->object_size);
+#else
+    void *object;
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_lock(&slab->lock);
+#endif
+    if (NULL == slab->free_list && FABRIC_OK != Fabric_memslab__add_chunk(slab)) {
+#ifndef FABRIC_NO_THREADS
+        pthread_mutex_unlock(&slab->lock);
+#endif
+        return NULL;
+    }
+    object = slab->free_list;
+    slab->free_list = *(void**)object;
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_unlock(&slab->lock);
+#endif
+    Fabric_mem__count(FABRIC_MEM_GENERAL, slab->object_size);
+    return object;
+#endif
+}
+
+/**
+ * Returns an object to its slab
+ *
+ * Args:
+ *      slab: The slab the object was allocated from
+ *      ptr: The object being freed
+ */
+void Fabric_memslab_free(MemSlab *slab, void *ptr) {
+#ifdef FABRIC_NO_SLAB
+    Fabric_memfree(ptr, slab->object_size);
+#else
+    if (NULL == ptr) {
+        return;
+    }
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_lock(&slab->lock);
+#endif
+    *(void**)ptr = slab->free_list;
+    slab->free_list = ptr;
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_unlock(&slab->lock);
+#endif
+    Fabric_mem__count(FABRIC_MEM_GENERAL, -slab->object_size);
+#endif
+}
+
+/**
+ * Returns all of a slab's chunks to the system
+ *
+ * Every object allocated from the slab must already have been freed.
+ */
+void Fabric_memslab_release(MemSlab *slab) {
+    void *chunk;
+    void *next;
+    size_t header = (sizeof(void*) + FABRIC_MEMSLAB_ALIGNMENT - 1) & ~(size_t)(FABRIC_MEMSLAB_ALIGNMENT - 1);
+    size_t chunk_size = FABRIC_MEMSLAB_CHUNK_SIZE;
+    if (chunk_size < header + slab->slot_size) {
+        chunk_size = header + slab->slot_size;
+    }
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_lock(&slab->lock);
+#endif
+    chunk = slab->chunks;
+    while (NULL != chunk) {
+        next = *(void**)chunk;
+        free(chunk);
+        Fabric_mem__count_reserved(-chunk_size);
+        chunk = next;
+    }
+    slab->chunks = NULL;
+    slab->free_list = NULL;
+    slab->num_chunks = 0;
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_unlock(&slab->lock);
+#endif
+}
+
+/**
+ * A Memory Arena hands out byte strings of any size
+ *
+ * Strings are carved one after another out of chunks of at least
+ * chunk_size bytes, so storing many short strings costs one malloc per
+ * chunk rather than one per string.  Strings can't be freed one at a
+ * time; all of an arena's chunks are returned to the system together by
+ * Fabric_memarena_release.  Allocations aren't aligned.
+ *
+ * An arena's chunks are counted against its FABRIC_MEM_* tag.
+ */
+typedef struct MemArena {
+    size_t chunk_size;      // The smallest chunk that is allocated
+    int tag;                // The tag the chunks are counted against
+    void *chunks;           // Allocated chunks; each one starts with a MemArenaChunk
+    uint8_t *next;          // The next free byte in the newest chunk
+    size_t remaining;       // The number of free bytes in the newest chunk
+} MemArena;
+
+typedef struct MemArenaChunk {
+    void *next;             // The chunk allocated before this one
+    size_t size;            // The size of the chunk including this header
+} MemArenaChunk;
+
+/**
+ * Initializes an empty arena
+ *
+ * Args:
+ *      arena: The arena being initialized
+ *      chunk_size: The smallest chunk the arena allocates
+ *      tag: The FABRIC_MEM_* tag the arena's memory is counted against
+ */
+void Fabric_memarena_init(MemArena *arena, size_t chunk_size, int tag) {
+    arena->chunk_size = chunk_size;
+    arena->tag = tag;
+    arena->chunks = NULL;
+    arena->next = NULL;
+    arena->remaining = 0;
+}
+
+/**
+ * Allocates bytes from an arena
+ *
+ * Args:
+ *      arena: The arena
+ *      size: The number of bytes to allocate
+ *
+ * Returns: A pointer to the bytes on success
+ *          NULL on failure with fabric_mem_errno set to a value
+ *              other than FABRIC_OK
+ */
+void *Fabric_memarena_alloc(MemArena *arena, size_t size) {
+    MemArenaChunk *chunk;
+    size_t chunk_size;
+    void *ptr;
+
+    if (size > arena->remaining) {
+        chunk_size = sizeof(MemArenaChunk) + size;
+        if (chunk_size < arena->chunk_size) {
+            chunk_size = arena->chunk_size;
+        }
+        chunk = Fabric_memalloc_tagged(chunk_size, arena->tag);
+        if (NULL == chunk) {
+            return NULL;
+        }
+        chunk->next = arena->chunks;
+        chunk->size = chunk_size;
+        arena->chunks = chunk;
+        arena->next = (uint8_t*)(chunk + 1);
+        arena->remaining = chunk_size - sizeof(MemArenaChunk);
+    }
+    ptr = arena->next;
+    arena->next += size;
+    arena->remaining -= size;
+    return ptr;
+}
+
+/**
+ * Frees everything allocated from an arena
+ *
+ * The arena is left empty and can be used again.
+ */
+void Fabric_memarena_release(MemArena *arena) {
+    MemArenaChunk *chunk = arena->chunks;
+    MemArenaChunk *next;
+    while (NULL != chunk) {
+        next = chunk->next;
+        Fabric_memfree_tagged(chunk, chunk->size, arena->tag);
+        chunk = next;
+    }
+    arena->chunks = NULL;
+    arena->next = NULL;
+    arena->remaining = 0;
+}
+
+/**
+ * Returns the number of bytes held by slab chunks
+ */
+size_t Fabric_memreserved() {
+    MemCounters *counters;
+    size_t reserved = 0;
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_lock(&_fabric_mem_lock);
+#endif
+    for (counters = &_fabric_mem_retired; NULL != counters; counters = counters->next) {
+        reserved += FABRIC_MEM_LOAD(counters->reserved);
+    }
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_unlock(&_fabric_mem_lock);
+#endif
+    return reserved;
+}
+
+/**
+ * Returns the amount of dynamically allocated memory counted against
+ * a subsystem
+ *
+ * Args:
+ *      tag: One of the FABRIC_MEM_* tags
+ */
+size_t Fabric_memused_tagged(int tag) {
+    MemCounters *counters;
+    size_t used = 0;
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_lock(&_fabric_mem_lock);
+#endif
+    for (counters = &_fabric_mem_retired; NULL != counters; counters = counters->next) {
+        used += FABRIC_MEM_LOAD(counters->used[tag]);
+    }
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_unlock(&_fabric_mem_lock);
+#endif
+    return used;
 }
 
 /**
  * Returns the amount of dynamically allocated memory fabric is using
  */
 size_t Fabric_memused() {
-    return _fabric_mem_used;
+    size_t used = 0;
+    int tag;
+    for (tag = 0; tag < FABRIC_MEM_NUM_TAGS; tag++) {
+        used += Fabric_memused_tagged(tag);
+    }
+    return used;
 }
 
 /**
- * Returns the fabric memory error number
+ * Returns the calling thread's fabric memory error number
+ *
+ * FABRIC_MEM_OVER_BUDGET is only a warning: the allocation that set it
+ * succeeded.
  */
 int Fabric_memerrno() {
     return _fabric_mem_errno;
 }
 
-#endif
\ No newline at end of file
+/**
+ * Sets the most memory the process should use
+ *
+ * The budget is checked as memory is allocated, starting with this call.
+ *
+ * Args:
+ *      budget: The budget in bytes, or 0 for no budget
+ */
+void Fabric_memset_budget(size_t budget) {
+    FABRIC_MEM_STORE(_fabric_mem_budget, budget);
+    Fabric_mem__check_budget();
+}
+
+/**
+ * Returns the process's memory budget in bytes, or 0 if it has none
+ */
+size_t Fabric_memget_budget() {
+    return FABRIC_MEM_LOAD(_fabric_mem_budget);
+}
+
+/**
+ * Returns whether the last check of the budget found the process over it
+ */
+bool_t Fabric_memis_over_budget() {
+    return FABRIC_MEM_LOAD(_fabric_mem_over_budget);
+}
+
+/**
+ * Returns a number that changes whenever the process is found over its
+ * budget, and when it is first found back under it
+ */
+uint32_t Fabric_mempressure() {
+    return FABRIC_MEM_LOAD(_fabric_mem_pressure);
+}
+
+#endif
@@ -0,0 +1,582 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_PREDICATE_C__
+#define _FABRIC_PREDICATE_C__
+
+#include <string.h>
+#include <math.h>
+#include "Internal.h"
+
+#if !defined(FABRIC_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define FABRIC_PREDICATE__X86 1
+#  include <immintrin.h>
+#endif
+
+/**
+ * A predicate compares property values with a constant: equal, less than,
+ * less than or equal, greater than, greater than or equal, an inclusive
+ * range or membership of a list of values.  Integers, reals, datetimes
+ * and short texts can be compared.  A value only matches a predicate on
+ * a value of the same kind, so an integer never matches a real.
+ *
+ * Every predicate is turned into a list of inclusive ranges of keys.  The
+ * key of an integer or a datetime is the value itself, and the key of a
+ * short text is its 8 bytes read as a big endian number with the sign bit
+ * flipped, so that the keys sort in the order of the texts.  The key of a
+ * real is the real; strict bounds are moved to the next real.  Equality
+ * is a range of one key and a list holds a range for each value.
+ *
+ * Predicates are evaluated many values at a time by kernels that test a
+ * block of keys against a range and set one bit of a selection bitmap for
+ * each key in the range: bit n % 8 of byte n / 8 for the nth key.  On x86
+ * there are AVX2 and SSE4.2 kernels, and the best one the processor
+ * supports is chosen the first time a predicate is evaluated.  The scalar
+ * kernels work everywhere.  Defining FABRIC_NO_SIMD leaves out the vector
+ * kernels.
+ */
+#define FABRIC_PREDICATE__INTEGER 1
+#define FABRIC_PREDICATE__DATETIME 2
+#define FABRIC_PREDICATE__REAL 3
+#define FABRIC_PREDICATE__TEXT 4
+
+/* The number of property records decoded into keys at a time */
+#define FABRIC_PREDICATE__BLOCK 256
+
+struct Predicate {
+    uint8_t kind;               // The kind of values the predicate compares
+    uint32_t num_ranges;        // The number of ranges; 0 matches nothing
+    int64_t low[FABRIC_PREDICATE_MAX_VALUES];       // The first key of each range
+    int64_t high[FABRIC_PREDICATE_MAX_VALUES];      // The last key of each range
+    float64_t real_low[FABRIC_PREDICATE_MAX_VALUES];    // The ranges of a real predicate
+    float64_t real_high[FABRIC_PREDICATE_MAX_VALUES];
+};
+
+typedef void (*Fabric_Predicate__integer_kernel)(const int64_t *keys, uint32_t count, int64_t low, int64_t high, uint8_t *bits);
+typedef void (*Fabric_Predicate__real_kernel)(const float64_t *keys, uint32_t count, float64_t low, float64_t high, uint8_t *bits);
+
+/**
+ * Private scalar kernel that ORs in a bit for each key in [low, high]
+ */
+static
+void Fabric_Predicate__integer_scalar(const int64_t *keys, uint32_t count, int64_t low, int64_t high, uint8_t *bits) {
+    uint32_t i, j;
+    uint8_t byte;
+    for (i = 0; i < count; i += 8) {
+        byte = 0;
+        for (j = 0; j < 8 && i + j < count; j++) {
+            byte |= (uint8_t)((keys[i + j] >= low) & (keys[i + j] <= high)) << j;
+        }
+        bits[i / 8] |= byte;
+    }
+}
+
+static
+void Fabric_Predicate__real_scalar(const float64_t *keys, uint32_t count, float64_t low, float64_t high, uint8_t *bits) {
+    uint32_t i, j;
+    uint8_t byte;
+    for (i = 0; i < count; i += 8) {
+        byte = 0;
+        for (j = 0; j < 8 && i + j < count; j++) {
+            byte |= (uint8_t)((keys[i + j] >= low) & (keys[i + j] <= high)) << j;
+        }
+        bits[i / 8] |= byte;
+    }
+}
+
+#ifdef FABRIC_PREDICATE__X86
+/**
+ * Private SSE4.2 kernels, testing two keys at a time
+ */
+__attribute__((target("sse4.2")))
+static
+void Fabric_Predicate__integer_sse4(const int64_t *keys, uint32_t count, int64_t low, int64_t high, uint8_t *bits) {
+    __m128i lows = _mm_set1_epi64x(low), highs = _mm_set1_epi64x(high);
+    __m128i x, outside;
+    uint32_t i, j, byte;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        byte = 0;
+        for (j = 0; j < 8; j += 2) {
+            x = _mm_loadu_si128((const __m128i*)(keys + i + j));
+            outside = _mm_or_si128(_mm_cmpgt_epi64(lows, x), _mm_cmpgt_epi64(x, highs));
+            byte |= (~_mm_movemask_pd(_mm_castsi128_pd(outside)) & 3) << j;
+        }
+        bits[i / 8] |= byte;
+    }
+    Fabric_Predicate__integer_scalar(keys + i, count - i, low, high, bits + i / 8);
+}
+
+__attribute__((target("sse4.2")))
+static
+void Fabric_Predicate__real_sse4(const float64_t *keys, uint32_t count, float64_t low, float64_t high, uint8_t *bits) {
+    __m128d lows = _mm_set1_pd(low), highs = _mm_set1_pd(high);
+    __m128d x;
+    uint32_t i, j, byte;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        byte = 0;
+        for (j = 0; j < 8; j += 2) {
+            x = _mm_loadu_pd(keys + i + j);
+            byte |= _mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(x, lows), _mm_cmple_pd(x, highs))) << j;
+        }
+        bits[i / 8] |= byte;
+    }
+    Fabric_Predicate__real_scalar(keys + i, count - i, low, high, bits + i / 8);
+}
+
+/**
+ * Private AVX2 kernels, testing four keys at a time
+ */
+__attribute__((target("avx2")))
+static
+void Fabric_Predicate__integer_avx2(const int64_t *keys, uint32_t count, int64_t low, int64_t high, uint8_t *bits) {
+    __m256i lows = _mm256_set1_epi64x(low), highs = _mm256_set1_epi64x(high);
+    __m256i a, b;
+    uint32_t i, outside;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        a = _mm256_loadu_si256((const __m256i*)(keys + i));
+        b = _mm256_loadu_si256((const __m256i*)(keys + i + 4));
+        a = _mm256_or_si256(_mm256_cmpgt_epi64(lows, a), _mm256_cmpgt_epi64(a, highs));
+        b = _mm256_or_si256(_mm256_cmpgt_epi64(lows, b), _mm256_cmpgt_epi64(b, highs));
+        outside = _mm256_movemask_pd(_mm256_castsi256_pd(a)) | (_mm256_movemask_pd(_mm256_castsi256_pd(b)) << 4);
+        bits[i / 8] |= ~outside & 0xff;
+    }
+    Fabric_Predicate__integer_scalar(keys + i, count - i, low, high, bits + i / 8);
+}
+
+__attribute__((target("avx2")))
+static
+void Fabric_Predicate__real_avx2(const float64_t *keys, uint32_t count, float64_t low, float64_t high, uint8_t *bits) {
+    __m256d lows = _mm256_set1_pd(low), highs = _mm256_set1_pd(high);
+    __m256d a, b;
+    uint32_t i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        a = _mm256_loadu_pd(keys + i);
+        b = _mm256_loadu_pd(keys + i + 4);
+        a = _mm256_and_pd(_mm256_cmp_pd(a, lows, _CMP_GE_OQ), _mm256_cmp_pd(a, highs, _CMP_LE_OQ));
+        b = _mm256_and_pd(_mm256_cmp_pd(b, lows, _CMP_GE_OQ), _mm256_cmp_pd(b, highs, _CMP_LE_OQ));
+        bits[i / 8] |= _mm256_movemask_pd(a) | (_mm256_movemask_pd(b) << 4);
+    }
+    Fabric_Predicate__real_scalar(keys + i, count - i, low, high, bits + i / 8);
+}
+#endif
+
+static int Fabric_Predicate__kernel = -1;
+static Fabric_Predicate__integer_kernel Fabric_Predicate__integers = Fabric_Predicate__integer_scalar;
+static Fabric_Predicate__real_kernel Fabric_Predicate__reals = Fabric_Predicate__real_scalar;
+
+/**
+ * Private function that switches the kernels used to evaluate predicates
+ *
+ * Returns: TRUE if the processor supports the kernels
+ */
+static
+bool_t Fabric_Predicate__use_kernel(int kernel) {
+    if (FABRIC_PREDICATE_KERNEL_SCALAR == kernel) {
+        Fabric_Predicate__integers = Fabric_Predicate__integer_scalar;
+        Fabric_Predicate__reals = Fabric_Predicate__real_scalar;
+#ifdef FABRIC_PREDICATE__X86
+    } else if (FABRIC_PREDICATE_KERNEL_SSE4 == kernel && __builtin_cpu_supports("sse4.2")) {
+        Fabric_Predicate__integers = Fabric_Predicate__integer_sse4;
+        Fabric_Predicate__reals = Fabric_Predicate__real_sse4;
+    } else if (FABRIC_PREDICATE_KERNEL_AVX2 == kernel && __builtin_cpu_supports("avx2")) {
+        Fabric_Predicate__integers = Fabric_Predicate__integer_avx2;
+        Fabric_Predicate__reals = Fabric_Predicate__real_avx2;
+#endif
+    } else {
+        return FALSE;
+    }
+    Fabric_Predicate__kernel = kernel;
+    return TRUE;
+}
+
+/**
+ * Gets the kernels used to evaluate predicates, choosing the best ones
+ * the processor supports the first time
+ *
+ * Returns: FABRIC_PREDICATE_KERNEL_AVX2, FABRIC_PREDICATE_KERNEL_SSE4 or
+ *          FABRIC_PREDICATE_KERNEL_SCALAR
+ */
+int Fabric_Predicate_get_kernel() {
+    if (Fabric_Predicate__kernel < 0 &&
+        !Fabric_Predicate__use_kernel(FABRIC_PREDICATE_KERNEL_AVX2) &&
+        !Fabric_Predicate__use_kernel(FABRIC_PREDICATE_KERNEL_SSE4)) {
+        Fabric_Predicate__use_kernel(FABRIC_PREDICATE_KERNEL_SCALAR);
+    }
+    return Fabric_Predicate__kernel;
+}
+
+/**
+ * Private function that gets the kind of a property type
+ *
+ * Returns: The kind or 0 if the type can't be compared
+ */
+static inline
+uint8_t Fabric_Predicate__kind(uint8_t type) {
+    switch (type) {
+    case FABRIC_PROPTYPE_INTEGER:
+        return FABRIC_PREDICATE__INTEGER;
+    case FABRIC_PROPTYPE_DATETIME:
+        return FABRIC_PREDICATE__DATETIME;
+    case FABRIC_PROPTYPE_REAL:
+        return FABRIC_PREDICATE__REAL;
+    default:
+        return type >= FABRIC_PROPTYPE_EMPTYTEXT && type <= FABRIC_PROPTYPE_TEXT8 ? FABRIC_PREDICATE__TEXT : 0;
+    }
+}
+
+/**
+ * Private function that gets the key of a property's data
+ */
+static inline
+int64_t Fabric_Predicate__key(uint8_t kind, const uint8_t *data) {
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+    value = betoh64(value);
+    if (FABRIC_PREDICATE__TEXT == kind) {
+        value ^= (uint64_t)1 << 63;
+    }
+    return (int64_t)value;
+}
+
+/**
+ * Private function that gets the value of a real property's data
+ */
+static inline
+float64_t Fabric_Predicate__real(const uint8_t *data) {
+    uint64_t value;
+    float64_t real;
+    memcpy(&value, data, sizeof(value));
+    value = betoh64(value);
+    memcpy(&real, &value, sizeof(real));
+    return real;
+}
+
+/**
+ * Private function that adds a range to a predicate
+ *
+ * A strict bound is given by passing FALSE for its inclusive flag.
+ */
+static
+void Fabric_Predicate__add_range(Predicate *self, Property *low, bool_t low_inclusive, Property *high, bool_t high_inclusive) {
+    uint32_t n = self->num_ranges;
+    int64_t low_key = INT64_MIN, high_key = INT64_MAX;
+
+    if (FABRIC_PREDICATE__REAL == self->kind) {
+        self->real_low[n] = NULL == low ? -INFINITY : Fabric_Predicate__real(Fabric_Property_get_data(low));
+        self->real_high[n] = NULL == high ? INFINITY : Fabric_Predicate__real(Fabric_Property_get_data(high));
+        if (!low_inclusive) {
+            self->real_low[n] = nextafter(self->real_low[n], INFINITY);
+        }
+        if (!high_inclusive) {
+            self->real_high[n] = nextafter(self->real_high[n], -INFINITY);
+        }
+        self->num_ranges++;
+        return;
+    }
+    if (NULL != low) {
+        low_key = Fabric_Predicate__key(self->kind, Fabric_Property_get_data(low));
+        if (!low_inclusive) {
+            if (INT64_MAX == low_key) {
+                return;
+            }
+            low_key++;
+        }
+    }
+    if (NULL != high) {
+        high_key = Fabric_Predicate__key(self->kind, Fabric_Property_get_data(high));
+        if (!high_inclusive) {
+            if (INT64_MIN == high_key) {
+                return;
+            }
+            high_key--;
+        }
+    }
+    self->low[n] = low_key;
+    self->high[n] = high_key;
+    self->num_ranges++;
+}
+
+/**
+ * Initializes a predicate that compares values with one value
+ *
+ * Args:
+ *      self: The predicate being initialized
+ *      op: FABRIC_PREDICATE_EQUAL, FABRIC_PREDICATE_LESS,
+ *          FABRIC_PREDICATE_LESS_EQUAL, FABRIC_PREDICATE_GREATER or
+ *          FABRIC_PREDICATE_GREATER_EQUAL.  The value is on the right, so
+ *          FABRIC_PREDICATE_LESS matches values less than it.
+ *      value: The value being compared with
+ *
+ * Returns: FABRIC_OK on success, FABRIC_PROPERTY_ERROR if the operator is
+ *          unknown or the value can't be compared
+ */
+error_t Fabric_Predicate_init(Predicate *self, int op, Property *value) {
+    self->kind = Fabric_Predicate__kind(Fabric_Property_get_type(value));
+    self->num_ranges = 0;
+    if (0 == self->kind) {
+        return FABRIC_PROPERTY_ERROR;
+    }
+    switch (op) {
+    case FABRIC_PREDICATE_EQUAL:
+        Fabric_Predicate__add_range(self, value, TRUE, value, TRUE);
+        break;
+    case FABRIC_PREDICATE_LESS:
+    case FABRIC_PREDICATE_LESS_EQUAL:
+        Fabric_Predicate__add_range(self, NULL, TRUE, value, FABRIC_PREDICATE_LESS_EQUAL == op);
+        break;
+    case FABRIC_PREDICATE_GREATER:
+    case FABRIC_PREDICATE_GREATER_EQUAL:
+        Fabric_Predicate__add_range(self, value, FABRIC_PREDICATE_GREATER_EQUAL == op, NULL, TRUE);
+        break;
+    default:
+        return FABRIC_PROPERTY_ERROR;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Initializes a predicate that matches the values from low to high,
+ * including both
+ *
+ * Returns: FABRIC_OK on success, FABRIC_PROPERTY_ERROR if the ends aren't
+ *          comparable values of the same kind
+ */
+error_t Fabric_Predicate_init_range(Predicate *self, Property *low, Property *high) {
+    self->kind = Fabric_Predicate__kind(Fabric_Property_get_type(low));
+    self->num_ranges = 0;
+    if (0 == self->kind || self->kind != Fabric_Predicate__kind(Fabric_Property_get_type(high))) {
+        return FABRIC_PROPERTY_ERROR;
+    }
+    Fabric_Predicate__add_range(self, low, TRUE, high, TRUE);
+    return FABRIC_OK;
+}
+
+/**
+ * Initializes a predicate that matches values equal to any of a list
+ *
+ * Args:
+ *      self: The predicate being initialized
+ *      values: The values being matched
+ *      count: The number of values, at most FABRIC_PREDICATE_MAX_VALUES
+ *
+ * Returns: FABRIC_OK on success, FABRIC_PROPERTY_ERROR if the list is
+ *          empty or too long or the values aren't comparable values of
+ *          the same kind
+ */
+error_t Fabric_Predicate_init_in(Predicate *self, Property **values, uint32_t count) {
+    uint32_t i;
+    self->num_ranges = 0;
+    if (0 == count || count > FABRIC_PREDICATE_MAX_VALUES) {
+        return FABRIC_PROPERTY_ERROR;
+    }
+    self->kind = Fabric_Predicate__kind(Fabric_Property_get_type(values[0]));
+    for (i = 0; i < count; i++) {
+        if (0 == self->kind || self->kind != Fabric_Predicate__kind(Fabric_Property_get_type(values[i]))) {
+            self->num_ranges = 0;
+            return FABRIC_PROPERTY_ERROR;
+        }
+        Fabric_Predicate__add_range(self, values[i], TRUE, values[i], TRUE);
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Checks whether a single value matches a predicate
+ *
+ * Args:
+ *      self: A predicate
+ *      type: The property type of the value
+ *      data: The value's property data
+ */
+bool_t Fabric_Predicate_matches(Predicate *self, uint8_t type, const uint8_t *data) {
+    uint32_t i;
+    int64_t key;
+    float64_t real;
+
+    if (Fabric_Predicate__kind(type) != self->kind) {
+        return FALSE;
+    }
+    if (FABRIC_PREDICATE__REAL == self->kind) {
+        real = Fabric_Predicate__real(data);
+        for (i = 0; i < self->num_ranges; i++) {
+            if (real >= self->real_low[i] && real <= self->real_high[i]) {
+                return TRUE;
+            }
+        }
+        return FALSE;
+    }
+    key = Fabric_Predicate__key(self->kind, data);
+    for (i = 0; i < self->num_ranges; i++) {
+        if (key >= self->low[i] && key <= self->high[i]) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * Private function that counts the set bits of a selection
+ */
+static
+uint32_t Fabric_Predicate__count(const uint8_t *selection, uint32_t count) {
+    uint32_t i, total = 0;
+    uint8_t byte;
+    for (i = 0; i < (count + 7) / 8; i++) {
+        for (byte = selection[i]; byte != 0; byte &= byte - 1) {
+            total++;
+        }
+    }
+    return total;
+}
+
+/**
+ * Private function that ORs in the bits of the keys in any of the
+ * predicate's ranges
+ */
+static
+void Fabric_Predicate__select_keys(Predicate *self, const void *keys, uint32_t count, uint8_t *bits) {
+    uint32_t i;
+    Fabric_Predicate_get_kernel();
+    for (i = 0; i < self->num_ranges; i++) {
+        if (FABRIC_PREDICATE__REAL == self->kind) {
+            Fabric_Predicate__reals(keys, count, self->real_low[i], self->real_high[i], bits);
+        } else {
+            Fabric_Predicate__integers(keys, count, self->low[i], self->high[i], bits);
+        }
+    }
+}
+
+/**
+ * Evaluates a predicate over an array of property records as they are
+ * stored
+ *
+ * Args:
+ *      self: A predicate
+ *      records: The records, FABRIC_PROPERTY_STORAGE_SIZE bytes each
+ *      count: The number of records
+ *      label_id: The label a record must have to match, or 0 for any
+ *      selection: Where a bit is set for each matching record and cleared
+ *                 for the others; (count + 7) / 8 bytes
+ *
+ * Returns: The number of matching records
+ */
+uint32_t Fabric_Predicate_select_records(Predicate *self, const uint8_t *records, uint32_t count, labelid_t label_id, uint8_t *selection) {
+    union {
+        int64_t integers[FABRIC_PREDICATE__BLOCK];
+        float64_t reals[FABRIC_PREDICATE__BLOCK];
+    } keys;
+    uint8_t valid[FABRIC_PREDICATE__BLOCK / 8];
+    uint32_t start, n, i;
+    const uint8_t *record;
+    uint64_t bits;
+
+    memset(selection, 0, (count + 7) / 8);
+    for (start = 0; start < count; start += FABRIC_PREDICATE__BLOCK) {
+        n = count - start < FABRIC_PREDICATE__BLOCK ? count - start : FABRIC_PREDICATE__BLOCK;
+
+        // Decode the block's keys, noting the records that can match
+        memset(valid, 0, sizeof(valid));
+        for (i = 0; i < n; i++) {
+            record = records + (start + i) * FABRIC_PROPERTY_STORAGE_SIZE;
+            memcpy(&bits, record + 9, sizeof(bits));
+            bits = betoh64(bits);
+            if (FABRIC_PREDICATE__TEXT == self->kind) {
+                bits ^= (uint64_t)1 << 63;
+            }
+            memcpy(&keys.integers[i], &bits, sizeof(bits));
+            if (Fabric_Predicate__kind(record[8]) == self->kind &&
+                (0 == label_id || betoh32(*(uint32_t*)record) == label_id)) {
+                valid[i / 8] |= 1 << (i % 8);
+            }
+        }
+
+        Fabric_Predicate__select_keys(self, &keys, n, selection + start / 8);
+        for (i = 0; i < (n + 7) / 8; i++) {
+            selection[start / 8 + i] &= valid[i];
+        }
+    }
+    return Fabric_Predicate__count(selection, count);
+}
+
+/**
+ * Evaluates a predicate over a property column
+ *
+ * Integer predicates can be evaluated over integer columns and real
+ * predicates over real columns.  Null rows never match.
+ *
+ * Args:
+ *      self: A predicate
+ *      column: The column being scanned
+ *      selection: Where a bit is set for each matching row and cleared for
+ *                 the others; (rows + 7) / 8 bytes
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The number of matching rows.  status is set to
+ *          FABRIC_PROPERTY_ERROR if the predicate can't be evaluated over
+ *          the column
+ */
+uint32_t Fabric_Predicate_select_column(Predicate *self, PropertyColumn *column, uint8_t *selection, error_t *status) {
+    uint32_t count = Fabric_PropertyColumn_get_row_count(column);
+    const uint8_t *nulls = Fabric_PropertyColumn_get_nulls(column);
+    const void *keys;
+    uint32_t i;
+
+    uint8_t type = Fabric_PropertyColumn_get_type(column);
+
+    if (FABRIC_PREDICATE__INTEGER == self->kind && FABRIC_COLUMN_INTEGER == type) {
+        keys = Fabric_PropertyColumn_get_integers(column);
+    } else if (FABRIC_PREDICATE__REAL == self->kind && FABRIC_COLUMN_REAL == type) {
+        keys = Fabric_PropertyColumn_get_reals(column);
+    } else {
+        *status = FABRIC_PROPERTY_ERROR;
+        return 0;
+    }
+    *status = FABRIC_OK;
+
+    memset(selection, 0, (count + 7) / 8);
+    Fabric_Predicate__select_keys(self, keys, count, selection);
+    for (i = 0; i < (count + 7) / 8; i++) {
+        selection[i] &= ~nulls[i];
+    }
+    if (count % 8 != 0) {
+        selection[count / 8] &= (1 << (count % 8)) - 1;
+    }
+    return Fabric_Predicate__count(selection, count);
+}
+
+/**
+ * Lists the ids of the selected entries of a selection bitmap
+ *
+ * Args:
+ *      selection: A selection bitmap
+ *      count: The number of entries the selection covers
+ *      ids: The id of each entry, such as a column's vertex ids, or NULL
+ *           if the entries have consecutive ids
+ *      first_id: The id of the first entry when ids is NULL
+ *      out: Where the ids of the selected entries are written
+ *
+ * Returns: The number of ids written
+ */
+uint32_t Fabric_Predicate_get_selected_ids(const uint8_t *selection, uint32_t count, const uint32_t *ids, uint32_t first_id, uint32_t *out) {
+    uint32_t i, j, n = 0;
+    uint8_t byte;
+    for (i = 0; i < (count + 7) / 8; i++) {
+        for (byte = selection[i], j = 0; byte != 0; byte >>= 1, j++) {
+            if ((byte & 1) && i * 8 + j < count) {
+                out[n++] = NULL == ids ? first_id + i * 8 + j : ids[i * 8 + j];
+            }
+        }
+    }
+    return n;
+}
+
+#endif
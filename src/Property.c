@@ -3,7 +3,7 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 24, 2015
- * Updated: March 27, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_PROPERTY_C__
@@ -62,6 +62,38 @@ typedef struct Property {
     uint8_t data[8];               // 8 bytes worth of data for the property
 } Property;
 
+/* Property objects are allocated from their own slab */
+static MemSlab Fabric_Property__slab = FABRIC_MEMSLAB_INITIALIZER(Property);
+
+/**
+ * Creates a new property object
+ *
+ * Args:
+ *      id: The internal id of the property object being created
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: A heap allocated property object that is NOT initialized
+ *          or NULL if there is a memory error
+ */
+Property *Fabric_Property_new(propertyid_t id, error_t *status) {
+    Property *property = Fabric_memslab_alloc(&Fabric_Property__slab);
+    if (NULL == property) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+
+    property->id = id;
+    *status = FABRIC_OK;
+    return property;
+}
+
+/**
+ * Frees a property object
+ */
+void Fabric_Property_destroy(Property *self) {
+    Fabric_memslab_free(&Fabric_Property__slab, self);
+}
+
 /**
  * Gets a property's internal id
  */
@@ -100,6 +132,20 @@ error_t Fabric_Property_init(Property *self, uint8_t *data) {
     return FABRIC_OK;
 }
 
+/**
+ * Writes a property's data to a stream of bytes
+ *
+ * Args:
+ *      self: The property being written
+ *      dest: Where the property is written (17 bytes)
+ */
+void Fabric_Property_load_bytes(Property *self, uint8_t *dest) {
+    *((labelid_t*)dest) = htobe32(self->label_id);
+    *((propertyid_t*)(dest + 4)) = htobe32(self->next_property_id);
+    dest[8] = self->type;
+    memcpy(dest + 9, self->data, 8);
+}
+
 /**
  * Gets the id of a property's label
  */
@@ -107,6 +153,13 @@ labelid_t Fabric_Property_get_label_id(Property *self) {
     return self->label_id;
 }
 
+/**
+ * Sets the id of a property's label
+ */
+void Fabric_Property_set_label_id(Property *self, labelid_t label_id) {
+    self->label_id = label_id;
+}
+
 /**
  * Gets the label for a property
  *
@@ -131,6 +184,13 @@ propertyid_t Fabric_Property_get_next_property_id(Property *self) {
     return self->next_property_id;
 }
 
+/**
+ * Sets the id of the property's owner's next property
+ */
+void Fabric_Property_set_next_property_id(Property *self, propertyid_t property_id) {
+    self->next_property_id = property_id;
+}
+
 /**
  * Returns the property's owner's next property
  *
@@ -320,4 +380,38 @@ void Fabric_Property_set_text_value_id(Property *self, textid_t text_id) {
     *((uint64_t*)self->data) = htobe64((uint64_t)text_id);
 }
 
-#endif
\ No newline at end of file
+/**
+ * Property views
+ *
+ * These read the fields of a property record straight from an EntityView
+ * without initializing a property object.
+ */
+/**
+ * Gets the id of a viewed property's label
+ */
+labelid_t Fabric_PropertyView_get_label_id(EntityView *view) {
+    return betoh32(*(labelid_t*)Fabric_EntityView_get_data(view));
+}
+
+/**
+ * Gets the id of the next property for a viewed property's owner
+ */
+propertyid_t Fabric_PropertyView_get_next_property_id(EntityView *view) {
+    return betoh32(*(propertyid_t*)(Fabric_EntityView_get_data(view) + 4));
+}
+
+/**
+ * Gets the internal property type of a viewed property
+ */
+uint8_t Fabric_PropertyView_get_type(EntityView *view) {
+    return *(Fabric_EntityView_get_data(view) + 8);
+}
+
+/**
+ * Returns a viewed property's data as a 64 bit integer
+ */
+int64_t Fabric_PropertyView_get_integer_value(EntityView *view) {
+    return betoh64(*(int64_t*)(Fabric_EntityView_get_data(view) + 9));
+}
+
+#endif
@@ -0,0 +1,805 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_PROPERTYCOLUMN_C__
+#define _FABRIC_PROPERTYCOLUMN_C__
+
+#include <string.h>
+#include "Internal.h"
+
+/**
+ * A property column holds one property of a class's vertices as a dense
+ * array, so that filters and aggregations over the property are a
+ * sequential scan instead of a walk of every vertex's property list.
+ *
+ * A column has a type, FABRIC_COLUMN_INTEGER, FABRIC_COLUMN_REAL or
+ * FABRIC_COLUMN_BOOLEAN, and holds a 64 bit integer, a 64 bit real or a
+ * byte that is 0 or 1 for each row.  A row belongs to one vertex of the
+ * class.  Rows are given out in vertex id order when the column is
+ * created, and a vertex that gets the property later is given the next
+ * row.  A row whose vertex doesn't have the property, or has a value of
+ * another type, is marked in the null bitmap.  Rows are never removed.
+ *
+ * The column sits next to the property store and is kept in sync with it
+ * through the store's log of property changes, which is applied when the
+ * property store is flushed.
+ *
+ * The rows are written to a chain of index pages, each holding a block of
+ * rows after a 12 byte header:
+ *
+ * +----+----+----+----+----+----+----+----+----+----+----+----+
+ * |type|ctyp| unused  | next_page_id      | num_rows          |
+ * +----+----+----+----+----+----+----+----+----+----+----+----+
+ *
+ * The header is followed by the vertex ids of the page's rows (4 bytes
+ * each), then their values (8 bytes, or 1 byte for booleans), then their
+ * null bits.  The ids and values are in the byte order of the graph's
+ * file, unlike the header.  Every page but the last is full.  Only the pages whose
+ * rows changed are written when the column is flushed.
+ *
+ * The graph's columns are listed in the property column directory, which
+ * is the index page FABRIC_PROPERTY_COLUMN_DIRECTORY_PAGE_ID.  Its header
+ * matches a property index directory's and it has a 16 byte entry for
+ * each column.
+ *
+ * +----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+
+ * | first_page_id     | class_id|ctyp|XXXX| label_id          | num_rows          |
+ * +----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+----+
+ *
+ * The directory and the rows of its columns are read the first time the
+ * directory is needed and kept in memory.
+ */
+#define FABRIC_PROPERTY_COLUMN_DIRECTORY_PAGE_ID 5
+#define FABRIC_PROPERTY_COLUMN_TYPE 0x08
+#define FABRIC_PROPERTY_COLUMN_DIRECTORY_TYPE 0x09
+#define FABRIC_PROPERTY_COLUMN_HEADER_SIZE 12
+#define FABRIC_PROPERTY_COLUMN_DIRECTORY_ENTRY_SIZE 16
+
+struct PropertyColumn {
+    IndexStore *store;          // The index store holding the column's pages
+    classid_t class_id;         // The class whose vertices are held
+    labelid_t label_id;         // The label of the held property
+    uint8_t type;               // The type of the values
+    uint32_t width;             // The size of a value
+    uint32_t rows_per_page;     // The number of rows a page holds
+    uint32_t num_rows;          // The number of rows
+    uint32_t stored_rows;       // The number of rows in the column's directory entry
+    uint32_t cap;               // The capacity of the row arrays
+    vertexid_t *vertex_ids;     // The vertex of each row
+    uint8_t *values;            // The value of each row, width bytes each
+    uint8_t *nulls;             // A bit for each row, set when it is null
+    EntityMap *rows;            // The row plus one of each vertex
+    uint32_t *page_ids;         // The pages of the chain
+    uint8_t *dirty;             // Whether each page has changed since it was written
+    uint32_t num_pages;         // The number of pages in the chain
+};
+
+struct PropertyColumnDirectory {
+    IndexStore *store;          // The index store holding the directory
+    PropertyColumn **columns;   // The graph's property columns
+    uint32_t count;             // The number of columns
+    uint32_t cap;               // The capacity of the columns array
+    bool_t changed;             // Whether an entry changed since the directory was written
+};
+
+/**
+ * Private function that sets up a column object
+ */
+static
+void Fabric_PropertyColumn__init(PropertyColumn *self, IndexStore *store, classid_t class_id, labelid_t label_id, uint8_t type) {
+    self->store = store;
+    self->class_id = class_id;
+    self->label_id = label_id;
+    self->type = type;
+    self->width = FABRIC_COLUMN_BOOLEAN == type ? 1 : 8;
+    self->rows_per_page = (store->page_size - FABRIC_PROPERTY_COLUMN_HEADER_SIZE) * 8 /
+        ((sizeof(vertexid_t) + self->width) * 8 + 1);
+    self->num_rows = 0;
+    self->stored_rows = 0;
+    self->cap = 0;
+    self->vertex_ids = NULL;
+    self->values = NULL;
+    self->nulls = NULL;
+    self->rows = NULL;
+    self->page_ids = NULL;
+    self->dirty = NULL;
+    self->num_pages = 0;
+}
+
+/**
+ * Private function that frees a column's rows
+ */
+static
+void Fabric_PropertyColumn__free_rows(PropertyColumn *self) {
+    if (NULL != self->vertex_ids) {
+        Fabric_memfree_tagged(self->vertex_ids, self->cap * sizeof(vertexid_t), FABRIC_MEM_INDEX);
+        Fabric_memfree_tagged(self->values, self->cap * self->width, FABRIC_MEM_INDEX);
+        Fabric_memfree_tagged(self->nulls, self->cap / 8, FABRIC_MEM_INDEX);
+    }
+    if (NULL != self->rows) {
+        Fabric_EntityMap_destroy(self->rows);
+    }
+    self->vertex_ids = NULL;
+    self->values = NULL;
+    self->nulls = NULL;
+    self->rows = NULL;
+    self->cap = 0;
+}
+
+/**
+ * Private function that frees a column
+ */
+static
+void Fabric_PropertyColumn__destroy(PropertyColumn *self) {
+    Fabric_PropertyColumn__free_rows(self);
+    if (NULL != self->page_ids) {
+        Fabric_memfree_tagged(self->page_ids, self->num_pages * sizeof(uint32_t), FABRIC_MEM_INDEX);
+        Fabric_memfree_tagged(self->dirty, self->num_pages, FABRIC_MEM_INDEX);
+    }
+    Fabric_memfree_tagged(self, sizeof(PropertyColumn), FABRIC_MEM_INDEX);
+}
+
+/**
+ * Private function that makes room for a number of rows
+ *
+ * The capacity is kept a multiple of 8 so the null bitmap is whole bytes.
+ */
+static
+error_t Fabric_PropertyColumn__reserve(PropertyColumn *self, uint32_t num_rows) {
+    uint32_t new_cap = self->cap < 64 ? 64 : self->cap;
+    vertexid_t *vertex_ids;
+    uint8_t *values, *nulls;
+
+    if (num_rows <= self->cap) {
+        return FABRIC_OK;
+    }
+    while (new_cap < num_rows) {
+        new_cap *= 2;
+    }
+    vertex_ids = Fabric_memrealloc_tagged(self->vertex_ids, new_cap * sizeof(vertexid_t),
+        self->cap * sizeof(vertexid_t), FABRIC_MEM_INDEX);
+    if (NULL == vertex_ids) {
+        return Fabric_memerrno();
+    }
+    self->vertex_ids = vertex_ids;
+    values = Fabric_memrealloc_tagged(self->values, new_cap * self->width, self->cap * self->width, FABRIC_MEM_INDEX);
+    if (NULL == values) {
+        return Fabric_memerrno();
+    }
+    self->values = values;
+    nulls = Fabric_memrealloc_tagged(self->nulls, new_cap / 8, self->cap / 8, FABRIC_MEM_INDEX);
+    if (NULL == nulls) {
+        return Fabric_memerrno();
+    }
+    self->nulls = nulls;
+    self->cap = new_cap;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that adds a page to the end of a column's chain
+ */
+static
+error_t Fabric_PropertyColumn__add_page(PropertyColumn *self, uint32_t page_id) {
+    uint32_t *page_ids;
+    uint8_t *dirty;
+
+    page_ids = Fabric_memrealloc_tagged(self->page_ids, (self->num_pages + 1) * sizeof(uint32_t),
+        self->num_pages * sizeof(uint32_t), FABRIC_MEM_INDEX);
+    if (NULL == page_ids) {
+        return Fabric_memerrno();
+    }
+    self->page_ids = page_ids;
+    dirty = Fabric_memrealloc_tagged(self->dirty, self->num_pages + 1, self->num_pages, FABRIC_MEM_INDEX);
+    if (NULL == dirty) {
+        return Fabric_memerrno();
+    }
+    self->dirty = dirty;
+    self->page_ids[self->num_pages] = page_id;
+    self->dirty[self->num_pages] = FALSE;
+    self->num_pages++;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that marks the page holding a row as changed
+ */
+static inline
+void Fabric_PropertyColumn__touch(PropertyColumn *self, uint32_t row) {
+    self->dirty[row / self->rows_per_page] = TRUE;
+}
+
+/**
+ * Private function that sets whether a row is null
+ */
+static inline
+void Fabric_PropertyColumn__set_null(PropertyColumn *self, uint32_t row, bool_t is_null) {
+    if (is_null) {
+        self->nulls[row / 8] |= 1 << (row % 8);
+    } else {
+        self->nulls[row / 8] &= ~(1 << (row % 8));
+    }
+}
+
+/**
+ * Private function that copies a page's rows into memory
+ *
+ * The page's vertex ids and values are converted from the graph's byte
+ * order a whole array at a time.
+ */
+static
+error_t Fabric_PropertyColumn__decode_page(PropertyColumn *self, uint8_t *page, uint32_t first_row, uint32_t num_rows) {
+    int byte_order = Fabric_Graph_get_byte_order(Fabric_IndexStore_get_graph(self->store));
+    uint8_t *ids = page + FABRIC_PROPERTY_COLUMN_HEADER_SIZE;
+    uint8_t *values = ids + self->rows_per_page * sizeof(vertexid_t);
+    uint8_t *nulls = values + self->rows_per_page * self->width;
+    uint32_t i, row;
+    error_t status;
+
+    Fabric_ByteSwap_copy32(self->vertex_ids + first_row, ids, num_rows, byte_order);
+    if (FABRIC_COLUMN_BOOLEAN == self->type) {
+        memcpy(self->values + first_row, values, num_rows);
+    } else {
+        Fabric_ByteSwap_copy64(self->values + first_row * 8, values, num_rows, byte_order);
+    }
+    for (i = 0; i < num_rows; i++) {
+        row = first_row + i;
+        Fabric_PropertyColumn__set_null(self, row, (nulls[i / 8] >> (i % 8)) & 1);
+        status = Fabric_EntityMap_set(self->rows, self->vertex_ids[row], (void*)(uintptr_t)(row + 1));
+        if (FABRIC_OK != status) {
+            return status;
+        }
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that copies one page's rows out of memory
+ *
+ * Returns: The number of bytes of the page that are used
+ */
+static
+uint32_t Fabric_PropertyColumn__encode_page(PropertyColumn *self, uint8_t *page, uint32_t page_number) {
+    int byte_order = Fabric_Graph_get_byte_order(Fabric_IndexStore_get_graph(self->store));
+    uint32_t first_row = page_number * self->rows_per_page;
+    uint32_t num_rows = self->num_rows - first_row;
+    uint8_t *ids = page + FABRIC_PROPERTY_COLUMN_HEADER_SIZE;
+    uint8_t *values = ids + self->rows_per_page * sizeof(vertexid_t);
+    uint8_t *nulls = values + self->rows_per_page * self->width;
+    uint32_t i;
+
+    if (num_rows > self->rows_per_page) {
+        num_rows = self->rows_per_page;
+    }
+    page[0] = FABRIC_PROPERTY_COLUMN_TYPE;
+    page[1] = self->type;
+    page[2] = page[3] = 0;
+    *(uint32_t*)(page + 4) = htobe32(page_number + 1 < self->num_pages ? self->page_ids[page_number + 1] : 0);
+    *(uint32_t*)(page + 8) = htobe32(num_rows);
+    Fabric_ByteSwap_copy32(ids, self->vertex_ids + first_row, num_rows, byte_order);
+    if (FABRIC_COLUMN_BOOLEAN == self->type) {
+        memcpy(values, self->values + first_row, num_rows);
+    } else {
+        Fabric_ByteSwap_copy64(values, self->values + first_row * 8, num_rows, byte_order);
+    }
+    memset(nulls, 0, (num_rows + 7) / 8);
+    for (i = 0; i < num_rows; i++) {
+        if (Fabric_PropertyColumn_is_null(self, first_row + i)) {
+            nulls[i / 8] |= 1 << (i % 8);
+        }
+    }
+    return (nulls - page) + (num_rows + 7) / 8;
+}
+
+/**
+ * Private function that reads a column's rows into memory
+ *
+ * Returns: FABRIC_OK on success, FABRIC_INDEX_ERROR if the chain doesn't
+ *          hold the rows the directory says it does or other error code
+ *          on failure
+ */
+static
+error_t Fabric_PropertyColumn__load(PropertyColumn *self, uint32_t first_page_id, uint32_t num_rows) {
+    Graph *graph = Fabric_IndexStore_get_graph(self->store);
+    uint32_t page_size = self->store->page_size;
+    uint32_t page_id = first_page_id, row = 0, page_rows;
+    uint8_t *page;
+    error_t status;
+
+    self->rows = Fabric_EntityMap_new(&status);
+    if (FABRIC_OK != status ||
+        FABRIC_OK != (status = Fabric_PropertyColumn__reserve(self, num_rows))) {
+        return status;
+    }
+    page = Fabric_memalloc_tagged(page_size, FABRIC_MEM_INDEX);
+    if (NULL == page) {
+        return Fabric_memerrno();
+    }
+    while (FABRIC_OK == status && row < num_rows) {
+        // A chain longer than the store can only be a loop
+        if (0 == page_id || page_id > Fabric_IndexStore_get_page_count(self->store) ||
+            self->num_pages >= Fabric_IndexStore_get_page_count(self->store)) {
+            status = FABRIC_INDEX_ERROR;
+            break;
+        }
+        status = Fabric_Graph_read_bytes(graph, page, page_size, Fabric_IndexStore_get_page_offset(self->store, page_id));
+        if (FABRIC_OK != status) {
+            break;
+        }
+        Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_INDEX_STORE, 1);
+        page_rows = betoh32(*(uint32_t*)(page + 8));
+        if (page[0] != FABRIC_PROPERTY_COLUMN_TYPE || page[1] != self->type ||
+            page_rows > self->rows_per_page || page_rows > num_rows - row) {
+            status = FABRIC_INDEX_ERROR;
+            break;
+        }
+        if (FABRIC_OK == (status = Fabric_PropertyColumn__add_page(self, page_id)) &&
+            FABRIC_OK == (status = Fabric_PropertyColumn__decode_page(self, page, row, page_rows))) {
+            row += page_rows;
+            page_id = betoh32(*(uint32_t*)(page + 4));
+        }
+    }
+    Fabric_memfree_tagged(page, page_size, FABRIC_MEM_INDEX);
+    self->num_rows = row;
+    self->stored_rows = row;
+    return status;
+}
+
+/**
+ * Gets the class whose vertices a column holds
+ */
+classid_t Fabric_PropertyColumn_get_class_id(PropertyColumn *self) {
+    return self->class_id;
+}
+
+/**
+ * Gets the label of the property a column holds
+ */
+labelid_t Fabric_PropertyColumn_get_label_id(PropertyColumn *self) {
+    return self->label_id;
+}
+
+/**
+ * Gets the type of a column's values
+ *
+ * Returns: FABRIC_COLUMN_INTEGER, FABRIC_COLUMN_REAL or FABRIC_COLUMN_BOOLEAN
+ */
+uint8_t Fabric_PropertyColumn_get_type(PropertyColumn *self) {
+    return self->type;
+}
+
+/**
+ * Gets the number of rows in a column
+ */
+uint32_t Fabric_PropertyColumn_get_row_count(PropertyColumn *self) {
+    return self->num_rows;
+}
+
+/**
+ * Gets the vertex of each of a column's rows
+ */
+const vertexid_t *Fabric_PropertyColumn_get_vertex_ids(PropertyColumn *self) {
+    return self->vertex_ids;
+}
+
+/**
+ * Gets the values of an integer column, one for each row
+ *
+ * Returns: The values or NULL if the column doesn't hold integers
+ */
+const int64_t *Fabric_PropertyColumn_get_integers(PropertyColumn *self) {
+    return FABRIC_COLUMN_INTEGER == self->type ? (int64_t*)self->values : NULL;
+}
+
+/**
+ * Gets the values of a real column, one for each row
+ *
+ * Returns: The values or NULL if the column doesn't hold reals
+ */
+const float64_t *Fabric_PropertyColumn_get_reals(PropertyColumn *self) {
+    return FABRIC_COLUMN_REAL == self->type ? (float64_t*)self->values : NULL;
+}
+
+/**
+ * Gets the values of a boolean column, a byte that is 0 or 1 for each row
+ *
+ * Returns: The values or NULL if the column doesn't hold booleans
+ */
+const uint8_t *Fabric_PropertyColumn_get_booleans(PropertyColumn *self) {
+    return FABRIC_COLUMN_BOOLEAN == self->type ? self->values : NULL;
+}
+
+/**
+ * Gets a column's null bitmap
+ *
+ * Row n is null when bit n % 8 of byte n / 8 is set.  The values of null
+ * rows are 0.
+ */
+const uint8_t *Fabric_PropertyColumn_get_nulls(PropertyColumn *self) {
+    return self->nulls;
+}
+
+/**
+ * Checks whether a row of a column is null
+ */
+bool_t Fabric_PropertyColumn_is_null(PropertyColumn *self, uint32_t row) {
+    return (self->nulls[row / 8] >> (row % 8)) & 1;
+}
+
+/**
+ * Finds a vertex's row in a column
+ *
+ * Args:
+ *      self: A property column
+ *      vertex_id: The vertex being looked for
+ *      row: A pointer to where the row is stored
+ *
+ * Returns: TRUE if the vertex has a row
+ */
+bool_t Fabric_PropertyColumn_find_row(PropertyColumn *self, vertexid_t vertex_id, uint32_t *row) {
+    uintptr_t entry = (uintptr_t)Fabric_EntityMap_get(self->rows, vertex_id);
+    if (0 == entry) {
+        return FALSE;
+    }
+    *row = entry - 1;
+    return TRUE;
+}
+
+/**
+ * Sets the value of a vertex's row, giving the vertex a new row if it
+ * doesn't have one
+ *
+ * Args:
+ *      self: A property column
+ *      vertex_id: The owner of the value
+ *      type: The value's property type.  Values of FABRIC_PROPTYPE_NOTHING
+ *            or a type that doesn't match the column are stored as null.
+ *      data: The value's property data
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_PropertyColumn_set(PropertyColumn *self, vertexid_t vertex_id, uint8_t type, const uint8_t *data) {
+    bool_t is_null = FALSE;
+    uint32_t row;
+    uint64_t value = 0;
+    error_t status;
+
+    if (FABRIC_COLUMN_INTEGER == self->type && FABRIC_PROPTYPE_INTEGER == type) {
+        value = betoh64(*(uint64_t*)data);
+    } else if (FABRIC_COLUMN_REAL == self->type && FABRIC_PROPTYPE_REAL == type) {
+        value = betoh64(*(uint64_t*)data);
+    } else if (FABRIC_COLUMN_BOOLEAN == self->type && (FABRIC_PROPTYPE_TRUE == type || FABRIC_PROPTYPE_FALSE == type)) {
+        value = FABRIC_PROPTYPE_TRUE == type;
+    } else {
+        is_null = TRUE;
+    }
+
+    if (!Fabric_PropertyColumn_find_row(self, vertex_id, &row)) {
+        row = self->num_rows;
+        if (row % self->rows_per_page == 0 && row / self->rows_per_page == self->num_pages) {
+            uint32_t page_id = Fabric_IndexStore_allocate_page(self->store, &status);
+            if (FABRIC_OK != status ||
+                FABRIC_OK != (status = Fabric_PropertyColumn__add_page(self, page_id))) {
+                return status;
+            }
+            // The page before has to point at the new one
+            if (self->num_pages > 1) {
+                self->dirty[self->num_pages - 2] = TRUE;
+            }
+        }
+        if (FABRIC_OK != (status = Fabric_PropertyColumn__reserve(self, row + 1)) ||
+            FABRIC_OK != (status = Fabric_EntityMap_set(self->rows, vertex_id, (void*)(uintptr_t)(row + 1)))) {
+            return status;
+        }
+        self->vertex_ids[row] = vertex_id;
+        self->num_rows++;
+    }
+    if (FABRIC_COLUMN_BOOLEAN == self->type) {
+        self->values[row] = value;
+    } else {
+        memcpy(self->values + row * 8, &value, 8);
+    }
+    Fabric_PropertyColumn__set_null(self, row, is_null);
+    Fabric_PropertyColumn__touch(self, row);
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that writes the changed pages of a column
+ */
+static
+error_t Fabric_PropertyColumn__flush(PropertyColumn *self, uint8_t *page) {
+    Graph *graph = Fabric_IndexStore_get_graph(self->store);
+    error_t status = FABRIC_OK;
+    uint32_t i, used;
+
+    for (i = 0; i < self->num_pages && FABRIC_OK == status; i++) {
+        if (!self->dirty[i]) {
+            continue;
+        }
+        used = Fabric_PropertyColumn__encode_page(self, page, i);
+        status = Fabric_Graph_write_bytes(graph, page, used, Fabric_IndexStore_get_page_offset(self->store, self->page_ids[i]));
+        if (FABRIC_OK == status) {
+            Fabric_stats_add(FABRIC_STAT_RECORDS_WRITTEN + FABRIC_STATS_INDEX_STORE, 1);
+            self->dirty[i] = FALSE;
+        }
+    }
+    return status;
+}
+
+/**
+ * Private function that adds a column object to the end of the directory
+ */
+static
+PropertyColumn *Fabric_PropertyColumnDirectory__append(PropertyColumnDirectory *self, error_t *status) {
+    PropertyColumn **columns;
+    PropertyColumn *column;
+    uint32_t new_cap;
+
+    if (self->count == self->cap) {
+        new_cap = self->cap > 0 ? self->cap * 2 : 8;
+        columns = Fabric_memrealloc_tagged(self->columns,
+            new_cap * sizeof(PropertyColumn*), self->cap * sizeof(PropertyColumn*), FABRIC_MEM_INDEX);
+        if (NULL == columns) {
+            *status = Fabric_memerrno();
+            return NULL;
+        }
+        self->columns = columns;
+        self->cap = new_cap;
+    }
+    column = Fabric_memalloc_tagged(sizeof(PropertyColumn), FABRIC_MEM_INDEX);
+    if (NULL == column) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    self->columns[self->count++] = column;
+    *status = FABRIC_OK;
+    return column;
+}
+
+/**
+ * Private function that reads the property column directory into memory
+ *
+ * Each column's rows are read here too, since they are needed as soon as
+ * the column's property changes.
+ */
+static
+error_t Fabric_PropertyColumnDirectory__load(PropertyColumnDirectory *self) {
+    Graph *graph = Fabric_IndexStore_get_graph(self->store);
+    uint32_t page_size = self->store->page_size;
+    uint32_t offset, used, position;
+    uint8_t *page, *entry;
+    PropertyColumn *column;
+    error_t status;
+
+    if (Fabric_IndexStore_get_page_count(self->store) < FABRIC_PROPERTY_COLUMN_DIRECTORY_PAGE_ID) {
+        return FABRIC_OK;
+    }
+    page = Fabric_memalloc_tagged(page_size, FABRIC_MEM_INDEX);
+    if (NULL == page) {
+        return Fabric_memerrno();
+    }
+    offset = Fabric_IndexStore_get_page_offset(self->store, FABRIC_PROPERTY_COLUMN_DIRECTORY_PAGE_ID);
+    status = Fabric_Graph_read_bytes(graph, page, page_size, offset);
+    Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_INDEX_STORE, 1);
+    used = betoh32(*(uint32_t*)(page + 8));
+    if (FABRIC_OK == status && page[0] != 0 &&
+        (page[0] != FABRIC_PROPERTY_COLUMN_DIRECTORY_TYPE || used > page_size - FABRIC_PROPERTY_COLUMN_HEADER_SIZE)) {
+        status = FABRIC_INDEX_ERROR;
+    }
+    if (FABRIC_OK != status || page[0] == 0) {
+        Fabric_memfree_tagged(page, page_size, FABRIC_MEM_INDEX);
+        return status;
+    }
+
+    for (position = FABRIC_PROPERTY_COLUMN_HEADER_SIZE;
+         position + FABRIC_PROPERTY_COLUMN_DIRECTORY_ENTRY_SIZE <= used + FABRIC_PROPERTY_COLUMN_HEADER_SIZE;
+         position += FABRIC_PROPERTY_COLUMN_DIRECTORY_ENTRY_SIZE) {
+        entry = page + position;
+        if (entry[6] < FABRIC_COLUMN_INTEGER || entry[6] > FABRIC_COLUMN_BOOLEAN) {
+            status = FABRIC_INDEX_ERROR;
+            break;
+        }
+        column = Fabric_PropertyColumnDirectory__append(self, &status);
+        if (FABRIC_OK != status) {
+            break;
+        }
+        Fabric_PropertyColumn__init(column, self->store,
+            betoh16(*(uint16_t*)(entry + 4)), betoh32(*(uint32_t*)(entry + 8)), entry[6]);
+        status = Fabric_PropertyColumn__load(column,
+            betoh32(*(uint32_t*)entry), betoh32(*(uint32_t*)(entry + 12)));
+        if (FABRIC_OK != status) {
+            break;
+        }
+    }
+    Fabric_memfree_tagged(page, page_size, FABRIC_MEM_INDEX);
+    return status;
+}
+
+/**
+ * Reads a graph's property column directory into memory
+ *
+ * Args:
+ *      store: The graph's index store
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The directory or NULL on failure
+ */
+PropertyColumnDirectory *Fabric_PropertyColumnDirectory_load(IndexStore *store, error_t *status) {
+    PropertyColumnDirectory *self = Fabric_memalloc_tagged(sizeof(PropertyColumnDirectory), FABRIC_MEM_INDEX);
+    if (NULL == self) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    self->store = store;
+    self->columns = NULL;
+    self->count = 0;
+    self->cap = 0;
+    self->changed = FALSE;
+    *status = Fabric_PropertyColumnDirectory__load(self);
+    if (FABRIC_OK != *status) {
+        Fabric_PropertyColumnDirectory_destroy(self);
+        return NULL;
+    }
+    return self;
+}
+
+/**
+ * Frees the memory held by a property column directory and its columns
+ */
+void Fabric_PropertyColumnDirectory_destroy(PropertyColumnDirectory *self) {
+    uint32_t i;
+    for (i = 0; i < self->count; i++) {
+        Fabric_PropertyColumn__destroy(self->columns[i]);
+    }
+    if (NULL != self->columns) {
+        Fabric_memfree_tagged(self->columns, self->cap * sizeof(PropertyColumn*), FABRIC_MEM_INDEX);
+    }
+    Fabric_memfree_tagged(self, sizeof(PropertyColumnDirectory), FABRIC_MEM_INDEX);
+}
+
+/**
+ * Gets the number of property columns in a directory
+ */
+uint32_t Fabric_PropertyColumnDirectory_get_count(PropertyColumnDirectory *self) {
+    return self->count;
+}
+
+/**
+ * Finds the column of a class's property
+ *
+ * Args:
+ *      self: A property column directory
+ *      class_id: The class whose vertices are held
+ *      label_id: The label of the held property
+ *
+ * Returns: The column or NULL if there isn't one
+ */
+PropertyColumn *Fabric_PropertyColumnDirectory_find(PropertyColumnDirectory *self, classid_t class_id, labelid_t label_id) {
+    uint32_t i;
+    for (i = 0; i < self->count; i++) {
+        if (self->columns[i]->class_id == class_id && self->columns[i]->label_id == label_id) {
+            return self->columns[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Creates an empty property column and adds it to the directory
+ *
+ * The directory is written when it is flushed.
+ *
+ * Args:
+ *      self: A property column directory
+ *      class_id: The class whose vertices are held
+ *      label_id: The label of the held property
+ *      type: FABRIC_COLUMN_INTEGER, FABRIC_COLUMN_REAL or FABRIC_COLUMN_BOOLEAN
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The new column or NULL on failure.  status is set to
+ *          FABRIC_INDEX_ERROR if the column exists, the type is unknown or
+ *          the directory is full
+ */
+PropertyColumn *Fabric_PropertyColumnDirectory_create(
+    PropertyColumnDirectory *self,
+    classid_t class_id,
+    labelid_t label_id,
+    uint8_t type,
+    error_t *status) {
+
+    PropertyColumn *column;
+    uint32_t used = self->count * FABRIC_PROPERTY_COLUMN_DIRECTORY_ENTRY_SIZE;
+
+    if (type < FABRIC_COLUMN_INTEGER || type > FABRIC_COLUMN_BOOLEAN ||
+        NULL != Fabric_PropertyColumnDirectory_find(self, class_id, label_id) ||
+        used + FABRIC_PROPERTY_COLUMN_DIRECTORY_ENTRY_SIZE > self->store->page_size - FABRIC_PROPERTY_COLUMN_HEADER_SIZE) {
+        *status = FABRIC_INDEX_ERROR;
+        return NULL;
+    }
+    *status = Fabric_IndexStore_reserve_root_pages(self->store);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    column = Fabric_PropertyColumnDirectory__append(self, status);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    Fabric_PropertyColumn__init(column, self->store, class_id, label_id, type);
+    column->rows = Fabric_EntityMap_new(status);
+    if (FABRIC_OK == *status) {
+        *status = Fabric_PropertyColumn__reserve(column, 1);
+    }
+    if (FABRIC_OK != *status) {
+        Fabric_PropertyColumn__destroy(column);
+        self->count--;
+        return NULL;
+    }
+    self->changed = TRUE;
+    return column;
+}
+
+/**
+ * Writes the changed pages of every column, then the directory if its
+ * entries changed
+ *
+ * Args:
+ *      self: A property column directory
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_PropertyColumnDirectory_flush(PropertyColumnDirectory *self) {
+    Graph *graph = Fabric_IndexStore_get_graph(self->store);
+    uint32_t page_size = self->store->page_size;
+    uint32_t i, used = 0;
+    PropertyColumn *column;
+    uint8_t *page, *entry;
+    error_t status = FABRIC_OK;
+
+    page = Fabric_memalloc_tagged(page_size, FABRIC_MEM_INDEX);
+    if (NULL == page) {
+        return Fabric_memerrno();
+    }
+    for (i = 0; i < self->count && FABRIC_OK == status; i++) {
+        column = self->columns[i];
+        status = Fabric_PropertyColumn__flush(column, page);
+        self->changed = self->changed || column->num_rows != column->stored_rows;
+    }
+    if (FABRIC_OK != status || !self->changed) {
+        Fabric_memfree_tagged(page, page_size, FABRIC_MEM_INDEX);
+        return status;
+    }
+
+    for (i = 0; i < self->count; i++) {
+        column = self->columns[i];
+        entry = page + FABRIC_PROPERTY_COLUMN_HEADER_SIZE + used;
+        *(uint32_t*)entry = htobe32(column->num_pages > 0 ? column->page_ids[0] : 0);
+        *(uint16_t*)(entry + 4) = htobe16(column->class_id);
+        entry[6] = column->type;
+        entry[7] = 0;
+        *(uint32_t*)(entry + 8) = htobe32(column->label_id);
+        *(uint32_t*)(entry + 12) = htobe32(column->num_rows);
+        used += FABRIC_PROPERTY_COLUMN_DIRECTORY_ENTRY_SIZE;
+    }
+    memset(page, 0, FABRIC_PROPERTY_COLUMN_HEADER_SIZE);
+    page[0] = FABRIC_PROPERTY_COLUMN_DIRECTORY_TYPE;
+    *(uint32_t*)(page + 8) = htobe32(used);
+    status = Fabric_Graph_write_bytes(graph, page, FABRIC_PROPERTY_COLUMN_HEADER_SIZE + used,
+        Fabric_IndexStore_get_page_offset(self->store, FABRIC_PROPERTY_COLUMN_DIRECTORY_PAGE_ID));
+    Fabric_memfree_tagged(page, page_size, FABRIC_MEM_INDEX);
+    if (FABRIC_OK == status) {
+        Fabric_stats_add(FABRIC_STAT_RECORDS_WRITTEN + FABRIC_STATS_INDEX_STORE, 1);
+        for (i = 0; i < self->count; i++) {
+            self->columns[i]->stored_rows = self->columns[i]->num_rows;
+        }
+        self->changed = FALSE;
+    }
+    return status;
+}
+
+#endif
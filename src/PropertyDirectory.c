@@ -0,0 +1,200 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_PROPERTYDIRECTORY_C__
+#define _FABRIC_PROPERTYDIRECTORY_C__
+
+#include <string.h>
+#include "Internal.h"
+
+/**
+ * A Property Directory maps the labels of one vertex's properties to
+ * the ids of the properties.
+ *
+ * Looking up a property by label otherwise follows the vertex's property
+ * list and reads every property before it.  A directory keeps the
+ * vertex's labels sorted, so a lookup is a binary search followed by a
+ * single read of the property, and a lookup of a label the vertex
+ * doesn't have reads nothing at all.
+ *
+ * Directories are only built for vertices with at least
+ * FABRIC_PROPERTY_DIRECTORY_MIN properties, the first time one of their
+ * properties is looked up.  They are held in memory by the property
+ * store in a cache of FABRIC_PROPERTY_DIRECTORY_CACHE_SIZE directories,
+ * kept up to date as properties are set and removed, and rebuilt when
+ * they are needed again after being evicted.
+ */
+typedef struct PropertyKey {
+    labelid_t label_id;         // The label of the property
+    propertyid_t property_id;   // The property
+} PropertyKey;
+
+struct PropertyDirectory {
+    uint32_t count;             // The number of keys
+    uint32_t cap;               // The capacity of keys
+    PropertyKey *keys;          // The keys in label order
+};
+
+/**
+ * Frees a directory
+ */
+void Fabric_PropertyDirectory_destroy(PropertyDirectory *self) {
+    if (NULL != self->keys) {
+        Fabric_memfree_tagged(self->keys, self->cap * sizeof(PropertyKey), FABRIC_MEM_INDEX);
+    }
+    Fabric_memfree_tagged(self, sizeof(PropertyDirectory), FABRIC_MEM_INDEX);
+}
+
+/**
+ * Private function that makes room for a number of keys in a directory
+ */
+static
+error_t Fabric_PropertyDirectory__reserve(PropertyDirectory *self, uint32_t count) {
+    uint32_t new_cap = self->cap < FABRIC_PROPERTY_DIRECTORY_MIN ? FABRIC_PROPERTY_DIRECTORY_MIN : self->cap;
+    PropertyKey *keys;
+
+    if (count <= self->cap) {
+        return FABRIC_OK;
+    }
+    while (new_cap < count) {
+        new_cap *= 2;
+    }
+    keys = Fabric_memrealloc_tagged(self->keys, new_cap * sizeof(PropertyKey),
+        self->cap * sizeof(PropertyKey), FABRIC_MEM_INDEX);
+    if (NULL == keys) {
+        return Fabric_memerrno();
+    }
+    self->keys = keys;
+    self->cap = new_cap;
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that finds the position of the first key whose label
+ * is not less than a label
+ */
+static
+uint32_t Fabric_PropertyDirectory__position(PropertyDirectory *self, labelid_t label_id) {
+    uint32_t low = 0, high = self->count, middle;
+    while (low < high) {
+        middle = low + (high - low) / 2;
+        if (self->keys[middle].label_id < label_id) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * Private comparison function for sorting keys by label
+ */
+static
+int Fabric_PropertyDirectory__compare_keys(const void *a, const void *b) {
+    labelid_t x = ((const PropertyKey*)a)->label_id;
+    labelid_t y = ((const PropertyKey*)b)->label_id;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * Builds the directory of a vertex's properties
+ *
+ * The properties are read without being added to the property cache.
+ *
+ * Args:
+ *      graph: The graph the vertex belongs to
+ *      vertex: The vertex whose properties are mapped
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The new directory or NULL on failure
+ */
+PropertyDirectory *Fabric_PropertyDirectory_build(Graph *graph, Vertex *vertex, error_t *status) {
+    PropertyDirectory *self = Fabric_memalloc_tagged(sizeof(PropertyDirectory), FABRIC_MEM_INDEX);
+    PropertyIterator iterator;
+    Property *property;
+
+    if (NULL == self) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    self->count = 0;
+    self->cap = 0;
+    self->keys = NULL;
+
+    Fabric_PropertyIterator_init_vertex(&iterator, graph, vertex);
+    while (NULL != (property = Fabric_PropertyIterator_next(&iterator, status))) {
+        *status = Fabric_PropertyDirectory__reserve(self, self->count + 1);
+        if (FABRIC_OK != *status) {
+            break;
+        }
+        self->keys[self->count].label_id = Fabric_Property_get_label_id(property);
+        self->keys[self->count].property_id = Fabric_Property_get_id(property);
+        self->count++;
+    }
+    if (FABRIC_OK != *status) {
+        Fabric_PropertyDirectory_destroy(self);
+        return NULL;
+    }
+    qsort(self->keys, self->count, sizeof(PropertyKey), Fabric_PropertyDirectory__compare_keys);
+    return self;
+}
+
+/**
+ * Finds the property with a label in a directory
+ *
+ * Returns: The id of the property or 0 if the vertex has no property
+ *          with the label
+ */
+propertyid_t Fabric_PropertyDirectory_find(PropertyDirectory *self, labelid_t label_id) {
+    uint32_t position = Fabric_PropertyDirectory__position(self, label_id);
+    if (position < self->count && self->keys[position].label_id == label_id) {
+        return self->keys[position].property_id;
+    }
+    return 0;
+}
+
+/**
+ * Adds a vertex's new property to its directory
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_PropertyDirectory_add(PropertyDirectory *self, labelid_t label_id, propertyid_t property_id) {
+    uint32_t position;
+    error_t status = Fabric_PropertyDirectory__reserve(self, self->count + 1);
+
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    position = Fabric_PropertyDirectory__position(self, label_id);
+    memmove(&self->keys[position + 1], &self->keys[position], (self->count - position) * sizeof(PropertyKey));
+    self->keys[position].label_id = label_id;
+    self->keys[position].property_id = property_id;
+    self->count++;
+    return FABRIC_OK;
+}
+
+/**
+ * Removes a vertex's property from its directory
+ */
+void Fabric_PropertyDirectory_remove(PropertyDirectory *self, labelid_t label_id) {
+    uint32_t position = Fabric_PropertyDirectory__position(self, label_id);
+    if (position < self->count && self->keys[position].label_id == label_id) {
+        self->count--;
+        memmove(&self->keys[position], &self->keys[position + 1], (self->count - position) * sizeof(PropertyKey));
+    }
+}
+
+/**
+ * Gets the number of properties in a directory
+ */
+uint32_t Fabric_PropertyDirectory_get_count(PropertyDirectory *self) {
+    return self->count;
+}
+
+#endif
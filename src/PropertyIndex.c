@@ -0,0 +1,967 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_PROPERTYINDEX_C__
+#define _FABRIC_PROPERTYINDEX_C__
+
+#include <string.h>
+#include "Internal.h"
+
+/**
+ * A property index is a B+tree that indexes the vertices of a class by
+ * the value of one of their properties.
+ *
+ * Each node of the tree is an index page.  The root page never moves, so
+ * its id is the index's id.  A node has a 12 byte header.
+ *
+ * +----+----+----+----+----+----+----+----+----+----+----+----+
+ * |type|leaf| num_keys| next_page_id      | first_child_id    |
+ * +----+----+----+----+----+----+----+----+----+----+----+----+
+ *
+ * The keys are 13 bytes and sort with memcmp(3).  A key is the value's
+ * type tag, then 8 bytes that sort in the value's order, then the id of
+ * the vertex, so every key is unique.
+ *
+ * +----+----+----+----+----+----+----+----+----+----+----+----+----+
+ * |tag | value                                 | vertex_id         |
+ * +----+----+----+----+----+----+----+----+----+----+----+----+----+
+ *
+ * A leaf holds sorted keys and the id of the next leaf.  A branch holds
+ * first_child_id followed by (key, child_id) pairs; the child after a key
+ * holds the keys greater than or equal to it.  Removed keys are taken out
+ * of their leaf but nodes are never merged.
+ *
+ * Integers, reals, datetimes and short text can be indexed.  Other values
+ * are left out of the index.
+ *
+ * The graph's property indices are listed in the property index
+ * directory, which is the index page FABRIC_PROPERTY_INDEX_DIRECTORY_PAGE_ID.
+ * Its header matches a name index page's and it has a 12 byte entry for
+ * each index.
+ *
+ * +----+----+----+----+----+----+----+----+----+----+----+----+
+ * | root_page_id      | class_id| unused  | label_id          |
+ * +----+----+----+----+----+----+----+----+----+----+----+----+
+ *
+ * The directory is read the first time it is needed and kept in memory.
+ */
+#define FABRIC_PROPERTY_INDEX_DIRECTORY_PAGE_ID 3
+#define FABRIC_PROPERTY_INDEX_TYPE 0x05
+#define FABRIC_PROPERTY_INDEX_DIRECTORY_TYPE 0x06
+#define FABRIC_PROPERTY_INDEX_HEADER_SIZE 12
+#define FABRIC_PROPERTY_INDEX_KEY_SIZE 13
+#define FABRIC_PROPERTY_INDEX_BRANCH_SIZE (FABRIC_PROPERTY_INDEX_KEY_SIZE + 4)
+#define FABRIC_PROPERTY_INDEX_DIRECTORY_ENTRY_SIZE 12
+
+struct PropertyIndex {
+    Index base;                 // The id is the root page
+    IndexStore *store;          // The index store holding the tree's pages
+    classid_t class_id;         // The class whose vertices are indexed
+    labelid_t label_id;         // The label of the indexed property
+    uint32_t max_leaf_keys;     // The most keys a leaf holds
+    uint32_t max_branch_keys;   // The most keys a branch holds
+};
+
+struct PropertyIndexDirectory {
+    IndexStore *store;          // The index store holding the directory
+    PropertyIndex **indexes;    // The graph's property indices
+    uint32_t count;             // The number of indices
+    uint32_t cap;               // The capacity of the indexes array
+};
+
+/**
+ * A property index cursor walks the leaves of a property index from the
+ * start of a range, reading FABRIC_PROPERTY_INDEX_CURSOR_BATCH keys at a
+ * time.
+ */
+struct PropertyIndexCursor {
+    PropertyIndex *index;       // The index being scanned
+    uint32_t page_id;           // The leaf being read or 0 at the end
+    uint32_t position;          // The next key of the leaf to read
+    uint32_t count;             // The number of keys in the batch
+    uint32_t at;                // The next key of the batch
+    uint8_t low[FABRIC_PROPERTY_INDEX_KEY_SIZE];    // Keys before this are skipped
+    uint8_t high[FABRIC_PROPERTY_INDEX_KEY_SIZE];   // Keys after this end the scan
+    uint8_t batch[FABRIC_PROPERTY_INDEX_CURSOR_BATCH * FABRIC_PROPERTY_INDEX_KEY_SIZE];
+};
+
+/**
+ * A node of a property index read into memory
+ */
+typedef struct PropertyIndexNode {
+    uint32_t page_id;           // The page holding the node
+    bool_t is_leaf;             // Whether the node is a leaf
+    uint16_t num_keys;          // The number of keys in the node
+    uint32_t next_page_id;      // The next leaf, for leaves
+    uint32_t first_child_id;    // The child before the first key, for branches
+    uint8_t *entries;           // The keys, or the key and child pairs
+} PropertyIndexNode;
+
+/**
+ * Private function that returns the tag that a value's key starts with
+ *
+ * Returns: The tag or FABRIC_PROPTYPE_NOTHING if the value can't be indexed
+ */
+static
+uint8_t Fabric_PropertyIndex__get_tag(uint8_t type) {
+    switch (type) {
+        case FABRIC_PROPTYPE_INTEGER:
+        case FABRIC_PROPTYPE_REAL:
+        case FABRIC_PROPTYPE_DATETIME:
+            return type;
+        default:
+            // Short texts of every length share a tag so they sort together
+            if (type >= FABRIC_PROPTYPE_EMPTYTEXT && type < FABRIC_PROPTYPE_LONGTEXT) {
+                return FABRIC_PROPTYPE_EMPTYTEXT;
+            }
+            return FABRIC_PROPTYPE_NOTHING;
+    }
+}
+
+/**
+ * Private function that encodes a value and a vertex id as a key
+ *
+ * The stored values are big endian, so integers only need their sign bit
+ * flipped.  Negative reals have all their bits flipped.  Short text is
+ * padded with zeros.
+ *
+ * Returns: TRUE on success, FALSE if the value can't be indexed
+ */
+static
+bool_t Fabric_PropertyIndex__encode_key(uint8_t *key, uint8_t type, const uint8_t *data, vertexid_t vertex_id) {
+    uint8_t tag = Fabric_PropertyIndex__get_tag(type);
+    int i, length;
+
+    if (FABRIC_PROPTYPE_NOTHING == tag) {
+        return FALSE;
+    }
+    key[0] = tag;
+    if (FABRIC_PROPTYPE_EMPTYTEXT == tag) {
+        length = type - FABRIC_PROPTYPE_EMPTYTEXT;
+        memcpy(key + 1, data, length);
+        memset(key + 1 + length, 0, 8 - length);
+    } else {
+        memcpy(key + 1, data, 8);
+        if (FABRIC_PROPTYPE_REAL == tag && (data[0] & 0x80)) {
+            for (i = 1; i <= 8; i++) {
+                key[i] = ~key[i];
+            }
+        } else {
+            key[1] ^= 0x80;
+        }
+    }
+    *(uint32_t*)(key + 9) = htobe32(vertex_id);
+    return TRUE;
+}
+
+/**
+ * Private function that returns the vertex id of a key
+ */
+static inline
+vertexid_t Fabric_PropertyIndex__key_vertex_id(const uint8_t *key) {
+    return betoh32(*(uint32_t*)(key + 9));
+}
+
+/**
+ * Private function that returns the size of a node's entries
+ */
+static inline
+uint32_t Fabric_PropertyIndex__entry_size(PropertyIndexNode *node) {
+    return node->is_leaf ? FABRIC_PROPERTY_INDEX_KEY_SIZE : FABRIC_PROPERTY_INDEX_BRANCH_SIZE;
+}
+
+/**
+ * Private function that returns a node's key at a position
+ */
+static inline
+uint8_t *Fabric_PropertyIndex__key(PropertyIndexNode *node, uint32_t position) {
+    return node->entries + position * Fabric_PropertyIndex__entry_size(node);
+}
+
+/**
+ * Private function that returns the child of a branch after the key at
+ * a position, or the first child for position -1
+ */
+static inline
+uint32_t Fabric_PropertyIndex__child(PropertyIndexNode *node, int position) {
+    if (position < 0) {
+        return node->first_child_id;
+    }
+    return betoh32(*(uint32_t*)(Fabric_PropertyIndex__key(node, position) + FABRIC_PROPERTY_INDEX_KEY_SIZE));
+}
+
+/**
+ * Private function that returns the number of keys in a node that are
+ * less than key, or less than or equal to it if or_equal is set
+ */
+static
+uint32_t Fabric_PropertyIndex__search(PropertyIndexNode *node, const uint8_t *key, bool_t or_equal) {
+    uint32_t low = 0, high = node->num_keys, middle;
+    int cmp;
+    while (low < high) {
+        middle = (low + high) / 2;
+        cmp = memcmp(Fabric_PropertyIndex__key(node, middle), key, FABRIC_PROPERTY_INDEX_KEY_SIZE);
+        if (cmp < 0 || (or_equal && cmp == 0)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * Private function that returns the size of a node's entries in memory
+ *
+ * It has room for one branch entry more than a page holds, so that a
+ * full branch can take its new entry before it is split.
+ */
+static
+uint32_t Fabric_PropertyIndex__node_size(PropertyIndex *self) {
+    return self->store->page_size + FABRIC_PROPERTY_INDEX_BRANCH_SIZE;
+}
+
+/**
+ * Private function that allocates the entries of a node
+ */
+static
+error_t Fabric_PropertyIndex__alloc_node(PropertyIndex *self, PropertyIndexNode *node) {
+    node->entries = Fabric_memalloc_tagged(Fabric_PropertyIndex__node_size(self), FABRIC_MEM_INDEX);
+    if (NULL == node->entries) {
+        return Fabric_memerrno();
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that frees the entries of a node
+ */
+static
+void Fabric_PropertyIndex__free_node(PropertyIndex *self, PropertyIndexNode *node) {
+    if (NULL != node->entries) {
+        Fabric_memfree_tagged(node->entries, Fabric_PropertyIndex__node_size(self), FABRIC_MEM_INDEX);
+        node->entries = NULL;
+    }
+}
+
+/**
+ * Private function that reads a node into memory
+ *
+ * Only the used part of the page is read.
+ */
+static
+error_t Fabric_PropertyIndex__read_node(PropertyIndex *self, uint32_t page_id, PropertyIndexNode *node) {
+    Graph *graph = Fabric_IndexStore_get_graph(self->store);
+    uint32_t offset = Fabric_IndexStore_get_page_offset(self->store, page_id);
+    uint8_t header[FABRIC_PROPERTY_INDEX_HEADER_SIZE];
+    uint32_t max_keys;
+    error_t status;
+
+    if (page_id < 1 || page_id > Fabric_IndexStore_get_page_count(self->store)) {
+        return FABRIC_INDEX_ERROR;
+    }
+    status = Fabric_Graph_read_bytes(graph, header, sizeof(header), offset);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_INDEX_STORE, 1);
+    node->page_id = page_id;
+    node->is_leaf = header[1];
+    node->num_keys = betoh16(*(uint16_t*)(header + 2));
+    node->next_page_id = betoh32(*(uint32_t*)(header + 4));
+    node->first_child_id = betoh32(*(uint32_t*)(header + 8));
+    max_keys = (self->store->page_size - FABRIC_PROPERTY_INDEX_HEADER_SIZE) / Fabric_PropertyIndex__entry_size(node);
+    if (header[0] != FABRIC_PROPERTY_INDEX_TYPE || node->num_keys > max_keys) {
+        return FABRIC_INDEX_ERROR;
+    }
+    return Fabric_Graph_read_bytes(graph, node->entries,
+        node->num_keys * Fabric_PropertyIndex__entry_size(node), offset + FABRIC_PROPERTY_INDEX_HEADER_SIZE);
+}
+
+/**
+ * Private function that writes a node's header and its entries from a
+ * position on
+ */
+static
+error_t Fabric_PropertyIndex__write_node(PropertyIndex *self, PropertyIndexNode *node, uint32_t from) {
+    Graph *graph = Fabric_IndexStore_get_graph(self->store);
+    uint32_t offset = Fabric_IndexStore_get_page_offset(self->store, node->page_id);
+    uint32_t entry_size = Fabric_PropertyIndex__entry_size(node);
+    uint8_t header[FABRIC_PROPERTY_INDEX_HEADER_SIZE];
+    error_t status;
+
+    header[0] = FABRIC_PROPERTY_INDEX_TYPE;
+    header[1] = node->is_leaf ? 1 : 0;
+    *(uint16_t*)(header + 2) = htobe16(node->num_keys);
+    *(uint32_t*)(header + 4) = htobe32(node->next_page_id);
+    *(uint32_t*)(header + 8) = htobe32(node->first_child_id);
+    status = Fabric_Graph_write_bytes(graph, header, sizeof(header), offset);
+    Fabric_stats_add(FABRIC_STAT_RECORDS_WRITTEN + FABRIC_STATS_INDEX_STORE, 1);
+    if (FABRIC_OK != status || from >= node->num_keys) {
+        return status;
+    }
+    return Fabric_Graph_write_bytes(graph, Fabric_PropertyIndex__key(node, from),
+        (node->num_keys - from) * entry_size, offset + FABRIC_PROPERTY_INDEX_HEADER_SIZE + from * entry_size);
+}
+
+/**
+ * Private function that puts an entry into a node at a position
+ *
+ * The node must have room for it in memory, which a full branch always
+ * has.
+ */
+static
+void Fabric_PropertyIndex__put(PropertyIndexNode *node, uint32_t position, const uint8_t *key, uint32_t child_id) {
+    uint32_t entry_size = Fabric_PropertyIndex__entry_size(node);
+    uint8_t *entry = Fabric_PropertyIndex__key(node, position);
+    memmove(entry + entry_size, entry, (node->num_keys - position) * entry_size);
+    memcpy(entry, key, FABRIC_PROPERTY_INDEX_KEY_SIZE);
+    if (!node->is_leaf) {
+        *(uint32_t*)(entry + FABRIC_PROPERTY_INDEX_KEY_SIZE) = htobe32(child_id);
+    }
+    node->num_keys++;
+}
+
+/**
+ * Private function that puts an entry into a full node by splitting it
+ *
+ * The upper half of the node is moved to a new page.  The key that
+ * separates the two halves is stored in split_key.  Leaves keep the
+ * separator as their first key while branches move it to their parent.
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+static
+error_t Fabric_PropertyIndex__split(PropertyIndex *self, PropertyIndexNode *node, uint32_t position,
+        const uint8_t *key, uint32_t child_id, uint8_t *split_key, uint32_t *split_page_id) {
+    uint32_t entry_size = Fabric_PropertyIndex__entry_size(node);
+    uint32_t middle = node->num_keys / 2;
+    PropertyIndexNode right;
+    error_t status;
+
+    right.page_id = Fabric_IndexStore_allocate_page(self->store, &status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    status = Fabric_PropertyIndex__alloc_node(self, &right);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    right.is_leaf = node->is_leaf;
+
+    // Move the upper half, then put the new entry in its half
+    if (node->is_leaf) {
+        right.num_keys = node->num_keys - middle;
+        memcpy(right.entries, Fabric_PropertyIndex__key(node, middle), right.num_keys * entry_size);
+        right.next_page_id = node->next_page_id;
+        right.first_child_id = 0;
+        node->next_page_id = right.page_id;
+        node->num_keys = middle;
+        if (position <= middle) {
+            Fabric_PropertyIndex__put(node, position, key, child_id);
+        } else {
+            Fabric_PropertyIndex__put(&right, position - middle, key, child_id);
+        }
+        memcpy(split_key, Fabric_PropertyIndex__key(&right, 0), FABRIC_PROPERTY_INDEX_KEY_SIZE);
+    } else {
+        Fabric_PropertyIndex__put(node, position, key, child_id);
+        middle = node->num_keys / 2;
+        memcpy(split_key, Fabric_PropertyIndex__key(node, middle), FABRIC_PROPERTY_INDEX_KEY_SIZE);
+        right.first_child_id = Fabric_PropertyIndex__child(node, middle);
+        right.next_page_id = 0;
+        right.num_keys = node->num_keys - middle - 1;
+        memcpy(right.entries, Fabric_PropertyIndex__key(node, middle + 1), right.num_keys * entry_size);
+        node->num_keys = middle;
+    }
+
+    status = Fabric_PropertyIndex__write_node(self, &right, 0);
+    if (FABRIC_OK == status) {
+        status = Fabric_PropertyIndex__write_node(self, node, 0);
+    }
+    Fabric_PropertyIndex__free_node(self, &right);
+    *split_page_id = right.page_id;
+    return status;
+}
+
+/**
+ * Private function that inserts a key into the subtree at a page
+ *
+ * split_page_id is set to the new page if the subtree's root was split,
+ * or 0 if not.
+ */
+static
+error_t Fabric_PropertyIndex__insert(PropertyIndex *self, uint32_t page_id, const uint8_t *key,
+        uint8_t *split_key, uint32_t *split_page_id) {
+    PropertyIndexNode node;
+    uint8_t child_split_key[FABRIC_PROPERTY_INDEX_KEY_SIZE];
+    uint32_t child_split_page_id = 0;
+    uint32_t position, max_keys;
+    error_t status;
+
+    *split_page_id = 0;
+    status = Fabric_PropertyIndex__alloc_node(self, &node);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    status = Fabric_PropertyIndex__read_node(self, page_id, &node);
+    if (FABRIC_OK != status) {
+        Fabric_PropertyIndex__free_node(self, &node);
+        return status;
+    }
+
+    if (node.is_leaf) {
+        position = Fabric_PropertyIndex__search(&node, key, FALSE);
+        // Keys are unique, so a key that is already there is done
+        if (position < node.num_keys &&
+            memcmp(Fabric_PropertyIndex__key(&node, position), key, FABRIC_PROPERTY_INDEX_KEY_SIZE) == 0) {
+            Fabric_PropertyIndex__free_node(self, &node);
+            return FABRIC_OK;
+        }
+        max_keys = self->max_leaf_keys;
+    } else {
+        position = Fabric_PropertyIndex__search(&node, key, TRUE);
+        status = Fabric_PropertyIndex__insert(self,
+            Fabric_PropertyIndex__child(&node, (int)position - 1), key, child_split_key, &child_split_page_id);
+        if (FABRIC_OK != status || 0 == child_split_page_id) {
+            Fabric_PropertyIndex__free_node(self, &node);
+            return status;
+        }
+        // The child's new page goes right after the child
+        key = child_split_key;
+        max_keys = self->max_branch_keys;
+    }
+
+    if (node.num_keys < max_keys) {
+        Fabric_PropertyIndex__put(&node, position, key, child_split_page_id);
+        status = Fabric_PropertyIndex__write_node(self, &node, position);
+    } else {
+        status = Fabric_PropertyIndex__split(self, &node, position, key, child_split_page_id, split_key, split_page_id);
+    }
+    Fabric_PropertyIndex__free_node(self, &node);
+    return status;
+}
+
+/**
+ * Private function that moves the contents of a split root to a new
+ * page and makes the root a branch over the two halves
+ *
+ * This keeps the root at the same page.
+ */
+static
+error_t Fabric_PropertyIndex__grow_root(PropertyIndex *self, const uint8_t *split_key, uint32_t split_page_id) {
+    PropertyIndexNode node;
+    uint32_t left_page_id;
+    error_t status;
+
+    left_page_id = Fabric_IndexStore_allocate_page(self->store, &status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    status = Fabric_PropertyIndex__alloc_node(self, &node);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    status = Fabric_PropertyIndex__read_node(self, self->base.id, &node);
+    if (FABRIC_OK == status) {
+        node.page_id = left_page_id;
+        status = Fabric_PropertyIndex__write_node(self, &node, 0);
+    }
+    if (FABRIC_OK == status) {
+        node.page_id = self->base.id;
+        node.is_leaf = FALSE;
+        node.num_keys = 0;
+        node.next_page_id = 0;
+        node.first_child_id = left_page_id;
+        Fabric_PropertyIndex__put(&node, 0, split_key, split_page_id);
+        status = Fabric_PropertyIndex__write_node(self, &node, 0);
+    }
+    Fabric_PropertyIndex__free_node(self, &node);
+    return status;
+}
+
+/**
+ * Private function that sets up a property index object
+ */
+static
+void Fabric_PropertyIndex__init(PropertyIndex *self, IndexStore *store, uint32_t root_page_id, classid_t class_id, labelid_t label_id) {
+    self->base.id = root_page_id;
+    self->base.type = FABRIC_PROPERTY_INDEX_TYPE;
+    self->store = store;
+    self->class_id = class_id;
+    self->label_id = label_id;
+    self->max_leaf_keys = (store->page_size - FABRIC_PROPERTY_INDEX_HEADER_SIZE) / FABRIC_PROPERTY_INDEX_KEY_SIZE;
+    self->max_branch_keys = (store->page_size - FABRIC_PROPERTY_INDEX_HEADER_SIZE) / FABRIC_PROPERTY_INDEX_BRANCH_SIZE;
+}
+
+/**
+ * Gets the class whose vertices a property index indexes
+ */
+classid_t Fabric_PropertyIndex_get_class_id(PropertyIndex *self) {
+    return self->class_id;
+}
+
+/**
+ * Gets the label of the property a property index indexes
+ */
+labelid_t Fabric_PropertyIndex_get_label_id(PropertyIndex *self) {
+    return self->label_id;
+}
+
+/**
+ * Adds a vertex's property value to a property index
+ *
+ * Args:
+ *      self: A property index
+ *      type: The type of the value
+ *      data: The value's 8 bytes of property data
+ *      vertex_id: The vertex with the value
+ *
+ * Returns: FABRIC_OK on success, other error code on failure.  Values
+ *          that can't be indexed are ignored.
+ */
+error_t Fabric_PropertyIndex_insert(PropertyIndex *self, uint8_t type, const uint8_t *data, vertexid_t vertex_id) {
+    uint8_t key[FABRIC_PROPERTY_INDEX_KEY_SIZE];
+    uint8_t split_key[FABRIC_PROPERTY_INDEX_KEY_SIZE];
+    uint32_t split_page_id;
+    error_t status;
+
+    if (!Fabric_PropertyIndex__encode_key(key, type, data, vertex_id)) {
+        return FABRIC_OK;
+    }
+    status = Fabric_PropertyIndex__insert(self, self->base.id, key, split_key, &split_page_id);
+    if (FABRIC_OK != status || 0 == split_page_id) {
+        return status;
+    }
+    return Fabric_PropertyIndex__grow_root(self, split_key, split_page_id);
+}
+
+/**
+ * Removes a vertex's property value from a property index
+ *
+ * Args:
+ *      self: A property index
+ *      type: The type of the value
+ *      data: The value's 8 bytes of property data
+ *      vertex_id: The vertex with the value
+ *
+ * Returns: FABRIC_OK on success, other error code on failure.  Values
+ *          that aren't in the index are ignored.
+ */
+error_t Fabric_PropertyIndex_remove(PropertyIndex *self, uint8_t type, const uint8_t *data, vertexid_t vertex_id) {
+    uint8_t key[FABRIC_PROPERTY_INDEX_KEY_SIZE];
+    PropertyIndexNode node;
+    uint32_t page_id = self->base.id;
+    uint32_t position;
+    error_t status;
+
+    if (!Fabric_PropertyIndex__encode_key(key, type, data, vertex_id)) {
+        return FABRIC_OK;
+    }
+    status = Fabric_PropertyIndex__alloc_node(self, &node);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    for (;;) {
+        status = Fabric_PropertyIndex__read_node(self, page_id, &node);
+        if (FABRIC_OK != status || node.is_leaf) {
+            break;
+        }
+        page_id = Fabric_PropertyIndex__child(&node, (int)Fabric_PropertyIndex__search(&node, key, TRUE) - 1);
+    }
+
+    if (FABRIC_OK == status) {
+        position = Fabric_PropertyIndex__search(&node, key, FALSE);
+        if (position < node.num_keys &&
+            memcmp(Fabric_PropertyIndex__key(&node, position), key, FABRIC_PROPERTY_INDEX_KEY_SIZE) == 0) {
+            memmove(Fabric_PropertyIndex__key(&node, position), Fabric_PropertyIndex__key(&node, position + 1),
+                (node.num_keys - position - 1) * FABRIC_PROPERTY_INDEX_KEY_SIZE);
+            node.num_keys--;
+            status = Fabric_PropertyIndex__write_node(self, &node, position);
+        }
+    }
+    Fabric_PropertyIndex__free_node(self, &node);
+    return status;
+}
+
+/**
+ * Private function that encodes one end of a range
+ *
+ * An open end is the lowest or highest key with the other end's tag.
+ */
+static
+bool_t Fabric_PropertyIndex__encode_bound(uint8_t *key, Property *value, Property *other, bool_t is_low, bool_t inclusive) {
+    // Inclusive ends take in every vertex with the value
+    vertexid_t vertex_id = (is_low == inclusive) ? 0 : UINT32_MAX;
+    if (NULL != value) {
+        return Fabric_PropertyIndex__encode_key(key,
+            Fabric_Property_get_type(value), Fabric_Property_get_data(value), vertex_id);
+    }
+    key[0] = Fabric_PropertyIndex__get_tag(Fabric_Property_get_type(other));
+    memset(key + 1, is_low ? 0x00 : 0xFF, FABRIC_PROPERTY_INDEX_KEY_SIZE - 1);
+    return key[0] != FABRIC_PROPTYPE_NOTHING;
+}
+
+/**
+ * Starts a scan of the vertices in a property index whose values are in
+ * a range
+ *
+ * Either end of the range may be NULL to leave it open, but not both.
+ * Both ends must be of the same kind of value; short texts of any length
+ * can be compared with each other.  Vertices are returned in the order of
+ * their values, and vertices with the same value in the order of their
+ * ids.  Changing the index during a scan may cause vertices to be skipped
+ * or returned twice.  A cursor holds no resources.
+ *
+ * Args:
+ *      self: The cursor being started
+ *      index: The property index being scanned
+ *      low: The lowest value or NULL
+ *      low_inclusive: Whether vertices with the lowest value are included
+ *      high: The highest value or NULL
+ *      high_inclusive: Whether vertices with the highest value are included
+ *
+ * Returns: FABRIC_OK on success, FABRIC_INDEX_ERROR if the range isn't
+ *          valid or other error code on failure
+ */
+error_t Fabric_PropertyIndexCursor_init(
+        PropertyIndexCursor *self,
+        PropertyIndex *index,
+        Property *low,
+        bool_t low_inclusive,
+        Property *high,
+        bool_t high_inclusive) {
+
+    PropertyIndexNode node;
+    uint32_t page_id = index->base.id;
+    error_t status;
+
+    self->index = index;
+    self->page_id = 0;
+    self->position = 0;
+    self->count = 0;
+    self->at = 0;
+    if ((NULL == low && NULL == high) ||
+        !Fabric_PropertyIndex__encode_bound(self->low, low, high, TRUE, low_inclusive) ||
+        !Fabric_PropertyIndex__encode_bound(self->high, high, low, FALSE, high_inclusive) ||
+        self->low[0] != self->high[0]) {
+        return FABRIC_INDEX_ERROR;
+    }
+
+    // Find the leaf that the range starts in
+    status = Fabric_PropertyIndex__alloc_node(index, &node);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    for (;;) {
+        status = Fabric_PropertyIndex__read_node(index, page_id, &node);
+        if (FABRIC_OK != status) {
+            break;
+        }
+        if (node.is_leaf) {
+            self->page_id = page_id;
+            self->position = Fabric_PropertyIndex__search(&node, self->low, FALSE);
+            break;
+        }
+        page_id = Fabric_PropertyIndex__child(&node, (int)Fabric_PropertyIndex__search(&node, self->low, TRUE) - 1);
+    }
+    Fabric_PropertyIndex__free_node(index, &node);
+    return status;
+}
+
+/**
+ * Private function that reads the cursor's next batch of keys
+ */
+static
+error_t Fabric_PropertyIndexCursor__fill(PropertyIndexCursor *self) {
+    PropertyIndex *index = self->index;
+    Graph *graph = Fabric_IndexStore_get_graph(index->store);
+    uint8_t header[FABRIC_PROPERTY_INDEX_HEADER_SIZE];
+    uint32_t offset, num_keys;
+    error_t status;
+
+    self->count = 0;
+    self->at = 0;
+    while (self->page_id != 0) {
+        if (self->page_id > Fabric_IndexStore_get_page_count(index->store)) {
+            return FABRIC_INDEX_ERROR;
+        }
+        offset = Fabric_IndexStore_get_page_offset(index->store, self->page_id);
+        status = Fabric_Graph_read_bytes(graph, header, sizeof(header), offset);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        if (header[0] != FABRIC_PROPERTY_INDEX_TYPE || !header[1]) {
+            return FABRIC_INDEX_ERROR;
+        }
+        num_keys = betoh16(*(uint16_t*)(header + 2));
+        if (self->position < num_keys) {
+            self->count = num_keys - self->position;
+            if (self->count > FABRIC_PROPERTY_INDEX_CURSOR_BATCH) {
+                self->count = FABRIC_PROPERTY_INDEX_CURSOR_BATCH;
+            }
+            status = Fabric_Graph_read_bytes(graph, self->batch, self->count * FABRIC_PROPERTY_INDEX_KEY_SIZE,
+                offset + FABRIC_PROPERTY_INDEX_HEADER_SIZE + self->position * FABRIC_PROPERTY_INDEX_KEY_SIZE);
+            self->position += self->count;
+            return status;
+        }
+        // Removing keys can leave a leaf empty
+        self->page_id = betoh32(*(uint32_t*)(header + 4));
+        self->position = 0;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Returns the next vertex of a property index scan
+ *
+ * Args:
+ *      self: A property index cursor
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The id of the next vertex or 0 at the end of the scan or on
+ *          failure
+ */
+vertexid_t Fabric_PropertyIndexCursor_next(PropertyIndexCursor *self, error_t *status) {
+    uint8_t *key;
+
+    *status = FABRIC_OK;
+    if (self->at == self->count) {
+        *status = Fabric_PropertyIndexCursor__fill(self);
+        if (FABRIC_OK != *status || 0 == self->count) {
+            self->page_id = 0;
+            return 0;
+        }
+    }
+    key = self->batch + self->at * FABRIC_PROPERTY_INDEX_KEY_SIZE;
+    if (memcmp(key, self->high, FABRIC_PROPERTY_INDEX_KEY_SIZE) > 0) {
+        // Stay at the end of the scan
+        self->at = self->count = 0;
+        self->page_id = 0;
+        return 0;
+    }
+    self->at++;
+    return Fabric_PropertyIndex__key_vertex_id(key);
+}
+
+/**
+ * Private function that adds an index object to the end of the directory
+ */
+static
+PropertyIndex *Fabric_PropertyIndexDirectory__append(PropertyIndexDirectory *self, error_t *status) {
+    PropertyIndex **indexes;
+    PropertyIndex *index;
+    uint32_t new_cap;
+
+    if (self->count == self->cap) {
+        new_cap = self->cap > 0 ? self->cap * 2 : 8;
+        indexes = Fabric_memrealloc_tagged(self->indexes,
+            new_cap * sizeof(PropertyIndex*), self->cap * sizeof(PropertyIndex*), FABRIC_MEM_INDEX);
+        if (NULL == indexes) {
+            *status = Fabric_memerrno();
+            return NULL;
+        }
+        self->indexes = indexes;
+        self->cap = new_cap;
+    }
+    index = Fabric_memalloc_tagged(sizeof(PropertyIndex), FABRIC_MEM_INDEX);
+    if (NULL == index) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    self->indexes[self->count++] = index;
+    *status = FABRIC_OK;
+    return index;
+}
+
+/**
+ * Private function that reads the property index directory into memory
+ */
+static
+error_t Fabric_PropertyIndexDirectory__load(PropertyIndexDirectory *self) {
+    Graph *graph = Fabric_IndexStore_get_graph(self->store);
+    uint32_t page_size = self->store->page_size;
+    uint32_t offset, used, position;
+    uint8_t *page;
+    PropertyIndex *index;
+    error_t status;
+
+    if (Fabric_IndexStore_get_page_count(self->store) < FABRIC_PROPERTY_INDEX_DIRECTORY_PAGE_ID) {
+        return FABRIC_OK;
+    }
+    page = Fabric_memalloc_tagged(page_size, FABRIC_MEM_INDEX);
+    if (NULL == page) {
+        return Fabric_memerrno();
+    }
+    offset = Fabric_IndexStore_get_page_offset(self->store, FABRIC_PROPERTY_INDEX_DIRECTORY_PAGE_ID);
+    status = Fabric_Graph_read_bytes(graph, page, page_size, offset);
+    Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_INDEX_STORE, 1);
+    used = betoh32(*(uint32_t*)(page + 8));
+    if (FABRIC_OK == status && page[0] != 0 &&
+        (page[0] != FABRIC_PROPERTY_INDEX_DIRECTORY_TYPE || used > page_size - FABRIC_PROPERTY_INDEX_HEADER_SIZE)) {
+        status = FABRIC_INDEX_ERROR;
+    }
+    if (FABRIC_OK != status || page[0] == 0) {
+        Fabric_memfree_tagged(page, page_size, FABRIC_MEM_INDEX);
+        return status;
+    }
+
+    for (position = FABRIC_PROPERTY_INDEX_HEADER_SIZE;
+         position + FABRIC_PROPERTY_INDEX_DIRECTORY_ENTRY_SIZE <= used + FABRIC_PROPERTY_INDEX_HEADER_SIZE;
+         position += FABRIC_PROPERTY_INDEX_DIRECTORY_ENTRY_SIZE) {
+        index = Fabric_PropertyIndexDirectory__append(self, &status);
+        if (FABRIC_OK != status) {
+            break;
+        }
+        Fabric_PropertyIndex__init(index, self->store,
+            betoh32(*(uint32_t*)(page + position)),
+            betoh16(*(uint16_t*)(page + position + 4)),
+            betoh32(*(uint32_t*)(page + position + 8)));
+    }
+    Fabric_memfree_tagged(page, page_size, FABRIC_MEM_INDEX);
+    return status;
+}
+
+/**
+ * Reads a graph's property index directory into memory
+ *
+ * Args:
+ *      store: The graph's index store
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The directory or NULL on failure
+ */
+PropertyIndexDirectory *Fabric_PropertyIndexDirectory_load(IndexStore *store, error_t *status) {
+    PropertyIndexDirectory *self = Fabric_memalloc_tagged(sizeof(PropertyIndexDirectory), FABRIC_MEM_INDEX);
+    if (NULL == self) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    self->store = store;
+    self->indexes = NULL;
+    self->count = 0;
+    self->cap = 0;
+    *status = Fabric_PropertyIndexDirectory__load(self);
+    if (FABRIC_OK != *status) {
+        Fabric_PropertyIndexDirectory_destroy(self);
+        return NULL;
+    }
+    return self;
+}
+
+/**
+ * Frees the memory held by a property index directory and its indices
+ */
+void Fabric_PropertyIndexDirectory_destroy(PropertyIndexDirectory *self) {
+    uint32_t i;
+    for (i = 0; i < self->count; i++) {
+        Fabric_memfree_tagged(self->indexes[i], sizeof(PropertyIndex), FABRIC_MEM_INDEX);
+    }
+    if (NULL != self->indexes) {
+        Fabric_memfree_tagged(self->indexes, self->cap * sizeof(PropertyIndex*), FABRIC_MEM_INDEX);
+    }
+    Fabric_memfree_tagged(self, sizeof(PropertyIndexDirectory), FABRIC_MEM_INDEX);
+}
+
+/**
+ * Gets the number of property indices in a directory
+ */
+uint32_t Fabric_PropertyIndexDirectory_get_count(PropertyIndexDirectory *self) {
+    return self->count;
+}
+
+/**
+ * Finds the property index of a class's property
+ *
+ * Args:
+ *      self: A property index directory
+ *      class_id: The class whose vertices are indexed
+ *      label_id: The label of the indexed property
+ *
+ * Returns: The index or NULL if there isn't one
+ */
+PropertyIndex *Fabric_PropertyIndexDirectory_find(PropertyIndexDirectory *self, classid_t class_id, labelid_t label_id) {
+    uint32_t i;
+    for (i = 0; i < self->count; i++) {
+        if (self->indexes[i]->class_id == class_id && self->indexes[i]->label_id == label_id) {
+            return self->indexes[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Creates an empty property index and adds it to the directory
+ *
+ * Args:
+ *      self: A property index directory
+ *      class_id: The class whose vertices are indexed
+ *      label_id: The label of the indexed property
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The new index or NULL on failure.  status is set to
+ *          FABRIC_INDEX_ERROR if the index exists or the directory is full
+ */
+PropertyIndex *Fabric_PropertyIndexDirectory_create(PropertyIndexDirectory *self, classid_t class_id, labelid_t label_id, error_t *status) {
+    Graph *graph = Fabric_IndexStore_get_graph(self->store);
+    uint8_t entry[FABRIC_PROPERTY_INDEX_DIRECTORY_ENTRY_SIZE];
+    uint32_t directory_offset, used;
+    PropertyIndexNode root;
+    PropertyIndex *index;
+
+    used = self->count * FABRIC_PROPERTY_INDEX_DIRECTORY_ENTRY_SIZE;
+    if (NULL != Fabric_PropertyIndexDirectory_find(self, class_id, label_id) ||
+        used + FABRIC_PROPERTY_INDEX_DIRECTORY_ENTRY_SIZE > self->store->page_size - FABRIC_PROPERTY_INDEX_HEADER_SIZE) {
+        *status = FABRIC_INDEX_ERROR;
+        return NULL;
+    }
+    *status = Fabric_IndexStore_reserve_root_pages(self->store);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    directory_offset = Fabric_IndexStore_get_page_offset(self->store, FABRIC_PROPERTY_INDEX_DIRECTORY_PAGE_ID);
+
+    // Write an empty root leaf
+    root.page_id = Fabric_IndexStore_allocate_page(self->store, status);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    root.is_leaf = TRUE;
+    root.num_keys = 0;
+    root.next_page_id = 0;
+    root.first_child_id = 0;
+    root.entries = NULL;
+    index = Fabric_PropertyIndexDirectory__append(self, status);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    Fabric_PropertyIndex__init(index, self->store, root.page_id, class_id, label_id);
+    *status = Fabric_PropertyIndex__write_node(index, &root, 0);
+
+    // The entry only counts once the directory's used bytes include it
+    *(uint32_t*)entry = htobe32(root.page_id);
+    *(uint16_t*)(entry + 4) = htobe16(class_id);
+    *(uint16_t*)(entry + 6) = 0;
+    *(uint32_t*)(entry + 8) = htobe32(label_id);
+    if (FABRIC_OK == *status) {
+        *status = Fabric_Graph_write_bytes(graph, entry, sizeof(entry),
+            directory_offset + FABRIC_PROPERTY_INDEX_HEADER_SIZE + used);
+    }
+    if (FABRIC_OK == *status) {
+        entry[0] = FABRIC_PROPERTY_INDEX_DIRECTORY_TYPE;
+        *status = Fabric_Graph_write_bytes(graph, entry, 1, directory_offset);
+        Fabric_Graph_write_uint32(graph, used + FABRIC_PROPERTY_INDEX_DIRECTORY_ENTRY_SIZE, directory_offset + 8);
+    }
+    if (FABRIC_OK != *status) {
+        Fabric_memfree_tagged(index, sizeof(PropertyIndex), FABRIC_MEM_INDEX);
+        self->count--;
+        return NULL;
+    }
+    return index;
+}
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_PROPERTYITERATOR_C__
+#define _FABRIC_PROPERTYITERATOR_C__
+
+#include "Internal.h"
+
+/**
+ * A Property Iterator walks the properties of a vertex or an edge one
+ * property at a time.
+ *
+ * An entity's properties form a linked list through the next_property_id
+ * fields of their records.  The iterator follows the list without
+ * allocating anything or adding the properties it reads to the property
+ * cache, and it reads a property only when it is asked for the next one.
+ * Fabric_PropertyIterator_find(3) skips ahead to the next property with a
+ * label, so a lookup stops at the first match.
+ *
+ * The properties returned by the iterator are copies owned by the
+ * iterator.  They are valid until the iterator is next advanced and are
+ * not affected by cache evictions; changes to them should be made to the
+ * property store's copy.  An iterator holds no resources and does not
+ * need to be deinitialized.
+ */
+typedef struct PropertyIterator {
+    Graph *graph;               // The graph whose properties are being walked
+    propertyid_t next_id;       // The id of the next property to return; 0 at the end
+    Property current;           // The property most recently returned
+} PropertyIterator;
+
+/**
+ * Initializes an iterator over a list of properties
+ *
+ * Args:
+ *      self: The iterator being initialized
+ *      graph: The graph the properties belong to
+ *      first_id: The id of the list's first property, or 0 for an empty list
+ */
+void Fabric_PropertyIterator_init(PropertyIterator *self, Graph *graph, propertyid_t first_id) {
+    self->graph = graph;
+    self->next_id = first_id;
+}
+
+/**
+ * Initializes an iterator over a vertex's properties
+ */
+void Fabric_PropertyIterator_init_vertex(PropertyIterator *self, Graph *graph, Vertex *vertex) {
+    Fabric_PropertyIterator_init(self, graph, Fabric_Vertex_get_first_property_id(vertex));
+}
+
+/**
+ * Initializes an iterator over an edge's properties
+ */
+void Fabric_PropertyIterator_init_edge(PropertyIterator *self, Graph *graph, Edge *edge) {
+    Fabric_PropertyIterator_init(self, graph, Fabric_Edge_get_first_property_id(edge));
+}
+
+/**
+ * Returns the iterator's next property
+ *
+ * Args:
+ *      self: The iterator
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The next property, or NULL once every property has been
+ *          returned or if an error occurred
+ */
+Property *Fabric_PropertyIterator_next(PropertyIterator *self, error_t *status) {
+    *status = FABRIC_OK;
+    if (self->next_id == 0) {
+        return NULL;
+    }
+    *status = Fabric_PropertyStore_read_property(
+        Fabric_Graph_get_property_store(self->graph), self->next_id, &self->current);
+    if (FABRIC_OK != *status) {
+        self->next_id = 0;
+        return NULL;
+    }
+    self->next_id = Fabric_Property_get_next_property_id(&self->current);
+    return &self->current;
+}
+
+/**
+ * Advances the iterator to its next property with a label
+ *
+ * Since a label is unique among an entity's properties, finding a label
+ * from a newly initialized iterator looks up the entity's property.
+ *
+ * Args:
+ *      self: The iterator
+ *      label_id: The label of the property being found
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The property, or NULL with status set to
+ *          FABRIC_PROPERTY_DOESNT_EXIST if no property left has the label
+ */
+Property *Fabric_PropertyIterator_find(PropertyIterator *self, labelid_t label_id, error_t *status) {
+    Property *property;
+    while (NULL != (property = Fabric_PropertyIterator_next(self, status))) {
+        if (Fabric_Property_get_label_id(property) == label_id) {
+            return property;
+        }
+    }
+    if (FABRIC_OK == *status) {
+        *status = FABRIC_PROPERTY_DOESNT_EXIST;
+    }
+    return NULL;
+}
+
+#endif
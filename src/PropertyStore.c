@@ -3,14 +3,36 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 23, 2015
- * Updated: March 27, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_PROPERTYSTORE_C__
 #define _FABRIC_PROPERTYSTORE_C__
 
+#include <string.h>
 #include "Internal.h"
 
+#define FABRIC_PROPERTYSTORE_HEADER_SIZE 12
+/* The number of records read at a time when evaluating a predicate */
+#define FABRIC_PROPERTYSTORE_SELECT_BLOCK 256
+
+/**
+ * A change to a vertex's property that the property indices and columns
+ * have not seen yet
+ *
+ * The old type is FABRIC_PROPTYPE_NOTHING for a property that was added
+ * and the new type is FABRIC_PROPTYPE_NOTHING for one that was removed.
+ */
+typedef struct PropertyChange {
+    vertexid_t vertex_id;   // The owner of the property
+    classid_t class_id;     // The class of the owner
+    labelid_t label_id;     // The label of the property
+    uint8_t old_type;       // The type the property had
+    uint8_t new_type;       // The type the property has now
+    uint8_t old_data[8];    // The value the property had
+    uint8_t new_data[8];    // The value the property has now
+} PropertyChange;
+
 /**
  * The Property Store is the component of the graph that has the responsibility
  * of managing the storage of Property objects.
@@ -18,30 +40,851 @@
  * For many of the functions to work, it is assumed that the Property Store
  * is embedded inside a Graph object.
  *
+ * The store begins with a 12 byte header holding the number of properties,
+ * the next free id and the last free id.  It is followed by the property
+ * records, starting with property 1.  Unused records have the type
+ * FABRIC_PROPTYPE_NOTHING and their freed ids are kept in a free id map
+ * (see FreeIdMap.c); older graphs link them through the next_property_id
+ * field.
+ *
+ * Changes to properties that have a property index or a property column
+ * are logged and applied to them when the store is flushed.
+ *
+ * Vertices with many properties get a property directory the first
+ * time one of their properties is looked up by label (see
+ * PropertyDirectory.c), so that their lookups don't walk their lists.
+ *
  * For a detailed description of Property objects, see the accompanying
- * Class.c file.
+ * Property.c file.
  */
 typedef struct PropertyStore {
-    uint32_t offset;    // graph file offset for the property store
-    uint32_t size;      // the size of the property store
+    uint32_t offset;            // graph file offset for the property store
+    uint32_t size;              // the size of the property store
+    ExtentList extents;         // the regions of the file that hold the property store
+    uint32_t num_properties;    // The number of properties in the graph
+    uint32_t last_free_id;      // The last property id available
+                                // Always points to an previously unwritten portion of the file
+    FreeIdMap free_ids;         // The freed ids below last_free_id
+    EntityCache *cache;         // A cache of properties; Includes at least all properties in changed
+    IdSet *changed;             // A set of properties that have changed since last write
+    PropertyChange *index_changes;  // Changes the property indices and columns haven't seen
+    uint32_t num_index_changes;     // The number of logged changes
+    uint32_t index_changes_cap;     // The capacity of the change log
+    EntityCache *directories;       // Property directories by vertex id, or NULL until one is built
 } PropertyStore;
 
+/**
+ * Internal function used by the cache to free evicted properties
+ */
+static
+void Fabric_PropertyStore__destroy_property(void *property) {
+    Fabric_Property_destroy(property);
+}
+
+/**
+ * Internal function used by the cache to free evicted property directories
+ */
+static
+void Fabric_PropertyStore__destroy_directory(void *directory) {
+    Fabric_PropertyDirectory_destroy(directory);
+}
+
 /**
  * Initializes a Property Store object
  *
  * Args:
  *      self: The Property Store object being initialized.  Its offset should
  *            already be set by the Graph
+ *
+ * Returns: FABRIC_OK on success or other error code on failure
+ */
+error_t Fabric_PropertyStore_init(PropertyStore *self) {
+    error_t status;
+    propertyid_t first_free_id;
+    uint8_t header[3 * sizeof(uint32_t)];
+    Graph *graph = Fabric_PropertyStore_get_graph(self);
+    self->size = Fabric_ExtentList_get_size(&self->extents);
+    Fabric_Graph_read_store_header(graph, header, sizeof(header), self->offset);
+    self->num_properties = betoh32(*(uint32_t*)header);
+    first_free_id = betoh32(*(uint32_t*)(header + 4));
+    self->last_free_id = betoh32(*(uint32_t*)(header + 8));
+
+    // A new store has never handed out an id
+    if (first_free_id == 0) {
+        first_free_id = 1;
+        self->last_free_id = 1;
+    }
+
+    Fabric_FreeIdMap_init(&self->free_ids);
+    status = Fabric_FreeIdMap_load(&self->free_ids, graph, FABRIC_PROPERTY_STORE, self->last_free_id);
+    if (FABRIC_FREEIDMAP_MISSING == status) {
+        // Older graphs link the free ids through the next property id of free property records
+        status = Fabric_FreeIdMap_load_list(&self->free_ids, graph, &self->extents,
+            first_free_id, self->last_free_id, sizeof(labelid_t), sizeof(uint32_t));
+    }
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    self->index_changes = NULL;
+    self->num_index_changes = 0;
+    self->index_changes_cap = 0;
+    self->directories = NULL;
+    self->cache = NULL;
+    // Changed properties are pinned in the cache until they are written
+    self->changed = Fabric_IdSet_new(&status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    self->cache = Fabric_EntityCache_new(
+        FABRIC_PROPERTY_CACHE_SIZE,
+        FABRIC_CACHE_POLICY,
+        self->changed,
+        Fabric_PropertyStore__destroy_property,
+        &status);
+    if (FABRIC_OK != status) {
+        Fabric_IdSet_destroy(self->changed);
+        self->changed = NULL;
+    }
+    return status;
+}
+
+/**
+ * Frees the memory used by a property store, including its cached
+ * properties
+ *
+ * Changes that have not been flushed are lost.
+ */
+void Fabric_PropertyStore_deinit(PropertyStore *self) {
+    if (NULL != self->cache) {
+        Fabric_EntityCache_destroy(self->cache);
+        self->cache = NULL;
+    }
+    if (NULL != self->changed) {
+        Fabric_IdSet_destroy(self->changed);
+        self->changed = NULL;
+    }
+    if (NULL != self->index_changes) {
+        Fabric_memfree_tagged(self->index_changes,
+            self->index_changes_cap * sizeof(PropertyChange), FABRIC_MEM_INDEX);
+        self->index_changes = NULL;
+    }
+    self->num_index_changes = 0;
+    self->index_changes_cap = 0;
+    if (NULL != self->directories) {
+        Fabric_EntityCache_destroy(self->directories);
+        self->directories = NULL;
+    }
+    Fabric_FreeIdMap_deinit(&self->free_ids);
+}
+
+/**
+ * Internal function for calculating the file offset of a property
+ */
+static inline uint32_t Fabric_PropertyStore__get_id_offset(PropertyStore *self, propertyid_t property_id) {
+    return Fabric_ExtentList_get_record_offset(&self->extents, property_id);
+}
+
+/**
+ * Internal function that serializes a changed property for the flush
+ */
+static
+void Fabric_PropertyStore__serialize(void *store, uint32_t property_id, uint8_t *destination) {
+    PropertyStore *self = store;
+    // If the property has been changed, it MUST be in the cache
+    Fabric_Property_load_bytes(Fabric_EntityCache_get(self->cache, property_id), destination);
+}
+
+/**
+ * Internal function that applies the logged changes to the property
+ * indices and columns, then writes the columns' changed rows
+ *
+ * Changes that couldn't be applied stay in the log.
+ */
+static
+error_t Fabric_PropertyStore__apply_index_changes(PropertyStore *self) {
+    IndexStore *is = Fabric_Graph_get_index_store(Fabric_PropertyStore_get_graph(self));
+    error_t status = FABRIC_OK;
+    uint32_t i;
+
+    for (i = 0; i < self->num_index_changes && FABRIC_OK == status; i++) {
+        status = Fabric_IndexStore_apply_property_change(is, &self->index_changes[i]);
+    }
+    if (FABRIC_OK != status) {
+        i--;
+    }
+    if (i > 0) {
+        memmove(self->index_changes, self->index_changes + i, (self->num_index_changes - i) * sizeof(PropertyChange));
+        self->num_index_changes -= i;
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_IndexStore_flush_property_columns(is);
+    }
+    return status;
+}
+
+/**
+ * Internal function that saves the property store's free id map and writes its header
+ *
+ * The free ids are all in the saved map, so the header's next free id
+ * is the same as its last free id.
  */
-void Fabric_PropertyStore_init(PropertyStore *self) {
+static
+error_t Fabric_PropertyStore__write_header(PropertyStore *self) {
     Graph *graph = Fabric_PropertyStore_get_graph(self);
-    self->size = Fabric_Graph_get_text_store_offset(graph) - self->offset;
+    error_t status = Fabric_FreeIdMap_save(&self->free_ids, graph, FABRIC_PROPERTY_STORE);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    // Write the property store's header
+    self->size = Fabric_ExtentList_get_size(&self->extents);
+    Fabric_Graph_update_uint32(graph, self->num_properties, self->offset);
+    Fabric_Graph_update_uint32(graph, self->last_free_id, self->offset + 4);
+    Fabric_Graph_update_uint32(graph, self->last_free_id, self->offset + 8);
+
+    return FABRIC_OK;
+}
+
+/**
+ * Writes updates to the property store to file.
+ *
+ * The logged changes are applied to the property indices and columns
+ * first.  The changed properties are then written in file order, with
+ * adjacent properties written together, and the header is only rewritten
+ * if it changed.
+ *
+ * Args:
+ *      self: The property store whose data is being persisted
+ *
+ * Returns:
+ *      FABRIC_OK if the write is successful
+ *      A memory error if there is not enough memory to complete the action
+ *      FABRIC_PROPERTYSTORE_NEEDS_RESIZE if the property store must be
+ *          resized before it can complete the write
+ */
+error_t Fabric_PropertyStore_flush(PropertyStore *self) {
+    error_t status = Fabric_PropertyStore__apply_index_changes(self);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    if (Fabric_IdSet_is_empty(self->changed)){
+        // Ids freed without changing a record only need the header
+        return Fabric_FreeIdMap_is_changed(&self->free_ids) ? Fabric_PropertyStore__write_header(self) : FABRIC_OK;
+    }
+    uint64_t started = Fabric_stats_now();
+
+    uint32_t *changed_ids = Fabric_IdSet_to_array(self->changed, &status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    int num_ids = Fabric_IdSet_get_count(self->changed);
+    int num_writable = 0;
+    int i;
+    propertyid_t max_id = 0;
+    Graph *graph = Fabric_PropertyStore_get_graph(self);
+
+    // Grow the store to fit every changed record first.  Properties that
+    // still don't fit stay in the changed set
+    for (i = 0; i < num_ids; i++) {
+        if (changed_ids[i] > max_id) {
+            max_id = changed_ids[i];
+        }
+    }
+    Fabric_Graph_grow_store(graph, FABRIC_PROPERTY_STORE, max_id);
+    for (i = 0; i < num_ids; i++) {
+        if (changed_ids[i] <= self->extents.capacity) {
+            changed_ids[num_writable++] = changed_ids[i];
+        }
+    }
+
+    status = Fabric_Graph_write_records(
+        graph,
+        changed_ids,
+        num_writable,
+        &self->extents,
+        Fabric_PropertyStore__serialize,
+        self);
+    Fabric_stats_add(FABRIC_STAT_FLUSHES + FABRIC_STATS_PROPERTY_STORE, 1);
+    Fabric_stats_add_elapsed(FABRIC_STAT_FLUSH_NANOS + FABRIC_STATS_PROPERTY_STORE, started);
+
+    if (FABRIC_OK == status) {
+        Fabric_stats_add(FABRIC_STAT_RECORDS_WRITTEN + FABRIC_STATS_PROPERTY_STORE, num_writable);
+        for (i = 0; i < num_writable; i++) {
+            Fabric_IdSet_remove(self->changed, changed_ids[i]);
+        }
+        if (num_writable < num_ids) {
+            status = FABRIC_PROPERTYSTORE_NEEDS_RESIZE;
+        }
+    }
+    Fabric_memfree(changed_ids, sizeof(uint32_t) * num_ids);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    return Fabric_PropertyStore__write_header(self);
+}
+
+/**
+ * Internal function for getting and updating the next id for a property
+ *
+ * The lowest freed id is reused before a new one is taken from the end
+ * of the store.
+ */
+static
+propertyid_t Fabric_PropertyStore__next_id(PropertyStore *self) {
+    propertyid_t property_id = Fabric_FreeIdMap_take(&self->free_ids);
+    if (0 == property_id) {
+        property_id = self->last_free_id++;
+    }
+    return property_id;
 }
 
+/**
+ * Internal function that frees a property's id so that it can be given out again
+ *
+ * If the free id map can't grow the id is never reused.
+ */
+static
+void Fabric_PropertyStore__add_free_id(PropertyStore *self, propertyid_t property_id) {
+    if (property_id + 1 == self->last_free_id) {
+        self->last_free_id--;
+    } else {
+        Fabric_FreeIdMap_add(&self->free_ids, property_id);
+    }
+}
+
+/**
+ * Gets a property by id from the store
+ *
+ * Args:
+ *      self: A graph's property store
+ *      property_id: The id of the property being retrieved
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The property object with the specified id, or NULL on failure
+ */
 Property *Fabric_PropertyStore_get_property(PropertyStore *self, propertyid_t property_id, error_t *status) {
-    // TODO: this is a stub
+    Property *property = Fabric_EntityCache_get(self->cache, property_id);
+    uint8_t data[FABRIC_PROPERTY_STORAGE_SIZE];
+    Graph *g;
     *status = FABRIC_OK;
+
+    // A cached copy may have changes not yet written to the file
+    if (!property) {
+        if (property_id < 1 || property_id > self->extents.capacity) {
+            *status = FABRIC_PROPERTYSTORE_INVALID_ID;
+            return NULL;
+        }
+        g = Fabric_PropertyStore_get_graph(self);
+        Fabric_Graph_read_bytes(g, data, FABRIC_PROPERTY_STORAGE_SIZE, Fabric_PropertyStore__get_id_offset(self, property_id));
+        Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_PROPERTY_STORE, 1);
+        property = Fabric_Property_new(property_id, status);
+        if (FABRIC_OK != *status) {
+            return NULL;
+        }
+        Fabric_Property_init(property, data);
+        // deleted records are not cached, since setting a property reuses them
+        if (FABRIC_PROPTYPE_NOTHING == Fabric_Property_get_type(property)) {
+            Fabric_Property_destroy(property);
+            *status = FABRIC_PROPERTY_DOESNT_EXIST;
+            return NULL;
+        }
+        *status = Fabric_EntityCache_set(self->cache, property_id, property);
+        if (FABRIC_OK != *status) {
+            Fabric_Property_destroy(property);
+            return NULL;
+        }
+    }
+
+    // Deleted properties have no type
+    if (FABRIC_PROPTYPE_NOTHING == Fabric_Property_get_type(property)) {
+        *status = FABRIC_PROPERTY_DOESNT_EXIST;
+        return NULL;
+    }
+
+    return property;
+}
+
+/**
+ * Reads a property by id into a property object owned by the caller
+ *
+ * The cached property is copied when there is one, since it may have
+ * changes not yet written to the file.  Otherwise the property's record
+ * is read from the graph file.  Either way nothing is added to the cache.
+ *
+ * Args:
+ *      self: A graph's property store
+ *      property_id: The id of the property being read
+ *      property: The property object the property is read into
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_PropertyStore_read_property(PropertyStore *self, propertyid_t property_id, Property *property) {
+    Property *cached = Fabric_EntityCache_get(self->cache, property_id);
+    uint8_t data[FABRIC_PROPERTY_STORAGE_SIZE];
+    error_t status;
+
+    if (cached) {
+        Fabric_Property_load_bytes(cached, data);
+    } else {
+        if (property_id < 1 || property_id > self->extents.capacity) {
+            return FABRIC_PROPERTYSTORE_INVALID_ID;
+        }
+        status = Fabric_Graph_read_bytes(
+            Fabric_PropertyStore_get_graph(self),
+            data,
+            FABRIC_PROPERTY_STORAGE_SIZE,
+            Fabric_PropertyStore__get_id_offset(self, property_id));
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_PROPERTY_STORE, 1);
+    }
+
+    Fabric_Property_set_id(property, property_id);
+    Fabric_Property_init(property, data);
+
+    // Deleted properties have no type
+    if (FABRIC_PROPTYPE_NOTHING == Fabric_Property_get_type(property)) {
+        return FABRIC_PROPERTY_DOESNT_EXIST;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Marks a property as changed so that it is written on the next flush
+ *
+ * Args:
+ *      self: A graph's property store
+ *      property: The property that was changed
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_PropertyStore_update_property(PropertyStore *self, Property *property) {
+    propertyid_t property_id = Fabric_Property_get_id(property);
+    // Mark the property as changed first so caching it can't evict it
+    error_t status = Fabric_IdSet_add(self->changed, property_id);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    return Fabric_EntityCache_set(self->cache, property_id, property);
+}
+
+/**
+ * Internal function that gets the property directory of a vertex, if it
+ * has one
+ */
+static inline
+PropertyDirectory *Fabric_PropertyStore__get_directory(PropertyStore *self, Vertex *vertex) {
+    return NULL == self->directories ? NULL : Fabric_EntityCache_get(self->directories, Fabric_Vertex_get_id(vertex));
+}
+
+/**
+ * Internal function that builds a vertex's property directory
+ *
+ * Returns: The directory, or NULL if it couldn't be built, in which case
+ *          the vertex's list is walked as if it had none
+ */
+static
+PropertyDirectory *Fabric_PropertyStore__add_directory(PropertyStore *self, Vertex *vertex) {
+    PropertyDirectory *directory;
+    error_t status;
+
+    if (NULL == self->directories) {
+        self->directories = Fabric_EntityCache_new(
+            FABRIC_PROPERTY_DIRECTORY_CACHE_SIZE,
+            FABRIC_CACHE_POLICY,
+            NULL,
+            Fabric_PropertyStore__destroy_directory,
+            &status);
+        if (FABRIC_OK != status) {
+            return NULL;
+        }
+    }
+    directory = Fabric_PropertyDirectory_build(Fabric_PropertyStore_get_graph(self), vertex, &status);
+    if (NULL == directory) {
+        return NULL;
+    }
+    if (FABRIC_OK != Fabric_EntityCache_set(self->directories, Fabric_Vertex_get_id(vertex), directory)) {
+        Fabric_PropertyDirectory_destroy(directory);
+        return NULL;
+    }
+    return directory;
+}
+
+/**
+ * Internal function that forgets a vertex's property directory, which
+ * is rebuilt when it is next needed
+ */
+static
+void Fabric_PropertyStore__drop_directory(PropertyStore *self, Vertex *vertex) {
+    PropertyDirectory *directory = Fabric_PropertyStore__get_directory(self, vertex);
+    if (NULL != directory) {
+        Fabric_EntityCache_unset(self->directories, Fabric_Vertex_get_id(vertex));
+        Fabric_PropertyDirectory_destroy(directory);
+    }
+}
+
+/**
+ * Gets the property of a vertex with a given label
+ *
+ * A vertex with a property directory has its property found without
+ * walking its list.  Otherwise the list is walked, and a directory is
+ * built once the walk has passed FABRIC_PROPERTY_DIRECTORY_MIN
+ * properties.
+ *
+ * Args:
+ *      self: A graph's property store
+ *      vertex: The owner of the property
+ *      label_id: The label of the property
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The property or NULL with status set to
+ *          FABRIC_PROPERTY_DOESNT_EXIST if the vertex has no such property
+ */
+Property *Fabric_PropertyStore_get_vertex_property(PropertyStore *self, Vertex *vertex, labelid_t label_id, error_t *status) {
+    PropertyDirectory *directory = Fabric_PropertyStore__get_directory(self, vertex);
+    propertyid_t property_id = Fabric_Vertex_get_first_property_id(vertex);
+    Property *property;
+    uint32_t num_walked = 0;
+
+    while (NULL == directory && property_id != 0) {
+        property = Fabric_PropertyStore_get_property(self, property_id, status);
+        if (FABRIC_OK != *status) {
+            return NULL;
+        }
+        if (Fabric_Property_get_label_id(property) == label_id) {
+            return property;
+        }
+        property_id = Fabric_Property_get_next_property_id(property);
+        if (++num_walked == FABRIC_PROPERTY_DIRECTORY_MIN && property_id != 0) {
+            directory = Fabric_PropertyStore__add_directory(self, vertex);
+        }
+    }
+    if (NULL != directory) {
+        property_id = Fabric_PropertyDirectory_find(directory, label_id);
+        if (property_id != 0) {
+            return Fabric_PropertyStore_get_property(self, property_id, status);
+        }
+    }
+    *status = FABRIC_PROPERTY_DOESNT_EXIST;
     return NULL;
 }
 
-#endif
\ No newline at end of file
+/**
+ * Internal function that makes room in the change log for one more
+ * change of a vertex's property, if the property has an index or a
+ * column
+ *
+ * Returns: FABRIC_OK on success, other error code on failure.  is_indexed
+ *          is set to whether the change needs to be logged.
+ */
+static
+error_t Fabric_PropertyStore__reserve_index_change(PropertyStore *self, Vertex *vertex, labelid_t label_id, bool_t *is_indexed) {
+    IndexStore *is = Fabric_Graph_get_index_store(Fabric_PropertyStore_get_graph(self));
+    PropertyChange *changes;
+    uint32_t new_cap;
+    error_t status;
+
+    *is_indexed = Fabric_IndexStore_tracks_property(is, Fabric_Vertex_get_class_id(vertex), label_id, &status);
+    if (FABRIC_OK != status || !*is_indexed) {
+        return status;
+    }
+
+    if (self->num_index_changes < self->index_changes_cap) {
+        return FABRIC_OK;
+    }
+    new_cap = self->index_changes_cap > 0 ? self->index_changes_cap * 2 : 64;
+    changes = Fabric_memrealloc_tagged(self->index_changes,
+        new_cap * sizeof(PropertyChange), self->index_changes_cap * sizeof(PropertyChange), FABRIC_MEM_INDEX);
+    if (NULL == changes) {
+        return Fabric_memerrno();
+    }
+    self->index_changes = changes;
+    self->index_changes_cap = new_cap;
+    return FABRIC_OK;
+}
+
+/**
+ * Internal function that logs a change of a vertex's property
+ *
+ * Room for the change must have been reserved.  A type of
+ * FABRIC_PROPTYPE_NOTHING logs an added or removed property, and its data
+ * may be NULL.
+ */
+static
+void Fabric_PropertyStore__log_index_change(PropertyStore *self, Vertex *vertex, labelid_t label_id,
+        uint8_t old_type, const uint8_t *old_data, uint8_t new_type, const uint8_t *new_data) {
+    PropertyChange *change = &self->index_changes[self->num_index_changes++];
+    change->vertex_id = Fabric_Vertex_get_id(vertex);
+    change->class_id = Fabric_Vertex_get_class_id(vertex);
+    change->label_id = label_id;
+    change->old_type = old_type;
+    change->new_type = new_type;
+    if (FABRIC_PROPTYPE_NOTHING != old_type) {
+        memcpy(change->old_data, old_data, 8);
+    }
+    if (FABRIC_PROPTYPE_NOTHING != new_type) {
+        memcpy(change->new_data, new_data, 8);
+    }
+}
+
+/**
+ * Sets the value of a vertex's property
+ *
+ * A vertex has at most one property with a label.  A new property is
+ * put at the head of the vertex's property list.
+ *
+ * Args:
+ *      self: A graph's property store
+ *      vertex: The owner of the property
+ *      label_id: The label of the property
+ *      value: A property whose type and data are the new value; its id,
+ *             label and next property are ignored
+ *
+ * Returns: FABRIC_OK on success, FABRIC_PROPERTY_ERROR if the value has
+ *          no type or other error code on failure
+ */
+error_t Fabric_PropertyStore_set_vertex_property(PropertyStore *self, Vertex *vertex, labelid_t label_id, Property *value) {
+    Graph *g = Fabric_PropertyStore_get_graph(self);
+    PropertyDirectory *directory;
+    propertyid_t property_id;
+    Property *property;
+    uint8_t old_type;
+    uint8_t old_data[8];
+    bool_t is_indexed;
+    bool_t is_reused;
+    error_t status;
+
+    if (FABRIC_PROPTYPE_NOTHING == Fabric_Property_get_type(value)) {
+        return FABRIC_PROPERTY_ERROR;
+    }
+    status = Fabric_PropertyStore__reserve_index_change(self, vertex, label_id, &is_indexed);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    property = Fabric_PropertyStore_get_vertex_property(self, vertex, label_id, &status);
+    if (FABRIC_OK == status) {
+        old_type = Fabric_Property_get_type(property);
+        memcpy(old_data, Fabric_Property_get_data(property), 8);
+        Fabric_Property_set_type(property, Fabric_Property_get_type(value));
+        memcpy(Fabric_Property_get_data(property), Fabric_Property_get_data(value), 8);
+        status = Fabric_PropertyStore_update_property(self, property);
+        if (FABRIC_OK != status) {
+            Fabric_Property_set_type(property, old_type);
+            memcpy(Fabric_Property_get_data(property), old_data, 8);
+            return status;
+        }
+        if (is_indexed) {
+            Fabric_PropertyStore__log_index_change(self, vertex, label_id,
+                old_type, old_data, Fabric_Property_get_type(property), Fabric_Property_get_data(property));
+        }
+        return FABRIC_OK;
+    } else if (FABRIC_PROPERTY_DOESNT_EXIST != status) {
+        return status;
+    }
+
+    property_id = Fabric_PropertyStore__next_id(self);
+    // A removed property stays cached until its record is written, and a
+    // new property with the same id takes over the cached object
+    property = Fabric_EntityCache_get(self->cache, property_id);
+    is_reused = NULL != property;
+    if (!is_reused) {
+        property = Fabric_Property_new(property_id, &status);
+        if (FABRIC_OK != status) {
+            Fabric_PropertyStore__add_free_id(self, property_id);
+            return status;
+        }
+    }
+    Fabric_Property_set_label_id(property, label_id);
+    Fabric_Property_set_next_property_id(property, Fabric_Vertex_get_first_property_id(vertex));
+    Fabric_Property_set_type(property, Fabric_Property_get_type(value));
+    memcpy(Fabric_Property_get_data(property), Fabric_Property_get_data(value), 8);
+
+    status = Fabric_PropertyStore_update_property(self, property);
+    if (FABRIC_OK != status) {
+        if (is_reused) {
+            Fabric_Property_set_type(property, FABRIC_PROPTYPE_NOTHING);
+            Fabric_Property_set_next_property_id(property, 0);
+        } else {
+            Fabric_IdSet_remove(self->changed, property_id);
+            Fabric_Property_destroy(property);
+        }
+        Fabric_PropertyStore__add_free_id(self, property_id);
+        return status;
+    }
+    Fabric_Vertex_set_first_property_id(vertex, property_id);
+    status = Fabric_VertexStore_update_vertex(Fabric_Graph_get_vertex_store(g), vertex);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    directory = Fabric_PropertyStore__get_directory(self, vertex);
+    if (NULL != directory && FABRIC_OK != Fabric_PropertyDirectory_add(directory, label_id, property_id)) {
+        Fabric_PropertyStore__drop_directory(self, vertex);
+    }
+    self->num_properties++;
+    if (is_indexed) {
+        Fabric_PropertyStore__log_index_change(self, vertex, label_id,
+            FABRIC_PROPTYPE_NOTHING, NULL, Fabric_Property_get_type(property), Fabric_Property_get_data(property));
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Removes a vertex's property
+ *
+ * The property's id is freed to be given out again.  Its record stays
+ * cached as unused until the next flush writes it, and the next property
+ * given the id reuses the cached object.
+ *
+ * Args:
+ *      self: A graph's property store
+ *      vertex: The owner of the property
+ *      label_id: The label of the property
+ *
+ * Returns: FABRIC_OK on success, FABRIC_PROPERTY_DOESNT_EXIST if the
+ *          vertex has no such property or other error code on failure
+ */
+error_t Fabric_PropertyStore_remove_vertex_property(PropertyStore *self, Vertex *vertex, labelid_t label_id) {
+    Graph *g = Fabric_PropertyStore_get_graph(self);
+    PropertyDirectory *directory;
+    propertyid_t property_id = Fabric_Vertex_get_first_property_id(vertex);
+    Property *property, *previous = NULL;
+    bool_t is_indexed;
+    error_t status;
+
+    status = Fabric_PropertyStore__reserve_index_change(self, vertex, label_id, &is_indexed);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    for (;;) {
+        if (property_id == 0) {
+            return FABRIC_PROPERTY_DOESNT_EXIST;
+        }
+        property = Fabric_PropertyStore_get_property(self, property_id, &status);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        if (Fabric_Property_get_label_id(property) == label_id) {
+            break;
+        }
+        previous = property;
+        property_id = Fabric_Property_get_next_property_id(property);
+    }
+
+    // Unlink the property from the vertex's list
+    if (NULL == previous) {
+        Fabric_Vertex_set_first_property_id(vertex, Fabric_Property_get_next_property_id(property));
+        status = Fabric_VertexStore_update_vertex(Fabric_Graph_get_vertex_store(g), vertex);
+    } else {
+        Fabric_Property_set_next_property_id(previous, Fabric_Property_get_next_property_id(property));
+        status = Fabric_PropertyStore_update_property(self, previous);
+    }
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    directory = Fabric_PropertyStore__get_directory(self, vertex);
+    if (NULL != directory) {
+        Fabric_PropertyDirectory_remove(directory, label_id);
+    }
+    if (is_indexed) {
+        Fabric_PropertyStore__log_index_change(self, vertex, label_id,
+            Fabric_Property_get_type(property), Fabric_Property_get_data(property), FABRIC_PROPTYPE_NOTHING, NULL);
+    }
+
+    // Mark the record as unused and free its id
+    Fabric_Property_set_type(property, FABRIC_PROPTYPE_NOTHING);
+    Fabric_Property_set_next_property_id(property, 0);
+    Fabric_PropertyStore__add_free_id(self, property_id);
+    self->num_properties--;
+    return Fabric_PropertyStore_update_property(self, property);
+}
+
+/**
+ * Evaluates a predicate over a range of the store's properties
+ *
+ * The records are read from the file a block at a time and evaluated
+ * together.  Properties that changed since the store was last flushed are
+ * evaluated from their cached copies instead.
+ *
+ * Args:
+ *      self: A graph's property store
+ *      predicate: The predicate being evaluated
+ *      label_id: The label a property must have to match, or 0 for any
+ *      first_id: The id of the first property in the range
+ *      count: The number of properties in the range
+ *      selection: Where a bit is set for each matching property and
+ *                 cleared for the others; (count + 7) / 8 bytes
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The number of matching properties.  status is set to
+ *          FABRIC_PROPERTYSTORE_INVALID_ID if the range includes ids that
+ *          haven't been given out
+ */
+uint32_t Fabric_PropertyStore_select_properties(
+    PropertyStore *self,
+    Predicate *predicate,
+    labelid_t label_id,
+    propertyid_t first_id,
+    uint32_t count,
+    uint8_t *selection,
+    error_t *status) {
+
+    uint8_t records[FABRIC_PROPERTYSTORE_SELECT_BLOCK * FABRIC_PROPERTY_STORAGE_SIZE];
+    Graph *g = Fabric_PropertyStore_get_graph(self);
+    uint32_t done, n, read, run, matches = 0, num_ids, i, bit;
+    uint32_t *changed_ids;
+    propertyid_t id;
+    Property *property;
+    bool_t match;
+
+    if (first_id < 1 || count > self->last_free_id - first_id) {
+        *status = FABRIC_PROPERTYSTORE_INVALID_ID;
+        return 0;
+    }
+    *status = FABRIC_OK;
+    for (done = 0; done < count; done += n) {
+        n = count - done < FABRIC_PROPERTYSTORE_SELECT_BLOCK ? count - done : FABRIC_PROPERTYSTORE_SELECT_BLOCK;
+        for (read = 0; read < n && FABRIC_OK == *status; read += run) {
+            id = first_id + done + read;
+            run = Fabric_ExtentList_get_contiguous(&self->extents, id);
+            run = run < n - read ? run : n - read;
+            *status = Fabric_Graph_read_bytes(g, records + read * FABRIC_PROPERTY_STORAGE_SIZE,
+                run * FABRIC_PROPERTY_STORAGE_SIZE, Fabric_PropertyStore__get_id_offset(self, id));
+        }
+        if (FABRIC_OK != *status) {
+            return 0;
+        }
+        Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_PROPERTY_STORE, n);
+        matches += Fabric_Predicate_select_records(predicate, records, n, label_id, selection + done / 8);
+    }
+
+    if (Fabric_IdSet_is_empty(self->changed)) {
+        return matches;
+    }
+    changed_ids = Fabric_IdSet_to_array(self->changed, status);
+    if (FABRIC_OK != *status) {
+        return 0;
+    }
+    num_ids = Fabric_IdSet_get_count(self->changed);
+    for (i = 0; i < num_ids; i++) {
+        if (changed_ids[i] < first_id || changed_ids[i] - first_id >= count) {
+            continue;
+        }
+        property = Fabric_EntityCache_get(self->cache, changed_ids[i]);
+        match = (0 == label_id || Fabric_Property_get_label_id(property) == label_id) &&
+            Fabric_Predicate_matches(predicate, Fabric_Property_get_type(property), Fabric_Property_get_data(property));
+        bit = changed_ids[i] - first_id;
+        if (match != ((selection[bit / 8] >> (bit % 8)) & 1)) {
+            selection[bit / 8] ^= 1 << (bit % 8);
+            matches += match ? 1 : -1;
+        }
+    }
+    Fabric_memfree(changed_ids, sizeof(uint32_t) * num_ids);
+    return matches;
+}
+
+#endif
@@ -0,0 +1,451 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_SNAPSHOT_C__
+#define _FABRIC_SNAPSHOT_C__
+
+#include <string.h>
+#ifndef FABRIC_NO_THREADS
+#  include <pthread.h>
+#endif
+#include "Internal.h"
+
+/**
+ * Snapshots let any number of threads read a graph while one thread
+ * writes to it.
+ *
+ * Each reader sees the graph as it was at the start of its snapshot.
+ * The writer works in an epoch.  Its changes become visible to new
+ * snapshots when it publishes them, which starts the next epoch.  A
+ * snapshot records the last published epoch when it begins.
+ *
+ * Isolation is provided by copy-on-write buffer pool pages.  The first
+ * time the writer changes a page in an epoch, a copy of the page as it
+ * was is kept as a page version.  The version is tagged with the epoch
+ * that replaced it, and snapshots from before that epoch read the
+ * version instead of the page.  Every other page is read from the
+ * buffer pool as usual.  Reads use positioned I/O, so no shared file
+ * position is involved.
+ *
+ * Versions are reclaimed by epoch: once no active snapshot is older than
+ * the epoch that replaced a version, the version is freed.  All memory is
+ * allocated and freed by the writer, so readers only take the manager's
+ * lock while they copy bytes out.
+ *
+ * The stores' caches are not shared with readers.  Readers use the
+ * Fabric_Snapshot_read_* functions, and only see the writer's changes
+ * once they have been flushed from the stores and published.
+ */
+typedef struct PageVersion {
+    uint32_t page_no;               // The page this is a version of
+    uint32_t end_epoch;             // Snapshots from before this epoch read this version
+    struct PageVersion *older;      // The page's previous version
+    struct PageVersion *newer;      // The page's next version
+    struct PageVersion *next;       // The next version in the order they were made
+    uint8_t *data;                  // The contents of the page
+} PageVersion;
+
+typedef struct SnapshotManager {
+    BufferPool *pool;               // The buffer pool of the graph
+    uint32_t published_epoch;       // The last published epoch
+    EntityMap *versions;            // Maps page numbers (+ 1) to their newest versions
+    PageVersion *oldest;            // The first version in the order they were made
+    PageVersion *newest;            // The last version in the order they were made
+    uint32_t active[FABRIC_MAX_SNAPSHOTS];   // The epoch of each active snapshot or 0
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_t lock;          // Protects the manager and the buffer pool
+#endif
+} SnapshotManager;
+
+typedef struct Snapshot {
+    SnapshotManager *manager;       // The manager of the graph being read
+    uint32_t epoch;                 // The epoch the snapshot reads
+    int slot;                       // The snapshot's entry in the manager's active list
+    ExtentList vertex_extents;      // The vertex store's extents when the snapshot began
+    ExtentList edge_extents;        // The edge store's extents when the snapshot began
+} Snapshot;
+
+#ifndef FABRIC_NO_THREADS
+#  define FABRIC_SNAPSHOT_LOCK(self) pthread_mutex_lock(&(self)->lock)
+#  define FABRIC_SNAPSHOT_UNLOCK(self) pthread_mutex_unlock(&(self)->lock)
+#else
+#  define FABRIC_SNAPSHOT_LOCK(self) ((void)(self))
+#  define FABRIC_SNAPSHOT_UNLOCK(self) ((void)(self))
+#endif
+
+/**
+ * Creates a snapshot manager for a graph's buffer pool
+ *
+ * Args:
+ *      pool: The buffer pool whose pages are versioned
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The new manager or NULL on failure
+ */
+SnapshotManager *Fabric_SnapshotManager_new(BufferPool *pool, error_t *status) {
+    SnapshotManager *self = Fabric_memalloc_tagged(sizeof(SnapshotManager), FABRIC_MEM_IO);
+    int i;
+
+    if (NULL == self) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    self->versions = Fabric_EntityMap_new(status);
+    if (FABRIC_OK != *status) {
+        Fabric_memfree_tagged(self, sizeof(SnapshotManager), FABRIC_MEM_IO);
+        return NULL;
+    }
+
+    self->pool = pool;
+    self->published_epoch = 1;
+    self->oldest = NULL;
+    self->newest = NULL;
+    for (i = 0; i < FABRIC_MAX_SNAPSHOTS; i++) {
+        self->active[i] = 0;
+    }
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_init(&self->lock, NULL);
+#endif
+    return self;
+}
+
+/**
+ * Private function that frees the oldest page version
+ */
+static
+void Fabric_SnapshotManager__free_oldest(SnapshotManager *self) {
+    PageVersion *version = self->oldest;
+
+    // The oldest version made is also the oldest version of its page
+    if (NULL != version->newer) {
+        version->newer->older = NULL;
+    } else {
+        Fabric_EntityMap_unset(self->versions, version->page_no + 1);
+    }
+    self->oldest = version->next;
+    if (NULL == self->oldest) {
+        self->newest = NULL;
+    }
+    Fabric_memfree_tagged(version->data, self->pool->page_size, FABRIC_MEM_IO);
+    Fabric_memfree_tagged(version, sizeof(PageVersion), FABRIC_MEM_IO);
+}
+
+/**
+ * Frees a snapshot manager and all of its page versions
+ *
+ * No snapshot of the graph may still be active.
+ */
+void Fabric_SnapshotManager_destroy(SnapshotManager *self) {
+    while (NULL != self->oldest) {
+        Fabric_SnapshotManager__free_oldest(self);
+    }
+    Fabric_EntityMap_destroy(self->versions);
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_destroy(&self->lock);
+#endif
+    Fabric_memfree_tagged(self, sizeof(SnapshotManager), FABRIC_MEM_IO);
+}
+
+/**
+ * Takes the lock that protects a manager and its graph's buffer pool
+ */
+void Fabric_SnapshotManager_lock(SnapshotManager *self) {
+    FABRIC_SNAPSHOT_LOCK(self);
+}
+
+/**
+ * Releases the lock taken by Fabric_SnapshotManager_lock(1)
+ */
+void Fabric_SnapshotManager_unlock(SnapshotManager *self) {
+    FABRIC_SNAPSHOT_UNLOCK(self);
+}
+
+/**
+ * Private function that frees the versions no snapshot can read
+ *
+ * Versions are made in epoch order, so the reclaimable versions are
+ * always the oldest ones.  The caller must hold the lock.
+ */
+static
+void Fabric_SnapshotManager__reclaim(SnapshotManager *self) {
+    uint32_t horizon = self->published_epoch;
+    int i;
+
+    // A version is still needed by any snapshot older than its end epoch
+    for (i = 0; i < FABRIC_MAX_SNAPSHOTS; i++) {
+        if (self->active[i] != 0 && self->active[i] < horizon) {
+            horizon = self->active[i];
+        }
+    }
+    while (NULL != self->oldest && self->oldest->end_epoch <= horizon) {
+        Fabric_SnapshotManager__free_oldest(self);
+    }
+}
+
+/**
+ * Keeps the current contents of the pages a write is about to change
+ *
+ * Pages that already have a version from the current epoch are left
+ * alone.  The caller must hold the lock and be the graph's writer.
+ *
+ * Args:
+ *      self: A graph's snapshot manager
+ *      offset: The file offset of the write
+ *      num_bytes: The length of the write
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_SnapshotManager_capture(SnapshotManager *self, uint32_t offset, uint32_t num_bytes) {
+    uint32_t page_size = self->pool->page_size;
+    uint32_t epoch = self->published_epoch + 1;
+    uint32_t page_no, last_page;
+    PageVersion *newest, *version;
+    error_t status;
+
+    if (num_bytes == 0) {
+        return FABRIC_OK;
+    }
+    last_page = (offset + num_bytes - 1) / page_size;
+    for (page_no = offset / page_size; page_no <= last_page; page_no++) {
+        newest = Fabric_EntityMap_get(self->versions, page_no + 1);
+        if (NULL != newest && newest->end_epoch == epoch) {
+            continue;
+        }
+
+        version = Fabric_memalloc_tagged(sizeof(PageVersion), FABRIC_MEM_IO);
+        if (NULL == version) {
+            return Fabric_memerrno();
+        }
+        version->data = Fabric_memalloc_tagged(page_size, FABRIC_MEM_IO);
+        if (NULL == version->data) {
+            Fabric_memfree_tagged(version, sizeof(PageVersion), FABRIC_MEM_IO);
+            return Fabric_memerrno();
+        }
+        status = Fabric_BufferPool_read(self->pool, version->data, page_size, page_no * page_size);
+        if (FABRIC_OK == status) {
+            status = Fabric_EntityMap_set(self->versions, page_no + 1, version);
+        }
+        if (FABRIC_OK != status) {
+            Fabric_memfree_tagged(version->data, page_size, FABRIC_MEM_IO);
+            Fabric_memfree_tagged(version, sizeof(PageVersion), FABRIC_MEM_IO);
+            return status;
+        }
+
+        version->page_no = page_no;
+        version->end_epoch = epoch;
+        version->older = newest;
+        version->newer = NULL;
+        version->next = NULL;
+        if (NULL != newest) {
+            newest->newer = version;
+        }
+        if (NULL != self->newest) {
+            self->newest->next = version;
+        } else {
+            self->oldest = version;
+        }
+        self->newest = version;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Makes the writes of the current epoch visible to new snapshots
+ *
+ * Versions that no snapshot can read anymore are freed.  The caller
+ * must be the graph's writer.
+ */
+void Fabric_SnapshotManager_publish(SnapshotManager *self) {
+    FABRIC_SNAPSHOT_LOCK(self);
+    self->published_epoch++;
+    Fabric_SnapshotManager__reclaim(self);
+    FABRIC_SNAPSHOT_UNLOCK(self);
+}
+
+/**
+ * Returns the number of page versions a manager is keeping
+ */
+uint32_t Fabric_SnapshotManager_get_num_versions(SnapshotManager *self) {
+    uint32_t count = 0;
+    PageVersion *version;
+
+    FABRIC_SNAPSHOT_LOCK(self);
+    for (version = self->oldest; NULL != version; version = version->next) {
+        count++;
+    }
+    FABRIC_SNAPSHOT_UNLOCK(self);
+    return count;
+}
+
+/**
+ * Begins a snapshot of a graph
+ *
+ * The snapshot must be ended with Fabric_Snapshot_end(1).  It can be
+ * used by one thread at a time.
+ *
+ * Args:
+ *      self: The snapshot being begun
+ *      graph: A graph with snapshots enabled
+ *
+ * Returns: FABRIC_OK on success, FABRIC_SNAPSHOT_ERROR if the graph
+ *          doesn't have snapshots enabled or FABRIC_SNAPSHOT_LIMIT if
+ *          FABRIC_MAX_SNAPSHOTS snapshots are already active
+ */
+error_t Fabric_Snapshot_begin(Snapshot *self, Graph *graph) {
+    SnapshotManager *manager = Fabric_Graph_get_snapshot_manager(graph);
+    int i;
+
+    if (NULL == manager) {
+        return FABRIC_SNAPSHOT_ERROR;
+    }
+
+    FABRIC_SNAPSHOT_LOCK(manager);
+    for (i = 0; i < FABRIC_MAX_SNAPSHOTS && manager->active[i] != 0; i++);
+    if (i == FABRIC_MAX_SNAPSHOTS) {
+        FABRIC_SNAPSHOT_UNLOCK(manager);
+        return FABRIC_SNAPSHOT_LIMIT;
+    }
+    self->manager = manager;
+    self->epoch = manager->published_epoch;
+    self->slot = i;
+    manager->active[i] = self->epoch;
+
+    // Stores only ever gain extents, so these stay valid for the snapshot
+    self->vertex_extents = *Fabric_Graph_get_store_extents(graph, FABRIC_VERTEX_STORE);
+    self->edge_extents = *Fabric_Graph_get_store_extents(graph, FABRIC_EDGE_STORE);
+    FABRIC_SNAPSHOT_UNLOCK(manager);
+    return FABRIC_OK;
+}
+
+/**
+ * Ends a snapshot
+ *
+ * The versions it was reading are freed by the writer's next publish.
+ */
+void Fabric_Snapshot_end(Snapshot *self) {
+    FABRIC_SNAPSHOT_LOCK(self->manager);
+    self->manager->active[self->slot] = 0;
+    FABRIC_SNAPSHOT_UNLOCK(self->manager);
+}
+
+/**
+ * Returns the epoch a snapshot reads
+ */
+uint32_t Fabric_Snapshot_get_epoch(Snapshot *self) {
+    return self->epoch;
+}
+
+/**
+ * Reads bytes of the graph file as they were when a snapshot began
+ *
+ * Args:
+ *      self: The snapshot being read
+ *      destination: The location to store the read data
+ *      num_bytes: The number of bytes to read
+ *      offset: The file offset to read from
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Snapshot_read_bytes(Snapshot *self, uint8_t *destination, uint32_t num_bytes, uint32_t offset) {
+    SnapshotManager *manager = self->manager;
+    uint32_t page_size = manager->pool->page_size;
+    uint32_t page_offset, length;
+    PageVersion *version, *visible;
+    error_t status = FABRIC_OK;
+
+    FABRIC_SNAPSHOT_LOCK(manager);
+    while (num_bytes > 0 && FABRIC_OK == status) {
+        page_offset = offset % page_size;
+        length = page_size - page_offset;
+        if (length > num_bytes) {
+            length = num_bytes;
+        }
+
+        // The snapshot reads the oldest version replaced after it began
+        visible = NULL;
+        version = Fabric_EntityMap_get(manager->versions, offset / page_size + 1);
+        for (; NULL != version && version->end_epoch > self->epoch; version = version->older) {
+            visible = version;
+        }
+        if (NULL != visible) {
+            memcpy(destination, visible->data + page_offset, length);
+        } else {
+            status = Fabric_BufferPool_read(manager->pool, destination, length, offset);
+        }
+
+        destination += length;
+        offset += length;
+        num_bytes -= length;
+    }
+    FABRIC_SNAPSHOT_UNLOCK(manager);
+    return status;
+}
+
+/**
+ * Reads a vertex as it was when a snapshot began
+ *
+ * Args:
+ *      self: The snapshot being read
+ *      vertex_id: The id of the vertex being read
+ *      vertex: Where the vertex will be stored
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Snapshot_read_vertex(Snapshot *self, vertexid_t vertex_id, Vertex *vertex) {
+    uint8_t data[FABRIC_VERTEX_STORAGE_SIZE];
+    error_t status;
+
+    if (vertex_id < 1 || vertex_id > self->vertex_extents.capacity) {
+        return FABRIC_VERTEXSTORE_INVALID_ID;
+    }
+    status = Fabric_Snapshot_read_bytes(
+        self, data, FABRIC_VERTEX_STORAGE_SIZE, Fabric_ExtentList_get_record_offset(&self->vertex_extents, vertex_id));
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    Fabric_Vertex_set_id(vertex, vertex_id);
+    Fabric_Vertex_init(vertex, data);
+    if (!Fabric_Vertex_is_in_use(vertex)) {
+        return FABRIC_VERTEX_DOESNT_EXIST;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Reads an edge as it was when a snapshot began
+ *
+ * Args:
+ *      self: The snapshot being read
+ *      edge_id: The id of the edge being read
+ *      edge: Where the edge will be stored
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Snapshot_read_edge(Snapshot *self, edgeid_t edge_id, Edge *edge) {
+    uint8_t data[FABRIC_EDGE_STORAGE_SIZE];
+    error_t status;
+
+    if (edge_id < 1 || edge_id > self->edge_extents.capacity) {
+        return FABRIC_EDGESTORE_INVALID_ID;
+    }
+    status = Fabric_Snapshot_read_bytes(
+        self, data, FABRIC_EDGE_STORAGE_SIZE, Fabric_ExtentList_get_record_offset(&self->edge_extents, edge_id));
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    Fabric_Edge_set_id(edge, edge_id);
+    Fabric_Edge_init(edge, data);
+    if (!Fabric_Edge_is_in_use(edge)) {
+        return FABRIC_EDGE_DOESNT_EXIST;
+    }
+    return FABRIC_OK;
+}
+
+#endif
@@ -0,0 +1,262 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_STATS_C__
+#define _FABRIC_STATS_C__
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef FABRIC_NO_THREADS
+#  include <pthread.h>
+#endif
+#include "Internal.h"
+
+/**
+ * Counters for the library's hot paths
+ *
+ * The counters are kept the same way memory usage is: each thread that
+ * counts something gets a block of counters, one per FABRIC_STAT_*
+ * value, that only it writes to, and Fabric_stats_read adds up every
+ * thread's block when it is asked.  Counting is a store to memory no
+ * other thread writes, so the counters can be left on.  When a thread
+ * exits its counts are folded into the retired block.
+ *
+ * The counters are kept for the whole process rather than for each graph,
+ * so a process with several graphs open counts all of them together.
+ * Fabric_Graph_get_stats(2) combines them with the counts each graph's
+ * caches and buffer pool keep for themselves.
+ *
+ * Defining FABRIC_NO_STATS compiles the counting out, and defining
+ * FABRIC_NO_THREADS uses a single block of counters.
+ */
+typedef struct StatCounters {
+    uint64_t values[FABRIC_STAT_NUM_COUNTERS];  // The count of each FABRIC_STAT_* value
+    struct StatCounters *next;                  // The next thread's counters
+} StatCounters;
+
+/**
+ * The counts for one of a graph's stores
+ */
+typedef struct GraphStoreStats {
+    uint64_t cache_hits;        // Lookups that found their entity in the store's cache
+    uint64_t cache_misses;      // Lookups that had to read the entity
+    uint64_t cache_evictions;   // Entities evicted from the store's cache
+    uint64_t records_read;      // Records (or text blocks, or index pages) read from the graph
+    uint64_t records_written;   // Records (or text blocks, or index pages) written to the graph
+    uint64_t flushes;           // The number of times the store was flushed
+    uint64_t flush_nanos;       // The time spent flushing the store
+} GraphStoreStats;
+
+/**
+ * A graph's statistics, as filled in by Fabric_Graph_get_stats(2)
+ */
+typedef struct GraphStats {
+    GraphStoreStats stores[FABRIC_STATS_NUM_STORES];    // Indexed by FABRIC_STATS_*_STORE
+    uint64_t read_bytes_calls;                          // Calls to Fabric_Graph_read_bytes(4)
+    uint64_t write_bytes_calls;                         // Calls to Fabric_Graph_write_bytes(4)
+    uint64_t bytes_read;                                // Bytes read through those calls
+    uint64_t bytes_written;                             // Bytes written through those calls
+    uint64_t seeks;                                     // Reads and writes that didn't follow the last one
+    uint64_t page_hits;                                 // Pages found in the buffer pool
+    uint64_t page_misses;                               // Pages the buffer pool loaded from the file
+    uint64_t file_bytes_read;                           // Bytes the buffer pool read from the file
+    uint64_t file_bytes_written;                        // Bytes the buffer pool wrote to the file
+    uint64_t graph_flushes;                             // Flushes of the buffer pool to the file
+    uint64_t graph_flush_nanos;                         // The time spent in those flushes
+    uint64_t idset_lookups;                             // Lookups of ids in id sets
+    uint64_t idset_probes;                              // Slots examined by those lookups
+    uint64_t idset_resizes;                             // The number of times an id set grew
+    uint64_t entitymap_lookups;                         // Lookups of keys in entity maps
+    uint64_t entitymap_probes;                          // Slots examined by those lookups
+    uint64_t entitymap_resizes;                         // The number of times an entity map grew
+    size_t memory_used[FABRIC_MEM_NUM_TAGS];            // Memory in use for each FABRIC_MEM_* tag
+    size_t memory_total;                                // All of the memory in use
+} GraphStats;
+
+static StatCounters _fabric_stats_retired;
+
+#ifndef FABRIC_NO_THREADS
+static pthread_mutex_t _fabric_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+#  ifndef FABRIC_NO_STATS
+static __thread StatCounters *_fabric_stats_counters;
+static pthread_once_t _fabric_stats_once = PTHREAD_ONCE_INIT;
+static pthread_key_t _fabric_stats_key;
+#  endif
+
+// Only the owning thread writes a block, but other threads read it
+#  define FABRIC_STATS_ADD(field, delta) __atomic_store_n(&(field), (field) + (delta), __ATOMIC_RELAXED)
+#  define FABRIC_STATS_LOAD(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+#  define FABRIC_STATS_CLEAR(field) __atomic_store_n(&(field), 0, __ATOMIC_RELAXED)
+#else
+#  ifndef FABRIC_NO_STATS
+static StatCounters *_fabric_stats_counters = &_fabric_stats_retired;
+#  endif
+
+#  define FABRIC_STATS_ADD(field, delta) ((field) += (delta))
+#  define FABRIC_STATS_LOAD(field) (field)
+#  define FABRIC_STATS_CLEAR(field) ((field) = 0)
+#endif
+
+#if !defined(FABRIC_NO_THREADS) && !defined(FABRIC_NO_STATS)
+/**
+ * Private function that folds an exiting thread's counts into the
+ * retired block
+ */
+static
+void Fabric_stats__retire_counters(void *arg) {
+    StatCounters *counters = arg;
+    StatCounters *previous;
+    int i;
+
+    pthread_mutex_lock(&_fabric_stats_lock);
+    for (i = 0; i < FABRIC_STAT_NUM_COUNTERS; i++) {
+        _fabric_stats_retired.values[i] += counters->values[i];
+    }
+    for (previous = &_fabric_stats_retired; previous->next != counters; previous = previous->next);
+    previous->next = counters->next;
+    pthread_mutex_unlock(&_fabric_stats_lock);
+    free(counters);
+}
+
+/**
+ * Private function that creates the key used to retire counters
+ */
+static
+void Fabric_stats__create_key() {
+    pthread_key_create(&_fabric_stats_key, Fabric_stats__retire_counters);
+}
+
+/**
+ * Private function that creates the calling thread's counters
+ *
+ * Returns: The new counters or NULL if they couldn't be allocated
+ */
+static
+StatCounters *Fabric_stats__new_counters() {
+    StatCounters *counters;
+
+    pthread_once(&_fabric_stats_once, Fabric_stats__create_key);
+    counters = calloc(1, sizeof(StatCounters));
+    if (NULL == counters) {
+        return NULL;
+    }
+    pthread_mutex_lock(&_fabric_stats_lock);
+    counters->next = _fabric_stats_retired.next;
+    _fabric_stats_retired.next = counters;
+    pthread_mutex_unlock(&_fabric_stats_lock);
+    pthread_setspecific(_fabric_stats_key, counters);
+    _fabric_stats_counters = counters;
+    return counters;
+}
+#endif
+
+/**
+ * Adds to one of the calling thread's counters
+ *
+ * A thread whose counters can't be allocated doesn't count anything.
+ *
+ * Args:
+ *      counter: One of the FABRIC_STAT_* values
+ *      delta: The amount to add
+ */
+static inline
+void Fabric_stats_add(int counter, uint64_t delta) {
+#ifndef FABRIC_NO_STATS
+    StatCounters *counters = _fabric_stats_counters;
+#ifndef FABRIC_NO_THREADS
+    if (__builtin_expect(NULL == counters, 0) && NULL == (counters = Fabric_stats__new_counters())) {
+        return;
+    }
+#endif
+    FABRIC_STATS_ADD(counters->values[counter], delta);
+#else
+    (void)counter;
+    (void)delta;
+#endif
+}
+
+/**
+ * Returns a monotonic time in nanoseconds for timing flushes, or 0 when
+ * FABRIC_NO_STATS is defined
+ */
+static inline
+uint64_t Fabric_stats_now() {
+#ifndef FABRIC_NO_STATS
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Adds the time since a call to Fabric_stats_now() to a counter
+ *
+ * Args:
+ *      counter: One of the FABRIC_STAT_* values
+ *      started: The value Fabric_stats_now() returned
+ */
+static inline
+void Fabric_stats_add_elapsed(int counter, uint64_t started) {
+#ifndef FABRIC_NO_STATS
+    Fabric_stats_add(counter, Fabric_stats_now() - started);
+#else
+    (void)counter;
+    (void)started;
+#endif
+}
+
+/**
+ * Adds up every thread's counters
+ *
+ * Args:
+ *      values: Where the FABRIC_STAT_NUM_COUNTERS totals are stored
+ */
+void Fabric_stats_read(uint64_t *values) {
+    StatCounters *counters;
+    int i;
+
+    memset(values, 0, FABRIC_STAT_NUM_COUNTERS * sizeof(uint64_t));
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_lock(&_fabric_stats_lock);
+#endif
+    for (counters = &_fabric_stats_retired; NULL != counters; counters = counters->next) {
+        for (i = 0; i < FABRIC_STAT_NUM_COUNTERS; i++) {
+            values[i] += FABRIC_STATS_LOAD(counters->values[i]);
+        }
+    }
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_unlock(&_fabric_stats_lock);
+#endif
+}
+
+/**
+ * Resets every thread's counters to zero
+ *
+ * Counts made by other threads while the counters are being reset may be
+ * lost, so it is best called while the library is idle.
+ */
+void Fabric_stats_reset() {
+    StatCounters *counters;
+    int i;
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_lock(&_fabric_stats_lock);
+#endif
+    for (counters = &_fabric_stats_retired; NULL != counters; counters = counters->next) {
+        for (i = 0; i < FABRIC_STAT_NUM_COUNTERS; i++) {
+            FABRIC_STATS_CLEAR(counters->values[i]);
+        }
+    }
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_unlock(&_fabric_stats_lock);
+#endif
+}
+
+#endif
@@ -0,0 +1,168 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+/**
+ * Checks a snapshot against the linked edge lists of every vertex
+ */
+static
+void snapshot_check_graph(AdjacencySnapshot *snapshot, Graph *graph, labelid_t label_id) {
+    EdgeIterator iterator;
+    Vertex *v;
+    Edge *e;
+    error_t status;
+    vertexid_t vertex_id;
+    vertexid_t *neighbors;
+    edgeid_t *edge_ids;
+    uint32_t count, expected, i;
+    int direction;
+
+    for (vertex_id = 1; vertex_id < graph->vertex_store.last_free_id; vertex_id++) {
+        v = Fabric_VertexStore_get_vertex(&graph->vertex_store, vertex_id, &status);
+        assert(FABRIC_OK == status);
+        for (direction = FABRIC_DIRECTION_OUT; direction <= FABRIC_DIRECTION_IN; direction++) {
+            neighbors = Fabric_AdjacencySnapshot_get_neighbors(snapshot, vertex_id, direction, &count);
+            edge_ids = Fabric_AdjacencySnapshot_get_edge_ids(snapshot, vertex_id, direction, &count);
+            assert(count == Fabric_AdjacencySnapshot_get_degree(snapshot, vertex_id, direction));
+
+            // the linked lists run from the newest edge to the oldest
+            expected = count;
+            Fabric_EdgeIterator_init(&iterator, graph, v, direction);
+            while (NULL != (e = Fabric_EdgeIterator_next(&iterator, &status))) {
+                if (label_id != 0 && Fabric_Edge_get_label_id(e) != label_id) {
+                    continue;
+                }
+                assert(expected > 0);
+                i = --expected;
+                assert(edge_ids[i] == Fabric_Edge_get_id(e));
+                assert(neighbors[i] == (direction == FABRIC_DIRECTION_OUT ?
+                    Fabric_Edge_get_to_vertex_id(e) : Fabric_Edge_get_from_vertex_id(e)));
+            }
+            assert(FABRIC_OK == status && 0 == expected);
+        }
+    }
+}
+
+/**
+ * Creates edges from every vertex to the next few vertices
+ */
+static
+void snapshot_add_edges(Graph *graph, vertexid_t first, vertexid_t last) {
+    Vertex *from, *to;
+    error_t status;
+    vertexid_t i, j;
+
+    for (i = first; i <= last; i++) {
+        for (j = i + 1; j <= last && j <= i + 3; j++) {
+            from = Fabric_VertexStore_get_vertex(&graph->vertex_store, i, &status);
+            assert(FABRIC_OK == status);
+            to = Fabric_VertexStore_get_vertex(&graph->vertex_store, j, &status);
+            assert(FABRIC_OK == status);
+            Fabric_EdgeStore_create_edge(&graph->edge_store, 1 + (i + j) % 2, from, to, &status);
+            assert(FABRIC_OK == status);
+        }
+    }
+}
+
+void test_adjacency_snapshot() {
+    FILE *db_file;
+    Graph graph;
+    Class *c;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    AdjacencySnapshot *all, *labeled, *loaded;
+    error_t status;
+    vertexid_t i;
+    uint32_t count;
+    size_t mem_used_start;
+
+    char *file_name = "test_snapshot.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    c = Fabric_Class_new(1, &status);
+    assert(FABRIC_OK == status);
+    memset(class_data, 0, sizeof(class_data));
+    Fabric_Class_init(c, class_data);
+    Fabric_ClassStore_update_class(&graph.class_store, c);
+    for (i = 1; i <= 60; i++) {
+        Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+        assert(FABRIC_OK == status);
+    }
+    snapshot_add_edges(&graph, 1, 40);
+
+    all = Fabric_AdjacencySnapshot_build(&graph, 0, &status);
+    assert(FABRIC_OK == status);
+    labeled = Fabric_AdjacencySnapshot_build(&graph, 2, &status);
+    assert(FABRIC_OK == status);
+    assert(Fabric_AdjacencySnapshot_is_current(all, &graph));
+    snapshot_check_graph(all, &graph, 0);
+    snapshot_check_graph(labeled, &graph, 2);
+    assert(3 == Fabric_AdjacencySnapshot_get_degree(all, 1, FABRIC_DIRECTION_OUT));
+    assert(0 == Fabric_AdjacencySnapshot_get_degree(all, 1, FABRIC_DIRECTION_IN));
+    assert(NULL == Fabric_AdjacencySnapshot_get_neighbors(all, 50, FABRIC_DIRECTION_OUT, &count) && 0 == count);
+    assert(0 == Fabric_AdjacencySnapshot_get_degree(all, 1000, FABRIC_DIRECTION_OUT));
+
+    // new edges are merged in by a refresh
+    snapshot_add_edges(&graph, 40, 60);
+    assert(!Fabric_AdjacencySnapshot_is_current(all, &graph));
+    assert(FABRIC_OK == Fabric_AdjacencySnapshot_refresh(all, &graph));
+    assert(FABRIC_OK == Fabric_AdjacencySnapshot_refresh(labeled, &graph));
+    assert(Fabric_AdjacencySnapshot_is_current(all, &graph));
+    snapshot_check_graph(all, &graph, 0);
+    snapshot_check_graph(labeled, &graph, 2);
+
+    // a saved snapshot survives reopening the graph
+    assert(FABRIC_OK == Fabric_AdjacencySnapshot_save(all, &graph));
+    Fabric_AdjacencySnapshot_destroy(all);
+    Fabric_AdjacencySnapshot_destroy(labeled);
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph.vertex_store));
+    assert(FABRIC_OK == Fabric_EdgeStore_flush(&graph.edge_store));
+    Fabric_close_graph(&graph);
+
+    Fabric_load_graph(db_file, &graph);
+    loaded = Fabric_AdjacencySnapshot_load(&graph, &status);
+    assert(FABRIC_OK == status);
+    assert(Fabric_AdjacencySnapshot_is_current(loaded, &graph));
+    snapshot_check_graph(loaded, &graph, 0);
+    Fabric_AdjacencySnapshot_destroy(loaded);
+
+    // snapshots release all of their memory
+    mem_used_start = Fabric_memused();
+    loaded = Fabric_AdjacencySnapshot_load(&graph, &status);
+    assert(FABRIC_OK == status);
+    all = Fabric_AdjacencySnapshot_build(&graph, 1, &status);
+    assert(FABRIC_OK == status);
+    Fabric_AdjacencySnapshot_destroy(all);
+    Fabric_AdjacencySnapshot_destroy(loaded);
+    assert(mem_used_start == Fabric_memused());
+
+    Fabric_AdjacencySnapshot_drop(&graph);
+    assert(NULL == Fabric_AdjacencySnapshot_load(&graph, &status));
+    assert(FABRIC_ADJACENCY_SNAPSHOT_MISSING == status);
+
+    Fabric_close_graph(&graph);
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for adjacency snapshots.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_adjacency_snapshot();
+    return 0;
+}
+#endif
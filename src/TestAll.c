@@ -8,7 +8,8 @@
 
 #define _FABRIC_TEST_ALL__
 
-#include "Fabric.h"
+#include "Fabric.c"
+#include "TestHelpers.c"
 #include "TestClass.c"
 #include "TestEdge.c"
 #include "TestGraph.c"
@@ -20,6 +21,27 @@
 #include "TestDynamicList.c"
 #include "TestIdSet.c"
 #include "TestEntityMap.c"
+#include "TestEntityCache.c"
+#include "TestBufferPool.c"
+#include "TestAdjacencySnapshot.c"
+#include "TestWal.c"
+#include "TestEntityView.c"
+#include "TestBulkLoad.c"
+#include "TestSnapshot.c"
+#include "TestIndex.c"
+#include "TestPropertyIndex.c"
+#include "TestPropertyColumn.c"
+#include "TestPredicate.c"
+#include "TestLabelPartition.c"
+#include "TestText.c"
+#include "TestByteSwap.c"
+#include "TestTraversal.c"
+#include "TestStats.c"
+#include "TestFreeIdMap.c"
+#include "TestCompaction.c"
+#include "TestDegreeCounts.c"
+#include "TestBatchRead.c"
+#include "TestWriteBatch.c"
 
 
 int main() {
@@ -29,8 +51,29 @@ int main() {
     test_dynamic_list();
     test_id_set();
     test_entity_map();
+    test_entity_cache();
+    test_buffer_pool();
 
     test_graph();
+    test_adjacency_snapshot();
+    test_wal();
+    test_entity_view();
+    test_bulk_load();
+    test_snapshot();
+    test_index();
+    test_property_index();
+    test_property_column();
+    test_predicate();
+    test_label_partition();
+    test_text();
+    test_byteswap();
+    test_traversal();
+    test_stats();
+    test_free_id_map();
+    test_compaction();
+    test_degree_counts();
+    test_batch_read();
+    test_write_batch();
 
     test_class();
     test_edge();
@@ -0,0 +1,162 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#include "TestHelpers.c"
+#endif
+
+#define BATCH_TEST_VERTICES 400
+#define BATCH_TEST_IDS 1000
+
+static vertexid_t batch_vertex_ids[BATCH_TEST_IDS];
+static Vertex batch_vertices[BATCH_TEST_IDS];
+static edgeid_t batch_edge_ids[BATCH_TEST_IDS];
+static Edge batch_edges[BATCH_TEST_IDS];
+
+void test_batch_read() {
+    FILE *db_file;
+    Graph graph;
+    GraphStats stats;
+    Class *c;
+    Vertex *v;
+    Edge edge, *new_edge;
+    Property properties[3];
+    PropertyIterator iterator;
+    propertyid_t property_ids[3];
+    labelid_t knows, age, height;
+    vertexid_t first_id, invalid_ids[4];
+    classid_t class_id;
+    int num_cached;
+    error_t status;
+    uint32_t i;
+
+    char *file_name = "test_batch_read.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    c = Fabric_ClassStore_create_class(&graph.class_store, NULL, "Vertex", FALSE, &status);
+    assert(FABRIC_OK == status);
+    class_id = Fabric_Class_get_id(c);
+    first_id = Fabric_VertexStore_create_vertices(&graph.vertex_store, c, BATCH_TEST_VERTICES, &status);
+    assert(FABRIC_OK == status && 1 == first_id);
+    knows = Fabric_LabelStore_add_label(&graph.label_store, "knows", &status);
+    age = Fabric_LabelStore_add_label(&graph.label_store, "age", &status);
+    height = Fabric_LabelStore_add_label(&graph.label_store, "height", &status);
+    assert(FABRIC_OK == status);
+    for (i = 1; i < BATCH_TEST_VERTICES; i++) {
+        Fabric_EdgeStore_create_edge(&graph.edge_store, knows,
+            test_get_vertex(&graph, i), test_get_vertex(&graph, i + 1), &status);
+        assert(FABRIC_OK == status);
+    }
+    v = test_get_vertex(&graph, 1);
+    test_set_integer_property(&graph, v, age, 41);
+    test_set_integer_property(&graph, v, height, 180);
+    assert(FABRIC_OK == Fabric_ClassStore_flush(&graph.class_store));
+    assert(FABRIC_OK == Fabric_LabelStore_flush(&graph.label_store));
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph.vertex_store));
+    assert(FABRIC_OK == Fabric_EdgeStore_flush(&graph.edge_store));
+    assert(FABRIC_OK == Fabric_PropertyStore_flush(&graph.property_store));
+    Fabric_close_graph(&graph);
+
+    // nothing is cached after loading, so every vertex is read
+    Fabric_load_graph(db_file, &graph);
+    for (i = 0; i < BATCH_TEST_IDS; i++) {
+        batch_vertex_ids[i] = BATCH_TEST_VERTICES - (i * 7) % BATCH_TEST_VERTICES;
+    }
+    num_cached = Fabric_EntityCache_get_count(graph.vertex_store.cache);
+    Fabric_stats_reset();
+    assert(FABRIC_OK == Fabric_VertexStore_read_vertices(&graph.vertex_store,
+        batch_vertex_ids, BATCH_TEST_IDS, batch_vertices));
+    Fabric_Graph_get_stats(&graph, &stats);
+#ifndef FABRIC_NO_STATS
+    // the repeated ids are read once, in runs of consecutive ids
+    assert(stats.read_bytes_calls < BATCH_TEST_VERTICES / 10);
+    assert(BATCH_TEST_IDS == stats.stores[FABRIC_STATS_VERTEX_STORE].records_read);
+#endif
+    assert(num_cached == Fabric_EntityCache_get_count(graph.vertex_store.cache));
+    for (i = 0; i < BATCH_TEST_IDS; i++) {
+        v = test_get_vertex(&graph, batch_vertex_ids[i]);
+        assert(batch_vertex_ids[i] == Fabric_Vertex_get_id(&batch_vertices[i]));
+        assert(class_id == Fabric_Vertex_get_class_id(&batch_vertices[i]));
+        assert(Fabric_Vertex_get_first_out_edge_id(v) == Fabric_Vertex_get_first_out_edge_id(&batch_vertices[i]));
+        assert(Fabric_Vertex_get_first_in_edge_id(v) == Fabric_Vertex_get_first_in_edge_id(&batch_vertices[i]));
+        assert(Fabric_Vertex_get_first_property_id(v) == Fabric_Vertex_get_first_property_id(&batch_vertices[i]));
+    }
+
+    // cached changes not yet written are seen, and bad ids are marked
+    new_edge = Fabric_EdgeStore_create_edge(&graph.edge_store, knows,
+        test_get_vertex(&graph, 5), test_get_vertex(&graph, 1), &status);
+    assert(FABRIC_OK == status);
+    invalid_ids[0] = 5;
+    invalid_ids[1] = 0;
+    invalid_ids[2] = graph.vertex_store.extents.capacity + 1;
+    invalid_ids[3] = 5;
+    assert(FABRIC_VERTEXSTORE_INVALID_ID == Fabric_VertexStore_read_vertices(&graph.vertex_store,
+        invalid_ids, 4, batch_vertices));
+    assert(0 == Fabric_Vertex_get_id(&batch_vertices[1]));
+    assert(0 == Fabric_Vertex_get_id(&batch_vertices[2]));
+    assert(5 == Fabric_Vertex_get_id(&batch_vertices[3]));
+    assert(Fabric_Edge_get_id(new_edge) == Fabric_Vertex_get_first_out_edge_id(&batch_vertices[0]));
+    assert(Fabric_Edge_get_id(new_edge) == Fabric_Vertex_get_first_out_edge_id(&batch_vertices[3]));
+
+    // edges come back in the order of their ids
+    for (i = 0; i < BATCH_TEST_IDS; i++) {
+        batch_edge_ids[i] = BATCH_TEST_VERTICES - (i * 3) % BATCH_TEST_VERTICES;
+    }
+    assert(FABRIC_OK == Fabric_EdgeStore_read_edges(&graph.edge_store,
+        batch_edge_ids, BATCH_TEST_IDS, batch_edges));
+    for (i = 0; i < BATCH_TEST_IDS; i++) {
+        assert(FABRIC_OK == Fabric_EdgeStore_read_edge(&graph.edge_store, batch_edge_ids[i], &edge));
+        assert(batch_edge_ids[i] == Fabric_Edge_get_id(&batch_edges[i]));
+        assert(Fabric_Edge_get_from_vertex_id(&edge) == Fabric_Edge_get_from_vertex_id(&batch_edges[i]));
+        assert(Fabric_Edge_get_to_vertex_id(&edge) == Fabric_Edge_get_to_vertex_id(&batch_edges[i]));
+        assert(Fabric_Edge_get_next_out_edge_id(&edge) == Fabric_Edge_get_next_out_edge_id(&batch_edges[i]));
+    }
+    assert(5 == Fabric_Edge_get_from_vertex_id(&batch_edges[0]));
+
+    // properties can be read in a batch and deleted ones are marked
+    Fabric_PropertyIterator_init_vertex(&iterator, &graph, test_get_vertex(&graph, 1));
+    property_ids[0] = Fabric_Property_get_id(Fabric_PropertyIterator_find(&iterator, height, &status));
+    Fabric_PropertyIterator_init_vertex(&iterator, &graph, test_get_vertex(&graph, 1));
+    property_ids[1] = Fabric_Property_get_id(Fabric_PropertyIterator_find(&iterator, age, &status));
+    assert(FABRIC_OK == status);
+    property_ids[2] = property_ids[0];
+    assert(FABRIC_OK == Fabric_PropertyStore_read_properties(&graph.property_store, property_ids, 3, properties));
+    assert(180 == Fabric_Property_get_integer_value(&properties[0]));
+    assert(41 == Fabric_Property_get_integer_value(&properties[1]));
+    assert(180 == Fabric_Property_get_integer_value(&properties[2]));
+    assert(FABRIC_OK == Fabric_PropertyStore_remove_vertex_property(&graph.property_store,
+        test_get_vertex(&graph, 1), height));
+    assert(FABRIC_PROPERTY_DOESNT_EXIST == Fabric_PropertyStore_read_properties(&graph.property_store,
+        property_ids, 3, properties));
+    assert(0 == Fabric_Property_get_id(&properties[0]));
+    assert(age == Fabric_Property_get_label_id(&properties[1]));
+    assert(0 == Fabric_Property_get_id(&properties[2]));
+
+    // an empty batch reads nothing
+    assert(FABRIC_OK == Fabric_EdgeStore_read_edges(&graph.edge_store, batch_edge_ids, 0, batch_edges));
+
+    Fabric_close_graph(&graph);
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for batch reads.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_batch_read();
+    return 0;
+}
+#endif
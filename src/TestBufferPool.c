@@ -0,0 +1,217 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+#define TEST_BP_PAGE_SIZE 64
+#define TEST_BP_FRAMES 4
+
+void test_buffer_pool() {
+    BufferPool pool;
+    FILE *file;
+    error_t status;
+    uint8_t in[TEST_BP_PAGE_SIZE * 3];
+    uint8_t out[TEST_BP_PAGE_SIZE * 3];
+    uint8_t *pages[TEST_BP_FRAMES];
+    uint8_t *page;
+    uint64_t misses;
+    size_t j;
+    int i;
+#ifndef _FABRIC_TEST_ALL__
+    Fabric_meminit();
+#endif
+    size_t starting_memory = Fabric_memused();
+
+    char *file_name = "test_buffer_pool.fdb";
+    file = fopen(file_name, "w+b");
+    assert(file != NULL);
+
+    status = Fabric_BufferPool_init(&pool, file, TEST_BP_PAGE_SIZE, TEST_BP_FRAMES);
+    assert(FABRIC_OK == status);
+    assert(0 == Fabric_BufferPool_get_bytes_read(&pool));
+    assert(0 == Fabric_BufferPool_get_bytes_written(&pool));
+
+    // pages past the end of the file read as zeros
+    status = Fabric_BufferPool_read(&pool, out, sizeof(out), 10);
+    assert(FABRIC_OK == status);
+    for (j = 0; j < sizeof(out); j++) {
+        assert(0 == out[j]);
+    }
+
+    // writes and reads may span pages
+    for (j = 0; j < sizeof(in); j++) {
+        in[j] = (uint8_t)(j * 7 + 1);
+    }
+    status = Fabric_BufferPool_write(&pool, in, sizeof(in), 30);
+    assert(FABRIC_OK == status);
+    status = Fabric_BufferPool_read(&pool, out, sizeof(out), 30);
+    assert(FABRIC_OK == status);
+    assert(0 == memcmp(in, out, sizeof(in)));
+
+    // touching more pages than there are frames evicts dirty pages,
+    // which must be written back and read again correctly
+    for (i = 10; i < 20; i++) {
+        status = Fabric_BufferPool_read(&pool, out, 1, i * TEST_BP_PAGE_SIZE);
+        assert(FABRIC_OK == status);
+    }
+    status = Fabric_BufferPool_read(&pool, out, sizeof(out), 30);
+    assert(FABRIC_OK == status);
+    assert(0 == memcmp(in, out, sizeof(in)));
+    assert(Fabric_BufferPool_get_bytes_written(&pool) >= sizeof(in));
+    assert(Fabric_BufferPool_get_bytes_read(&pool) >= sizeof(in));
+
+    // a pool whose frames are all pinned cannot load another page
+    for (i = 0; i < TEST_BP_FRAMES; i++) {
+        pages[i] = Fabric_BufferPool_pin(&pool, 40 + i, &status);
+        assert(FABRIC_OK == status);
+        assert(pages[i] != NULL);
+    }
+    page = Fabric_BufferPool_pin(&pool, 50, &status);
+    assert(NULL == page);
+    assert(FABRIC_BUFFERPOOL_ALL_PINNED == status);
+
+    // pinning a resident page again returns the same memory
+    page = Fabric_BufferPool_pin(&pool, 41, &status);
+    assert(FABRIC_OK == status);
+    assert(page == pages[1]);
+    Fabric_BufferPool_unpin(&pool, 41, FALSE);
+
+    pages[0][0] = 0xAB;
+    for (i = 0; i < TEST_BP_FRAMES; i++) {
+        Fabric_BufferPool_unpin(&pool, 40 + i, i == 0);
+    }
+
+    // flushed data must reach the file
+    status = Fabric_BufferPool_flush(&pool);
+    assert(FABRIC_OK == status);
+    fseek(file, 40 * TEST_BP_PAGE_SIZE, SEEK_SET);
+    assert(0xAB == fgetc(file));
+    fseek(file, 30, SEEK_SET);
+    assert(sizeof(in) == fread(out, 1, sizeof(in), file));
+    assert(0 == memcmp(in, out, sizeof(in)));
+
+    // prefetched pages are read in the background and found by later pins
+    memset(in, 0x5C, sizeof(in));
+    fseek(file, 60 * TEST_BP_PAGE_SIZE, SEEK_SET);
+    assert(sizeof(in) == fwrite(in, 1, sizeof(in), file));
+    fflush(file);
+    misses = Fabric_BufferPool_get_misses(&pool);
+    status = Fabric_BufferPool_prefetch(&pool, 60 * TEST_BP_PAGE_SIZE, sizeof(in));
+    assert(FABRIC_OK == status);
+    // only half of the frames are loaded by a prefetch
+    assert(misses + TEST_BP_FRAMES / 2 == Fabric_BufferPool_get_misses(&pool));
+    status = Fabric_BufferPool_read(&pool, out, 2 * TEST_BP_PAGE_SIZE, 60 * TEST_BP_PAGE_SIZE);
+    assert(FABRIC_OK == status);
+    assert(0 == memcmp(in, out, 2 * TEST_BP_PAGE_SIZE));
+    assert(misses + TEST_BP_FRAMES / 2 == Fabric_BufferPool_get_misses(&pool));
+
+    // a pin can take the frame of a loading page when the rest are pinned
+    for (i = 0; i < TEST_BP_FRAMES - 1; i++) {
+        pages[i] = Fabric_BufferPool_pin(&pool, 70 + i, &status);
+        assert(FABRIC_OK == status);
+    }
+    status = Fabric_BufferPool_prefetch(&pool, 62 * TEST_BP_PAGE_SIZE, TEST_BP_PAGE_SIZE);
+    assert(FABRIC_OK == status);
+    page = Fabric_BufferPool_pin(&pool, 63, &status);
+    assert(FABRIC_OK == status && NULL != page);
+    assert(0 == page[0]);
+    Fabric_BufferPool_unpin(&pool, 63, FALSE);
+    for (i = 0; i < TEST_BP_FRAMES - 1; i++) {
+        Fabric_BufferPool_unpin(&pool, 70 + i, FALSE);
+    }
+    status = Fabric_BufferPool_read(&pool, out, TEST_BP_PAGE_SIZE, 62 * TEST_BP_PAGE_SIZE);
+    assert(FABRIC_OK == status);
+    assert(0 == memcmp(in, out, TEST_BP_PAGE_SIZE));
+
+    // an incremental flush writes dirty pages in file order and keeps
+    // the lsn each page had when it became dirty
+    memset(in, 0x3D, sizeof(in));
+    assert(0 == Fabric_BufferPool_get_dirty_count(&pool));
+    assert(UINT64_MAX == Fabric_BufferPool_get_oldest_lsn(&pool));
+    Fabric_BufferPool_set_lsn(&pool, 7);
+    assert(FABRIC_OK == Fabric_BufferPool_write(&pool, in, 1, 85 * TEST_BP_PAGE_SIZE));
+    Fabric_BufferPool_set_lsn(&pool, 3);
+    assert(FABRIC_OK == Fabric_BufferPool_write(&pool, in, 1, 81 * TEST_BP_PAGE_SIZE));
+    Fabric_BufferPool_set_lsn(&pool, 8);
+    assert(FABRIC_OK == Fabric_BufferPool_write(&pool, in, 2, 85 * TEST_BP_PAGE_SIZE));
+    assert(2 == Fabric_BufferPool_get_dirty_count(&pool));
+    assert(3 == Fabric_BufferPool_get_oldest_lsn(&pool));
+    assert(FABRIC_OK == Fabric_BufferPool_flush_some(&pool, 1, &i));
+    assert(1 == i);
+    assert(7 == Fabric_BufferPool_get_oldest_lsn(&pool));
+    fflush(file);
+    fseek(file, 81 * TEST_BP_PAGE_SIZE, SEEK_SET);
+    assert(0x3D == fgetc(file));
+
+    // the next incremental flush continues after the last page written
+    // and wraps around to the start of the file
+    page = Fabric_BufferPool_pin(&pool, 85, &status);
+    assert(FABRIC_OK == status);
+    assert(FABRIC_OK == Fabric_BufferPool_write(&pool, in, 1, 80 * TEST_BP_PAGE_SIZE));
+    Fabric_BufferPool_unpin(&pool, 85, FALSE);
+    assert(FABRIC_OK == Fabric_BufferPool_flush_some(&pool, 1, &i));
+    assert(1 == i);
+    fflush(file);
+    fseek(file, 85 * TEST_BP_PAGE_SIZE, SEEK_SET);
+    assert(0x3D == fgetc(file));
+    assert(8 == Fabric_BufferPool_get_oldest_lsn(&pool));
+    assert(FABRIC_OK == Fabric_BufferPool_flush_some(&pool, TEST_BP_FRAMES, &i));
+    assert(1 == i);
+    assert(0 == Fabric_BufferPool_get_dirty_count(&pool));
+    fflush(file);
+    fseek(file, 80 * TEST_BP_PAGE_SIZE, SEEK_SET);
+    assert(0x3D == fgetc(file));
+
+    // a page changed at or after the commit lsn is neither written back
+    // nor evicted until the commit lsn passes its last change
+    Fabric_BufferPool_set_commit_lsn(&pool, 10);
+    Fabric_BufferPool_set_lsn(&pool, 10);
+    assert(FABRIC_OK == Fabric_BufferPool_write(&pool, in, 1, 90 * TEST_BP_PAGE_SIZE));
+    assert(FABRIC_OK == Fabric_BufferPool_flush(&pool));
+    assert(FABRIC_OK == Fabric_BufferPool_flush_some(&pool, TEST_BP_FRAMES, &i));
+    assert(0 == i);
+    assert(1 == Fabric_BufferPool_get_dirty_count(&pool));
+    for (i = 0; i < TEST_BP_FRAMES - 1; i++) {
+        pages[i] = Fabric_BufferPool_pin(&pool, 100 + i, &status);
+        assert(FABRIC_OK == status && NULL != pages[i]);
+    }
+    page = Fabric_BufferPool_pin(&pool, 100 + i, &status);
+    assert(NULL == page);
+    assert(FABRIC_BUFFERPOOL_ALL_PINNED == status);
+    for (i = 0; i < TEST_BP_FRAMES - 1; i++) {
+        Fabric_BufferPool_unpin(&pool, 100 + i, FALSE);
+    }
+    Fabric_BufferPool_set_commit_lsn(&pool, 9);
+    assert(FABRIC_OK == Fabric_BufferPool_flush(&pool));
+    assert(1 == Fabric_BufferPool_get_dirty_count(&pool));
+    Fabric_BufferPool_set_commit_lsn(&pool, 11);
+    assert(FABRIC_OK == Fabric_BufferPool_flush(&pool));
+    assert(0 == Fabric_BufferPool_get_dirty_count(&pool));
+    fseek(file, 90 * TEST_BP_PAGE_SIZE, SEEK_SET);
+    assert(0x3D == fgetc(file));
+
+    Fabric_BufferPool_deinit(&pool);
+    assert(starting_memory == Fabric_memused());
+
+    fclose(file);
+    remove(file_name);
+
+    printf("All tests passed for buffer pool.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    test_buffer_pool();
+    return 0;
+}
+#endif
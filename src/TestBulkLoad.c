@@ -0,0 +1,176 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+#define BULK_TEST_VERTICES 6000
+#define BULK_TEST_EDGES 9000
+#define BULK_TEST_BATCH 700
+
+/**
+ * Creates a graph file with two concrete classes
+ */
+static
+void bulk_create_graph(FILE *db_file, Graph *graph) {
+    Class *c;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    error_t status;
+    classid_t id;
+
+    Fabric_create_graph(db_file, graph);
+    Fabric_close_graph(graph);
+    Fabric_load_graph(db_file, graph);
+    memset(class_data, 0, sizeof(class_data));
+    for (id = 1; id <= 3; id++) {
+        c = Fabric_Class_new(id, &status);
+        assert(FABRIC_OK == status);
+        Fabric_Class_init(c, class_data);
+        Fabric_Class_set_label_id(c, id);
+        Fabric_Class_set_is_abstract(c, id == 3);
+        Fabric_ClassStore_update_class(&graph->class_store, c);
+    }
+}
+
+/**
+ * The ends of the test edges; most vertices get several edges each way
+ */
+static vertexid_t bulk_from(uint32_t i) { return 1 + (i * 7919) % BULK_TEST_VERTICES; }
+static vertexid_t bulk_to(uint32_t i) { return 1 + (i * 104729 + 13) % BULK_TEST_VERTICES; }
+static classid_t bulk_class(uint32_t i) { return 1 + i % 2; }
+static labelid_t bulk_label(uint32_t i) { return 1 + i % 5; }
+
+void test_bulk_load() {
+    FILE *bulk_file, *reference_file;
+    Graph bulk, reference;
+    BulkLoad load;
+    Vertex *from, *to, *v;
+    Class *c;
+    classid_t class_ids[BULK_TEST_BATCH];
+    labelid_t label_ids[BULK_TEST_BATCH];
+    vertexid_t from_ids[BULK_TEST_BATCH], to_ids[BULK_TEST_BATCH];
+    uint8_t bulk_record[FABRIC_EDGE_STORAGE_SIZE], reference_record[FABRIC_EDGE_STORAGE_SIZE];
+    uint32_t i, j, count;
+    vertexid_t first_vertex;
+    edgeid_t first_edge;
+    error_t status;
+    size_t mem_used_start;
+
+    char *bulk_name = "test_bulk.fdb";
+    char *reference_name = "test_bulk_reference.fdb";
+    bulk_file = fopen(bulk_name, "w+b");
+    reference_file = fopen(reference_name, "w+b");
+    bulk_create_graph(bulk_file, &bulk);
+    bulk_create_graph(reference_file, &reference);
+
+    // the reference graph is built one entity at a time
+    for (i = 1; i <= BULK_TEST_VERTICES; i++) {
+        c = Fabric_ClassStore_get_class(&reference.class_store, bulk_class(i), &status);
+        assert(FABRIC_OK == status);
+        v = Fabric_VertexStore_create_vertex(&reference.vertex_store, c, &status);
+        assert(FABRIC_OK == status && i == Fabric_Vertex_get_id(v));
+    }
+    for (i = 0; i < BULK_TEST_EDGES; i++) {
+        from = Fabric_VertexStore_get_vertex(&reference.vertex_store, bulk_from(i), &status);
+        assert(FABRIC_OK == status);
+        to = Fabric_VertexStore_get_vertex(&reference.vertex_store, bulk_to(i), &status);
+        assert(FABRIC_OK == status);
+        Fabric_EdgeStore_create_edge(&reference.edge_store, bulk_label(i), from, to, &status);
+        assert(FABRIC_OK == status);
+    }
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&reference.vertex_store));
+    assert(FABRIC_OK == Fabric_EdgeStore_flush(&reference.edge_store));
+    assert(FABRIC_OK == Fabric_ClassStore_flush(&reference.class_store));
+
+    // the bulk graph is loaded in batches with the same entities
+    mem_used_start = Fabric_memused();
+    assert(FABRIC_OK == Fabric_BulkLoad_begin(&load, &bulk));
+    for (i = 1; i <= BULK_TEST_VERTICES; i += count) {
+        count = BULK_TEST_VERTICES + 1 - i < BULK_TEST_BATCH ? BULK_TEST_VERTICES + 1 - i : BULK_TEST_BATCH;
+        for (j = 0; j < count; j++) {
+            class_ids[j] = bulk_class(i + j);
+        }
+        assert(FABRIC_OK == Fabric_BulkLoad_add_vertices(&load, class_ids, count, &first_vertex));
+        assert(i == first_vertex);
+    }
+    for (i = 0; i < BULK_TEST_EDGES; i += count) {
+        count = BULK_TEST_EDGES - i < BULK_TEST_BATCH ? BULK_TEST_EDGES - i : BULK_TEST_BATCH;
+        for (j = 0; j < count; j++) {
+            label_ids[j] = bulk_label(i + j);
+            from_ids[j] = bulk_from(i + j);
+            to_ids[j] = bulk_to(i + j);
+        }
+        assert(FABRIC_OK == Fabric_BulkLoad_add_edges(&load, label_ids, from_ids, to_ids, count, &first_edge));
+        assert(i + 1 == first_edge);
+    }
+
+    // bad batches are rejected whole
+    from_ids[0] = BULK_TEST_VERTICES + 1;
+    assert(FABRIC_BULKLOAD_INVALID_VERTEX == Fabric_BulkLoad_add_edges(&load, label_ids, from_ids, to_ids, 1, NULL));
+    class_ids[0] = 3;
+    assert(FABRIC_CLASS_ERROR == Fabric_BulkLoad_add_vertices(&load, class_ids, 1, NULL));
+
+    assert(FABRIC_OK == Fabric_BulkLoad_finish(&load));
+    assert(mem_used_start == Fabric_memused());
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&bulk.vertex_store));
+    assert(FABRIC_OK == Fabric_EdgeStore_flush(&bulk.edge_store));
+    Fabric_close_graph(&bulk);
+    Fabric_load_graph(bulk_file, &bulk);
+
+    // both graphs hold exactly the same records
+    assert(BULK_TEST_VERTICES == bulk.vertex_store.num_vertices);
+    assert(BULK_TEST_EDGES == bulk.edge_store.num_edges);
+    assert(reference.vertex_store.last_free_id == bulk.vertex_store.last_free_id);
+    assert(reference.edge_store.last_free_id == bulk.edge_store.last_free_id);
+    for (i = 1; i <= BULK_TEST_VERTICES; i++) {
+        Fabric_Graph_read_bytes(&bulk, bulk_record, FABRIC_VERTEX_STORAGE_SIZE,
+            Fabric_ExtentList_get_record_offset(&bulk.vertex_store.extents, i));
+        Fabric_Graph_read_bytes(&reference, reference_record, FABRIC_VERTEX_STORAGE_SIZE,
+            Fabric_ExtentList_get_record_offset(&reference.vertex_store.extents, i));
+        assert(0 == memcmp(bulk_record, reference_record, FABRIC_VERTEX_STORAGE_SIZE));
+    }
+    for (i = 1; i <= BULK_TEST_EDGES; i++) {
+        Fabric_Graph_read_bytes(&bulk, bulk_record, FABRIC_EDGE_STORAGE_SIZE,
+            Fabric_ExtentList_get_record_offset(&bulk.edge_store.extents, i));
+        Fabric_Graph_read_bytes(&reference, reference_record, FABRIC_EDGE_STORAGE_SIZE,
+            Fabric_ExtentList_get_record_offset(&reference.edge_store.extents, i));
+        assert(0 == memcmp(bulk_record, reference_record, FABRIC_EDGE_STORAGE_SIZE));
+    }
+    for (i = 1; i <= 2; i++) {
+        c = Fabric_ClassStore_get_class(&bulk.class_store, i, &status);
+        assert(FABRIC_OK == status);
+        assert(BULK_TEST_VERTICES / 2 == Fabric_Class_get_count(c));
+    }
+
+    // a store with freed ids can't be bulk loaded
+    assert(FABRIC_OK == Fabric_FreeIdMap_add(&bulk.edge_store.free_ids, 1));
+    mem_used_start = Fabric_memused();
+    assert(FABRIC_BULKLOAD_ERROR == Fabric_BulkLoad_begin(&load, &bulk));
+    Fabric_BulkLoad_abort(&load);
+    assert(mem_used_start == Fabric_memused());
+
+    Fabric_close_graph(&bulk);
+    Fabric_close_graph(&reference);
+    fclose(bulk_file);
+    fclose(reference_file);
+    remove(bulk_name);
+    remove(reference_name);
+    printf("All tests passed for bulk loading.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_bulk_load();
+    return 0;
+}
+#endif
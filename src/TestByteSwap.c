@@ -0,0 +1,209 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+#define BYTESWAP_TEST_MAX 70
+#define BYTESWAP_TEST_VERTICES 300
+
+/**
+ * Checks the current kernels against swapping each value on its own, at
+ * every count up to the test maximum and every misalignment
+ */
+static
+void byteswap_check_kernel() {
+    static uint8_t source[BYTESWAP_TEST_MAX * 8 + 8], destination[BYTESWAP_TEST_MAX * 8 + 8];
+    uint32_t count, shift, i, value32;
+    uint64_t value64;
+    int other = FABRIC_BYTE_ORDER_HOST == FABRIC_BYTE_ORDER_BIG_ENDIAN ?
+        FABRIC_BYTE_ORDER_LITTLE_ENDIAN : FABRIC_BYTE_ORDER_BIG_ENDIAN;
+
+    for (i = 0; i < sizeof(source); i++) {
+        source[i] = (uint8_t)(i * 37 + 11);
+    }
+    for (count = 0; count <= BYTESWAP_TEST_MAX; count++) {
+        for (shift = 0; shift < 4; shift++) {
+            memset(destination, 0xee, sizeof(destination));
+            Fabric_ByteSwap_copy32(destination + shift, source + shift, count, other);
+            for (i = 0; i < count; i++) {
+                memcpy(&value32, source + shift + i * 4, 4);
+                value32 = bswap32(value32);
+                assert(0 == memcmp(&value32, destination + shift + i * 4, 4));
+            }
+            // nothing past the array is written
+            assert(0xee == destination[shift + count * 4]);
+
+            memset(destination, 0xee, sizeof(destination));
+            Fabric_ByteSwap_copy64(destination + shift, source + shift, count, other);
+            for (i = 0; i < count; i++) {
+                memcpy(&value64, source + shift + i * 8, 8);
+                value64 = bswap64(value64);
+                assert(0 == memcmp(&value64, destination + shift + i * 8, 8));
+            }
+            assert(0xee == destination[shift + count * 8]);
+
+            // swapping in place twice gives back the array
+            memcpy(destination, source, sizeof(source));
+            Fabric_ByteSwap_copy32(destination + shift, destination + shift, count, other);
+            Fabric_ByteSwap_copy32(destination + shift, destination + shift, count, other);
+            Fabric_ByteSwap_copy64(destination + shift, destination + shift, count, other);
+            Fabric_ByteSwap_copy64(destination + shift, destination + shift, count, other);
+            assert(0 == memcmp(source, destination, sizeof(source)));
+        }
+    }
+
+    // the host's own order is copied as it is
+    Fabric_ByteSwap_copy32(destination, source, BYTESWAP_TEST_MAX, FABRIC_BYTE_ORDER_HOST);
+    assert(0 == memcmp(source, destination, BYTESWAP_TEST_MAX * 4));
+    Fabric_ByteSwap_copy64(destination + 1, source + 3, BYTESWAP_TEST_MAX, FABRIC_BYTE_ORDER_HOST);
+    assert(0 == memcmp(source + 3, destination + 1, BYTESWAP_TEST_MAX * 8));
+}
+
+static
+void byteswap_test_kernels() {
+    int kernel, best = Fabric_ByteSwap_get_kernel();
+
+    for (kernel = FABRIC_BYTESWAP_KERNEL_SCALAR; kernel <= FABRIC_BYTESWAP_KERNEL_AVX2; kernel++) {
+        if (Fabric_ByteSwap__use_kernel(kernel)) {
+            assert(kernel == Fabric_ByteSwap_get_kernel());
+            byteswap_check_kernel();
+        }
+    }
+    assert(!Fabric_ByteSwap__use_kernel(FABRIC_BYTESWAP_KERNEL_AVX2 + 1));
+    assert(Fabric_ByteSwap__use_kernel(best));
+}
+
+/**
+ * Reads a 32 bit value of a graph's file in a byte order
+ */
+static
+uint32_t byteswap_read_value(Graph *graph, long offset, int byte_order) {
+    uint32_t value;
+    assert(FABRIC_OK == Fabric_Graph_read_bytes(graph, (uint8_t*)&value, 4, offset));
+    return FABRIC_BYTE_ORDER_BIG_ENDIAN == byte_order ? betoh32(value) : letoh32(value);
+}
+
+/**
+ * Saves an adjacency snapshot and an integer column in a graph of a byte
+ * order, checks the bytes in the file and that both read back the same
+ */
+static
+void byteswap_test_graph(int byte_order) {
+    FILE *db_file;
+    Graph graph;
+    Class *c;
+    Vertex *from, *to;
+    Property *p;
+    PropertyColumn *column;
+    AdjacencySnapshot *built, *loaded;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    uint8_t data[FABRIC_PROPERTY_STORAGE_SIZE];
+    const vertexid_t *vertex_ids, *neighbors, *loaded_neighbors;
+    const int64_t *values;
+    uint32_t offset, count, loaded_count, row;
+    long page_offset;
+    error_t status;
+    vertexid_t i;
+
+    char *file_name = "test_byteswap.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph_with_byte_order(db_file, &graph, byte_order);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+    assert(byte_order == Fabric_Graph_get_byte_order(&graph));
+
+    c = Fabric_Class_new(1, &status);
+    assert(FABRIC_OK == status);
+    memset(class_data, 0, sizeof(class_data));
+    Fabric_Class_init(c, class_data);
+    assert(FABRIC_OK == Fabric_ClassStore_update_class(&graph.class_store, c));
+    p = Fabric_Property_new(0, &status);
+    assert(FABRIC_OK == status);
+    for (i = 1; i <= BYTESWAP_TEST_VERTICES; i++) {
+        to = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+        assert(FABRIC_OK == status);
+        memset(data, 0, sizeof(data));
+        Fabric_Property_init(p, data);
+        Fabric_Property_set_type(p, FABRIC_PROPTYPE_INTEGER);
+        Fabric_Property_set_integer_value(p, (int64_t)i * 1000003 - 7);
+        assert(FABRIC_OK == Fabric_PropertyStore_set_vertex_property(&graph.property_store, to, 1, p));
+        if (i > 1) {
+            from = Fabric_VertexStore_get_vertex(&graph.vertex_store, i / 2, &status);
+            assert(FABRIC_OK == status);
+            to = Fabric_VertexStore_get_vertex(&graph.vertex_store, i, &status);
+            assert(FABRIC_OK == status);
+            Fabric_EdgeStore_create_edge(&graph.edge_store, 1, from, to, &status);
+            assert(FABRIC_OK == status);
+        }
+    }
+    Fabric_Property_destroy(p);
+    column = Fabric_IndexStore_create_property_column(&graph.index_store, 1, 1, FABRIC_COLUMN_INTEGER, &status);
+    assert(FABRIC_OK == status && NULL != column);
+    built = Fabric_AdjacencySnapshot_build(&graph, 0, &status);
+    assert(FABRIC_OK == status);
+    assert(FABRIC_OK == Fabric_AdjacencySnapshot_save(built, &graph));
+
+    // the arrays are laid out in the file's byte order
+    offset = Fabric_Graph_get_adjacency_snapshot_offset(&graph);
+    assert(BYTESWAP_TEST_VERTICES == byteswap_read_value(&graph, offset + 4, byte_order));
+    assert(BYTESWAP_TEST_VERTICES - 1 == byteswap_read_value(&graph, offset + 8, byte_order));
+    page_offset = Fabric_IndexStore_get_page_offset(&graph.index_store, column->page_ids[0]);
+    assert(BYTESWAP_TEST_VERTICES == byteswap_read_value(&graph, page_offset + 8, FABRIC_BYTE_ORDER_BIG_ENDIAN));
+    assert(2 == byteswap_read_value(&graph, page_offset + 12 + 4, byte_order));
+    Fabric_close_graph(&graph);
+
+    // and read back the same after reopening the graph
+    Fabric_load_graph(db_file, &graph);
+    assert(byte_order == Fabric_Graph_get_byte_order(&graph));
+    loaded = Fabric_AdjacencySnapshot_load(&graph, &status);
+    assert(FABRIC_OK == status && NULL != loaded);
+    for (i = 1; i <= BYTESWAP_TEST_VERTICES; i++) {
+        neighbors = Fabric_AdjacencySnapshot_get_neighbors(built, i, FABRIC_DIRECTION_OUT, &count);
+        loaded_neighbors = Fabric_AdjacencySnapshot_get_neighbors(loaded, i, FABRIC_DIRECTION_OUT, &loaded_count);
+        assert(count == loaded_count);
+        assert(0 == count || 0 == memcmp(neighbors, loaded_neighbors, count * sizeof(vertexid_t)));
+        neighbors = Fabric_AdjacencySnapshot_get_neighbors(loaded, i, FABRIC_DIRECTION_IN, &count);
+        assert(i == 1 ? 0 == count : 1 == count && i / 2 == neighbors[0]);
+    }
+    Fabric_AdjacencySnapshot_destroy(built);
+    Fabric_AdjacencySnapshot_destroy(loaded);
+
+    column = Fabric_IndexStore_get_property_column(&graph.index_store, 1, 1, &status);
+    assert(FABRIC_OK == status && NULL != column);
+    assert(BYTESWAP_TEST_VERTICES == Fabric_PropertyColumn_get_row_count(column));
+    vertex_ids = Fabric_PropertyColumn_get_vertex_ids(column);
+    values = Fabric_PropertyColumn_get_integers(column);
+    for (row = 0; row < BYTESWAP_TEST_VERTICES; row++) {
+        assert(row + 1 == vertex_ids[row]);
+        assert((int64_t)(row + 1) * 1000003 - 7 == values[row]);
+    }
+    Fabric_close_graph(&graph);
+
+    fclose(db_file);
+    remove(file_name);
+}
+
+void test_byteswap() {
+    byteswap_test_kernels();
+    byteswap_test_graph(FABRIC_BYTE_ORDER_BIG_ENDIAN);
+    byteswap_test_graph(FABRIC_BYTE_ORDER_LITTLE_ENDIAN);
+    printf("All tests passed for byte swapping.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_byteswap();
+    return 0;
+}
+#endif
@@ -3,16 +3,220 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 25, 2015
- * Updated: March 26, 2015
+ * Updated: October 14, 2026
  */
 
 #include <stdio.h>
 #include <assert.h>
 #ifndef _FABRIC_TEST_ALL__
-#include "Fabric.h"
+#include "Fabric.c"
 #endif
 #include "Graph.c"
 
+#define CLASS_TEST_MANY (FABRIC_CLASS_CACHE_SIZE + 100)
+
+/**
+ * Checks that a class's descendents come from the class hierarchy in the
+ * same order as walking its child lists
+ */
+static
+void class_check_descendents(Graph *graph, Class *c, int expected) {
+    DynamicList *list, *walked;
+    ClassIterator iterator;
+    Class *next;
+    error_t status;
+    int i;
+
+    list = Fabric_Class_get_descendent_classes(c, graph, &status);
+    assert(FABRIC_OK == status);
+    walked = Fabric_DynamicList_new(&status);
+    assert(FABRIC_OK == Fabric_Class_load_descendent_classes(c, graph, walked, 0));
+    assert(expected == Fabric_DynamicList_count(list));
+    assert(expected == Fabric_DynamicList_count(walked));
+    for (i = 0; i < expected; i++) {
+        assert(Fabric_DynamicList_at(list, i) == Fabric_DynamicList_at(walked, i));
+    }
+
+    // an iterator returns copies of the same classes in the same order
+    Fabric_ClassIterator_init_descendents(&iterator, graph, c);
+    for (i = 0; NULL != (next = Fabric_ClassIterator_next(&iterator, &status)); i++) {
+        assert(i < expected);
+        assert(Fabric_Class_get_id(next) == (classid_t)(uintptr_t)Fabric_DynamicList_at(list, i));
+    }
+    assert(FABRIC_OK == status && expected == i);
+    Fabric_DynamicList_destroy(list);
+    Fabric_DynamicList_destroy(walked);
+}
+
+/**
+ * Tests the class hierarchy's subclass tests and total counts
+ */
+static
+void class_test_hierarchy() {
+    FILE *db_file;
+    Graph graph;
+    ClassStore *cs;
+    Class *root, *animal, *dog, *cat, *plant, *tree, *fish, *child;
+    ClassIterator iterator;
+    error_t status;
+    int i;
+
+    char *file_name = "test_class.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+    cs = &graph.class_store;
+
+    root = Fabric_ClassStore_create_class(cs, NULL, "Vertex", FALSE, &status);
+    assert(FABRIC_OK == status && NULL != root);
+    animal = Fabric_ClassStore_create_class(cs, root, "Animal", TRUE, &status);
+    assert(FABRIC_OK == status);
+    // the hierarchy is numbered once and kept up to date from then on
+    assert(Fabric_Class_is_subclass_of(animal, root, &graph, &status) && FABRIC_OK == status);
+    dog = Fabric_ClassStore_create_class(cs, animal, "Dog", FALSE, &status);
+    cat = Fabric_ClassStore_create_class(cs, animal, "Cat", FALSE, &status);
+    plant = Fabric_ClassStore_create_class(cs, root, "Plant", FALSE, &status);
+    tree = Fabric_ClassStore_create_class(cs, plant, "Tree", FALSE, &status);
+    assert(FABRIC_OK == status);
+
+    assert(Fabric_Class_is_subclass_of(dog, animal, &graph, &status));
+    assert(Fabric_Class_is_subclass_of(dog, root, &graph, &status));
+    assert(Fabric_Class_is_subclass_of(dog, dog, &graph, &status));
+    assert(!Fabric_Class_is_subclass_of(dog, plant, &graph, &status));
+    assert(!Fabric_Class_is_subclass_of(animal, dog, &graph, &status));
+    assert(!Fabric_Class_is_subclass_of(cat, dog, &graph, &status));
+    assert(Fabric_Class_is_subclass_of(tree, root, &graph, &status) && FABRIC_OK == status);
+    class_check_descendents(&graph, root, 5);
+    class_check_descendents(&graph, animal, 2);
+
+    // child classes are walked newest first and the walk can stop early
+    Fabric_ClassIterator_init_children(&iterator, &graph, root);
+    child = Fabric_ClassIterator_next(&iterator, &status);
+    assert(FABRIC_OK == status && Fabric_Class_get_id(plant) == Fabric_Class_get_id(child));
+    child = Fabric_ClassIterator_next(&iterator, &status);
+    assert(FABRIC_OK == status && Fabric_Class_get_id(animal) == Fabric_Class_get_id(child));
+    assert(NULL == Fabric_ClassIterator_next(&iterator, &status) && FABRIC_OK == status);
+    Fabric_ClassIterator_init_children(&iterator, &graph, dog);
+    assert(NULL == Fabric_ClassIterator_next(&iterator, &status) && FABRIC_OK == status);
+
+    for (i = 0; i < 3; i++) {
+        Fabric_VertexStore_create_vertex(&graph.vertex_store, dog, &status);
+        assert(FABRIC_OK == status);
+    }
+    for (i = 0; i < 2; i++) {
+        Fabric_VertexStore_create_vertex(&graph.vertex_store, cat, &status);
+    }
+    Fabric_VertexStore_create_vertex(&graph.vertex_store, tree, &status);
+    Fabric_VertexStore_create_vertex(&graph.vertex_store, root, &status);
+    assert(FABRIC_OK == status);
+    assert(7 == Fabric_Class_get_total_count(root, &graph, &status));
+    assert(5 == Fabric_Class_get_total_count(animal, &graph, &status));
+    assert(1 == Fabric_Class_get_total_count(plant, &graph, &status));
+    assert(3 == Fabric_Class_get_total_count(dog, &graph, &status) && FABRIC_OK == status);
+
+    // deleting a class takes it out of the hierarchy
+    assert(FABRIC_CANT_DELETE_CLASS_HAS_MEMBERS == Fabric_ClassStore_delete_class(cs, cat));
+    fish = Fabric_ClassStore_create_class(cs, animal, "Fish", FALSE, &status);
+    assert(FABRIC_OK == status);
+    class_check_descendents(&graph, root, 6);
+    assert(Fabric_Class_is_subclass_of(fish, animal, &graph, &status));
+    assert(FABRIC_OK == Fabric_ClassStore_delete_class(cs, fish));
+    class_check_descendents(&graph, root, 5);
+    class_check_descendents(&graph, animal, 2);
+    assert(!Fabric_ClassStore_is_subclass(cs, 7, 1, &status));
+    assert(FABRIC_CLASS_DOESNT_EXIST == status);
+    assert(Fabric_Class_is_subclass_of(tree, plant, &graph, &status));
+    assert(7 == Fabric_Class_get_total_count(root, &graph, &status));
+
+    assert(FABRIC_OK == Fabric_ClassStore_flush(cs));
+    assert(FABRIC_OK == Fabric_LabelStore_flush(&graph.label_store));
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph.vertex_store));
+    Fabric_close_graph(&graph);
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+
+    // the hierarchy is numbered again from the stored classes
+    Fabric_load_graph(db_file, &graph);
+    cs = &graph.class_store;
+    root = Fabric_ClassStore_get_class_by_name(cs, "Vertex", &status);
+    animal = Fabric_ClassStore_get_class_by_name(cs, "Animal", &status);
+    dog = Fabric_ClassStore_get_class_by_name(cs, "Dog", &status);
+    plant = Fabric_ClassStore_get_class_by_name(cs, "Plant", &status);
+    assert(FABRIC_OK == status);
+    assert(7 == Fabric_Class_get_total_count(root, &graph, &status));
+    assert(5 == Fabric_Class_get_total_count(animal, &graph, &status) && FABRIC_OK == status);
+    assert(Fabric_Class_is_subclass_of(dog, root, &graph, &status));
+    assert(!Fabric_Class_is_subclass_of(dog, plant, &graph, &status));
+    class_check_descendents(&graph, root, 5);
+    // a freed id is handed out again
+    fish = Fabric_ClassStore_create_class(cs, plant, "Fern", FALSE, &status);
+    assert(FABRIC_OK == status && 7 == Fabric_Class_get_id(fish));
+    assert(Fabric_Class_is_subclass_of(fish, plant, &graph, &status));
+    class_check_descendents(&graph, root, 6);
+    Fabric_close_graph(&graph);
+
+    fclose(db_file);
+    remove(file_name);
+}
+
+/**
+ * Tests listing more classes than the class store caches
+ */
+static
+void class_test_many_classes() {
+    FILE *db_file;
+    Graph graph;
+    ClassStore *cs;
+    DynamicList *list;
+    Class *root, *c;
+    classid_t root_id;
+    char name[24];
+    error_t status;
+    int i;
+
+    char *file_name = "test_class_many.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+    cs = &graph.class_store;
+
+    root = Fabric_ClassStore_create_class(cs, NULL, "Vertex", FALSE, &status);
+    assert(FABRIC_OK == status);
+    root_id = Fabric_Class_get_id(root);
+    for (i = 0; i < CLASS_TEST_MANY; i++) {
+        sprintf(name, "Class%d", i);
+        Fabric_ClassStore_create_class(cs, Fabric_ClassStore_get_class(cs, root_id, &status), name, FALSE, &status);
+        assert(FABRIC_OK == status);
+    }
+    assert(FABRIC_OK == Fabric_Graph_flush_stores(&graph));
+
+    // getting the listed classes evicts classes got earlier
+    root = Fabric_ClassStore_get_class(cs, root_id, &status);
+    list = Fabric_Class_get_descendent_classes(root, &graph, &status);
+    assert(FABRIC_OK == status && CLASS_TEST_MANY == Fabric_DynamicList_count(list));
+    for (i = 0; i < CLASS_TEST_MANY; i++) {
+        c = Fabric_ClassStore_get_listed_class(cs, list, i, &status);
+        assert(FABRIC_OK == status && root_id == Fabric_Class_get_parent_class_id(c));
+    }
+    c = Fabric_ClassStore_get_listed_class(cs, list, 0, &status);
+    assert(FABRIC_OK == status && root_id == Fabric_Class_get_parent_class_id(c));
+    Fabric_DynamicList_destroy(list);
+
+    // so are the child classes walked from the child lists
+    list = Fabric_Class_get_child_classes(Fabric_ClassStore_get_class(cs, root_id, &status), &graph, &status);
+    assert(FABRIC_OK == status && CLASS_TEST_MANY == Fabric_DynamicList_count(list));
+    for (i = 0; i < CLASS_TEST_MANY; i++) {
+        c = Fabric_ClassStore_get_listed_class(cs, list, i, &status);
+        assert(FABRIC_OK == status && root_id == Fabric_Class_get_parent_class_id(c));
+    }
+    Fabric_DynamicList_destroy(list);
+
+    Fabric_close_graph(&graph);
+    fclose(db_file);
+    remove(file_name);
+}
+
 void test_class() {
     Class cl;
     uint8_t data[29] = {
@@ -55,12 +259,16 @@ void test_class() {
     assert(Fabric_Class_increment(&cl) == 37);
     assert(Fabric_Class_increment(&cl) == 38);
 
+    class_test_hierarchy();
+    class_test_many_classes();
+
     printf ("All tests passed for class implementation.\n");
 
 }
 
 #ifndef _FABRIC_TEST_ALL__
 int main() {
+    Fabric_meminit();
     test_class();
     return 0;
 }
@@ -0,0 +1,229 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#include "TestHelpers.c"
+#endif
+
+#define COMPACTION_TEST_VERTICES 40
+#define COMPACTION_TEST_FREED 7
+#define COMPACTION_TEST_MAX_EDGES 8
+
+/* The old ids of each old vertex's out and in neighbors, newest first */
+static vertexid_t compaction_out[COMPACTION_TEST_VERTICES + 1][COMPACTION_TEST_MAX_EDGES];
+static vertexid_t compaction_in[COMPACTION_TEST_VERTICES + 1][COMPACTION_TEST_MAX_EDGES];
+static uint32_t compaction_out_count[COMPACTION_TEST_VERTICES + 1];
+static uint32_t compaction_in_count[COMPACTION_TEST_VERTICES + 1];
+
+static
+void compaction_add_edge(Graph *graph, vertexid_t from_id, vertexid_t to_id) {
+    test_connect(graph, 1, from_id, to_id);
+
+    // the lists run from the newest edge to the oldest
+    memmove(compaction_out[from_id] + 1, compaction_out[from_id], sizeof(vertexid_t) * compaction_out_count[from_id]);
+    compaction_out[from_id][0] = to_id;
+    compaction_out_count[from_id]++;
+    memmove(compaction_in[to_id] + 1, compaction_in[to_id], sizeof(vertexid_t) * compaction_in_count[to_id]);
+    compaction_in[to_id][0] = from_id;
+    compaction_in_count[to_id]++;
+}
+
+/**
+ * Checks that every vertex kept its class, neighbors and properties
+ * under its new id, and that its out edges are stored together
+ */
+static
+void compaction_check_graph(Graph *graph, Compaction *compaction) {
+    EdgeIterator iterator;
+    Vertex *v;
+    Edge *e;
+    Property *p;
+    error_t status;
+    vertexid_t old_id, new_id;
+    edgeid_t last_edge_id;
+    uint32_t i;
+
+    for (old_id = 1; old_id <= COMPACTION_TEST_VERTICES; old_id++) {
+        new_id = Fabric_Compaction_get_vertex_id(compaction, old_id);
+        if (COMPACTION_TEST_FREED == old_id) {
+            assert(0 == new_id);
+            continue;
+        }
+        assert(new_id > 0 && new_id < COMPACTION_TEST_VERTICES);
+        v = Fabric_VertexStore_get_vertex(&graph->vertex_store, new_id, &status);
+        assert(FABRIC_OK == status);
+        assert(1 + old_id % 2 == Fabric_Vertex_get_class_id(v));
+
+        i = 0;
+        last_edge_id = 0;
+        Fabric_EdgeIterator_init(&iterator, graph, v, FABRIC_DIRECTION_OUT);
+        while (NULL != (e = Fabric_EdgeIterator_next(&iterator, &status))) {
+            assert(i < compaction_out_count[old_id]);
+            assert(Fabric_Compaction_get_vertex_id(compaction, compaction_out[old_id][i]) ==
+                Fabric_Edge_get_to_vertex_id(e));
+            assert(new_id == Fabric_Edge_get_from_vertex_id(e));
+            assert(0 == last_edge_id || last_edge_id + 1 == Fabric_Edge_get_id(e));
+            last_edge_id = Fabric_Edge_get_id(e);
+            i++;
+        }
+        assert(FABRIC_OK == status && compaction_out_count[old_id] == i);
+
+        i = 0;
+        Fabric_EdgeIterator_init(&iterator, graph, v, FABRIC_DIRECTION_IN);
+        while (NULL != (e = Fabric_EdgeIterator_next(&iterator, &status))) {
+            assert(i < compaction_in_count[old_id]);
+            assert(Fabric_Compaction_get_vertex_id(compaction, compaction_in[old_id][i]) ==
+                Fabric_Edge_get_from_vertex_id(e));
+            i++;
+        }
+        assert(FABRIC_OK == status && compaction_in_count[old_id] == i);
+
+        p = Fabric_PropertyStore_get_vertex_property(&graph->property_store, v, 1, &status);
+        if (old_id % 5 == 0) {
+            assert(NULL == p);
+        } else {
+            assert(NULL != p && old_id * 10 + 1 == Fabric_Property_get_integer_value(p));
+        }
+        p = Fabric_PropertyStore_get_vertex_property(&graph->property_store, v, 2, &status);
+        assert(NULL != p && old_id * 10 + 2 == Fabric_Property_get_integer_value(p));
+    }
+}
+
+void test_compaction() {
+    FILE *db_file;
+    Graph graph;
+    Compaction compaction;
+    Class *classes[2];
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    Vertex *v;
+    error_t status;
+    vertexid_t i;
+    uint32_t num_edges, num_properties;
+    size_t mem_used_start;
+    int c;
+
+    char *file_name = "test_compaction.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    for (c = 0; c < 2; c++) {
+        classes[c] = Fabric_Class_new(c + 1, &status);
+        assert(FABRIC_OK == status);
+        memset(class_data, 0, sizeof(class_data));
+        Fabric_Class_init(classes[c], class_data);
+        Fabric_Class_set_label_id(classes[c], c + 1);
+        assert(FABRIC_OK == Fabric_ClassStore_update_class(&graph.class_store, classes[c]));
+    }
+
+    // the vertices are created with their properties interleaved, so the
+    // properties of a vertex start out apart
+    for (i = 1; i <= COMPACTION_TEST_VERTICES; i++) {
+        v = Fabric_VertexStore_create_vertex(&graph.vertex_store, classes[i % 2], &status);
+        assert(FABRIC_OK == status && i == Fabric_Vertex_get_id(v));
+        test_set_integer_property(&graph, v, 1, i * 10 + 1);
+    }
+    for (i = 1; i <= COMPACTION_TEST_VERTICES; i++) {
+        v = Fabric_VertexStore_get_vertex(&graph.vertex_store, i, &status);
+        assert(FABRIC_OK == status);
+        test_set_integer_property(&graph, v, 2, i * 10 + 2);
+        if (i % 5 == 0) {
+            assert(FABRIC_OK == Fabric_PropertyStore_remove_vertex_property(&graph.property_store, v, 1));
+        }
+    }
+
+    // a ring with chords, leaving out the vertex that is freed
+    num_edges = 0;
+    for (i = 1; i <= COMPACTION_TEST_VERTICES; i++) {
+        if (COMPACTION_TEST_FREED == i) {
+            continue;
+        }
+        compaction_add_edge(&graph, i, i % COMPACTION_TEST_VERTICES + 1 == COMPACTION_TEST_FREED ?
+            COMPACTION_TEST_FREED + 1 : i % COMPACTION_TEST_VERTICES + 1);
+        num_edges++;
+        if (i % 3 == 0 && (i * 7) % COMPACTION_TEST_VERTICES + 1 != COMPACTION_TEST_FREED) {
+            compaction_add_edge(&graph, i, (i * 7) % COMPACTION_TEST_VERTICES + 1);
+            num_edges++;
+        }
+    }
+
+    // a vertex store frees a vertex by clearing its class
+    v = Fabric_VertexStore_get_vertex(&graph.vertex_store, COMPACTION_TEST_FREED, &status);
+    assert(FABRIC_OK == status);
+    assert(FABRIC_OK == Fabric_PropertyStore_remove_vertex_property(&graph.property_store, v, 1));
+    assert(FABRIC_OK == Fabric_PropertyStore_remove_vertex_property(&graph.property_store, v, 2));
+    Fabric_Vertex_set_class_id(v, 0);
+    assert(FABRIC_OK == Fabric_VertexStore_update_vertex(&graph.vertex_store, v));
+    assert(FABRIC_OK == Fabric_FreeIdMap_add(&graph.vertex_store.free_ids, COMPACTION_TEST_FREED));
+    num_properties = 2 * (COMPACTION_TEST_VERTICES - 1) - (COMPACTION_TEST_VERTICES / 5);
+    assert(Fabric_FreeIdMap_get_count(&graph.property_store.free_ids) > 0);
+
+    // the search numbers the first vertex and then its neighbors
+    assert(FABRIC_OK == Fabric_Compaction_run(&compaction, &graph, FABRIC_COMPACT_BREADTH_FIRST));
+    assert(1 == Fabric_Compaction_get_vertex_id(&compaction, 1));
+    assert(2 == Fabric_Compaction_get_vertex_id(&compaction, 2));
+    assert(COMPACTION_TEST_VERTICES == graph.vertex_store.last_free_id);
+    assert(num_edges + 1 == graph.edge_store.last_free_id);
+    assert(num_properties + 1 == graph.property_store.last_free_id);
+    assert(0 == Fabric_FreeIdMap_get_count(&graph.vertex_store.free_ids));
+    assert(0 == Fabric_FreeIdMap_get_count(&graph.property_store.free_ids));
+    compaction_check_graph(&graph, &compaction);
+
+    // the compacted stores are what a reloaded graph reads
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+    assert(COMPACTION_TEST_VERTICES == graph.vertex_store.last_free_id);
+    assert(num_edges == graph.edge_store.num_edges);
+    assert(num_properties + 1 == graph.property_store.last_free_id);
+    compaction_check_graph(&graph, &compaction);
+    Fabric_Compaction_deinit(&compaction);
+
+    // grouping by class puts the vertices of the first class first, and
+    // a compacted graph keeps its ids
+    assert(FABRIC_OK == Fabric_Compaction_run(&compaction, &graph, FABRIC_COMPACT_BY_CLASS));
+    Fabric_Compaction_deinit(&compaction);
+    mem_used_start = Fabric_memused();
+    assert(FABRIC_OK == Fabric_Compaction_run(&compaction, &graph, FABRIC_COMPACT_BY_CLASS));
+    for (i = 1; i < COMPACTION_TEST_VERTICES; i++) {
+        assert(i == Fabric_Compaction_get_vertex_id(&compaction, i));
+    }
+    for (i = 1; i <= num_edges; i++) {
+        assert(i == Fabric_Compaction_get_edge_id(&compaction, i));
+    }
+    Fabric_Compaction_deinit(&compaction);
+    assert(mem_used_start == Fabric_memused());
+    for (i = 1; i < COMPACTION_TEST_VERTICES; i++) {
+        v = Fabric_VertexStore_get_vertex(&graph.vertex_store, i, &status);
+        assert(FABRIC_OK == status);
+        assert((i <= COMPACTION_TEST_VERTICES / 2 ? 1 : 2) == Fabric_Vertex_get_class_id(v));
+    }
+
+    // a graph with a property index is left alone
+    assert(NULL != Fabric_IndexStore_create_property_index(&graph.index_store, 1, 1, &status));
+    assert(FABRIC_COMPACTION_HAS_INDEXES == Fabric_Compaction_run(&compaction, &graph, FABRIC_COMPACT_BY_CLASS));
+    assert(0 == Fabric_Compaction_get_vertex_id(&compaction, 1));
+    Fabric_Compaction_deinit(&compaction);
+
+    Fabric_close_graph(&graph);
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for compaction.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_compaction();
+    return 0;
+}
+#endif
@@ -0,0 +1,248 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#include "TestHelpers.c"
+#endif
+
+#define DEGREE_TEST_VERTICES 20
+#define DEGREE_TEST_BULK_VERTICES 12000
+#define DEGREE_TEST_BULK_EDGES 1000
+
+static
+DegreeCounts *degree_test_get_counts(Graph *graph) {
+    error_t status;
+    DegreeCounts *counts = Fabric_EdgeStore_get_degree_counts(&graph->edge_store, &status);
+    assert(FABRIC_OK == status && NULL != counts);
+    return counts;
+}
+
+/**
+ * Checks that the counted degrees of the first vertices match walks of
+ * their edge lists
+ */
+static
+void degree_test_check_walks(Graph *graph, vertexid_t num_vertices) {
+    DegreeCounts *counts = degree_test_get_counts(graph);
+    EdgeIterator iterator;
+    error_t status;
+    vertexid_t i;
+    uint32_t count;
+    int direction;
+
+    for (i = 1; i <= num_vertices; i++) {
+        for (direction = FABRIC_DIRECTION_OUT; direction <= FABRIC_DIRECTION_IN; direction++) {
+            count = 0;
+            Fabric_EdgeIterator_init(&iterator, graph, test_get_vertex(graph, i), direction);
+            while (NULL != Fabric_EdgeIterator_next(&iterator, &status)) {
+                count++;
+            }
+            assert(FABRIC_OK == status);
+            assert(count == Fabric_DegreeCounts_get_degree(counts, i, direction));
+        }
+    }
+}
+
+static
+void degree_test_flush(FILE *db_file, Graph *graph) {
+    assert(FABRIC_OK == Fabric_ClassStore_flush(&graph->class_store));
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph->vertex_store));
+    assert(FABRIC_OK == Fabric_EdgeStore_flush(&graph->edge_store));
+    Fabric_close_graph(graph);
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+    Fabric_load_graph(db_file, graph);
+}
+
+void test_degree_counts() {
+    FILE *db_file;
+    Graph graph;
+    BulkLoad load;
+    Class *c;
+    DegreeCounts *counts;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    uint32_t buckets[FABRIC_DEGREE_BUCKETS];
+    classid_t class_ids[DEGREE_TEST_BULK_VERTICES];
+    labelid_t label_ids[DEGREE_TEST_BULK_EDGES];
+    vertexid_t from_ids[DEGREE_TEST_BULK_EDGES], to_ids[DEGREE_TEST_BULK_EDGES];
+    vertexid_t supernodes[4], first_id;
+    uint32_t i, degrees[2], page_offset;
+    uint8_t type;
+    error_t status;
+#ifndef FABRIC_NO_STATS
+    uint64_t before[FABRIC_STAT_NUM_COUNTERS], after[FABRIC_STAT_NUM_COUNTERS];
+#endif
+
+    char *file_name = "test_degree_counts.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    // vertices 1 to 10 are in class 1 and the rest in class 2
+    memset(class_data, 0, sizeof(class_data));
+    for (i = 1; i <= 2; i++) {
+        c = Fabric_Class_new(i, &status);
+        assert(FABRIC_OK == status);
+        Fabric_Class_init(c, class_data);
+        Fabric_Class_set_label_id(c, i);
+        Fabric_ClassStore_update_class(&graph.class_store, c);
+    }
+    for (i = 1; i <= DEGREE_TEST_VERTICES; i++) {
+        c = Fabric_ClassStore_get_class(&graph.class_store, i <= 10 ? 1 : 2, &status);
+        assert(FABRIC_OK == status);
+        Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+        assert(FABRIC_OK == status);
+    }
+
+    // a new graph counts nothing
+    counts = degree_test_get_counts(&graph);
+    assert(0 == Fabric_DegreeCounts_get_edge_count(counts));
+    assert(0 == Fabric_DegreeCounts_get_degree(counts, 1, FABRIC_DIRECTION_OUT));
+    assert(0 == Fabric_DegreeCounts_get_label_count(counts, 1));
+
+    // the hub points at every other vertex, and class 2 points back
+    for (i = 2; i <= DEGREE_TEST_VERTICES; i++) {
+        test_connect(&graph, 1 + i % 2, 1, i);
+    }
+    for (i = 11; i <= DEGREE_TEST_VERTICES; i++) {
+        test_connect(&graph, 3, i, 1);
+    }
+    test_connect(&graph, 1, 2, 3);
+    assert(30 == Fabric_DegreeCounts_get_edge_count(counts));
+    assert(19 == Fabric_DegreeCounts_get_degree(counts, 1, FABRIC_DIRECTION_OUT));
+    assert(10 == Fabric_DegreeCounts_get_degree(counts, 1, FABRIC_DIRECTION_IN));
+    assert(2 == Fabric_DegreeCounts_get_degree(counts, 3, FABRIC_DIRECTION_IN));
+    assert(0 == Fabric_DegreeCounts_get_degree(counts, 5, FABRIC_DIRECTION_OUT));
+    assert(0 == Fabric_DegreeCounts_get_degree(counts, 1000, FABRIC_DIRECTION_OUT));
+    assert(11 == Fabric_DegreeCounts_get_label_count(counts, 1));
+    assert(9 == Fabric_DegreeCounts_get_label_count(counts, 2));
+    assert(10 == Fabric_DegreeCounts_get_label_count(counts, 3));
+    assert(0 == Fabric_DegreeCounts_get_label_count(counts, 4));
+    degree_test_check_walks(&graph, DEGREE_TEST_VERTICES);
+
+    // the histograms bucket degrees by their highest bit
+    Fabric_DegreeCounts_get_histogram(counts, 1, FABRIC_DIRECTION_OUT, buckets);
+    assert(1 == buckets[0] && 1 == buckets[4]);
+    Fabric_DegreeCounts_get_histogram(counts, 1, FABRIC_DIRECTION_IN, buckets);
+    assert(8 == buckets[0] && 1 == buckets[1] && 0 == buckets[2] && 1 == buckets[3]);
+    Fabric_DegreeCounts_get_histogram(counts, 2, FABRIC_DIRECTION_OUT, buckets);
+    assert(10 == buckets[0] && 0 == buckets[1]);
+    Fabric_DegreeCounts_get_histogram(counts, 9, FABRIC_DIRECTION_OUT, buckets);
+    for (i = 0; i < FABRIC_DEGREE_BUCKETS; i++) {
+        assert(0 == buckets[i]);
+    }
+
+    // a vertex with enough edges is a supernode
+    assert(!Fabric_DegreeCounts_is_supernode(counts, 1));
+    for (i = 19; i < FABRIC_SUPERNODE_DEGREE; i++) {
+        test_connect(&graph, 4, 1, 2 + i % (DEGREE_TEST_VERTICES - 1));
+    }
+    assert(FABRIC_SUPERNODE_DEGREE == Fabric_DegreeCounts_get_degree(counts, 1, FABRIC_DIRECTION_OUT));
+    assert(Fabric_DegreeCounts_is_supernode(counts, 1));
+    assert(!Fabric_DegreeCounts_is_supernode(counts, 2));
+    assert(1 == Fabric_DegreeCounts_find_supernodes(counts, FABRIC_SUPERNODE_DEGREE, supernodes, 4));
+    assert(1 == supernodes[0]);
+    assert(DEGREE_TEST_VERTICES == Fabric_DegreeCounts_find_supernodes(counts, 1, supernodes, 4));
+    assert(4 == supernodes[3]);
+    Fabric_DegreeCounts_get_histogram(counts, 1, FABRIC_DIRECTION_OUT, buckets);
+    assert(1 == buckets[12] && 0 == buckets[4]);
+
+    // the counts survive reopening the graph
+    degree_test_flush(db_file, &graph);
+    counts = degree_test_get_counts(&graph);
+    assert(FABRIC_SUPERNODE_DEGREE + 11 == Fabric_DegreeCounts_get_edge_count(counts));
+    assert(Fabric_DegreeCounts_is_supernode(counts, 1));
+    assert(FABRIC_SUPERNODE_DEGREE - 19 == Fabric_DegreeCounts_get_label_count(counts, 4));
+    Fabric_DegreeCounts_get_histogram(counts, 1, FABRIC_DIRECTION_IN, buckets);
+    assert(1 == buckets[3]);
+    degree_test_check_walks(&graph, DEGREE_TEST_VERTICES);
+
+    // a bulk load updates loaded counts, which then span several pages
+    assert(FABRIC_OK == Fabric_BulkLoad_begin(&load, &graph));
+    for (i = 0; i < DEGREE_TEST_BULK_VERTICES; i++) {
+        class_ids[i] = 1 + i % 2;
+    }
+    assert(FABRIC_OK == Fabric_BulkLoad_add_vertices(&load, class_ids, DEGREE_TEST_BULK_VERTICES, &first_id));
+    for (i = 0; i < DEGREE_TEST_BULK_EDGES; i++) {
+        label_ids[i] = 5 + i % 3;
+        from_ids[i] = first_id + (i * 7919) % DEGREE_TEST_BULK_VERTICES;
+        to_ids[i] = first_id + DEGREE_TEST_BULK_VERTICES - 1 - i % 10;
+    }
+    assert(FABRIC_OK == Fabric_BulkLoad_add_edges(&load, label_ids, from_ids, to_ids, DEGREE_TEST_BULK_EDGES, NULL));
+    assert(FABRIC_OK == Fabric_BulkLoad_finish(&load));
+    first_id += DEGREE_TEST_BULK_VERTICES - 1;
+    assert(DEGREE_TEST_BULK_EDGES / 10 == Fabric_DegreeCounts_get_degree(counts, first_id, FABRIC_DIRECTION_IN));
+    assert(334 == Fabric_DegreeCounts_get_label_count(counts, 5));
+    degree_test_flush(db_file, &graph);
+    counts = degree_test_get_counts(&graph);
+    assert(counts->num_pages > 1);
+    assert(DEGREE_TEST_BULK_EDGES / 10 == Fabric_DegreeCounts_get_degree(counts, first_id, FABRIC_DIRECTION_IN));
+    degree_test_check_walks(&graph, DEGREE_TEST_VERTICES);
+    degrees[0] = Fabric_DegreeCounts_get_degree(counts, 2, FABRIC_DIRECTION_OUT);
+    degrees[1] = Fabric_DegreeCounts_get_degree(counts, 3, FABRIC_DIRECTION_IN);
+
+    // only the changed page is written
+    test_connect(&graph, 1, 2, 3);
+#ifndef FABRIC_NO_STATS
+    Fabric_stats_read(before);
+#endif
+    assert(FABRIC_OK == Fabric_DegreeCounts_flush(counts));
+#ifndef FABRIC_NO_STATS
+    Fabric_stats_read(after);
+    assert(1 == after[FABRIC_STAT_RECORDS_WRITTEN + FABRIC_STATS_INDEX_STORE] -
+        before[FABRIC_STAT_RECORDS_WRITTEN + FABRIC_STATS_INDEX_STORE]);
+#endif
+
+    // dropped counts are rebuilt from the edges into the same pages
+    degree_test_flush(db_file, &graph);
+    assert(FABRIC_OK == Fabric_DegreeCounts_drop(&graph));
+    i = graph.index_store.page_count;
+    counts = degree_test_get_counts(&graph);
+    assert(degrees[0] + 1 == Fabric_DegreeCounts_get_degree(counts, 2, FABRIC_DIRECTION_OUT));
+    assert(degrees[1] + 1 == Fabric_DegreeCounts_get_degree(counts, 3, FABRIC_DIRECTION_IN));
+    assert(DEGREE_TEST_BULK_EDGES / 10 == Fabric_DegreeCounts_get_degree(counts, first_id, FABRIC_DIRECTION_IN));
+    assert(FABRIC_SUPERNODE_DEGREE - 19 == Fabric_DegreeCounts_get_label_count(counts, 4));
+    Fabric_DegreeCounts_get_histogram(counts, 1, FABRIC_DIRECTION_OUT, buckets);
+    assert(1 == buckets[12]);
+    degree_test_check_walks(&graph, DEGREE_TEST_VERTICES);
+    degree_test_flush(db_file, &graph);
+    assert(i == graph.index_store.page_count);
+
+    // an older graph whose root page belongs to another index keeps its
+    // counts in memory
+    page_offset = Fabric_IndexStore_get_page_offset(&graph.index_store, 6);
+    type = 0x05;
+    assert(FABRIC_OK == Fabric_Graph_write_bytes(&graph, &type, sizeof(type), page_offset));
+    assert(FABRIC_OK == Fabric_DegreeCounts_drop(&graph));
+    counts = degree_test_get_counts(&graph);
+    assert(Fabric_DegreeCounts_is_supernode(counts, 1));
+    test_connect(&graph, 1, 2, 3);
+    degree_test_flush(db_file, &graph);
+    assert(FABRIC_OK == Fabric_Graph_read_bytes(&graph, &type, sizeof(type), page_offset));
+    assert(0x05 == type);
+    counts = degree_test_get_counts(&graph);
+    assert(degrees[0] + 2 == Fabric_DegreeCounts_get_degree(counts, 2, FABRIC_DIRECTION_OUT));
+
+    Fabric_close_graph(&graph);
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for degree counts.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_degree_counts();
+    return 0;
+}
+#endif
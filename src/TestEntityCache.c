@@ -0,0 +1,167 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+static int ecache_destroyed;
+
+static
+void ecache_destroy_dummy(void *dummy) {
+    Fabric_memfree(dummy, sizeof(uint32_t));
+    ecache_destroyed++;
+}
+
+static
+uint32_t *ecache_new_dummy(uint32_t value) {
+    uint32_t *dummy = Fabric_memalloc(sizeof(uint32_t));
+    assert(dummy != NULL);
+    *dummy = value;
+    return dummy;
+}
+
+void test_entity_cache_policy(int policy) {
+    error_t status;
+    uint32_t id;
+    uint32_t *dummy;
+    size_t mem_used_start = Fabric_memused();
+    IdSet *pinned = Fabric_IdSet_new(&status);
+    assert(FABRIC_OK == status);
+
+    EntityCache *cache = Fabric_EntityCache_new(8, policy, pinned, ecache_destroy_dummy, &status);
+    assert(FABRIC_OK == status);
+    ecache_destroyed = 0;
+
+    for (id = 1; id <= 8; id++) {
+        assert(FABRIC_OK == Fabric_EntityCache_set(cache, id, ecache_new_dummy(id)));
+    }
+    assert(8 == Fabric_EntityCache_get_count(cache));
+    assert(0 == ecache_destroyed);
+
+    // pinned ids and recently used ids survive eviction
+    assert(FABRIC_OK == Fabric_IdSet_add(pinned, 1));
+    dummy = Fabric_EntityCache_get(cache, 2);
+    assert(dummy != NULL && *dummy == 2);
+    for (id = 9; id <= 12; id++) {
+        assert(FABRIC_OK == Fabric_EntityCache_set(cache, id, ecache_new_dummy(id)));
+        assert(8 == Fabric_EntityCache_get_count(cache));
+    }
+    assert(4 == ecache_destroyed);
+    assert(4 == Fabric_EntityCache_get_evictions(cache));
+    assert(Fabric_EntityCache_has_key(cache, 1));
+    assert(Fabric_EntityCache_has_key(cache, 2));
+    for (id = 9; id <= 12; id++) {
+        assert(Fabric_EntityCache_has_key(cache, id));
+    }
+
+    // a cache whose entities are all pinned grows instead of evicting
+    for (id = 1; id <= 12; id++) {
+        if (Fabric_EntityCache_has_key(cache, id)) {
+            assert(FABRIC_OK == Fabric_IdSet_add(pinned, id));
+        }
+    }
+    assert(FABRIC_OK == Fabric_EntityCache_set(cache, 13, ecache_new_dummy(13)));
+    assert(9 == Fabric_EntityCache_get_count(cache));
+    assert(4 == ecache_destroyed);
+
+    // unset hands the entity back without destroying it
+    dummy = Fabric_EntityCache_get(cache, 13);
+    Fabric_EntityCache_unset(cache, 13);
+    assert(!Fabric_EntityCache_has_key(cache, 13));
+    assert(4 == ecache_destroyed);
+    ecache_destroy_dummy(dummy);
+
+    // hits and misses are counted by get
+    assert(NULL == Fabric_EntityCache_get(cache, 100));
+    assert(2 == Fabric_EntityCache_get_hits(cache));
+    assert(1 == Fabric_EntityCache_get_misses(cache));
+    assert(Fabric_EntityCache_get_hit_ratio(cache) > 0.66 && Fabric_EntityCache_get_hit_ratio(cache) < 0.67);
+    assert(Fabric_EntityCache_get_recent_hit_ratio(cache) > 0.66);
+    assert(0 == Fabric_EntityCache_get_recent_hit_ratio(cache));
+    assert(NULL == Fabric_EntityCache_get(cache, 100));
+    assert(0 == Fabric_EntityCache_get_recent_hit_ratio(cache));
+
+    // replacing an entity destroys it, while setting it again doesn't
+    dummy = Fabric_EntityCache_get(cache, 12);
+    assert(FABRIC_OK == Fabric_EntityCache_set(cache, 12, dummy));
+    assert(5 == ecache_destroyed);
+    assert(FABRIC_OK == Fabric_EntityCache_set(cache, 12, ecache_new_dummy(112)));
+    assert(6 == ecache_destroyed);
+    dummy = Fabric_EntityCache_get(cache, 12);
+    assert(dummy != NULL && *dummy == 112);
+
+    Fabric_EntityCache_destroy(cache);
+    Fabric_IdSet_destroy(pinned);
+    assert(mem_used_start == Fabric_memused());
+}
+
+/**
+ * Tests holding fewer entities than a cache's capacity
+ */
+static
+void test_entity_cache_limit() {
+    error_t status;
+    uint32_t id;
+    size_t mem_used_start = Fabric_memused();
+    IdSet *pinned = Fabric_IdSet_new(&status);
+    assert(FABRIC_OK == status);
+
+    EntityCache *cache = Fabric_EntityCache_new(8, FABRIC_CACHE_POLICY, pinned, ecache_destroy_dummy, &status);
+    assert(FABRIC_OK == status);
+    ecache_destroyed = 0;
+    for (id = 1; id <= 8; id++) {
+        assert(FABRIC_OK == Fabric_EntityCache_set(cache, id, ecache_new_dummy(id)));
+    }
+
+    // the limit is kept within the capacity
+    Fabric_EntityCache_set_limit(cache, 100);
+    assert(8 == Fabric_EntityCache_get_limit(cache));
+    Fabric_EntityCache_set_limit(cache, 0);
+    assert(1 == Fabric_EntityCache_get_limit(cache));
+
+    // lowering the limit evicts nothing until an entity is added
+    Fabric_EntityCache_set_limit(cache, 4);
+    assert(8 == Fabric_EntityCache_get_count(cache));
+    assert(FABRIC_OK == Fabric_EntityCache_set(cache, 9, ecache_new_dummy(9)));
+    assert(7 == Fabric_EntityCache_get_count(cache));
+    assert(2 == ecache_destroyed);
+
+    // trimming evicts down to the limit, except for pinned entities
+    assert(FABRIC_OK == Fabric_IdSet_add(pinned, 9));
+    Fabric_EntityCache_set_limit(cache, 1);
+    Fabric_EntityCache_trim(cache);
+    assert(1 == Fabric_EntityCache_get_count(cache));
+    assert(Fabric_EntityCache_has_key(cache, 9));
+    assert(FABRIC_OK == Fabric_EntityCache_set(cache, 10, ecache_new_dummy(10)));
+    assert(2 == Fabric_EntityCache_get_count(cache));
+    assert(8 == ecache_destroyed);
+
+    Fabric_EntityCache_destroy(cache);
+    Fabric_IdSet_destroy(pinned);
+    assert(mem_used_start == Fabric_memused());
+}
+
+void test_entity_cache() {
+#ifndef _FABRIC_TEST_ALL__
+    Fabric_meminit();
+#endif
+    test_entity_cache_policy(FABRIC_CACHE_POLICY_CLOCK);
+    test_entity_cache_policy(FABRIC_CACHE_POLICY_LRU);
+    test_entity_cache_limit();
+    printf("All tests passed for entity cache.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    test_entity_cache();
+    return 0;
+}
+#endif
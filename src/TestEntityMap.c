@@ -104,6 +104,20 @@ void test_entity_map() {
         assert(((EMapDummy*)Fabric_EntityMap_get(map, dummy->id))->value == dummy->id + 1);
     }
 
+    // unsetting every other key must leave the rest reachable
+    for (i = 0; i < 50; i += 2) {
+        Fabric_EntityMap_unset(map, changed_dummies[i]->id);
+    }
+    for (i = 0; i < 50; i++) {
+        dummy = changed_dummies[i];
+        if (i % 2 == 0) {
+            assert(NULL == Fabric_EntityMap_get(map, dummy->id));
+        } else {
+            assert(dummy == Fabric_EntityMap_get(map, dummy->id));
+        }
+    }
+    assert(Fabric_EntityMap_get_count(map) == 25);
+
     Fabric_EntityMap_destroy(map);
     assert(mem_used_start == Fabric_memused());
 
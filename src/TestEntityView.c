@@ -0,0 +1,159 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+/**
+ * Returns the number of pins held on a graph's buffer pool pages
+ */
+static
+uint32_t view_count_pins(Graph *graph) {
+    uint32_t pins = 0;
+    int i;
+    for (i = 0; i < graph->buffer_pool.num_frames; i++) {
+        pins += graph->buffer_pool.frames[i].pin_count;
+    }
+    return pins;
+}
+
+/**
+ * Checks the views of every edge in a graph against the edges themselves
+ */
+static
+void view_check_edges(Graph *graph, edgeid_t num_edges) {
+    EntityView view;
+    Edge edge;
+    edgeid_t id;
+
+    Fabric_EntityView_init(&view);
+    for (id = 1; id <= num_edges; id++) {
+        assert(FABRIC_OK == Fabric_EdgeStore_read_edge(&graph->edge_store, id, &edge));
+        assert(FABRIC_OK == Fabric_EdgeStore_view_edge(&graph->edge_store, id, &view));
+        assert(Fabric_EdgeView_is_in_use(&view));
+        assert(Fabric_Edge_get_label_id(&edge) == Fabric_EdgeView_get_label_id(&view));
+        assert(Fabric_Edge_get_from_vertex_id(&edge) == Fabric_EdgeView_get_from_vertex_id(&view));
+        assert(Fabric_Edge_get_to_vertex_id(&edge) == Fabric_EdgeView_get_to_vertex_id(&view));
+        assert(Fabric_Edge_get_next_out_edge_id(&edge) == Fabric_EdgeView_get_next_out_edge_id(&view));
+        assert(Fabric_Edge_get_next_in_edge_id(&edge) == Fabric_EdgeView_get_next_in_edge_id(&view));
+        assert(Fabric_Edge_get_first_property_id(&edge) == Fabric_EdgeView_get_first_property_id(&view));
+        Fabric_EntityView_release(&view);
+    }
+}
+
+void test_entity_view() {
+    FILE *db_file;
+    Graph graph;
+    Class *c;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    Vertex *v, *previous;
+    EntityView view;
+    error_t status;
+    vertexid_t i;
+    edgeid_t straddling = 0;
+    uint32_t offset;
+
+    char *file_name = "test_view.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    c = Fabric_Class_new(1, &status);
+    assert(FABRIC_OK == status);
+    memset(class_data, 0, sizeof(class_data));
+    Fabric_Class_init(c, class_data);
+    Fabric_Class_set_label_id(c, 7);
+    Fabric_ClassStore_update_class(&graph.class_store, c);
+
+    previous = NULL;
+    for (i = 1; i <= 300; i++) {
+        v = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+        assert(FABRIC_OK == status);
+        if (NULL != previous) {
+            Fabric_EdgeStore_create_edge(&graph.edge_store, 1 + i % 3, previous, v, &status);
+            assert(FABRIC_OK == status);
+        }
+        previous = v;
+    }
+
+    // cached entities are viewed through a copy
+    Fabric_EntityView_init(&view);
+    assert(FABRIC_OK == Fabric_VertexStore_view_vertex(&graph.vertex_store, 2, &view));
+    assert(1 == Fabric_VertexView_get_class_id(&view));
+    assert(1 == Fabric_VertexView_get_first_in_edge_id(&view));
+    assert(2 == Fabric_VertexView_get_first_out_edge_id(&view));
+    Fabric_EntityView_release(&view);
+    view_check_edges(&graph, 299);
+    assert(0 == view_count_pins(&graph));
+
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph.vertex_store));
+    assert(FABRIC_OK == Fabric_EdgeStore_flush(&graph.edge_store));
+    assert(FABRIC_OK == Fabric_ClassStore_flush(&graph.class_store));
+    Fabric_close_graph(&graph);
+
+    // records are viewed in place in the buffer pool, or copied when
+    // they span two pages
+    Fabric_load_graph(db_file, &graph);
+    for (i = 1; i <= 299 && 0 == straddling; i++) {
+        offset = Fabric_ExtentList_get_record_offset(&graph.edge_store.extents, i);
+        if (offset / FABRIC_PAGE_SIZE != (offset + FABRIC_EDGE_STORAGE_SIZE - 1) / FABRIC_PAGE_SIZE) {
+            straddling = i;
+        }
+    }
+    assert(0 != straddling);
+    assert(FABRIC_OK == Fabric_EdgeStore_view_edge(&graph.edge_store, straddling, &view));
+    assert(view.data == view.copy);
+    assert(0 == view_count_pins(&graph));
+    assert(FABRIC_OK == Fabric_EdgeStore_view_edge(&graph.edge_store, 1, &view));
+    assert(view.data != view.copy);
+    assert(1 == view_count_pins(&graph));
+    Fabric_EntityView_release(&view);
+    assert(0 == view_count_pins(&graph));
+    view_check_edges(&graph, 299);
+    assert(0 == view_count_pins(&graph));
+
+    assert(FABRIC_OK == Fabric_ClassStore_view_class(&graph.class_store, 1, &view));
+    assert(7 == Fabric_ClassView_get_label_id(&view));
+    assert(300 == Fabric_ClassView_get_count(&view));
+    assert(!Fabric_ClassView_is_abstract(&view));
+    Fabric_EntityView_release(&view);
+
+    // missing entities can't be viewed and leave nothing pinned
+    assert(FABRIC_VERTEX_DOESNT_EXIST == Fabric_VertexStore_view_vertex(&graph.vertex_store, 301, &view));
+    assert(FABRIC_EDGESTORE_INVALID_ID == Fabric_EdgeStore_view_edge(&graph.edge_store, 0, &view));
+    assert(NULL == Fabric_EntityView_get_data(&view));
+    assert(0 == view_count_pins(&graph));
+    Fabric_close_graph(&graph);
+
+#ifndef FABRIC_NO_MMAP
+    // a mapped graph is viewed straight from its mapping
+    assert(FABRIC_OK == Fabric_map_graph(db_file, &graph));
+    assert(FABRIC_OK == Fabric_EdgeStore_view_edge(&graph.edge_store, straddling, &view));
+    assert(view.data != view.copy);
+    Fabric_EntityView_release(&view);
+    view_check_edges(&graph, 299);
+    Fabric_close_graph(&graph);
+#endif
+
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for entity views.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_entity_view();
+    return 0;
+}
+#endif
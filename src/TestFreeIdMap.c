@@ -0,0 +1,249 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+#define FREE_ID_TEST_IDS 10000
+#define FREE_ID_TEST_VERTICES 5
+#define FREE_ID_TEST_BATCH 100
+
+/**
+ * Checks adding, taking and removing ids in memory
+ */
+static
+void free_id_test_map() {
+    FreeIdMap map;
+    uint32_t id;
+
+    Fabric_FreeIdMap_init(&map);
+    assert(0 == Fabric_FreeIdMap_take(&map));
+    assert(!Fabric_FreeIdMap_has(&map, 1));
+    assert(!Fabric_FreeIdMap_is_changed(&map));
+
+    // ids are taken lowest first, whatever order they were freed in
+    assert(FABRIC_OK == Fabric_FreeIdMap_add(&map, 9));
+    assert(FABRIC_OK == Fabric_FreeIdMap_add(&map, 3));
+    assert(FABRIC_OK == Fabric_FreeIdMap_add(&map, 3));
+    assert(FABRIC_OK == Fabric_FreeIdMap_add(&map, 70000));
+    assert(3 == Fabric_FreeIdMap_get_count(&map));
+    assert(Fabric_FreeIdMap_is_changed(&map));
+    assert(Fabric_FreeIdMap_has(&map, 70000));
+    assert(3 == Fabric_FreeIdMap_take(&map));
+    assert(FABRIC_OK == Fabric_FreeIdMap_add(&map, 2));
+    assert(2 == Fabric_FreeIdMap_take(&map));
+    assert(9 == Fabric_FreeIdMap_take(&map));
+    assert(Fabric_FreeIdMap_remove(&map, 70000));
+    assert(!Fabric_FreeIdMap_remove(&map, 70000));
+    assert(0 == Fabric_FreeIdMap_take(&map));
+
+    // a run is only taken where enough consecutive ids are free
+    for (id = 1; id < FREE_ID_TEST_IDS; id += 2) {
+        assert(FABRIC_OK == Fabric_FreeIdMap_add(&map, id));
+    }
+    for (id = 12000; id < 12200; id++) {
+        assert(FABRIC_OK == Fabric_FreeIdMap_add(&map, id));
+    }
+    assert(0 == Fabric_FreeIdMap_take_run(&map, 201));
+    assert(12000 == Fabric_FreeIdMap_take_run(&map, 150));
+    assert(!Fabric_FreeIdMap_has(&map, 12149));
+    assert(Fabric_FreeIdMap_has(&map, 12150));
+    assert(12150 == Fabric_FreeIdMap_take_run(&map, 50));
+    assert(1 == Fabric_FreeIdMap_take_run(&map, 1));
+    assert(FREE_ID_TEST_IDS / 2 - 1 == Fabric_FreeIdMap_get_count(&map));
+    for (id = 3; id < FREE_ID_TEST_IDS; id += 2) {
+        assert(id == Fabric_FreeIdMap_take(&map));
+    }
+    assert(0 == Fabric_FreeIdMap_get_count(&map));
+
+    Fabric_FreeIdMap_deinit(&map);
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+}
+
+/**
+ * Checks that a map saved to a graph loads with the same ids
+ */
+static
+void free_id_test_save(Graph *graph) {
+    FreeIdMap map, loaded;
+    uint32_t id;
+
+    // the edge store has no edges, so its map is free for the test
+    Fabric_FreeIdMap_init(&map);
+    Fabric_FreeIdMap_init(&loaded);
+    assert(FABRIC_FREEIDMAP_MISSING == Fabric_FreeIdMap_load(&loaded, graph, FABRIC_EDGE_STORE, 100000));
+    for (id = 100; id < 5000; id += 3) {
+        assert(FABRIC_OK == Fabric_FreeIdMap_add(&map, id));
+    }
+    assert(FABRIC_OK == Fabric_FreeIdMap_add(&map, 5001));
+    assert(FABRIC_OK == Fabric_FreeIdMap_add(&map, 5002));
+    assert(FABRIC_OK == Fabric_FreeIdMap_save(&map, graph, FABRIC_EDGE_STORE));
+    assert(!Fabric_FreeIdMap_is_changed(&map));
+    assert(0 != Fabric_Graph_get_free_id_directory_offset(graph));
+
+    assert(FABRIC_OK == Fabric_FreeIdMap_load(&loaded, graph, FABRIC_EDGE_STORE, 100000));
+    assert(Fabric_FreeIdMap_get_count(&map) == Fabric_FreeIdMap_get_count(&loaded));
+    assert(!Fabric_FreeIdMap_is_changed(&loaded));
+    for (id = 1; id < 5010; id++) {
+        assert(Fabric_FreeIdMap_has(&map, id) == Fabric_FreeIdMap_has(&loaded, id));
+    }
+    Fabric_FreeIdMap_deinit(&loaded);
+
+    // ids at or past the store's last free id are left out
+    Fabric_FreeIdMap_init(&loaded);
+    assert(FABRIC_OK == Fabric_FreeIdMap_load(&loaded, graph, FABRIC_EDGE_STORE, 5002));
+    assert(Fabric_FreeIdMap_has(&loaded, 5001));
+    assert(!Fabric_FreeIdMap_has(&loaded, 5002));
+    Fabric_FreeIdMap_deinit(&loaded);
+
+    // an empty map replaces the runs in place
+    while (0 != Fabric_FreeIdMap_take(&map));
+    assert(FABRIC_OK == Fabric_FreeIdMap_save(&map, graph, FABRIC_EDGE_STORE));
+    Fabric_FreeIdMap_init(&loaded);
+    assert(FABRIC_OK == Fabric_FreeIdMap_load(&loaded, graph, FABRIC_EDGE_STORE, 100000));
+    assert(0 == Fabric_FreeIdMap_get_count(&loaded));
+    Fabric_FreeIdMap_deinit(&loaded);
+    Fabric_FreeIdMap_deinit(&map);
+}
+
+/**
+ * Sets a vertex's property to an integer
+ */
+static
+void free_id_test_set(Graph *graph, Vertex *v, labelid_t label_id) {
+    uint8_t data[FABRIC_PROPERTY_STORAGE_SIZE];
+    error_t status;
+    Property *p = Fabric_Property_new(0, &status);
+
+    assert(FABRIC_OK == status);
+    memset(data, 0, sizeof(data));
+    Fabric_Property_init(p, data);
+    Fabric_Property_set_type(p, FABRIC_PROPTYPE_INTEGER);
+    Fabric_Property_set_integer_value(p, label_id);
+    assert(FABRIC_OK == Fabric_PropertyStore_set_vertex_property(&graph->property_store, v, label_id, p));
+    Fabric_Property_destroy(p);
+}
+
+/**
+ * Flushes the stores the tests change and reloads the graph
+ */
+static
+void free_id_test_reload(FILE *db_file, Graph *graph) {
+    assert(FABRIC_OK == Fabric_ClassStore_flush(&graph->class_store));
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph->vertex_store));
+    assert(FABRIC_OK == Fabric_PropertyStore_flush(&graph->property_store));
+    Fabric_close_graph(graph);
+    Fabric_load_graph(db_file, graph);
+}
+
+/**
+ * Checks that the stores reuse their freed ids across reloads, including
+ * ids freed in a graph saved with the older free lists
+ */
+static
+void free_id_test_stores(FILE *db_file, Graph *graph) {
+    VertexStore *vs = &graph->vertex_store;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    Class *c;
+    Vertex *v;
+    error_t status;
+    vertexid_t first_id;
+
+    c = Fabric_Class_new(1, &status);
+    assert(FABRIC_OK == status);
+    memset(class_data, 0, sizeof(class_data));
+    Fabric_Class_init(c, class_data);
+    Fabric_Class_set_label_id(c, 1);
+    assert(FABRIC_OK == Fabric_ClassStore_update_class(&graph->class_store, c));
+    first_id = Fabric_VertexStore_create_vertices(vs, c, FREE_ID_TEST_VERTICES, &status);
+    assert(FABRIC_OK == status && 1 == first_id);
+    assert(FREE_ID_TEST_VERTICES == Fabric_Class_get_count(c));
+    assert(FREE_ID_TEST_VERTICES + 1 == vs->last_free_id);
+
+    // a removed property's id is given to the next property
+    v = Fabric_VertexStore_get_vertex(vs, 1, &status);
+    free_id_test_set(graph, v, 1);
+    free_id_test_set(graph, v, 2);
+    free_id_test_set(graph, v, 3);
+    assert(FABRIC_OK == Fabric_PropertyStore_remove_vertex_property(&graph->property_store, v, 1));
+    assert(Fabric_FreeIdMap_has(&graph->property_store.free_ids, 1));
+    free_id_test_reload(db_file, graph);
+    assert(Fabric_FreeIdMap_has(&graph->property_store.free_ids, 1));
+    v = Fabric_VertexStore_get_vertex(vs, 1, &status);
+    assert(FABRIC_OK == status);
+    free_id_test_set(graph, v, 4);
+    assert(1 == Fabric_Vertex_get_first_property_id(v));
+    assert(4 == graph->property_store.last_free_id);
+    free_id_test_reload(db_file, graph);
+
+    // an older graph lists ids 2 and 4 through the first out edge field
+    assert(0 == Fabric_FreeIdMap_get_count(&vs->free_ids));
+    Fabric_Graph_update_uint32(graph, 2, vs->offset + 4);
+    Fabric_Graph_update_uint32(graph, 4,
+        Fabric_ExtentList_get_record_offset(&vs->extents, 2) + sizeof(classid_t));
+    Fabric_Graph_update_uint32(graph, FREE_ID_TEST_VERTICES + 1,
+        Fabric_ExtentList_get_record_offset(&vs->extents, 4) + sizeof(classid_t));
+    Fabric_close_graph(graph);
+    Fabric_load_graph(db_file, graph);
+    assert(2 == Fabric_FreeIdMap_get_count(&vs->free_ids));
+    assert(Fabric_FreeIdMap_has(&vs->free_ids, 2));
+    assert(Fabric_FreeIdMap_has(&vs->free_ids, 4));
+
+    // the list is replaced by the map when the store is flushed
+    assert(FABRIC_OK == Fabric_VertexStore_flush(vs));
+    assert(FREE_ID_TEST_VERTICES + 1 == Fabric_Graph_read_uint32(graph, vs->offset + 4));
+    Fabric_close_graph(graph);
+    Fabric_load_graph(db_file, graph);
+    assert(2 == Fabric_FreeIdMap_get_count(&vs->free_ids));
+
+    // a batch too long for the freed ids is taken from the end of the store
+    c = Fabric_ClassStore_get_class(&graph->class_store, 1, &status);
+    assert(FABRIC_OK == status);
+    first_id = Fabric_VertexStore_create_vertices(vs, c, FREE_ID_TEST_BATCH, &status);
+    assert(FABRIC_OK == status && FREE_ID_TEST_VERTICES + 1 == first_id);
+    assert(FREE_ID_TEST_VERTICES + FREE_ID_TEST_BATCH + 1 == vs->last_free_id);
+    v = Fabric_VertexStore_create_vertex(vs, c, &status);
+    assert(FABRIC_OK == status && 2 == Fabric_Vertex_get_id(v));
+    free_id_test_reload(db_file, graph);
+    assert(1 == Fabric_FreeIdMap_get_count(&vs->free_ids));
+    assert(FREE_ID_TEST_VERTICES + FREE_ID_TEST_BATCH + 1 == vs->last_free_id);
+}
+
+void test_free_id_map() {
+    FILE *db_file;
+    Graph graph;
+
+    free_id_test_map();
+
+    char *file_name = "test_free_id_map.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    free_id_test_save(&graph);
+    free_id_test_stores(db_file, &graph);
+
+    Fabric_close_graph(&graph);
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for free id maps.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_free_id_map();
+    return 0;
+}
+#endif
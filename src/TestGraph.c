@@ -13,6 +13,8 @@
 #include "Fabric.c"
 #endif
 
+#define TEST_BUDGET_VERTICES 2000
+
 
 void test_create_db() {
     FILE *db_file;
@@ -25,6 +27,7 @@ void test_create_db() {
     db_file = fopen(file_name, "w+b");
 
     Fabric_create_graph(db_file, &created_graph);
+    Fabric_close_graph(&created_graph);
 
     fclose(db_file);
 
@@ -64,12 +67,479 @@ void test_create_db() {
     assert(test_graph = &loaded_graph);
     printf("All tests passed for db creation.\n");
     // clean up
+    Fabric_close_graph(&loaded_graph);
+    fclose(db_file);
+    remove(file_name);
+}
+
+void test_map_db() {
+    FILE *db_file;
+    Graph created_graph;
+    Graph mapped_graph;
+    uint8_t in[32];
+    uint8_t out[32];
+    long offset;
+    size_t j;
+    int i;
+
+    char *file_name = "test_mapped.fdb";
+    db_file = fopen(file_name, "w+b");
+
+    Fabric_create_graph(db_file, &created_graph);
+    Fabric_close_graph(&created_graph);
+
+    assert(FABRIC_OK == Fabric_map_graph(db_file, &mapped_graph));
+    assert(mapped_graph.is_mapped);
+
+    // the mapped graph must see the same header as the created graph
+    assert(memcmp(&mapped_graph.fabric_header_string, &created_graph.fabric_header_string, 16) == 0);
+    assert(mapped_graph.fabric_version_number == created_graph.fabric_version_number);
+    assert(mapped_graph.class_store.offset == created_graph.class_store.offset);
+    assert(mapped_graph.label_store.offset == created_graph.label_store.offset);
+    assert(mapped_graph.index_store.page_count == created_graph.index_store.page_count);
+
+    // writes past the end of the file grow the mapping
+    for (j = 0; j < sizeof(in); j++) {
+        in[j] = (uint8_t)(j * 3 + 5);
+    }
+    offset = mapped_graph.mapping.size + 100;
+    assert(FABRIC_OK == Fabric_Graph_write_bytes(&mapped_graph, in, sizeof(in), offset));
+    assert(mapped_graph.mapping.size >= offset + sizeof(in));
+    assert(FABRIC_OK == Fabric_Graph_read_bytes(&mapped_graph, out, sizeof(out), offset));
+    assert(memcmp(in, out, sizeof(in)) == 0);
+    assert(betoh32(*(uint32_t*)in) == Fabric_Graph_read_uint32(&mapped_graph, offset));
+
+    assert(FABRIC_OK == Fabric_Graph_advise_store(&mapped_graph, FABRIC_VERTEX_STORE, FABRIC_ADVISE_SEQUENTIAL));
+    assert(FABRIC_GRAPH_ERROR == Fabric_Graph_advise_store(&mapped_graph, 0, FABRIC_ADVISE_NORMAL));
+
+    // advice is remembered once per region and is applied again when the
+    // mapping grows, which leaves the mapped data in place
+    i = mapped_graph.mapping.num_advice;
+    assert(i > 0);
+    assert(FABRIC_OK == Fabric_Graph_advise_store(&mapped_graph, FABRIC_VERTEX_STORE, FABRIC_ADVISE_SEQUENTIAL));
+    assert(i == mapped_graph.mapping.num_advice);
+    assert(FABRIC_OK == Fabric_FileMapping_ensure_size(&mapped_graph.mapping, mapped_graph.mapping.size + 1));
+    assert(i == mapped_graph.mapping.num_advice);
+    assert(FABRIC_OK == Fabric_Graph_read_bytes(&mapped_graph, out, sizeof(out), offset));
+    assert(memcmp(in, out, sizeof(in)) == 0);
+
+    Fabric_close_graph(&mapped_graph);
+
+    // the data written through the mapping must be in the file
+    fseek(db_file, offset, SEEK_SET);
+    assert(sizeof(out) == fread(out, 1, sizeof(out), db_file));
+    assert(memcmp(in, out, sizeof(in)) == 0);
+
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for mapped db.\n");
+}
+
+/**
+ * Serializer for test_write_records; each record is its id repeated
+ */
+static
+void test_serialize_record(void *store, uint32_t id, uint8_t *destination) {
+    memset(destination, (int)id, *(uint32_t*)store);
+}
+
+void test_write_records() {
+    FILE *db_file;
+    Graph graph;
+    uint32_t ids[] = {9, 2, 1, 3, 5, 4};
+    uint32_t record_size = 21;
+    uint32_t first_offset = 100;
+    ExtentList extents;
+    uint8_t record[21];
+    uint32_t id;
+    uint32_t i;
+
+    char *file_name = "test_records.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+
+    // records 1 to 4 fill the first extent and 5 to 10 are in the second
+    Fabric_ExtentList_init(&extents, 0, record_size);
+    assert(FABRIC_OK == Fabric_ExtentList_add(&extents, first_offset, 4 * record_size + 5));
+    assert(FABRIC_OK == Fabric_ExtentList_add(&extents, first_offset + 1000, 6 * record_size));
+    assert(10 == extents.capacity);
+    assert(first_offset + 1000 == Fabric_ExtentList_get_record_offset(&extents, 5));
+    assert(1 == Fabric_ExtentList_get_contiguous(&extents, 4));
+    assert(6 == Fabric_ExtentList_get_contiguous(&extents, 5));
+
+    assert(FABRIC_OK == Fabric_Graph_write_records(
+        &graph, ids, 6, &extents, test_serialize_record, &record_size));
+
+    // the ids are sorted in place
+    for (i = 1; i < 6; i++) {
+        assert(ids[i - 1] < ids[i]);
+    }
+
+    // only the written records are changed; the rest stay zero
+    for (id = 1; id <= 10; id++) {
+        Fabric_Graph_read_bytes(&graph, record, record_size, Fabric_ExtentList_get_record_offset(&extents, id));
+        for (i = 0; i < record_size; i++) {
+            if (id <= 5 || id == 9) {
+                assert(record[i] == id);
+            } else {
+                assert(record[i] == 0);
+            }
+        }
+    }
+
+    Fabric_Graph_update_uint16(&graph, 0x1234, first_offset);
+    assert(0x1234 == Fabric_Graph_read_uint16(&graph, first_offset));
+
+    Fabric_close_graph(&graph);
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for record writes.\n");
+}
+
+void test_adjacency() {
+    FILE *db_file;
+    Graph graph;
+    Class *c;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    Vertex *hub, *sink, *v;
+    Edge *e;
+    EdgeIterator iterator;
+    error_t status;
+    vertexid_t i;
+    vertexid_t frontier[3] = {1, 2, 101};
+    edgeid_t last_id;
+    uint64_t misses;
+    uint32_t count;
+
+    char *file_name = "test_adjacency.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    c = Fabric_Class_new(1, &status);
+    assert(FABRIC_OK == status);
+    memset(class_data, 0, sizeof(class_data));
+    Fabric_Class_init(c, class_data);
+    Fabric_Class_set_label_id(c, 1);
+    Fabric_ClassStore_update_class(&graph.class_store, c);
+
+    hub = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+    assert(FABRIC_OK == status && 1 == Fabric_Vertex_get_id(hub));
+    sink = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+    assert(FABRIC_OK == status && 2 == Fabric_Vertex_get_id(sink));
+
+    // the hub points at every vertex and every other vertex points at the sink
+    for (i = 3; i <= 100; i++) {
+        v = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+        assert(FABRIC_OK == status && i == Fabric_Vertex_get_id(v));
+        Fabric_EdgeStore_create_edge(&graph.edge_store, 1, hub, v, &status);
+        assert(FABRIC_OK == status);
+        Fabric_EdgeStore_create_edge(&graph.edge_store, 2, v, sink, &status);
+        assert(FABRIC_OK == status);
+    }
+    assert(100 == Fabric_Class_get_count(c));
+    assert(196 == graph.edge_store.num_edges);
+
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph.vertex_store));
+    assert(FABRIC_OK == Fabric_EdgeStore_flush(&graph.edge_store));
+    assert(FABRIC_OK == Fabric_ClassStore_flush(&graph.class_store));
+    Fabric_close_graph(&graph);
+
+    // walk the edges from the file rather than from the caches, after
+    // starting the reads of the first edges of both vertices at once
+    Fabric_load_graph(db_file, &graph);
+    misses = Fabric_BufferPool_get_misses(&graph.buffer_pool);
+    assert(FABRIC_OK == Fabric_EdgeIterator_prefetch_frontier(&graph, frontier, 2, FABRIC_DIRECTION_OUT));
+    assert(Fabric_BufferPool_get_misses(&graph.buffer_pool) > misses);
+    assert(Fabric_EntityCache_has_key(graph.vertex_store.cache, 2));
+    assert(FABRIC_VERTEX_DOESNT_EXIST == Fabric_EdgeIterator_prefetch_frontier(&graph, frontier + 2, 1, FABRIC_DIRECTION_IN));
+    hub = Fabric_VertexStore_get_vertex(&graph.vertex_store, 1, &status);
+    assert(FABRIC_OK == status);
+    sink = Fabric_VertexStore_get_vertex(&graph.vertex_store, 2, &status);
+    assert(FABRIC_OK == status);
+
+    count = 0;
+    last_id = 0;
+    Fabric_EdgeIterator_init(&iterator, &graph, hub, FABRIC_DIRECTION_OUT);
+    while (NULL != (e = Fabric_EdgeIterator_next(&iterator, &status))) {
+        assert(1 == Fabric_Edge_get_label_id(e));
+        assert(1 == Fabric_Edge_get_from_vertex_id(e));
+        assert(100 - count == Fabric_Edge_get_to_vertex_id(e));
+        assert(0 == last_id || Fabric_Edge_get_id(e) < last_id);
+        last_id = Fabric_Edge_get_id(e);
+        count++;
+    }
+    assert(FABRIC_OK == status && 98 == count);
+
+    count = 0;
+    Fabric_EdgeIterator_init(&iterator, &graph, sink, FABRIC_DIRECTION_IN);
+    while (NULL != (e = Fabric_EdgeIterator_next(&iterator, &status))) {
+        assert(2 == Fabric_Edge_get_label_id(e));
+        assert(2 == Fabric_Edge_get_to_vertex_id(e));
+        count++;
+    }
+    assert(FABRIC_OK == status && 98 == count);
+
+    // the hub has no in edges
+    Fabric_EdgeIterator_init(&iterator, &graph, hub, FABRIC_DIRECTION_IN);
+    assert(NULL == Fabric_EdgeIterator_next(&iterator, &status));
+    assert(FABRIC_OK == status);
+
+    assert(NULL == Fabric_VertexStore_get_vertex(&graph.vertex_store, 101, &status));
+    assert(FABRIC_VERTEX_DOESNT_EXIST == status);
+
+    // a missing vertex is not cached, so creating it later is found by id
+    assert(NULL == Fabric_EntityCache_get(graph.vertex_store.cache, 101));
+    c = Fabric_ClassStore_get_class(&graph.class_store, 1, &status);
+    assert(FABRIC_OK == status);
+    v = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+    assert(FABRIC_OK == status && 101 == Fabric_Vertex_get_id(v));
+    assert(v == Fabric_VertexStore_get_vertex(&graph.vertex_store, 101, &status));
+    assert(FABRIC_OK == status);
+    assert(NULL == Fabric_EdgeStore_get_edge(&graph.edge_store, 0, &status));
+    assert(FABRIC_EDGESTORE_INVALID_ID == status);
+
+    Fabric_close_graph(&graph);
     fclose(db_file);
     remove(file_name);
+    printf("All tests passed for adjacency.\n");
+}
+
+/**
+ * Fills a graph with more vertices and edges than fit in its first
+ * extents and checks that they survive reopening the graph
+ */
+static
+void test_grow_graph(FILE *db_file, Graph *graph) {
+    Class *c;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    Vertex *from, *to;
+    Edge *e;
+    error_t status;
+    vertexid_t i;
+    vertexid_t num_vertices = 2 * MIN_PAGE_SIZE / FABRIC_VERTEX_STORAGE_SIZE;
+    uint32_t vertex_capacity = graph->vertex_store.extents.capacity;
+    uint32_t edge_capacity = graph->edge_store.extents.capacity;
+
+    c = Fabric_Class_new(1, &status);
+    assert(FABRIC_OK == status);
+    memset(class_data, 0, sizeof(class_data));
+    Fabric_Class_init(c, class_data);
+    Fabric_ClassStore_update_class(&graph->class_store, c);
+
+    for (i = 1; i <= num_vertices; i++) {
+        to = Fabric_VertexStore_create_vertex(&graph->vertex_store, c, &status);
+        assert(FABRIC_OK == status);
+        if (i > 1) {
+            from = Fabric_VertexStore_get_vertex(&graph->vertex_store, i - 1, &status);
+            assert(FABRIC_OK == status);
+            Fabric_EdgeStore_create_edge(&graph->edge_store, 1, from, to, &status);
+            assert(FABRIC_OK == status);
+        }
+    }
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph->vertex_store));
+    assert(FABRIC_OK == Fabric_EdgeStore_flush(&graph->edge_store));
+    assert(FABRIC_OK == Fabric_ClassStore_flush(&graph->class_store));
+    assert(graph->vertex_store.extents.num_extents > 1);
+    assert(graph->vertex_store.extents.capacity > vertex_capacity);
+    assert(graph->edge_store.extents.capacity > edge_capacity);
+    assert(0 != graph->store_directory_offset);
+    Fabric_close_graph(graph);
+
+    // the grown stores are found through the store directory
+    Fabric_load_graph(db_file, graph);
+    assert(graph->vertex_store.extents.capacity >= num_vertices);
+    assert(num_vertices == graph->vertex_store.num_vertices);
+    assert(num_vertices - 1 == graph->edge_store.num_edges);
+    for (i = 2; i <= num_vertices; i++) {
+        e = Fabric_EdgeStore_get_edge(&graph->edge_store, i - 1, &status);
+        assert(FABRIC_OK == status);
+        assert(i - 1 == Fabric_Edge_get_from_vertex_id(e));
+        assert(i == Fabric_Edge_get_to_vertex_id(e));
+        to = Fabric_VertexStore_get_vertex(&graph->vertex_store, i, &status);
+        assert(FABRIC_OK == status);
+        assert(i - 1 == Fabric_Vertex_get_first_in_edge_id(to));
+    }
+    Fabric_close_graph(graph);
+}
+
+void test_store_growth() {
+    FILE *db_file;
+    Graph graph;
+
+    char *file_name = "test_growth.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+    test_grow_graph(db_file, &graph);
+    fclose(db_file);
+
+    // a graph without a store directory gets one when a store grows
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    graph.store_directory_offset = 0;
+    graph.end_offset = 0;
+    Fabric_Graph_write_header(&graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+    assert(0 == graph.store_directory_offset);
+    assert(graph.end_offset == graph.index_store.offset + graph.index_store.page_size * graph.index_store.page_count);
+    test_grow_graph(db_file, &graph);
+
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for store growth.\n");
+}
+
+void test_open_db() {
+    FILE *db_file;
+    Graph graph;
+    uint8_t byte;
+    uint32_t checksum;
+    error_t status;
+#ifndef FABRIC_NO_STATS
+    uint64_t before[FABRIC_STAT_NUM_COUNTERS], after[FABRIC_STAT_NUM_COUNTERS];
+#endif
+
+    char *file_name = "test_open.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+
+    // the header, the store directory and the class store's header are
+    // decoded from one read of the first page
+#ifndef FABRIC_NO_STATS
+    Fabric_stats_read(before);
+#endif
+    assert(0 == Fabric_Graph_init(&graph, db_file));
+#ifndef FABRIC_NO_STATS
+    Fabric_stats_read(after);
+    assert(after[FABRIC_STAT_READ_BYTES_CALLS] - before[FABRIC_STAT_READ_BYTES_CALLS] <= 1 + FABRIC_INDEX_STORE);
+#endif
+    assert(NULL == graph.first_page);
+    assert(1 == graph.class_store.last_free_id);
+    assert(1 == graph.vertex_store.last_free_id);
+
+    // a header field updated after the graph was created keeps it valid
+    Fabric_Graph_allocate(&graph, 100, &status);
+    assert(FABRIC_OK == status);
+    Fabric_close_graph(&graph);
+    assert(0 == Fabric_Graph_init(&graph, db_file));
+    Fabric_close_graph(&graph);
+
+    // a damaged header is refused
+    fseek(db_file, END_OFFSET_OFFSET, SEEK_SET);
+    byte = (uint8_t)fgetc(db_file);
+    fseek(db_file, END_OFFSET_OFFSET, SEEK_SET);
+    fputc(byte ^ 0x10, db_file);
+    fflush(db_file);
+    assert(0 > Fabric_Graph_init(&graph, db_file));
+    fseek(db_file, END_OFFSET_OFFSET, SEEK_SET);
+    fputc(byte, db_file);
+    fflush(db_file);
+
+    // graphs from before the checksum are loaded without one, and keep
+    // the bytes after their header as they are
+    assert(0 == Fabric_Graph_init(&graph, db_file));
+    graph.fabric_version_number = 1;
+    Fabric_Graph_write_header(&graph);
+    checksum = Fabric_Graph_read_uint32(&graph, HEADER_CHECKSUM_OFFSET);
+    Fabric_close_graph(&graph);
+    assert(0 == Fabric_Graph_init(&graph, db_file));
+    assert(1 == graph.fabric_version_number);
+    Fabric_Graph_allocate(&graph, 100, &status);
+    assert(FABRIC_OK == status);
+    assert(checksum == Fabric_Graph_read_uint32(&graph, HEADER_CHECKSUM_OFFSET));
+    Fabric_close_graph(&graph);
+
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for graph opening.\n");
+}
+
+/**
+ * Private function that creates a graph of vertices and loads it with
+ * empty caches
+ */
+static
+void test_budget_graph(FILE *db_file, Graph *graph) {
+    Class *c;
+    error_t status;
+
+    Fabric_create_graph(db_file, graph);
+    Fabric_close_graph(graph);
+    Fabric_load_graph(db_file, graph);
+    c = Fabric_ClassStore_create_class(&graph->class_store, NULL, "Vertex", FALSE, &status);
+    assert(FABRIC_OK == status);
+    Fabric_VertexStore_create_vertices(&graph->vertex_store, c, TEST_BUDGET_VERTICES, &status);
+    assert(FABRIC_OK == status);
+    assert(FABRIC_OK == Fabric_Graph_flush_stores(graph));
+    Fabric_close_graph(graph);
+    Fabric_load_graph(db_file, graph);
+}
+
+void test_memory_budget() {
+    FILE *db_files[2];
+    Graph graphs[2];
+    EntityCache *caches[2];
+    size_t used;
+    error_t status;
+    int i, j;
+
+    char *file_names[2] = {"test_budget_a.fdb", "test_budget_b.fdb"};
+    for (i = 0; i < 2; i++) {
+        db_files[i] = fopen(file_names[i], "w+b");
+        test_budget_graph(db_files[i], &graphs[i]);
+        for (j = 1; j < TEST_BUDGET_VERTICES; j++) {
+            Fabric_VertexStore_get_vertex(&graphs[i].vertex_store, j, &status);
+            assert(FABRIC_OK == status);
+        }
+        caches[i] = graphs[i].vertex_store.cache;
+        assert(TEST_BUDGET_VERTICES - 1 == Fabric_EntityCache_get_count(caches[i]));
+    }
+
+    // going over budget lowers a graph's limits the next time it reads
+    used = Fabric_memused();
+    Fabric_memset_budget(used - 1);
+    assert(Fabric_memis_over_budget());
+    Fabric_VertexStore_get_vertex(&graphs[0].vertex_store, TEST_BUDGET_VERTICES, &status);
+    assert(FABRIC_OK == status);
+    assert(Fabric_EntityCache_get_limit(caches[0]) < TEST_BUDGET_VERTICES * 7 / 8);
+    assert(TEST_BUDGET_VERTICES - 2 == Fabric_EntityCache_get_count(caches[0]));
+
+    // both graphs give memory back, and the limits are restored once the
+    // memory is back under the budget
+    Fabric_Graph_reclaim_memory(&graphs[0]);
+    Fabric_Graph_reclaim_memory(&graphs[1]);
+    for (i = 0; i < 2; i++) {
+        assert(Fabric_EntityCache_get_count(caches[i]) == Fabric_EntityCache_get_limit(caches[i]));
+        assert(Fabric_EntityCache_get_count(caches[i]) > FABRIC_MEM_BUDGET_MIN_CACHE_SIZE);
+        assert(Fabric_EntityCache_get_count(caches[i]) < TEST_BUDGET_VERTICES * 7 / 8);
+    }
+    assert(Fabric_memused() < used);
+    Fabric_memset_budget(0);
+    for (i = 0; i < 2; i++) {
+        Fabric_Graph_reclaim_memory(&graphs[i]);
+        assert(FABRIC_VERTEX_CACHE_SIZE == Fabric_EntityCache_get_limit(caches[i]));
+        Fabric_close_graph(&graphs[i]);
+        fclose(db_files[i]);
+        remove(file_names[i]);
+    }
+    printf("All tests passed for memory budgets.\n");
 }
 
 void test_graph() {
     test_create_db();
+    test_open_db();
+    test_write_records();
+    test_adjacency();
+    test_store_growth();
+    test_memory_budget();
+#ifndef FABRIC_NO_MMAP
+    test_map_db();
+#endif
 }
 
 #ifndef _FABRIC_TEST_ALL__
@@ -0,0 +1,59 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_TESTHELPERS_C__
+#define _FABRIC_TESTHELPERS_C__
+
+/**
+ * Fixtures shared by the tests that build graphs vertex by vertex.  It
+ * must be included after Fabric.c: a test file that is built on its own
+ * includes it next to Fabric.c, while TestAll.c includes it once for
+ * every test.
+ */
+
+#include <string.h>
+#include <assert.h>
+
+/**
+ * Gets a vertex of a graph, which must exist
+ */
+Vertex *test_get_vertex(Graph *graph, vertexid_t vertex_id) {
+    error_t status;
+    Vertex *v = Fabric_VertexStore_get_vertex(&graph->vertex_store, vertex_id, &status);
+    assert(FABRIC_OK == status);
+    return v;
+}
+
+/**
+ * Creates an edge between two vertices of a graph
+ */
+void test_connect(Graph *graph, labelid_t label_id, vertexid_t from, vertexid_t to) {
+    error_t status;
+    Fabric_EdgeStore_create_edge(&graph->edge_store, label_id,
+        test_get_vertex(graph, from), test_get_vertex(graph, to), &status);
+    assert(FABRIC_OK == status);
+}
+
+/**
+ * Sets an integer property of a vertex
+ */
+void test_set_integer_property(Graph *graph, Vertex *v, labelid_t label_id, int64_t value) {
+    uint8_t data[FABRIC_PROPERTY_STORAGE_SIZE];
+    error_t status;
+    Property *p = Fabric_Property_new(0, &status);
+
+    assert(FABRIC_OK == status);
+    memset(data, 0, sizeof(data));
+    Fabric_Property_init(p, data);
+    Fabric_Property_set_type(p, FABRIC_PROPTYPE_INTEGER);
+    Fabric_Property_set_integer_value(p, value);
+    assert(FABRIC_OK == Fabric_PropertyStore_set_vertex_property(&graph->property_store, v, label_id, p));
+    Fabric_Property_destroy(p);
+}
+
+#endif
@@ -74,7 +74,6 @@ void test_id_set() {
         assert (id % 3 == 0 || id % 4 == 0);
         assert (id % 5 != 0 || id % 4 == 0);
         assert (id != 0);
-        assert (id != FABRIC_IDSET_TOMBSTONE);
         assert (id <= 150);
         assert (TRUE == Fabric_IdSet_has(set, id));
         Fabric_IdSet_remove(set, id);
@@ -85,6 +84,31 @@ void test_id_set() {
 
     Fabric_memfree(ids, l * sizeof(uint32_t));
 
+    // heavy churn must not slow down or break lookups, since removals
+    // leave no tombstones behind
+    l = Fabric_IdSet_get_capacity(set);
+    for (i = 0; i < 20; i++) {
+        for (id = 1; id <= 40; id++) {
+            assert(FABRIC_OK == Fabric_IdSet_add(set, i * 1000 + id));
+        }
+        for (id = 1; id <= 40; id++) {
+            if (id % 2 == 0) {
+                Fabric_IdSet_remove(set, i * 1000 + id);
+            }
+        }
+        for (id = 1; id <= 40; id++) {
+            assert((id % 2 == 1) == Fabric_IdSet_has(set, i * 1000 + id));
+            Fabric_IdSet_remove(set, i * 1000 + id);
+        }
+        assert(0 == Fabric_IdSet_get_count(set));
+    }
+    assert(l == Fabric_IdSet_get_capacity(set));
+
+    // 0 marks an empty slot and is never stored
+    assert(FABRIC_OK == Fabric_IdSet_add(set, 0));
+    assert(FALSE == Fabric_IdSet_has(set, 0));
+    assert(0 == Fabric_IdSet_get_count(set));
+
     Fabric_IdSet_destroy(set);
     assert(starting_memory == Fabric_memused());
 
@@ -0,0 +1,249 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+#define INDEX_TEST_CLASSES 3000
+
+/**
+ * Writes the name of a test class; the names are long enough that the
+ * index needs several pages
+ */
+static
+void index_class_name(char *name, classid_t id) {
+    sprintf(name, "TestClass%05u_with_a_name_long_enough_to_page", (unsigned)id);
+}
+
+/**
+ * Puts a class with the given id in the class store and the class index
+ */
+static
+void index_add_class(Graph *graph, classid_t id) {
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    char name[64];
+    error_t status;
+    Class *c = Fabric_Class_new(id, &status);
+    assert(FABRIC_OK == status);
+    memset(class_data, 0, sizeof(class_data));
+    Fabric_Class_init(c, class_data);
+    Fabric_Class_set_label_id(c, id);
+    assert(FABRIC_OK == Fabric_ClassStore_update_class(&graph->class_store, c));
+    index_class_name(name, id);
+    assert(FABRIC_OK == Fabric_IndexStore_add_class_to_index(&graph->index_store, c, name));
+}
+
+/**
+ * Checks that every test class can be found by its name unless removed
+ */
+static
+void index_check_classes(Graph *graph, classid_t removed) {
+    ClassIndex *ci;
+    Class *c;
+    char name[64];
+    error_t status;
+    classid_t id;
+
+    ci = Fabric_IndexStore_get_class_index(&graph->index_store, &status);
+    assert(FABRIC_OK == status && NULL != ci);
+    for (id = 1; id <= INDEX_TEST_CLASSES; id++) {
+        index_class_name(name, id);
+        if (id == removed) {
+            assert(0 == Fabric_ClassIndex_get_class_id(ci, name, &status));
+            assert(NULL == Fabric_ClassStore_get_class_by_name(&graph->class_store, name, &status));
+            assert(FABRIC_CLASS_DOESNT_EXIST == status);
+            continue;
+        }
+        assert(id == Fabric_ClassIndex_get_class_id(ci, name, &status));
+        assert(FABRIC_OK == status);
+        c = Fabric_ClassStore_get_class_by_name(&graph->class_store, name, &status);
+        assert(FABRIC_OK == status && id == Fabric_Class_get_id(c));
+    }
+    assert(0 == Fabric_ClassIndex_get_class_id(ci, "NoSuchClass", &status));
+    assert(FABRIC_OK == status);
+}
+
+#define INDEX_TEST_LABELS 500
+
+/**
+ * Writes the text of a test label
+ */
+static
+void index_label_name(char *name, uint32_t i) {
+    sprintf(name, "label_%u", (unsigned)i);
+}
+
+/**
+ * Checks that every test label maps to its id and back
+ */
+static
+void index_check_labels(Graph *graph, labelid_t *ids) {
+    LabelIndex *li;
+    char name[64];
+    error_t status;
+    uint32_t i;
+
+    li = Fabric_IndexStore_get_label_index(&graph->index_store, &status);
+    assert(FABRIC_OK == status && NULL != li);
+    for (i = 0; i < INDEX_TEST_LABELS; i++) {
+        index_label_name(name, i);
+        assert(ids[i] == Fabric_LabelIndex_get_label_id(li, name, &status));
+        assert(0 == strcmp(name, Fabric_LabelIndex_get_text(li, ids[i])));
+        assert(0 == strcmp(name, Fabric_LabelStore_get_label_name(&graph->label_store, ids[i], &status)));
+        assert(FABRIC_OK == status);
+    }
+    assert(0 == Fabric_LabelIndex_get_label_id(li, "no_such_label", &status));
+    assert(NULL == Fabric_LabelStore_get_label_name(&graph->label_store, ids[0] + INDEX_TEST_LABELS, &status));
+    assert(FABRIC_LABEL_DOESNT_EXIST == status);
+}
+
+/**
+ * Tests the label index, which interns the text of labels
+ */
+static
+void index_test_labels(FILE *db_file) {
+    Graph graph;
+    Label *label;
+    Text *text;
+    labelid_t ids[INDEX_TEST_LABELS];
+    char name[64];
+    error_t status;
+    uint32_t i;
+
+    Fabric_load_graph(db_file, &graph);
+    for (i = 0; i < INDEX_TEST_LABELS; i++) {
+        index_label_name(name, i);
+        ids[i] = Fabric_LabelStore_add_label(&graph.label_store, name, &status);
+        assert(FABRIC_OK == status && 0 != ids[i]);
+    }
+    index_check_labels(&graph, ids);
+
+    // adding a label's text again adds a reference to the same label
+    index_label_name(name, 3);
+    label = Fabric_LabelStore_get_label(&graph.label_store, ids[3], &status);
+    i = Fabric_Label_get_refs(label);
+    assert(ids[3] == Fabric_LabelStore_add_label(&graph.label_store, name, &status));
+    assert(i + 1 == Fabric_Label_get_refs(label));
+    assert(INDEX_TEST_LABELS == graph.label_store.num_labels);
+
+    // the text is kept in the text store too
+    text = Fabric_Label_get_text(label, &graph, &status);
+    assert(FABRIC_OK == status);
+    assert(0 == strcmp(name, Fabric_Text_get_value(text)));
+    Fabric_Text_destroy(text);
+
+    assert(FABRIC_OK == Fabric_LabelStore_flush(&graph.label_store));
+    Fabric_close_graph(&graph);
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_TEXT));
+
+    // the index is read back from its pages
+    Fabric_load_graph(db_file, &graph);
+    index_check_labels(&graph, ids);
+    Fabric_close_graph(&graph);
+
+    // an index that was never stored is built from the label and text stores
+    Fabric_load_graph(db_file, &graph);
+    name[0] = 0;
+    Fabric_Graph_write_bytes(&graph, (uint8_t*)name, 1, Fabric_IndexStore_get_page_offset(&graph.index_store, 2));
+    index_check_labels(&graph, ids);
+    Fabric_close_graph(&graph);
+
+    Fabric_load_graph(db_file, &graph);
+    index_check_labels(&graph, ids);
+    Fabric_close_graph(&graph);
+}
+
+void test_index() {
+    FILE *db_file;
+    Graph graph;
+    ClassIndex *ci;
+    Class *c;
+    char name[64];
+    char long_name[INDEX_PAGE_SIZE];
+    error_t status;
+    classid_t id;
+
+    char *file_name = "test_index.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    // a new graph has an empty index and no index pages
+    ci = Fabric_IndexStore_get_class_index(&graph.index_store, &status);
+    assert(FABRIC_OK == status && NULL != ci);
+    assert(0 == Fabric_ClassIndex_get_class_id(ci, "TestClass00001_with_a_name_long_enough_to_page", &status));
+    assert(0 == graph.index_store.page_count);
+
+    for (id = 1; id <= INDEX_TEST_CLASSES; id++) {
+        index_add_class(&graph, id);
+    }
+    assert(2 < graph.index_store.page_count);
+    index_check_classes(&graph, 0);
+
+    // names are unique and must fit in a page
+    c = Fabric_ClassStore_get_class(&graph.class_store, 1, &status);
+    index_class_name(name, 2);
+    assert(FABRIC_DUPLICATE_CLASSNAME == Fabric_IndexStore_add_class_to_index(&graph.index_store, c, name));
+    memset(long_name, 'a', sizeof(long_name) - 1);
+    long_name[sizeof(long_name) - 1] = '\0';
+    assert(FABRIC_INDEX_ERROR == Fabric_IndexStore_add_class_to_index(&graph.index_store, c, long_name));
+
+    // removed classes can be put back
+    c = Fabric_ClassStore_get_class(&graph.class_store, 7, &status);
+    assert(FABRIC_OK == Fabric_IndexStore_remove_class_from_index(&graph.index_store, c));
+    index_check_classes(&graph, 7);
+    assert(FABRIC_OK == Fabric_IndexStore_add_class_to_index_if_not_exists(&graph.index_store, c));
+    assert(FABRIC_OK == Fabric_IndexStore_add_class_to_index_if_not_exists(&graph.index_store, c));
+    index_check_classes(&graph, 0);
+    assert(FABRIC_OK == Fabric_IndexStore_remove_class_from_index(&graph.index_store, c));
+
+    assert(FABRIC_OK == Fabric_ClassStore_flush(&graph.class_store));
+    Fabric_close_graph(&graph);
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+
+    // the index is read back from its pages
+    Fabric_load_graph(db_file, &graph);
+    index_check_classes(&graph, 7);
+    c = Fabric_ClassStore_get_class(&graph.class_store, 7, &status);
+    assert(FABRIC_OK == status);
+    // removed entries aren't read back, so the class is added again
+    assert(FABRIC_INDEX_ERROR == Fabric_IndexStore_add_class_to_index_if_not_exists(&graph.index_store, c));
+    index_class_name(name, 7);
+    assert(FABRIC_OK == Fabric_IndexStore_add_class_to_index(&graph.index_store, c, name));
+    index_check_classes(&graph, 0);
+    Fabric_close_graph(&graph);
+
+    Fabric_load_graph(db_file, &graph);
+    index_check_classes(&graph, 0);
+    Fabric_close_graph(&graph);
+
+    index_test_labels(db_file);
+
+    // the class index is unchanged by the labels
+    Fabric_load_graph(db_file, &graph);
+    index_check_classes(&graph, 0);
+    Fabric_close_graph(&graph);
+
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for indices.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_index();
+    return 0;
+}
+#endif
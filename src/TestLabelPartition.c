@@ -0,0 +1,289 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#include "TestHelpers.c"
+#endif
+
+#define LABEL_PARTITION_TEST_MAX_EDGES 8192
+
+/**
+ * Checks that a labeled walk of a vertex's edges returns the same edges,
+ * in the same order, as a full walk that skips the other labels
+ *
+ * Returns: The number of edges with the label
+ */
+static
+uint32_t label_partition_check_label(Graph *graph, Vertex *vertex, int direction, labelid_t label_id) {
+    edgeid_t expected[LABEL_PARTITION_TEST_MAX_EDGES];
+    uint32_t num_expected = 0, count = 0;
+    EdgeIterator iterator;
+    error_t status;
+    Edge *e;
+
+    Fabric_EdgeIterator_init(&iterator, graph, vertex, direction);
+    while (NULL != (e = Fabric_EdgeIterator_next(&iterator, &status))) {
+        if (Fabric_Edge_get_label_id(e) == label_id) {
+            expected[num_expected++] = Fabric_Edge_get_id(e);
+        }
+    }
+    assert(FABRIC_OK == status);
+
+    assert(FABRIC_OK == Fabric_EdgeIterator_init_with_label(&iterator, graph, vertex, direction, label_id));
+    while (NULL != (e = Fabric_EdgeIterator_next(&iterator, &status))) {
+        assert(count < num_expected);
+        assert(label_id == Fabric_Edge_get_label_id(e));
+        assert(expected[count] == Fabric_Edge_get_id(e));
+        count++;
+    }
+    assert(FABRIC_OK == status && num_expected == count);
+    return count;
+}
+
+/**
+ * Checks that every label's edges are next to each other in a list
+ *
+ * Returns: The number of edges in the list
+ */
+static
+uint32_t label_partition_check_grouped(Graph *graph, Vertex *vertex, int direction) {
+    labelid_t seen[LABEL_PARTITION_TEST_MAX_EDGES];
+    uint32_t num_seen = 0, count = 0, i;
+    labelid_t label_id = 0;
+    EdgeIterator iterator;
+    error_t status;
+    Edge *e;
+
+    Fabric_EdgeIterator_init(&iterator, graph, vertex, direction);
+    while (NULL != (e = Fabric_EdgeIterator_next(&iterator, &status))) {
+        if (Fabric_Edge_get_label_id(e) != label_id) {
+            label_id = Fabric_Edge_get_label_id(e);
+            for (i = 0; i < num_seen; i++) {
+                assert(seen[i] != label_id);
+            }
+            seen[num_seen++] = label_id;
+        }
+        count++;
+    }
+    assert(FABRIC_OK == status);
+    return count;
+}
+
+void test_label_partition() {
+    FILE *db_file;
+    Graph graph;
+    Class *c;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    LabelPartitionDirectory *partitions;
+    EdgeIterator iterator;
+    Vertex *hub;
+    Edge *e;
+    error_t status;
+    vertexid_t i;
+    uint32_t max_groups;
+    edgeid_t first_out, group_first, edge_id;
+    uint32_t group_count, count;
+
+    char *file_name = "test_label_partition.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    c = Fabric_Class_new(1, &status);
+    assert(FABRIC_OK == status);
+    memset(class_data, 0, sizeof(class_data));
+    Fabric_Class_init(c, class_data);
+    Fabric_Class_set_label_id(c, 1);
+    Fabric_ClassStore_update_class(&graph.class_store, c);
+    for (i = 1; i <= 301; i++) {
+        Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+        assert(FABRIC_OK == status);
+    }
+
+    // the hub's lists mix their labels
+    for (i = 2; i <= 301; i++) {
+        test_connect(&graph, 1 + i % 3, 1, i);
+        test_connect(&graph, 1 + i % 2, i, 1);
+    }
+    hub = test_get_vertex(&graph, 1);
+
+    // labeled walks of an unpartitioned list skip the other labels
+    partitions = Fabric_EdgeStore_get_label_partitions(&graph.edge_store, &status);
+    assert(FABRIC_OK == status);
+    assert(!Fabric_LabelPartitionDirectory_is_partitioned(partitions, 1, FABRIC_DIRECTION_OUT));
+    assert(100 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_OUT, 2));
+    assert(150 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_IN, 1));
+    assert(0 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_OUT, 7));
+
+    // partitioning groups the lists without losing edges
+    assert(FABRIC_OK == Fabric_EdgeStore_partition_by_label(&graph.edge_store, hub, FABRIC_DIRECTION_OUT));
+    assert(FABRIC_OK == Fabric_EdgeStore_partition_by_label(&graph.edge_store, hub, FABRIC_DIRECTION_IN));
+    assert(FABRIC_OK == Fabric_EdgeStore_partition_by_label(&graph.edge_store, hub, FABRIC_DIRECTION_IN));
+    assert(Fabric_LabelPartitionDirectory_is_partitioned(partitions, 1, FABRIC_DIRECTION_OUT));
+    assert(Fabric_LabelPartitionDirectory_is_partitioned(partitions, 1, FABRIC_DIRECTION_IN));
+    assert(300 == label_partition_check_grouped(&graph, hub, FABRIC_DIRECTION_OUT));
+    assert(300 == label_partition_check_grouped(&graph, hub, FABRIC_DIRECTION_IN));
+    assert(100 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_OUT, 1));
+    assert(100 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_OUT, 2));
+    assert(100 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_OUT, 3));
+    assert(150 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_IN, 2));
+    assert(0 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_IN, 3));
+
+    // the edges within a label keep their newest first order
+    assert(FABRIC_OK == Fabric_EdgeIterator_init_with_label(&iterator, &graph, hub, FABRIC_DIRECTION_OUT, 3));
+    for (i = 299; NULL != (e = Fabric_EdgeIterator_next(&iterator, &status)); i -= 3) {
+        assert(i == Fabric_Edge_get_to_vertex_id(e));
+    }
+    assert(FABRIC_OK == status);
+
+    // new edges join their label's group, or start a new one
+    test_connect(&graph, 2, 1, 5);
+    test_connect(&graph, 9, 1, 6);
+    test_connect(&graph, 3, 1, 7);
+    test_connect(&graph, 9, 8, 1);
+    assert(303 == label_partition_check_grouped(&graph, hub, FABRIC_DIRECTION_OUT));
+    assert(301 == label_partition_check_grouped(&graph, hub, FABRIC_DIRECTION_IN));
+    assert(101 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_OUT, 2));
+    assert(101 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_OUT, 3));
+    assert(1 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_OUT, 9));
+    assert(1 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_IN, 9));
+    assert(FABRIC_OK == Fabric_EdgeIterator_init_with_label(&iterator, &graph, hub, FABRIC_DIRECTION_OUT, 3));
+    e = Fabric_EdgeIterator_next(&iterator, &status);
+    assert(NULL != e && 7 == Fabric_Edge_get_to_vertex_id(e));
+
+    // unlinking a new edge restores its group, or removes the group it started
+    first_out = Fabric_Vertex_get_first_out_edge_id(hub);
+    assert(Fabric_LabelPartitionDirectory_find_group(partitions, 1, FABRIC_DIRECTION_OUT, 2, &group_first, &group_count));
+    e = Fabric_Edge_new(LABEL_PARTITION_TEST_MAX_EDGES, &status);
+    assert(FABRIC_OK == status);
+    Fabric_Edge_set_from_vertex_id(e, 1);
+    Fabric_Edge_set_to_vertex_id(e, 9);
+    assert(FABRIC_OK == Fabric_EdgeStore_update_edge(&graph.edge_store, e));
+    for (i = 2; i <= 11; i += 9) {
+        Fabric_Edge_set_label_id(e, i);
+        assert(FABRIC_OK == Fabric_LabelPartitionDirectory_link_edge(partitions, e, hub, FABRIC_DIRECTION_OUT));
+        assert(FABRIC_OK == Fabric_LabelPartitionDirectory_unlink_edge(partitions, e, hub, FABRIC_DIRECTION_OUT));
+        assert(first_out == Fabric_Vertex_get_first_out_edge_id(hub));
+    }
+    assert(Fabric_LabelPartitionDirectory_find_group(partitions, 1, FABRIC_DIRECTION_OUT, 2, &edge_id, &count));
+    assert(group_first == edge_id && group_count == count);
+    assert(Fabric_LabelPartitionDirectory_find_group(partitions, 1, FABRIC_DIRECTION_OUT, 11, &edge_id, &count));
+    assert(0 == count);
+    Fabric_EntityCache_unset(graph.edge_store.cache, LABEL_PARTITION_TEST_MAX_EDGES);
+    Fabric_IdSet_remove(graph.edge_store.changed, LABEL_PARTITION_TEST_MAX_EDGES);
+    Fabric_Edge_destroy(e);
+    assert(303 == label_partition_check_grouped(&graph, hub, FABRIC_DIRECTION_OUT));
+    assert(101 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_OUT, 2));
+
+    // a short list keeps its grouping as it grows
+    assert(FABRIC_OK == Fabric_EdgeStore_partition_by_label(&graph.edge_store,
+        test_get_vertex(&graph, 300), FABRIC_DIRECTION_OUT));
+    for (i = 2; i <= 40; i++) {
+        test_connect(&graph, 1 + i % 4, 300, i);
+    }
+    assert(40 == label_partition_check_grouped(&graph, test_get_vertex(&graph, 300), FABRIC_DIRECTION_OUT));
+    assert(11 == label_partition_check_label(&graph, test_get_vertex(&graph, 300), FABRIC_DIRECTION_OUT, 1));
+
+    // the partitions survive reopening the graph
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph.vertex_store));
+    assert(FABRIC_OK == Fabric_EdgeStore_flush(&graph.edge_store));
+    assert(FABRIC_OK == Fabric_ClassStore_flush(&graph.class_store));
+    Fabric_close_graph(&graph);
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+
+    Fabric_load_graph(db_file, &graph);
+    c = Fabric_ClassStore_get_class(&graph.class_store, 1, &status);
+    assert(FABRIC_OK == status);
+    hub = test_get_vertex(&graph, 1);
+    partitions = Fabric_EdgeStore_get_label_partitions(&graph.edge_store, &status);
+    assert(FABRIC_OK == status);
+    assert(Fabric_LabelPartitionDirectory_is_partitioned(partitions, 1, FABRIC_DIRECTION_OUT));
+    assert(Fabric_LabelPartitionDirectory_is_partitioned(partitions, 300, FABRIC_DIRECTION_OUT));
+    assert(!Fabric_LabelPartitionDirectory_is_partitioned(partitions, 300, FABRIC_DIRECTION_IN));
+    assert(101 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_OUT, 2));
+    assert(150 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_IN, 1));
+    test_connect(&graph, 1, 1, 9);
+    assert(304 == label_partition_check_grouped(&graph, hub, FABRIC_DIRECTION_OUT));
+    assert(101 == label_partition_check_label(&graph, hub, FABRIC_DIRECTION_OUT, 1));
+
+    // a list with more labels than a partition can hold isn't partitioned
+    max_groups = (graph.index_store.page_size - 20) / 16;
+    Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+    assert(FABRIC_OK == status);
+    for (i = 1; i <= max_groups + 1; i++) {
+        test_connect(&graph, 100 + i, 302, 2);
+    }
+    assert(FABRIC_EDGESTORE_TOO_MANY_LABELS == Fabric_EdgeStore_partition_by_label(&graph.edge_store,
+        test_get_vertex(&graph, 302), FABRIC_DIRECTION_OUT));
+    assert(!Fabric_LabelPartitionDirectory_is_partitioned(partitions, 302, FABRIC_DIRECTION_OUT));
+    assert(max_groups + 1 == label_partition_check_grouped(&graph, test_get_vertex(&graph, 302), FABRIC_DIRECTION_OUT));
+
+    // one that gets too many labels later is dropped but keeps its edges
+    Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+    assert(FABRIC_OK == status);
+    assert(FABRIC_OK == Fabric_EdgeStore_partition_by_label(&graph.edge_store,
+        test_get_vertex(&graph, 303), FABRIC_DIRECTION_OUT));
+    for (i = 1; i <= max_groups; i++) {
+        test_connect(&graph, 100 + i, 303, 2);
+    }
+    assert(Fabric_LabelPartitionDirectory_is_partitioned(partitions, 303, FABRIC_DIRECTION_OUT));
+    test_connect(&graph, 1, 303, 2);
+    assert(!Fabric_LabelPartitionDirectory_is_partitioned(partitions, 303, FABRIC_DIRECTION_OUT));
+    assert(1 == label_partition_check_label(&graph, test_get_vertex(&graph, 303), FABRIC_DIRECTION_OUT, 1));
+    assert(1 == label_partition_check_label(&graph, test_get_vertex(&graph, 303), FABRIC_DIRECTION_OUT, 101));
+
+    // a directory spread over several pages reads back
+    Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+    assert(FABRIC_OK == status);
+    for (i = 1; i <= max_groups; i++) {
+        test_connect(&graph, 100 + i, 304, 2);
+    }
+    assert(FABRIC_OK == Fabric_EdgeStore_partition_by_label(&graph.edge_store,
+        test_get_vertex(&graph, 304), FABRIC_DIRECTION_OUT));
+    for (i = 2; i <= 299; i++) {
+        assert(FABRIC_OK == Fabric_EdgeStore_partition_by_label(&graph.edge_store,
+            test_get_vertex(&graph, i), FABRIC_DIRECTION_OUT));
+    }
+    assert(FABRIC_OK == Fabric_EdgeStore_partition_by_label(&graph.edge_store,
+        test_get_vertex(&graph, 302), FABRIC_DIRECTION_IN));
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph.vertex_store));
+    assert(FABRIC_OK == Fabric_EdgeStore_flush(&graph.edge_store));
+    Fabric_close_graph(&graph);
+
+    Fabric_load_graph(db_file, &graph);
+    partitions = Fabric_EdgeStore_get_label_partitions(&graph.edge_store, &status);
+    assert(FABRIC_OK == status);
+    for (i = 1; i <= 300; i++) {
+        assert(Fabric_LabelPartitionDirectory_is_partitioned(partitions, i, FABRIC_DIRECTION_OUT));
+    }
+    assert(Fabric_LabelPartitionDirectory_is_partitioned(partitions, 302, FABRIC_DIRECTION_IN));
+    assert(!Fabric_LabelPartitionDirectory_is_partitioned(partitions, 303, FABRIC_DIRECTION_OUT));
+    assert(3 == partitions->num_pages);
+    assert(1 == label_partition_check_label(&graph, test_get_vertex(&graph, 304), FABRIC_DIRECTION_OUT, 100 + max_groups));
+    assert(1 == label_partition_check_label(&graph, test_get_vertex(&graph, 150), FABRIC_DIRECTION_OUT, 1));
+    assert(101 == label_partition_check_label(&graph, test_get_vertex(&graph, 1), FABRIC_DIRECTION_OUT, 1));
+
+    Fabric_close_graph(&graph);
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for label partitions.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_label_partition();
+    return 0;
+}
+#endif
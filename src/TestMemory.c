@@ -3,11 +3,15 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 26, 2015
- * Updated: March 26, 2015
+ * Updated: October 14, 2026
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
+#ifndef FABRIC_NO_THREADS
+#include <pthread.h>
+#endif
 #ifndef _FABRIC_TEST_ALL__
 #include "Fabric.c"
 #endif
@@ -15,11 +19,68 @@
 #define NUM_TESTS 509
 #define TEST_POINTER_SIZE 6
 #define TEST_POINTER_REALLOCATE_SIZE 10
+#define TEST_MEMORY_THREADS 4
+#define TEST_SLAB_VERTICES 1000
+#define TEST_SLAB_ROUNDS 20
+
+#ifndef FABRIC_NO_THREADS
+/**
+ * Allocates and frees memory, keeping every third allocation so that
+ * it outlives the thread
+ */
+static
+void *memory_test_thread(void *arg) {
+    void **kept = arg;
+    void *ptr;
+    int i;
+    for (i = 0; i < NUM_TESTS; i++) {
+        ptr = Fabric_memalloc_tagged(TEST_POINTER_SIZE, FABRIC_MEM_LIST);
+        assert(ptr != NULL);
+        if (i % 3 == 0) {
+            kept[i / 3] = ptr;
+        } else {
+            Fabric_memfree_tagged(ptr, TEST_POINTER_SIZE, FABRIC_MEM_LIST);
+        }
+    }
+    assert(Fabric_memerrno() == FABRIC_OK);
+    return NULL;
+}
+
+/**
+ * Creates and destroys vertices, which share one slab with every other
+ * thread, checking that no vertex was handed out twice
+ */
+static
+void *memory_slab_thread(void *arg) {
+    Vertex *vertices[TEST_SLAB_VERTICES];
+    vertexid_t first_id = *(vertexid_t*)arg;
+    error_t status;
+    int round, i;
+    for (round = 0; round < TEST_SLAB_ROUNDS; round++) {
+        for (i = 0; i < TEST_SLAB_VERTICES; i++) {
+            vertices[i] = Fabric_Vertex_new(first_id + i, &status);
+            assert(FABRIC_OK == status);
+        }
+        for (i = 0; i < TEST_SLAB_VERTICES; i++) {
+            assert(first_id + i == Fabric_Vertex_get_id(vertices[i]));
+            Fabric_Vertex_destroy(vertices[i]);
+        }
+    }
+    return NULL;
+}
+#endif
 
 void test_memory() {
     void *ptrs[NUM_TESTS];
     int i;
     void *ptr;
+    uint32_t pressure;
+#ifndef FABRIC_NO_THREADS
+    int j;
+    pthread_t threads[TEST_MEMORY_THREADS];
+    void *kept[TEST_MEMORY_THREADS][(NUM_TESTS + 2) / 3];
+    vertexid_t first_ids[2] = {1, TEST_SLAB_VERTICES + 1};
+#endif
 
 
     assert(Fabric_meminit() == FABRIC_OK);
@@ -54,6 +115,92 @@ void test_memory() {
 
     assert(Fabric_memused() == 0);
 
+    // slab objects are accounted as if they were allocated separately
+    MemSlab slab = FABRIC_MEMSLAB_INITIALIZER(uint8_t[TEST_POINTER_SIZE]);
+    size_t reserved = Fabric_memreserved();
+    for (i = 0; i < NUM_TESTS; i++) {
+        ptrs[i] = Fabric_memslab_alloc(&slab);
+        assert(ptrs[i] != NULL);
+        memset(ptrs[i], i, TEST_POINTER_SIZE);
+    }
+    assert(Fabric_memused() == NUM_TESTS * TEST_POINTER_SIZE);
+#ifndef FABRIC_NO_SLAB
+    assert(Fabric_memreserved() > reserved);
+
+    // freed objects are reused
+    ptr = ptrs[NUM_TESTS - 1];
+    Fabric_memslab_free(&slab, ptr);
+    assert(Fabric_memslab_alloc(&slab) == ptr);
+#endif
+
+    for (i = 0; i < NUM_TESTS; i++) {
+        Fabric_memslab_free(&slab, ptrs[i]);
+    }
+    assert(Fabric_memused() == 0);
+    Fabric_memslab_release(&slab);
+    assert(Fabric_memreserved() == reserved);
+
+    // usage is also counted by subsystem
+    ptr = Fabric_memalloc_tagged(TEST_POINTER_SIZE, FABRIC_MEM_CACHE);
+    assert(ptr != NULL);
+    assert(Fabric_memused_tagged(FABRIC_MEM_CACHE) == TEST_POINTER_SIZE);
+    assert(Fabric_memused_tagged(FABRIC_MEM_GENERAL) == 0);
+    ptr = Fabric_memrealloc_tagged(ptr, TEST_POINTER_REALLOCATE_SIZE, TEST_POINTER_SIZE, FABRIC_MEM_CACHE);
+    assert(ptr != NULL);
+    assert(Fabric_memused() == TEST_POINTER_REALLOCATE_SIZE);
+    Fabric_memfree_tagged(ptr, TEST_POINTER_REALLOCATE_SIZE, FABRIC_MEM_CACHE);
+    assert(Fabric_memused_tagged(FABRIC_MEM_CACHE) == 0);
+
+#ifndef FABRIC_NO_THREADS
+    // every thread's usage is counted, even once it has exited
+    for (i = 0; i < TEST_MEMORY_THREADS; i++) {
+        assert(0 == pthread_create(&threads[i], NULL, memory_test_thread, kept[i]));
+    }
+    for (i = 0; i < TEST_MEMORY_THREADS; i++) {
+        assert(0 == pthread_join(threads[i], NULL));
+    }
+    assert(Fabric_memused() == TEST_MEMORY_THREADS * ((NUM_TESTS + 2) / 3) * TEST_POINTER_SIZE);
+    assert(Fabric_memused_tagged(FABRIC_MEM_LIST) == Fabric_memused());
+
+    // memory can be freed by another thread
+    for (i = 0; i < TEST_MEMORY_THREADS; i++) {
+        for (j = 0; j < (NUM_TESTS + 2) / 3; j++) {
+            Fabric_memfree_tagged(kept[i][j], TEST_POINTER_SIZE, FABRIC_MEM_LIST);
+        }
+    }
+    assert(Fabric_memused() == 0);
+
+    // two threads can create and destroy entities at once
+    for (i = 0; i < 2; i++) {
+        assert(0 == pthread_create(&threads[i], NULL, memory_slab_thread, &first_ids[i]));
+    }
+    for (i = 0; i < 2; i++) {
+        assert(0 == pthread_join(threads[i], NULL));
+    }
+    assert(Fabric_memused() == 0);
+#endif
+
+    // going over the budget is a warning, checked every few allocations
+    pressure = Fabric_mempressure();
+    assert(Fabric_memget_budget() == 0 && !Fabric_memis_over_budget());
+    Fabric_memset_budget(FABRIC_MEM_BUDGET_CHECK_SIZE);
+    assert(Fabric_memget_budget() == FABRIC_MEM_BUDGET_CHECK_SIZE);
+    assert(Fabric_mempressure() == pressure);
+    ptr = Fabric_memalloc(2 * FABRIC_MEM_BUDGET_CHECK_SIZE);
+    assert(ptr != NULL);
+    assert(Fabric_memerrno() == FABRIC_MEM_OVER_BUDGET);
+    assert(Fabric_memis_over_budget());
+    assert(Fabric_mempressure() != pressure);
+
+    // the warning is cleared once the memory is back under the budget
+    pressure = Fabric_mempressure();
+    Fabric_memfree(ptr, 2 * FABRIC_MEM_BUDGET_CHECK_SIZE);
+    Fabric_memset_budget(0);
+    assert(Fabric_memerrno() == FABRIC_OK);
+    assert(!Fabric_memis_over_budget());
+    assert(Fabric_mempressure() != pressure);
+    assert(Fabric_memused() == 0);
+
     printf("All tests past for memory module.\n");
 }
 
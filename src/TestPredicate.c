@@ -0,0 +1,397 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+#define PREDICATE_TEST_RECORDS 1001
+#define PREDICATE_TEST_VERTICES 900
+#define PREDICATE_TEST_AGE 1
+#define PREDICATE_TEST_SCORE 2
+
+static uint32_t predicate_test_seed = 2463534242U;
+
+static
+uint32_t predicate_random() {
+    predicate_test_seed ^= predicate_test_seed << 13;
+    predicate_test_seed ^= predicate_test_seed >> 17;
+    predicate_test_seed ^= predicate_test_seed << 5;
+    return predicate_test_seed;
+}
+
+/**
+ * Fills a property object with a value of a type
+ */
+static
+void predicate_value(Property *p, uint8_t type, int64_t integer) {
+    uint8_t data[FABRIC_PROPERTY_STORAGE_SIZE];
+    memset(data, 0, sizeof(data));
+    Fabric_Property_set_id(p, 1);
+    Fabric_Property_init(p, data);
+    Fabric_Property_set_type(p, type);
+    Fabric_Property_set_integer_value(p, integer);
+}
+
+static
+void predicate_real(Property *p, float64_t real) {
+    predicate_value(p, FABRIC_PROPTYPE_REAL, 0);
+    Fabric_Property_set_real_value(p, real);
+}
+
+static
+void predicate_text(Property *p, const char *text) {
+    predicate_value(p, FABRIC_PROPTYPE_EMPTYTEXT + strlen(text), 0);
+    Fabric_Property_set_short_text(p, (text_t)text);
+}
+
+static
+bool_t predicate_matches(Predicate *predicate, Property *p) {
+    return Fabric_Predicate_matches(predicate, Fabric_Property_get_type(p), Fabric_Property_get_data(p));
+}
+
+/**
+ * Checks single values against predicates of each operator
+ */
+static
+void predicate_test_matches() {
+    Property a, b, c, *values[3];
+    Predicate predicate;
+
+    predicate_value(&a, FABRIC_PROPTYPE_INTEGER, -5);
+    predicate_value(&b, FABRIC_PROPTYPE_INTEGER, 10);
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_LESS, &b));
+    assert(predicate_matches(&predicate, &a) && !predicate_matches(&predicate, &b));
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_LESS_EQUAL, &b));
+    assert(predicate_matches(&predicate, &a) && predicate_matches(&predicate, &b));
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_GREATER, &a));
+    assert(!predicate_matches(&predicate, &a) && predicate_matches(&predicate, &b));
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_GREATER_EQUAL, &b));
+    assert(!predicate_matches(&predicate, &a) && predicate_matches(&predicate, &b));
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_EQUAL, &a));
+    assert(predicate_matches(&predicate, &a) && !predicate_matches(&predicate, &b));
+
+    // a datetime is not an integer
+    predicate_value(&c, FABRIC_PROPTYPE_DATETIME, -5);
+    assert(!predicate_matches(&predicate, &c));
+
+    // nothing is less than the smallest integer
+    predicate_value(&c, FABRIC_PROPTYPE_INTEGER, INT64_MIN);
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_LESS, &c));
+    assert(!predicate_matches(&predicate, &c) && !predicate_matches(&predicate, &a));
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_LESS_EQUAL, &c));
+    assert(predicate_matches(&predicate, &c));
+
+    // reals, with strict bounds and NaN
+    predicate_real(&a, 1.5);
+    predicate_real(&b, nextafter(1.5, 2.0));
+    predicate_real(&c, NAN);
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_GREATER, &a));
+    assert(!predicate_matches(&predicate, &a) && predicate_matches(&predicate, &b));
+    assert(!predicate_matches(&predicate, &c));
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_LESS, &b));
+    assert(predicate_matches(&predicate, &a) && !predicate_matches(&predicate, &b));
+
+    // short texts compare in byte order, a prefix first
+    predicate_text(&a, "ab");
+    predicate_text(&b, "abc");
+    predicate_text(&c, "b");
+    assert(FABRIC_OK == Fabric_Predicate_init_range(&predicate, &a, &b));
+    assert(predicate_matches(&predicate, &a) && predicate_matches(&predicate, &b));
+    assert(!predicate_matches(&predicate, &c));
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_GREATER, &b));
+    assert(predicate_matches(&predicate, &c) && !predicate_matches(&predicate, &a));
+    predicate_text(&a, "");
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_LESS, &b));
+    assert(predicate_matches(&predicate, &a));
+    values[0] = &a;
+    values[1] = &c;
+    assert(FABRIC_OK == Fabric_Predicate_init_in(&predicate, values, 2));
+    assert(predicate_matches(&predicate, &a) && predicate_matches(&predicate, &c));
+    assert(!predicate_matches(&predicate, &b));
+
+    // values that can't be compared
+    predicate_value(&c, FABRIC_PROPTYPE_TRUE, 0);
+    assert(FABRIC_PROPERTY_ERROR == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_EQUAL, &c));
+    assert(FABRIC_PROPERTY_ERROR == Fabric_Predicate_init(&predicate, 99, &a));
+    predicate_value(&c, FABRIC_PROPTYPE_INTEGER, 3);
+    assert(FABRIC_PROPERTY_ERROR == Fabric_Predicate_init_range(&predicate, &a, &c));
+    values[2] = &c;
+    assert(FABRIC_PROPERTY_ERROR == Fabric_Predicate_init_in(&predicate, values, 3));
+    assert(FABRIC_PROPERTY_ERROR == Fabric_Predicate_init_in(&predicate, values, 0));
+    assert(FABRIC_PROPERTY_ERROR == Fabric_Predicate_init_in(&predicate, values, FABRIC_PREDICATE_MAX_VALUES + 1));
+}
+
+/**
+ * Evaluates a predicate over records with every kernel the processor
+ * supports, checking each against the single value matches
+ */
+static
+void predicate_check_records(Predicate *predicate, const uint8_t *records, Property *properties, labelid_t label_id) {
+    uint8_t selection[(PREDICATE_TEST_RECORDS + 7) / 8];
+    uint32_t ids[PREDICATE_TEST_RECORDS];
+    uint32_t count, expected, n, i;
+    int kernel, default_kernel = Fabric_Predicate_get_kernel();
+    bool_t match;
+
+    for (kernel = FABRIC_PREDICATE_KERNEL_SCALAR; kernel <= FABRIC_PREDICATE_KERNEL_AVX2; kernel++) {
+        if (!Fabric_Predicate__use_kernel(kernel)) {
+            continue;
+        }
+        memset(selection, 0xff, sizeof(selection));
+        count = Fabric_Predicate_select_records(predicate, records, PREDICATE_TEST_RECORDS, label_id, selection);
+        expected = 0;
+        for (i = 0; i < PREDICATE_TEST_RECORDS; i++) {
+            match = predicate_matches(predicate, &properties[i]) &&
+                (0 == label_id || Fabric_Property_get_label_id(&properties[i]) == label_id);
+            assert(match == ((selection[i / 8] >> (i % 8)) & 1));
+            expected += match;
+        }
+        assert(count == expected);
+        // the bits past the last record are clear
+        assert(0 == selection[PREDICATE_TEST_RECORDS / 8] >> (PREDICATE_TEST_RECORDS % 8));
+
+        n = Fabric_Predicate_get_selected_ids(selection, PREDICATE_TEST_RECORDS, NULL, 100, ids);
+        assert(n == count);
+        for (i = 1; i < n; i++) {
+            assert(ids[i] > ids[i - 1]);
+        }
+        if (n > 0) {
+            assert(predicate_matches(predicate, &properties[ids[0] - 100]));
+        }
+    }
+    assert(Fabric_Predicate__use_kernel(default_kernel));
+}
+
+/**
+ * Evaluates predicates over an array of property records of mixed types
+ */
+static
+void predicate_test_records() {
+    static uint8_t records[PREDICATE_TEST_RECORDS * FABRIC_PROPERTY_STORAGE_SIZE];
+    static Property properties[PREDICATE_TEST_RECORDS];
+    char text[9];
+    Property low, high, *values[FABRIC_PREDICATE_MAX_VALUES];
+    Property in_values[FABRIC_PREDICATE_MAX_VALUES];
+    Predicate predicate;
+    uint32_t i, r;
+
+    for (i = 0; i < PREDICATE_TEST_RECORDS; i++) {
+        r = predicate_random();
+        switch (r % 6) {
+        case 0:
+        case 1:
+            predicate_value(&properties[i], FABRIC_PROPTYPE_INTEGER, (int64_t)(r % 2001) - 1000);
+            break;
+        case 2:
+            predicate_real(&properties[i], ((int)(r % 2001) - 1000) / 8.0);
+            break;
+        case 3:
+            predicate_value(&properties[i], FABRIC_PROPTYPE_DATETIME, (int64_t)(r % 2001) - 1000);
+            break;
+        case 4:
+            sprintf(text, "t%u", (unsigned)(r % 500));
+            predicate_text(&properties[i], text);
+            break;
+        default:
+            predicate_value(&properties[i], r % 2 ? FABRIC_PROPTYPE_TRUE : FABRIC_PROPTYPE_INTEGER, INT64_MAX - r % 3);
+            break;
+        }
+        Fabric_Property_set_label_id(&properties[i], 1 + r % 3);
+        Fabric_Property_load_bytes(&properties[i], records + i * FABRIC_PROPERTY_STORAGE_SIZE);
+    }
+
+    predicate_value(&low, FABRIC_PROPTYPE_INTEGER, 17);
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_EQUAL, &low));
+    predicate_check_records(&predicate, records, properties, 0);
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_LESS, &low));
+    predicate_check_records(&predicate, records, properties, 0);
+    predicate_check_records(&predicate, records, properties, 2);
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_GREATER_EQUAL, &low));
+    predicate_check_records(&predicate, records, properties, 0);
+    predicate_value(&low, FABRIC_PROPTYPE_INTEGER, INT64_MAX - 1);
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_GREATER, &low));
+    predicate_check_records(&predicate, records, properties, 0);
+
+    predicate_value(&low, FABRIC_PROPTYPE_DATETIME, -100);
+    predicate_value(&high, FABRIC_PROPTYPE_DATETIME, 250);
+    assert(FABRIC_OK == Fabric_Predicate_init_range(&predicate, &low, &high));
+    predicate_check_records(&predicate, records, properties, 0);
+
+    predicate_real(&low, -3.25);
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_LESS_EQUAL, &low));
+    predicate_check_records(&predicate, records, properties, 0);
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_GREATER, &low));
+    predicate_check_records(&predicate, records, properties, 3);
+
+    predicate_text(&low, "t1");
+    predicate_text(&high, "t2");
+    assert(FABRIC_OK == Fabric_Predicate_init_range(&predicate, &low, &high));
+    predicate_check_records(&predicate, records, properties, 0);
+
+    for (i = 0; i < FABRIC_PREDICATE_MAX_VALUES; i++) {
+        predicate_value(&in_values[i], FABRIC_PROPTYPE_INTEGER, (int64_t)i * 37 - 300);
+        values[i] = &in_values[i];
+    }
+    assert(FABRIC_OK == Fabric_Predicate_init_in(&predicate, values, FABRIC_PREDICATE_MAX_VALUES));
+    predicate_check_records(&predicate, records, properties, 0);
+}
+
+/**
+ * Sets a vertex's integer or real property
+ */
+static
+void predicate_set(Graph *graph, vertexid_t vertex_id, labelid_t label_id, Property *value) {
+    error_t status;
+    Vertex *v = Fabric_VertexStore_get_vertex(&graph->vertex_store, vertex_id, &status);
+    assert(FABRIC_OK == status);
+    assert(FABRIC_OK == Fabric_PropertyStore_set_vertex_property(&graph->property_store, v, label_id, value));
+}
+
+/**
+ * Evaluates predicates over columns and over the property store
+ */
+static
+void predicate_test_graph() {
+    static int64_t ages[PREDICATE_TEST_VERTICES + 1];
+    uint8_t selection[PREDICATE_TEST_VERTICES * 2 / 8 + 1];
+    uint32_t ids[PREDICATE_TEST_VERTICES];
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    PropertyColumn *age_column, *score_column;
+    Property value, bound;
+    Predicate predicate;
+    FILE *db_file;
+    Graph graph;
+    Class *c;
+    uint32_t count, expected, n, i, num_properties;
+    error_t status;
+    bool_t match;
+
+    char *file_name = "test_predicate.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    c = Fabric_Class_new(1, &status);
+    assert(FABRIC_OK == status);
+    memset(class_data, 0, sizeof(class_data));
+    Fabric_Class_init(c, class_data);
+    Fabric_Class_set_label_id(c, 1);
+    assert(FABRIC_OK == Fabric_ClassStore_update_class(&graph.class_store, c));
+    for (i = 1; i <= PREDICATE_TEST_VERTICES; i++) {
+        Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+        assert(FABRIC_OK == status);
+        if (i % 9 != 0) {
+            ages[i] = (int64_t)(predicate_random() % 100);
+            predicate_value(&value, FABRIC_PROPTYPE_INTEGER, ages[i]);
+            predicate_set(&graph, i, PREDICATE_TEST_AGE, &value);
+        }
+        predicate_real(&value, i * 0.5);
+        predicate_set(&graph, i, PREDICATE_TEST_SCORE, &value);
+    }
+    age_column = Fabric_IndexStore_create_property_column(&graph.index_store, 1, PREDICATE_TEST_AGE, FABRIC_COLUMN_INTEGER, &status);
+    assert(FABRIC_OK == status);
+    score_column = Fabric_IndexStore_create_property_column(&graph.index_store, 1, PREDICATE_TEST_SCORE, FABRIC_COLUMN_REAL, &status);
+    assert(FABRIC_OK == status);
+
+    // a column scan skips the null rows
+    predicate_value(&bound, FABRIC_PROPTYPE_INTEGER, 30);
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_LESS, &bound));
+    count = Fabric_Predicate_select_column(&predicate, age_column, selection, &status);
+    assert(FABRIC_OK == status);
+    n = Fabric_Predicate_get_selected_ids(selection, Fabric_PropertyColumn_get_row_count(age_column),
+        Fabric_PropertyColumn_get_vertex_ids(age_column), 0, ids);
+    assert(n == count);
+    expected = 0;
+    for (i = 1; i <= PREDICATE_TEST_VERTICES; i++) {
+        if (i % 9 != 0 && ages[i] < 30) {
+            assert(ids[expected++] == i);
+        }
+    }
+    assert(expected == count);
+
+    predicate_value(&bound, FABRIC_PROPTYPE_INTEGER, 0);
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_EQUAL, &bound));
+    count = Fabric_Predicate_select_column(&predicate, age_column, selection, &status);
+    for (i = 1, expected = 0; i <= PREDICATE_TEST_VERTICES; i++) {
+        expected += i % 9 != 0 && ages[i] == 0;
+    }
+    assert(FABRIC_OK == status && expected == count);
+
+    predicate_real(&bound, 100.0);
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_GREATER, &bound));
+    count = Fabric_Predicate_select_column(&predicate, score_column, selection, &status);
+    assert(FABRIC_OK == status && PREDICATE_TEST_VERTICES - 200 == count);
+
+    // the predicate's kind must match the column's type
+    assert(0 == Fabric_Predicate_select_column(&predicate, age_column, selection, &status));
+    assert(FABRIC_PROPERTY_ERROR == status);
+
+    // a scan of the store's records sees changes that haven't been flushed
+    num_properties = graph.property_store.last_free_id - 1;
+    assert(num_properties <= PREDICATE_TEST_VERTICES * 2);
+    predicate_value(&bound, FABRIC_PROPTYPE_INTEGER, 50);
+    assert(FABRIC_OK == Fabric_Predicate_init(&predicate, FABRIC_PREDICATE_GREATER_EQUAL, &bound));
+    predicate_value(&value, FABRIC_PROPTYPE_INTEGER, 99);
+    predicate_set(&graph, 1, PREDICATE_TEST_AGE, &value);
+    ages[1] = 99;
+    predicate_value(&value, FABRIC_PROPTYPE_INTEGER, 1);
+    predicate_set(&graph, 2, PREDICATE_TEST_AGE, &value);
+    ages[2] = 1;
+    for (i = 0; i < 2; i++) {
+        count = Fabric_PropertyStore_select_properties(&graph.property_store, &predicate, PREDICATE_TEST_AGE,
+            1, num_properties, selection, &status);
+        assert(FABRIC_OK == status);
+        for (n = 1, expected = 0; n <= PREDICATE_TEST_VERTICES; n++) {
+            expected += n % 9 != 0 && ages[n] >= 50;
+        }
+        assert(expected == count);
+        n = Fabric_Predicate_get_selected_ids(selection, num_properties, NULL, 1, ids);
+        assert(n == count);
+        for (n = 0; n < count; n++) {
+            Property *p = Fabric_PropertyStore_get_property(&graph.property_store, ids[n], &status);
+            assert(FABRIC_OK == status);
+            match = predicate_matches(&predicate, p) && PREDICATE_TEST_AGE == Fabric_Property_get_label_id(p);
+            assert(match);
+        }
+        assert(FABRIC_OK == Fabric_PropertyStore_flush(&graph.property_store));
+    }
+
+    // the column was brought up to date by the flush
+    count = Fabric_Predicate_select_column(&predicate, age_column, selection, &status);
+    assert(FABRIC_OK == status && expected == count);
+
+    assert(0 == Fabric_PropertyStore_select_properties(&graph.property_store, &predicate, 0, 0, 1, selection, &status));
+    assert(FABRIC_PROPERTYSTORE_INVALID_ID == status);
+    assert(0 == Fabric_PropertyStore_select_properties(&graph.property_store, &predicate, 0, 1, num_properties + 1, selection, &status));
+    assert(FABRIC_PROPERTYSTORE_INVALID_ID == status);
+
+    Fabric_close_graph(&graph);
+    fclose(db_file);
+    remove(file_name);
+}
+
+void test_predicate() {
+    predicate_test_matches();
+    predicate_test_records();
+    predicate_test_graph();
+    printf("All tests passed for predicates.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_predicate();
+    return 0;
+}
+#endif
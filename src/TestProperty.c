@@ -3,16 +3,203 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 26, 2015
- * Updated: March 26, 2015
+ * Updated: October 14, 2026
  */
 
 #include <stdio.h>
 #include <assert.h>
 #ifndef _FABRIC_TEST_ALL__
-#include "Fabric.h"
-#include "Graph.c"
+#include "Fabric.c"
 #endif
 
+#define PROPERTY_TEST_LABELS 40
+
+/**
+ * Tests walking and searching a vertex's properties with an iterator
+ */
+static
+void property_test_iterator() {
+    FILE *db_file;
+    Graph graph;
+    PropertyIterator iterator;
+    Property *value, *p;
+    Class *c;
+    Vertex *v;
+    Edge e;
+    labelid_t labels[3], missing;
+    uint8_t data[FABRIC_PROPERTY_STORAGE_SIZE];
+    size_t mem_used;
+    error_t status;
+    int i, seen;
+
+    char *file_name = "test_property.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    c = Fabric_ClassStore_create_class(&graph.class_store, NULL, "Vertex", FALSE, &status);
+    assert(FABRIC_OK == status);
+    v = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+    assert(FABRIC_OK == status);
+    labels[0] = Fabric_LabelStore_add_label(&graph.label_store, "first", &status);
+    labels[1] = Fabric_LabelStore_add_label(&graph.label_store, "second", &status);
+    labels[2] = Fabric_LabelStore_add_label(&graph.label_store, "third", &status);
+    missing = Fabric_LabelStore_add_label(&graph.label_store, "missing", &status);
+    assert(FABRIC_OK == status);
+
+    value = Fabric_Property_new(0, &status);
+    assert(FABRIC_OK == status);
+    memset(data, 0, sizeof(data));
+    Fabric_Property_init(value, data);
+    Fabric_Property_set_type(value, FABRIC_PROPTYPE_INTEGER);
+    for (i = 0; i < 3; i++) {
+        Fabric_Property_set_integer_value(value, 100 + i);
+        assert(FABRIC_OK == Fabric_PropertyStore_set_vertex_property(&graph.property_store, v, labels[i], value));
+    }
+    Fabric_Property_destroy(value);
+
+    // every property is returned once, as a copy, without allocating
+    mem_used = Fabric_memused();
+    Fabric_PropertyIterator_init_vertex(&iterator, &graph, v);
+    for (seen = 0; NULL != (p = Fabric_PropertyIterator_next(&iterator, &status)); ) {
+        for (i = 0; i < 3 && labels[i] != Fabric_Property_get_label_id(p); i++);
+        assert(i < 3 && 0 == (seen & (1 << i)));
+        assert(100 + i == Fabric_Property_get_integer_value(p));
+        seen |= 1 << i;
+    }
+    assert(FABRIC_OK == status && 7 == seen);
+    assert(mem_used == Fabric_memused());
+
+    // finding a label stops at its property
+    Fabric_PropertyIterator_init_vertex(&iterator, &graph, v);
+    p = Fabric_PropertyIterator_find(&iterator, labels[1], &status);
+    assert(FABRIC_OK == status && 101 == Fabric_Property_get_integer_value(p));
+    assert(p != Fabric_PropertyStore_get_vertex_property(&graph.property_store, v, labels[1], &status));
+    assert(NULL == Fabric_PropertyIterator_find(&iterator, labels[1], &status));
+    assert(FABRIC_PROPERTY_DOESNT_EXIST == status);
+    Fabric_PropertyIterator_init_vertex(&iterator, &graph, v);
+    assert(NULL == Fabric_PropertyIterator_find(&iterator, missing, &status));
+    assert(FABRIC_PROPERTY_DOESNT_EXIST == status);
+
+    // an entity without properties has nothing to walk
+    Fabric_Edge_set_first_property_id(&e, 0);
+    Fabric_PropertyIterator_init_edge(&iterator, &graph, &e);
+    assert(NULL == Fabric_PropertyIterator_next(&iterator, &status) && FABRIC_OK == status);
+
+    Fabric_close_graph(&graph);
+    fclose(db_file);
+    remove(file_name);
+}
+
+/**
+ * Tests looking up the properties of a vertex with a property directory
+ */
+static
+void property_test_directory() {
+    FILE *db_file;
+    Graph graph;
+    GraphStats stats;
+    PropertyDirectory *directory;
+    Property *value, *p, *removed;
+    Class *c;
+    Vertex *v, *few;
+    labelid_t labels[PROPERTY_TEST_LABELS], missing;
+    uint8_t data[FABRIC_PROPERTY_STORAGE_SIZE];
+    char name[24];
+    error_t status;
+    int i;
+
+    char *file_name = "test_property_directory.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    c = Fabric_ClassStore_create_class(&graph.class_store, NULL, "Vertex", FALSE, &status);
+    assert(FABRIC_OK == status);
+    v = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+    assert(FABRIC_OK == status);
+    few = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+    assert(FABRIC_OK == status);
+    for (i = 0; i < PROPERTY_TEST_LABELS; i++) {
+        sprintf(name, "label%d", i);
+        labels[i] = Fabric_LabelStore_add_label(&graph.label_store, name, &status);
+        assert(FABRIC_OK == status);
+    }
+    missing = Fabric_LabelStore_add_label(&graph.label_store, "missing", &status);
+    assert(FABRIC_OK == status);
+
+    value = Fabric_Property_new(0, &status);
+    assert(FABRIC_OK == status);
+    memset(data, 0, sizeof(data));
+    Fabric_Property_init(value, data);
+    Fabric_Property_set_type(value, FABRIC_PROPTYPE_INTEGER);
+    for (i = 0; i < PROPERTY_TEST_LABELS; i++) {
+        Fabric_Property_set_integer_value(value, 1000 + i);
+        assert(FABRIC_OK == Fabric_PropertyStore_set_vertex_property(&graph.property_store, v, labels[i], value));
+    }
+    for (i = 0; i < 3; i++) {
+        assert(FABRIC_OK == Fabric_PropertyStore_set_vertex_property(&graph.property_store, few, labels[i], value));
+    }
+    assert(FABRIC_OK == Fabric_Graph_flush_stores(&graph));
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+    v = Fabric_VertexStore_get_vertex(&graph.vertex_store, 1, &status);
+    few = Fabric_VertexStore_get_vertex(&graph.vertex_store, 2, &status);
+    assert(FABRIC_OK == status);
+
+    // the first lookup past the end of a long list builds its directory
+    assert(NULL == graph.property_store.directories);
+    p = Fabric_PropertyStore_get_vertex_property(&graph.property_store, v, labels[0], &status);
+    assert(FABRIC_OK == status && 1000 == Fabric_Property_get_integer_value(p));
+    directory = Fabric_EntityCache_get(graph.property_store.directories, Fabric_Vertex_get_id(v));
+    assert(NULL != directory && PROPERTY_TEST_LABELS == Fabric_PropertyDirectory_get_count(directory));
+    for (i = 0; i < PROPERTY_TEST_LABELS; i++) {
+        p = Fabric_PropertyStore_get_vertex_property(&graph.property_store, v, labels[i], &status);
+        assert(FABRIC_OK == status && labels[i] == Fabric_Property_get_label_id(p));
+        assert(1000 + i == Fabric_Property_get_integer_value(p));
+    }
+
+    // a label the vertex doesn't have is found missing without any reads
+    Fabric_stats_reset();
+    assert(NULL == Fabric_PropertyStore_get_vertex_property(&graph.property_store, v, missing, &status));
+    assert(FABRIC_PROPERTY_DOESNT_EXIST == status);
+    Fabric_Graph_get_stats(&graph, &stats);
+#ifndef FABRIC_NO_STATS
+    assert(0 == stats.stores[FABRIC_STATS_PROPERTY_STORE].records_read);
+#endif
+
+    // a short list is walked as before
+    p = Fabric_PropertyStore_get_vertex_property(&graph.property_store, few, labels[0], &status);
+    assert(FABRIC_OK == status && labels[0] == Fabric_Property_get_label_id(p));
+    assert(NULL == Fabric_EntityCache_get(graph.property_store.directories, Fabric_Vertex_get_id(few)));
+
+    // the directory follows properties being removed, added and changed,
+    // and a removed property's cached object is reused with its id
+    removed = Fabric_PropertyStore_get_vertex_property(&graph.property_store, v, labels[5], &status);
+    assert(FABRIC_OK == status);
+    assert(FABRIC_OK == Fabric_PropertyStore_remove_vertex_property(&graph.property_store, v, labels[5]));
+    assert(NULL == Fabric_PropertyStore_get_vertex_property(&graph.property_store, v, labels[5], &status));
+    assert(FABRIC_PROPERTY_DOESNT_EXIST == status);
+    assert(PROPERTY_TEST_LABELS - 1 == Fabric_PropertyDirectory_get_count(directory));
+    Fabric_Property_set_integer_value(value, 5);
+    assert(FABRIC_OK == Fabric_PropertyStore_set_vertex_property(&graph.property_store, v, labels[5], value));
+    Fabric_Property_set_integer_value(value, 6);
+    assert(FABRIC_OK == Fabric_PropertyStore_set_vertex_property(&graph.property_store, v, labels[6], value));
+    assert(PROPERTY_TEST_LABELS == Fabric_PropertyDirectory_get_count(directory));
+    p = Fabric_PropertyStore_get_vertex_property(&graph.property_store, v, labels[5], &status);
+    assert(FABRIC_OK == status && 5 == Fabric_Property_get_integer_value(p));
+    assert(p == removed);
+    p = Fabric_PropertyStore_get_vertex_property(&graph.property_store, v, labels[6], &status);
+    assert(FABRIC_OK == status && 6 == Fabric_Property_get_integer_value(p));
+    Fabric_Property_destroy(value);
+
+    Fabric_close_graph(&graph);
+    fclose(db_file);
+    remove(file_name);
+}
+
 void test_property() {
     Property p;
     uint8_t data[17] = {
@@ -88,12 +275,16 @@ void test_property() {
     assert(TRUE == Fabric_Property_is_boolean(&p));
     assert(FALSE == Fabric_Property_get_boolean_value(&p));
 
+    property_test_iterator();
+    property_test_directory();
+
     printf("All unit tests passed for property.\n");
 
 }
 
 #ifndef _FABRIC_TEST_ALL__
 int main() {
+    Fabric_meminit();
     test_property();
     return 0;
 }
@@ -0,0 +1,303 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+#define PROPERTY_COLUMN_TEST_VERTICES 7000
+#define PROPERTY_COLUMN_TEST_BACKFILLED 3000
+#define PROPERTY_COLUMN_TEST_AGE 1
+#define PROPERTY_COLUMN_TEST_SCORE 2
+#define PROPERTY_COLUMN_TEST_FLAG 3
+
+/**
+ * The values the test expects each vertex to have; a vertex whose has_
+ * field is 0 has a null in that column
+ */
+typedef struct PropertyColumnExpected {
+    classid_t class_id[PROPERTY_COLUMN_TEST_VERTICES + 2];
+    bool_t has_age[PROPERTY_COLUMN_TEST_VERTICES + 2];
+    bool_t has_score[PROPERTY_COLUMN_TEST_VERTICES + 2];
+    bool_t has_flag[PROPERTY_COLUMN_TEST_VERTICES + 2];
+    int64_t age[PROPERTY_COLUMN_TEST_VERTICES + 2];
+    float64_t score[PROPERTY_COLUMN_TEST_VERTICES + 2];
+    bool_t flag[PROPERTY_COLUMN_TEST_VERTICES + 2];
+} PropertyColumnExpected;
+
+static PropertyColumnExpected property_column_expected;
+
+/**
+ * Sets a vertex's property to a value of a type
+ */
+static
+void property_column_set(Graph *graph, vertexid_t vertex_id, labelid_t label_id, uint8_t type, uint64_t bits) {
+    uint8_t data[FABRIC_PROPERTY_STORAGE_SIZE];
+    error_t status;
+    Property *p = Fabric_Property_new(0, &status);
+    Vertex *v;
+
+    assert(FABRIC_OK == status);
+    memset(data, 0, sizeof(data));
+    Fabric_Property_init(p, data);
+    Fabric_Property_set_type(p, type);
+    Fabric_Property_set_integer_value(p, (int64_t)bits);
+    v = Fabric_VertexStore_get_vertex(&graph->vertex_store, vertex_id, &status);
+    assert(FABRIC_OK == status);
+    assert(FABRIC_OK == Fabric_PropertyStore_set_vertex_property(&graph->property_store, v, label_id, p));
+    Fabric_Property_destroy(p);
+}
+
+static
+void property_column_set_real(Graph *graph, vertexid_t vertex_id, labelid_t label_id, float64_t value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    property_column_set(graph, vertex_id, label_id, FABRIC_PROPTYPE_REAL, bits);
+}
+
+/**
+ * Gives a test vertex its age, score and flag; every tenth vertex has no
+ * age
+ */
+static
+void property_column_set_vertex(Graph *graph, vertexid_t i) {
+    PropertyColumnExpected *e = &property_column_expected;
+    if (i % 10 != 0) {
+        e->has_age[i] = TRUE;
+        e->age[i] = (int64_t)(i % 97) - 40;
+        property_column_set(graph, i, PROPERTY_COLUMN_TEST_AGE, FABRIC_PROPTYPE_INTEGER, e->age[i]);
+    }
+    e->has_score[i] = TRUE;
+    e->score[i] = ((float64_t)i - 3000.0) * 0.25;
+    property_column_set_real(graph, i, PROPERTY_COLUMN_TEST_SCORE, e->score[i]);
+    e->has_flag[i] = TRUE;
+    e->flag[i] = i % 3 == 0;
+    property_column_set(graph, i, PROPERTY_COLUMN_TEST_FLAG, e->flag[i] ? FABRIC_PROPTYPE_TRUE : FABRIC_PROPTYPE_FALSE, 0);
+}
+
+/**
+ * Scans the columns of class 1, checking every row against the expected
+ * values and that every vertex of the class has exactly one row in order
+ */
+static
+void property_column_check(Graph *graph, vertexid_t num_vertices) {
+    PropertyColumnExpected *e = &property_column_expected;
+    PropertyColumn *ages, *scores, *flags;
+    const vertexid_t *vertex_ids;
+    const int64_t *age_values;
+    const float64_t *score_values;
+    const uint8_t *flag_values, *nulls;
+    int64_t age_sum = 0, expected_sum = 0;
+    uint32_t num_rows, row, found, num_flags = 0, expected_flags = 0;
+    vertexid_t i, previous = 0;
+    error_t status;
+
+    ages = Fabric_IndexStore_get_property_column(&graph->index_store, 1, PROPERTY_COLUMN_TEST_AGE, &status);
+    assert(FABRIC_OK == status && NULL != ages);
+    scores = Fabric_IndexStore_get_property_column(&graph->index_store, 1, PROPERTY_COLUMN_TEST_SCORE, &status);
+    assert(FABRIC_OK == status && NULL != scores);
+    flags = Fabric_IndexStore_get_property_column(&graph->index_store, 1, PROPERTY_COLUMN_TEST_FLAG, &status);
+    assert(FABRIC_OK == status && NULL != flags);
+    assert(FABRIC_COLUMN_INTEGER == Fabric_PropertyColumn_get_type(ages));
+    assert(1 == Fabric_PropertyColumn_get_class_id(ages));
+    assert(PROPERTY_COLUMN_TEST_SCORE == Fabric_PropertyColumn_get_label_id(scores));
+
+    // each column only hands out the array of its own type
+    age_values = Fabric_PropertyColumn_get_integers(ages);
+    score_values = Fabric_PropertyColumn_get_reals(scores);
+    flag_values = Fabric_PropertyColumn_get_booleans(flags);
+    assert(NULL != age_values && NULL != score_values && NULL != flag_values);
+    assert(NULL == Fabric_PropertyColumn_get_reals(ages));
+    assert(NULL == Fabric_PropertyColumn_get_booleans(scores));
+    assert(NULL == Fabric_PropertyColumn_get_integers(flags));
+
+    // a sequential scan of the age column
+    num_rows = Fabric_PropertyColumn_get_row_count(ages);
+    vertex_ids = Fabric_PropertyColumn_get_vertex_ids(ages);
+    nulls = Fabric_PropertyColumn_get_nulls(ages);
+    for (row = 0; row < num_rows; row++) {
+        i = vertex_ids[row];
+        assert(i <= num_vertices && 1 == e->class_id[i]);
+        assert(i > previous || i == PROPERTY_COLUMN_TEST_VERTICES + 1);
+        previous = i;
+        assert(((nulls[row / 8] >> (row % 8)) & 1) == !e->has_age[i]);
+        if (e->has_age[i]) {
+            assert(age_values[row] == e->age[i]);
+            age_sum += age_values[row];
+        }
+    }
+
+    for (i = 1; i <= num_vertices; i++) {
+        if (1 != e->class_id[i]) {
+            assert(!Fabric_PropertyColumn_find_row(ages, i, &found));
+            continue;
+        }
+        if (e->has_age[i]) {
+            expected_sum += e->age[i];
+        }
+        assert(Fabric_PropertyColumn_find_row(ages, i, &found));
+        assert(vertex_ids[found] == i);
+        assert(Fabric_PropertyColumn_find_row(scores, i, &found));
+        assert(Fabric_PropertyColumn_is_null(scores, found) == !e->has_score[i]);
+        if (e->has_score[i]) {
+            assert(score_values[found] == e->score[i]);
+        }
+        assert(Fabric_PropertyColumn_find_row(flags, i, &found));
+        assert(Fabric_PropertyColumn_is_null(flags, found) == !e->has_flag[i]);
+        if (e->has_flag[i]) {
+            assert(flag_values[found] == (e->flag[i] ? 1 : 0));
+            expected_flags += e->flag[i];
+        }
+    }
+    assert(age_sum == expected_sum);
+
+    num_rows = Fabric_PropertyColumn_get_row_count(flags);
+    for (row = 0; row < num_rows; row++) {
+        num_flags += flag_values[row];
+    }
+    assert(num_flags == expected_flags);
+}
+
+void test_property_column() {
+    PropertyColumnExpected *e = &property_column_expected;
+    FILE *db_file;
+    Graph graph;
+    Class *c;
+    Vertex *v;
+    PropertyColumn *column;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    uint32_t class_rows = 0;
+    error_t status;
+    vertexid_t i;
+    classid_t class_id;
+
+    memset(e, 0, sizeof(*e));
+    char *file_name = "test_property_column.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    for (class_id = 1; class_id <= 2; class_id++) {
+        c = Fabric_Class_new(class_id, &status);
+        assert(FABRIC_OK == status);
+        memset(class_data, 0, sizeof(class_data));
+        Fabric_Class_init(c, class_data);
+        Fabric_Class_set_label_id(c, class_id);
+        assert(FABRIC_OK == Fabric_ClassStore_update_class(&graph.class_store, c));
+    }
+
+    // every seventh vertex is of a class without columns
+    for (i = 1; i <= PROPERTY_COLUMN_TEST_VERTICES; i++) {
+        e->class_id[i] = (i % 7 == 0) ? 2 : 1;
+        class_rows += 1 == e->class_id[i];
+        c = Fabric_ClassStore_get_class(&graph.class_store, e->class_id[i], &status);
+        assert(FABRIC_OK == status);
+        v = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+        assert(FABRIC_OK == status && i == Fabric_Vertex_get_id(v));
+    }
+
+    // the first vertices' values are copied when the columns are created
+    for (i = 1; i <= PROPERTY_COLUMN_TEST_BACKFILLED; i++) {
+        property_column_set_vertex(&graph, i);
+    }
+    column = Fabric_IndexStore_get_property_column(&graph.index_store, 1, PROPERTY_COLUMN_TEST_AGE, &status);
+    assert(NULL == column && FABRIC_INDEX_DOESNT_EXIST == status);
+    column = Fabric_IndexStore_create_property_column(&graph.index_store, 1, PROPERTY_COLUMN_TEST_AGE, FABRIC_COLUMN_INTEGER, &status);
+    assert(FABRIC_OK == status && NULL != column);
+    assert(class_rows == Fabric_PropertyColumn_get_row_count(column));
+    assert(NULL == Fabric_IndexStore_create_property_column(&graph.index_store, 1, PROPERTY_COLUMN_TEST_AGE, FABRIC_COLUMN_REAL, &status));
+    assert(FABRIC_INDEX_ERROR == status);
+    assert(NULL == Fabric_IndexStore_create_property_column(&graph.index_store, 2, PROPERTY_COLUMN_TEST_AGE, 7, &status));
+    assert(FABRIC_INDEX_ERROR == status);
+    column = Fabric_IndexStore_create_property_column(&graph.index_store, 1, PROPERTY_COLUMN_TEST_SCORE, FABRIC_COLUMN_REAL, &status);
+    assert(FABRIC_OK == status && NULL != column);
+    column = Fabric_IndexStore_create_property_column(&graph.index_store, 1, PROPERTY_COLUMN_TEST_FLAG, FABRIC_COLUMN_BOOLEAN, &status);
+    assert(FABRIC_OK == status && NULL != column);
+    property_column_check(&graph, PROPERTY_COLUMN_TEST_VERTICES);
+
+    // the rest reach the columns as the property store is flushed
+    for (i = PROPERTY_COLUMN_TEST_BACKFILLED + 1; i <= PROPERTY_COLUMN_TEST_VERTICES; i++) {
+        property_column_set_vertex(&graph, i);
+    }
+    assert(FABRIC_OK == Fabric_PropertyStore_flush(&graph.property_store));
+    property_column_check(&graph, PROPERTY_COLUMN_TEST_VERTICES);
+
+    // changes to properties without a column aren't logged
+    property_column_set(&graph, 7, PROPERTY_COLUMN_TEST_AGE, FABRIC_PROPTYPE_INTEGER, 5);
+    assert(0 == graph.property_store.num_index_changes);
+
+    // updates, removals and values of the wrong type
+    property_column_set(&graph, 8, PROPERTY_COLUMN_TEST_AGE, FABRIC_PROPTYPE_INTEGER, 1000);
+    e->age[8] = 1000;
+    v = Fabric_VertexStore_get_vertex(&graph.vertex_store, 11, &status);
+    assert(FABRIC_OK == status);
+    assert(FABRIC_OK == Fabric_PropertyStore_remove_vertex_property(&graph.property_store, v, PROPERTY_COLUMN_TEST_AGE));
+    e->has_age[11] = FALSE;
+    property_column_set(&graph, 9, PROPERTY_COLUMN_TEST_AGE, FABRIC_PROPTYPE_TRUE, 0);
+    e->has_age[9] = FALSE;
+    property_column_set(&graph, 20, PROPERTY_COLUMN_TEST_AGE, FABRIC_PROPTYPE_INTEGER, 3);
+    e->has_age[20] = TRUE;
+    e->age[20] = 3;
+    property_column_set(&graph, 6000, PROPERTY_COLUMN_TEST_FLAG, FABRIC_PROPTYPE_INTEGER, 1);
+    e->has_flag[6000] = FALSE;
+    assert(FABRIC_OK == Fabric_PropertyStore_flush(&graph.property_store));
+    property_column_check(&graph, PROPERTY_COLUMN_TEST_VERTICES);
+
+    // a new vertex gets the next row when its property is set
+    c = Fabric_ClassStore_get_class(&graph.class_store, 1, &status);
+    assert(FABRIC_OK == status);
+    v = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+    assert(FABRIC_OK == status && PROPERTY_COLUMN_TEST_VERTICES + 1 == Fabric_Vertex_get_id(v));
+    e->class_id[PROPERTY_COLUMN_TEST_VERTICES + 1] = 1;
+    property_column_set_vertex(&graph, PROPERTY_COLUMN_TEST_VERTICES + 1);
+    assert(FABRIC_OK == Fabric_PropertyStore_flush(&graph.property_store));
+    column = Fabric_IndexStore_get_property_column(&graph.index_store, 1, PROPERTY_COLUMN_TEST_AGE, &status);
+    assert(class_rows + 1 == Fabric_PropertyColumn_get_row_count(column));
+    property_column_check(&graph, PROPERTY_COLUMN_TEST_VERTICES + 1);
+
+    // the age column spans pages and the flag column fits in one
+    assert(1 < column->num_pages);
+    column = Fabric_IndexStore_get_property_column(&graph.index_store, 1, PROPERTY_COLUMN_TEST_FLAG, &status);
+    assert(1 == column->num_pages);
+
+    assert(FABRIC_OK == Fabric_ClassStore_flush(&graph.class_store));
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph.vertex_store));
+    Fabric_close_graph(&graph);
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+
+    // the columns are read back from their pages and stay in sync
+    Fabric_load_graph(db_file, &graph);
+    property_column_check(&graph, PROPERTY_COLUMN_TEST_VERTICES + 1);
+    property_column_set(&graph, 12, PROPERTY_COLUMN_TEST_AGE, FABRIC_PROPTYPE_INTEGER, 77);
+    e->age[12] = 77;
+    property_column_set_real(&graph, 6500, PROPERTY_COLUMN_TEST_SCORE, -1.5);
+    e->score[6500] = -1.5;
+    assert(FABRIC_OK == Fabric_PropertyStore_flush(&graph.property_store));
+    Fabric_close_graph(&graph);
+
+    Fabric_load_graph(db_file, &graph);
+    property_column_check(&graph, PROPERTY_COLUMN_TEST_VERTICES + 1);
+    Fabric_close_graph(&graph);
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for property columns.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_property_column();
+    return 0;
+}
+#endif
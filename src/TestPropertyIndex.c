@@ -0,0 +1,357 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+#define PROPERTY_INDEX_TEST_VERTICES 600
+#define PROPERTY_INDEX_TEST_BACKFILLED 200
+#define PROPERTY_INDEX_TEST_AGE 1
+#define PROPERTY_INDEX_TEST_SCORE 2
+#define PROPERTY_INDEX_TEST_NAME 3
+
+/**
+ * The values the test expects each vertex to have; a vertex whose
+ * has_age is 0 has no age property
+ */
+typedef struct PropertyIndexExpected {
+    classid_t class_id[PROPERTY_INDEX_TEST_VERTICES + 1];
+    bool_t has_age[PROPERTY_INDEX_TEST_VERTICES + 1];
+    int64_t age[PROPERTY_INDEX_TEST_VERTICES + 1];
+    float64_t score[PROPERTY_INDEX_TEST_VERTICES + 1];
+    char name[PROPERTY_INDEX_TEST_VERTICES + 1][9];
+} PropertyIndexExpected;
+
+static PropertyIndexExpected property_index_expected;
+
+/**
+ * Creates a property to hold a value of a type; it must be destroyed
+ */
+static
+Property *property_index_value(uint8_t type) {
+    uint8_t data[FABRIC_PROPERTY_STORAGE_SIZE];
+    error_t status;
+    Property *p = Fabric_Property_new(0, &status);
+    assert(FABRIC_OK == status);
+    memset(data, 0, sizeof(data));
+    Fabric_Property_init(p, data);
+    Fabric_Property_set_type(p, type);
+    return p;
+}
+
+static
+Property *property_index_integer(uint8_t type, int64_t value) {
+    Property *p = property_index_value(type);
+    Fabric_Property_set_integer_value(p, value);
+    return p;
+}
+
+static
+Property *property_index_real(float64_t value) {
+    Property *p = property_index_value(FABRIC_PROPTYPE_REAL);
+    Fabric_Property_set_real_value(p, value);
+    return p;
+}
+
+static
+Property *property_index_text(const char *value) {
+    Property *p = property_index_value(FABRIC_PROPTYPE_EMPTYTEXT + strlen(value));
+    Fabric_Property_set_short_text(p, (text_t)value);
+    return p;
+}
+
+/**
+ * Sets a vertex's property to a value and destroys the value
+ */
+static
+void property_index_set(Graph *graph, vertexid_t vertex_id, labelid_t label_id, Property *value) {
+    error_t status;
+    Vertex *v = Fabric_VertexStore_get_vertex(&graph->vertex_store, vertex_id, &status);
+    assert(FABRIC_OK == status);
+    assert(FABRIC_OK == Fabric_PropertyStore_set_vertex_property(&graph->property_store, v, label_id, value));
+    Fabric_Property_destroy(value);
+}
+
+/**
+ * Gives a test vertex its age, score and name
+ */
+static
+void property_index_set_vertex(Graph *graph, vertexid_t i) {
+    PropertyIndexExpected *e = &property_index_expected;
+    e->has_age[i] = TRUE;
+    e->age[i] = (int64_t)(i % 97) - 40;
+    e->score[i] = ((float64_t)i - 300.0) * 0.25;
+    sprintf(e->name[i], "n%u", (unsigned)(i % 150));
+    property_index_set(graph, i, PROPERTY_INDEX_TEST_AGE, property_index_integer(FABRIC_PROPTYPE_INTEGER, e->age[i]));
+    property_index_set(graph, i, PROPERTY_INDEX_TEST_SCORE, property_index_real(e->score[i]));
+    property_index_set(graph, i, PROPERTY_INDEX_TEST_NAME, property_index_text(e->name[i]));
+}
+
+/**
+ * Scans a property index, checking that the vertices come out in order and
+ * are the ones of class 1 for which in_range is true
+ */
+static
+void property_index_check(PropertyIndex *index, Property *low, bool_t low_inclusive, Property *high, bool_t high_inclusive,
+        bool_t (*in_range)(vertexid_t id), int (*compare)(vertexid_t a, vertexid_t b)) {
+    PropertyIndexExpected *e = &property_index_expected;
+    PropertyIndexCursor cursor;
+    uint8_t seen[PROPERTY_INDEX_TEST_VERTICES + 1];
+    vertexid_t id, previous = 0;
+    uint32_t count = 0, expected = 0;
+    error_t status;
+
+    memset(seen, 0, sizeof(seen));
+    assert(FABRIC_OK == Fabric_PropertyIndexCursor_init(&cursor, index, low, low_inclusive, high, high_inclusive));
+    while (0 != (id = Fabric_PropertyIndexCursor_next(&cursor, &status))) {
+        assert(FABRIC_OK == status);
+        assert(id <= PROPERTY_INDEX_TEST_VERTICES && !seen[id]);
+        assert(1 == e->class_id[id] && in_range(id));
+        if (previous != 0) {
+            assert(compare(previous, id) < 0 || (compare(previous, id) == 0 && previous < id));
+        }
+        seen[id] = 1;
+        previous = id;
+        count++;
+    }
+    assert(FABRIC_OK == status);
+    assert(0 == Fabric_PropertyIndexCursor_next(&cursor, &status));
+
+    for (id = 1; id <= PROPERTY_INDEX_TEST_VERTICES; id++) {
+        if (1 == e->class_id[id] && in_range(id)) {
+            expected++;
+        }
+    }
+    assert(expected == count);
+}
+
+static int property_index_compare_age(vertexid_t a, vertexid_t b) {
+    PropertyIndexExpected *e = &property_index_expected;
+    return e->age[a] < e->age[b] ? -1 : e->age[a] > e->age[b];
+}
+
+static int property_index_compare_score(vertexid_t a, vertexid_t b) {
+    PropertyIndexExpected *e = &property_index_expected;
+    return e->score[a] < e->score[b] ? -1 : e->score[a] > e->score[b];
+}
+
+static int property_index_compare_name(vertexid_t a, vertexid_t b) {
+    return strcmp(property_index_expected.name[a], property_index_expected.name[b]);
+}
+
+static bool_t property_index_age_is_12(vertexid_t id) {
+    return property_index_expected.has_age[id] && 12 == property_index_expected.age[id];
+}
+
+static bool_t property_index_age_over_30(vertexid_t id) {
+    return property_index_expected.has_age[id] && property_index_expected.age[id] > 30;
+}
+
+static bool_t property_index_age_to_0(vertexid_t id) {
+    return property_index_expected.has_age[id] && property_index_expected.age[id] <= 0;
+}
+
+static bool_t property_index_age_is_1000(vertexid_t id) {
+    return property_index_expected.has_age[id] && 1000 == property_index_expected.age[id];
+}
+
+static bool_t property_index_score_negative(vertexid_t id) {
+    return property_index_expected.score[id] < 0.0;
+}
+
+static bool_t property_index_score_near_0(vertexid_t id) {
+    return property_index_expected.score[id] >= -10.0 && property_index_expected.score[id] <= 10.0;
+}
+
+static bool_t property_index_name_n10s(vertexid_t id) {
+    return strcmp(property_index_expected.name[id], "n10") >= 0 && strcmp(property_index_expected.name[id], "n11") < 0;
+}
+
+/**
+ * Checks the range scans of the age, score and name indices
+ */
+static
+void property_index_check_all(Graph *graph) {
+    PropertyIndex *ages, *scores, *names;
+    Property *low, *high;
+    error_t status;
+
+    ages = Fabric_IndexStore_get_property_index(&graph->index_store, 1, PROPERTY_INDEX_TEST_AGE, &status);
+    assert(FABRIC_OK == status && NULL != ages);
+    scores = Fabric_IndexStore_get_property_index(&graph->index_store, 1, PROPERTY_INDEX_TEST_SCORE, &status);
+    assert(FABRIC_OK == status && NULL != scores);
+    names = Fabric_IndexStore_get_property_index(&graph->index_store, 1, PROPERTY_INDEX_TEST_NAME, &status);
+    assert(FABRIC_OK == status && NULL != names);
+
+    // equality
+    low = property_index_integer(FABRIC_PROPTYPE_INTEGER, 12);
+    property_index_check(ages, low, TRUE, low, TRUE, property_index_age_is_12, property_index_compare_age);
+    Fabric_Property_destroy(low);
+
+    // open ranges
+    low = property_index_integer(FABRIC_PROPTYPE_INTEGER, 30);
+    property_index_check(ages, low, FALSE, NULL, FALSE, property_index_age_over_30, property_index_compare_age);
+    Fabric_Property_destroy(low);
+    high = property_index_integer(FABRIC_PROPTYPE_INTEGER, 0);
+    property_index_check(ages, NULL, FALSE, high, TRUE, property_index_age_to_0, property_index_compare_age);
+    Fabric_Property_destroy(high);
+    low = property_index_integer(FABRIC_PROPTYPE_INTEGER, 1000);
+    property_index_check(ages, low, TRUE, low, TRUE, property_index_age_is_1000, property_index_compare_age);
+    Fabric_Property_destroy(low);
+
+    // reals, including negative ones
+    high = property_index_real(0.0);
+    property_index_check(scores, NULL, FALSE, high, FALSE, property_index_score_negative, property_index_compare_score);
+    Fabric_Property_destroy(high);
+    low = property_index_real(-10.0);
+    high = property_index_real(10.0);
+    property_index_check(scores, low, TRUE, high, TRUE, property_index_score_near_0, property_index_compare_score);
+    Fabric_Property_destroy(low);
+    Fabric_Property_destroy(high);
+
+    // short texts of different lengths
+    low = property_index_text("n10");
+    high = property_index_text("n11");
+    property_index_check(names, low, TRUE, high, FALSE, property_index_name_n10s, property_index_compare_name);
+    Fabric_Property_destroy(low);
+    Fabric_Property_destroy(high);
+}
+
+void test_property_index() {
+    PropertyIndexExpected *e = &property_index_expected;
+    FILE *db_file;
+    Graph graph;
+    Class *c;
+    Vertex *v;
+    PropertyIndex *index;
+    PropertyIndexCursor cursor;
+    Property *low, *high;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    error_t status;
+    vertexid_t i;
+    classid_t class_id;
+
+    char *file_name = "test_property_index.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    for (class_id = 1; class_id <= 2; class_id++) {
+        c = Fabric_Class_new(class_id, &status);
+        assert(FABRIC_OK == status);
+        memset(class_data, 0, sizeof(class_data));
+        Fabric_Class_init(c, class_data);
+        Fabric_Class_set_label_id(c, class_id);
+        assert(FABRIC_OK == Fabric_ClassStore_update_class(&graph.class_store, c));
+    }
+
+    // every seventh vertex is of a class without indices
+    for (i = 1; i <= PROPERTY_INDEX_TEST_VERTICES; i++) {
+        e->class_id[i] = (i % 7 == 0) ? 2 : 1;
+        c = Fabric_ClassStore_get_class(&graph.class_store, e->class_id[i], &status);
+        assert(FABRIC_OK == status);
+        v = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+        assert(FABRIC_OK == status && i == Fabric_Vertex_get_id(v));
+    }
+
+    // the values of the first vertices are indexed when the indices are created
+    for (i = 1; i <= PROPERTY_INDEX_TEST_BACKFILLED; i++) {
+        property_index_set_vertex(&graph, i);
+    }
+    index = Fabric_IndexStore_get_property_index(&graph.index_store, 1, PROPERTY_INDEX_TEST_AGE, &status);
+    assert(NULL == index && FABRIC_INDEX_DOESNT_EXIST == status);
+    index = Fabric_IndexStore_create_property_index(&graph.index_store, 1, PROPERTY_INDEX_TEST_AGE, &status);
+    assert(FABRIC_OK == status && NULL != index);
+    assert(NULL == Fabric_IndexStore_create_property_index(&graph.index_store, 1, PROPERTY_INDEX_TEST_AGE, &status));
+    assert(FABRIC_INDEX_ERROR == status);
+    // small nodes make the later values split the tree several levels deep
+    index->max_leaf_keys = 4;
+    index->max_branch_keys = 3;
+    index = Fabric_IndexStore_create_property_index(&graph.index_store, 1, PROPERTY_INDEX_TEST_SCORE, &status);
+    assert(FABRIC_OK == status && NULL != index);
+    index = Fabric_IndexStore_create_property_index(&graph.index_store, 1, PROPERTY_INDEX_TEST_NAME, &status);
+    assert(FABRIC_OK == status && NULL != index);
+    index->max_leaf_keys = 5;
+    index->max_branch_keys = 4;
+
+    // the rest are indexed as the property store is flushed
+    for (i = PROPERTY_INDEX_TEST_BACKFILLED + 1; i <= PROPERTY_INDEX_TEST_VERTICES; i++) {
+        property_index_set_vertex(&graph, i);
+    }
+    assert(FABRIC_OK == Fabric_PropertyStore_flush(&graph.property_store));
+    assert(100 < graph.index_store.page_count);
+    property_index_check_all(&graph);
+
+    // updates and removals reach the index on the next flush
+    property_index_set(&graph, 8, PROPERTY_INDEX_TEST_AGE, property_index_integer(FABRIC_PROPTYPE_INTEGER, 1000));
+    property_index_set(&graph, 300, PROPERTY_INDEX_TEST_AGE, property_index_integer(FABRIC_PROPTYPE_INTEGER, 1000));
+    e->age[8] = e->age[300] = 1000;
+    v = Fabric_VertexStore_get_vertex(&graph.vertex_store, 12 + 97, &status);
+    assert(FABRIC_OK == status);
+    assert(FABRIC_OK == Fabric_PropertyStore_remove_vertex_property(&graph.property_store, v, PROPERTY_INDEX_TEST_AGE));
+    assert(FABRIC_PROPERTY_DOESNT_EXIST ==
+        Fabric_PropertyStore_remove_vertex_property(&graph.property_store, v, PROPERTY_INDEX_TEST_AGE));
+    e->has_age[12 + 97] = FALSE;
+    // a value that can't be indexed leaves the vertex out of the index
+    property_index_set(&graph, 9, PROPERTY_INDEX_TEST_AGE, property_index_value(FABRIC_PROPTYPE_TRUE));
+    e->has_age[9] = FALSE;
+    assert(FABRIC_OK == Fabric_PropertyStore_flush(&graph.property_store));
+    property_index_check_all(&graph);
+
+    // ranges need an end and both ends must be comparable
+    index = Fabric_IndexStore_get_property_index(&graph.index_store, 1, PROPERTY_INDEX_TEST_AGE, &status);
+    assert(FABRIC_INDEX_ERROR == Fabric_PropertyIndexCursor_init(&cursor, index, NULL, TRUE, NULL, TRUE));
+    low = property_index_integer(FABRIC_PROPTYPE_INTEGER, 1);
+    high = property_index_real(2.0);
+    assert(FABRIC_INDEX_ERROR == Fabric_PropertyIndexCursor_init(&cursor, index, low, TRUE, high, TRUE));
+    Fabric_Property_destroy(low);
+    Fabric_Property_destroy(high);
+
+    assert(FABRIC_OK == Fabric_ClassStore_flush(&graph.class_store));
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph.vertex_store));
+    Fabric_close_graph(&graph);
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+
+    // the indices and their directory are read back from their pages
+    Fabric_load_graph(db_file, &graph);
+    property_index_check_all(&graph);
+    property_index_set(&graph, 12, PROPERTY_INDEX_TEST_AGE, property_index_integer(FABRIC_PROPTYPE_INTEGER, 1000));
+    e->age[12] = 1000;
+    assert(FABRIC_OK == Fabric_PropertyStore_flush(&graph.property_store));
+    property_index_check_all(&graph);
+    Fabric_close_graph(&graph);
+
+    // the values are stored in the property store
+    Fabric_load_graph(db_file, &graph);
+    v = Fabric_VertexStore_get_vertex(&graph.vertex_store, 300, &status);
+    assert(FABRIC_OK == status);
+    low = Fabric_PropertyStore_get_vertex_property(&graph.property_store, v, PROPERTY_INDEX_TEST_AGE, &status);
+    assert(FABRIC_OK == status && 1000 == Fabric_Property_get_integer_value(low));
+    low = Fabric_PropertyStore_get_vertex_property(&graph.property_store, v, PROPERTY_INDEX_TEST_SCORE, &status);
+    assert(FABRIC_OK == status && e->score[300] == Fabric_Property_get_real_value(low));
+    property_index_check_all(&graph);
+    Fabric_close_graph(&graph);
+    assert(0 == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for property indices.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_property_index();
+    return 0;
+}
+#endif
@@ -0,0 +1,201 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef FABRIC_NO_THREADS
+#include <pthread.h>
+#endif
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+#define SNAPSHOT_TEST_VERTICES 2000
+#define SNAPSHOT_TEST_ROUNDS 20
+#define SNAPSHOT_TEST_READERS 4
+
+/**
+ * Marks every vertex of a graph with the same round number
+ */
+static
+void snapshot_mark_vertices(Graph *graph, propertyid_t round) {
+    Vertex *v;
+    error_t status;
+    vertexid_t id;
+
+    for (id = 1; id <= SNAPSHOT_TEST_VERTICES; id++) {
+        v = Fabric_VertexStore_get_vertex(&graph->vertex_store, id, &status);
+        assert(FABRIC_OK == status);
+        Fabric_Vertex_set_first_property_id(v, round);
+        assert(FABRIC_OK == Fabric_VertexStore_update_vertex(&graph->vertex_store, v));
+    }
+}
+
+/**
+ * Checks that a snapshot sees every vertex marked with one round and
+ * returns that round
+ */
+static
+propertyid_t snapshot_check_vertices(Snapshot *snapshot) {
+    Vertex v;
+    propertyid_t round = 0;
+    vertexid_t id;
+
+    for (id = 1; id <= SNAPSHOT_TEST_VERTICES; id++) {
+        assert(FABRIC_OK == Fabric_Snapshot_read_vertex(snapshot, id, &v));
+        if (id == 1) {
+            round = Fabric_Vertex_get_first_property_id(&v);
+        }
+        assert(round == Fabric_Vertex_get_first_property_id(&v));
+    }
+    return round;
+}
+
+#ifndef FABRIC_NO_THREADS
+/**
+ * Reader thread that checks snapshots until the writer is done
+ */
+static
+void *snapshot_reader(void *arg) {
+    Graph *graph = arg;
+    Snapshot snapshot;
+    propertyid_t round, last_round = 0;
+
+    do {
+        assert(FABRIC_OK == Fabric_Snapshot_begin(&snapshot, graph));
+        round = snapshot_check_vertices(&snapshot);
+        Fabric_Snapshot_end(&snapshot);
+        // Snapshots never go back in time
+        assert(round >= last_round);
+        last_round = round;
+    } while (round < SNAPSHOT_TEST_ROUNDS);
+    return NULL;
+}
+#endif
+
+void test_snapshot() {
+    FILE *db_file;
+    Graph graph;
+    Class *c;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    Vertex *from, *to;
+    Vertex v;
+    Edge e;
+    Snapshot old, current, extra[FABRIC_MAX_SNAPSHOTS];
+    error_t status;
+    edgeid_t edge_id;
+    vertexid_t i;
+#ifndef FABRIC_NO_THREADS
+    pthread_t readers[SNAPSHOT_TEST_READERS];
+    propertyid_t round;
+#endif
+
+    char *file_name = "test_snapshot.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    c = Fabric_Class_new(1, &status);
+    assert(FABRIC_OK == status);
+    memset(class_data, 0, sizeof(class_data));
+    Fabric_Class_init(c, class_data);
+    Fabric_ClassStore_update_class(&graph.class_store, c);
+    for (i = 1; i <= SNAPSHOT_TEST_VERTICES; i++) {
+        Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+        assert(FABRIC_OK == status);
+    }
+
+    // snapshots need to be enabled first
+    assert(FABRIC_SNAPSHOT_ERROR == Fabric_Snapshot_begin(&old, &graph));
+    assert(FABRIC_SNAPSHOT_ERROR == Fabric_Graph_publish(&graph));
+    assert(FABRIC_OK == Fabric_Graph_enable_snapshots(&graph));
+    assert(FABRIC_OK == Fabric_Graph_publish(&graph));
+    assert(0 == Fabric_SnapshotManager_get_num_versions(graph.snapshots));
+
+    // a snapshot keeps seeing the graph as it was when it began
+    assert(FABRIC_OK == Fabric_Snapshot_begin(&old, &graph));
+    assert(0 == snapshot_check_vertices(&old));
+    snapshot_mark_vertices(&graph, 1);
+    from = Fabric_VertexStore_get_vertex(&graph.vertex_store, 1, &status);
+    to = Fabric_VertexStore_get_vertex(&graph.vertex_store, 2, &status);
+    edge_id = Fabric_Edge_get_id(Fabric_EdgeStore_create_edge(&graph.edge_store, 3, from, to, &status));
+    assert(FABRIC_OK == status);
+    assert(0 == snapshot_check_vertices(&old));
+    assert(FABRIC_OK == Fabric_Graph_publish(&graph));
+    assert(0 < Fabric_SnapshotManager_get_num_versions(graph.snapshots));
+    assert(0 == snapshot_check_vertices(&old));
+    assert(FABRIC_OK == Fabric_Snapshot_read_vertex(&old, 1, &v));
+    assert(0 == Fabric_Vertex_get_first_out_edge_id(&v));
+    assert(FABRIC_OK != Fabric_Snapshot_read_edge(&old, edge_id, &e));
+    assert(FABRIC_VERTEXSTORE_INVALID_ID == Fabric_Snapshot_read_vertex(&old, 0, &v));
+
+    // a new snapshot sees the published changes
+    assert(FABRIC_OK == Fabric_Snapshot_begin(&current, &graph));
+    assert(Fabric_Snapshot_get_epoch(&old) < Fabric_Snapshot_get_epoch(&current));
+    assert(1 == snapshot_check_vertices(&current));
+    assert(FABRIC_OK == Fabric_Snapshot_read_vertex(&current, 1, &v));
+    assert(edge_id == Fabric_Vertex_get_first_out_edge_id(&v));
+    assert(FABRIC_OK == Fabric_Snapshot_read_edge(&current, edge_id, &e));
+    assert(3 == Fabric_Edge_get_label_id(&e));
+    assert(2 == Fabric_Edge_get_to_vertex_id(&e));
+
+    // versions are freed once no snapshot can read them
+    Fabric_Snapshot_end(&old);
+    assert(FABRIC_OK == Fabric_Graph_publish(&graph));
+    assert(0 == Fabric_SnapshotManager_get_num_versions(graph.snapshots));
+    assert(1 == snapshot_check_vertices(&current));
+
+    // only so many snapshots can be active at once
+    for (i = 1; i < FABRIC_MAX_SNAPSHOTS; i++) {
+        assert(FABRIC_OK == Fabric_Snapshot_begin(&extra[i], &graph));
+    }
+    assert(FABRIC_SNAPSHOT_LIMIT == Fabric_Snapshot_begin(&extra[0], &graph));
+    for (i = 1; i < FABRIC_MAX_SNAPSHOTS; i++) {
+        Fabric_Snapshot_end(&extra[i]);
+    }
+    Fabric_Snapshot_end(&current);
+
+#ifndef FABRIC_NO_THREADS
+    // readers never see a round that is only partly written
+    for (i = 0; i < SNAPSHOT_TEST_READERS; i++) {
+        assert(0 == pthread_create(&readers[i], NULL, snapshot_reader, &graph));
+    }
+    for (round = 2; round <= SNAPSHOT_TEST_ROUNDS; round++) {
+        snapshot_mark_vertices(&graph, round);
+        assert(FABRIC_OK == Fabric_Graph_publish(&graph));
+    }
+    for (i = 0; i < SNAPSHOT_TEST_READERS; i++) {
+        assert(0 == pthread_join(readers[i], NULL));
+    }
+    assert(FABRIC_OK == Fabric_Graph_publish(&graph));
+    assert(0 == Fabric_SnapshotManager_get_num_versions(graph.snapshots));
+#endif
+
+    Fabric_close_graph(&graph);
+
+#ifndef FABRIC_NO_MMAP
+    // mapped graphs can't be read through snapshots
+    assert(FABRIC_OK == Fabric_map_graph(db_file, &graph));
+    assert(FABRIC_SNAPSHOT_ERROR == Fabric_Graph_enable_snapshots(&graph));
+    Fabric_close_graph(&graph);
+#endif
+
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for snapshots.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_snapshot();
+    return 0;
+}
+#endif
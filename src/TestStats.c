@@ -0,0 +1,195 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+#define STATS_TEST_VERTICES 10
+#define STATS_TEST_IDS 100
+
+#ifndef FABRIC_NO_STATS
+#ifndef FABRIC_NO_THREADS
+/**
+ * Adds ids to a set from another thread, whose counts must outlive it
+ */
+static
+void *stats_add_ids(void *arg) {
+    IdSet *set = arg;
+    uint32_t id;
+    for (id = 1; id <= STATS_TEST_IDS; id++) {
+        Fabric_IdSet_add(set, id);
+    }
+    return NULL;
+}
+#endif
+
+/**
+ * Checks the id set and entity map counters
+ */
+static
+void stats_test_lookups(Graph *graph) {
+    GraphStats stats;
+    IdSet *set;
+    EntityMap *map;
+    error_t status;
+    uint32_t id;
+#ifndef FABRIC_NO_THREADS
+    pthread_t thread;
+#endif
+
+    Fabric_stats_reset();
+    set = Fabric_IdSet_new(&status);
+    assert(FABRIC_OK == status);
+    map = Fabric_EntityMap_new(&status);
+    assert(FABRIC_OK == status);
+
+    // the default capacity of 32 grows at 25, 49 and 97 entries
+    for (id = 1; id <= STATS_TEST_IDS; id++) {
+        Fabric_IdSet_add(set, id);
+        Fabric_EntityMap_set(map, id, map);
+    }
+    Fabric_Graph_get_stats(graph, &stats);
+    assert(3 == stats.idset_resizes);
+    assert(3 == stats.entitymap_resizes);
+    // each add looks its id up once, and again after a resize
+    assert(STATS_TEST_IDS + 3 == stats.idset_lookups);
+    assert(STATS_TEST_IDS + 3 == stats.entitymap_lookups);
+    assert(stats.idset_probes >= stats.idset_lookups);
+    assert(stats.entitymap_probes >= stats.entitymap_lookups);
+
+    Fabric_stats_reset();
+    for (id = 1; id <= STATS_TEST_IDS; id++) {
+        assert(Fabric_IdSet_has(set, id));
+        assert(map == Fabric_EntityMap_get(map, id));
+    }
+    Fabric_Graph_get_stats(graph, &stats);
+    assert(STATS_TEST_IDS == stats.idset_lookups);
+    assert(STATS_TEST_IDS == stats.entitymap_lookups);
+    assert(0 == stats.idset_resizes);
+    Fabric_IdSet_destroy(set);
+
+#ifndef FABRIC_NO_THREADS
+    // the counts of a thread that has exited are kept
+    Fabric_stats_reset();
+    set = Fabric_IdSet_new(&status);
+    assert(FABRIC_OK == status);
+    assert(0 == pthread_create(&thread, NULL, stats_add_ids, set));
+    assert(0 == pthread_join(thread, NULL));
+    Fabric_Graph_get_stats(graph, &stats);
+    assert(STATS_TEST_IDS + 3 == stats.idset_lookups);
+    assert(3 == stats.idset_resizes);
+    Fabric_IdSet_destroy(set);
+#endif
+    Fabric_EntityMap_destroy(map);
+}
+
+/**
+ * Checks the store, read and flush counters
+ */
+static
+void stats_test_stores(FILE *db_file, Graph *graph) {
+    GraphStats stats;
+    GraphStoreStats *vertices;
+    Class *c;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    uint8_t bytes[8];
+    error_t status;
+    vertexid_t v;
+
+    c = Fabric_Class_new(1, &status);
+    assert(FABRIC_OK == status);
+    memset(class_data, 0, sizeof(class_data));
+    Fabric_Class_init(c, class_data);
+    assert(FABRIC_OK == Fabric_ClassStore_update_class(&graph->class_store, c));
+    for (v = 1; v <= STATS_TEST_VERTICES; v++) {
+        Fabric_VertexStore_create_vertex(&graph->vertex_store, c, &status);
+        assert(FABRIC_OK == status);
+    }
+
+    Fabric_stats_reset();
+    assert(FABRIC_OK == Fabric_ClassStore_flush(&graph->class_store));
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph->vertex_store));
+    assert(FABRIC_OK == Fabric_Graph_flush(graph));
+    Fabric_Graph_get_stats(graph, &stats);
+    vertices = &stats.stores[FABRIC_STATS_VERTEX_STORE];
+    assert(STATS_TEST_VERTICES == vertices->records_written);
+    assert(1 == vertices->flushes);
+    assert(1 == stats.stores[FABRIC_STATS_CLASS_STORE].records_written);
+    assert(0 == stats.stores[FABRIC_STATS_EDGE_STORE].flushes);
+    assert(1 == stats.graph_flushes);
+    assert(stats.file_bytes_written > 0);
+    assert(stats.write_bytes_calls > 0);
+    Fabric_close_graph(graph);
+
+    // a reloaded graph reads each vertex once and then finds it cached
+    Fabric_load_graph(db_file, graph);
+    Fabric_stats_reset();
+    for (v = 1; v <= STATS_TEST_VERTICES; v++) {
+        Fabric_VertexStore_get_vertex(&graph->vertex_store, v, &status);
+        assert(FABRIC_OK == status);
+        Fabric_VertexStore_get_vertex(&graph->vertex_store, v, &status);
+        assert(FABRIC_OK == status);
+    }
+    Fabric_Graph_get_stats(graph, &stats);
+    vertices = &stats.stores[FABRIC_STATS_VERTEX_STORE];
+    assert(STATS_TEST_VERTICES == vertices->records_read);
+    assert(STATS_TEST_VERTICES == vertices->cache_misses);
+    assert(STATS_TEST_VERTICES == vertices->cache_hits);
+    assert(STATS_TEST_VERTICES == stats.read_bytes_calls);
+    assert(STATS_TEST_VERTICES * FABRIC_VERTEX_STORAGE_SIZE == stats.bytes_read);
+    assert(stats.page_misses > 0);
+    assert(stats.file_bytes_read > 0);
+
+    // only reads that don't follow the last one are seeks
+    Fabric_stats_reset();
+    assert(FABRIC_OK == Fabric_Graph_read_bytes(graph, bytes, 4, 1000));
+    assert(FABRIC_OK == Fabric_Graph_read_bytes(graph, bytes + 4, 4, 1004));
+    assert(FABRIC_OK == Fabric_Graph_read_bytes(graph, bytes, 8, -1));
+    assert(FABRIC_OK == Fabric_Graph_read_bytes(graph, bytes, 8, 0));
+    Fabric_Graph_get_stats(graph, &stats);
+    assert(4 == stats.read_bytes_calls);
+    assert(24 == stats.bytes_read);
+    assert(2 == stats.seeks);
+
+    assert(Fabric_memused() == stats.memory_total);
+    assert(Fabric_memused_tagged(FABRIC_MEM_CACHE) == stats.memory_used[FABRIC_MEM_CACHE]);
+}
+#endif
+
+void test_stats() {
+    FILE *db_file;
+    Graph graph;
+
+    char *file_name = "test_stats.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+#ifndef FABRIC_NO_STATS
+    stats_test_lookups(&graph);
+    stats_test_stores(db_file, &graph);
+#endif
+
+    Fabric_close_graph(&graph);
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for statistics.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_stats();
+    return 0;
+}
+#endif
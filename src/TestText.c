@@ -0,0 +1,241 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+#define TEXT_TEST_MAX_SIZE 20000
+
+static uint32_t text_test_seed = 12345;
+
+/**
+ * Fills a buffer with printable characters that don't compress
+ */
+static
+void text_random(char *value, uint32_t size) {
+    uint32_t i;
+    for (i = 0; i < size; i++) {
+        text_test_seed ^= text_test_seed << 13;
+        text_test_seed ^= text_test_seed >> 17;
+        text_test_seed ^= text_test_seed << 5;
+        value[i] = 33 + text_test_seed % 94;
+    }
+    value[size] = '\0';
+}
+
+/**
+ * Fills a buffer with a description that repeats itself
+ */
+static
+void text_description(char *value, uint32_t size, int n) {
+    uint32_t i;
+    int written;
+    for (i = 0; i < size; i += written) {
+        written = snprintf(value + i, size - i + 1, "Vertex %d is described by sentence %u. ", n, i % 7);
+    }
+    value[size] = '\0';
+}
+
+/**
+ * Compresses and decompresses a value
+ */
+static
+void text_check_round_trip(const uint8_t *value, uint32_t size) {
+    static uint8_t compressed[TEXT_TEST_MAX_SIZE + TEXT_TEST_MAX_SIZE / 255 + 16];
+    static uint8_t decompressed[TEXT_TEST_MAX_SIZE];
+    uint32_t compressed_size;
+
+    assert(Fabric_Compression_bound(size) <= sizeof(compressed));
+    compressed_size = Fabric_Compression_compress(value, size, compressed, Fabric_Compression_bound(size));
+    assert(compressed_size > 0 && compressed_size <= Fabric_Compression_bound(size));
+    assert(Fabric_Compression_decompress(compressed, compressed_size, decompressed, size));
+    assert(0 == memcmp(value, decompressed, size));
+
+    // the wrong size or a truncated input is noticed
+    if (size > 0) {
+        assert(!Fabric_Compression_decompress(compressed, compressed_size, decompressed, size - 1));
+        assert(!Fabric_Compression_decompress(compressed, compressed_size - 1, decompressed, size));
+    }
+}
+
+static
+void text_test_compression() {
+    static char value[TEXT_TEST_MAX_SIZE + 1];
+    static uint8_t compressed[TEXT_TEST_MAX_SIZE];
+    uint8_t bad[] = {0x1f, 'a', 0x00, 0x00, 0x00};
+    uint8_t decompressed[32];
+    uint32_t size;
+
+    for (size = 0; size < 40; size++) {
+        text_description(value, size, 1);
+        text_check_round_trip((uint8_t*)value, size);
+    }
+    text_description(value, 4000, 7);
+    text_check_round_trip((uint8_t*)value, 4000);
+    assert(Fabric_Compression_compress((uint8_t*)value, 4000, compressed, 4000) < 1000);
+    memset(value, 'z', TEXT_TEST_MAX_SIZE);
+    text_check_round_trip((uint8_t*)value, TEXT_TEST_MAX_SIZE);
+    assert(Fabric_Compression_compress((uint8_t*)value, TEXT_TEST_MAX_SIZE, compressed, 200) > 0);
+    text_random(value, 3000);
+    text_check_round_trip((uint8_t*)value, 3000);
+
+    // random text doesn't fit in less space than it started with
+    assert(0 == Fabric_Compression_compress((uint8_t*)value, 3000, compressed, 2990));
+
+    // a match can't start before the output
+    assert(!Fabric_Compression_decompress(bad, sizeof(bad), decompressed, 20));
+    bad[2] = 0x01;
+    assert(Fabric_Compression_decompress(bad, sizeof(bad), decompressed, 1 + 15 + 4));
+    assert(decompressed[19] == 'a');
+}
+
+static
+void text_test_headers() {
+    Text text;
+    uint8_t plain[FABRIC_TEXT_HEADER_SIZE] = {0x00, 0x00, 0x01, 0x00, 'a', 'b', 'c', 'd'};
+    uint8_t compressed[FABRIC_TEXT_HEADER_SIZE] = {0x80, 0x00, 0x00, 0x40, 0x00, 0x00, 0x10, 0x00};
+
+    Fabric_Text_set_id(&text, 0);
+    assert(FABRIC_TEXT_INVALID_ID == Fabric_Text_init(&text, plain));
+    Fabric_Text_set_id(&text, 3);
+    assert(FABRIC_OK == Fabric_Text_init(&text, plain));
+    assert(256 == Fabric_Text_get_size(&text));
+    assert(256 == Fabric_Text_get_stored_size(&text));
+    assert(!Fabric_Text_is_compressed(&text));
+    assert(FABRIC_OK == Fabric_Text_init(&text, compressed));
+    assert(4096 == Fabric_Text_get_size(&text));
+    assert(64 == Fabric_Text_get_stored_size(&text));
+    assert(Fabric_Text_is_compressed(&text));
+}
+
+/**
+ * Checks a stored text both ways it can be read
+ */
+static
+void text_check_stored(TextStore *ts, MemArena *arena, textid_t text_id, char *expected) {
+    uint32_t size;
+    error_t status;
+    text_t value;
+    Text *text;
+
+    text = Fabric_TextStore_get_text(ts, text_id, &status);
+    assert(FABRIC_OK == status && NULL != text);
+    assert(strlen(expected) == Fabric_Text_get_size(text));
+    assert(0 == strcmp(expected, Fabric_Text_get_value(text)));
+    Fabric_Text_destroy(text);
+
+    value = Fabric_TextStore_read_text(ts, text_id, arena, &size, &status);
+    assert(FABRIC_OK == status && NULL != value);
+    assert(strlen(expected) == size);
+    assert(0 == strcmp(expected, value));
+}
+
+void test_text() {
+    static char values[8][TEXT_TEST_MAX_SIZE + 1];
+    FILE *db_file;
+    Graph graph;
+    TextStore *ts;
+    MemArena arena;
+    textid_t ids[8], spanning_id = 0;
+    uint32_t blocks;
+    size_t text_used;
+    error_t status;
+    Text *text;
+    int i;
+
+    text_test_compression();
+    text_test_headers();
+
+    char *file_name = "test_text.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+    ts = &graph.text_store;
+
+    values[0][0] = '\0';
+    strcpy(values[1], "a short name");
+    text_description(values[2], 3000, 2);
+    text_random(values[3], 2000);
+    text_description(values[4], FABRIC_TEXT_COMPRESSION_THRESHOLD - 1, 4);
+    for (i = 0; i < 5; i++) {
+        ids[i] = Fabric_TextStore_create_text(ts, values[i], &status);
+        assert(FABRIC_OK == status && 0 != ids[i]);
+    }
+
+    // only long texts that shrink are compressed
+    text = Fabric_TextStore_get_text(ts, ids[2], &status);
+    assert(FABRIC_OK == status);
+    assert(Fabric_Text_is_compressed(text));
+    assert(Fabric_Text_get_stored_size(text) < 1000);
+    assert(ids[3] - ids[2] == (Fabric_Text_get_stored_size(text) + 4) / ts->block_size + 1);
+    Fabric_Text_destroy(text);
+    for (i = 3; i < 5; i++) {
+        text = Fabric_TextStore_get_text(ts, ids[i], &status);
+        assert(FABRIC_OK == status);
+        assert(!Fabric_Text_is_compressed(text));
+        Fabric_Text_destroy(text);
+    }
+
+    // long texts carry on into the next extent instead of skipping to it
+    for (i = 0; i < 200 && 0 == spanning_id; i++) {
+        text_random(values[5], 5000);
+        ids[5] = Fabric_TextStore_create_text(ts, values[5], &status);
+        assert(FABRIC_OK == status);
+        blocks = (5000 + 4) / ts->block_size + 1;
+        if (Fabric_ExtentList_get_contiguous(&ts->extents, ids[5]) < blocks) {
+            spanning_id = ids[5];
+        }
+    }
+    assert(0 != spanning_id);
+    ids[6] = Fabric_TextStore_create_text(ts, values[2], &status);
+    assert(FABRIC_OK == status && ids[6] == spanning_id + blocks);
+    strcpy(values[6], values[2]);
+
+    // values read into an arena are freed with it
+    text_used = Fabric_memused_tagged(FABRIC_MEM_TEXT);
+    Fabric_memarena_init(&arena, 4096, FABRIC_MEM_TEXT);
+    for (i = 0; i < 7; i++) {
+        text_check_stored(ts, &arena, ids[i], values[i]);
+    }
+    assert(Fabric_memused_tagged(FABRIC_MEM_TEXT) > text_used);
+    Fabric_memarena_release(&arena);
+    assert(Fabric_memused_tagged(FABRIC_MEM_TEXT) == text_used);
+
+    assert(NULL == Fabric_TextStore_read_text(ts, 0, &arena, NULL, &status));
+    assert(FABRIC_TEXT_INVALID_ID == status);
+    assert(NULL == Fabric_TextStore_get_text(ts, ts->next_id, &status));
+    assert(FABRIC_TEXT_INVALID_ID == status);
+    Fabric_close_graph(&graph);
+
+    // the texts survive reopening the graph
+    Fabric_load_graph(db_file, &graph);
+    ts = &graph.text_store;
+    Fabric_memarena_init(&arena, 4096, FABRIC_MEM_TEXT);
+    for (i = 0; i < 7; i++) {
+        text_check_stored(ts, &arena, ids[i], values[i]);
+    }
+    Fabric_memarena_release(&arena);
+    Fabric_close_graph(&graph);
+
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for texts.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_text();
+    return 0;
+}
+#endif
@@ -0,0 +1,197 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#include "TestHelpers.c"
+#endif
+
+/* Vertices up to TREE form a binary tree and the rest form paths of three */
+#define TRAVERSAL_TEST_TREE 3000
+#define TRAVERSAL_TEST_VERTICES 6000
+
+static uint32_t traversal_depths[TRAVERSAL_TEST_VERTICES + 1];
+static uint32_t traversal_expected[TRAVERSAL_TEST_VERTICES + 1];
+static vertexid_t traversal_vertices[TRAVERSAL_TEST_VERTICES];
+static vertexid_t traversal_components[TRAVERSAL_TEST_VERTICES + 1];
+
+/**
+ * Returns the depth of a vertex of the tree below the root
+ */
+static
+uint32_t traversal_tree_depth(vertexid_t vertex_id) {
+    uint32_t depth = 0;
+    while (vertex_id > 1) {
+        vertex_id /= 2;
+        depth++;
+    }
+    return depth;
+}
+
+/**
+ * Searches with a pool and checks the depths, and that the vertices come
+ * out with the start first and in order of their depths
+ */
+static
+void traversal_check_bfs(TraversalPool *pool, AdjacencySnapshot *snapshot,
+        vertexid_t start_id, int direction, uint32_t max_depth, uint32_t expected_count) {
+    uint32_t count, i;
+
+    assert(FABRIC_OK == Fabric_Traversal_bfs(pool, snapshot, start_id, direction, max_depth,
+        traversal_vertices, traversal_depths, &count));
+    assert(expected_count == count);
+    assert(0 == memcmp(traversal_expected, traversal_depths, sizeof(traversal_depths)));
+    assert(start_id == traversal_vertices[0]);
+    for (i = 1; i < count; i++) {
+        assert(traversal_depths[traversal_vertices[i - 1]] <= traversal_depths[traversal_vertices[i]]);
+    }
+}
+
+static
+void traversal_test_pool(TraversalPool *pool, AdjacencySnapshot *snapshot) {
+    uint32_t count, i, found = 0;
+    vertexid_t v;
+
+    // the whole tree, then only its first levels
+    for (v = 0; v <= TRAVERSAL_TEST_VERTICES; v++) {
+        traversal_expected[v] = v >= 1 && v <= TRAVERSAL_TEST_TREE ? traversal_tree_depth(v) : FABRIC_TRAVERSAL_UNREACHED;
+    }
+    traversal_check_bfs(pool, snapshot, 1, FABRIC_DIRECTION_OUT, UINT32_MAX, TRAVERSAL_TEST_TREE);
+    for (v = 1; v <= TRAVERSAL_TEST_VERTICES; v++) {
+        if (traversal_expected[v] > 3) {
+            traversal_expected[v] = FABRIC_TRAVERSAL_UNREACHED;
+        }
+    }
+    traversal_check_bfs(pool, snapshot, 1, FABRIC_DIRECTION_OUT, 3, 15);
+
+    // incoming edges lead back up to the root
+    memset(traversal_expected, 0xff, sizeof(traversal_expected));
+    for (v = TRAVERSAL_TEST_TREE, i = 0; v >= 1; v /= 2, i++) {
+        traversal_expected[v] = i;
+    }
+    traversal_check_bfs(pool, snapshot, TRAVERSAL_TEST_TREE, FABRIC_DIRECTION_IN, UINT32_MAX, i);
+
+    // a path is only connected when edges are followed either way
+    memset(traversal_expected, 0xff, sizeof(traversal_expected));
+    traversal_expected[3001] = 0;
+    traversal_expected[3002] = 1;
+    traversal_check_bfs(pool, snapshot, 3001, FABRIC_DIRECTION_OUT, UINT32_MAX, 2);
+    traversal_expected[3003] = 2;
+    traversal_check_bfs(pool, snapshot, 3001, FABRIC_DIRECTION_OUT | FABRIC_DIRECTION_IN, UINT32_MAX, 3);
+
+    // the neighbourhood of a vertex leaves the vertex out
+    assert(FABRIC_OK == Fabric_Traversal_k_hop(pool, snapshot, 2, FABRIC_DIRECTION_OUT | FABRIC_DIRECTION_IN, 2,
+        traversal_vertices, &count));
+    assert(8 == count);
+    for (i = 0; i < count; i++) {
+        v = traversal_vertices[i];
+        assert(v != 2);
+        found |= 1 << v;
+        // 1, 4 and 5 are one hop away and 3, 8, 9, 10 and 11 are two
+        assert(i < 3 ? (v == 1 || v == 4 || v == 5) : (v == 3 || (v >= 8 && v <= 11)));
+    }
+    assert(found == ((1 << 1) | (1 << 3) | (1 << 4) | (1 << 5) | (0xf << 8)));
+    assert(FABRIC_OK == Fabric_Traversal_k_hop(pool, snapshot, 2, FABRIC_DIRECTION_OUT, 0, traversal_vertices, &count));
+    assert(0 == count);
+
+    // the tree is one component and each path is another
+    assert(FABRIC_OK == Fabric_Traversal_connected_components(pool, snapshot, traversal_components, &count));
+    assert(1 + (TRAVERSAL_TEST_VERTICES - TRAVERSAL_TEST_TREE) / 3 == count);
+    for (v = 1; v <= TRAVERSAL_TEST_VERTICES; v++) {
+        if (v <= TRAVERSAL_TEST_TREE) {
+            assert(1 == traversal_components[v]);
+        } else {
+            assert(v - (v - TRAVERSAL_TEST_TREE - 1) % 3 == traversal_components[v]);
+        }
+    }
+
+    // starts and directions that aren't valid
+    assert(FABRIC_TRAVERSAL_ERROR == Fabric_Traversal_bfs(pool, snapshot, 0, FABRIC_DIRECTION_OUT, 1, NULL, NULL, &count));
+    assert(FABRIC_TRAVERSAL_ERROR == Fabric_Traversal_bfs(
+        pool, snapshot, TRAVERSAL_TEST_VERTICES + 1, FABRIC_DIRECTION_OUT, 1, NULL, NULL, &count));
+    assert(FABRIC_TRAVERSAL_ERROR == Fabric_Traversal_bfs(pool, snapshot, 1, 0, 1, NULL, NULL, &count));
+    assert(FABRIC_TRAVERSAL_ERROR == Fabric_Traversal_bfs(pool, snapshot, 1, 4, 1, NULL, NULL, &count));
+    assert(0 == count);
+
+    // the vertices don't have to be kept
+    assert(FABRIC_OK == Fabric_Traversal_bfs(pool, snapshot, 1, FABRIC_DIRECTION_OUT, UINT32_MAX, NULL, NULL, &count));
+    assert(TRAVERSAL_TEST_TREE == count);
+}
+
+void test_traversal() {
+    FILE *db_file;
+    Graph graph;
+    Class *c;
+    TraversalPool *pool;
+    AdjacencySnapshot *snapshot;
+    uint8_t class_data[FABRIC_CLASS_STORAGE_SIZE];
+    uint32_t workers[] = {1, 2, 4, 8, 0};
+    size_t index_used, general_used;
+    error_t status;
+    vertexid_t v;
+    int i;
+
+    char *file_name = "test_traversal.fdb";
+    db_file = fopen(file_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    Fabric_load_graph(db_file, &graph);
+
+    c = Fabric_Class_new(1, &status);
+    assert(FABRIC_OK == status);
+    memset(class_data, 0, sizeof(class_data));
+    Fabric_Class_init(c, class_data);
+    assert(FABRIC_OK == Fabric_ClassStore_update_class(&graph.class_store, c));
+    for (v = 1; v <= TRAVERSAL_TEST_VERTICES; v++) {
+        Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+        assert(FABRIC_OK == status);
+    }
+    for (v = 2; v <= TRAVERSAL_TEST_TREE; v++) {
+        test_connect(&graph, 1, v / 2, v);
+    }
+    for (v = TRAVERSAL_TEST_TREE + 1; v <= TRAVERSAL_TEST_VERTICES; v += 3) {
+        test_connect(&graph, 1, v, v + 1);
+        test_connect(&graph, 1, v + 2, v + 1);
+    }
+    snapshot = Fabric_AdjacencySnapshot_build(&graph, 0, &status);
+    assert(FABRIC_OK == status);
+    assert(TRAVERSAL_TEST_VERTICES == Fabric_AdjacencySnapshot_get_vertex_count(snapshot));
+
+    index_used = Fabric_memused_tagged(FABRIC_MEM_INDEX);
+    general_used = Fabric_memused_tagged(FABRIC_MEM_GENERAL);
+    for (i = 0; i < (int)(sizeof(workers) / sizeof(workers[0])); i++) {
+        pool = Fabric_TraversalPool_new(workers[i], &status);
+        assert(FABRIC_OK == status && NULL != pool);
+#ifndef FABRIC_NO_THREADS
+        assert(0 == workers[i] || workers[i] == Fabric_TraversalPool_get_worker_count(pool));
+#else
+        assert(1 == Fabric_TraversalPool_get_worker_count(pool));
+#endif
+        traversal_test_pool(pool, snapshot);
+        Fabric_TraversalPool_destroy(pool);
+        assert(index_used == Fabric_memused_tagged(FABRIC_MEM_INDEX));
+        assert(general_used == Fabric_memused_tagged(FABRIC_MEM_GENERAL));
+    }
+
+    Fabric_AdjacencySnapshot_destroy(snapshot);
+    Fabric_close_graph(&graph);
+    fclose(db_file);
+    remove(file_name);
+    printf("All tests passed for traversals.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_traversal();
+    return 0;
+}
+#endif
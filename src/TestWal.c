@@ -0,0 +1,271 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#endif
+
+#define WAL_TEST_THREADS 4
+#define WAL_TEST_COMMITS 50
+
+/**
+ * Drops a graph without flushing it, as if the process had crashed
+ */
+static
+void wal_crash_graph(Graph *graph) {
+    Fabric_Wal_deinit(&graph->wal);
+    Fabric_BufferPool_deinit(&graph->buffer_pool);
+    Fabric_ClassStore_deinit(&graph->class_store);
+    Fabric_LabelStore_deinit(&graph->label_store);
+    Fabric_VertexStore_deinit(&graph->vertex_store);
+    Fabric_EdgeStore_deinit(&graph->edge_store);
+    Fabric_PropertyStore_deinit(&graph->property_store);
+    Fabric_IndexStore_deinit(&graph->index_store);
+}
+
+/**
+ * Reads bytes straight from a file, bypassing any graph
+ */
+static
+void wal_read_file(FILE *file, uint8_t *destination, size_t num_bytes, long offset) {
+    memset(destination, 0, num_bytes);
+    fflush(file);
+    fseek(file, offset, SEEK_SET);
+    fread(destination, 1, num_bytes, file);
+    clearerr(file);
+}
+
+void test_wal_recovery() {
+    FILE *db_file, *wal_file;
+    Graph graph;
+    uint8_t committed[16], uncommitted[16], garbage[7], out[16];
+    long committed_offset, uncommitted_offset;
+    size_t i;
+
+    char *db_name = "test_wal.fdb";
+    char *wal_name = "test_wal.log";
+    db_file = fopen(db_name, "w+b");
+    wal_file = fopen(wal_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+
+    for (i = 0; i < sizeof(committed); i++) {
+        committed[i] = (uint8_t)(i + 1);
+        uncommitted[i] = (uint8_t)(0xF0 | i);
+    }
+    assert(FABRIC_OK == Fabric_load_logged_graph(db_file, wal_file, &graph));
+    committed_offset = graph.vertex_store.offset + 100;
+    uncommitted_offset = graph.edge_store.offset + 100;
+
+    // a committed write survives a crash through the log alone, so the
+    // log is committed without the checkpoint step a graph commit may run
+    assert(FABRIC_OK == Fabric_Graph_write_bytes(&graph, committed, sizeof(committed), committed_offset));
+    assert(FABRIC_OK == Fabric_Wal_commit(&graph.wal));
+    assert(Fabric_Wal_get_size(&graph.wal) > 0);
+    assert(FABRIC_OK == Fabric_Graph_write_bytes(&graph, uncommitted, sizeof(uncommitted), uncommitted_offset));
+    wal_crash_graph(&graph);
+
+    // a torn record after the last commit is ignored
+    memset(garbage, 0xAB, sizeof(garbage));
+    fseek(wal_file, 0, SEEK_END);
+    fwrite(garbage, 1, sizeof(garbage), wal_file);
+    fflush(wal_file);
+
+    wal_read_file(db_file, out, sizeof(out), committed_offset);
+    assert(memcmp(out, committed, sizeof(committed)) != 0);
+
+    assert(FABRIC_OK == Fabric_load_logged_graph(db_file, wal_file, &graph));
+    assert(0 == Fabric_Wal_get_size(&graph.wal));
+    assert(FABRIC_OK == Fabric_Graph_read_bytes(&graph, out, sizeof(out), committed_offset));
+    assert(memcmp(out, committed, sizeof(committed)) == 0);
+    assert(FABRIC_OK == Fabric_Graph_read_bytes(&graph, out, sizeof(out), uncommitted_offset));
+    assert(memcmp(out, uncommitted, sizeof(uncommitted)) != 0);
+
+    // the replayed write was forced into the graph file itself
+    wal_read_file(db_file, out, sizeof(out), committed_offset);
+    assert(memcmp(out, committed, sizeof(committed)) == 0);
+
+    // a write that hasn't been committed never reaches the graph file,
+    // which only holds what the log could redo
+    assert(FABRIC_OK == Fabric_Graph_write_bytes(&graph, uncommitted, sizeof(uncommitted), uncommitted_offset));
+    assert(FABRIC_OK == Fabric_Graph_checkpoint(&graph));
+    wal_read_file(db_file, out, sizeof(out), uncommitted_offset);
+    assert(memcmp(out, uncommitted, sizeof(uncommitted)) != 0);
+
+    // closing a logged graph checkpoints it
+    assert(FABRIC_OK == Fabric_commit_graph(&graph));
+    Fabric_close_graph(&graph);
+    fseek(wal_file, 0, SEEK_END);
+    assert(0 == ftell(wal_file));
+    wal_read_file(db_file, out, sizeof(out), uncommitted_offset);
+    assert(memcmp(out, uncommitted, sizeof(uncommitted)) == 0);
+
+    fclose(wal_file);
+    fclose(db_file);
+    remove(wal_name);
+    remove(db_name);
+    printf("All tests passed for wal recovery.\n");
+}
+
+void test_wal_checkpoint_step() {
+    FILE *db_file, *wal_file;
+    Graph graph;
+    uint8_t first[16], second[16], marker[16], out[16];
+    long offsets[3];
+    int i;
+
+    char *db_name = "test_wal_step.fdb";
+    char *wal_name = "test_wal_step.log";
+    db_file = fopen(db_name, "w+b");
+    wal_file = fopen(wal_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+
+    memset(first, 0x11, sizeof(first));
+    memset(second, 0x22, sizeof(second));
+    memset(marker, 0x33, sizeof(marker));
+    assert(FABRIC_OK == Fabric_load_logged_graph(db_file, wal_file, &graph));
+    offsets[0] = graph.vertex_store.offset + 100;
+    offsets[1] = graph.edge_store.offset + 100;
+    offsets[2] = graph.property_store.offset + 100;
+
+    // the log is committed directly so that only the test runs steps
+    for (i = 0; i < 3; i++) {
+        assert(FABRIC_OK == Fabric_Graph_write_bytes(&graph, first, sizeof(first), offsets[i]));
+    }
+    assert(FABRIC_OK == Fabric_Wal_commit(&graph.wal));
+    assert(3 == Fabric_BufferPool_get_dirty_count(&graph.buffer_pool));
+
+    // a step writes the lowest dirty page and records where redo starts
+    assert(FABRIC_OK == Fabric_Graph_checkpoint_step(&graph, 1));
+    assert(2 == Fabric_BufferPool_get_dirty_count(&graph.buffer_pool));
+    wal_read_file(db_file, out, sizeof(out), offsets[0]);
+    assert(memcmp(out, first, sizeof(first)) == 0);
+    assert(FABRIC_OK == Fabric_Graph_write_bytes(&graph, second, sizeof(second), offsets[1]));
+    assert(FABRIC_OK == Fabric_Wal_commit(&graph.wal));
+    wal_crash_graph(&graph);
+
+    // recovery starts after the records of the written page, so a change
+    // made to it behind the log's back is not replayed over
+    fseek(db_file, offsets[0], SEEK_SET);
+    fwrite(marker, 1, sizeof(marker), db_file);
+    fflush(db_file);
+    assert(FABRIC_OK == Fabric_load_logged_graph(db_file, wal_file, &graph));
+    assert(FABRIC_OK == Fabric_Graph_read_bytes(&graph, out, sizeof(out), offsets[0]));
+    assert(memcmp(out, marker, sizeof(marker)) == 0);
+    assert(FABRIC_OK == Fabric_Graph_read_bytes(&graph, out, sizeof(out), offsets[1]));
+    assert(memcmp(out, second, sizeof(second)) == 0);
+    assert(FABRIC_OK == Fabric_Graph_read_bytes(&graph, out, sizeof(out), offsets[2]));
+    assert(memcmp(out, first, sizeof(first)) == 0);
+
+    // the log is emptied by the step that leaves no page dirty
+    for (i = 0; i < 3; i++) {
+        assert(FABRIC_OK == Fabric_Graph_write_bytes(&graph, second, sizeof(second), offsets[i]));
+    }
+    assert(FABRIC_OK == Fabric_Wal_commit(&graph.wal));
+    assert(FABRIC_OK == Fabric_Graph_checkpoint_step(&graph, 2));
+    assert(Fabric_Wal_get_size(&graph.wal) > 0);
+    assert(FABRIC_OK == Fabric_Graph_checkpoint_step(&graph, 2));
+    assert(0 == Fabric_BufferPool_get_dirty_count(&graph.buffer_pool));
+    assert(0 == Fabric_Wal_get_size(&graph.wal));
+
+    // the first commit after loading runs a step
+    assert(FABRIC_OK == Fabric_Graph_write_bytes(&graph, first, sizeof(first), offsets[2]));
+    assert(FABRIC_OK == Fabric_commit_graph(&graph));
+    assert(0 == Fabric_BufferPool_get_dirty_count(&graph.buffer_pool));
+    assert(0 == Fabric_Wal_get_size(&graph.wal));
+    wal_read_file(db_file, out, sizeof(out), offsets[2]);
+    assert(memcmp(out, first, sizeof(first)) == 0);
+
+    Fabric_close_graph(&graph);
+    fclose(wal_file);
+    fclose(db_file);
+    remove(wal_name);
+    remove(db_name);
+    printf("All tests passed for wal checkpoint steps.\n");
+}
+
+#ifndef FABRIC_NO_THREADS
+static int wal_applied;
+
+static
+error_t wal_count_write(void *target, uint8_t *bytes, uint32_t num_bytes, uint32_t offset) {
+    (void)target;
+    assert(num_bytes == sizeof(uint32_t));
+    assert(offset == betoh32(*(uint32_t*)bytes));
+    wal_applied++;
+    return FABRIC_OK;
+}
+
+static
+void *wal_commit_thread(void *wal) {
+    uint32_t offset, value;
+    int i;
+    for (i = 0; i < WAL_TEST_COMMITS; i++) {
+        offset = (uint32_t)(size_t)pthread_self() % 100000 + i;
+        value = htobe32(offset);
+        assert(FABRIC_OK == Fabric_Wal_append(wal, (uint8_t*)&value, sizeof(value), offset));
+        assert(FABRIC_OK == Fabric_Wal_commit(wal));
+    }
+    return NULL;
+}
+
+void test_wal_group_commit() {
+    FILE *wal_file;
+    Wal wal;
+    pthread_t threads[WAL_TEST_THREADS];
+    size_t mem_used_start = Fabric_memused();
+    int i;
+
+    char *wal_name = "test_group_commit.log";
+    wal_file = fopen(wal_name, "w+b");
+    assert(FABRIC_OK == Fabric_Wal_init(&wal, wal_file));
+
+    for (i = 0; i < WAL_TEST_THREADS; i++) {
+        assert(0 == pthread_create(&threads[i], NULL, wal_commit_thread, &wal));
+    }
+    for (i = 0; i < WAL_TEST_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // every committed write is in the log exactly once
+    wal_applied = 0;
+    assert(FABRIC_OK == Fabric_Wal_recover(&wal, wal_count_write, NULL));
+    assert(WAL_TEST_THREADS * WAL_TEST_COMMITS == wal_applied);
+
+    assert(FABRIC_OK == Fabric_Wal_truncate(&wal));
+    wal_applied = 0;
+    assert(FABRIC_OK == Fabric_Wal_recover(&wal, wal_count_write, NULL));
+    assert(0 == wal_applied);
+
+    Fabric_Wal_deinit(&wal);
+    assert(mem_used_start == Fabric_memused());
+    fclose(wal_file);
+    remove(wal_name);
+    printf("All tests passed for wal group commit.\n");
+}
+#endif
+
+void test_wal() {
+    test_wal_recovery();
+    test_wal_checkpoint_step();
+#ifndef FABRIC_NO_THREADS
+    test_wal_group_commit();
+#endif
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_wal();
+    return 0;
+}
+#endif
@@ -0,0 +1,138 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifndef _FABRIC_TEST_ALL__
+#include "Fabric.c"
+#include "TestHelpers.c"
+#endif
+
+#define WRITE_BATCH_TEST_VERTICES 20
+
+static
+Class *write_batch_get_class(Graph *graph, text_t name) {
+    error_t status;
+    Class *c = Fabric_ClassStore_get_class_by_name(&graph->class_store, name, &status);
+    assert(FABRIC_OK == status);
+    return c;
+}
+
+void test_write_batch() {
+    FILE *db_file, *wal_file;
+    Graph graph;
+    WriteBatch batch, other;
+    Class *person, *c;
+    Vertex *v;
+    labelid_t knows;
+    vertexid_t first_id;
+    uint32_t num_vertices, num_edges;
+    error_t status;
+    int i;
+
+    char *db_name = "test_write_batch.fdb";
+    char *wal_name = "test_write_batch.log";
+    db_file = fopen(db_name, "w+b");
+    wal_file = fopen(wal_name, "w+b");
+    Fabric_create_graph(db_file, &graph);
+    Fabric_close_graph(&graph);
+    assert(FABRIC_OK == Fabric_load_logged_graph(db_file, wal_file, &graph));
+
+    // a committed batch flushes every store and commits the log once
+    assert(FABRIC_OK == Fabric_WriteBatch_begin(&batch, &graph));
+    assert(FABRIC_WRITEBATCH_ERROR == Fabric_WriteBatch_begin(&other, &graph));
+    person = Fabric_ClassStore_create_class(&graph.class_store, NULL, "Person", FALSE, &status);
+    assert(FABRIC_OK == status);
+    first_id = Fabric_VertexStore_create_vertices(&graph.vertex_store, person, WRITE_BATCH_TEST_VERTICES, &status);
+    assert(FABRIC_OK == status && 1 == first_id);
+    knows = Fabric_LabelStore_add_label(&graph.label_store, "knows", &status);
+    assert(FABRIC_OK == status);
+    for (i = 1; i < WRITE_BATCH_TEST_VERTICES; i++) {
+        Fabric_EdgeStore_create_edge(&graph.edge_store, knows,
+            test_get_vertex(&graph, i), test_get_vertex(&graph, i + 1), &status);
+        assert(FABRIC_OK == status);
+    }
+    assert(Fabric_WriteBatch_get_page_count(&batch) > 0);
+    assert(FABRIC_OK == Fabric_WriteBatch_commit(&batch));
+    assert(NULL == Fabric_Graph_get_write_batch(&graph));
+    assert(FABRIC_WRITEBATCH_ERROR == Fabric_WriteBatch_commit(&batch));
+    assert(Fabric_IdSet_is_empty(graph.class_store.changed));
+    assert(Fabric_IdSet_is_empty(graph.vertex_store.changed));
+    assert(Fabric_IdSet_is_empty(graph.edge_store.changed));
+    num_vertices = graph.vertex_store.num_vertices;
+    num_edges = graph.edge_store.num_edges;
+    assert(WRITE_BATCH_TEST_VERTICES == num_vertices);
+
+    // an aborted batch leaves no trace in the stores or the indices
+    assert(FABRIC_OK == Fabric_WriteBatch_begin(&batch, &graph));
+    c = Fabric_ClassStore_create_class(&graph.class_store, write_batch_get_class(&graph, "Person"),
+        "Temporary", FALSE, &status);
+    assert(FABRIC_OK == status);
+    Fabric_VertexStore_create_vertices(&graph.vertex_store, c, 5, &status);
+    assert(FABRIC_OK == status);
+    v = Fabric_VertexStore_create_vertex(&graph.vertex_store, write_batch_get_class(&graph, "Person"), &status);
+    assert(FABRIC_OK == status);
+    Fabric_EdgeStore_create_edge(&graph.edge_store, knows, v, test_get_vertex(&graph, 1), &status);
+    assert(FABRIC_OK == status);
+    Fabric_LabelStore_add_label(&graph.label_store, "dislikes", &status);
+    assert(FABRIC_OK == status);
+    // a flush in the middle of the batch is undone too
+    assert(FABRIC_OK == Fabric_VertexStore_flush(&graph.vertex_store));
+    assert(FABRIC_OK == Fabric_WriteBatch_abort(&batch));
+    assert(NULL == Fabric_Graph_get_write_batch(&graph));
+
+    assert(NULL == Fabric_ClassStore_get_class_by_name(&graph.class_store, "Temporary", &status));
+    assert(FABRIC_CLASS_DOESNT_EXIST == status);
+    person = write_batch_get_class(&graph, "Person");
+    assert(0 == Fabric_Class_get_first_child_class_id(person));
+    assert(WRITE_BATCH_TEST_VERTICES == Fabric_Class_get_count(person));
+    assert(num_vertices == graph.vertex_store.num_vertices);
+    assert(num_edges == graph.edge_store.num_edges);
+    assert(NULL == Fabric_VertexStore_get_vertex(&graph.vertex_store, WRITE_BATCH_TEST_VERTICES + 1, &status));
+    assert(FABRIC_OK != status);
+    assert(0 == Fabric_Vertex_get_first_in_edge_id(test_get_vertex(&graph, 1)));
+    assert(NULL == Fabric_LabelStore_get_label_by_name(&graph.label_store, "dislikes", &status));
+
+    // the graph can be changed again after an abort
+    assert(FABRIC_OK == Fabric_WriteBatch_begin(&batch, &graph));
+    c = Fabric_ClassStore_create_class(&graph.class_store, person, "Temporary", FALSE, &status);
+    assert(FABRIC_OK == status);
+    v = Fabric_VertexStore_create_vertex(&graph.vertex_store, c, &status);
+    assert(FABRIC_OK == status && WRITE_BATCH_TEST_VERTICES + 1 == Fabric_Vertex_get_id(v));
+    assert(FABRIC_OK == Fabric_WriteBatch_commit(&batch));
+    Fabric_close_graph(&graph);
+
+    // committed batches are all that is in the file
+    Fabric_load_graph(db_file, &graph);
+    person = write_batch_get_class(&graph, "Person");
+    c = write_batch_get_class(&graph, "Temporary");
+    assert(Fabric_Class_get_id(c) == Fabric_Class_get_first_child_class_id(person));
+    assert(1 == Fabric_Class_get_count(c));
+    assert(WRITE_BATCH_TEST_VERTICES + 1 == graph.vertex_store.num_vertices);
+    assert(num_edges == graph.edge_store.num_edges);
+    assert(NULL == Fabric_LabelStore_get_label_by_name(&graph.label_store, "dislikes", &status));
+    assert(Fabric_Vertex_get_id(test_get_vertex(&graph, 2)) ==
+        Fabric_Edge_get_to_vertex_id(Fabric_EdgeStore_get_edge(&graph.edge_store,
+            Fabric_Vertex_get_first_out_edge_id(test_get_vertex(&graph, 1)), &status)));
+    Fabric_close_graph(&graph);
+
+    fclose(wal_file);
+    fclose(db_file);
+    remove(wal_name);
+    remove(db_name);
+    printf("All tests passed for write batches.\n");
+}
+
+#ifndef _FABRIC_TEST_ALL__
+int main() {
+    Fabric_meminit();
+    test_write_batch();
+    return 0;
+}
+#endif
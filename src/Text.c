@@ -3,7 +3,7 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 26, 2015
- * Updated: March 27, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_TEXT_C__
@@ -18,7 +18,11 @@
  * by id.
  *
  * Each text object has a stored header which consists of
- * a 4 byte size.  A text's data is stored in FABRIC_TEXT_BLOCK_SIZE
+ * a 4 byte size.  The high bit of the size marks a compressed
+ * value.  The rest of the size is then the number of bytes stored
+ * after the header: a second 4 byte size, which is the size of the
+ * value, followed by the value compressed as described in
+ * Compression.c.  A text's data is stored in FABRIC_TEXT_BLOCK_SIZE
  * units.  What this means is that a text's data will use
  * at least that much space to store a value and will will
  * add enough of this size of data in order to have enough
@@ -37,7 +41,7 @@
  * And the total number of blocks the text object will take
  * is determined with the formula
  *
- *      (size + sizeof(uint32_t)) / FABRIC_TEXT_BLOCK_SIZE + 1
+ *      (stored size + sizeof(uint32_t)) / FABRIC_TEXT_BLOCK_SIZE + 1
  *
  * A null terminator is not saved in the database, but it is
  * added when the value is retrieved.
@@ -46,11 +50,51 @@
  * where knowing the size of the text is all that is needed.
  */
 typedef struct Text {
-    textid_t id;        // The id of the text
-    uint32_t size;     // The size of the data in bytes
-    text_t value;       // The value of this text node
+    textid_t id;            // The id of the text
+    uint32_t size;          // The size of the data in bytes
+    uint32_t stored_size;   // The number of bytes stored after the header's first 4
+    bool_t is_compressed;   // Whether the data is stored compressed
+    text_t value;           // The value of this text node
 } Text;
 
+/**
+ * Creates a new text object with no value
+ *
+ * Args:
+ *      id: The id of the text
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: A heap allocated text object that is NOT initialized
+ *          or NULL if there is a memory error
+ */
+Text *Fabric_Text_new(textid_t id, error_t *status) {
+    Text *self = Fabric_memalloc_tagged(sizeof(Text), FABRIC_MEM_TEXT);
+    if (NULL == self) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    self->id = id;
+    self->size = 0;
+    self->stored_size = 0;
+    self->is_compressed = FALSE;
+    self->value = NULL;
+    *status = FABRIC_OK;
+    return self;
+}
+
+/**
+ * Frees a text object and its value
+ *
+ * The value must have been allocated with Fabric_memalloc_tagged(2)
+ * against FABRIC_MEM_TEXT, with room for a null terminator.
+ */
+void Fabric_Text_destroy(Text *self) {
+    if (NULL != self->value) {
+        Fabric_memfree_tagged(self->value, self->size + 1, FABRIC_MEM_TEXT);
+    }
+    Fabric_memfree_tagged(self, sizeof(Text), FABRIC_MEM_TEXT);
+}
+
 /**
  * Gets the id of a text object
  */
@@ -80,7 +124,9 @@ void Fabric_Text_set_id(Text *self, textid_t id) {
  *
  * Args:
  *      self: The text object being initialized
- *      data: The text object's header (4 bytes)
+ *      data: The first FABRIC_TEXT_HEADER_SIZE bytes of the text's
+ *            record.  Only the first 4 are used if the text isn't
+ *            compressed.
  *
  * Returns: FABRIC_OK on success, other error number of failure
  */
@@ -88,7 +134,10 @@ error_t Fabric_Text_init(Text *self, uint8_t *data) {
     if (self->id < 1) {
         return FABRIC_TEXT_INVALID_ID;
     }
-    self->size = betoh32(*(uint32_t*)data);
+    self->stored_size = betoh32(*(uint32_t*)data);
+    self->is_compressed = (self->stored_size & FABRIC_TEXT_COMPRESSED) != 0;
+    self->stored_size &= ~FABRIC_TEXT_COMPRESSED;
+    self->size = self->is_compressed ? betoh32(*(uint32_t*)(data + 4)) : self->stored_size;
     // The value isn't loaded at initialization time
     // It must be set externally
     self->value = NULL;
@@ -102,6 +151,21 @@ uint32_t Fabric_Text_get_size(Text *self) {
     return self->size;
 }
 
+/**
+ * Gets the number of bytes a text object's data uses in the store, not
+ * counting the first 4 bytes of its header
+ */
+uint32_t Fabric_Text_get_stored_size(Text *self) {
+    return self->stored_size;
+}
+
+/**
+ * Checks whether a text object's data is stored compressed
+ */
+bool_t Fabric_Text_is_compressed(Text *self) {
+    return self->is_compressed;
+}
+
 /**
  * Sets a text objects data size.
  */
@@ -3,14 +3,17 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 23, 2015
- * Updated: March 27, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_TEXTSTORE_C__
 #define _FABRIC_TEXTSTORE_C__
 
+#include <string.h>
 #include "Internal.h"
 
+#define FABRIC_TEXTSTORE_HEADER_SIZE 8
+
 /**
  * The Text Store is the component of the graph that has the responsibility
  * of managing the storage of text.
@@ -20,11 +23,24 @@
  *
  * For a detailed description of text objects, see the accompanying
  * Text.c file.
+ *
+ * Texts are appended to the store.  The store's header holds the id of
+ * the first unused block and the number of texts.  A text's blocks have
+ * consecutive ids, but they are chained across the store's extents, so a
+ * long text that reaches the end of one extent carries on at the start
+ * of the next.  Its value is read with one read for each extent it
+ * touches.  The space of deleted texts is not reused.
+ *
+ * Texts of at least FABRIC_TEXT_COMPRESSION_THRESHOLD bytes are stored
+ * compressed when that makes them smaller.
  */
 typedef struct TextStore {
     uint32_t offset;        // graph file offset for the class store
     uint32_t size;          // the size of the class store
+    ExtentList extents;     // the regions of the file that hold the text store
     uint32_t block_size;    // the size of each block of text
+    textid_t next_id;       // the first unused block
+    uint32_t num_texts;     // the number of texts in the store
 } TextStore;
 
 /**
@@ -36,29 +52,338 @@ typedef struct TextStore {
  */
 void Fabric_TextStore_init(TextStore *self) {
     Graph *graph = Fabric_TextStore_get_graph(self);
-    self->size = Fabric_Graph_get_index_store_offset(graph) - self->offset;
+    uint8_t header[2 * sizeof(uint32_t)];
+    self->size = Fabric_ExtentList_get_size(&self->extents);
+    Fabric_Graph_read_store_header(graph, header, sizeof(header), self->offset);
+    self->next_id = betoh32(*(uint32_t*)header);
+    self->num_texts = betoh32(*(uint32_t*)(header + 4));
+    if (self->next_id == 0) {
+        self->next_id = 1;
+    }
+}
+
+/**
+ * Private function that returns the number of blocks a text uses
+ */
+static inline
+uint32_t Fabric_TextStore__num_blocks(TextStore *self, uint32_t stored_size) {
+    return (stored_size + sizeof(uint32_t)) / self->block_size + 1;
+}
+
+/**
+ * Private function that reads or writes part of a text's blocks
+ *
+ * The bytes are split at the ends of extents, so there is one read or
+ * write for each extent.
+ *
+ * Args:
+ *      self: A graph's text store
+ *      text_id: The text's first block
+ *      position: Where the bytes start, counted from the text's header
+ *      bytes: The bytes being written, or where the bytes are read to
+ *      num_bytes: The number of bytes
+ *      write: TRUE to write the bytes, FALSE to read them
+ */
+static
+error_t Fabric_TextStore__access(
+    TextStore *self,
+    textid_t text_id,
+    uint32_t position,
+    uint8_t *bytes,
+    uint32_t num_bytes,
+    bool_t write) {
+
+    Graph *graph = Fabric_TextStore_get_graph(self);
+    uint32_t block_id, within, contiguous, length, offset;
+    error_t status;
+
+    while (num_bytes > 0) {
+        block_id = text_id + position / self->block_size;
+        within = position % self->block_size;
+        if (block_id > self->extents.capacity) {
+            return FABRIC_TEXTSTORE_ERROR;
+        }
+        contiguous = Fabric_ExtentList_get_contiguous(&self->extents, block_id);
+        length = contiguous * self->block_size - within;
+        if (length > num_bytes) {
+            length = num_bytes;
+        }
+        offset = Fabric_ExtentList_get_record_offset(&self->extents, block_id) + within;
+        if (write) {
+            status = Fabric_Graph_write_bytes(graph, bytes, length, offset);
+        } else {
+            status = Fabric_Graph_read_bytes(graph, bytes, length, offset);
+        }
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        Fabric_stats_add((write ? FABRIC_STAT_RECORDS_WRITTEN : FABRIC_STAT_RECORDS_READ) + FABRIC_STATS_TEXT_STORE,
+            (within + length + self->block_size - 1) / self->block_size);
+        position += length;
+        bytes += length;
+        num_bytes -= length;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private type holding the fields of a text's header
+ */
+typedef struct TextHeader {
+    uint32_t size;          // The size of the value
+    uint32_t stored_size;   // The number of bytes stored after the first 4
+    bool_t is_compressed;   // Whether the value is compressed
+} TextHeader;
+
+/**
+ * Private function that reads and checks a text's header
+ *
+ * Args:
+ *      self: A graph's text store
+ *      text_id: The id of the text
+ *      bytes: Where the header's FABRIC_TEXT_HEADER_SIZE bytes are read to
+ *      header: Where the header's fields are stored
+ */
+static
+error_t Fabric_TextStore__read_header(TextStore *self, textid_t text_id, uint8_t *bytes, TextHeader *header) {
+    error_t status;
+
+    if (text_id < 1 || text_id >= self->next_id) {
+        return FABRIC_TEXT_INVALID_ID;
+    }
+    // The first block always holds the whole header
+    status = Fabric_TextStore__access(self, text_id, 0, bytes, FABRIC_TEXT_HEADER_SIZE, FALSE);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    header->stored_size = betoh32(*(uint32_t*)bytes);
+    header->is_compressed = (header->stored_size & FABRIC_TEXT_COMPRESSED) != 0;
+    header->stored_size &= ~FABRIC_TEXT_COMPRESSED;
+    header->size = header->is_compressed ? betoh32(*(uint32_t*)(bytes + 4)) : header->stored_size;
+    if ((header->is_compressed && header->stored_size < sizeof(uint32_t)) ||
+        Fabric_TextStore__num_blocks(self, header->stored_size) > self->next_id - text_id) {
+        return FABRIC_TEXTSTORE_ERROR;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Private function that reads a text's value into a buffer of at least
+ * its size plus a null terminator
+ */
+static
+error_t Fabric_TextStore__read_value(TextStore *self, textid_t text_id, TextHeader *header, uint8_t *value) {
+    uint32_t compressed_size;
+    uint8_t *compressed;
+    error_t status;
+
+    value[header->size] = '\0';
+    if (!header->is_compressed) {
+        return Fabric_TextStore__access(self, text_id, sizeof(uint32_t), value, header->size, FALSE);
+    }
+
+    // A compressed value follows the 8 byte header
+    compressed_size = header->stored_size - sizeof(uint32_t);
+    compressed = Fabric_memalloc_tagged(compressed_size, FABRIC_MEM_TEXT);
+    if (NULL == compressed && compressed_size > 0) {
+        return Fabric_memerrno();
+    }
+    status = Fabric_TextStore__access(self, text_id, FABRIC_TEXT_HEADER_SIZE, compressed, compressed_size, FALSE);
+    if (FABRIC_OK == status && !Fabric_Compression_decompress(compressed, compressed_size, value, header->size)) {
+        status = FABRIC_TEXTSTORE_ERROR;
+    }
+    if (NULL != compressed) {
+        Fabric_memfree_tagged(compressed, compressed_size, FABRIC_MEM_TEXT);
+    }
+    return status;
 }
 
 /**
  * Loads a text object from the database
  *
+ * The text's value is loaded too.  The text must be freed with
+ * Fabric_Text_destroy(1).
+ *
  * Args:
  *      self: A graph's text store
  *      text_id: The id of the text object being retrieved
- *      out: A memory location to store the text object in
+ *      status: A pointer to where an error can be indicated
  *
- * Returns: FABRIC_OK on success, a different error code on failure
+ * Returns: The text object or NULL on failure
  */
 Text *Fabric_TextStore_get_text(TextStore *self, textid_t text_id, error_t *status) {
-    // TODO: this is a stub
-    *status = FABRIC_OK;
-    return NULL;
+    uint8_t bytes[FABRIC_TEXT_HEADER_SIZE];
+    TextHeader header;
+    text_t value;
+    Text *text;
+
+    *status = Fabric_TextStore__read_header(self, text_id, bytes, &header);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    text = Fabric_Text_new(text_id, status);
+    if (NULL == text) {
+        return NULL;
+    }
+    *status = Fabric_Text_init(text, bytes);
+    if (FABRIC_OK != *status) {
+        Fabric_Text_destroy(text);
+        return NULL;
+    }
+    value = Fabric_memalloc_tagged(header.size + 1, FABRIC_MEM_TEXT);
+    if (NULL == value) {
+        *status = Fabric_memerrno();
+        Fabric_Text_destroy(text);
+        return NULL;
+    }
+    Fabric_Text_set_value(text, value);
+    *status = Fabric_TextStore__read_value(self, text_id, &header, (uint8_t*)value);
+    if (FABRIC_OK != *status) {
+        Fabric_Text_destroy(text);
+        return NULL;
+    }
+    return text;
+}
+
+/**
+ * Reads a text's value into an arena
+ *
+ * Unlike Fabric_TextStore_get_text, no text object is created and the
+ * value isn't allocated on its own.  A query that reads many texts can
+ * give them one arena and release them together.
+ *
+ * Args:
+ *      self: A graph's text store
+ *      text_id: The id of the text being read
+ *      arena: The arena the null terminated value is allocated from
+ *      size: Where the size of the value is stored, or NULL
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The value or NULL on failure
+ */
+text_t Fabric_TextStore_read_text(TextStore *self, textid_t text_id, MemArena *arena, uint32_t *size, error_t *status) {
+    uint8_t bytes[FABRIC_TEXT_HEADER_SIZE];
+    TextHeader header;
+    uint8_t *value;
+
+    *status = Fabric_TextStore__read_header(self, text_id, bytes, &header);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    value = Fabric_memarena_alloc(arena, header.size + 1);
+    if (NULL == value) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    *status = Fabric_TextStore__read_value(self, text_id, &header, value);
+    if (FABRIC_OK != *status) {
+        return NULL;
+    }
+    if (NULL != size) {
+        *size = header.size;
+    }
+    return (text_t)value;
 }
 
+/**
+ * Private function that compresses a value for storage
+ *
+ * Returns: The header and value to store, whose allocated size is put
+ *          in record_size, or NULL if the value isn't smaller compressed
+ */
+static
+uint8_t *Fabric_TextStore__compress(text_t value, uint32_t size, uint32_t *stored_size, uint32_t *record_size) {
+    uint32_t capacity, compressed_size;
+    uint8_t *record;
+
+    if (0 == FABRIC_TEXT_COMPRESSION_THRESHOLD || size < FABRIC_TEXT_COMPRESSION_THRESHOLD) {
+        return NULL;
+    }
+    // Compressing must save more than the extra size field
+    capacity = size - sizeof(uint32_t) - 1;
+    record = Fabric_memalloc_tagged(FABRIC_TEXT_HEADER_SIZE + capacity, FABRIC_MEM_TEXT);
+    if (NULL == record) {
+        return NULL;
+    }
+    compressed_size = Fabric_Compression_compress((uint8_t*)value, size,
+        record + FABRIC_TEXT_HEADER_SIZE, capacity);
+    if (0 == compressed_size) {
+        Fabric_memfree_tagged(record, FABRIC_TEXT_HEADER_SIZE + capacity, FABRIC_MEM_TEXT);
+        return NULL;
+    }
+    *stored_size = compressed_size + sizeof(uint32_t);
+    *record_size = FABRIC_TEXT_HEADER_SIZE + capacity;
+    *(uint32_t*)record = htobe32(*stored_size | FABRIC_TEXT_COMPRESSED);
+    *(uint32_t*)(record + 4) = htobe32(size);
+    return record;
+}
+
+/**
+ * Stores a new text in the database
+ *
+ * Args:
+ *      self: A graph's text store
+ *      value: The null terminated text being stored
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The id of the new text or 0 on failure
+ */
 textid_t Fabric_TextStore_create_text(TextStore *self, text_t value, error_t *status) {
-    // TODO: this is a stub
-    *status = FABRIC_OK;
-    return NULL;
+    Graph *graph = Fabric_TextStore_get_graph(self);
+    uint32_t size = strlen(value);
+    uint32_t stored_size = size, record_size = 0;
+    uint8_t *record = Fabric_TextStore__compress(value, size, &stored_size, &record_size);
+    uint32_t num_blocks = Fabric_TextStore__num_blocks(self, stored_size);
+    uint8_t header[sizeof(uint32_t)];
+    textid_t text_id = self->next_id;
+
+    *status = Fabric_Graph_grow_store(graph, FABRIC_TEXT_STORE, text_id + num_blocks - 1);
+    if (FABRIC_OK == *status) {
+        if (NULL != record) {
+            *status = Fabric_TextStore__access(self, text_id, 0, record,
+                stored_size + sizeof(uint32_t), TRUE);
+        } else {
+            *(uint32_t*)header = htobe32(size);
+            *status = Fabric_TextStore__access(self, text_id, 0, header, sizeof(header), TRUE);
+            if (FABRIC_OK == *status) {
+                *status = Fabric_TextStore__access(self, text_id, sizeof(header), (uint8_t*)value, size, TRUE);
+            }
+        }
+    }
+    if (NULL != record) {
+        Fabric_memfree_tagged(record, record_size, FABRIC_MEM_TEXT);
+    }
+    if (FABRIC_OK != *status) {
+        return 0;
+    }
+
+    self->next_id = text_id + num_blocks;
+    self->num_texts++;
+    self->size = Fabric_ExtentList_get_size(&self->extents);
+    Fabric_Graph_update_uint32(graph, self->next_id, self->offset);
+    Fabric_Graph_update_uint32(graph, self->num_texts, self->offset + 4);
+    return text_id;
+}
+
+/**
+ * Deletes a text from the database
+ *
+ * The text's blocks are not reused.
+ *
+ * Args:
+ *      self: A graph's text store
+ *      text_id: The id of the text being deleted
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_TextStore_delete_text(TextStore *self, textid_t text_id) {
+    Graph *graph = Fabric_TextStore_get_graph(self);
+    if (text_id < 1 || text_id >= self->next_id) {
+        return FABRIC_TEXT_INVALID_ID;
+    }
+    self->num_texts--;
+    Fabric_Graph_update_uint32(graph, self->num_texts, self->offset + 4);
+    return FABRIC_OK;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,702 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_TRAVERSAL_C__
+#define _FABRIC_TRAVERSAL_C__
+
+#include <string.h>
+#include <unistd.h>
+#ifndef FABRIC_NO_THREADS
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+#include "Internal.h"
+
+/**
+ * Traversals walk an adjacency snapshot with a pool of worker threads.
+ *
+ * A snapshot's rows are plain arrays that don't change until it is
+ * refreshed, so any number of workers can read them at once.  The
+ * snapshot must not be refreshed or destroyed while a traversal runs.
+ *
+ * The work of each step of a traversal is a range of items, such as the
+ * vertices of a breadth first search's frontier.  The range is split
+ * evenly between the workers' deques.  A worker takes ranges from the
+ * bottom of its own deque, pushes back the top half of any range bigger
+ * than FABRIC_TRAVERSAL_GRAIN and works on the rest.  A worker whose
+ * deque is empty steals from the top of another worker's deque, which
+ * holds the biggest ranges.  The step is finished once every item has
+ * been worked on.  The thread that started the traversal is one of the
+ * workers.
+ *
+ * Visited vertices are marked in a bitmap indexed by vertex id, with a
+ * bit set by an atomic or so exactly one worker claims each vertex.
+ *
+ * Defining FABRIC_NO_THREADS gives every pool a single worker, which is
+ * the calling thread.
+ */
+#define FABRIC_TRAVERSAL__DEQUE_SIZE 64
+#define FABRIC_TRAVERSAL__BUFFER_SIZE 256
+
+#ifndef FABRIC_NO_THREADS
+#  define FABRIC_TRAVERSAL__LOAD(field) __atomic_load_n(&(field), __ATOMIC_ACQUIRE)
+#  define FABRIC_TRAVERSAL__STORE(field, value) __atomic_store_n(&(field), (value), __ATOMIC_RELEASE)
+#  define FABRIC_TRAVERSAL__FETCH_ADD(field, delta) __atomic_fetch_add(&(field), (delta), __ATOMIC_ACQ_REL)
+#  define FABRIC_TRAVERSAL__FETCH_OR(field, bits) __atomic_fetch_or(&(field), (bits), __ATOMIC_RELAXED)
+#  define FABRIC_TRAVERSAL__CAS(field, expected, desired) \
+    __atomic_compare_exchange_n(&(field), &(expected), (desired), FALSE, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#  define FABRIC_TRAVERSAL__LOCK(lock) pthread_mutex_lock(lock)
+#  define FABRIC_TRAVERSAL__UNLOCK(lock) pthread_mutex_unlock(lock)
+#else
+#  define FABRIC_TRAVERSAL__LOAD(field) (field)
+#  define FABRIC_TRAVERSAL__STORE(field, value) ((field) = (value))
+#  define FABRIC_TRAVERSAL__FETCH_ADD(field, delta) Fabric_Traversal__fetch_add(&(field), (delta))
+#  define FABRIC_TRAVERSAL__FETCH_OR(field, bits) Fabric_Traversal__fetch_or(&(field), (bits))
+#  define FABRIC_TRAVERSAL__CAS(field, expected, desired) Fabric_Traversal__cas(&(field), &(expected), (desired))
+#  define FABRIC_TRAVERSAL__LOCK(lock)
+#  define FABRIC_TRAVERSAL__UNLOCK(lock)
+
+static inline
+uint32_t Fabric_Traversal__fetch_add(uint32_t *field, uint32_t delta) {
+    uint32_t old = *field;
+    *field += delta;
+    return old;
+}
+
+static inline
+uint64_t Fabric_Traversal__fetch_or(uint64_t *field, uint64_t bits) {
+    uint64_t old = *field;
+    *field |= bits;
+    return old;
+}
+
+static inline
+bool_t Fabric_Traversal__cas(uint32_t *field, uint32_t *expected, uint32_t desired) {
+    if (*field != *expected) {
+        *expected = *field;
+        return FALSE;
+    }
+    *field = desired;
+    return TRUE;
+}
+#endif
+
+typedef struct TraversalRange {
+    uint32_t begin;         // The first item of the range
+    uint32_t end;           // The item after the last one
+} TraversalRange;
+
+typedef struct TraversalWorker {
+    TraversalPool *pool;            // The pool the worker belongs to
+    uint32_t index;                 // The worker's position in the pool
+    TraversalRange deque[FABRIC_TRAVERSAL__DEQUE_SIZE];    // Ranges waiting to be worked on
+    uint32_t top;                   // Where ranges are stolen from
+    uint32_t bottom;                // Where the worker pushes and takes ranges
+    vertexid_t found[FABRIC_TRAVERSAL__BUFFER_SIZE];       // Vertices not yet added to the output
+    uint32_t num_found;             // The number of buffered vertices
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_t lock;           // Protects the deque
+    pthread_t thread;               // The worker's thread; worker 0 has none
+#endif
+} TraversalWorker;
+
+/* Works on the items in [begin, end) of the current step */
+typedef void (*Fabric_Traversal__job)(void *context, TraversalWorker *worker, uint32_t begin, uint32_t end);
+
+struct TraversalPool {
+    uint32_t num_workers;           // The number of workers, including the calling thread
+    TraversalWorker *workers;       // The workers
+    Fabric_Traversal__job job;      // The job of the current step
+    void *context;                  // The job's context
+    uint32_t remaining;             // The items of the current step not yet worked on
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_t lock;           // Protects the fields below
+    pthread_cond_t wake;            // Signalled when a step starts or the pool stops
+    pthread_cond_t idle;            // Signalled when the last helper finishes a step
+    uint32_t step;                  // Counts the steps that have been started
+    uint32_t busy;                  // The helpers still working on the current step
+    bool_t stopping;                // Whether the helpers should exit
+    uint32_t num_threads;           // The number of helper threads started
+#endif
+};
+
+/**
+ * Private function that pushes a range onto the bottom of a worker's deque
+ *
+ * Returns: FALSE if the deque is full
+ */
+static
+bool_t Fabric_TraversalWorker__push(TraversalWorker *self, uint32_t begin, uint32_t end) {
+    bool_t pushed = FALSE;
+    FABRIC_TRAVERSAL__LOCK(&self->lock);
+    if (self->bottom - self->top < FABRIC_TRAVERSAL__DEQUE_SIZE) {
+        self->deque[self->bottom % FABRIC_TRAVERSAL__DEQUE_SIZE].begin = begin;
+        self->deque[self->bottom % FABRIC_TRAVERSAL__DEQUE_SIZE].end = end;
+        self->bottom++;
+        pushed = TRUE;
+    }
+    FABRIC_TRAVERSAL__UNLOCK(&self->lock);
+    return pushed;
+}
+
+/**
+ * Private function that takes a range from either end of a worker's deque
+ *
+ * Returns: FALSE if the deque is empty
+ */
+static
+bool_t Fabric_TraversalWorker__take(TraversalWorker *self, bool_t from_top, TraversalRange *range) {
+    bool_t taken = FALSE;
+    FABRIC_TRAVERSAL__LOCK(&self->lock);
+    if (self->bottom != self->top) {
+        if (from_top) {
+            *range = self->deque[self->top % FABRIC_TRAVERSAL__DEQUE_SIZE];
+            self->top++;
+        } else {
+            self->bottom--;
+            *range = self->deque[self->bottom % FABRIC_TRAVERSAL__DEQUE_SIZE];
+        }
+        taken = TRUE;
+    }
+    FABRIC_TRAVERSAL__UNLOCK(&self->lock);
+    return taken;
+}
+
+/**
+ * Private function that works on the current step until none of its
+ * items are left
+ */
+static
+void Fabric_TraversalPool__work(TraversalPool *self, TraversalWorker *worker) {
+    TraversalRange range;
+    uint32_t i, victim, mid;
+    bool_t found;
+
+    while (FABRIC_TRAVERSAL__LOAD(self->remaining) > 0) {
+        found = Fabric_TraversalWorker__take(worker, FALSE, &range);
+        for (i = 1; !found && i < self->num_workers; i++) {
+            victim = (worker->index + i) % self->num_workers;
+            found = Fabric_TraversalWorker__take(&self->workers[victim], TRUE, &range);
+        }
+        if (!found) {
+#ifndef FABRIC_NO_THREADS
+            sched_yield();
+#endif
+            continue;
+        }
+        // Leave the top halves of a big range for thieves
+        while (range.end - range.begin > FABRIC_TRAVERSAL_GRAIN) {
+            mid = range.begin + (range.end - range.begin) / 2;
+            if (!Fabric_TraversalWorker__push(worker, mid, range.end)) {
+                break;
+            }
+            range.end = mid;
+        }
+        self->job(self->context, worker, range.begin, range.end);
+        FABRIC_TRAVERSAL__FETCH_ADD(self->remaining, -(range.end - range.begin));
+    }
+}
+
+#ifndef FABRIC_NO_THREADS
+/**
+ * Private function run by each helper thread of a pool
+ */
+static
+void *Fabric_TraversalPool__helper(void *arg) {
+    TraversalWorker *worker = arg;
+    TraversalPool *self = worker->pool;
+    uint32_t step = 0;
+
+    pthread_mutex_lock(&self->lock);
+    while (TRUE) {
+        while (!self->stopping && self->step == step) {
+            pthread_cond_wait(&self->wake, &self->lock);
+        }
+        if (self->stopping) {
+            break;
+        }
+        step = self->step;
+        pthread_mutex_unlock(&self->lock);
+        Fabric_TraversalPool__work(self, worker);
+        pthread_mutex_lock(&self->lock);
+        if (0 == --self->busy) {
+            pthread_cond_signal(&self->idle);
+        }
+    }
+    pthread_mutex_unlock(&self->lock);
+    return NULL;
+}
+#endif
+
+/**
+ * Private function that runs a job over the items [0, count) with all of
+ * a pool's workers, returning once every item has been worked on
+ */
+static
+void Fabric_TraversalPool__run(TraversalPool *self, uint32_t count, Fabric_Traversal__job job, void *context) {
+    uint32_t i, begin, end;
+
+    if (0 == count) {
+        return;
+    }
+    self->job = job;
+    self->context = context;
+    self->remaining = count;
+    for (i = 0; i < self->num_workers; i++) {
+        begin = (uint32_t)((uint64_t)count * i / self->num_workers);
+        end = (uint32_t)((uint64_t)count * (i + 1) / self->num_workers);
+        self->workers[i].top = self->workers[i].bottom = 0;
+        if (end > begin) {
+            Fabric_TraversalWorker__push(&self->workers[i], begin, end);
+        }
+    }
+
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_lock(&self->lock);
+    self->step++;
+    self->busy = self->num_threads;
+    pthread_cond_broadcast(&self->wake);
+    pthread_mutex_unlock(&self->lock);
+#endif
+    Fabric_TraversalPool__work(self, &self->workers[0]);
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_lock(&self->lock);
+    while (self->busy > 0) {
+        pthread_cond_wait(&self->idle, &self->lock);
+    }
+    pthread_mutex_unlock(&self->lock);
+#endif
+}
+
+/**
+ * Creates a pool of workers for traversals
+ *
+ * Args:
+ *      num_workers: The number of workers including the calling thread,
+ *                   or 0 for one per online processor.  At most
+ *                   FABRIC_TRAVERSAL_MAX_THREADS are used.
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The new pool or NULL on failure
+ */
+TraversalPool *Fabric_TraversalPool_new(uint32_t num_workers, error_t *status) {
+    TraversalPool *self;
+    uint32_t i;
+    long online;
+
+    if (0 == num_workers) {
+        online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_workers = online > 0 ? (uint32_t)online : 1;
+    }
+    if (num_workers > FABRIC_TRAVERSAL_MAX_THREADS) {
+        num_workers = FABRIC_TRAVERSAL_MAX_THREADS;
+    }
+#ifdef FABRIC_NO_THREADS
+    num_workers = 1;
+#endif
+
+    self = Fabric_memalloc_tagged(sizeof(TraversalPool), FABRIC_MEM_GENERAL);
+    if (NULL == self) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+    self->workers = Fabric_memalloc_tagged(sizeof(TraversalWorker) * num_workers, FABRIC_MEM_GENERAL);
+    if (NULL == self->workers) {
+        *status = Fabric_memerrno();
+        Fabric_memfree_tagged(self, sizeof(TraversalPool), FABRIC_MEM_GENERAL);
+        return NULL;
+    }
+    self->num_workers = num_workers;
+    self->remaining = 0;
+    for (i = 0; i < num_workers; i++) {
+        self->workers[i].pool = self;
+        self->workers[i].index = i;
+        self->workers[i].top = self->workers[i].bottom = 0;
+        self->workers[i].num_found = 0;
+#ifndef FABRIC_NO_THREADS
+        pthread_mutex_init(&self->workers[i].lock, NULL);
+#endif
+    }
+
+    *status = FABRIC_OK;
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_init(&self->lock, NULL);
+    pthread_cond_init(&self->wake, NULL);
+    pthread_cond_init(&self->idle, NULL);
+    self->step = 0;
+    self->busy = 0;
+    self->stopping = FALSE;
+    for (self->num_threads = 0; self->num_threads + 1 < num_workers; self->num_threads++) {
+        if (0 != pthread_create(&self->workers[self->num_threads + 1].thread, NULL,
+                Fabric_TraversalPool__helper, &self->workers[self->num_threads + 1])) {
+            *status = FABRIC_TRAVERSAL_ERROR;
+            Fabric_TraversalPool_destroy(self);
+            return NULL;
+        }
+    }
+#endif
+    return self;
+}
+
+/**
+ * Stops a pool's threads and frees it
+ */
+void Fabric_TraversalPool_destroy(TraversalPool *self) {
+#ifndef FABRIC_NO_THREADS
+    uint32_t i;
+
+    pthread_mutex_lock(&self->lock);
+    self->stopping = TRUE;
+    pthread_cond_broadcast(&self->wake);
+    pthread_mutex_unlock(&self->lock);
+    for (i = 0; i < self->num_threads; i++) {
+        pthread_join(self->workers[i + 1].thread, NULL);
+    }
+    for (i = 0; i < self->num_workers; i++) {
+        pthread_mutex_destroy(&self->workers[i].lock);
+    }
+    pthread_cond_destroy(&self->idle);
+    pthread_cond_destroy(&self->wake);
+    pthread_mutex_destroy(&self->lock);
+#endif
+    Fabric_memfree_tagged(self->workers, sizeof(TraversalWorker) * self->num_workers, FABRIC_MEM_GENERAL);
+    Fabric_memfree_tagged(self, sizeof(TraversalPool), FABRIC_MEM_GENERAL);
+}
+
+/**
+ * Gets the number of workers in a pool, including the calling thread
+ */
+uint32_t Fabric_TraversalPool_get_worker_count(TraversalPool *self) {
+    return self->num_workers;
+}
+
+/**
+ * The state shared by the workers of a breadth first search
+ */
+typedef struct TraversalSearch {
+    AdjacencySnapshot *snapshot;    // The snapshot being searched
+    int direction;                  // The directions of the edges followed
+    uint64_t *visited;              // A bit for each vertex, set once it is reached
+    uint32_t *depths;               // The depth of each vertex or NULL
+    vertexid_t *order;              // The vertices reached, in the order of their depths
+    uint32_t frontier;              // Where the current depth's vertices start in order
+    uint32_t end;                   // The number of vertices in order
+    uint32_t depth;                 // The depth of the frontier
+} TraversalSearch;
+
+/**
+ * Private function that adds a worker's buffered vertices to the output
+ */
+static
+void Fabric_Traversal__flush_found(TraversalSearch *search, TraversalWorker *worker) {
+    uint32_t position;
+    if (worker->num_found > 0) {
+        position = FABRIC_TRAVERSAL__FETCH_ADD(search->end, worker->num_found);
+        memcpy(search->order + position, worker->found, sizeof(vertexid_t) * worker->num_found);
+        worker->num_found = 0;
+    }
+}
+
+/**
+ * Private function that marks a vertex as visited
+ *
+ * Returns: TRUE if this call was the one that marked it
+ */
+static inline
+bool_t Fabric_Traversal__visit(uint64_t *visited, vertexid_t vertex_id) {
+    uint64_t bit = (uint64_t)1 << (vertex_id % 64);
+    if (FABRIC_TRAVERSAL__LOAD(visited[vertex_id / 64]) & bit) {
+        return FALSE;
+    }
+    return 0 == (FABRIC_TRAVERSAL__FETCH_OR(visited[vertex_id / 64], bit) & bit);
+}
+
+/**
+ * Private job that expands part of a search's frontier by one step
+ */
+static
+void Fabric_Traversal__expand(void *context, TraversalWorker *worker, uint32_t begin, uint32_t end) {
+    TraversalSearch *search = context;
+    vertexid_t *neighbors;
+    uint32_t i, j, count;
+    int direction;
+
+    for (i = begin; i < end; i++) {
+        for (direction = FABRIC_DIRECTION_OUT; direction <= FABRIC_DIRECTION_IN; direction++) {
+            if (0 == (search->direction & direction)) {
+                continue;
+            }
+            neighbors = Fabric_AdjacencySnapshot_get_neighbors(
+                search->snapshot, search->order[search->frontier + i], direction, &count);
+            for (j = 0; j < count; j++) {
+                if (!Fabric_Traversal__visit(search->visited, neighbors[j])) {
+                    continue;
+                }
+                if (NULL != search->depths) {
+                    search->depths[neighbors[j]] = search->depth + 1;
+                }
+                if (FABRIC_TRAVERSAL__BUFFER_SIZE == worker->num_found) {
+                    Fabric_Traversal__flush_found(search, worker);
+                }
+                worker->found[worker->num_found++] = neighbors[j];
+            }
+        }
+    }
+    Fabric_Traversal__flush_found(search, worker);
+}
+
+/**
+ * Searches a snapshot breadth first from a vertex
+ *
+ * Each depth is expanded in parallel by the pool's workers, so the order
+ * of the vertices at the same depth varies from run to run.
+ *
+ * Args:
+ *      pool: The workers that search
+ *      snapshot: The adjacency snapshot searched
+ *      start_id: The vertex the search starts from
+ *      direction: FABRIC_DIRECTION_OUT or FABRIC_DIRECTION_IN to follow
+ *                 edges one way, or both or'd together to follow them
+ *                 either way
+ *      max_depth: The greatest number of edges from the start to follow
+ *      vertices: Where the vertices reached are stored, starting with the
+ *                start and in order of their depths, or NULL.  It needs
+ *                room for every vertex of the snapshot.
+ *      depths: Where the depth of every vertex is stored, indexed by vertex
+ *              id, or NULL.  Vertices that weren't reached have a depth of
+ *              FABRIC_TRAVERSAL_UNREACHED.  It needs room for the vertex
+ *              count of the snapshot plus one.
+ *      count: Where the number of vertices reached is stored
+ *
+ * Returns: FABRIC_OK on success, FABRIC_TRAVERSAL_ERROR if the start or
+ *          direction is invalid or other error code on failure
+ */
+error_t Fabric_Traversal_bfs(
+    TraversalPool *pool,
+    AdjacencySnapshot *snapshot,
+    vertexid_t start_id,
+    int direction,
+    uint32_t max_depth,
+    vertexid_t *vertices,
+    uint32_t *depths,
+    uint32_t *count) {
+    uint32_t num_vertices = Fabric_AdjacencySnapshot_get_vertex_count(snapshot);
+    size_t visited_size = sizeof(uint64_t) * (num_vertices / 64 + 1);
+    TraversalSearch search;
+    uint32_t frontier_end;
+
+    *count = 0;
+    if (start_id < 1 || start_id > num_vertices ||
+        0 == (direction & (FABRIC_DIRECTION_OUT | FABRIC_DIRECTION_IN)) ||
+        0 != (direction & ~(FABRIC_DIRECTION_OUT | FABRIC_DIRECTION_IN))) {
+        return FABRIC_TRAVERSAL_ERROR;
+    }
+    search.snapshot = snapshot;
+    search.direction = direction;
+    search.depths = depths;
+    search.order = vertices;
+    search.visited = Fabric_memalloc_tagged(visited_size, FABRIC_MEM_INDEX);
+    if (NULL == vertices) {
+        search.order = Fabric_memalloc_tagged(sizeof(vertexid_t) * num_vertices, FABRIC_MEM_INDEX);
+    }
+    if (NULL == search.visited || NULL == search.order) {
+        error_t status = Fabric_memerrno();
+        if (NULL != search.visited) {
+            Fabric_memfree_tagged(search.visited, visited_size, FABRIC_MEM_INDEX);
+        }
+        if (NULL == vertices && NULL != search.order) {
+            Fabric_memfree_tagged(search.order, sizeof(vertexid_t) * num_vertices, FABRIC_MEM_INDEX);
+        }
+        return status;
+    }
+    memset(search.visited, 0, visited_size);
+    if (NULL != depths) {
+        memset(depths, 0xff, sizeof(uint32_t) * (num_vertices + 1));
+        depths[start_id] = 0;
+    }
+
+    Fabric_Traversal__visit(search.visited, start_id);
+    search.order[0] = start_id;
+    search.frontier = 0;
+    search.end = 1;
+    for (search.depth = 0; search.depth < max_depth && search.frontier < search.end; search.depth++) {
+        frontier_end = search.end;
+        Fabric_TraversalPool__run(pool, frontier_end - search.frontier, Fabric_Traversal__expand, &search);
+        search.frontier = frontier_end;
+    }
+
+    *count = search.end;
+    Fabric_memfree_tagged(search.visited, visited_size, FABRIC_MEM_INDEX);
+    if (NULL == vertices) {
+        Fabric_memfree_tagged(search.order, sizeof(vertexid_t) * num_vertices, FABRIC_MEM_INDEX);
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Finds the vertices within a number of edges of a vertex
+ *
+ * Args:
+ *      pool: The workers that search
+ *      snapshot: The adjacency snapshot searched
+ *      start_id: The vertex whose neighbourhood is found
+ *      direction: The directions of the edges followed, as for
+ *                 Fabric_Traversal_bfs(8)
+ *      hops: The most edges a neighbour can be from the start
+ *      vertices: Where the neighbours are stored, closest first.  It needs
+ *                room for every vertex of the snapshot.
+ *      count: Where the number of neighbours is stored
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Traversal_k_hop(
+    TraversalPool *pool,
+    AdjacencySnapshot *snapshot,
+    vertexid_t start_id,
+    int direction,
+    uint32_t hops,
+    vertexid_t *vertices,
+    uint32_t *count) {
+    error_t status = Fabric_Traversal_bfs(pool, snapshot, start_id, direction, hops, vertices, NULL, count);
+    if (FABRIC_OK == status) {
+        // The start isn't its own neighbour
+        (*count)--;
+        memmove(vertices, vertices + 1, sizeof(vertexid_t) * *count);
+    }
+    return status;
+}
+
+/**
+ * The state shared by the workers finding connected components
+ */
+typedef struct TraversalComponents {
+    AdjacencySnapshot *snapshot;    // The snapshot whose components are found
+    vertexid_t *parents;            // The parent of each vertex in its component's tree
+    uint32_t num_roots;             // The number of components found
+} TraversalComponents;
+
+/**
+ * Private function that finds the root of a vertex's tree, halving the
+ * path to it along the way
+ */
+static
+vertexid_t Fabric_Traversal__find(vertexid_t *parents, vertexid_t vertex_id) {
+    vertexid_t parent, grandparent, expected;
+
+    while ((parent = FABRIC_TRAVERSAL__LOAD(parents[vertex_id])) != vertex_id) {
+        grandparent = FABRIC_TRAVERSAL__LOAD(parents[parent]);
+        if (grandparent != parent) {
+            // Losing this race only leaves the path longer
+            expected = parent;
+            FABRIC_TRAVERSAL__CAS(parents[vertex_id], expected, grandparent);
+        }
+        vertex_id = parent;
+    }
+    return vertex_id;
+}
+
+/**
+ * Private job that joins the trees of the vertices at each end of the
+ * edges of a range of vertices
+ *
+ * The root with the larger id is always put under the one with the
+ * smaller id, so no cycle can form and the root of every tree is its
+ * smallest vertex.
+ */
+static
+void Fabric_Traversal__join(void *context, TraversalWorker *worker, uint32_t begin, uint32_t end) {
+    TraversalComponents *components = context;
+    vertexid_t *neighbors;
+    vertexid_t a, b, swap;
+    uint32_t i, j, count;
+    (void)worker;
+
+    for (i = begin; i < end; i++) {
+        neighbors = Fabric_AdjacencySnapshot_get_neighbors(components->snapshot, i + 1, FABRIC_DIRECTION_OUT, &count);
+        for (j = 0; j < count; j++) {
+            a = i + 1;
+            b = neighbors[j];
+            while (TRUE) {
+                a = Fabric_Traversal__find(components->parents, a);
+                b = Fabric_Traversal__find(components->parents, b);
+                if (a == b) {
+                    break;
+                }
+                if (a < b) {
+                    swap = a;
+                    a = b;
+                    b = swap;
+                }
+                // Another worker may have moved a under a new root first
+                swap = a;
+                if (FABRIC_TRAVERSAL__CAS(components->parents[a], swap, b)) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Private job that points each vertex of a range straight at its root
+ */
+static
+void Fabric_Traversal__flatten(void *context, TraversalWorker *worker, uint32_t begin, uint32_t end) {
+    TraversalComponents *components = context;
+    uint32_t i, num_roots = 0;
+    vertexid_t root;
+    (void)worker;
+
+    for (i = begin + 1; i <= end; i++) {
+        root = Fabric_Traversal__find(components->parents, i);
+        FABRIC_TRAVERSAL__STORE(components->parents[i], root);
+        num_roots += root == i;
+    }
+    FABRIC_TRAVERSAL__FETCH_ADD(components->num_roots, num_roots);
+}
+
+/**
+ * Finds the weakly connected components of a snapshot
+ *
+ * Edges are followed either way.  Every vertex id the snapshot covers is
+ * given a component, so ids that aren't in use are components of their own.
+ *
+ * Args:
+ *      pool: The workers that search
+ *      snapshot: The adjacency snapshot searched
+ *      components: Where the component of each vertex is stored, indexed
+ *                  by vertex id.  A component is named by its smallest
+ *                  vertex id.  It needs room for the vertex count of the
+ *                  snapshot plus one.
+ *      count: Where the number of components is stored
+ *
+ * Returns: FABRIC_OK
+ */
+error_t Fabric_Traversal_connected_components(
+    TraversalPool *pool,
+    AdjacencySnapshot *snapshot,
+    vertexid_t *components,
+    uint32_t *count) {
+    uint32_t num_vertices = Fabric_AdjacencySnapshot_get_vertex_count(snapshot);
+    TraversalComponents state;
+    vertexid_t i;
+
+    components[0] = 0;
+    for (i = 1; i <= num_vertices; i++) {
+        components[i] = i;
+    }
+    state.snapshot = snapshot;
+    state.parents = components;
+    state.num_roots = 0;
+    Fabric_TraversalPool__run(pool, num_vertices, Fabric_Traversal__join, &state);
+    Fabric_TraversalPool__run(pool, num_vertices, Fabric_Traversal__flatten, &state);
+    *count = state.num_roots;
+    return FABRIC_OK;
+}
+
+#endif
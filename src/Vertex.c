@@ -37,6 +37,38 @@ typedef struct Vertex {
     propertyid_t first_property_id; // the id of the first property for this vertex
 } Vertex;
 
+/* Vertex objects are allocated from their own slab */
+static MemSlab Fabric_Vertex__slab = FABRIC_MEMSLAB_INITIALIZER(Vertex);
+
+/**
+ * Creates a new vertex object
+ *
+ * Args:
+ *      id: The internal id of the vertex object being created
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: A heap allocated vertex object that is NOT initialized
+ *          or NULL if there is a memory error
+ */
+Vertex *Fabric_Vertex_new(vertexid_t id, error_t *status) {
+    Vertex *vertex = Fabric_memslab_alloc(&Fabric_Vertex__slab);
+    if (NULL == vertex) {
+        *status = Fabric_memerrno();
+        return NULL;
+    }
+
+    vertex->id = id;
+    *status = FABRIC_OK;
+    return vertex;
+}
+
+/**
+ * Frees a vertex object
+ */
+void Fabric_Vertex_destroy(Vertex *self) {
+    Fabric_memslab_free(&Fabric_Vertex__slab, self);
+}
+
 /**
  * Gets a vertex's id
  */
@@ -75,6 +107,29 @@ error_t Fabric_Vertex_init(Vertex *self, uint8_t *data) {
     return FABRIC_OK;
 }
 
+/**
+ * Writes a vertex's database data
+ *
+ * Args:
+ *      self: The vertex being stored
+ *      dest: An array of 14 bytes to hold the vertex's data
+ */
+void Fabric_Vertex_load_bytes(Vertex *self, uint8_t *dest) {
+    *((classid_t*)dest) = htobe16(self->class_id);
+    *((edgeid_t*)(dest + 2)) = htobe32(self->first_out_id);
+    *((edgeid_t*)(dest + 6)) = htobe32(self->first_in_id);
+    *((propertyid_t*)(dest + 10)) = htobe32(self->first_property_id);
+}
+
+/**
+ * Returns whether or not this vertex is in use.
+ *
+ * A vertex is marked as not in use by setting its class_id to 0
+ */
+bool_t Fabric_Vertex_is_in_use(Vertex *self) {
+    return self->class_id != 0;
+}
+
 /**
  * Gets the id of a vertex's class
  */
@@ -82,6 +137,13 @@ classid_t Fabric_Vertex_get_class_id(Vertex *self) {
     return self->class_id;
 }
 
+/**
+ * Sets the id of a vertex's class
+ */
+void Fabric_Vertex_set_class_id(Vertex *self, classid_t class_id) {
+    self->class_id = class_id;
+}
+
 /**
  * Gets the vertex's class object
  *
@@ -106,6 +168,13 @@ edgeid_t Fabric_Vertex_get_first_out_edge_id(Vertex *self) {
     return self->first_out_id;
 }
 
+/**
+ * Sets the id of the vertex's first out edge
+ */
+void Fabric_Vertex_set_first_out_edge_id(Vertex *self, edgeid_t edge_id) {
+    self->first_out_id = edge_id;
+}
+
 /**
  * Returns: TRUE if the vertex has at least one outgoing edge, FALSE if not.
  */
@@ -137,6 +206,13 @@ edgeid_t Fabric_Vertex_get_first_in_edge_id(Vertex *self) {
     return self->first_in_id;
 }
 
+/**
+ * Sets the id of the vertex's first in edge
+ */
+void Fabric_Vertex_set_first_in_edge_id(Vertex *self, edgeid_t edge_id) {
+    self->first_in_id = edge_id;
+}
+
 /**
  * Returns: TRUE if the vertex has at least one incoming edge, FALSE if not.
  */
@@ -168,6 +244,13 @@ propertyid_t Fabric_Vertex_get_first_property_id(Vertex *self) {
     return self->first_property_id;
 }
 
+/**
+ * Sets the id of the vertex's first property
+ */
+void Fabric_Vertex_set_first_property_id(Vertex *self, propertyid_t property_id) {
+    self->first_property_id = property_id;
+}
+
 /**
  * Gets the vertex's first property
  *
@@ -196,4 +279,45 @@ bool_t Fabric_Vertex_has_properties(Vertex *self) {
     return self->first_property_id != 0;
 }
 
-#endif
\ No newline at end of file
+/**
+ * Vertex views
+ *
+ * These read the fields of a vertex record straight from an EntityView
+ * without initializing a vertex object.
+ */
+/**
+ * Gets the id of a viewed vertex's class
+ */
+classid_t Fabric_VertexView_get_class_id(EntityView *view) {
+    return betoh16(*(classid_t*)Fabric_EntityView_get_data(view));
+}
+
+/**
+ * Returns whether or not a viewed vertex is in use
+ */
+bool_t Fabric_VertexView_is_in_use(EntityView *view) {
+    return Fabric_VertexView_get_class_id(view) != 0;
+}
+
+/**
+ * Gets the id of a viewed vertex's first outgoing edge
+ */
+edgeid_t Fabric_VertexView_get_first_out_edge_id(EntityView *view) {
+    return betoh32(*(edgeid_t*)(Fabric_EntityView_get_data(view) + 2));
+}
+
+/**
+ * Gets the id of a viewed vertex's first incoming edge
+ */
+edgeid_t Fabric_VertexView_get_first_in_edge_id(EntityView *view) {
+    return betoh32(*(edgeid_t*)(Fabric_EntityView_get_data(view) + 6));
+}
+
+/**
+ * Gets the id of a viewed vertex's first property
+ */
+propertyid_t Fabric_VertexView_get_first_property_id(EntityView *view) {
+    return betoh32(*(propertyid_t*)(Fabric_EntityView_get_data(view) + 10));
+}
+
+#endif
@@ -3,7 +3,7 @@
  *
  * Author: Mark Wardle <mark@themarkside.com>
  * Created: March 23, 2015
- * Updated: March 27, 2015
+ * Updated: October 14, 2026
  */
 
 #ifndef _FABRIC_VERTEXSTORE_C__
@@ -11,6 +11,8 @@
 
 #include "Internal.h"
 
+#define FABRIC_VERTEXSTORE_HEADER_SIZE 12
+
 /**
  * The Vertex Store is the component of the graph that has the responsibility
  * of managing the storage of Vertex objects.
@@ -18,30 +20,499 @@
  * For many of the functions to work, it is assumed that the Vertex Store
  * is embedded inside a Graph object.
  *
+ * The store begins with a 12 byte header holding the number of vertices,
+ * the next free id and the last free id.  It is followed by the vertex
+ * records, starting with vertex 1.  Freed ids are kept in a free id map
+ * (see FreeIdMap.c); older graphs link them through the first_out_id
+ * field of unused records.
+ *
  * For a detailed description of Vertex objects, see the accompanying
  * Vertex.c file.
  */
 typedef struct VertexStore {
-    uint32_t offset;    // graph file offset for the property store
-    uint32_t size;      // the size of the property store
+    uint32_t offset;        // graph file offset for the vertex store
+    ExtentList extents;     // The regions of the file that hold the vertex store
+    uint32_t num_vertices;  // The number of vertices in the graph
+    uint32_t last_free_id;  // The last vertex id available
+                             // Always points to an previously unwritten portion of the file
+    FreeIdMap free_ids;     // The freed ids below last_free_id
+    EntityCache *cache;      // A cache of vertices; Includes at least all vertices in changed
+    IdSet *changed;          // A set of vertices that have changed since last write
 } VertexStore;
 
+/**
+ * Internal function used by the cache to free evicted vertices
+ */
+static
+void Fabric_VertexStore__destroy_vertex(void *vertex) {
+    Fabric_Vertex_destroy(vertex);
+}
+
 /**
  * Initializes a vertex store object
  *
  * Args:
  *      self: The Vertex Store object being initialized.  Its offset should
  *            already be set by the Graph
+ *
+ * Returns: FABRIC_OK on success or other error code on failure
  */
-void Fabric_VertexStore_init(VertexStore *self) {
+error_t Fabric_VertexStore_init(VertexStore *self) {
+    error_t status;
+    vertexid_t first_free_id;
+    uint8_t header[3 * sizeof(uint32_t)];
     Graph *graph = Fabric_VertexStore_get_graph(self);
-    self->size = Fabric_Graph_get_edge_store_offset(graph) - self->offset;
+    Fabric_Graph_read_store_header(graph, header, sizeof(header), self->offset);
+    self->num_vertices = betoh32(*(uint32_t*)header);
+    first_free_id = betoh32(*(uint32_t*)(header + 4));
+    self->last_free_id = betoh32(*(uint32_t*)(header + 8));
+
+    // A new store has never handed out an id
+    if (first_free_id == 0) {
+        first_free_id = 1;
+        self->last_free_id = 1;
+    }
+
+    Fabric_FreeIdMap_init(&self->free_ids);
+    status = Fabric_FreeIdMap_load(&self->free_ids, graph, FABRIC_VERTEX_STORE, self->last_free_id);
+    if (FABRIC_FREEIDMAP_MISSING == status) {
+        // Older graphs link the free ids through the first out edge id of free vertex records
+        status = Fabric_FreeIdMap_load_list(&self->free_ids, graph, &self->extents,
+            first_free_id, self->last_free_id, sizeof(classid_t), sizeof(uint32_t));
+    }
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    self->cache = NULL;
+    // Changed vertices are pinned in the cache until they are written
+    self->changed = Fabric_IdSet_new(&status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    self->cache = Fabric_EntityCache_new(
+        FABRIC_VERTEX_CACHE_SIZE,
+        FABRIC_CACHE_POLICY,
+        self->changed,
+        Fabric_VertexStore__destroy_vertex,
+        &status);
+    if (FABRIC_OK != status) {
+        Fabric_IdSet_destroy(self->changed);
+        self->changed = NULL;
+    }
+    return status;
+}
+
+/**
+ * Frees the memory used by a vertex store, including its cached vertices
+ *
+ * Changes that have not been flushed are lost.
+ */
+void Fabric_VertexStore_deinit(VertexStore *self) {
+    if (NULL != self->cache) {
+        Fabric_EntityCache_destroy(self->cache);
+        self->cache = NULL;
+    }
+    if (NULL != self->changed) {
+        Fabric_IdSet_destroy(self->changed);
+        self->changed = NULL;
+    }
+    Fabric_FreeIdMap_deinit(&self->free_ids);
+}
+
+/**
+ * Internal function for calculating the file offset of a vertex
+ */
+static inline uint32_t Fabric_VertexStore__get_id_offset(VertexStore *self, vertexid_t vertex_id) {
+    return Fabric_ExtentList_get_record_offset(&self->extents, vertex_id);
+}
+
+/**
+ * Internal function that returns the largest id that fits in the store
+ */
+static inline vertexid_t Fabric_VertexStore__max_id(VertexStore *self) {
+    return self->extents.capacity;
+}
+
+/**
+ * Internal function that serializes a changed vertex for the flush
+ */
+static
+void Fabric_VertexStore__serialize(void *store, uint32_t vertex_id, uint8_t *destination) {
+    VertexStore *self = store;
+    // If the vertex has been changed, it MUST be in the cache
+    Fabric_Vertex_load_bytes(Fabric_EntityCache_get(self->cache, vertex_id), destination);
+}
+
+/**
+ * Internal function that saves the vertex store's free id map and writes its header
+ *
+ * The free ids are all in the saved map, so the header's next free id
+ * is the same as its last free id.
+ */
+static
+error_t Fabric_VertexStore__write_header(VertexStore *self) {
+    Graph *graph = Fabric_VertexStore_get_graph(self);
+    error_t status = Fabric_FreeIdMap_save(&self->free_ids, graph, FABRIC_VERTEX_STORE);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    // Write the vertex store's header
+    Fabric_Graph_update_uint32(graph, self->num_vertices, self->offset);
+    Fabric_Graph_update_uint32(graph, self->last_free_id, self->offset + 4);
+    Fabric_Graph_update_uint32(graph, self->last_free_id, self->offset + 8);
+
+    return FABRIC_OK;
+}
+
+/**
+ * Writes updates to the vertex store to file.
+ *
+ * The changed vertices are written in file order, with adjacent
+ * vertices written together, and the header is only rewritten if it
+ * changed.
+ *
+ * Args:
+ *      self: The vertex store whose data is being persisted
+ *
+ * Returns:
+ *      FABRIC_OK if the write is successful
+ *      A memory error if there is not enough memory to complete the action
+ *      FABRIC_VERTEXSTORE_NEEDS_RESIZE if the vertex store must be resized
+ *          before it can complete the write
+ */
+error_t Fabric_VertexStore_flush(VertexStore *self) {
+    if (Fabric_IdSet_is_empty(self->changed)){
+        // Ids freed without changing a record only need the header
+        return Fabric_FreeIdMap_is_changed(&self->free_ids) ? Fabric_VertexStore__write_header(self) : FABRIC_OK;
+    }
+    uint64_t started = Fabric_stats_now();
+
+    error_t status;
+    uint32_t *changed_ids = Fabric_IdSet_to_array(self->changed, &status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    int num_ids = Fabric_IdSet_get_count(self->changed);
+    int num_writable = 0;
+    int i;
+    vertexid_t max_id = 0;
+    Graph *graph = Fabric_VertexStore_get_graph(self);
+
+    // Grow the store to fit every changed record first.  Vertices that
+    // still don't fit stay in the changed set
+    for (i = 0; i < num_ids; i++) {
+        if (changed_ids[i] > max_id) {
+            max_id = changed_ids[i];
+        }
+    }
+    Fabric_Graph_grow_store(graph, FABRIC_VERTEX_STORE, max_id);
+    max_id = Fabric_VertexStore__max_id(self);
+    for (i = 0; i < num_ids; i++) {
+        if (changed_ids[i] <= max_id) {
+            changed_ids[num_writable++] = changed_ids[i];
+        }
+    }
+
+    status = Fabric_Graph_write_records(
+        graph,
+        changed_ids,
+        num_writable,
+        &self->extents,
+        Fabric_VertexStore__serialize,
+        self);
+    Fabric_stats_add(FABRIC_STAT_FLUSHES + FABRIC_STATS_VERTEX_STORE, 1);
+    Fabric_stats_add_elapsed(FABRIC_STAT_FLUSH_NANOS + FABRIC_STATS_VERTEX_STORE, started);
+
+    if (FABRIC_OK == status) {
+        Fabric_stats_add(FABRIC_STAT_RECORDS_WRITTEN + FABRIC_STATS_VERTEX_STORE, num_writable);
+        for (i = 0; i < num_writable; i++) {
+            Fabric_IdSet_remove(self->changed, changed_ids[i]);
+        }
+        if (num_writable < num_ids) {
+            status = FABRIC_VERTEXSTORE_NEEDS_RESIZE;
+        }
+    }
+    Fabric_memfree(changed_ids, sizeof(uint32_t) * num_ids);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    return Fabric_VertexStore__write_header(self);
+}
+
+/**
+ * Internal function for getting and updating the next id for a vertex
+ *
+ * The lowest freed id is reused before a new one is taken from the end
+ * of the store.
+ */
+static
+vertexid_t Fabric_VertexStore__next_id(VertexStore *self) {
+    vertexid_t vertex_id = Fabric_FreeIdMap_take(&self->free_ids);
+    if (0 == vertex_id) {
+        vertex_id = self->last_free_id++;
+    }
+    return vertex_id;
+}
+
+/**
+ * Internal function that frees a vertex's id so that it can be given out again
+ *
+ * If the free id map can't grow the id is never reused.
+ */
+static
+void Fabric_VertexStore__add_free_id(VertexStore *self, vertexid_t vertex_id) {
+    if (vertex_id + 1 == self->last_free_id) {
+        self->last_free_id--;
+    } else {
+        Fabric_FreeIdMap_add(&self->free_ids, vertex_id);
+    }
+}
+
+/**
+ * Internal function for taking a run of consecutive ids for new vertices
+ *
+ * A run of freed ids is used when one is long enough; otherwise the ids
+ * are taken from the end of the store.
+ */
+static
+vertexid_t Fabric_VertexStore__reserve_ids(VertexStore *self, uint32_t count) {
+    vertexid_t first_id = Fabric_FreeIdMap_take_run(&self->free_ids, count);
+    if (0 == first_id) {
+        first_id = self->last_free_id;
+        self->last_free_id += count;
+    }
+    return first_id;
 }
 
-Vertex *Fabric_VertexStore_get_vertex(VertexStore *self, edgeid_t edge_id, error_t *status) {
-    // TODO this is a stub
+/**
+ * Gets a vertex by id from the store
+ *
+ * Args:
+ *      self: A graph's vertex store
+ *      vertex_id: The id of the vertex being retrieved
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The vertex object with the specified id, or NULL on failure
+ */
+Vertex *Fabric_VertexStore_get_vertex(VertexStore *self, vertexid_t vertex_id, error_t *status) {
+    Vertex *vertex = Fabric_EntityCache_get(self->cache, vertex_id);
+    uint8_t data[FABRIC_VERTEX_STORAGE_SIZE];
+    Graph *g;
     *status = FABRIC_OK;
-    return NULL;
+
+    // A cached copy may have changes not yet written to the file
+    if (!vertex) {
+        if (vertex_id < 1 || vertex_id > Fabric_VertexStore__max_id(self)) {
+            *status = FABRIC_VERTEXSTORE_INVALID_ID;
+            return NULL;
+        }
+        g = Fabric_VertexStore_get_graph(self);
+        Fabric_Graph_read_bytes(g, data, FABRIC_VERTEX_STORAGE_SIZE, Fabric_VertexStore__get_id_offset(self, vertex_id));
+        Fabric_stats_add(FABRIC_STAT_RECORDS_READ + FABRIC_STATS_VERTEX_STORE, 1);
+        vertex = Fabric_Vertex_new(vertex_id, status);
+        if (FABRIC_OK != *status) {
+            return NULL;
+        }
+        Fabric_Vertex_init(vertex, data);
+        // unused records are not cached, since creating a vertex reuses them
+        if (!Fabric_Vertex_is_in_use(vertex)) {
+            Fabric_Vertex_destroy(vertex);
+            *status = FABRIC_VERTEX_DOESNT_EXIST;
+            return NULL;
+        }
+        *status = Fabric_EntityCache_set(self->cache, vertex_id, vertex);
+        if (FABRIC_OK != *status) {
+            Fabric_Vertex_destroy(vertex);
+            return NULL;
+        }
+    }
+
+    // if its class id is 0 then it is not in use
+    if (!Fabric_Vertex_is_in_use(vertex)) {
+        *status = FABRIC_VERTEX_DOESNT_EXIST;
+        return NULL;
+    }
+
+    return vertex;
+}
+
+/**
+ * Views a vertex by id without creating a vertex object
+ *
+ * The view reads the cached vertex when there is one, since it may have
+ * changes not yet written to the file.  Otherwise it points at the
+ * vertex's record in the graph file.  The view must be released with
+ * Fabric_EntityView_release(1).
+ *
+ * Args:
+ *      self: A graph's vertex store
+ *      vertex_id: The id of the vertex being viewed
+ *      view: The view that is pointed at the vertex
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_VertexStore_view_vertex(VertexStore *self, vertexid_t vertex_id, EntityView *view) {
+    Vertex *cached = Fabric_EntityCache_get(self->cache, vertex_id);
+    error_t status;
+
+    if (cached) {
+        Fabric_Vertex_load_bytes(cached, Fabric_EntityView_copy(view));
+    } else {
+        if (vertex_id < 1 || vertex_id > Fabric_VertexStore__max_id(self)) {
+            Fabric_EntityView_release(view);
+            return FABRIC_VERTEXSTORE_INVALID_ID;
+        }
+        status = Fabric_EntityView_open(
+            view,
+            Fabric_VertexStore_get_graph(self),
+            FABRIC_VERTEX_STORAGE_SIZE,
+            Fabric_VertexStore__get_id_offset(self, vertex_id));
+        if (FABRIC_OK != status) {
+            Fabric_EntityView_release(view);
+            return status;
+        }
+    }
+
+    if (!Fabric_VertexView_is_in_use(view)) {
+        Fabric_EntityView_release(view);
+        return FABRIC_VERTEX_DOESNT_EXIST;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Marks a vertex as changed so that it is written on the next flush
+ *
+ * Args:
+ *      self: A graph's vertex store
+ *      vertex: The vertex that was changed
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_VertexStore_update_vertex(VertexStore *self, Vertex *vertex) {
+    vertexid_t vertex_id = Fabric_Vertex_get_id(vertex);
+    // Mark the vertex as changed first so caching it can't evict it
+    error_t status = Fabric_IdSet_add(self->changed, vertex_id);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    return Fabric_EntityCache_set(self->cache, vertex_id, vertex);
+}
+
+/**
+ * Creates a new vertex with no edges or properties
+ *
+ * Args:
+ *      self: The graph's vertex store
+ *      c: The class of the new vertex; its member count is incremented
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The newly created vertex or NULL on failure
+ */
+Vertex *Fabric_VertexStore_create_vertex(VertexStore *self, Class *c, error_t *status) {
+    Graph *g = Fabric_VertexStore_get_graph(self);
+    ClassStore *cs = Fabric_Graph_get_class_store(g);
+    vertexid_t vertex_id;
+    Vertex *vertex;
+
+    if (NULL == c || Fabric_Class_is_abstract(c)) {
+        *status = FABRIC_CLASS_ERROR;
+        return NULL;
+    }
+
+    vertex_id = Fabric_VertexStore__next_id(self);
+    vertex = Fabric_Vertex_new(vertex_id, status);
+    if (FABRIC_OK != *status) {
+        Fabric_VertexStore__add_free_id(self, vertex_id);
+        return NULL;
+    }
+
+    Fabric_Vertex_set_class_id(vertex, Fabric_Class_get_id(c));
+    Fabric_Vertex_set_first_out_edge_id(vertex, 0);
+    Fabric_Vertex_set_first_in_edge_id(vertex, 0);
+    Fabric_Vertex_set_first_property_id(vertex, 0);
+
+    *status = Fabric_VertexStore_update_vertex(self, vertex);
+    if (FABRIC_OK != *status) {
+        Fabric_IdSet_remove(self->changed, vertex_id);
+        Fabric_Vertex_destroy(vertex);
+        Fabric_VertexStore__add_free_id(self, vertex_id);
+        return NULL;
+    }
+
+    *status = Fabric_ClassStore_add_to_count(cs, c, 1);
+    self->num_vertices++;
+    return vertex;
+}
+
+/**
+ * Creates a number of new vertices of a class with consecutive ids
+ *
+ * The ids are reserved at once, so a bulk insert gets a contiguous part
+ * of the store.  If any of the vertices can't be made then none of them
+ * are and their ids are freed.
+ *
+ * Args:
+ *      self: The graph's vertex store
+ *      c: The class of the new vertices; its member count is increased
+ *      count: The number of vertices to create
+ *      status: A pointer to where an error can be indicated
+ *
+ * Returns: The id of the first new vertex or 0 on failure
+ */
+vertexid_t Fabric_VertexStore_create_vertices(VertexStore *self, Class *c, uint32_t count, error_t *status) {
+    Graph *g = Fabric_VertexStore_get_graph(self);
+    ClassStore *cs = Fabric_Graph_get_class_store(g);
+    vertexid_t first_id, vertex_id;
+    Vertex *vertex;
+    uint32_t i;
+
+    if (NULL == c || Fabric_Class_is_abstract(c) || 0 == count) {
+        *status = FABRIC_CLASS_ERROR;
+        return 0;
+    }
+
+    first_id = Fabric_VertexStore__reserve_ids(self, count);
+    for (i = 0; i < count; i++) {
+        vertex_id = first_id + i;
+        vertex = Fabric_Vertex_new(vertex_id, status);
+        if (FABRIC_OK != *status) {
+            break;
+        }
+        Fabric_Vertex_set_class_id(vertex, Fabric_Class_get_id(c));
+        Fabric_Vertex_set_first_out_edge_id(vertex, 0);
+        Fabric_Vertex_set_first_in_edge_id(vertex, 0);
+        Fabric_Vertex_set_first_property_id(vertex, 0);
+
+        *status = Fabric_VertexStore_update_vertex(self, vertex);
+        if (FABRIC_OK != *status) {
+            Fabric_IdSet_remove(self->changed, vertex_id);
+            Fabric_Vertex_destroy(vertex);
+            break;
+        }
+    }
+
+    if (i < count) {
+        // Free the ids from the last one so that ids taken from the end of
+        // the store are given back there
+        for (vertex_id = first_id + count - 1; vertex_id >= first_id; vertex_id--) {
+            if (vertex_id < first_id + i) {
+                vertex = Fabric_EntityCache_get(self->cache, vertex_id);
+                Fabric_EntityCache_unset(self->cache, vertex_id);
+                Fabric_IdSet_remove(self->changed, vertex_id);
+                Fabric_Vertex_destroy(vertex);
+            }
+            Fabric_VertexStore__add_free_id(self, vertex_id);
+        }
+        return 0;
+    }
+
+    *status = Fabric_ClassStore_add_to_count(cs, c, count);
+    self->num_vertices += count;
+    return first_id;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,553 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_WAL_C__
+#define _FABRIC_WAL_C__
+
+#include <string.h>
+#include <unistd.h>
+#include "Internal.h"
+
+#ifndef FABRIC_NO_THREADS
+#  include <pthread.h>
+#endif
+
+/**
+ * A Write-Ahead Log (WAL) makes a graph's committed writes durable
+ * without forcing the graph file to disk on every flush.
+ *
+ * Every write to the graph is appended to the log as a redo record
+ * before it is applied.  Committing appends a commit record and forces
+ * the log to disk, which is a sequential append instead of a scattered
+ * write of every changed page.  When the graph is next initialized with
+ * its log, the writes of every committed transaction are replayed into
+ * the graph file.  Writes after the last commit record are ignored.
+ *
+ * Records are buffered in memory until a commit.  Commits from several
+ * threads are grouped: while one thread forces the log to disk the others
+ * wait, and the next thread to force the log writes all of their records
+ * with one write and one fsync.
+ *
+ * A checkpoint flushes the graph, forces the graph file to disk and then
+ * empties the log.  The log only guarantees redo, so writes that were not
+ * committed must never reach the graph file: the graph's buffer pool is
+ * given the lsn of the last durable commit and keeps every page changed
+ * after it in memory until a later commit covers it.  The log isn't
+ * emptied while such a page is still dirty.
+ *
+ * Every record has a log sequence number (lsn): the number of bytes
+ * appended before it since the log was opened.  An incremental
+ * checkpoint writes only some of the graph's dirty pages, so instead of
+ * emptying the log it appends a checkpoint record holding the log file
+ * offset of the oldest record a dirty page still depends on.  Recovery
+ * replays from the last checkpoint record before the last commit instead
+ * of from the start of the log, and the log is emptied by the first
+ * checkpoint that finds no dirty pages left.
+ *
+ * Every record is laid out as big endian 32 bit integers followed by its
+ * data:
+ *
+ *      type, offset, length, data (length bytes), checksum
+ *
+ * The checksum covers everything before it.  A record with a bad
+ * checksum marks the end of the log; it is the torn tail of a write that
+ * was interrupted by a crash.
+ */
+typedef struct Wal {
+    FILE *file;                  // The log file
+    uint8_t *buffer;             // Records that have not been written to the log file
+    size_t buffer_size;          // The number of bytes in buffer
+    size_t buffer_capacity;      // The allocated size of buffer
+    uint8_t *spare;              // A second buffer swapped in while buffer is written
+    size_t spare_capacity;       // The allocated size of spare
+    size_t file_size;            // The size of the log file
+    uint64_t appended;           // Bytes of records appended since the log was opened
+    uint64_t durable;            // Bytes of records known to be on disk
+    uint64_t base;               // The lsn of the first byte of the log file
+    uint64_t written;            // The lsn just past the last write record
+    uint64_t committed;          // The lsn just past the last durable commit record
+    bool_t syncing;              // Whether a thread is forcing the log to disk
+    error_t failure;             // The error of a failed log write, which is permanent
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_t lock;        // Protects every field of the log
+    pthread_cond_t synced;       // Signalled whenever a sync finishes
+#endif
+} Wal;
+
+#define FABRIC_WAL_RECORD_WRITE 1
+#define FABRIC_WAL_RECORD_COMMIT 2
+#define FABRIC_WAL_RECORD_CHECKPOINT 3
+#define FABRIC_WAL_RECORD_HEADER_SIZE 12
+#define FABRIC_WAL_RECORD_OVERHEAD 16
+
+#ifndef FABRIC_NO_THREADS
+#  define FABRIC_WAL_LOCK(self) pthread_mutex_lock(&(self)->lock)
+#  define FABRIC_WAL_UNLOCK(self) pthread_mutex_unlock(&(self)->lock)
+#else
+#  define FABRIC_WAL_LOCK(self)
+#  define FABRIC_WAL_UNLOCK(self)
+#endif
+
+/**
+ * Private function that continues a Jenkins one at a time hash
+ */
+static
+uint32_t Fabric_Wal__mix(uint32_t hash, uint8_t *bytes, size_t num_bytes) {
+    size_t i;
+    for (i = 0; i < num_bytes; i++) {
+        hash += bytes[i];
+        hash += (hash << 10);
+        hash ^= (hash >> 6);
+    }
+    return hash;
+}
+
+/**
+ * Private function that finishes a Jenkins one at a time hash
+ */
+static inline
+uint32_t Fabric_Wal__finish(uint32_t hash) {
+    hash += (hash << 3);
+    hash ^= (hash >> 11);
+    hash += (hash << 15);
+    return hash;
+}
+
+/**
+ * Initializes a log
+ *
+ * The log file may hold records from a previous session.  They are kept
+ * until the log is recovered or truncated.
+ *
+ * Args:
+ *      self: The log being initialized
+ *      file: The log file, opened for reading and writing
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Wal_init(Wal *self, FILE *file) {
+    long size;
+
+    self->file = file;
+    self->buffer_size = 0;
+    self->buffer_capacity = FABRIC_WAL_BUFFER_SIZE;
+    self->spare_capacity = FABRIC_WAL_BUFFER_SIZE;
+    self->base = 0;
+    self->syncing = FALSE;
+    self->failure = FABRIC_OK;
+
+    if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0) {
+        return FABRIC_WAL_IO_ERROR;
+    }
+    self->file_size = size;
+    self->appended = size;
+    self->durable = size;
+    self->written = size;
+    self->committed = size;
+
+    self->buffer = Fabric_memalloc_tagged(self->buffer_capacity, FABRIC_MEM_IO);
+    self->spare = Fabric_memalloc_tagged(self->spare_capacity, FABRIC_MEM_IO);
+    if (NULL == self->buffer || NULL == self->spare) {
+        error_t status = Fabric_memerrno();
+        if (NULL != self->buffer) {
+            Fabric_memfree_tagged(self->buffer, self->buffer_capacity, FABRIC_MEM_IO);
+        }
+        if (NULL != self->spare) {
+            Fabric_memfree_tagged(self->spare, self->spare_capacity, FABRIC_MEM_IO);
+        }
+        return status;
+    }
+
+#ifndef FABRIC_NO_THREADS
+    pthread_mutex_init(&self->lock, NULL);
+    pthread_cond_init(&self->synced, NULL);
+#endif
+    return FABRIC_OK;
+}
+
+/**
+ * Frees the memory used by a log
+ *
+ * Records that have not been committed are discarded.  The log file is
+ * not closed.
+ */
+void Fabric_Wal_deinit(Wal *self) {
+    Fabric_memfree_tagged(self->buffer, self->buffer_capacity, FABRIC_MEM_IO);
+    Fabric_memfree_tagged(self->spare, self->spare_capacity, FABRIC_MEM_IO);
+    self->buffer = NULL;
+    self->spare = NULL;
+#ifndef FABRIC_NO_THREADS
+    pthread_cond_destroy(&self->synced);
+    pthread_mutex_destroy(&self->lock);
+#endif
+}
+
+/**
+ * Private function that adds a record to the buffer
+ *
+ * The log must be locked.
+ */
+static
+error_t Fabric_Wal__append_record(Wal *self, uint32_t type, uint8_t *bytes, uint32_t num_bytes, uint32_t offset) {
+    size_t record_size = FABRIC_WAL_RECORD_OVERHEAD + num_bytes;
+    size_t new_capacity;
+    uint8_t *record;
+    uint8_t *new_buffer;
+    uint32_t checksum;
+
+    if (self->buffer_size + record_size > self->buffer_capacity) {
+        new_capacity = self->buffer_capacity * 2;
+        while (new_capacity < self->buffer_size + record_size) {
+            new_capacity *= 2;
+        }
+        new_buffer = Fabric_memrealloc_tagged(self->buffer, new_capacity, self->buffer_capacity, FABRIC_MEM_IO);
+        if (NULL == new_buffer) {
+            return Fabric_memerrno();
+        }
+        self->buffer = new_buffer;
+        self->buffer_capacity = new_capacity;
+    }
+
+    record = self->buffer + self->buffer_size;
+    *((uint32_t*)record) = htobe32(type);
+    *((uint32_t*)(record + 4)) = htobe32(offset);
+    *((uint32_t*)(record + 8)) = htobe32(num_bytes);
+    if (num_bytes > 0) {
+        memcpy(record + FABRIC_WAL_RECORD_HEADER_SIZE, bytes, num_bytes);
+    }
+    checksum = Fabric_Wal__finish(Fabric_Wal__mix(0, record, FABRIC_WAL_RECORD_HEADER_SIZE + num_bytes));
+    *((uint32_t*)(record + FABRIC_WAL_RECORD_HEADER_SIZE + num_bytes)) = htobe32(checksum);
+
+    self->buffer_size += record_size;
+    self->appended += record_size;
+    return FABRIC_OK;
+}
+
+/**
+ * Appends a redo record for a write to the graph file
+ *
+ * The record is buffered and reaches the log file with the next commit.
+ *
+ * Args:
+ *      self: The log
+ *      bytes: The bytes being written
+ *      num_bytes: The number of bytes being written
+ *      offset: The graph file offset being written to
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Wal_append(Wal *self, uint8_t *bytes, uint32_t num_bytes, uint32_t offset) {
+    error_t status;
+    FABRIC_WAL_LOCK(self);
+    status = Fabric_Wal__append_record(self, FABRIC_WAL_RECORD_WRITE, bytes, num_bytes, offset);
+    if (FABRIC_OK == status) {
+        self->written = self->appended;
+    }
+    FABRIC_WAL_UNLOCK(self);
+    return status;
+}
+
+/**
+ * Private function that writes a buffer to the end of the log file and
+ * forces it to disk
+ *
+ * The log must not be locked, since this is the slow part of a commit.
+ */
+static
+error_t Fabric_Wal__sync(Wal *self, uint8_t *buffer, size_t num_bytes) {
+    if (num_bytes > 0) {
+        if (fseek(self->file, 0, SEEK_END) != 0 ||
+            fwrite(buffer, 1, num_bytes, self->file) != num_bytes) {
+            return FABRIC_WAL_IO_ERROR;
+        }
+    }
+    if (fflush(self->file) != 0 || fsync(fileno(self->file)) != 0) {
+        return FABRIC_WAL_IO_ERROR;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Commits the writes appended since the last commit
+ *
+ * Returns once the commit record and every record before it are on
+ * disk.  Threads that commit while another thread is forcing the log to
+ * disk share the next sync.
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Wal_commit(Wal *self) {
+    error_t status;
+    uint64_t target, end;
+    uint8_t *buffer;
+    size_t num_bytes, capacity;
+
+    FABRIC_WAL_LOCK(self);
+    status = Fabric_Wal__append_record(self, FABRIC_WAL_RECORD_COMMIT, NULL, 0, 0);
+    target = self->appended;
+
+    while (FABRIC_OK == status && FABRIC_OK == self->failure && self->durable < target) {
+#ifndef FABRIC_NO_THREADS
+        if (self->syncing) {
+            pthread_cond_wait(&self->synced, &self->lock);
+            continue;
+        }
+#endif
+        // Become the thread that writes every buffered record
+        self->syncing = TRUE;
+        buffer = self->buffer;
+        num_bytes = self->buffer_size;
+        capacity = self->buffer_capacity;
+        end = self->appended;
+        self->buffer = self->spare;
+        self->buffer_capacity = self->spare_capacity;
+        self->buffer_size = 0;
+        FABRIC_WAL_UNLOCK(self);
+
+        status = Fabric_Wal__sync(self, buffer, num_bytes);
+
+        FABRIC_WAL_LOCK(self);
+        self->spare = buffer;
+        self->spare_capacity = capacity;
+        self->syncing = FALSE;
+        if (FABRIC_OK == status) {
+            self->durable = end;
+            self->file_size += num_bytes;
+        } else {
+            self->failure = status;
+        }
+#ifndef FABRIC_NO_THREADS
+        pthread_cond_broadcast(&self->synced);
+#endif
+    }
+
+    if (FABRIC_OK == status) {
+        status = self->failure;
+    }
+    if (FABRIC_OK == status && target > self->committed) {
+        self->committed = target;
+    }
+    FABRIC_WAL_UNLOCK(self);
+    return status;
+}
+
+/**
+ * Gets the lsn the next record appended to a log will have
+ */
+uint64_t Fabric_Wal_get_lsn(Wal *self) {
+    uint64_t lsn;
+    FABRIC_WAL_LOCK(self);
+    lsn = self->appended;
+    FABRIC_WAL_UNLOCK(self);
+    return lsn;
+}
+
+/**
+ * Gets the lsn just past the last commit record that is on disk
+ *
+ * Every write record before it belongs to a durable commit.
+ */
+uint64_t Fabric_Wal_get_commit_lsn(Wal *self) {
+    uint64_t lsn;
+    FABRIC_WAL_LOCK(self);
+    lsn = self->committed;
+    FABRIC_WAL_UNLOCK(self);
+    return lsn;
+}
+
+/**
+ * Private function that empties the log file
+ *
+ * The log must be locked and no thread may be syncing it.
+ */
+static
+error_t Fabric_Wal__truncate(Wal *self) {
+    if (fflush(self->file) != 0 || ftruncate(fileno(self->file), 0) != 0 || fseek(self->file, 0, SEEK_SET) != 0) {
+        return FABRIC_WAL_IO_ERROR;
+    }
+    self->file_size = 0;
+    self->buffer_size = 0;
+    self->durable = self->appended;
+    self->base = self->appended;
+    return FABRIC_OK;
+}
+
+/**
+ * Records the progress of an incremental checkpoint
+ *
+ * The caller must have forced to the graph file on disk every committed
+ * write before redo_lsn.  If that is every record in the log and no
+ * write record is waiting for a commit, the log is emptied.  Otherwise a checkpoint record is
+ * appended, which takes effect once a commit after it is durable.
+ *
+ * Args:
+ *      self: The log
+ *      redo_lsn: The lsn of the oldest record recovery would still need
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Wal_checkpoint(Wal *self, uint64_t redo_lsn) {
+    error_t status;
+
+    FABRIC_WAL_LOCK(self);
+    if (redo_lsn >= self->appended && self->written <= self->durable && !self->syncing) {
+        status = Fabric_Wal__truncate(self);
+    } else {
+        if (redo_lsn < self->base) {
+            redo_lsn = self->base;
+        } else if (redo_lsn > self->appended) {
+            redo_lsn = self->appended;
+        }
+        status = Fabric_Wal__append_record(self, FABRIC_WAL_RECORD_CHECKPOINT, NULL, 0, (uint32_t)(redo_lsn - self->base));
+    }
+    FABRIC_WAL_UNLOCK(self);
+    return status;
+}
+
+/**
+ * Returns the size of the log file in bytes
+ */
+size_t Fabric_Wal_get_size(Wal *self) {
+    size_t size;
+    FABRIC_WAL_LOCK(self);
+    size = self->file_size;
+    FABRIC_WAL_UNLOCK(self);
+    return size;
+}
+
+/**
+ * Private function that reads the record at a log file offset
+ *
+ * The record's data is read into data, which is grown if needed.
+ *
+ * Returns: TRUE if a complete record with a valid checksum was read
+ */
+static
+bool_t Fabric_Wal__read_record(
+    Wal *self,
+    size_t position,
+    uint32_t *type,
+    uint32_t *offset,
+    uint32_t *num_bytes,
+    uint8_t **data,
+    size_t *data_capacity) {
+
+    uint8_t header[FABRIC_WAL_RECORD_HEADER_SIZE];
+    uint8_t trailer[sizeof(uint32_t)];
+    uint8_t *new_data;
+    uint32_t checksum;
+
+    if (position + FABRIC_WAL_RECORD_OVERHEAD > self->file_size ||
+        fseek(self->file, position, SEEK_SET) != 0 ||
+        fread(header, 1, sizeof(header), self->file) != sizeof(header)) {
+        return FALSE;
+    }
+    *type = betoh32(*((uint32_t*)header));
+    *offset = betoh32(*((uint32_t*)(header + 4)));
+    *num_bytes = betoh32(*((uint32_t*)(header + 8)));
+    if (position + FABRIC_WAL_RECORD_OVERHEAD + *num_bytes > self->file_size) {
+        return FALSE;
+    }
+
+    if (*num_bytes > *data_capacity) {
+        new_data = Fabric_memrealloc_tagged(*data, *num_bytes, *data_capacity, FABRIC_MEM_IO);
+        if (NULL == new_data) {
+            return FALSE;
+        }
+        *data = new_data;
+        *data_capacity = *num_bytes;
+    }
+    if (fread(*data, 1, *num_bytes, self->file) != *num_bytes ||
+        fread(trailer, 1, sizeof(trailer), self->file) != sizeof(trailer)) {
+        return FALSE;
+    }
+
+    checksum = Fabric_Wal__finish(Fabric_Wal__mix(Fabric_Wal__mix(0, header, sizeof(header)), *data, *num_bytes));
+    return checksum == betoh32(*((uint32_t*)trailer));
+}
+
+/**
+ * Replays the committed writes in the log file
+ *
+ * The log is read twice: once to find the end of the last committed
+ * transaction and once to apply every write before it in log order,
+ * starting from the offset held by the last checkpoint record before the
+ * last commit record.  The log is not truncated; the caller should do so once the replayed
+ * writes are on disk.
+ *
+ * Args:
+ *      self: The log
+ *      apply: Called with each committed write
+ *      target: Passed through to apply
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Wal_recover(Wal *self, Fabric_WalApplier apply, void *target) {
+    uint8_t *data = NULL;
+    size_t data_capacity = 0;
+    size_t position = 0;
+    size_t committed_end = 0;
+    size_t checkpoint_start = 0;
+    size_t redo_start = 0;
+    uint32_t type, offset, num_bytes;
+    error_t status = FABRIC_OK;
+
+    // Find the end of the last complete transaction and where to replay from
+    while (Fabric_Wal__read_record(self, position, &type, &offset, &num_bytes, &data, &data_capacity)) {
+        if (FABRIC_WAL_RECORD_CHECKPOINT == type && offset <= position) {
+            checkpoint_start = offset;
+        }
+        position += FABRIC_WAL_RECORD_OVERHEAD + num_bytes;
+        if (FABRIC_WAL_RECORD_COMMIT == type) {
+            committed_end = position;
+            redo_start = checkpoint_start;
+        }
+    }
+
+    position = redo_start;
+    while (FABRIC_OK == status && position < committed_end) {
+        if (!Fabric_Wal__read_record(self, position, &type, &offset, &num_bytes, &data, &data_capacity)) {
+            status = FABRIC_WAL_IO_ERROR;
+            break;
+        }
+        if (FABRIC_WAL_RECORD_WRITE == type) {
+            status = apply(target, data, num_bytes, offset);
+        }
+        position += FABRIC_WAL_RECORD_OVERHEAD + num_bytes;
+    }
+
+    if (NULL != data) {
+        Fabric_memfree_tagged(data, data_capacity, FABRIC_MEM_IO);
+    }
+    return status;
+}
+
+/**
+ * Empties the log file
+ *
+ * This must only be done once every committed write has reached the
+ * graph file on disk.  Buffered records that have not been committed are
+ * discarded.
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_Wal_truncate(Wal *self) {
+    error_t status;
+
+    FABRIC_WAL_LOCK(self);
+#ifndef FABRIC_NO_THREADS
+    while (self->syncing) {
+        pthread_cond_wait(&self->synced, &self->lock);
+    }
+#endif
+    status = Fabric_Wal__truncate(self);
+    FABRIC_WAL_UNLOCK(self);
+    return status;
+}
+
+#endif
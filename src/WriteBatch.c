@@ -0,0 +1,227 @@
+/**
+ * This file is part of the FabricDB library
+ *
+ * Author: Mark Wardle <mark@themarkside.com>
+ * Created: October 14, 2026
+ * Updated: October 14, 2026
+ */
+
+#ifndef _FABRIC_WRITEBATCH_C__
+#define _FABRIC_WRITEBATCH_C__
+
+#include <string.h>
+#include "Internal.h"
+
+/**
+ * A Write Batch groups a graph's changes so that they are committed or
+ * abandoned together.
+ *
+ * Changes made while a batch is open are staged by the stores as usual:
+ * changed entities stay pinned in the stores' caches and nothing is
+ * written to their records until the batch is committed.  Committing
+ * flushes each store once, so every store's records are written in one
+ * pass and its header at most once, and then commits the graph, which
+ * for a graph with a write-ahead log is a single commit record.  A
+ * batch of small changes costs one flush and one commit instead of one
+ * of each per change.
+ *
+ * Some changes, such as those to indices and text, are written to the
+ * graph as they are made.  While a batch is open, the first write to
+ * each page of the graph keeps a copy of the page as it was in the
+ * batch's arena.  Aborting the batch writes those copies back and then
+ * reloads the stores from the graph, which discards every change they
+ * staged.  The stores are flushed when a batch begins, so reloading them
+ * loses nothing from before the batch.
+ *
+ * A graph has at most one open batch.  Entities obtained from the stores
+ * before an abort must not be used after it, and the graph should not be
+ * flushed, committed or published while a batch is open.
+ */
+typedef struct PageImage {
+    uint32_t page_no;           // The page this is a copy of
+    struct PageImage *next;     // The page copied before this one
+    uint8_t data[FABRIC_PAGE_SIZE];    // The page as it was when the batch began
+} PageImage;
+
+typedef struct WriteBatch {
+    Graph *graph;               // The graph being changed
+    EntityMap *pages;           // Maps page numbers (+ 1) to their images
+    PageImage *newest;          // The page copied most recently
+    uint32_t num_pages;         // The number of pages copied
+    MemArena arena;             // Holds the page images
+} WriteBatch;
+
+/**
+ * Private function that frees a batch's page images and detaches it
+ * from its graph
+ */
+static
+void Fabric_WriteBatch__release(WriteBatch *self) {
+    Fabric_Graph_set_write_batch(self->graph, NULL);
+    if (NULL != self->pages) {
+        Fabric_EntityMap_destroy(self->pages);
+        self->pages = NULL;
+    }
+    Fabric_memarena_release(&self->arena);
+    self->newest = NULL;
+    self->num_pages = 0;
+}
+
+/**
+ * Begins a batch of changes to a graph
+ *
+ * Changes the stores are holding are flushed first.
+ *
+ * Args:
+ *      self: The batch being begun
+ *      graph: The graph being changed
+ *
+ * Returns: FABRIC_OK on success, FABRIC_WRITEBATCH_ERROR if the graph
+ *          already has an open batch or other error code on failure
+ */
+error_t Fabric_WriteBatch_begin(WriteBatch *self, Graph *graph) {
+    error_t status;
+
+    self->graph = graph;
+    self->pages = NULL;
+    self->newest = NULL;
+    self->num_pages = 0;
+    Fabric_memarena_init(&self->arena, FABRIC_WRITE_BATCH_CHUNK_SIZE, FABRIC_MEM_IO);
+
+    if (NULL != Fabric_Graph_get_write_batch(graph)) {
+        return FABRIC_WRITEBATCH_ERROR;
+    }
+    status = Fabric_Graph_flush_stores(graph);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    self->pages = Fabric_EntityMap_new(&status);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+    Fabric_Graph_set_write_batch(graph, self);
+    return FABRIC_OK;
+}
+
+/**
+ * Keeps a copy of each page a write is about to change
+ *
+ * The graph calls this before every write while the batch is open.
+ * Pages that have already been copied are skipped.
+ *
+ * Args:
+ *      self: The graph's open batch
+ *      offset: The file offset of the write
+ *      num_bytes: The number of bytes being written
+ *
+ * Returns: FABRIC_OK on success, other error code on failure
+ */
+error_t Fabric_WriteBatch_capture(WriteBatch *self, uint32_t offset, uint32_t num_bytes) {
+    PageImage *image;
+    uint32_t page_no, last_page_no;
+    error_t status;
+
+    if (num_bytes == 0) {
+        return FABRIC_OK;
+    }
+    last_page_no = (offset + num_bytes - 1) / FABRIC_PAGE_SIZE;
+    for (page_no = offset / FABRIC_PAGE_SIZE; page_no <= last_page_no; page_no++) {
+        if (Fabric_EntityMap_has_key(self->pages, page_no + 1)) {
+            continue;
+        }
+        image = Fabric_memarena_alloc(&self->arena, sizeof(PageImage));
+        if (NULL == image) {
+            return Fabric_memerrno();
+        }
+        // Pages past the end of the file are read as zeros
+        status = Fabric_Graph_read_bytes(self->graph, image->data, FABRIC_PAGE_SIZE, page_no * FABRIC_PAGE_SIZE);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        status = Fabric_EntityMap_set(self->pages, page_no + 1, image);
+        if (FABRIC_OK != status) {
+            return status;
+        }
+        image->page_no = page_no;
+        image->next = self->newest;
+        self->newest = image;
+        self->num_pages++;
+    }
+    return FABRIC_OK;
+}
+
+/**
+ * Returns the number of pages a batch has copied so far
+ */
+uint32_t Fabric_WriteBatch_get_page_count(WriteBatch *self) {
+    return self->num_pages;
+}
+
+/**
+ * Commits a batch's changes
+ *
+ * Each store is flushed once and the graph is then committed.  If the
+ * commit fails the batch is still open, so it can be aborted.
+ *
+ * Args:
+ *      self: The graph's open batch
+ *
+ * Returns: FABRIC_OK on success, FABRIC_WRITEBATCH_ERROR if the batch
+ *          isn't open or other error code on failure
+ */
+error_t Fabric_WriteBatch_commit(WriteBatch *self) {
+    error_t status;
+
+    if (Fabric_Graph_get_write_batch(self->graph) != self) {
+        return FABRIC_WRITEBATCH_ERROR;
+    }
+    status = Fabric_Graph_flush_stores(self->graph);
+    if (FABRIC_OK != status) {
+        return status;
+    }
+
+    // Nothing written from here on needs to be undone
+    Fabric_Graph_set_write_batch(self->graph, NULL);
+    status = Fabric_Graph_commit(self->graph);
+    if (FABRIC_OK != status) {
+        Fabric_Graph_set_write_batch(self->graph, self);
+        return status;
+    }
+    Fabric_WriteBatch__release(self);
+    return FABRIC_OK;
+}
+
+/**
+ * Abandons a batch's changes
+ *
+ * The pages the batch changed are written back as they were and the
+ * stores are reloaded, which discards the changes they were holding.
+ * The batch is closed even if this fails, in which case the graph should
+ * be closed and loaded again.
+ *
+ * Args:
+ *      self: The graph's open batch
+ *
+ * Returns: FABRIC_OK on success, FABRIC_WRITEBATCH_ERROR if the batch
+ *          isn't open or other error code on failure
+ */
+error_t Fabric_WriteBatch_abort(WriteBatch *self) {
+    PageImage *image;
+    error_t status = FABRIC_OK;
+
+    if (Fabric_Graph_get_write_batch(self->graph) != self) {
+        return FABRIC_WRITEBATCH_ERROR;
+    }
+    Fabric_Graph_set_write_batch(self->graph, NULL);
+    for (image = self->newest; NULL != image && FABRIC_OK == status; image = image->next) {
+        status = Fabric_Graph_write_bytes(self->graph, image->data, FABRIC_PAGE_SIZE,
+            image->page_no * FABRIC_PAGE_SIZE);
+    }
+    if (FABRIC_OK == status) {
+        status = Fabric_Graph_reload(self->graph);
+    }
+    Fabric_WriteBatch__release(self);
+    return status;
+}
+
+#endif